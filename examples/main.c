@@ -1588,11 +1588,14 @@ int main(int argc, char *argv[]) {
 
     fprintf(e.file_timesteps,
             "  %6d %14e %12.7f %12.7f %14e %4d %4d %12lld %12lld %12lld %12lld"
-            " %12lld %21.3f %6d\n",
+            " %12lld %21.3f %6d",
             e.step, e.time, e.cosmology->a, e.cosmology->z, e.time_step,
             e.min_active_bin, e.max_active_bin, e.updates, e.g_updates,
             e.s_updates, e.sink_updates, e.b_updates, e.wallclock_time,
             e.step_props);
+    if (e.step_analysis)
+      task_write_step_summary(e.file_timesteps, &e.step_summary);
+    fprintf(e.file_timesteps, "\n");
     fflush(e.file_timesteps);
 
     /* Print information to the SFH logger */
@@ -1659,6 +1662,9 @@ int main(int argc, char *argv[]) {
 #endif
   }
 
+  /* Make sure the last snapshot is on disk before going any further. */
+  engine_wait_for_snapshot(&e);
+
   /* Remove the stop file if used. Do this anyway, we could have missed the
    * stop file if normal exit happened first. */
   if (myrank == 0) force_stop = restart_stop_now(restart_dir, 1);
@@ -33,6 +33,12 @@
 #define NUM_VEC_PROC 2
 #define C2_CACHE_SIZE (NUM_VEC_PROC * VEC_SIZE * 6) + (NUM_VEC_PROC * VEC_SIZE)
 
+/* Hydro schemes providing masked vector versions of all their loops. */
+#if defined(WITH_VECTORIZATION) && \
+    (defined(SPHENIX_SPH) || defined(ANARCHY_PU_SPH) || defined(HOPKINS_PU_SPH))
+#define WITH_MASKED_HYDRO_VECTORIZATION
+#endif
+
 #ifdef WITH_VECTORIZATION
 /* Cache struct to hold a local copy of a cells' particle
  * properties required for density/force calculations.*/
@@ -80,6 +86,24 @@ struct cache {
   /* Particle sound speed. */
   float *restrict soundspeed SWIFT_CACHE_ALIGN;
 
+  /* Particle internal energy. */
+  float *restrict u SWIFT_CACHE_ALIGN;
+
+  /* Particle pressure (smoothed pressure for pressure-energy schemes). */
+  float *restrict pressure SWIFT_CACHE_ALIGN;
+
+  /* Particle pressure including the pressure floor. */
+  float *restrict pressure_floor SWIFT_CACHE_ALIGN;
+
+  /* Artificial viscosity coefficient. */
+  float *restrict alpha_visc SWIFT_CACHE_ALIGN;
+
+  /* Thermal diffusion coefficient. */
+  float *restrict alpha_diff SWIFT_CACHE_ALIGN;
+
+  /* Particle signal velocity. */
+  float *restrict v_sig SWIFT_CACHE_ALIGN;
+
   /* Cache size. */
   int count;
 };
@@ -146,6 +170,12 @@ __attribute__((always_inline)) INLINE void cache_init(struct cache *c,
     free(c->pOrho2);
     free(c->balsara);
     free(c->soundspeed);
+    free(c->u);
+    free(c->pressure);
+    free(c->pressure_floor);
+    free(c->alpha_visc);
+    free(c->alpha_diff);
+    free(c->v_sig);
   }
 
   error += posix_memalign((void **)&c->x, SWIFT_CACHE_ALIGNMENT, sizeBytes);
@@ -167,6 +197,16 @@ __attribute__((always_inline)) INLINE void cache_init(struct cache *c,
       posix_memalign((void **)&c->balsara, SWIFT_CACHE_ALIGNMENT, sizeBytes);
   error +=
       posix_memalign((void **)&c->soundspeed, SWIFT_CACHE_ALIGNMENT, sizeBytes);
+  error += posix_memalign((void **)&c->u, SWIFT_CACHE_ALIGNMENT, sizeBytes);
+  error +=
+      posix_memalign((void **)&c->pressure, SWIFT_CACHE_ALIGNMENT, sizeBytes);
+  error += posix_memalign((void **)&c->pressure_floor, SWIFT_CACHE_ALIGNMENT,
+                          sizeBytes);
+  error +=
+      posix_memalign((void **)&c->alpha_visc, SWIFT_CACHE_ALIGNMENT, sizeBytes);
+  error +=
+      posix_memalign((void **)&c->alpha_diff, SWIFT_CACHE_ALIGNMENT, sizeBytes);
+  error += posix_memalign((void **)&c->v_sig, SWIFT_CACHE_ALIGNMENT, sizeBytes);
 
   if (error != 0)
     error("Couldn't allocate cache, no. of particles: %d", (int)count);
@@ -1069,6 +1109,150 @@ cache_read_two_partial_cells_sorted_force(
   }
 }
 
+#ifdef WITH_MASKED_HYDRO_VECTORIZATION
+
+/**
+ * @brief Copy the scheme-specific fields of a particle into a cache slot.
+ *
+ * @param c The #cache.
+ * @param i The slot to fill.
+ * @param p The #part to read from.
+ */
+__attribute__((always_inline)) INLINE static void cache_read_hydro_fields(
+    struct cache *restrict c, const int i, const struct part *restrict p) {
+
+  c->h[i] = p->h;
+  c->m[i] = p->mass;
+  c->vx[i] = p->v[0];
+  c->vy[i] = p->v[1];
+  c->vz[i] = p->v[2];
+  c->rho[i] = p->rho;
+  c->u[i] = p->u;
+  c->grad_h[i] = p->force.f;
+  c->balsara[i] = p->force.balsara;
+  c->soundspeed[i] = p->force.soundspeed;
+
+#if defined(SPHENIX_SPH)
+  c->pressure[i] = p->force.pressure;
+  c->pressure_floor[i] = p->force.pressure;
+  c->alpha_visc[i] = p->viscosity.alpha;
+  c->alpha_diff[i] = p->diffusion.alpha;
+  c->v_sig[i] = p->viscosity.v_sig;
+#elif defined(ANARCHY_PU_SPH)
+  c->pressure[i] = p->pressure_bar;
+  c->pressure_floor[i] = p->pressure_bar;
+  c->alpha_visc[i] = p->viscosity.alpha;
+  c->alpha_diff[i] = p->diffusion.alpha;
+  c->v_sig[i] = p->viscosity.v_sig;
+#elif defined(HOPKINS_PU_SPH)
+  c->pressure[i] = p->pressure_bar;
+  c->pressure_floor[i] = p->force.pressure_bar_with_floor;
+  c->alpha_visc[i] = 1.f;
+  c->alpha_diff[i] = 0.f;
+  c->v_sig[i] = p->force.v_sig;
+#endif
+}
+
+/**
+ * @brief Fill a cache slot with a particle that cannot interact with anything
+ * in the cell pair.
+ *
+ * All the fields are set to finite values such that the masked-out lanes of
+ * the vector interactions do not generate floating-point exceptions.
+ *
+ * @param c The #cache.
+ * @param i The slot to fill.
+ * @param pos_padded The position to put the particle at.
+ * @param h_padded The smoothing length to give to the particle.
+ */
+__attribute__((always_inline)) INLINE static void cache_pad_hydro_fields(
+    struct cache *restrict c, const int i, const float pos_padded,
+    const float h_padded) {
+
+  c->x[i] = pos_padded;
+  c->y[i] = pos_padded;
+  c->z[i] = pos_padded;
+  c->h[i] = h_padded;
+  c->m[i] = 1.f;
+  c->vx[i] = 0.f;
+  c->vy[i] = 0.f;
+  c->vz[i] = 0.f;
+  c->rho[i] = 1.f;
+  c->u[i] = 1.f;
+  c->grad_h[i] = 0.f;
+  c->balsara[i] = 0.f;
+  c->soundspeed[i] = 0.f;
+  c->pressure[i] = 1.f;
+  c->pressure_floor[i] = 1.f;
+  c->alpha_visc[i] = 0.f;
+  c->alpha_diff[i] = 0.f;
+  c->v_sig[i] = 0.f;
+}
+
+/**
+ * @brief Populate a cache with all the particles of a cell for the masked
+ * vector interactions of the density, gradient and force loops.
+ *
+ * The particles are read in the order given by the sort list (or in memory
+ * order if no list is given) and their positions are stored relative to the
+ * given origin. Inhibited particles and the slots up to the next multiple of
+ * the vector length are padded with particles placed far outside of the
+ * range of any real particle.
+ *
+ * @param c The #cell.
+ * @param c_cache The #cache to fill.
+ * @param sort The sorted list of particles (or NULL for memory order).
+ * @param origin The origin of the frame the positions are expressed in.
+ * @param width The largest width of the cells the particles of this cache
+ * will be interacted with.
+ * @return The number of slots filled, a multiple of the vector length.
+ */
+__attribute__((always_inline)) INLINE static int cache_read_hydro_cell(
+    const struct cell *restrict c, struct cache *restrict c_cache,
+    const struct sort_entry *restrict sort, const double *origin,
+    const double width) {
+
+  const int count = c->hydro.count;
+  const struct part *restrict parts = c->hydro.parts;
+
+  /* Make sure the cache is big enough. */
+  if (c_cache->count < count) cache_init(c_cache, count);
+
+  /* Any position in the frame is within 2 cell widths of the origin so this
+   * is further away than any smoothing length. */
+  const float pos_padded = -(4. * width + c->hydro.dx_max_part);
+  const float h_padded = c->hydro.h_max / 4.;
+
+  for (int i = 0; i < count; i++) {
+
+    const struct part *restrict p = &parts[sort == NULL ? i : sort[i].i];
+
+    /* Pad inhibited particles. */
+    if (p->time_bin >= time_bin_inhibited) {
+      cache_pad_hydro_fields(c_cache, i, pos_padded, h_padded);
+      continue;
+    }
+
+    c_cache->x[i] = (float)(p->x[0] - origin[0]);
+    c_cache->y[i] = (float)(p->x[1] - origin[1]);
+    c_cache->z[i] = (float)(p->x[2] - origin[2]);
+    cache_read_hydro_fields(c_cache, i, p);
+  }
+
+  /* Pad the cache to a multiple of the vector length. */
+  int count_align = count;
+  const int rem = count % VEC_SIZE;
+  if (rem != 0) {
+    count_align += VEC_SIZE - rem;
+    for (int i = count; i < count_align; i++)
+      cache_pad_hydro_fields(c_cache, i, pos_padded, h_padded);
+  }
+
+  return count_align;
+}
+
+#endif /* WITH_MASKED_HYDRO_VECTORIZATION */
+
 /**
  * @brief Clean the memory allocated by a #cache object.
  *
@@ -1090,6 +1274,12 @@ static INLINE void cache_clean(struct cache *c) {
     free(c->pOrho2);
     free(c->balsara);
     free(c->soundspeed);
+    free(c->u);
+    free(c->pressure);
+    free(c->pressure_floor);
+    free(c->alpha_visc);
+    free(c->alpha_diff);
+    free(c->v_sig);
   }
   c->count = 0;
 }
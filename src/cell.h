@@ -1100,6 +1100,7 @@ __attribute__((always_inline)) INLINE static void cell_free_hydro_sorts(
     swift_free("hydro.sort", c->hydro.sort);
     c->hydro.sort = NULL;
     c->hydro.sort_allocated = 0;
+    c->hydro.sort_reusable = 0;
   }
 }
 
@@ -1216,6 +1217,21 @@ __attribute__((always_inline)) INLINE static void cell_free_stars_sorts(
   }
 }
 
+/**
+ * @brief Free the #gravity_cell_cache of a cell.
+ *
+ * Does nothing unless SWIFT_GRAVITY_CELL_CACHE is defined.
+ *
+ * @param c The #cell.
+ */
+__attribute__((always_inline)) INLINE static void cell_free_grav_cache(
+    struct cell *c) {
+
+#ifdef SWIFT_GRAVITY_CELL_CACHE
+  gravity_cell_cache_free(&c->grav.cache);
+#endif
+}
+
 /**
  * @brief Returns the array of sorted indices for the star particles of a given
  * cell along agiven direction.
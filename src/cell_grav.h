@@ -25,6 +25,7 @@
 #include "../config.h"
 
 /* Local includes. */
+#include "gravity_cell_cache.h"
 #include "lock.h"
 #include "timeline.h"
 
@@ -119,6 +120,12 @@ struct cell_grav {
 
   /*! Number of M-M tasks that are associated with this cell. */
   short int nr_mm_tasks;
+
+#ifdef SWIFT_GRAVITY_CELL_CACHE
+  /*! Inputs of the gravity caches for the #gpart of this leaf, filled by the
+   * first P-P or M-P interaction of each step */
+  struct gravity_cell_cache cache;
+#endif
 };
 
 #endif /* SWIFT_CELL_GRAV_H */
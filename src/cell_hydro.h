@@ -167,6 +167,10 @@ struct cell_hydro {
   /*! Bit-mask indicating the sorted directions */
   uint16_t sort_allocated;
 
+  /*! Bit-mask indicating the sort arrays holding the order of a previous
+   * sort of the cell's particles */
+  uint16_t sort_reusable;
+
 #ifdef SWIFT_DEBUG_CHECKS
 
   /*! Last (integer) time the cell's sort arrays were updated. */
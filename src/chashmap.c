@@ -0,0 +1,360 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+/* Config parameters. */
+#include "../config.h"
+
+/* Some standard headers. */
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/* This object's header. */
+#include "chashmap.h"
+
+/* Local headers. */
+#include "align.h"
+#include "atomic.h"
+#include "error.h"
+#include "memuse.h"
+
+/*! Control byte of an empty slot */
+#define chashmap_ctrl_empty ((int8_t)-128)
+
+/*! Control byte of a slot being filled */
+#define chashmap_ctrl_busy ((int8_t)-2)
+
+/*! Maximal fraction of the slots we expect to fill */
+#define chashmap_max_load 0.875
+
+/**
+ * @brief Hash a key (finaliser of the SplitMix64 generator).
+ *
+ * @param key The key.
+ */
+__attribute__((always_inline)) INLINE static uint64_t chashmap_hash(
+    const chashmap_key_t key) {
+
+  uint64_t z = (uint64_t)key + 0x9e3779b97f4a7c15ULL;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+/**
+ * @brief Bitmasks of the slots of a group whose control byte matches a
+ * given hash, is empty or is busy.
+ *
+ * @param ctrl The control bytes of the group.
+ * @param h2 The 7 bits of the hash stored in the control bytes.
+ * @param match (return) The slots matching h2.
+ * @param empty (return) The empty slots.
+ * @param busy (return) The slots being filled.
+ */
+__attribute__((always_inline)) INLINE static void chashmap_group_match(
+    const int8_t *ctrl, const int8_t h2, unsigned int *match,
+    unsigned int *empty, unsigned int *busy) {
+
+#ifdef __SSE2__
+  const __m128i group = _mm_load_si128((const __m128i *)ctrl);
+  *match = _mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(h2)));
+  *empty = _mm_movemask_epi8(
+      _mm_cmpeq_epi8(group, _mm_set1_epi8(chashmap_ctrl_empty)));
+  *busy = _mm_movemask_epi8(
+      _mm_cmpeq_epi8(group, _mm_set1_epi8(chashmap_ctrl_busy)));
+#else
+  *match = 0;
+  *empty = 0;
+  *busy = 0;
+  for (int k = 0; k < chashmap_group_size; k++) {
+    const int8_t c = __atomic_load_n(&ctrl[k], __ATOMIC_RELAXED);
+    *match |= (unsigned int)(c == h2) << k;
+    *empty |= (unsigned int)(c == chashmap_ctrl_empty) << k;
+    *busy |= (unsigned int)(c == chashmap_ctrl_busy) << k;
+  }
+#endif
+
+  /* Make sure the keys of the matching slots are read after their control
+   * bytes. */
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief Initialises an empty #chashmap.
+ *
+ * @param m The #chashmap.
+ * @param max_elements The largest number of elements the map will hold.
+ * @param value_size The size in bytes of the values.
+ */
+void chashmap_init(struct chashmap *m, size_t max_elements,
+                   size_t value_size) {
+
+  /* Number of groups required, rounded up to a power of 2 */
+  const size_t min_slots = (size_t)(max_elements / chashmap_max_load) + 1;
+  size_t nr_groups = 1;
+  while (nr_groups * chashmap_group_size < min_slots) nr_groups *= 2;
+  const size_t nr_slots = nr_groups * chashmap_group_size;
+
+  m->nr_groups = nr_groups;
+  m->size = 0;
+  m->value_size = value_size;
+  m->value_stride = (value_size + 7) & ~(size_t)7;
+
+  if (swift_memalign("chashmap", (void **)&m->ctrl, chashmap_group_size,
+                     nr_slots * sizeof(int8_t)) != 0 ||
+      swift_memalign("chashmap", (void **)&m->keys, SWIFT_STRUCT_ALIGNMENT,
+                     nr_slots * sizeof(chashmap_key_t)) != 0 ||
+      swift_memalign("chashmap", (void **)&m->values, SWIFT_STRUCT_ALIGNMENT,
+                     nr_slots * m->value_stride) != 0)
+    error("Unable to allocate hashmap of %zu elements.", max_elements);
+
+  memset(m->ctrl, chashmap_ctrl_empty, nr_slots * sizeof(int8_t));
+}
+
+/**
+ * @brief Get the value for a given key, creating a zeroed one if the key is
+ * not in the map yet. Return a flag indicating whether a new element has
+ * been added.
+ *
+ * Can be called concurrently with any other function apart from
+ * chashmap_free(). The returned pointer remains valid until the map is
+ * freed.
+ *
+ * @param m The #chashmap.
+ * @param key The key.
+ * @param created_new_element (return) Was the element created by this call?
+ */
+void *chashmap_get_new(struct chashmap *m, chashmap_key_t key,
+                       int *created_new_element) {
+
+  const uint64_t hash = chashmap_hash(key);
+  const int8_t h2 = (int8_t)(hash & 0x7f);
+  const size_t group_mask = m->nr_groups - 1;
+  size_t group = (hash >> 7) & group_mask;
+
+  *created_new_element = 0;
+
+  for (size_t probe = 1; probe <= m->nr_groups; probe++) {
+
+    int8_t *ctrl = &m->ctrl[group * chashmap_group_size];
+    const size_t first = group * chashmap_group_size;
+
+    while (1) {
+
+      unsigned int match, empty, busy;
+      chashmap_group_match(ctrl, h2, &match, &empty, &busy);
+
+      /* Is the key already in this group? */
+      while (match) {
+        const int k = __builtin_ctz(match);
+        if (m->keys[first + k] == key)
+          return m->values + (first + k) * m->value_stride;
+        match &= match - 1;
+      }
+
+      /* Someone is filling a slot in this group, possibly with our key.
+       * Wait for them to be done. */
+      if (busy) continue;
+
+      /* Group is full, try the next one */
+      if (!empty) break;
+
+      /* Claim the first empty slot */
+      const int k = __builtin_ctz(empty);
+      int8_t expected = chashmap_ctrl_empty;
+      if (!__atomic_compare_exchange_n(&ctrl[k], &expected, chashmap_ctrl_busy,
+                                       /*weak=*/0, __ATOMIC_ACQ_REL,
+                                       __ATOMIC_RELAXED))
+        continue;
+
+      /* Fill it and publish it */
+      char *value = m->values + (first + k) * m->value_stride;
+      m->keys[first + k] = key;
+      memset(value, 0, m->value_size);
+      atomic_inc(&m->size);
+      __atomic_store_n(&ctrl[k], h2, __ATOMIC_RELEASE);
+
+      *created_new_element = 1;
+      return value;
+    }
+
+    /* Triangular probing visits all the groups */
+    group = (group + probe) & group_mask;
+  }
+
+  error("Hashmap is full (%zu elements).", m->size);
+  return NULL;
+}
+
+/**
+ * @brief Get the value for a given key, creating a zeroed one if the key is
+ * not in the map yet.
+ *
+ * Can be called concurrently with any other function apart from
+ * chashmap_free(). The returned pointer remains valid until the map is
+ * freed.
+ *
+ * @param m The #chashmap.
+ * @param key The key.
+ */
+void *chashmap_get(struct chashmap *m, chashmap_key_t key) {
+  int created_new_element;
+  return chashmap_get_new(m, key, &created_new_element);
+}
+
+/**
+ * @brief Look for the given key and return a pointer to its value or NULL if
+ * it is not in the map.
+ *
+ * @param m The #chashmap.
+ * @param key The key.
+ */
+void *chashmap_lookup(const struct chashmap *m, chashmap_key_t key) {
+
+  const uint64_t hash = chashmap_hash(key);
+  const int8_t h2 = (int8_t)(hash & 0x7f);
+  const size_t group_mask = m->nr_groups - 1;
+  size_t group = (hash >> 7) & group_mask;
+
+  for (size_t probe = 1; probe <= m->nr_groups; probe++) {
+
+    const int8_t *ctrl = &m->ctrl[group * chashmap_group_size];
+    const size_t first = group * chashmap_group_size;
+
+    unsigned int match, empty, busy;
+    do {
+      chashmap_group_match(ctrl, h2, &match, &empty, &busy);
+    } while (busy);
+
+    while (match) {
+      const int k = __builtin_ctz(match);
+      if (m->keys[first + k] == key)
+        return m->values + (first + k) * m->value_stride;
+      match &= match - 1;
+    }
+
+    /* The key would have been put in this group */
+    if (empty) return NULL;
+
+    group = (group + probe) & group_mask;
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief Call a function on all the elements of the slots of a range of
+ * groups.
+ */
+static void chashmap_iterate_groups(const struct chashmap *m,
+                                    const size_t group_begin,
+                                    const size_t group_end,
+                                    chashmap_mapper_t f, void *data) {
+
+  for (size_t i = group_begin * chashmap_group_size;
+       i < group_end * chashmap_group_size; i++)
+    if (m->ctrl[i] >= 0)
+      f(m->keys[i], m->values + i * m->value_stride, data);
+}
+
+/**
+ * @brief Iterate a function over each element in the map.
+ *
+ * @param m The #chashmap.
+ * @param f The function, taking the key, a pointer to the value and data.
+ * @param data The extra data passed to the function.
+ */
+void chashmap_iterate(const struct chashmap *m, chashmap_mapper_t f,
+                      void *data) {
+
+  chashmap_iterate_groups(m, 0, m->nr_groups, f, data);
+}
+
+/*! Arguments of chashmap_iterate_mapper() */
+struct chashmap_iterate_data {
+  const struct chashmap *m;
+  chashmap_mapper_t f;
+  void *data;
+};
+
+/**
+ * @brief #threadpool mapper function iterating over a range of groups.
+ *
+ * @param map_data The control bytes of the first group.
+ * @param num_elements The number of groups.
+ * @param extra_data Pointer to a #chashmap_iterate_data.
+ */
+static void chashmap_iterate_mapper(void *map_data, int num_elements,
+                                    void *extra_data) {
+
+  const struct chashmap_iterate_data *it =
+      (const struct chashmap_iterate_data *)extra_data;
+  const size_t group_begin =
+      ((int8_t *)map_data - it->m->ctrl) / chashmap_group_size;
+
+  chashmap_iterate_groups(it->m, group_begin, group_begin + num_elements,
+                          it->f, it->data);
+}
+
+/**
+ * @brief Iterate a function over each element in the map using the threads
+ * of a #threadpool.
+ *
+ * The function is called concurrently and in no particular order.
+ *
+ * @param m The #chashmap.
+ * @param tp The #threadpool.
+ * @param f The function, taking the key, a pointer to the value and data.
+ * @param data The extra data passed to the function.
+ */
+void chashmap_iterate_parallel(const struct chashmap *m,
+                               struct threadpool *tp, chashmap_mapper_t f,
+                               void *data) {
+
+  struct chashmap_iterate_data it = {m, f, data};
+  threadpool_map(tp, chashmap_iterate_mapper, m->ctrl, m->nr_groups,
+                 chashmap_group_size * sizeof(int8_t),
+                 threadpool_auto_chunk_size, &it);
+}
+
+/**
+ * @brief Get the number of elements in a map.
+ *
+ * @param m The #chashmap.
+ */
+size_t chashmap_size(const struct chashmap *m) { return m->size; }
+
+/**
+ * @brief De-allocate the memory of a map.
+ *
+ * @param m The #chashmap.
+ */
+void chashmap_free(struct chashmap *m) {
+
+  swift_free("chashmap", m->ctrl);
+  swift_free("chashmap", m->keys);
+  swift_free("chashmap", m->values);
+  m->ctrl = NULL;
+  m->keys = NULL;
+  m->values = NULL;
+  m->nr_groups = 0;
+  m->size = 0;
+}
@@ -0,0 +1,102 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+/*
+ * Concurrent open-addressing hashmap.
+ *
+ * The slots are organised in groups of 16, each with one control byte per
+ * slot that is either empty, busy (being filled) or holds 7 bits of the hash
+ * of the key stored in it. A look-up compares the control bytes of a whole
+ * group at once (using SSE2 when available) and only looks at the keys of
+ * the slots whose hash bits match, moving to the next group along a
+ * triangular sequence if the group is full.
+ *
+ * Slots are claimed with an atomic compare-and-swap of their control byte,
+ * such that any number of threads can insert and look up keys
+ * concurrently. The values are stored in place and can then be updated
+ * using atomic operations. Elements cannot be removed and the map does not
+ * grow, so it must be created with the maximal number of elements it will
+ * have to hold.
+ */
+#ifndef SWIFT_CHASHMAP_H
+#define SWIFT_CHASHMAP_H
+
+/* Config parameters. */
+#include "../config.h"
+
+/* Some standard headers. */
+#include <stddef.h>
+#include <stdint.h>
+
+/* Local headers. */
+#include "threadpool.h"
+
+/*! Number of slots in a group */
+#define chashmap_group_size 16
+
+/*! Type used for the keys */
+typedef size_t chashmap_key_t;
+
+/**
+ * @brief A concurrent open-addressing hashmap.
+ */
+struct chashmap {
+
+  /*! Control byte of each slot */
+  int8_t *ctrl;
+
+  /*! Key of each slot */
+  chashmap_key_t *keys;
+
+  /*! Value of each slot */
+  char *values;
+
+  /*! Size in bytes of the values */
+  size_t value_size;
+
+  /*! Distance in bytes between two values */
+  size_t value_stride;
+
+  /*! Number of groups of slots (a power of 2) */
+  size_t nr_groups;
+
+  /*! Number of elements in the map */
+  size_t size;
+};
+
+/**
+ * @brief Function called on every element of a #chashmap. It receives the
+ * key, a pointer to the value and the extra data.
+ */
+typedef void (*chashmap_mapper_t)(chashmap_key_t key, void *value,
+                                  void *data);
+
+void chashmap_init(struct chashmap *m, size_t max_elements, size_t value_size);
+void *chashmap_get(struct chashmap *m, chashmap_key_t key);
+void *chashmap_get_new(struct chashmap *m, chashmap_key_t key,
+                       int *created_new_element);
+void *chashmap_lookup(const struct chashmap *m, chashmap_key_t key);
+void chashmap_iterate(const struct chashmap *m, chashmap_mapper_t f,
+                      void *data);
+void chashmap_iterate_parallel(const struct chashmap *m,
+                               struct threadpool *tp, chashmap_mapper_t f,
+                               void *data);
+size_t chashmap_size(const struct chashmap *m);
+void chashmap_free(struct chashmap *m);
+
+#endif /* SWIFT_CHASHMAP_H */
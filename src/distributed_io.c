@@ -48,6 +48,7 @@
 #include "gravity_properties.h"
 #include "hydro_io.h"
 #include "hydro_properties.h"
+#include "io_async.h"
 #include "io_properties.h"
 #include "memuse.h"
 #include "output_list.h"
@@ -65,41 +66,23 @@
 #include "xmf.h"
 
 /**
- * @brief Writes a data array in given HDF5 group.
+ * @brief Writes a data array already converted to the snapshot units in given
+ * HDF5 group.
  *
- * @param e The #engine we are writing from.
  * @param grp The group in which to write.
- * @param fileName The name of the file in which the data is written
- * @param partTypeGroupName The name of the group containing the particles in
- * the HDF5 file.
- * @param props The #io_props of the field to read
+ * @param props The #io_props of the field to write.
  * @param N The number of particles to write.
- * @param internal_units The #unit_system used internally
+ * @param lossy_compression The lossy compression scheme to apply.
+ * @param compression The level of GZIP compression to apply.
+ * @param a The current scale-factor.
  * @param snapshot_units The #unit_system used in the snapshots
- *
- * @todo A better version using HDF5 hyper-slabs to write the file directly from
- * the part array will be written once the structures have been stabilized.
+ * @param temp The buffer containing the converted data.
  */
-void write_distributed_array(
-    const struct engine* e, hid_t grp, const char* fileName,
-    const char* partTypeGroupName, const struct io_props props, const size_t N,
+static void write_distributed_array_buffer(
+    hid_t grp, const struct io_props props, const size_t N,
     const enum lossy_compression_schemes lossy_compression,
-    const struct unit_system* internal_units,
-    const struct unit_system* snapshot_units) {
-
-  const size_t typeSize = io_sizeof_type(props.type);
-  const size_t num_elements = N * props.dimension;
-
-  /* message("Writing '%s' array...", props.name); */
-
-  /* Allocate temporary buffer */
-  void* temp = NULL;
-  if (swift_memalign("writebuff", (void**)&temp, IO_BUFFER_ALIGNMENT,
-                     num_elements * typeSize) != 0)
-    error("Unable to allocate temporary i/o buffer");
-
-  /* Copy the particle data to the temporary buffer */
-  io_copy_temp_buffer(temp, e, props, N, internal_units, snapshot_units);
+    const int compression, const double a,
+    const struct unit_system* snapshot_units, const void* temp) {
 
   /* Create data space */
   hid_t h_space;
@@ -161,13 +144,13 @@ void write_distributed_array(
                                  props.name);
 
     /* Impose GZIP data compression */
-    if (e->snapshot_compression > 0) {
+    if (compression > 0) {
       h_err = H5Pset_shuffle(h_prop);
       if (h_err < 0)
         error("Error while setting shuffling options for field '%s'.",
               props.name);
 
-      h_err = H5Pset_deflate(h_prop, e->snapshot_compression);
+      h_err = H5Pset_deflate(h_prop, compression);
       if (h_err < 0)
         error("Error while setting compression options for field '%s'.",
               props.name);
@@ -214,7 +197,7 @@ void write_distributed_array(
   io_write_attribute_d(
       h_data,
       "Conversion factor to physical CGS (including cosmological corrections)",
-      factor * pow(e->cosmology->a, props.scale_factor_exponent));
+      factor * pow(a, props.scale_factor_exponent));
 
 #ifdef SWIFT_DEBUG_CHECKS
   if (strlen(props.description) == 0)
@@ -224,14 +207,91 @@ void write_distributed_array(
   /* Write the full description */
   io_write_attribute_s(h_data, "Description", props.description);
 
-  /* Free and close everything */
-  swift_free("writebuff", temp);
+  /* Close everything */
   H5Tclose(h_type);
   H5Pclose(h_prop);
   H5Dclose(h_data);
   H5Sclose(h_space);
 }
 
+/**
+ * @brief Writes a data array in given HDF5 group.
+ *
+ * @param e The #engine we are writing from.
+ * @param grp The group in which to write.
+ * @param fileName The name of the file in which the data is written
+ * @param partTypeGroupName The name of the group containing the particles in
+ * the HDF5 file.
+ * @param props The #io_props of the field to read
+ * @param N The number of particles to write.
+ * @param internal_units The #unit_system used internally
+ * @param snapshot_units The #unit_system used in the snapshots
+ *
+ * @todo A better version using HDF5 hyper-slabs to write the file directly from
+ * the part array will be written once the structures have been stabilized.
+ */
+void write_distributed_array(
+    const struct engine* e, hid_t grp, const char* fileName,
+    const char* partTypeGroupName, const struct io_props props, const size_t N,
+    const enum lossy_compression_schemes lossy_compression,
+    const struct unit_system* internal_units,
+    const struct unit_system* snapshot_units) {
+
+  const size_t typeSize = io_sizeof_type(props.type);
+  const size_t num_elements = N * props.dimension;
+
+  /* message("Writing '%s' array...", props.name); */
+
+  /* Allocate temporary buffer */
+  void* temp = NULL;
+  if (swift_memalign("writebuff", (void**)&temp, IO_BUFFER_ALIGNMENT,
+                     num_elements * typeSize) != 0)
+    error("Unable to allocate temporary i/o buffer");
+
+  /* Copy the particle data to the temporary buffer */
+  io_copy_temp_buffer(temp, e, props, N, internal_units, snapshot_units);
+
+  /* Write it to the file */
+  write_distributed_array_buffer(grp, props, N, lossy_compression,
+                                 e->snapshot_compression, e->cosmology->a,
+                                 snapshot_units, temp);
+
+  /* Free everything */
+  swift_free("writebuff", temp);
+}
+
+/**
+ * @brief Executes a job of the asynchronous snapshot writer.
+ *
+ * The groups and the file are created by write_output_distributed() and
+ * closed here once all their datasets are written.
+ *
+ * @param job The #io_async_job to execute.
+ * @param snap The #io_async_snapshot being written.
+ */
+static void distributed_io_async_write_job(struct io_async_job* job,
+                                           struct io_async_snapshot* snap) {
+
+  switch (job->type) {
+    case io_async_file_begin:
+    case io_async_group_begin:
+      break;
+    case io_async_dataset:
+      write_distributed_array_buffer(job->h_grp, job->props, job->N,
+                                     job->lossy_compression, snap->compression,
+                                     snap->a, &snap->snapshot_units,
+                                     job->buffer);
+      break;
+    case io_async_group_end:
+      io_write_attribute_i(job->h_grp, "NumberOfFields", job->num_fields);
+      H5Gclose(job->h_grp);
+      break;
+    case io_async_file_end:
+      H5Fclose(snap->h_file);
+      break;
+  }
+}
+
 /**
  * @brief Writes a snapshot distributed into multiple files.
  *
@@ -247,6 +307,11 @@ void write_distributed_array(
  * Writes the particles contained in the engine.
  * If such files already exist, it is erased and replaced by the new one.
  * The companion XMF file is also updated accordingly.
+ *
+ * In asynchronous mode, the particle fields are converted here but written
+ * by a separate thread on each rank such that this function can return
+ * before the files are complete. io_async_wait() must be called before any
+ * use of the files.
  */
 void write_output_distributed(struct engine* e,
                               const struct unit_system* internal_units,
@@ -276,6 +341,10 @@ void write_output_distributed(struct engine* e,
 #else
   const int with_stf = 0;
 #endif
+  const int async = e->snapshot_async;
+
+  /* Make sure the previous snapshot is complete */
+  io_async_wait();
 
   /* Number of particles currently in the arrays */
   const size_t Ntot = e->s->nr_gparts;
@@ -463,6 +532,11 @@ void write_output_distributed(struct engine* e,
                         internal_units, snapshot_units);
   H5Gclose(h_grp);
 
+  /* The particle data will be written by the writer thread */
+  if (async)
+    io_async_begin(e, h_file, fileName, /*xmfFileName=*/NULL, snapshot_units,
+                   distributed_io_async_write_job);
+
   /* Loop over all particle types */
   for (int ptype = 0; ptype < swift_type_count; ptype++) {
 
@@ -813,16 +887,19 @@ void write_output_distributed(struct engine* e,
               (enum part_type)ptype, compression_level_current_default);
 
       if (compression_level != compression_do_not_write) {
-        write_distributed_array(e, h_grp, fileName, partTypeGroupName, list[i],
-                                Nparticles, compression_level, internal_units,
-                                snapshot_units);
+        if (async)
+          io_async_push_dataset(e, h_grp, (enum part_type)ptype,
+                                partTypeGroupName, list[i], Nparticles,
+                                N[ptype], /*offset=*/0, compression_level,
+                                internal_units, snapshot_units);
+        else
+          write_distributed_array(e, h_grp, fileName, partTypeGroupName,
+                                  list[i], Nparticles, compression_level,
+                                  internal_units, snapshot_units);
         num_fields_written++;
       }
     }
 
-    /* Only write this now that we know exactly how many fields there are. */
-    io_write_attribute_i(h_grp, "NumberOfFields", num_fields_written);
-
     /* Free temporary arrays */
     if (parts_written) swift_free("parts_written", parts_written);
     if (xparts_written) swift_free("xparts_written", xparts_written);
@@ -833,14 +910,33 @@ void write_output_distributed(struct engine* e,
     if (sparts_written) swift_free("sparts_written", sparts_written);
     if (bparts_written) swift_free("bparts_written", bparts_written);
 
-    /* Close particle group */
-    H5Gclose(h_grp);
+    if (async) {
+
+      /* Let the writer close the group once all its fields are written */
+      struct io_async_job* job =
+          io_async_new_job(io_async_group_end, h_grp, (enum part_type)ptype,
+                           partTypeGroupName, Nparticles, N[ptype]);
+      job->num_fields = num_fields_written;
+      io_async_push(job);
+
+    } else {
+
+      /* Only write this now that we know exactly how many fields there are. */
+      io_write_attribute_i(h_grp, "NumberOfFields", num_fields_written);
+
+      /* Close particle group */
+      H5Gclose(h_grp);
+    }
   }
 
   /* message("Done writing particles..."); */
 
-  /* Close file */
-  H5Fclose(h_file);
+  /* Close file (or let the writer do it) */
+  if (async)
+    io_async_push(io_async_new_job(io_async_file_end, h_file, swift_type_gas,
+                                   /*partTypeGroupName=*/NULL, 0, 0));
+  else
+    H5Fclose(h_file);
 
   e->snapshot_output_count++;
   if (e->snapshot_invoke_stf) e->stf_output_count++;
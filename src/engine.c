@@ -167,7 +167,7 @@ void engine_addlink(struct engine *e, struct link **l, struct task *t) {
  */
 void engine_repartition(struct engine *e) {
 
-#if defined(WITH_MPI) && (defined(HAVE_PARMETIS) || defined(HAVE_METIS))
+#if defined(WITH_MPI)
 
   ticks tic = getticks();
 
@@ -194,9 +194,14 @@ void engine_repartition(struct engine *e) {
                     /* header = */ 1, /* allranks = */ 1);
   }
 
-  /* Do the repartitioning. */
-  partition_repartition(e->reparttype, e->nodeID, e->nr_nodes, e->s,
-                        e->sched.tasks, e->sched.nr_tasks);
+  /* Do the repartitioning. If the current partition has been kept there are
+   * no particles to move, but the tasks have not been unskipped, so we still
+   * need a rebuild. */
+  if (!partition_repartition(e->reparttype, e->nodeID, e->nr_nodes, e->s,
+                             e->sched.tasks, e->sched.nr_tasks)) {
+    e->forcerebuild = 1;
+    return;
+  }
 
   /* Partitioning requires copies of the particles, so we need to reduce the
    * memory in use to the minimum, we can free the sorting indices and the
@@ -239,7 +244,7 @@ void engine_repartition(struct engine *e) {
             clocks_getunit());
 #else
   if (e->reparttype->type != REPART_NONE)
-    error("SWIFT was not compiled with MPI and METIS or ParMETIS support.");
+    error("SWIFT was not compiled with MPI support.");
 
   /* Clear the repartition flag. */
   e->forcerepart = 0;
@@ -465,10 +470,259 @@ void engine_exchange_cells(struct engine *e) {
 #endif
 }
 
+#ifdef WITH_MPI
+/**
+ * @brief Sends the local top-level multipoles to the nodes owning a cell
+ * close enough to them to need them for the long-range gravity task, and
+ * receives the multipoles of their cells close enough to ours.
+ *
+ * With periodic boundary conditions, the long-range task only interacts the
+ * top-level cells that are within the cut-off radius of the mesh forces.
+ * Every other foreign multipole is left zeroed, which cuts the volume of
+ * data exchanged from the whole top-level grid to the neighbourhood of the
+ * domain of each node. The cells in range of each other are found from the
+ * cell positions and owners only, such that the two sides of a pair of nodes
+ * agree on what is sent without any extra communication.
+ *
+ * In builds with consistency checks, the mass and particle count of all the
+ * top-level cells are still gathered everywhere as the checks rely on them.
+ *
+ * @param e The #engine.
+ */
+static void engine_exchange_top_multipoles_sparse(struct engine *e) {
+
+  struct space *s = e->s;
+  struct cell *cells = s->cells_top;
+  struct gravity_tensors *multipoles = s->multipoles_top;
+  const int nr_cells = s->nr_cells;
+  const int nr_nodes = e->nr_nodes;
+  const int nodeID = e->nodeID;
+  const int periodic = e->mesh->periodic;
+  const int *cdim = s->cdim;
+  const double dim[3] = {s->dim[0], s->dim[1], s->dim[2]};
+  const double max_distance = e->mesh->r_cut_max;
+  const double max_distance2 = max_distance * max_distance;
+
+  /* How many cells away can we find a cell within the cut-off radius? */
+  int delta_m[3], delta_p[3];
+  for (int d = 0; d < 3; d++) {
+    const int delta = (int)(max_distance / s->width[d]) + 1;
+
+    /* Special case where every cell is in range of every other one */
+    if (periodic && 2 * delta + 1 >= cdim[d]) {
+      delta_m[d] = cdim[d] / 2;
+      delta_p[d] = cdim[d] - 1 - cdim[d] / 2;
+    } else {
+      delta_m[d] = min(delta, cdim[d] - 1);
+      delta_p[d] = min(delta, cdim[d] - 1);
+    }
+  }
+
+  /* Foreign cells we need and (node, cell) pairs of what we send */
+  char *needed = (char *)calloc(nr_cells, sizeof(char));
+  int *last_sent = (int *)malloc(nr_nodes * sizeof(int));
+  int *send_counts = (int *)malloc(nr_nodes * sizeof(int));
+  int *recv_counts = (int *)malloc(nr_nodes * sizeof(int));
+  if (needed == NULL || last_sent == NULL || send_counts == NULL ||
+      recv_counts == NULL)
+    error("Failed to allocate the top-level multipole exchange lists.");
+  for (int k = 0; k < nr_nodes; k++) {
+    last_sent[k] = -1;
+    send_counts[k] = 0;
+    recv_counts[k] = 0;
+  }
+
+  size_t size_pairs = 2 * (size_t)s->nr_local_cells + 1;
+  size_t nr_pairs = 0;
+  int *pairs = (int *)malloc(2 * size_pairs * sizeof(int));
+  if (pairs == NULL) error("Failed to allocate the multipole send list.");
+
+  /* Walk the neighbourhood of all our cells. The outer loop runs in
+   * increasing cell index, which is the order of the messages. */
+  for (int cid = 0; cid < nr_cells; cid++) {
+
+    if (cells[cid].nodeID != nodeID) continue;
+
+    const int i = cid / (cdim[1] * cdim[2]);
+    const int j = (cid / cdim[2]) % cdim[1];
+    const int k = cid % cdim[2];
+
+    for (int ii = -delta_m[0]; ii <= delta_p[0]; ii++) {
+      int iii = i + ii;
+      if (!periodic && (iii < 0 || iii >= cdim[0])) continue;
+      iii = (iii + cdim[0]) % cdim[0];
+      for (int jj = -delta_m[1]; jj <= delta_p[1]; jj++) {
+        int jjj = j + jj;
+        if (!periodic && (jjj < 0 || jjj >= cdim[1])) continue;
+        jjj = (jjj + cdim[1]) % cdim[1];
+        for (int kk = -delta_m[2]; kk <= delta_p[2]; kk++) {
+          int kkk = k + kk;
+          if (!periodic && (kkk < 0 || kkk >= cdim[2])) continue;
+          kkk = (kkk + cdim[2]) % cdim[2];
+
+          const int cjd = cell_getid(cdim, iii, jjj, kkk);
+          const int node = cells[cjd].nodeID;
+
+          if (node == nodeID) continue;
+
+          /* Same criterion as in runner_do_grav_long_range() */
+          const double min_radius2 =
+              cell_min_dist2_same_size(&cells[cid], &cells[cjd], periodic, dim);
+          if (min_radius2 > max_distance2) continue;
+
+          /* We need their multipole */
+          needed[cjd] = 1;
+
+          /* And they need ours (only once per node) */
+          if (last_sent[node] == cid) continue;
+          last_sent[node] = cid;
+
+          if (nr_pairs == size_pairs) {
+            size_pairs *= 2;
+            pairs = (int *)realloc(pairs, 2 * size_pairs * sizeof(int));
+            if (pairs == NULL)
+              error("Failed to re-allocate the multipole send list.");
+          }
+          pairs[2 * nr_pairs + 0] = node;
+          pairs[2 * nr_pairs + 1] = cid;
+          nr_pairs++;
+          send_counts[node]++;
+        }
+      }
+    }
+  }
+
+  /* Count what we receive from whom */
+  size_t nr_recv = 0;
+  for (int cid = 0; cid < nr_cells; cid++) {
+    if (needed[cid]) {
+      recv_counts[cells[cid].nodeID]++;
+      nr_recv++;
+    }
+  }
+
+  /* Offsets of the messages in the buffers */
+  int *send_offsets = (int *)malloc(nr_nodes * sizeof(int));
+  int *recv_offsets = (int *)malloc(nr_nodes * sizeof(int));
+  if (send_offsets == NULL || recv_offsets == NULL)
+    error("Failed to allocate the multipole exchange offsets.");
+  send_offsets[0] = 0;
+  recv_offsets[0] = 0;
+  for (int k = 1; k < nr_nodes; k++) {
+    send_offsets[k] = send_offsets[k - 1] + send_counts[k - 1];
+    recv_offsets[k] = recv_offsets[k - 1] + recv_counts[k - 1];
+  }
+
+  struct gravity_tensors *buffer_send = NULL;
+  struct gravity_tensors *buffer_recv = NULL;
+  if (swift_memalign("send_gravity_tensors", (void **)&buffer_send,
+                     SWIFT_CACHE_ALIGNMENT,
+                     (nr_pairs + 1) * sizeof(struct gravity_tensors)) != 0 ||
+      swift_memalign("recv_gravity_tensors", (void **)&buffer_recv,
+                     SWIFT_CACHE_ALIGNMENT,
+                     (nr_recv + 1) * sizeof(struct gravity_tensors)) != 0)
+    error("Unable to allocate memory for multipole transactions");
+
+  /* Pack the multipoles we send, grouped by node */
+  for (int k = 0; k < nr_nodes; k++) last_sent[k] = send_offsets[k];
+  for (size_t n = 0; n < nr_pairs; n++) {
+    const int node = pairs[2 * n + 0];
+    const int cid = pairs[2 * n + 1];
+    memcpy(&buffer_send[last_sent[node]++], &multipoles[cid],
+           sizeof(struct gravity_tensors));
+  }
+  free(pairs);
+
+  /* Post all the messages */
+  MPI_Request *requests =
+      (MPI_Request *)malloc(2 * nr_nodes * sizeof(MPI_Request));
+  if (requests == NULL) error("Unable to allocate memory for MPI requests");
+  int nr_requests = 0;
+  for (int k = 0; k < nr_nodes; k++) {
+    if (recv_counts[k] > 0) {
+      int err = MPI_Irecv(&buffer_recv[recv_offsets[k]], recv_counts[k],
+                          multipole_mpi_type, k, engine_top_multipoles_tag,
+                          MPI_COMM_WORLD, &requests[nr_requests++]);
+      if (err != MPI_SUCCESS)
+        mpi_error(err, "Failed to receive the top-level multipoles.");
+    }
+    if (send_counts[k] > 0) {
+      int err = MPI_Isend(&buffer_send[send_offsets[k]], send_counts[k],
+                          multipole_mpi_type, k, engine_top_multipoles_tag,
+                          MPI_COMM_WORLD, &requests[nr_requests++]);
+      if (err != MPI_SUCCESS)
+        mpi_error(err, "Failed to send the top-level multipoles.");
+    }
+  }
+
+  /* While this is in flight, gather the summary the checks need */
+#if defined(SWIFT_DEBUG_CHECKS) || defined(SWIFT_GRAVITY_FORCE_CHECKS)
+  float *masses = (float *)calloc(nr_cells, sizeof(float));
+  long long *counts = (long long *)calloc(nr_cells, sizeof(long long));
+  if (masses == NULL || counts == NULL)
+    error("Failed to allocate the top-level multipole summary.");
+  for (int cid = 0; cid < nr_cells; cid++) {
+    if (cells[cid].nodeID == nodeID) {
+      masses[cid] = multipoles[cid].m_pole.M_000;
+      counts[cid] = multipoles[cid].m_pole.num_gpart;
+    }
+  }
+  int err = MPI_Allreduce(MPI_IN_PLACE, masses, nr_cells, MPI_FLOAT, MPI_SUM,
+                          MPI_COMM_WORLD);
+  if (err != MPI_SUCCESS)
+    mpi_error(err, "Failed to all-reduce the top-level masses.");
+  err = MPI_Allreduce(MPI_IN_PLACE, counts, nr_cells, MPI_LONG_LONG_INT,
+                      MPI_SUM, MPI_COMM_WORLD);
+  if (err != MPI_SUCCESS)
+    mpi_error(err, "Failed to all-reduce the top-level particle counts.");
+  for (int cid = 0; cid < nr_cells; cid++) {
+    if (cells[cid].nodeID != nodeID && !needed[cid]) {
+      multipoles[cid].m_pole.M_000 = masses[cid];
+      multipoles[cid].m_pole.num_gpart = counts[cid];
+    }
+  }
+  free(masses);
+  free(counts);
+#endif
+
+  if (MPI_Waitall(nr_requests, requests, MPI_STATUSES_IGNORE) != MPI_SUCCESS)
+    error("Failed during waitall for the top-level multipoles.");
+
+  /* Unpack the multipoles we received. They come in increasing cell index
+   * from each node. */
+  for (int k = 0; k < nr_nodes; k++) last_sent[k] = recv_offsets[k];
+  for (int cid = 0; cid < nr_cells; cid++) {
+    if (needed[cid]) {
+      const int node = cells[cid].nodeID;
+      memcpy(&multipoles[cid], &buffer_recv[last_sent[node]++],
+             sizeof(struct gravity_tensors));
+    }
+  }
+
+  if (e->verbose)
+    message("Exchanged %zu multipoles out and %zu in (%d top-level cells).",
+            nr_pairs, nr_recv, nr_cells);
+
+  swift_free("send_gravity_tensors", buffer_send);
+  swift_free("recv_gravity_tensors", buffer_recv);
+  free(requests);
+  free(send_offsets);
+  free(recv_offsets);
+  free(needed);
+  free(last_sent);
+  free(send_counts);
+  free(recv_counts);
+}
+#endif /* WITH_MPI */
+
 /**
  * @brief Exchanges the top-level multipoles between all the nodes
  * such that every node has a multipole for each top-level cell.
  *
+ * With periodic boundary conditions, only the multipoles of the cells within
+ * the cut-off radius of the mesh forces of a local cell are exchanged (see
+ * engine_exchange_top_multipoles_sparse()).
+ *
  * @param e The #engine.
  */
 void engine_exchange_top_multipoles(struct engine *e) {
@@ -501,18 +755,26 @@ void engine_exchange_top_multipoles(struct engine *e) {
 #endif
 
   /* Each node (space) has constructed its own top-level multipoles.
-   * We now need to make sure every other node has a copy of everything.
-   *
-   * We use our home-made reduction operation that simply performs a XOR
-   * operation on the multipoles. Since only local multipoles are non-zero and
-   * each multipole is only present once, the bit-by-bit XOR will
-   * create the desired result.
-   */
-  int err = MPI_Allreduce(MPI_IN_PLACE, e->s->multipoles_top, e->s->nr_cells,
-                          multipole_mpi_type, multipole_mpi_reduce_op,
-                          MPI_COMM_WORLD);
-  if (err != MPI_SUCCESS)
-    mpi_error(err, "Failed to all-reduce the top-level multipoles.");
+   * We now need to make sure every other node has a copy of the ones it
+   * needs. */
+  if (e->mesh->periodic) {
+
+    /* With periodic BCs, only the cells within the cut-off radius of the
+     * mesh forces are needed. */
+    engine_exchange_top_multipoles_sparse(e);
+
+  } else {
+
+    /* We need everything. We use our home-made reduction operation that
+     * simply performs a XOR operation on the multipoles. Since only local
+     * multipoles are non-zero and each multipole is only present once, the
+     * bit-by-bit XOR will create the desired result. */
+    int err = MPI_Allreduce(MPI_IN_PLACE, e->s->multipoles_top,
+                            e->s->nr_cells, multipole_mpi_type,
+                            multipole_mpi_reduce_op, MPI_COMM_WORLD);
+    if (err != MPI_SUCCESS)
+      mpi_error(err, "Failed to all-reduce the top-level multipoles.");
+  }
 
 #ifdef SWIFT_DEBUG_CHECKS
   long long counter = 0;
@@ -1142,6 +1404,24 @@ int engine_estimate_nr_tasks(const struct engine *e) {
   return (int)(ncells * tasks_per_cell);
 }
 
+#ifdef SWIFT_GRAVITY_CELL_CACHE
+/**
+ * @brief Recursively adds up the memory used by the #gravity_cell_cache of a
+ * cell hierarchy.
+ *
+ * @param c The #cell.
+ */
+static size_t engine_gravity_cell_caches_memory(const struct cell *c) {
+
+  size_t bytes = gravity_cell_cache_memory(&c->grav.cache);
+  if (c->split)
+    for (int k = 0; k < 8; k++)
+      if (c->progeny[k] != NULL)
+        bytes += engine_gravity_cell_caches_memory(c->progeny[k]);
+  return bytes;
+}
+#endif
+
 /**
  * @brief Rebuild the space and tasks.
  *
@@ -1166,6 +1446,18 @@ void engine_rebuild(struct engine *e, const int repartitioned,
   /* Give some breathing space */
   scheduler_free_tasks(&e->sched);
 
+#ifdef SWIFT_GRAVITY_CELL_CACHE
+  /* Report the memory used by the gravity caches of the cells before the
+   * rebuild drops them */
+  if (e->verbose) {
+    size_t cache_bytes = 0;
+    for (int k = 0; k < e->s->nr_cells; k++)
+      cache_bytes += engine_gravity_cell_caches_memory(&e->s->cells_top[k]);
+    message("Gravity caches of the cells used %zd MB.",
+            cache_bytes / (1024 * 1024));
+  }
+#endif
+
   /* Re-build the space. */
   space_rebuild(e->s, repartitioned, e->verbose);
 
@@ -1280,6 +1572,10 @@ void engine_rebuild(struct engine *e, const int repartitioned,
   /* Make the list of top-level cells that have tasks */
   space_list_useful_top_level_cells(e->s);
 
+  /* Make the lists of M-M interactions of the long-range gravity tasks */
+  if (e->policy & engine_policy_self_gravity)
+    engine_make_grav_long_range_lists(e);
+
 #ifdef SWIFT_DEBUG_CHECKS
   /* Check that all cells have been drifted to the current time.
    * That can include cells that have not
@@ -1382,7 +1678,7 @@ int engine_prepare(struct engine *e) {
 
     /* And repartition */
     engine_repartition(e);
-    repartitioned = 1;
+    repartitioned = (e->step_props & engine_step_prop_repartition) != 0;
 
     /* Reallocate the mesh */
     if ((e->policy & engine_policy_self_gravity) && e->s->periodic)
@@ -1629,6 +1925,9 @@ void engine_launch(struct engine *e, const char *call) {
   /* Sit back and wait for the runners to come home. */
   swift_barrier_wait(&e->wait_barrier);
 
+  /* Feed the measured task costs back into the scheduler's weights */
+  scheduler_update_costs(&e->sched, tic);
+
   /* Store the wallclock time */
   e->sched.total_ticks += getticks() - tic;
 
@@ -1980,6 +2279,44 @@ void engine_init_particles(struct engine *e, int flag_entropy_ICs,
  *
  * @param e The #engine.
  */
+/**
+ * @brief Prints the largest scratch memory used by the tasks of each runner
+ * since the last call and starts counting again.
+ *
+ * @param e The #engine.
+ */
+static void engine_report_runner_arenas(struct engine *e) {
+
+  size_t max_high_water = 0, total_high_water = 0, total_size = 0;
+  int max_runner = 0;
+
+#ifdef WITH_MPI
+  printf("[%04i] %s engine_report_runner_arenas: high-water marks are [",
+         e->nodeID, clocks_get_timesincestart());
+#else
+  printf("%s engine_report_runner_arenas: high-water marks are [",
+         clocks_get_timesincestart());
+#endif
+  for (int k = 0; k < e->nr_threads; k++) {
+    const size_t high_water =
+        runner_arena_step_high_water(&e->runners[k].arena);
+    if (high_water > max_high_water) {
+      max_high_water = high_water;
+      max_runner = k;
+    }
+    total_high_water += high_water;
+    total_size += e->runners[k].arena.size;
+    printf(" %i=%zu", k, high_water);
+  }
+  printf(" ] bytes\n");
+  fflush(stdout);
+
+  message(
+      "Largest high-water mark: %zu bytes (runner %i), %zu bytes in total for "
+      "%zu bytes allocated.",
+      max_high_water, max_runner, total_high_water, total_size);
+}
+
 void engine_step(struct engine *e) {
 
   TIMER_TIC2;
@@ -2024,15 +2361,20 @@ void engine_step(struct engine *e) {
 #endif
     }
 
-    if (!e->restarting)
+    if (!e->restarting) {
       fprintf(
           e->file_timesteps,
           "  %6d %14e %12.7f %12.7f %14e %4d %4d %12lld %12lld %12lld %12lld "
-          "%12lld %21.3f %6d\n",
+          "%12lld %21.3f %6d",
           e->step, e->time, e->cosmology->a, e->cosmology->z, e->time_step,
           e->min_active_bin, e->max_active_bin, e->updates, e->g_updates,
           e->s_updates, e->sink_updates, e->b_updates, e->wallclock_time,
           e->step_props);
+
+      if (e->step_analysis)
+        task_write_step_summary(e->file_timesteps, &e->step_summary);
+      fprintf(e->file_timesteps, "\n");
+    }
 #ifdef SWIFT_DEBUG_CHECKS
     fflush(e->file_timesteps);
 #endif
@@ -2125,10 +2467,15 @@ void engine_step(struct engine *e) {
   /* Are we reconstructing the multipoles or drifting them ?*/
   if ((e->policy & engine_policy_self_gravity) && !e->forcerebuild) {
 
-    if (e->policy & engine_policy_reconstruct_mpoles)
+    if (e->policy & engine_policy_reconstruct_mpoles) {
       engine_reconstruct_multipoles(e);
-    else
+
+      /* The rebuild-time sizes and positions of the multipoles were reset,
+       * so the lists of M-M interactions must follow. */
+      engine_make_grav_long_range_lists(e);
+    } else {
       engine_drift_top_multipoles(e);
+    }
   }
 
 #ifdef WITH_MPI
@@ -2219,6 +2566,14 @@ void engine_step(struct engine *e) {
   clocks_get_cputimes_used(&start_usertime, &start_systime);
 #endif
 
+  /* Reset the time the runners spend on the tasks. */
+  if (e->step_analysis) {
+    for (int k = 0; k < e->nr_threads; k++) {
+      e->runners[k].busy_ticks = 0;
+      e->runners[k].last_toc = 0;
+    }
+  }
+
   /* Start all the tasks. */
   TIMER_TIC;
   engine_launch(e, "tasks");
@@ -2233,6 +2588,19 @@ void engine_step(struct engine *e) {
   e->systime_last_step = end_systime - start_systime;
 #endif
 
+  /* Find the critical path and idle time of the tasks of this step. */
+  if (e->step_analysis) task_analyse_step(e);
+
+  /* Gather the sampled task costs and write them from time to time. */
+  if (e->profiler.every > 0) {
+    task_profiler_collect(&e->profiler, e->runners, e->nr_threads);
+    if (e->step % e->profiler.write_steps == 0)
+      task_profiler_write(&e->profiler, e->step, e->nodeID);
+  }
+
+  /* Report the scratch memory used by the tasks of this step. */
+  if (e->verbose) engine_report_runner_arenas(e);
+
   /* Since the time-steps may have changed because of the limiter's
    * action, we need to communicate the new time-step sizes */
   if ((e->policy & engine_policy_timestep_sync) ||
@@ -2486,71 +2854,17 @@ void engine_split(struct engine *e, struct partition *initial_partition) {
 #ifdef DEBUG_INTERACTIONS_STARS
 /**
  * @brief Exchange the feedback counters between stars
+ *
+ * Only the proxies exchange data: each node gets back the counters of the
+ * copies of its stars held by its neighbours.
+ *
  * @param e The #engine.
  */
 void engine_collect_stars_counter(struct engine *e) {
 
 #ifdef WITH_MPI
-  if (e->total_nr_sparts > 1e5) {
-    message("WARNING: too many sparts, skipping exchange of counters");
-    return;
-  }
-
-  /* Get number of sparticles for each rank */
-  size_t *n_sparts = (size_t *)malloc(e->nr_nodes * sizeof(size_t));
-
-  int err = MPI_Allgather(&e->s->nr_sparts_foreign, 1, MPI_UNSIGNED_LONG,
-                          n_sparts, 1, MPI_UNSIGNED_LONG, MPI_COMM_WORLD);
-  if (err != MPI_SUCCESS) error("Communication failed");
-
-  /* Compute derivated quantities */
-  int total = 0;
-  int *n_sparts_int = (int *)malloc(e->nr_nodes * sizeof(int));
-  int *displs = (int *)malloc(e->nr_nodes * sizeof(int));
-  for (int i = 0; i < e->nr_nodes; i++) {
-    displs[i] = total;
-    total += n_sparts[i];
-    n_sparts_int[i] = n_sparts[i];
-  }
-
-  /* Get all sparticles */
-  struct spart *sparts =
-      (struct spart *)swift_malloc("sparts", total * sizeof(struct spart));
-  err = MPI_Allgatherv(e->s->sparts_foreign, e->s->nr_sparts_foreign,
-                       spart_mpi_type, sparts, n_sparts_int, displs,
-                       spart_mpi_type, MPI_COMM_WORLD);
-  if (err != MPI_SUCCESS) error("Communication failed");
-
-  /* Reset counters */
-  for (size_t i = 0; i < e->s->nr_sparts_foreign; i++) {
-    e->s->sparts_foreign[i].num_ngb_feedback = 0;
-  }
-
-  /* Update counters */
-  struct spart *local_sparts = e->s->sparts;
-  for (size_t i = 0; i < e->s->nr_sparts; i++) {
-    const long long id_i = local_sparts[i].id;
-
-    for (int j = 0; j < total; j++) {
-      const long long id_j = sparts[j].id;
-
-      if (id_j == id_i) {
-        if (j >= displs[engine_rank] &&
-            j < displs[engine_rank] + n_sparts_int[engine_rank]) {
-          error(
-              "Found a local spart in foreign cell ID=%lli: j=%i, displs=%i, "
-              "n_sparts=%i",
-              id_j, j, displs[engine_rank], n_sparts_int[engine_rank]);
-        }
-
-        local_sparts[i].num_ngb_feedback += sparts[j].num_ngb_feedback;
-      }
-    }
-  }
-
-  free(n_sparts);
-  free(n_sparts_int);
-  swift_free("sparts", sparts);
+  /* Send the counters of the foreign stars back to their node */
+  proxy_stars_counters_exchange(e->proxies, e->nr_proxies, e->s);
 #endif
 }
 
@@ -2776,6 +3090,12 @@ void engine_init(struct engine *e, struct space *s, struct swift_params *params,
       parser_get_opt_param_int(params, "Snapshots:compression", 0);
   e->snapshot_distributed =
       parser_get_opt_param_int(params, "Snapshots:distributed", 0);
+  e->snapshot_async =
+      parser_get_opt_param_int(params, "Snapshots:asynchronous", 0);
+  e->snapshot_async_buffer_size =
+      parser_get_opt_param_float(params, "Snapshots:async_buffer_size",
+                                 1024.f) *
+      1024 * 1024;
   e->snapshot_int_time_label_on =
       parser_get_opt_param_int(params, "Snapshots:int_time_label_on", 0);
   e->snapshot_invoke_stf =
@@ -3138,7 +3458,10 @@ void engine_recompute_displacement_constraint(struct engine *e) {
  * @param restart Was this a run that was restarted from check-point files?
  */
 void engine_clean(struct engine *e, const int fof, const int restart) {
-  /* Start by telling the runners to stop. */
+  /* Make sure the last snapshot is complete. */
+  engine_wait_for_snapshot(e);
+
+  /* Then tell the runners to stop. */
   e->step_props = engine_step_prop_done;
   swift_barrier_wait(&e->run_barrier);
 
@@ -3152,6 +3475,8 @@ void engine_clean(struct engine *e, const int fof, const int restart) {
 #endif
     gravity_cache_clean(&e->runners[k].ci_gravity_cache);
     gravity_cache_clean(&e->runners[k].cj_gravity_cache);
+    gravity_M2L_batch_clean(&e->runners[k].M2L_batch);
+    runner_arena_clean(&e->runners[k].arena);
   }
   swift_free("runners", e->runners);
   free(e->snapshot_units);
@@ -3163,6 +3488,7 @@ void engine_clean(struct engine *e, const int fof, const int restart) {
   output_options_clean(e->output_options);
 
   swift_free("links", e->links);
+  engine_reusetasks_clean(e);
 #if defined(WITH_LOGGER)
   if (e->policy & engine_policy_logger) {
     logger_free(e->logger);
@@ -3185,9 +3511,11 @@ void engine_clean(struct engine *e, const int fof, const int restart) {
   stats_free_mpi_type();
   proxy_free_mpi_type();
   task_free_mpi_comms();
-  mpicollect_free_MPI_type();
+  if (!fof) mpicollect_free_MPI_type();
 #endif
 
+  task_profiler_clean(&e->profiler);
+
   /* Close files */
   if (!fof && e->nodeID == 0) {
     fclose(e->file_timesteps);
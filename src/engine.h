@@ -46,6 +46,7 @@
 #include "scheduler.h"
 #include "space.h"
 #include "task.h"
+#include "task_profiler.h"
 #include "units.h"
 #include "velociraptor_interface.h"
 
@@ -107,9 +108,12 @@ enum engine_step_properties {
 
 /* Some constants */
 #define engine_maxproxies 64
+#define engine_top_multipoles_tag 1002
 #define engine_tasksreweight 1
 #define engine_parts_size_grow 1.05
 #define engine_redistribute_alloc_margin 1.2
+#define engine_redistribute_pieces_in_flight 4
+#define engine_redistribute_buffer_size_default 1024
 #define engine_rebuild_link_alloc_margin 1.2
 #define engine_foreign_alloc_margin 1.05
 #define engine_default_energy_file_name "statistics"
@@ -313,6 +317,8 @@ struct engine {
   char snapshot_subdir[PARSER_MAX_LINE_SIZE];
   int snapshot_distributed;
   int snapshot_compression;
+  int snapshot_async;
+  size_t snapshot_async_buffer_size;
   int snapshot_int_time_label_on;
   int snapshot_invoke_stf;
   struct unit_system *snapshot_units;
@@ -382,6 +388,15 @@ struct engine {
   /* Tic/toc at the start/end of a step. */
   ticks tic_step, toc_step;
 
+  /* Analyse the execution of the tasks of each step? */
+  int step_analysis;
+
+  /* The analysis of the tasks of the last step. */
+  struct task_step_summary step_summary;
+
+  /* The histograms of the sampled costs of the tasks. */
+  struct task_profiler profiler;
+
 #ifdef WITH_MPI
   /* CPU times that the tasks used in the last step. */
   double usertime_last_step;
@@ -393,6 +408,9 @@ struct engine {
   /* Use synchronous redistributes. */
   int syncredist;
 
+  /* Maximal size in bytes of the asynchronous redistribute sends in flight. */
+  size_t redist_buffer_size;
+
 #endif
 
   /* Wallclock time of the last time-step */
@@ -427,6 +445,13 @@ struct engine {
      the creation of communication tasks so needs to be large enough. */
   float links_per_tasks;
 
+  /* Re-use the hydro tasks of the cells that did not change over rebuilds?
+   * (2 to also verify them against tasks made from scratch) */
+  int incremental_rebuild;
+
+  /* The hydro tasks of the last rebuild. */
+  struct engine_task_recipes *task_recipes;
+
   /* Are we talkative ? */
   int verbose;
 
@@ -506,6 +531,21 @@ struct engine {
   /* Maximum number of tasks needed for restarting. */
   int restart_max_tasks;
 
+  /* Length in bytes of the chunks of the particle arrays in restart files. */
+  size_t restart_chunk_size;
+
+  /* zlib compression level of the chunks (0 for no compression). */
+  int restart_compression;
+
+  /* Whether to only write the chunks changed since the last full dump. */
+  int restart_incremental;
+
+  /* Number of incremental dumps between two full dumps. */
+  int restart_full_every;
+
+  /* Number of incremental dumps since the last full dump. */
+  int restart_nr_incremental;
+
   /* The globally agreed runtime, in hours. */
   float runtime;
 
@@ -565,6 +605,7 @@ void engine_check_for_dumps(struct engine *e);
 void engine_check_for_index_dump(struct engine *e);
 void engine_collect_end_of_step(struct engine *e, int apply);
 void engine_dump_snapshot(struct engine *e);
+void engine_wait_for_snapshot(struct engine *e);
 void engine_init_output_lists(struct engine *e, struct swift_params *params);
 void engine_init(struct engine *e, struct space *s, struct swift_params *params,
                  struct output_options *output_options, long long Ngas,
@@ -611,6 +652,9 @@ void engine_redistribute(struct engine *e);
 void engine_print_policy(struct engine *e);
 int engine_is_done(struct engine *e);
 void engine_pin(void);
+#ifdef DEBUG_INTERACTIONS_STARS
+void engine_collect_stars_counter(struct engine *e);
+#endif
 void engine_unpin(void);
 void engine_clean(struct engine *e, const int fof, const int restart);
 int engine_estimate_nr_tasks(const struct engine *e);
@@ -621,6 +665,9 @@ void engine_activate_gpart_comms(struct engine *e);
 
 /* Function prototypes, engine_maketasks.c. */
 void engine_maketasks(struct engine *e);
+void engine_make_grav_long_range_lists(struct engine *e);
+void engine_make_hydroloop_tasks_mapper(void *map_data, int num_elements,
+                                        void *extra_data);
 
 /* Function prototypes, engine_maketasks.c. */
 void engine_make_fof_tasks(struct engine *e);
@@ -628,6 +675,12 @@ void engine_make_fof_tasks(struct engine *e);
 /* Function prototypes, engine_marktasks.c. */
 int engine_marktasks(struct engine *e);
 
+/* Function prototypes, engine_reusetasks.c. */
+void engine_reusetasks_make_hydroloop_tasks(struct engine *e);
+void engine_reusetasks_record(struct engine *e);
+const char *engine_reusetasks_reused_cells(const struct engine *e);
+void engine_reusetasks_clean(struct engine *e);
+
 /* Function prototypes, engine_split_particles.c. */
 void engine_split_gas_particles(struct engine *e);
 
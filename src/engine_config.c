@@ -90,6 +90,7 @@ void engine_config(int restart, int fof, struct engine *e,
   e->step_props = engine_step_prop_none;
   e->links = NULL;
   e->nr_links = 0;
+  e->task_recipes = NULL;
   e->file_stats = NULL;
   e->file_timesteps = NULL;
   e->sfh_logger = NULL;
@@ -99,6 +100,11 @@ void engine_config(int restart, int fof, struct engine *e,
   e->restart_file = restart_file;
   e->restart_next = 0;
   e->restart_dt = 0;
+  e->restart_chunk_size = 0;
+  e->restart_compression = 0;
+  e->restart_incremental = 0;
+  e->restart_full_every = 0;
+  e->restart_nr_incremental = 0;
   e->run_fof = 0;
   engine_rank = nodeID;
 
@@ -119,6 +125,14 @@ void engine_config(int restart, int fof, struct engine *e,
     message("Number of task queues set to %d", nr_queues);
   e->s->nr_queues = nr_queues;
 
+  /* Analyse the execution of the tasks of every step? */
+  e->step_analysis =
+      parser_get_opt_param_int(params, "Scheduler:step_analysis", 0);
+  bzero(&e->step_summary, sizeof(struct task_step_summary));
+
+  /* Sample the costs of the tasks? */
+  task_profiler_init(&e->profiler, params, nodeID, restart);
+
 /* Deal with affinity. For now, just figure out the number of cores. */
 #if defined(HAVE_SETAFFINITY)
   const int nr_cores = sysconf(_SC_NPROCESSORS_ONLN);
@@ -252,6 +266,14 @@ void engine_config(int restart, int fof, struct engine *e,
     e->syncredist =
         parser_get_opt_param_int(params, "DomainDecomposition:synchronous", 0);
 
+    /* How much data to have in flight when redistributing asynchronously. */
+    const double redist_buffer_MB = parser_get_opt_param_double(
+        params, "DomainDecomposition:redistribute_buffer_MB",
+        engine_redistribute_buffer_size_default);
+    if (redist_buffer_MB <= 0.)
+      error("DomainDecomposition:redistribute_buffer_MB must be positive.");
+    e->redist_buffer_size = (size_t)(redist_buffer_MB * 1024. * 1024.);
+
 #endif
   }
 
@@ -313,10 +335,17 @@ void engine_config(int restart, int fof, struct engine *e,
 
       fprintf(e->file_timesteps,
               "# %6s %14s %12s %12s %14s %9s %12s %12s %12s %12s %12s %16s "
-              "[%s] %6s\n",
+              "[%s] %6s",
               "Step", "Time", "Scale-factor", "Redshift", "Time-step",
               "Time-bins", "Updates", "g-Updates", "s-Updates", "Sink-Updates",
               "b-Updates", "Wall-clock time", clocks_getunit(), "Props");
+      if (e->step_analysis)
+        fprintf(e->file_timesteps,
+                " %14s [%s] %14s [%s] %9s %9s %14s [%s] %24s", "Tasks span",
+                clocks_getunit(), "Critical path", clocks_getunit(),
+                "Idle-mean", "Idle-max", "Tail", clocks_getunit(),
+                "Tail-task");
+      fprintf(e->file_timesteps, "\n");
       fflush(e->file_timesteps);
     }
 
@@ -558,6 +587,27 @@ void engine_config(int restart, int fof, struct engine *e,
         message("Restarts will be dumped after the final step");
     }
 
+    /* How to write the particle arrays. Can be changed on restart. */
+    const float chunk_MB =
+        parser_get_opt_param_float(params, "Restarts:chunk_size_MB", 16.f);
+    if (chunk_MB <= 0.f) error("Restarts:chunk_size_MB must be positive");
+    e->restart_chunk_size = (size_t)(chunk_MB * 1024. * 1024.);
+    e->restart_compression =
+        parser_get_opt_param_int(params, "Restarts:compression", 0);
+    if (e->restart_compression < 0 || e->restart_compression > 9)
+      error("Restarts:compression must be between 0 and 9");
+#ifndef HAVE_ZLIB
+    if (e->restart_compression > 0)
+      error("SWIFT was not compiled with zlib, can't compress restart files");
+#endif
+    e->restart_incremental =
+        parser_get_opt_param_int(params, "Restarts:incremental", 0);
+    e->restart_full_every =
+        parser_get_opt_param_int(params, "Restarts:full_every", 4);
+    if (e->nodeID == 0 && e->restart_dump && e->restart_incremental)
+      message("Restarts will be incremental, with a full dump every %d",
+              e->restart_full_every + 1);
+
     /* Internally we use ticks, so convert into a delta ticks. Assumes we can
      * convert from ticks into milliseconds. */
     e->restart_dt = clocks_to_ticks(dhours * 60.0 * 60.0 * 1000.0);
@@ -611,9 +661,32 @@ void engine_config(int restart, int fof, struct engine *e,
   e->links_per_tasks =
       parser_get_opt_param_float(params, "Scheduler:links_per_tasks", 25.);
 
+  /* Re-use the hydro tasks of the unchanged cells over rebuilds? */
+  e->incremental_rebuild =
+      parser_get_opt_param_int(params, "Scheduler:incremental_rebuild", 0);
+  if (e->incremental_rebuild < 0 || e->incremental_rebuild > 2)
+    error("Invalid value for Scheduler:incremental_rebuild (%d)",
+          e->incremental_rebuild);
+
+  /* Use the lock-free work-stealing deques rather than the binary heaps? */
+  const int lockfree_queues =
+      parser_get_opt_param_int(params, "Scheduler:lockfree_queues", 0);
+  if (lockfree_queues && nodeID == 0)
+    message("Using lock-free work-stealing task queues.");
+
   /* Init the scheduler. */
   scheduler_init(&e->sched, e->s, maxtasks, nr_queues,
-                 (e->policy & scheduler_flag_steal), e->nodeID, &e->threadpool);
+                 (e->policy & scheduler_flag_steal) |
+                     (lockfree_queues ? scheduler_flag_lockfree : 0),
+                 e->nodeID, &e->threadpool);
+
+  /* Weight of the last step in the running average of the measured task
+   * costs. The averages themselves are part of the restart files. */
+  e->sched.costs.alpha = parser_get_opt_param_float(
+      params, "Scheduler:task_cost_ema_alpha", 0.2f);
+  if (e->sched.costs.alpha < 0.f || e->sched.costs.alpha > 1.f)
+    error("Invalid value for Scheduler:task_cost_ema_alpha (%f)",
+          e->sched.costs.alpha);
 
   /* Maximum size of MPI task messages, in KB, that should not be buffered,
    * that is sent using MPI_Issend, not MPI_Isend. 4Mb by default. Can be
@@ -673,6 +746,9 @@ void engine_config(int restart, int fof, struct engine *e,
   for (int k = 0; k < e->nr_threads; k++) {
     e->runners[k].id = k;
     e->runners[k].e = e;
+    e->runners[k].busy_ticks = 0;
+    e->runners[k].last_toc = 0;
+    task_profiler_ring_init(&e->runners[k].profiler_ring, &e->profiler, k);
     if (pthread_create(&e->runners[k].thread, NULL, &runner_main,
                        &e->runners[k]) != 0)
       error("Failed to create runner thread.");
@@ -691,6 +767,13 @@ void engine_config(int restart, int fof, struct engine *e,
       else
         e->runners[k].qid = k;
 
+#if defined(HAVE_LIBNUMA) && defined(_GNU_SOURCE)
+      /* Record the NUMA node of the queue for the work stealing. */
+      if (numa_available() >= 0)
+        e->sched.queues[e->runners[k].qid].numa_node =
+            numa_node_of_cpu(cpuid[coreid]);
+#endif
+
       /* Set the cpu mask to zero | e->id. */
       CPU_ZERO(&cpuset);
       CPU_SET(cpuid[coreid], &cpuset);
@@ -713,6 +796,8 @@ void engine_config(int restart, int fof, struct engine *e,
     e->runners[k].cj_gravity_cache.count = 0;
     gravity_cache_init(&e->runners[k].ci_gravity_cache, space_splitsize);
     gravity_cache_init(&e->runners[k].cj_gravity_cache, space_splitsize);
+    gravity_M2L_batch_init(&e->runners[k].M2L_batch);
+    runner_arena_init(&e->runners[k].arena, runner_arena_initial_size);
 #ifdef WITH_VECTORIZATION
     e->runners[k].ci_cache.count = 0;
     e->runners[k].cj_cache.count = 0;
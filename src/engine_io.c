@@ -32,6 +32,7 @@
 
 /* Local headers. */
 #include "distributed_io.h"
+#include "io_async.h"
 #include "kick.h"
 #include "line_of_sight.h"
 #include "logger_io.h"
@@ -101,6 +102,10 @@ void engine_dump_restarts(struct engine *e, int drifted_all, int force) {
 
       /* Drift all particles first (may have just been done). */
       if (!drifted_all) engine_drift_all(e, /*drift_mpole=*/1);
+
+      /* Don't refer to a snapshot that is not complete yet. */
+      engine_wait_for_snapshot(e);
+
       restart_write(e, e->restart_file);
 
 #ifdef WITH_MPI
@@ -208,6 +213,27 @@ void engine_dump_snapshot(struct engine *e) {
             (float)clocks_diff(&time1, &time2), clocks_getunit());
 }
 
+/**
+ * @brief Waits for the snapshot being written in the background, if any, to
+ * be complete.
+ *
+ * @param e The #engine.
+ */
+void engine_wait_for_snapshot(struct engine *e) {
+
+#if defined(HAVE_HDF5)
+  if (!e->snapshot_async) return;
+
+  const ticks tic = getticks();
+
+  io_async_wait();
+
+  if (e->verbose)
+    message("Waiting for the snapshot writer took %.3f %s.",
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+#endif
+}
+
 /**
  * @brief Writes an index file with the current state of the engine
  *
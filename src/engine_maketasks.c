@@ -27,6 +27,7 @@
 
 /* Some standard headers. */
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
 /* MPI headers. */
@@ -1541,6 +1542,228 @@ void engine_make_self_gravity_tasks_mapper(void *map_data, int num_elements,
   }
 }
 
+/**
+ * @brief Lists the top-level cells a local top-level cell interacts with
+ * using M-M in its long-range gravity task.
+ *
+ * These are the cells with particles that are not in range of a pair task,
+ * i.e. that pass the MAC with the rebuild-time sizes and positions. As
+ * these only change at rebuild time, the list is valid until the next one,
+ * unless the multipoles are reconstructed at every step, in which case the
+ * lists must be re-made after each reconstruction.
+ * In the periodic case, only the cells within the cut-off of the mesh
+ * forces are considered; the others are counted.
+ *
+ * @param e The #engine.
+ * @param cid The index of the top-level cell.
+ * @param has_particles For each top-level cell, does it have particles?
+ * @param nr_cells_with_particles The number of top-level cells with
+ * particles.
+ * @param list (return) The indices of the cells to interact with, NULL to
+ * only count them.
+ * @param nr_far (return) The number of cells with particles beyond the
+ * cut-off.
+ *
+ * @return The number of cells to interact with.
+ */
+static int engine_make_grav_long_range_list(const struct engine *e,
+                                            const int cid,
+                                            const char *has_particles,
+                                            const int nr_cells_with_particles,
+                                            int *list, int *nr_far) {
+
+  const struct space *s = e->s;
+  const int periodic = e->mesh->periodic;
+  const double dim[3] = {s->dim[0], s->dim[1], s->dim[2]};
+  const int cdim[3] = {s->cdim[0], s->cdim[1], s->cdim[2]};
+  struct cell *cells = s->cells_top;
+  const double max_distance = e->mesh->r_cut_max;
+  const double max_distance2 = max_distance * max_distance;
+  struct cell *top = &cells[cid];
+
+  int count = 0;
+  *nr_far = 0;
+
+  if (!periodic) {
+
+    /* No cut-off, all the cells are candidates */
+    for (int n = 0; n < nr_cells_with_particles; ++n) {
+      const int cjd = s->cells_with_particles_top[n];
+      if (cjd == cid) continue;
+
+      if (cell_can_use_pair_mm(top, &cells[cjd], e, s,
+                               /*use_rebuild_data=*/1, /*is_tree_walk=*/0)) {
+        if (list != NULL) list[count] = cjd;
+        ++count;
+      }
+    }
+    return count;
+  }
+
+  /* Compute how many cells away we need to walk in each direction */
+  int delta_m[3], delta_p[3];
+  for (int d = 0; d < 3; ++d) {
+    const int delta = (int)(max_distance / cells[0].width[d]) + 1;
+    delta_m[d] = delta;
+    delta_p[d] = delta;
+
+    /* Special case where every cell is in range of every other one */
+    if (2 * delta + 1 >= cdim[d]) {
+      delta_m[d] = cdim[d] / 2;
+      delta_p[d] = cdim[d] - cdim[d] / 2 - 1;
+    }
+  }
+
+  /* Integer indices of the cell in the top-level grid */
+  const int i = cid / (cdim[1] * cdim[2]);
+  const int j = (cid / cdim[2]) % cdim[1];
+  const int k = cid % cdim[2];
+
+  /* Loop over the cells that may be within the cut-off */
+  int nr_near = 0;
+  for (int ii = -delta_m[0]; ii <= delta_p[0]; ii++) {
+    const int iii = (i + ii + cdim[0]) % cdim[0];
+    for (int jj = -delta_m[1]; jj <= delta_p[1]; jj++) {
+      const int jjj = (j + jj + cdim[1]) % cdim[1];
+      for (int kk = -delta_m[2]; kk <= delta_p[2]; kk++) {
+        const int kkk = (k + kk + cdim[2]) % cdim[2];
+
+        const int cjd = cell_getid(cdim, iii, jjj, kkk);
+        struct cell *cj = &cells[cjd];
+
+        /* Avoid self contributions and empty cells */
+        if (cjd == cid || !has_particles[cjd]) continue;
+
+        /* Are we beyond the distance where the truncated forces are 0 ?*/
+        if (cell_min_dist2_same_size(top, cj, periodic, dim) > max_distance2)
+          continue;
+        ++nr_near;
+
+        if (cell_can_use_pair_mm(top, cj, e, s, /*use_rebuild_data=*/1,
+                                 /*is_tree_walk=*/0)) {
+          if (list != NULL) list[count] = cjd;
+          ++count;
+        }
+      }
+    }
+  }
+
+  /* All the other cells with particles are beyond the cut-off */
+  *nr_far = nr_cells_with_particles - nr_near - (has_particles[cid] ? 1 : 0);
+
+  return count;
+}
+
+/*! Arguments of engine_make_grav_long_range_lists_mapper() */
+struct engine_grav_long_range_data {
+  struct engine *e;
+  const char *has_particles;
+  int fill;
+};
+
+/**
+ * @brief Counts or fills the long-range gravity lists of a range of local
+ * top-level cells.
+ *
+ * @param map_data The indices of the local top-level cells.
+ * @param num_elements The number of cells.
+ * @param extra_data Pointer to a #engine_grav_long_range_data.
+ */
+static void engine_make_grav_long_range_lists_mapper(void *map_data,
+                                                     int num_elements,
+                                                     void *extra_data) {
+
+  const struct engine_grav_long_range_data *data =
+      (const struct engine_grav_long_range_data *)extra_data;
+  const struct engine *e = data->e;
+  struct space *s = e->s;
+  const int *local_cells = (const int *)map_data;
+
+  for (int ind = 0; ind < num_elements; ind++) {
+    const int cid = local_cells[ind];
+
+    /* Cells without gravity particles have no long-range task */
+    if (s->cells_top[cid].grav.count == 0) continue;
+
+    int *list = NULL;
+    if (data->fill)
+      list = &s->grav_long_range_cells[s->grav_long_range_offsets[cid]];
+
+    /* The counts go in the next offset until the prefix sum */
+    const int count = engine_make_grav_long_range_list(
+        e, cid, data->has_particles, s->nr_cells_with_particles, list,
+        &s->grav_long_range_nr_far[cid]);
+    if (!data->fill) s->grav_long_range_offsets[cid + 1] = count;
+  }
+}
+
+/**
+ * @brief Builds the lists of top-level cells each local top-level cell
+ * interacts with using M-M in its long-range gravity task.
+ *
+ * Must be called after the list of the top-level cells with particles has
+ * been made.
+ *
+ * @param e The #engine.
+ */
+void engine_make_grav_long_range_lists(struct engine *e) {
+
+  struct space *s = e->s;
+  const int nr_cells = s->nr_cells;
+  const ticks tic = getticks();
+
+  /* Free the lists of the previous rebuild */
+  if (s->grav_long_range_offsets != NULL)
+    swift_free("grav_long_range_offsets", s->grav_long_range_offsets);
+  if (s->grav_long_range_cells != NULL)
+    swift_free("grav_long_range_cells", s->grav_long_range_cells);
+  if (s->grav_long_range_nr_far != NULL)
+    swift_free("grav_long_range_nr_far", s->grav_long_range_nr_far);
+  s->grav_long_range_cells = NULL;
+
+  s->grav_long_range_offsets = (int *)swift_malloc(
+      "grav_long_range_offsets", (nr_cells + 1) * sizeof(int));
+  s->grav_long_range_nr_far =
+      (int *)swift_malloc("grav_long_range_nr_far", nr_cells * sizeof(int));
+  char *has_particles = (char *)malloc(nr_cells * sizeof(char));
+  if (s->grav_long_range_offsets == NULL ||
+      s->grav_long_range_nr_far == NULL || has_particles == NULL)
+    error("Failed to allocate the long-range gravity lists.");
+  memset(s->grav_long_range_offsets, 0, (nr_cells + 1) * sizeof(int));
+  memset(s->grav_long_range_nr_far, 0, nr_cells * sizeof(int));
+  memset(has_particles, 0, nr_cells * sizeof(char));
+  for (int n = 0; n < s->nr_cells_with_particles; ++n)
+    has_particles[s->cells_with_particles_top[n]] = 1;
+
+  /* Count the interactions of each cell... */
+  struct engine_grav_long_range_data data = {e, has_particles, /*fill=*/0};
+  threadpool_map(&e->threadpool, engine_make_grav_long_range_lists_mapper,
+                 s->local_cells_top, s->nr_local_cells, sizeof(int),
+                 threadpool_auto_chunk_size, &data);
+
+  /* ...turn the counts into offsets... */
+  for (int cid = 0; cid < nr_cells; ++cid)
+    s->grav_long_range_offsets[cid + 1] += s->grav_long_range_offsets[cid];
+
+  /* ...and fill the lists */
+  const int nr_interactions = s->grav_long_range_offsets[nr_cells];
+  s->grav_long_range_cells = (int *)swift_malloc(
+      "grav_long_range_cells", max(nr_interactions, 1) * sizeof(int));
+  if (s->grav_long_range_cells == NULL)
+    error("Failed to allocate the long-range gravity lists.");
+  data.fill = 1;
+  threadpool_map(&e->threadpool, engine_make_grav_long_range_lists_mapper,
+                 s->local_cells_top, s->nr_local_cells, sizeof(int),
+                 threadpool_auto_chunk_size, &data);
+
+  free(has_particles);
+
+  if (e->verbose)
+    message("Made %d long-range M-M interactions, took %.3f %s.",
+            nr_interactions, clocks_from_ticks(getticks() - tic),
+            clocks_getunit());
+}
+
 /**
  * @brief Constructs the top-level tasks for the external gravity.
  *
@@ -3164,6 +3387,9 @@ void engine_make_hydroloop_tasks_mapper(void *map_data, int num_elements,
   const int *cdim = s->cdim;
   struct cell *cells = s->cells_top;
 
+  /* Cells whose tasks are re-used from the last rebuild (NULL if none). */
+  const char *reused = engine_reusetasks_reused_cells(e);
+
   /* Loop through the elements, which are just byte offsets from NULL. */
   for (int ind = 0; ind < num_elements; ind++) {
 
@@ -3185,7 +3411,7 @@ void engine_make_hydroloop_tasks_mapper(void *map_data, int num_elements,
       continue;
 
     /* If the cell is local build a self-interaction */
-    if (ci->nodeID == nodeID) {
+    if (ci->nodeID == nodeID && (reused == NULL || !reused[cid])) {
       scheduler_addtask(sched, task_type_self, task_subtype_density, 0, 0, ci,
                         NULL);
     }
@@ -3217,6 +3443,9 @@ void engine_make_hydroloop_tasks_mapper(void *map_data, int num_elements,
               (ci->nodeID != nodeID && cj->nodeID != nodeID))
             continue;
 
+          /* Are the tasks of both cells re-used? */
+          if (reused != NULL && reused[cid] && reused[cjd]) continue;
+
           /* Construct the pair task */
           const int sid = sortlistID[(kk + 1) + 3 * ((jj + 1) + 3 * (ii + 1))];
           scheduler_addtask(sched, task_type_pair, task_subtype_density, sid, 0,
@@ -3514,11 +3743,17 @@ void engine_maketasks(struct engine *e) {
 
   ticks tic2 = getticks();
 
-  /* Construct the first hydro loop over neighbours */
-  if (e->policy & engine_policy_hydro)
+  /* Construct the first hydro loop over neighbours. When re-using the
+   * tasks of the last rebuild, these come out already split. */
+  if ((e->policy & engine_policy_hydro) && e->incremental_rebuild)
+    engine_reusetasks_make_hydroloop_tasks(e);
+  else if (e->policy & engine_policy_hydro)
     threadpool_map(&e->threadpool, engine_make_hydroloop_tasks_mapper, NULL,
                    s->nr_cells, 1, threadpool_auto_chunk_size, e);
 
+  /* Number of tasks that are already split. */
+  const int nr_split_tasks = e->incremental_rebuild ? sched->nr_tasks : 0;
+
   if (e->verbose)
     message("Making hydro tasks took %.3f %s.",
             clocks_from_ticks(getticks() - tic2), clocks_getunit());
@@ -3545,7 +3780,13 @@ void engine_maketasks(struct engine *e) {
   tic2 = getticks();
 
   /* Split the tasks. */
-  scheduler_splittasks(sched, /*fof_tasks=*/0, e->verbose);
+  if (nr_split_tasks == 0)
+    scheduler_splittasks(sched, /*fof_tasks=*/0, e->verbose);
+  else
+    threadpool_map(&e->threadpool, scheduler_splittasks_mapper,
+                   &sched->tasks[nr_split_tasks],
+                   sched->nr_tasks - nr_split_tasks, sizeof(struct task),
+                   threadpool_auto_chunk_size, sched);
 
   if (e->verbose)
     message("Splitting tasks took %.3f %s.",
@@ -3586,6 +3827,10 @@ void engine_maketasks(struct engine *e) {
     message("Counting and linking tasks took %.3f %s.",
             clocks_from_ticks(getticks() - tic2), clocks_getunit());
 
+  /* Keep the hydro tasks for the next rebuild. */
+  if ((e->policy & engine_policy_hydro) && e->incremental_rebuild)
+    engine_reusetasks_record(e);
+
   tic2 = getticks();
 
   /* Re-set the tag counter. MPI tags are defined for top-level cells in
@@ -29,12 +29,136 @@
 #include "memswap.h"
 
 #ifdef WITH_MPI
+/**
+ * @brief Function called by engine_do_redistribute() once all the particles
+ * sent by a given node have arrived. It receives the node, the new particle
+ * array and the extra data.
+ */
+typedef void (*engine_redistribute_arrived_fn)(int node, void *parts_new,
+                                               void *data);
+
+/**
+ * @brief Length of the pieces the messages exchanged with a node are cut
+ * into.
+ *
+ * The pieces are numbered by their MPI tag, so the base length is enlarged
+ * when needed to keep the number of pieces within MPI_TAG_UB. Both ends of a
+ * message compute the same length from the same count.
+ *
+ * @param base the length of the pieces that fits in the buffer.
+ * @param count the number of particles exchanged with the node.
+ * @param tag_ub the largest tag allowed by the MPI library.
+ * @param sizeofparts sizeof the particle struct.
+ */
+static size_t engine_redistribute_piece(size_t base, int count, int tag_ub,
+                                        size_t sizeofparts) {
+
+  size_t piece = base;
+  if (((size_t)count + piece - 1) / piece > (size_t)tag_ub)
+    piece = ((size_t)count + tag_ub - 1) / tag_ub;
+  if (piece > INT_MAX / sizeofparts)
+    error(
+        "Cannot cut %d particles into fewer than %d messages of less than "
+        "2GB. Use DomainDecomposition:synchronous.",
+        count, tag_ub);
+  return piece;
+}
+
+/**
+ * @brief Emit the send of the next piece of particles of an asynchronous
+ * redistribute, going round the nodes.
+ *
+ * @param parts the particle data to exchange.
+ * @param counts the number of particles to send to each node.
+ * @param offsets_send where the particles of each node start in parts.
+ * @param pieces_sent (in/out) the number of pieces sent to each node.
+ * @param next_node (in/out) the node to look at first.
+ * @param piece the length of the pieces sent to each node.
+ * @param sizeofparts sizeof the particle struct.
+ * @param mpi_type the MPI_Datatype for these particles.
+ * @param nr_nodes the number of nodes to exchange with.
+ * @param nodeID the id of this node.
+ * @param req (return) the request of the send.
+ *
+ * @result 1 if a send was emitted, 0 if there is nothing left to send.
+ */
+static int engine_redistribute_send_next(
+    char *parts, const int *counts, const size_t *offsets_send,
+    int *pieces_sent, int *next_node, const size_t *piece, size_t sizeofparts,
+    MPI_Datatype mpi_type, int nr_nodes, int nodeID, MPI_Request *req) {
+
+  /* Find the next node we still have something to send to. */
+  int k = -1;
+  for (int i = 0; i < nr_nodes && k < 0; i++) {
+    const int kk = (*next_node + i) % nr_nodes;
+    if (kk != nodeID && pieces_sent[kk] * piece[kk] < (size_t)counts[kk])
+      k = kk;
+  }
+  if (k < 0) return 0;
+  *next_node = (k + 1) % nr_nodes;
+
+  const size_t sendo = pieces_sent[k] * piece[k];
+  const int sendc = min(piece[k], counts[k] - sendo);
+  const int res =
+      MPI_Isend(&parts[(offsets_send[k] + sendo) * sizeofparts], sendc,
+                mpi_type, k, pieces_sent[k], MPI_COMM_WORLD, req);
+  if (res != MPI_SUCCESS)
+    mpi_error(res, "Failed to isend parts to node %i.", k);
+  pieces_sent[k]++;
+  return 1;
+}
+
+/**
+ * @brief Post the receive of the next piece of particles expected from a
+ * node, if any.
+ *
+ * @param parts_new the new particle array.
+ * @param recv_counts the number of particles to receive from each node.
+ * @param offsets_recv where the particles of each node start in parts_new.
+ * @param pieces_posted (in/out) the number of receives posted for each node.
+ * @param piece the length of the pieces received from each node.
+ * @param sizeofparts sizeof the particle struct.
+ * @param mpi_type the MPI_Datatype for these particles.
+ * @param k the node to receive from.
+ * @param req (return) the request of the receive, MPI_REQUEST_NULL if there
+ *            is nothing left to receive from that node.
+ */
+static void engine_redistribute_recv_next(
+    char *parts_new, const int *recv_counts, const size_t *offsets_recv,
+    int *pieces_posted, const size_t *piece, size_t sizeofparts,
+    MPI_Datatype mpi_type, int k, MPI_Request *req) {
+
+  const size_t recvo = pieces_posted[k] * piece[k];
+  if (recvo >= (size_t)recv_counts[k]) {
+    *req = MPI_REQUEST_NULL;
+    return;
+  }
+
+  const int recvc = min(piece[k], recv_counts[k] - recvo);
+  const int res =
+      MPI_Irecv(&parts_new[(offsets_recv[k] + recvo) * sizeofparts], recvc,
+                mpi_type, k, pieces_posted[k], MPI_COMM_WORLD, req);
+  if (res != MPI_SUCCESS)
+    mpi_error(res, "Failed to emit irecv of parts from node %i.", k);
+  pieces_posted[k]++;
+}
+
 /**
  * Do the exchange of one type of particles with all the other nodes.
  *
+ * The messages are cut into pieces such that at most buffer_size bytes of
+ * sends are in flight at any time. The pieces are numbered by their MPI tag,
+ * so they are enlarged when a message would otherwise need more than
+ * MPI_TAG_UB of them. A window of receives per node is posted straight into
+ * the new array and refilled as the pieces arrive, such that every send can
+ * always complete without posting all the receives up front. The
+ * particles a node sends to itself are copied while the first messages are
+ * in flight and the arrived function is called for each node as soon as all
+ * its particles are in.
+ *
  * @param label a label for the memory allocations of this particle type.
- * @param counts 2D array with the counts of particles to exchange with
- *               each other node.
+ * @param counts the number of particles to send to each node.
+ * @param recv_counts the number of particles to receive from each node.
  * @param parts the particle data to exchange
  * @param new_nr_parts the number of particles this node will have after all
  *                     exchanges have completed.
@@ -45,14 +169,21 @@
  * @param nodeID the id of this node.
  * @param syncredist whether to use slower more memory friendly synchronous
  *                   exchanges.
+ * @param buffer_size the maximal number of bytes of asynchronous sends in
+ *                    flight.
+ * @param arrived function to call once the particles of a node have arrived,
+ *                can be NULL.
+ * @param arrived_data extra data passed to the arrived function.
  *
  * @result new particle data constructed from all the exchanges with the
  *         given alignment.
  */
-static void *engine_do_redistribute(const char *label, int *counts, char *parts,
-                                    size_t new_nr_parts, size_t sizeofparts,
-                                    size_t alignsize, MPI_Datatype mpi_type,
-                                    int nr_nodes, int nodeID, int syncredist) {
+static void *engine_do_redistribute(
+    const char *label, const int *counts, const int *recv_counts, char *parts,
+    size_t new_nr_parts, size_t sizeofparts, size_t alignsize,
+    MPI_Datatype mpi_type, int nr_nodes, int nodeID, int syncredist,
+    size_t buffer_size, engine_redistribute_arrived_fn arrived,
+    void *arrived_data) {
 
   /* Allocate a new particle array with some extra margin */
   char *parts_new = NULL;
@@ -61,10 +192,21 @@ static void *engine_do_redistribute(const char *label, int *counts, char *parts,
           sizeofparts * new_nr_parts * engine_redistribute_alloc_margin) != 0)
     error("Failed to allocate new particle data.");
 
+  /* Where the particles of each node start in the old and new arrays. */
+  size_t *offsets_send = NULL, *offsets_recv = NULL;
+  if ((offsets_send = (size_t *)malloc(sizeof(size_t) * nr_nodes)) == NULL ||
+      (offsets_recv = (size_t *)malloc(sizeof(size_t) * nr_nodes)) == NULL)
+    error("Failed to allocate redistribute offsets.");
+  offsets_send[0] = 0;
+  offsets_recv[0] = 0;
+  for (int k = 1; k < nr_nodes; k++) {
+    offsets_send[k] = offsets_send[k - 1] + counts[k - 1];
+    offsets_recv[k] = offsets_recv[k - 1] + recv_counts[k - 1];
+  }
+
   if (syncredist) {
 
     /* Slow synchronous redistribute,. */
-    size_t offset_send = 0, offset_recv = 0;
 
     /* Only send and receive only "chunk" particles per request.
      * Fixing the message size to 2GB. */
@@ -76,163 +218,176 @@ static void *engine_do_redistribute(const char *label, int *counts, char *parts,
       /* Rank 0 decides the index of sending node */
       MPI_Bcast(&kk, 1, MPI_INT, 0, MPI_COMM_WORLD);
 
-      int ind_recv = kk * nr_nodes + nodeID;
-
       if (nodeID == kk) {
 
         /*  Send out our particles. */
-        offset_send = 0;
         for (int j = 0; j < nr_nodes; j++) {
 
-          int ind_send = kk * nr_nodes + j;
-
           /*  Just copy our own parts */
-          if (counts[ind_send] > 0) {
-            if (j == nodeID) {
-              memcpy(&parts_new[offset_recv * sizeofparts],
-                     &parts[offset_send * sizeofparts],
-                     sizeofparts * counts[ind_recv]);
-              offset_send += counts[ind_send];
-              offset_recv += counts[ind_recv];
-            } else {
-              for (int i = 0, n = 0; i < counts[ind_send]; n++) {
-
-                /* Count and index, with chunk parts at most. */
-                size_t sendc = min(chunk, counts[ind_send] - i);
-                size_t sendo = offset_send + i;
-
-                res = MPI_Send(&parts[sendo * sizeofparts], sendc, mpi_type, j,
-                               n, MPI_COMM_WORLD);
-                if (res != MPI_SUCCESS) {
-                  mpi_error(res, "Failed to send parts to node %i from %i.", j,
-                            nodeID);
-                }
-                i += sendc;
+          if (j == nodeID) {
+            memcpy(&parts_new[offsets_recv[j] * sizeofparts],
+                   &parts[offsets_send[j] * sizeofparts],
+                   sizeofparts * counts[j]);
+            if (arrived != NULL) arrived(j, parts_new, arrived_data);
+          } else {
+            for (int i = 0, n = 0; i < counts[j]; n++) {
+
+              /* Count and index, with chunk parts at most. */
+              size_t sendc = min(chunk, counts[j] - i);
+              size_t sendo = offsets_send[j] + i;
+
+              res = MPI_Send(&parts[sendo * sizeofparts], sendc, mpi_type, j,
+                             n, MPI_COMM_WORLD);
+              if (res != MPI_SUCCESS) {
+                mpi_error(res, "Failed to send parts to node %i from %i.", j,
+                          nodeID);
               }
-              offset_send += counts[ind_send];
+              i += sendc;
             }
           }
         }
       } else {
         /*  Listen for sends from kk. */
-        if (counts[ind_recv] > 0) {
-          for (int i = 0, n = 0; i < counts[ind_recv]; n++) {
-            /* Count and index, with +chunk parts at most. */
-            size_t recvc = min(chunk, counts[ind_recv] - i);
-            size_t recvo = offset_recv + i;
-
-            MPI_Status status;
-            res = MPI_Recv(&parts_new[recvo * sizeofparts], recvc, mpi_type, kk,
-                           n, MPI_COMM_WORLD, &status);
-            if (res != MPI_SUCCESS) {
-              mpi_error(res, "Failed to recv of parts from node %i to %i.", kk,
-                        nodeID);
-            }
-            i += recvc;
+        for (int i = 0, n = 0; i < recv_counts[kk]; n++) {
+          /* Count and index, with +chunk parts at most. */
+          size_t recvc = min(chunk, recv_counts[kk] - i);
+          size_t recvo = offsets_recv[kk] + i;
+
+          MPI_Status status;
+          res = MPI_Recv(&parts_new[recvo * sizeofparts], recvc, mpi_type, kk,
+                         n, MPI_COMM_WORLD, &status);
+          if (res != MPI_SUCCESS) {
+            mpi_error(res, "Failed to recv of parts from node %i to %i.", kk,
+                      nodeID);
           }
-          offset_recv += counts[ind_recv];
+          i += recvc;
         }
+        if (arrived != NULL) arrived(kk, parts_new, arrived_data);
       }
     }
 
   } else {
-    /* Asynchronous redistribute, can take a lot of memory. */
+    /* Asynchronous redistribute, pipelined within the buffer size. */
+
+    /* Largest tag we can use to number the pieces. */
+    int *tag_ub_ptr = NULL, flag = 0;
+    MPI_Comm_get_attr(MPI_COMM_WORLD, MPI_TAG_UB, &tag_ub_ptr, &flag);
+    const int tag_ub = flag ? *tag_ub_ptr : 32767;
+
+    /* Length of the pieces the messages are cut into, such that a few of
+     * them fit in the buffer and none is larger than 2GB. */
+    size_t base_piece = buffer_size / engine_redistribute_pieces_in_flight;
+    base_piece /= sizeofparts;
+    if (base_piece > INT_MAX / sizeofparts) base_piece = INT_MAX / sizeofparts;
+    if (base_piece < 1) base_piece = 1;
+
+    /* The pieces exchanged with each node, and how many are expected. */
+    size_t *piece_send = NULL, *piece_recv = NULL;
+    int *pieces_left = NULL, *pieces_posted = NULL, *pieces_sent = NULL;
+    if ((piece_send = (size_t *)malloc(sizeof(size_t) * nr_nodes)) == NULL ||
+        (piece_recv = (size_t *)malloc(sizeof(size_t) * nr_nodes)) == NULL ||
+        (pieces_left = (int *)malloc(sizeof(int) * nr_nodes)) == NULL ||
+        (pieces_posted = (int *)calloc(nr_nodes, sizeof(int))) == NULL ||
+        (pieces_sent = (int *)calloc(nr_nodes, sizeof(int))) == NULL)
+      error("Failed to allocate redistribute pieces counters.");
+    for (int k = 0; k < nr_nodes; k++) {
+      piece_send[k] = engine_redistribute_piece(base_piece, counts[k], tag_ub,
+                                                sizeofparts);
+      piece_recv[k] = engine_redistribute_piece(
+          base_piece, recv_counts[k], tag_ub, sizeofparts);
+      pieces_left[k] = (k == nodeID) ? 0
+                                     : (recv_counts[k] + piece_recv[k] - 1) /
+                                           piece_recv[k];
+    }
 
-    /* Prepare MPI requests for the asynchronous communications */
-    MPI_Request *reqs;
-    if ((reqs = (MPI_Request *)malloc(sizeof(MPI_Request) * 2 * nr_nodes)) ==
-        NULL)
+    /* Requests of a window of receives per node followed by the slots of
+     * the sends. */
+    const int nr_slots = engine_redistribute_pieces_in_flight;
+    const int nr_recv_reqs = nr_nodes * nr_slots;
+    const int nr_reqs = nr_recv_reqs + nr_slots;
+    MPI_Request *reqs = NULL;
+    int *done = NULL;
+    if ((reqs = (MPI_Request *)malloc(sizeof(MPI_Request) * nr_reqs)) ==
+            NULL ||
+        (done = (int *)malloc(sizeof(int) * nr_reqs)) == NULL)
       error("Failed to allocate MPI request list.");
+    for (int r = 0; r < nr_reqs; r++) reqs[r] = MPI_REQUEST_NULL;
 
-    /* Only send and receive only "chunk" particles per request. So we need to
-     * loop as many times as necessary here. Make 2Gb/sizeofparts so we only
-     * send 2Gb packets. */
-    const int chunk = INT_MAX / sizeofparts;
-    int sent = 0;
-    int recvd = 0;
-
-    int activenodes = 1;
-    while (activenodes) {
-
-      for (int k = 0; k < 2 * nr_nodes; k++) reqs[k] = MPI_REQUEST_NULL;
-
-      /* Emit the sends and recvs for the data. */
-      size_t offset_send = sent;
-      size_t offset_recv = recvd;
-      activenodes = 0;
-
-      for (int k = 0; k < nr_nodes; k++) {
-
-        /* Indices in the count arrays of the node of interest */
-        const int ind_send = nodeID * nr_nodes + k;
-        const int ind_recv = k * nr_nodes + nodeID;
-
-        /* Are we sending any data this loop? */
-        int sending = counts[ind_send] - sent;
-        if (sending > 0) {
-          activenodes++;
-          if (sending > chunk) sending = chunk;
-
-          /* If the send and receive is local then just copy. */
-          if (k == nodeID) {
-            int receiving = counts[ind_recv] - recvd;
-            if (receiving > chunk) receiving = chunk;
-            memcpy(&parts_new[offset_recv * sizeofparts],
-                   &parts[offset_send * sizeofparts], sizeofparts * receiving);
-          } else {
-            /* Otherwise send it. */
-            int res =
-                MPI_Isend(&parts[offset_send * sizeofparts], sending, mpi_type,
-                          k, ind_send, MPI_COMM_WORLD, &reqs[2 * k + 0]);
-            if (res != MPI_SUCCESS)
-              mpi_error(res, "Failed to isend parts to node %i.", k);
-          }
-        }
+    /* Post the first receives, the pieces from a given node arrive in order
+     * and each completed receive is replaced by the next one. */
+    for (int k = 0; k < nr_nodes; k++) {
+      if (k == nodeID) continue;
+      for (int w = 0; w < nr_slots; w++)
+        engine_redistribute_recv_next(parts_new, recv_counts, offsets_recv,
+                                      pieces_posted, piece_recv, sizeofparts,
+                                      mpi_type, k, &reqs[k * nr_slots + w]);
+    }
 
-        /* If we're sending to this node, then move past it to next. */
-        if (counts[ind_send] > 0) offset_send += counts[ind_send];
-
-        /* Are we receiving any data from this node? Note already done if coming
-         * from this node. */
-        if (k != nodeID) {
-          int receiving = counts[ind_recv] - recvd;
-          if (receiving > 0) {
-            activenodes++;
-            if (receiving > chunk) receiving = chunk;
-            int res = MPI_Irecv(&parts_new[offset_recv * sizeofparts],
-                                receiving, mpi_type, k, ind_recv,
-                                MPI_COMM_WORLD, &reqs[2 * k + 1]);
-            if (res != MPI_SUCCESS)
-              mpi_error(res, "Failed to emit irecv of parts from node %i.", k);
-          }
+    /* Emit the first sends, going round the nodes. Each slot is refilled
+     * with the next piece as soon as its send completes. */
+    int next_node = (nodeID + 1) % nr_nodes;
+    for (int slot = 0; slot < nr_slots; slot++)
+      engine_redistribute_send_next(parts, counts, offsets_send, pieces_sent,
+                                    &next_node, piece_send, sizeofparts,
+                                    mpi_type, nr_nodes, nodeID,
+                                    &reqs[nr_recv_reqs + slot]);
+
+    /* Copy our own particles while the messages are in flight. */
+    memcpy(&parts_new[offsets_recv[nodeID] * sizeofparts],
+           &parts[offsets_send[nodeID] * sizeofparts],
+           sizeofparts * counts[nodeID]);
+
+    /* Deal with the nodes we do not expect anything from. */
+    if (arrived != NULL)
+      for (int k = 0; k < nr_nodes; k++)
+        if (pieces_left[k] == 0) arrived(k, parts_new, arrived_data);
+
+    /* Wait for the messages to tumble in and keep the sends going. */
+    while (1) {
+
+      int nr_done = 0;
+      const int res = MPI_Waitsome(nr_reqs, reqs, &nr_done, done,
+                                   MPI_STATUSES_IGNORE);
+      if (res != MPI_SUCCESS)
+        mpi_error(res, "Failed during waitsome for %s data.", label);
+      if (nr_done == MPI_UNDEFINED) break;
+
+      for (int i = 0; i < nr_done; i++) {
+        const int r = done[i];
+
+        /* A receive completed, post the next one. Is this node done? */
+        if (r < nr_recv_reqs) {
+          const int k = r / nr_slots;
+          engine_redistribute_recv_next(parts_new, recv_counts, offsets_recv,
+                                        pieces_posted, piece_recv,
+                                        sizeofparts, mpi_type, k, &reqs[r]);
+          pieces_left[k]--;
+          if (pieces_left[k] == 0 && arrived != NULL)
+            arrived(k, parts_new, arrived_data);
+          continue;
         }
 
-        /* If we're receiving from this node, then move past it to next. */
-        if (counts[ind_recv] > 0) offset_recv += counts[ind_recv];
+        /* A send completed, emit the next one in its slot. */
+        engine_redistribute_send_next(parts, counts, offsets_send,
+                                      pieces_sent, &next_node, piece_send,
+                                      sizeofparts, mpi_type, nr_nodes, nodeID,
+                                      &reqs[r]);
       }
-
-      /* Wait for all the sends and recvs to tumble in. */
-      MPI_Status stats[2 * nr_nodes];
-      int res;
-      if ((res = MPI_Waitall(2 * nr_nodes, reqs, stats)) != MPI_SUCCESS) {
-        for (int k = 0; k < 2 * nr_nodes; k++) {
-          char buff[MPI_MAX_ERROR_STRING];
-          MPI_Error_string(stats[k].MPI_ERROR, buff, &res);
-          message("request from source %i, tag %i has error '%s'.",
-                  stats[k].MPI_SOURCE, stats[k].MPI_TAG, buff);
-        }
-        error("Failed during waitall for part data.");
-      }
-
-      /* Move to next chunks. */
-      sent += chunk;
-      recvd += chunk;
     }
 
     /* Free temps. */
     free(reqs);
+    free(done);
+    free(piece_send);
+    free(piece_recv);
+    free(pieces_left);
+    free(pieces_posted);
+    free(pieces_sent);
   }
 
+  free(offsets_send);
+  free(offsets_recv);
+
   /* And return new memory. */
   return parts_new;
 }
@@ -244,7 +399,6 @@ static void *engine_do_redistribute(const char *label, int *counts, char *parts,
 struct redist_mapper_data {
   int *counts;
   int *dest;
-  int nodeID;
   int nr_nodes;
   struct cell *cells;
   struct space *s;
@@ -264,8 +418,7 @@ struct redist_mapper_data {
     int *dest =                                                            \
         mydata->dest + (ptrdiff_t)(parts - (struct TYPE *)mydata->base);   \
     int *lcounts = NULL;                                                   \
-    if ((lcounts = (int *)calloc(                                          \
-             sizeof(int), mydata->nr_nodes * mydata->nr_nodes)) == NULL)   \
+    if ((lcounts = (int *)calloc(sizeof(int), mydata->nr_nodes)) == NULL)  \
       error("Failed to allocate counts thread-specific buffer");           \
     for (int k = 0; k < num_elements; k++) {                               \
       for (int j = 0; j < 3; j++) {                                        \
@@ -278,10 +431,9 @@ struct redist_mapper_data {
                                  parts[k].x[1] * s->iwidth[1],             \
                                  parts[k].x[2] * s->iwidth[2]);            \
       dest[k] = s->cells_top[cid].nodeID;                                  \
-      size_t ind = mydata->nodeID * mydata->nr_nodes + dest[k];            \
-      lcounts[ind] += 1;                                                   \
+      lcounts[dest[k]] += 1;                                               \
     }                                                                      \
-    for (int k = 0; k < (mydata->nr_nodes * mydata->nr_nodes); k++)        \
+    for (int k = 0; k < mydata->nr_nodes; k++)                             \
       atomic_add(&mydata->counts[k], lcounts[k]);                          \
     free(lcounts);                                                         \
   }
@@ -324,10 +476,8 @@ static void ENGINE_REDISTRIBUTE_DEST_MAPPER(bpart);
 
 /* Support for saving the linkage between gparts and parts/sparts. */
 struct savelink_mapper_data {
-  int nr_nodes;
   int *counts;
   void *parts;
-  int nodeID;
 };
 
 /**
@@ -345,8 +495,6 @@ struct savelink_mapper_data {
     int *nodes = (int *)map_data;                                              \
     struct savelink_mapper_data *mydata =                                      \
         (struct savelink_mapper_data *)extra_data;                             \
-    int nodeID = mydata->nodeID;                                               \
-    int nr_nodes = mydata->nr_nodes;                                           \
     int *counts = mydata->counts;                                              \
     struct TYPE *parts = (struct TYPE *)mydata->parts;                         \
                                                                                \
@@ -354,9 +502,9 @@ struct savelink_mapper_data {
       int node = nodes[j];                                                     \
       int count = 0;                                                           \
       size_t offset = 0;                                                       \
-      for (int i = 0; i < node; i++) offset += counts[nodeID * nr_nodes + i];  \
+      for (int i = 0; i < node; i++) offset += counts[i];                      \
                                                                                \
-      for (int k = 0; k < counts[nodeID * nr_nodes + node]; k++) {             \
+      for (int k = 0; k < counts[node]; k++) {                                 \
         if (parts[k + offset].gpart != NULL) {                                 \
           if (CHECKS)                                                          \
             if (parts[k + offset].gpart->id_or_neg_offset > 0)                 \
@@ -400,103 +548,90 @@ static void ENGINE_REDISTRIBUTE_SAVELINK_MAPPER(bpart, 0);
 
 #endif /* savelink_mapper_data */
 
-#ifdef WITH_MPI /* relink_mapper_data */
+#ifdef WITH_MPI /* relink_data */
 
 /* Support for relinking parts, gparts, sparts and bparts after moving between
  * nodes. */
-struct relink_mapper_data {
-  int nodeID;
-  int nr_nodes;
-  int *counts;
-  int *s_counts;
+struct relink_data {
+
+  /* Where the particles received from each node start. */
+  size_t *offsets_parts;
+  size_t *offsets_gparts;
+  size_t *offsets_sparts;
+  size_t *offsets_bparts;
+
+  /* The number of gparts received from each node. */
   int *g_counts;
-  int *b_counts;
+
   struct space *s;
 };
 
 /**
- * @brief Restore the part/gpart and spart/gpart links for a list of nodes.
+ * @brief Restore the part/gpart, spart/gpart and bpart/gpart links of the
+ * gparts received from a node.
  *
- * @param map_data address of nodes to process.
- * @param num_elements the number nodes to process.
- * @param extra_data additional data defining the context (a
- * relink_mapper_data).
+ * Called by engine_do_redistribute() as soon as the gparts of a node have
+ * arrived, the other particle types must already be in place.
+ *
+ * @param node the node the gparts were received from.
+ * @param parts_new the new gpart array.
+ * @param extra_data additional data defining the context (a relink_data).
  */
-static void engine_redistribute_relink_mapper(void *map_data, int num_elements,
-                                              void *extra_data) {
-
-  int *nodes = (int *)map_data;
-  struct relink_mapper_data *mydata = (struct relink_mapper_data *)extra_data;
-
-  int nodeID = mydata->nodeID;
-  int nr_nodes = mydata->nr_nodes;
-  int *counts = mydata->counts;
-  int *g_counts = mydata->g_counts;
-  int *s_counts = mydata->s_counts;
-  int *b_counts = mydata->b_counts;
+static void engine_redistribute_relink(int node, void *parts_new,
+                                       void *extra_data) {
+
+  struct relink_data *mydata = (struct relink_data *)extra_data;
+  struct gpart *gparts = (struct gpart *)parts_new;
   struct space *s = mydata->s;
 
-  for (int i = 0; i < num_elements; i++) {
-
-    int node = nodes[i];
-
-    /* Get offsets to correct parts of the counts arrays for this node. */
-    size_t offset_parts = 0;
-    size_t offset_gparts = 0;
-    size_t offset_sparts = 0;
-    size_t offset_bparts = 0;
-    for (int n = 0; n < node; n++) {
-      int ind_recv = n * nr_nodes + nodeID;
-      offset_parts += counts[ind_recv];
-      offset_gparts += g_counts[ind_recv];
-      offset_sparts += s_counts[ind_recv];
-      offset_bparts += b_counts[ind_recv];
-    }
+  /* Get offsets to correct parts of the arrays for this node. */
+  const size_t offset_parts = mydata->offsets_parts[node];
+  const size_t offset_gparts = mydata->offsets_gparts[node];
+  const size_t offset_sparts = mydata->offsets_sparts[node];
+  const size_t offset_bparts = mydata->offsets_bparts[node];
 
-    /* Number of gparts sent from this node. */
-    int ind_recv = node * nr_nodes + nodeID;
-    const size_t count_gparts = g_counts[ind_recv];
+  /* Number of gparts sent from this node. */
+  const size_t count_gparts = mydata->g_counts[node];
 
-    /* Loop over the gparts received from this node */
-    for (size_t k = offset_gparts; k < offset_gparts + count_gparts; k++) {
+  /* Loop over the gparts received from this node */
+  for (size_t k = offset_gparts; k < offset_gparts + count_gparts; k++) {
 
-      /* Does this gpart have a gas partner ? */
-      if (s->gparts[k].type == swift_type_gas) {
+    /* Does this gpart have a gas partner ? */
+    if (gparts[k].type == swift_type_gas) {
 
-        const ptrdiff_t partner_index =
-            offset_parts - s->gparts[k].id_or_neg_offset;
+      const ptrdiff_t partner_index =
+          offset_parts - gparts[k].id_or_neg_offset;
 
-        /* Re-link */
-        s->gparts[k].id_or_neg_offset = -partner_index;
-        s->parts[partner_index].gpart = &s->gparts[k];
-      }
+      /* Re-link */
+      gparts[k].id_or_neg_offset = -partner_index;
+      s->parts[partner_index].gpart = &gparts[k];
+    }
 
-      /* Does this gpart have a star partner ? */
-      else if (s->gparts[k].type == swift_type_stars) {
+    /* Does this gpart have a star partner ? */
+    else if (gparts[k].type == swift_type_stars) {
 
-        const ptrdiff_t partner_index =
-            offset_sparts - s->gparts[k].id_or_neg_offset;
+      const ptrdiff_t partner_index =
+          offset_sparts - gparts[k].id_or_neg_offset;
 
-        /* Re-link */
-        s->gparts[k].id_or_neg_offset = -partner_index;
-        s->sparts[partner_index].gpart = &s->gparts[k];
-      }
+      /* Re-link */
+      gparts[k].id_or_neg_offset = -partner_index;
+      s->sparts[partner_index].gpart = &gparts[k];
+    }
 
-      /* Does this gpart have a black hole partner ? */
-      else if (s->gparts[k].type == swift_type_black_hole) {
+    /* Does this gpart have a black hole partner ? */
+    else if (gparts[k].type == swift_type_black_hole) {
 
-        const ptrdiff_t partner_index =
-            offset_bparts - s->gparts[k].id_or_neg_offset;
+      const ptrdiff_t partner_index =
+          offset_bparts - gparts[k].id_or_neg_offset;
 
-        /* Re-link */
-        s->gparts[k].id_or_neg_offset = -partner_index;
-        s->bparts[partner_index].gpart = &s->gparts[k];
-      }
+      /* Re-link */
+      gparts[k].id_or_neg_offset = -partner_index;
+      s->bparts[partner_index].gpart = &gparts[k];
     }
   }
 }
 
-#endif /* relink_mapper_data */
+#endif /* relink_data */
 
 /**
  * @brief Redistribute the particles amongst the nodes according
@@ -505,12 +640,17 @@ static void engine_redistribute_relink_mapper(void *map_data, int num_elements,
  * The strategy here is as follows:
  * 1) Each node counts the number of particles it has to send to each other
  * node.
- * 2) The number of particles of each type is then exchanged.
+ * 2) The number of particles of each type is then exchanged with each
+ * other node in a single all-to-all.
  * 3) The particles to send are placed in a temporary buffer in which the
  * part-gpart links are preserved.
  * 4) Each node allocates enough space for the new particles.
  * 5) Asynchronous or synchronous communications are issued to transfer the
- * data.
+ * data, one type at a time. The asynchronous ones are cut into pieces that
+ * keep the data in flight within DomainDecomposition:redistribute_buffer_MB.
+ * 6) The gparts are sent last, such that their links to the other types can
+ * be restored as soon as the gparts of a given node have arrived, while the
+ * others are still in flight.
  *
  *
  * @param e The #engine.
@@ -645,9 +785,9 @@ void engine_redistribute(struct engine *e) {
   /* Now we are ready to deal with real particles and can start the exchange. */
 
   /* Allocate temporary arrays to store the counts of particles to be sent
-   * and the destination of each particle */
+   * to each node and the destination of each particle */
   int *counts;
-  if ((counts = (int *)calloc(sizeof(int), nr_nodes * nr_nodes)) == NULL)
+  if ((counts = (int *)calloc(sizeof(int), nr_nodes)) == NULL)
     error("Failed to allocate counts temporary buffer.");
 
   int *dest;
@@ -663,7 +803,6 @@ void engine_redistribute(struct engine *e) {
   /* Get destination of each particle */
   struct redist_mapper_data redist_data;
   redist_data.s = s;
-  redist_data.nodeID = nodeID;
   redist_data.nr_nodes = nr_nodes;
 
   redist_data.counts = counts;
@@ -676,8 +815,7 @@ void engine_redistribute(struct engine *e) {
 
   /* Sort the particles according to their cell index. */
   if (nr_parts > 0)
-    space_parts_sort(s->parts, s->xparts, dest, &counts[nodeID * nr_nodes],
-                     nr_nodes, 0);
+    space_parts_sort(s->parts, s->xparts, dest, counts, nr_nodes, 0);
 
 #ifdef SWIFT_DEBUG_CHECKS
   /* Verify that the part have been sorted correctly. */
@@ -714,10 +852,8 @@ void engine_redistribute(struct engine *e) {
   if (nr_parts > 0 && nr_gparts > 0) {
 
     struct savelink_mapper_data savelink_data;
-    savelink_data.nr_nodes = nr_nodes;
     savelink_data.counts = counts;
     savelink_data.parts = (void *)parts;
-    savelink_data.nodeID = nodeID;
     threadpool_map(&e->threadpool, engine_redistribute_savelink_mapper_part,
                    nodes, nr_nodes, sizeof(int), threadpool_auto_chunk_size,
                    &savelink_data);
@@ -726,7 +862,7 @@ void engine_redistribute(struct engine *e) {
 
   /* Get destination of each s-particle */
   int *s_counts;
-  if ((s_counts = (int *)calloc(sizeof(int), nr_nodes * nr_nodes)) == NULL)
+  if ((s_counts = (int *)calloc(sizeof(int), nr_nodes)) == NULL)
     error("Failed to allocate s_counts temporary buffer.");
 
   int *s_dest;
@@ -743,8 +879,7 @@ void engine_redistribute(struct engine *e) {
 
   /* Sort the particles according to their cell index. */
   if (nr_sparts > 0)
-    space_sparts_sort(s->sparts, s_dest, &s_counts[nodeID * nr_nodes], nr_nodes,
-                      0);
+    space_sparts_sort(s->sparts, s_dest, s_counts, nr_nodes, 0);
 
 #ifdef SWIFT_DEBUG_CHECKS
   /* Verify that the spart have been sorted correctly. */
@@ -780,10 +915,8 @@ void engine_redistribute(struct engine *e) {
   if (nr_sparts > 0) {
 
     struct savelink_mapper_data savelink_data;
-    savelink_data.nr_nodes = nr_nodes;
     savelink_data.counts = s_counts;
     savelink_data.parts = (void *)sparts;
-    savelink_data.nodeID = nodeID;
     threadpool_map(&e->threadpool, engine_redistribute_savelink_mapper_spart,
                    nodes, nr_nodes, sizeof(int), threadpool_auto_chunk_size,
                    &savelink_data);
@@ -792,7 +925,7 @@ void engine_redistribute(struct engine *e) {
 
   /* Get destination of each b-particle */
   int *b_counts;
-  if ((b_counts = (int *)calloc(sizeof(int), nr_nodes * nr_nodes)) == NULL)
+  if ((b_counts = (int *)calloc(sizeof(int), nr_nodes)) == NULL)
     error("Failed to allocate b_counts temporary buffer.");
 
   int *b_dest;
@@ -809,8 +942,7 @@ void engine_redistribute(struct engine *e) {
 
   /* Sort the particles according to their cell index. */
   if (nr_bparts > 0)
-    space_bparts_sort(s->bparts, b_dest, &b_counts[nodeID * nr_nodes], nr_nodes,
-                      0);
+    space_bparts_sort(s->bparts, b_dest, b_counts, nr_nodes, 0);
 
 #ifdef SWIFT_DEBUG_CHECKS
   /* Verify that the bpart have been sorted correctly. */
@@ -846,10 +978,8 @@ void engine_redistribute(struct engine *e) {
   if (nr_bparts > 0) {
 
     struct savelink_mapper_data savelink_data;
-    savelink_data.nr_nodes = nr_nodes;
     savelink_data.counts = b_counts;
     savelink_data.parts = (void *)bparts;
-    savelink_data.nodeID = nodeID;
     threadpool_map(&e->threadpool, engine_redistribute_savelink_mapper_bpart,
                    nodes, nr_nodes, sizeof(int), threadpool_auto_chunk_size,
                    &savelink_data);
@@ -858,7 +988,7 @@ void engine_redistribute(struct engine *e) {
 
   /* Get destination of each g-particle */
   int *g_counts;
-  if ((g_counts = (int *)calloc(sizeof(int), nr_nodes * nr_nodes)) == NULL)
+  if ((g_counts = (int *)calloc(sizeof(int), nr_nodes)) == NULL)
     error("Failed to allocate g_gcount temporary buffer.");
 
   int *g_dest;
@@ -876,7 +1006,7 @@ void engine_redistribute(struct engine *e) {
   /* Sort the gparticles according to their cell index. */
   if (nr_gparts > 0)
     space_gparts_sort(s->gparts, s->parts, s->sinks, s->sparts, s->bparts,
-                      g_dest, &g_counts[nodeID * nr_nodes], nr_nodes);
+                      g_dest, g_counts, nr_nodes);
 
 #ifdef SWIFT_DEBUG_CHECKS
   /* Verify that the gpart have been sorted correctly. */
@@ -911,77 +1041,88 @@ void engine_redistribute(struct engine *e) {
 
   swift_free("g_dest", g_dest);
 
-  /* Get all the counts from all the nodes. */
-  if (MPI_Allreduce(MPI_IN_PLACE, counts, nr_nodes * nr_nodes, MPI_INT, MPI_SUM,
-                    MPI_COMM_WORLD) != MPI_SUCCESS)
-    error("Failed to allreduce particle transfer counts.");
-
-  /* Get all the g_counts from all the nodes. */
-  if (MPI_Allreduce(MPI_IN_PLACE, g_counts, nr_nodes * nr_nodes, MPI_INT,
-                    MPI_SUM, MPI_COMM_WORLD) != MPI_SUCCESS)
-    error("Failed to allreduce gparticle transfer counts.");
-
-  /* Get all the s_counts from all the nodes. */
-  if (MPI_Allreduce(MPI_IN_PLACE, s_counts, nr_nodes * nr_nodes, MPI_INT,
-                    MPI_SUM, MPI_COMM_WORLD) != MPI_SUCCESS)
-    error("Failed to allreduce sparticle transfer counts.");
-
-  /* Get all the b_counts from all the nodes. */
-  if (MPI_Allreduce(MPI_IN_PLACE, b_counts, nr_nodes * nr_nodes, MPI_INT,
-                    MPI_SUM, MPI_COMM_WORLD) != MPI_SUCCESS)
-    error("Failed to allreduce bparticle transfer counts.");
+  /* Tell each node how many particles of each type it will get from us and
+   * get the same from each of them. We also send the number of particles of
+   * each type we have and keep, such that the verbose rank can report the
+   * totals without an extra collective. */
+  long long *sendbuf = NULL, *recvbuf = NULL;
+  if ((sendbuf = (long long *)malloc(sizeof(long long) * 12 * nr_nodes)) ==
+          NULL ||
+      (recvbuf = (long long *)malloc(sizeof(long long) * 12 * nr_nodes)) ==
+          NULL)
+    error("Failed to allocate transfer counts buffers.");
+  long long local_totals[4] = {0, 0, 0, 0};
+  for (int k = 0; k < nr_nodes; k++) {
+    local_totals[0] += counts[k];
+    local_totals[1] += g_counts[k];
+    local_totals[2] += s_counts[k];
+    local_totals[3] += b_counts[k];
+  }
+  for (int k = 0; k < nr_nodes; k++) {
+    long long *buf = &sendbuf[12 * k];
+    buf[0] = counts[k];
+    buf[1] = g_counts[k];
+    buf[2] = s_counts[k];
+    buf[3] = b_counts[k];
+    for (int j = 0; j < 4; j++) buf[4 + j] = local_totals[j];
+    buf[8] = counts[nodeID];
+    buf[9] = g_counts[nodeID];
+    buf[10] = s_counts[nodeID];
+    buf[11] = b_counts[nodeID];
+  }
+  if (MPI_Alltoall(sendbuf, 12, MPI_LONG_LONG, recvbuf, 12, MPI_LONG_LONG,
+                   MPI_COMM_WORLD) != MPI_SUCCESS)
+    error("Failed to exchange particle transfer counts.");
+
+  int *recv_counts = NULL, *g_recv_counts = NULL, *s_recv_counts = NULL,
+      *b_recv_counts = NULL;
+  if ((recv_counts = (int *)malloc(sizeof(int) * nr_nodes)) == NULL ||
+      (g_recv_counts = (int *)malloc(sizeof(int) * nr_nodes)) == NULL ||
+      (s_recv_counts = (int *)malloc(sizeof(int) * nr_nodes)) == NULL ||
+      (b_recv_counts = (int *)malloc(sizeof(int) * nr_nodes)) == NULL)
+    error("Failed to allocate received counts buffers.");
+  for (int k = 0; k < nr_nodes; k++) {
+    recv_counts[k] = recvbuf[12 * k + 0];
+    g_recv_counts[k] = recvbuf[12 * k + 1];
+    s_recv_counts[k] = recvbuf[12 * k + 2];
+    b_recv_counts[k] = recvbuf[12 * k + 3];
+  }
 
   /* Report how many particles will be moved. */
   if (e->verbose) {
-    if (e->nodeID == 0) {
-      size_t total = 0, g_total = 0, s_total = 0, b_total = 0;
-      size_t unmoved = 0, g_unmoved = 0, s_unmoved = 0, b_unmoved = 0;
-      for (int p = 0, r = 0; p < nr_nodes; p++) {
-        for (int n = 0; n < nr_nodes; n++) {
-          total += counts[r];
-          g_total += g_counts[r];
-          s_total += s_counts[r];
-          b_total += b_counts[r];
-          if (p == n) {
-            unmoved += counts[r];
-            g_unmoved += g_counts[r];
-            s_unmoved += s_counts[r];
-            b_unmoved += b_counts[r];
-          }
-          r++;
-        }
-      }
-      if (total > 0)
-        message("%zu of %zu (%.2f%%) of particles moved", total - unmoved,
-                total, 100.0 * (double)(total - unmoved) / (double)total);
-      if (g_total > 0)
-        message("%zu of %zu (%.2f%%) of g-particles moved", g_total - g_unmoved,
-                g_total,
-                100.0 * (double)(g_total - g_unmoved) / (double)g_total);
-      if (s_total > 0)
-        message("%zu of %zu (%.2f%%) of s-particles moved", s_total - s_unmoved,
-                s_total,
-                100.0 * (double)(s_total - s_unmoved) / (double)s_total);
-      if (b_total > 0)
-        message("%ld of %ld (%.2f%%) of b-particles moved", b_total - b_unmoved,
-                b_total,
-                100.0 * (double)(b_total - b_unmoved) / (double)b_total);
-    }
+    long long moved[8] = {0};
+    for (int k = 0; k < nr_nodes; k++)
+      for (int j = 0; j < 8; j++) moved[j] += recvbuf[12 * k + 4 + j];
+
+    const size_t total = moved[0], g_total = moved[1], s_total = moved[2],
+                 b_total = moved[3];
+    const size_t unmoved = moved[4], g_unmoved = moved[5],
+                 s_unmoved = moved[6], b_unmoved = moved[7];
+    if (total > 0)
+      message("%zu of %zu (%.2f%%) of particles moved", total - unmoved,
+              total, 100.0 * (double)(total - unmoved) / (double)total);
+    if (g_total > 0)
+      message("%zu of %zu (%.2f%%) of g-particles moved", g_total - g_unmoved,
+              g_total, 100.0 * (double)(g_total - g_unmoved) / (double)g_total);
+    if (s_total > 0)
+      message("%zu of %zu (%.2f%%) of s-particles moved", s_total - s_unmoved,
+              s_total, 100.0 * (double)(s_total - s_unmoved) / (double)s_total);
+    if (b_total > 0)
+      message("%zu of %zu (%.2f%%) of b-particles moved", b_total - b_unmoved,
+              b_total, 100.0 * (double)(b_total - b_unmoved) / (double)b_total);
   }
+  free(sendbuf);
+  free(recvbuf);
 
-  /* Now each node knows how many parts, sparts, bparts, and gparts will be
-   * transferred to every other node. Get the new numbers of particles for this
+  /* Now each node knows how many parts, sparts, bparts, and gparts it will
+   * receive from every other node. Get the new numbers of particles for this
    * node. */
   size_t nr_parts_new = 0, nr_gparts_new = 0, nr_sparts_new = 0,
          nr_bparts_new = 0;
-  for (int k = 0; k < nr_nodes; k++)
-    nr_parts_new += counts[k * nr_nodes + nodeID];
-  for (int k = 0; k < nr_nodes; k++)
-    nr_gparts_new += g_counts[k * nr_nodes + nodeID];
-  for (int k = 0; k < nr_nodes; k++)
-    nr_sparts_new += s_counts[k * nr_nodes + nodeID];
-  for (int k = 0; k < nr_nodes; k++)
-    nr_bparts_new += b_counts[k * nr_nodes + nodeID];
+  for (int k = 0; k < nr_nodes; k++) nr_parts_new += recv_counts[k];
+  for (int k = 0; k < nr_nodes; k++) nr_gparts_new += g_recv_counts[k];
+  for (int k = 0; k < nr_nodes; k++) nr_sparts_new += s_recv_counts[k];
+  for (int k = 0; k < nr_nodes; k++) nr_bparts_new += b_recv_counts[k];
 
 #ifdef WITH_LOGGER
   if (e->policy & engine_policy_logger) {
@@ -992,7 +1133,7 @@ void engine_redistribute(struct engine *e) {
     size_t bpart_offset = 0;
 
     for (int i = 0; i < nr_nodes; i++) {
-      const size_t c_ind = engine_rank * nr_nodes + i;
+      const size_t c_ind = i;
 
       /* No need to log the local particles. */
       if (i == engine_rank) {
@@ -1035,8 +1176,9 @@ void engine_redistribute(struct engine *e) {
 
   /* SPH particles. */
   void *new_parts = engine_do_redistribute(
-      "parts", counts, (char *)s->parts, nr_parts_new, sizeof(struct part),
-      part_align, part_mpi_type, nr_nodes, nodeID, e->syncredist);
+      "parts", counts, recv_counts, (char *)s->parts, nr_parts_new,
+      sizeof(struct part), part_align, part_mpi_type, nr_nodes, nodeID,
+      e->syncredist, e->redist_buffer_size, NULL, NULL);
   swift_free("parts", s->parts);
   s->parts = (struct part *)new_parts;
   s->nr_parts = nr_parts_new;
@@ -1044,41 +1186,70 @@ void engine_redistribute(struct engine *e) {
 
   /* Extra SPH particle properties. */
   new_parts = engine_do_redistribute(
-      "xparts", counts, (char *)s->xparts, nr_parts_new, sizeof(struct xpart),
-      xpart_align, xpart_mpi_type, nr_nodes, nodeID, e->syncredist);
+      "xparts", counts, recv_counts, (char *)s->xparts, nr_parts_new,
+      sizeof(struct xpart), xpart_align, xpart_mpi_type, nr_nodes, nodeID,
+      e->syncredist, e->redist_buffer_size, NULL, NULL);
   swift_free("xparts", s->xparts);
   s->xparts = (struct xpart *)new_parts;
 
-  /* Gravity particles. */
-  new_parts =
-      engine_do_redistribute("gparts", g_counts, (char *)s->gparts,
-                             nr_gparts_new, sizeof(struct gpart), gpart_align,
-                             gpart_mpi_type, nr_nodes, nodeID, e->syncredist);
-  swift_free("gparts", s->gparts);
-  s->gparts = (struct gpart *)new_parts;
-  s->nr_gparts = nr_gparts_new;
-  s->size_gparts = engine_redistribute_alloc_margin * nr_gparts_new;
-
   /* Star particles. */
-  new_parts =
-      engine_do_redistribute("sparts", s_counts, (char *)s->sparts,
-                             nr_sparts_new, sizeof(struct spart), spart_align,
-                             spart_mpi_type, nr_nodes, nodeID, e->syncredist);
+  new_parts = engine_do_redistribute(
+      "sparts", s_counts, s_recv_counts, (char *)s->sparts, nr_sparts_new,
+      sizeof(struct spart), spart_align, spart_mpi_type, nr_nodes, nodeID,
+      e->syncredist, e->redist_buffer_size, NULL, NULL);
   swift_free("sparts", s->sparts);
   s->sparts = (struct spart *)new_parts;
   s->nr_sparts = nr_sparts_new;
   s->size_sparts = engine_redistribute_alloc_margin * nr_sparts_new;
 
   /* Black holes particles. */
-  new_parts =
-      engine_do_redistribute("bparts", b_counts, (char *)s->bparts,
-                             nr_bparts_new, sizeof(struct bpart), bpart_align,
-                             bpart_mpi_type, nr_nodes, nodeID, e->syncredist);
+  new_parts = engine_do_redistribute(
+      "bparts", b_counts, b_recv_counts, (char *)s->bparts, nr_bparts_new,
+      sizeof(struct bpart), bpart_align, bpart_mpi_type, nr_nodes, nodeID,
+      e->syncredist, e->redist_buffer_size, NULL, NULL);
   swift_free("bparts", s->bparts);
   s->bparts = (struct bpart *)new_parts;
   s->nr_bparts = nr_bparts_new;
   s->size_bparts = engine_redistribute_alloc_margin * nr_bparts_new;
 
+  /* Gravity particles. All their partners are now in place, so we restore
+   * the part<->gpart, spart<->gpart and bpart<->gpart links of the gparts of
+   * each node as soon as they have arrived. */
+  struct relink_data relink_data;
+  relink_data.s = s;
+  relink_data.g_counts = g_recv_counts;
+  if ((relink_data.offsets_parts =
+           (size_t *)malloc(sizeof(size_t) * 4 * nr_nodes)) == NULL)
+    error("Failed to allocate relink offsets.");
+  relink_data.offsets_gparts = relink_data.offsets_parts + nr_nodes;
+  relink_data.offsets_sparts = relink_data.offsets_parts + 2 * nr_nodes;
+  relink_data.offsets_bparts = relink_data.offsets_parts + 3 * nr_nodes;
+  relink_data.offsets_parts[0] = 0;
+  relink_data.offsets_gparts[0] = 0;
+  relink_data.offsets_sparts[0] = 0;
+  relink_data.offsets_bparts[0] = 0;
+  for (int k = 1; k < nr_nodes; k++) {
+    relink_data.offsets_parts[k] =
+        relink_data.offsets_parts[k - 1] + recv_counts[k - 1];
+    relink_data.offsets_gparts[k] =
+        relink_data.offsets_gparts[k - 1] + g_recv_counts[k - 1];
+    relink_data.offsets_sparts[k] =
+        relink_data.offsets_sparts[k - 1] + s_recv_counts[k - 1];
+    relink_data.offsets_bparts[k] =
+        relink_data.offsets_bparts[k - 1] + b_recv_counts[k - 1];
+  }
+
+  new_parts = engine_do_redistribute(
+      "gparts", g_counts, g_recv_counts, (char *)s->gparts, nr_gparts_new,
+      sizeof(struct gpart), gpart_align, gpart_mpi_type, nr_nodes, nodeID,
+      e->syncredist, e->redist_buffer_size, engine_redistribute_relink,
+      &relink_data);
+  swift_free("gparts", s->gparts);
+  s->gparts = (struct gpart *)new_parts;
+  s->nr_gparts = nr_gparts_new;
+  s->size_gparts = engine_redistribute_alloc_margin * nr_gparts_new;
+  free(relink_data.offsets_parts);
+
   /* All particles have now arrived. Time for some final operations on the
      stuff we just received */
 
@@ -1090,14 +1261,14 @@ void engine_redistribute(struct engine *e) {
     size_t bpart_offset = 0;
 
     for (int i = 0; i < nr_nodes; i++) {
-      const size_t c_ind = i * nr_nodes + engine_rank;
+      const size_t c_ind = i;
 
       /* No need to log the local particles. */
       if (i == engine_rank) {
-        part_offset += counts[c_ind];
-        spart_offset += s_counts[c_ind];
-        gpart_offset += g_counts[c_ind];
-        bpart_offset += b_counts[c_ind];
+        part_offset += recv_counts[c_ind];
+        spart_offset += s_recv_counts[c_ind];
+        gpart_offset += g_recv_counts[c_ind];
+        bpart_offset += b_recv_counts[c_ind];
         continue;
       }
 
@@ -1106,45 +1277,31 @@ void engine_redistribute(struct engine *e) {
 
       /* Log the hydro parts. */
       logger_log_parts(e->logger, &s->parts[part_offset],
-                       &s->xparts[part_offset], counts[c_ind], e,
+                       &s->xparts[part_offset], recv_counts[c_ind], e,
                        /* log_all_fields */ 1, flag);
 
       /* Log the stellar parts. */
-      logger_log_sparts(e->logger, &s->sparts[spart_offset], s_counts[c_ind], e,
+      logger_log_sparts(e->logger, &s->sparts[spart_offset], s_recv_counts[c_ind], e,
                         /* log_all_fields */ 1, flag);
 
       /* Log the gparts */
-      logger_log_gparts(e->logger, &s->gparts[gpart_offset], g_counts[c_ind], e,
+      logger_log_gparts(e->logger, &s->gparts[gpart_offset], g_recv_counts[c_ind], e,
                         /* log_all_fields */ 1, flag);
 
       /* Log the bparts */
-      if (b_counts[c_ind] > 0) {
+      if (b_recv_counts[c_ind] > 0) {
         error("TODO");
       }
 
       /* Update the counters */
-      part_offset += counts[c_ind];
-      spart_offset += s_counts[c_ind];
-      gpart_offset += g_counts[c_ind];
-      bpart_offset += b_counts[c_ind];
+      part_offset += recv_counts[c_ind];
+      spart_offset += s_recv_counts[c_ind];
+      gpart_offset += g_recv_counts[c_ind];
+      bpart_offset += b_recv_counts[c_ind];
     }
   }
 #endif
 
-  /* Restore the part<->gpart and spart<->gpart links.
-   * Generate indices and counts for threadpool tasks. Note we process a node
-   * at a time. */
-  struct relink_mapper_data relink_data;
-  relink_data.s = s;
-  relink_data.counts = counts;
-  relink_data.g_counts = g_counts;
-  relink_data.s_counts = s_counts;
-  relink_data.b_counts = b_counts;
-  relink_data.nodeID = nodeID;
-  relink_data.nr_nodes = nr_nodes;
-
-  threadpool_map(&e->threadpool, engine_redistribute_relink_mapper, nodes,
-                 nr_nodes, sizeof(int), 1, &relink_data);
   free(nodes);
 
   /* Clean up the counts now we are done. */
@@ -1152,6 +1309,10 @@ void engine_redistribute(struct engine *e) {
   free(g_counts);
   free(s_counts);
   free(b_counts);
+  free(recv_counts);
+  free(g_recv_counts);
+  free(s_recv_counts);
+  free(b_recv_counts);
 
 #ifdef SWIFT_DEBUG_CHECKS
   /* Verify that all parts are in the right place. */
@@ -0,0 +1,810 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+/* Config parameters. */
+#include "../config.h"
+
+/* Some standard headers. */
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* This object's header. */
+#include "engine.h"
+
+/* Local headers. */
+#include "atomic.h"
+#include "cell.h"
+#include "clocks.h"
+#include "cycle.h"
+#include "error.h"
+#include "memuse.h"
+#include "scheduler.h"
+#include "space.h"
+#include "threadpool.h"
+
+/**
+ * @brief A task of the first hydro loop made at the last rebuild.
+ *
+ * The cells are recycled at every rebuild, so they are identified by their
+ * top-level cell and by their rank in a depth-first traversal of its
+ * hierarchy.
+ */
+struct engine_reusetasks_entry {
+
+  /*! Type of the task (self, pair, sub-self or sub-pair) */
+  int type;
+
+  /*! Flags of the task (the sort ID of pairs) */
+  int flags;
+
+  /*! Top-level cell and depth-first rank of the first cell */
+  int top_i, rank_i;
+
+  /*! Top-level cell and depth-first rank of the second cell (-1 if none) */
+  int top_j, rank_j;
+};
+
+/**
+ * @brief The tasks of the first hydro loop made at the last rebuild.
+ *
+ * All the hydro, stars, black holes, sinks and RT loops are made from the
+ * density tasks, whose construction and splitting only depend on the
+ * hierarchies of the cells they act on. The tasks of a pair of top-level
+ * cells whose hierarchies did not change can hence be re-created from their
+ * description here instead of splitting the top-level tasks again.
+ */
+struct engine_task_recipes {
+
+  /*! Number of top-level cells the recipes refer to (0 if they are unusable) */
+  int nr_cells;
+
+  /*! Dimensions of the top-level grid the recipes refer to */
+  int cdim[3];
+
+  /*! Structural signature of each top-level cell hierarchy */
+  uint64_t *signatures;
+
+  /*! Offset of each top-level hierarchy in the depth-first list of all the
+   * cells, with a final entry for the total number of cells */
+  int *offsets;
+
+  /*! Was each cell of the depth-first list visited by the hydro tasks? */
+  char *has_tasks;
+
+  /*! The density tasks */
+  struct engine_reusetasks_entry *entries;
+
+  /*! Number of density tasks */
+  int nr_entries;
+
+  /*! Are the tasks of each top-level cell re-used at this rebuild? */
+  char *reused;
+
+  /*! Should engine_make_hydroloop_tasks_mapper() skip the re-used cells? */
+  int active;
+};
+
+/*! Data passed to the mappers of this file */
+struct engine_reusetasks_data {
+
+  /*! The #engine */
+  struct engine *e;
+
+  /*! Signatures of the current hierarchies */
+  uint64_t *signatures;
+
+  /*! Offsets of the current hierarchies in the list below */
+  int *offsets;
+
+  /*! Depth-first list of all the current cells */
+  struct cell **cells;
+
+  /*! has_tasks flag of each cell in the list above */
+  char *has_tasks;
+
+  /*! Number of tasks re-created */
+  int nr_reused_tasks;
+};
+
+/*! A task of the first hydro loop, as compared by the verification mode */
+struct engine_reusetasks_fingerprint {
+  int type;
+  long long flags;
+  const struct cell *ci, *cj;
+};
+
+/**
+ * @brief Mix a value into a hash.
+ *
+ * @param h The current hash.
+ * @param v The value to add.
+ */
+__attribute__((always_inline)) INLINE static uint64_t engine_reusetasks_mix(
+    uint64_t h, uint64_t v) {
+
+  /* splitmix64 finaliser of the value, then combine */
+  v += 0x9e3779b97f4a7c15ULL;
+  v = (v ^ (v >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  v = (v ^ (v >> 27)) * 0x94d049bb133111ebULL;
+  v ^= v >> 31;
+  return (h ^ v) * 0x100000001b3ULL + (h >> 29);
+}
+
+/**
+ * @brief Compute the structural signature of a cell hierarchy.
+ *
+ * This covers everything the construction and splitting of the density
+ * tasks depend upon: the tree structure, the node, the number of each type
+ * of particle acted upon by the hydro loops and the ability of the tasks to
+ * be split.
+ *
+ * @param c The #cell.
+ * @param h The hash of the cells visited so far.
+ * @param count (return) The number of cells visited so far.
+ */
+static uint64_t engine_reusetasks_signature_rec(const struct cell *c,
+                                                uint64_t h, int *count) {
+
+  int progeny_mask = 0;
+  if (c->split)
+    for (int k = 0; k < 8; k++)
+      if (c->progeny[k] != NULL) progeny_mask |= (1 << k);
+
+  const uint64_t flags = (uint64_t)progeny_mask |
+                         ((uint64_t)c->split << 8) |
+                         ((uint64_t)cell_can_split_pair_hydro_task(c) << 9) |
+                         ((uint64_t)cell_can_split_self_hydro_task(c) << 10) |
+                         ((uint64_t)(uint32_t)c->nodeID << 32);
+
+  h = engine_reusetasks_mix(h, flags);
+  h = engine_reusetasks_mix(h, (uint64_t)c->hydro.count);
+  h = engine_reusetasks_mix(h, (uint64_t)c->stars.count);
+  h = engine_reusetasks_mix(h, (uint64_t)c->sinks.count);
+  h = engine_reusetasks_mix(h, (uint64_t)c->black_holes.count);
+  (*count)++;
+
+  if (c->split)
+    for (int k = 0; k < 8; k++)
+      if (c->progeny[k] != NULL)
+        h = engine_reusetasks_signature_rec(c->progeny[k], h, count);
+
+  return h;
+}
+
+/**
+ * @brief Compute the signature and the number of cells of the top-level
+ * cells. Threadpool mapper function.
+ *
+ * @param map_data Pointer to the top-level cells.
+ * @param num_elements The number of cells to treat.
+ * @param extra_data Pointer to a #engine_reusetasks_data.
+ */
+static void engine_reusetasks_signature_mapper(void *map_data,
+                                               int num_elements,
+                                               void *extra_data) {
+
+  struct engine_reusetasks_data *data =
+      (struct engine_reusetasks_data *)extra_data;
+  const struct cell *cells_top = data->e->s->cells_top;
+  const struct cell *cells = (const struct cell *)map_data;
+
+  for (int ind = 0; ind < num_elements; ind++) {
+    const struct cell *c = &cells[ind];
+    const size_t cid = c - cells_top;
+    int count = 0;
+    data->signatures[cid] = engine_reusetasks_signature_rec(c, 0, &count);
+    data->offsets[cid + 1] = count;
+  }
+}
+
+/**
+ * @brief List the cells of a hierarchy in depth-first order.
+ *
+ * @param c The #cell.
+ * @param list The list of cells to fill.
+ * @param count (return) The number of cells in the list so far.
+ */
+static void engine_reusetasks_list_cells(struct cell *c, struct cell **list,
+                                         int *count) {
+
+  list[(*count)++] = c;
+  if (c->split)
+    for (int k = 0; k < 8; k++)
+      if (c->progeny[k] != NULL)
+        engine_reusetasks_list_cells(c->progeny[k], list, count);
+}
+
+/**
+ * @brief List the cells of the top-level cells in depth-first order.
+ * Threadpool mapper function.
+ *
+ * @param map_data Pointer to the top-level cells.
+ * @param num_elements The number of cells to treat.
+ * @param extra_data Pointer to a #engine_reusetasks_data.
+ */
+static void engine_reusetasks_list_mapper(void *map_data, int num_elements,
+                                          void *extra_data) {
+
+  struct engine_reusetasks_data *data =
+      (struct engine_reusetasks_data *)extra_data;
+  struct cell *cells_top = data->e->s->cells_top;
+  struct cell *cells = (struct cell *)map_data;
+
+  for (int ind = 0; ind < num_elements; ind++) {
+    struct cell *c = &cells[ind];
+    const size_t cid = c - cells_top;
+    int count = 0;
+    engine_reusetasks_list_cells(c, &data->cells[data->offsets[cid]], &count);
+  }
+}
+
+/**
+ * @brief Re-create the density tasks whose top-level cells are re-used.
+ * Threadpool mapper function.
+ *
+ * @param map_data Pointer to the #engine_reusetasks_entry.
+ * @param num_elements The number of entries to treat.
+ * @param extra_data Pointer to a #engine_reusetasks_data.
+ */
+static void engine_reusetasks_replay_mapper(void *map_data, int num_elements,
+                                            void *extra_data) {
+
+  struct engine_reusetasks_data *data =
+      (struct engine_reusetasks_data *)extra_data;
+  struct scheduler *sched = &data->e->sched;
+  const char *reused = data->e->task_recipes->reused;
+  const struct engine_reusetasks_entry *entries =
+      (const struct engine_reusetasks_entry *)map_data;
+  int count = 0;
+
+  for (int ind = 0; ind < num_elements; ind++) {
+    const struct engine_reusetasks_entry *en = &entries[ind];
+
+    /* Only the tasks between re-used cells were not made again. */
+    if (!reused[en->top_i]) continue;
+    if (en->top_j >= 0 && !reused[en->top_j]) continue;
+
+    struct cell *ci = data->cells[data->offsets[en->top_i] + en->rank_i];
+    struct cell *cj =
+        en->top_j >= 0 ? data->cells[data->offsets[en->top_j] + en->rank_j]
+                       : NULL;
+
+    scheduler_addtask(sched, (enum task_types)en->type, task_subtype_density,
+                      en->flags, 0, ci, cj);
+    count++;
+  }
+
+  atomic_add(&data->nr_reused_tasks, count);
+}
+
+/**
+ * @brief Flag the cells of the re-used top-level cells that were visited by
+ * the hydro tasks of the last rebuild. Threadpool mapper function.
+ *
+ * Splitting a task also flags the cells of the sub-tasks that turn out to be
+ * empty, so this cannot be inferred from the re-created tasks alone.
+ *
+ * @param map_data Pointer to the top-level cells.
+ * @param num_elements The number of cells to treat.
+ * @param extra_data Pointer to a #engine_reusetasks_data.
+ */
+static void engine_reusetasks_replay_flags_mapper(void *map_data,
+                                                  int num_elements,
+                                                  void *extra_data) {
+
+  struct engine_reusetasks_data *data =
+      (struct engine_reusetasks_data *)extra_data;
+  const struct engine_task_recipes *r = data->e->task_recipes;
+  const struct cell *cells_top = data->e->s->cells_top;
+  const struct cell *cells = (const struct cell *)map_data;
+
+  for (int ind = 0; ind < num_elements; ind++) {
+    const size_t cid = &cells[ind] - cells_top;
+    if (!r->reused[cid]) continue;
+
+    /* The hierarchy did not change, so neither did its size. */
+    const int count = data->offsets[cid + 1] - data->offsets[cid];
+    for (int k = 0; k < count; k++)
+      if (r->has_tasks[r->offsets[cid] + k])
+        cell_set_flag(data->cells[data->offsets[cid] + k],
+                      cell_flag_has_tasks);
+  }
+}
+
+/**
+ * @brief Record which cells of the list were visited by the hydro tasks.
+ * Threadpool mapper function.
+ *
+ * @param map_data Pointer to the depth-first list of cells.
+ * @param num_elements The number of cells to treat.
+ * @param extra_data Pointer to a #engine_reusetasks_data.
+ */
+static void engine_reusetasks_record_flags_mapper(void *map_data,
+                                                  int num_elements,
+                                                  void *extra_data) {
+
+  struct engine_reusetasks_data *data =
+      (struct engine_reusetasks_data *)extra_data;
+  struct cell **cells = (struct cell **)map_data;
+  const size_t first = cells - data->cells;
+
+  for (int ind = 0; ind < num_elements; ind++)
+    data->has_tasks[first + ind] =
+        cell_get_flag(cells[ind], cell_flag_has_tasks);
+}
+
+/**
+ * @brief Decide which top-level cells re-use their tasks.
+ *
+ * A pair task is only re-used when neither of its cells changed. We also
+ * require all the neighbours of a re-used cell to be unchanged, such that
+ * all the tasks acting on its hierarchy, and hence the cells they visited,
+ * are the same as at the last rebuild.
+ *
+ * @param e The #engine.
+ * @param signatures The signatures of the current hierarchies.
+ * @param nr_changed (return) The number of top-level cells that changed.
+ *
+ * @return The number of top-level cells re-using their tasks.
+ */
+static int engine_reusetasks_find_reused(const struct engine *e,
+                                         const uint64_t *signatures,
+                                         int *nr_changed) {
+
+  const struct space *s = e->s;
+  struct engine_task_recipes *r = e->task_recipes;
+  const int nr_cells = s->nr_cells;
+  const int periodic = s->periodic;
+  const int *cdim = s->cdim;
+
+  /* Can we compare with the last rebuild at all? */
+  const int valid = r->nr_cells == nr_cells && r->cdim[0] == cdim[0] &&
+                    r->cdim[1] == cdim[1] && r->cdim[2] == cdim[2];
+
+  char *changed = (char *)malloc(nr_cells * sizeof(char));
+  if (changed == NULL) error("Failed to allocate temporary cell flags.");
+
+  *nr_changed = 0;
+  for (int cid = 0; cid < nr_cells; cid++) {
+    changed[cid] = !valid || signatures[cid] != r->signatures[cid];
+    *nr_changed += changed[cid];
+  }
+
+  int nr_reused = 0;
+  for (int cid = 0; cid < nr_cells; cid++) {
+
+    r->reused[cid] = 0;
+    if (changed[cid]) continue;
+
+    /* Integer indices of the cell in the top-level grid */
+    const int i = cid / (cdim[1] * cdim[2]);
+    const int j = (cid / cdim[2]) % cdim[1];
+    const int k = cid % cdim[2];
+
+    int reuse = 1;
+    for (int ii = -1; ii < 2 && reuse; ii++) {
+      int iii = i + ii;
+      if (!periodic && (iii < 0 || iii >= cdim[0])) continue;
+      iii = (iii + cdim[0]) % cdim[0];
+      for (int jj = -1; jj < 2 && reuse; jj++) {
+        int jjj = j + jj;
+        if (!periodic && (jjj < 0 || jjj >= cdim[1])) continue;
+        jjj = (jjj + cdim[1]) % cdim[1];
+        for (int kk = -1; kk < 2 && reuse; kk++) {
+          int kkk = k + kk;
+          if (!periodic && (kkk < 0 || kkk >= cdim[2])) continue;
+          kkk = (kkk + cdim[2]) % cdim[2];
+          if (changed[cell_getid(cdim, iii, jjj, kkk)]) reuse = 0;
+        }
+      }
+    }
+
+    r->reused[cid] = reuse;
+    nr_reused += reuse;
+  }
+
+  free(changed);
+  return nr_reused;
+}
+
+/**
+ * @brief Order two #engine_reusetasks_fingerprint.
+ */
+static int engine_reusetasks_cmp_fingerprint(const void *a, const void *b) {
+
+  const struct engine_reusetasks_fingerprint *fa =
+      (const struct engine_reusetasks_fingerprint *)a;
+  const struct engine_reusetasks_fingerprint *fb =
+      (const struct engine_reusetasks_fingerprint *)b;
+
+  if (fa->type != fb->type) return fa->type < fb->type ? -1 : 1;
+  if (fa->flags != fb->flags) return fa->flags < fb->flags ? -1 : 1;
+  if (fa->ci != fb->ci) return (uintptr_t)fa->ci < (uintptr_t)fb->ci ? -1 : 1;
+  if (fa->cj != fb->cj) return (uintptr_t)fa->cj < (uintptr_t)fb->cj ? -1 : 1;
+  return 0;
+}
+
+/**
+ * @brief Collect the density tasks of the scheduler and the has_tasks flag
+ * of all the cells, in an order-independent way.
+ *
+ * @param e The #engine.
+ * @param data The #engine_reusetasks_data containing the list of cells.
+ * @param nr_tasks (return) The number of density tasks.
+ * @param has_tasks (return) The flags of the cells, to be freed by the caller.
+ *
+ * @return The sorted list of tasks, to be freed by the caller.
+ */
+static struct engine_reusetasks_fingerprint *engine_reusetasks_fingerprint(
+    const struct engine *e, const struct engine_reusetasks_data *data,
+    int *nr_tasks, char **has_tasks) {
+
+  const struct scheduler *sched = &e->sched;
+  const int nr_cells = data->offsets[e->s->nr_cells];
+
+  struct engine_reusetasks_fingerprint *list =
+      (struct engine_reusetasks_fingerprint *)malloc(
+          sched->nr_tasks * sizeof(struct engine_reusetasks_fingerprint));
+  if (list == NULL) error("Failed to allocate the task fingerprints.");
+
+  int count = 0;
+  for (int k = 0; k < sched->nr_tasks; k++) {
+    const struct task *t = &sched->tasks[k];
+    if (t->type == task_type_none) continue;
+    list[count].type = t->type;
+    list[count].flags = t->flags;
+    list[count].ci = t->ci;
+    list[count].cj = t->cj;
+    count++;
+  }
+  qsort(list, count, sizeof(struct engine_reusetasks_fingerprint),
+        engine_reusetasks_cmp_fingerprint);
+  *nr_tasks = count;
+
+  if ((*has_tasks = (char *)malloc(nr_cells * sizeof(char))) == NULL)
+    error("Failed to allocate the cell fingerprints.");
+  for (int k = 0; k < nr_cells; k++)
+    (*has_tasks)[k] = cell_get_flag(data->cells[k], cell_flag_has_tasks);
+
+  return list;
+}
+
+/**
+ * @brief Make the tasks of the first hydro loop, re-using the ones of the
+ * last rebuild for the top-level cells whose hierarchy did not change.
+ *
+ * The tasks of the other cells are made and split as usual. This has to be
+ * called on an empty scheduler, before any other task is made, and the
+ * tasks are already split when it returns.
+ *
+ * With Scheduler:incremental_rebuild set to 2, the tasks are first made
+ * from scratch and the result is checked against them.
+ *
+ * @param e The #engine.
+ */
+void engine_reusetasks_make_hydroloop_tasks(struct engine *e) {
+
+  struct space *s = e->s;
+  struct scheduler *sched = &e->sched;
+  const int nr_cells = s->nr_cells;
+  const ticks tic = getticks();
+
+  /* First call? */
+  if (e->task_recipes == NULL) {
+    if ((e->task_recipes = (struct engine_task_recipes *)calloc(
+             1, sizeof(struct engine_task_recipes))) == NULL)
+      error("Failed to allocate the task recipes.");
+  }
+  struct engine_task_recipes *r = e->task_recipes;
+
+  /* Signatures and sizes of the new hierarchies. */
+  struct engine_reusetasks_data data;
+  bzero(&data, sizeof(struct engine_reusetasks_data));
+  data.e = e;
+  data.signatures =
+      (uint64_t *)swift_malloc("task_recipes", nr_cells * sizeof(uint64_t));
+  data.offsets =
+      (int *)swift_malloc("task_recipes", (nr_cells + 1) * sizeof(int));
+  if (data.signatures == NULL || data.offsets == NULL)
+    error("Failed to allocate the cell signatures.");
+  threadpool_map(&e->threadpool, engine_reusetasks_signature_mapper,
+                 s->cells_top, nr_cells, sizeof(struct cell),
+                 threadpool_auto_chunk_size, &data);
+  data.offsets[0] = 0;
+  for (int cid = 0; cid < nr_cells; cid++)
+    data.offsets[cid + 1] += data.offsets[cid];
+  const int nr_tree_cells = data.offsets[nr_cells];
+
+  /* Which top-level cells can re-use their tasks? */
+  swift_free("task_recipes", r->reused);
+  if ((r->reused = (char *)swift_malloc("task_recipes",
+                                        nr_cells * sizeof(char))) == NULL)
+    error("Failed to allocate the re-used cell flags.");
+  int nr_changed = 0;
+  const int nr_reused = engine_reusetasks_find_reused(e, data.signatures,
+                                                      &nr_changed);
+
+  /* List all the cells in depth-first order. */
+  if ((data.cells = (struct cell **)malloc(nr_tree_cells *
+                                           sizeof(struct cell *))) == NULL)
+    error("Failed to allocate the list of cells.");
+  threadpool_map(&e->threadpool, engine_reusetasks_list_mapper, s->cells_top,
+                 nr_cells, sizeof(struct cell), threadpool_auto_chunk_size,
+                 &data);
+
+  /* Make all the tasks from scratch for comparison? */
+  struct engine_reusetasks_fingerprint *ref_tasks = NULL;
+  char *ref_has_tasks = NULL;
+  int nr_ref_tasks = 0;
+  if (e->incremental_rebuild == 2) {
+    threadpool_map(&e->threadpool, engine_make_hydroloop_tasks_mapper, NULL,
+                   nr_cells, 1, threadpool_auto_chunk_size, e);
+    threadpool_map(&e->threadpool, scheduler_splittasks_mapper, sched->tasks,
+                   sched->nr_tasks, sizeof(struct task),
+                   threadpool_auto_chunk_size, sched);
+    ref_tasks = engine_reusetasks_fingerprint(e, &data, &nr_ref_tasks,
+                                              &ref_has_tasks);
+
+    /* Start again from an empty scheduler and unflagged cells. */
+    scheduler_reset(sched, sched->size);
+    for (int k = 0; k < nr_tree_cells; k++)
+      cell_clear_flag(data.cells[k], cell_flag_has_tasks);
+  }
+
+  /* Make the tasks involving a cell that is not re-used and split them. */
+  r->active = 1;
+  threadpool_map(&e->threadpool, engine_make_hydroloop_tasks_mapper, NULL,
+                 nr_cells, 1, threadpool_auto_chunk_size, e);
+  r->active = 0;
+  threadpool_map(&e->threadpool, scheduler_splittasks_mapper, sched->tasks,
+                 sched->nr_tasks, sizeof(struct task),
+                 threadpool_auto_chunk_size, sched);
+  const int nr_made_tasks = sched->nr_tasks;
+
+  /* Re-create the others, already split, and the flags they set. */
+  if (nr_reused > 0) {
+    threadpool_map(&e->threadpool, engine_reusetasks_replay_mapper,
+                   r->entries, r->nr_entries,
+                   sizeof(struct engine_reusetasks_entry),
+                   threadpool_auto_chunk_size, &data);
+    threadpool_map(&e->threadpool, engine_reusetasks_replay_flags_mapper,
+                   s->cells_top, nr_cells, sizeof(struct cell),
+                   threadpool_auto_chunk_size, &data);
+  }
+
+  /* Record the cells visited by the hydro tasks for the next rebuild. */
+  if ((data.has_tasks = (char *)swift_malloc(
+           "task_recipes", nr_tree_cells * sizeof(char))) == NULL)
+    error("Failed to allocate the cell flags.");
+  threadpool_map(&e->threadpool, engine_reusetasks_record_flags_mapper,
+                 data.cells, nr_tree_cells, sizeof(struct cell *),
+                 threadpool_auto_chunk_size, &data);
+
+  /* Check that we got the same tasks as from scratch. */
+  if (e->incremental_rebuild == 2) {
+    char *new_has_tasks = NULL;
+    int nr_new_tasks = 0;
+    struct engine_reusetasks_fingerprint *new_tasks =
+        engine_reusetasks_fingerprint(e, &data, &nr_new_tasks, &new_has_tasks);
+
+    if (nr_new_tasks != nr_ref_tasks)
+      error(
+          "Re-using the tasks of %d top-level cells gave %d hydro tasks "
+          "instead of %d.",
+          nr_reused, nr_new_tasks, nr_ref_tasks);
+    for (int k = 0; k < nr_new_tasks; k++)
+      if (engine_reusetasks_cmp_fingerprint(&new_tasks[k], &ref_tasks[k]) != 0)
+        error(
+            "Re-using the tasks of %d top-level cells gave a different %s "
+            "task than the ones made from scratch.",
+            nr_reused, taskID_names[new_tasks[k].type]);
+    for (int k = 0; k < nr_tree_cells; k++)
+      if (new_has_tasks[k] != ref_has_tasks[k])
+        error(
+            "Re-using the tasks of %d top-level cells gave a different "
+            "has_tasks flag for cell %d of %d.",
+            nr_reused, k, nr_tree_cells);
+
+    if (e->verbose)
+      message("The %d hydro tasks are identical to the ones made from scratch.",
+              nr_new_tasks);
+
+    free(new_tasks);
+    free(new_has_tasks);
+    free(ref_tasks);
+    free(ref_has_tasks);
+  }
+
+  /* Keep the description of the new hierarchies. The tasks themselves are
+   * recorded by engine_reusetasks_record() once they are linked. */
+  swift_free("task_recipes", r->signatures);
+  swift_free("task_recipes", r->offsets);
+  swift_free("task_recipes", r->has_tasks);
+  r->signatures = data.signatures;
+  r->offsets = data.offsets;
+  r->has_tasks = data.has_tasks;
+  r->nr_cells = 0;
+  free(data.cells);
+
+  if (e->verbose)
+    message(
+        "Re-used the hydro tasks of %d/%d top-level cells (%d changed): %d "
+        "tasks re-used and %d made.",
+        nr_reused, nr_cells, nr_changed, data.nr_reused_tasks, nr_made_tasks);
+
+  if (e->verbose)
+    message("took %.3f %s.", clocks_from_ticks(getticks() - tic),
+            clocks_getunit());
+}
+
+/**
+ * @brief Set the depth-first rank of the cells of the density tasks of a
+ * hierarchy.
+ *
+ * @param c The #cell.
+ * @param cid The index of the top-level cell of the hierarchy.
+ * @param tasks The array of tasks of the scheduler.
+ * @param entries One (so far incomplete) entry per task of the scheduler.
+ * @param rank (return) The rank of the next cell.
+ */
+static void engine_reusetasks_rank_rec(const struct cell *c, const int cid,
+                                       const struct task *tasks,
+                                       struct engine_reusetasks_entry *entries,
+                                       int *rank) {
+
+  for (const struct link *l = c->hydro.density; l != NULL; l = l->next) {
+    struct engine_reusetasks_entry *en = &entries[l->t - tasks];
+    if (l->t->ci == c) {
+      en->top_i = cid;
+      en->rank_i = *rank;
+    }
+    if (l->t->cj == c) {
+      en->top_j = cid;
+      en->rank_j = *rank;
+    }
+  }
+  (*rank)++;
+
+  if (c->split)
+    for (int k = 0; k < 8; k++)
+      if (c->progeny[k] != NULL)
+        engine_reusetasks_rank_rec(c->progeny[k], cid, tasks, entries, rank);
+}
+
+/**
+ * @brief Set the depth-first rank of the cells of the density tasks.
+ * Threadpool mapper function.
+ *
+ * @param map_data Pointer to the top-level cells.
+ * @param num_elements The number of cells to treat.
+ * @param extra_data Pointer to a #engine_reusetasks_data.
+ */
+static void engine_reusetasks_rank_mapper(void *map_data, int num_elements,
+                                          void *extra_data) {
+
+  struct engine_reusetasks_data *data =
+      (struct engine_reusetasks_data *)extra_data;
+  const struct cell *cells_top = data->e->s->cells_top;
+  const struct task *tasks = data->e->sched.tasks;
+  struct engine_reusetasks_entry *entries =
+      data->e->task_recipes->entries;
+  const struct cell *cells = (const struct cell *)map_data;
+
+  for (int ind = 0; ind < num_elements; ind++) {
+    const struct cell *c = &cells[ind];
+    int rank = 0;
+    engine_reusetasks_rank_rec(c, c - cells_top, tasks, entries, &rank);
+  }
+}
+
+/**
+ * @brief Record the density tasks for the next rebuild.
+ *
+ * Must be called once the tasks have been linked to their cells by
+ * engine_count_and_link_tasks_mapper().
+ *
+ * @param e The #engine.
+ */
+void engine_reusetasks_record(struct engine *e) {
+
+  struct engine_task_recipes *r = e->task_recipes;
+  const struct space *s = e->s;
+  const struct scheduler *sched = &e->sched;
+  const int nr_tasks = sched->nr_tasks;
+  const ticks tic = getticks();
+
+  /* One entry per task for now, such that the ranks can be set in parallel. */
+  swift_free("task_recipes", r->entries);
+  if ((r->entries = (struct engine_reusetasks_entry *)swift_malloc(
+           "task_recipes",
+           nr_tasks * sizeof(struct engine_reusetasks_entry))) == NULL)
+    error("Failed to allocate the task recipes.");
+
+  struct engine_reusetasks_data data;
+  bzero(&data, sizeof(struct engine_reusetasks_data));
+  data.e = e;
+  threadpool_map(&e->threadpool, engine_reusetasks_rank_mapper, s->cells_top,
+                 s->nr_cells, sizeof(struct cell), threadpool_auto_chunk_size,
+                 &data);
+
+  /* Only keep the density tasks. */
+  int count = 0;
+  for (int k = 0; k < nr_tasks; k++) {
+    const struct task *t = &sched->tasks[k];
+    if (t->subtype != task_subtype_density) continue;
+    if (t->type != task_type_self && t->type != task_type_pair &&
+        t->type != task_type_sub_self && t->type != task_type_sub_pair)
+      continue;
+
+    struct engine_reusetasks_entry *en = &r->entries[count++];
+    *en = r->entries[k];
+    en->type = t->type;
+    en->flags = t->flags;
+    if (t->cj == NULL) {
+      en->top_j = -1;
+      en->rank_j = -1;
+    }
+  }
+  r->nr_entries = count;
+
+  /* The recipes are now complete. */
+  r->nr_cells = s->nr_cells;
+  r->cdim[0] = s->cdim[0];
+  r->cdim[1] = s->cdim[1];
+  r->cdim[2] = s->cdim[2];
+
+  if (e->verbose)
+    message("Recording %d hydro tasks took %.3f %s.", count,
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+}
+
+/**
+ * @brief Return the flags marking the top-level cells whose tasks of the
+ * first hydro loop are re-used from the last rebuild.
+ *
+ * @param e The #engine.
+ *
+ * @return NULL if all the tasks have to be made.
+ */
+const char *engine_reusetasks_reused_cells(const struct engine *e) {
+
+  const struct engine_task_recipes *r = e->task_recipes;
+  if (r == NULL || !r->active) return NULL;
+  return r->reused;
+}
+
+/**
+ * @brief Free the task recipes.
+ *
+ * @param e The #engine.
+ */
+void engine_reusetasks_clean(struct engine *e) {
+
+  struct engine_task_recipes *r = e->task_recipes;
+  if (r == NULL) return;
+
+  swift_free("task_recipes", r->signatures);
+  swift_free("task_recipes", r->offsets);
+  swift_free("task_recipes", r->has_tasks);
+  swift_free("task_recipes", r->entries);
+  swift_free("task_recipes", r->reused);
+  free(r);
+  e->task_recipes = NULL;
+}
@@ -37,6 +37,7 @@
 
 /* Local headers. */
 #include "black_holes.h"
+#include "chashmap.h"
 #include "common_io.h"
 #include "engine.h"
 #include "hashmap.h"
@@ -51,6 +52,7 @@
 /* Constants. */
 #define UNION_BY_SIZE_OVER_MPI (1)
 #define FOF_COMPRESS_PATHS_MIN_LENGTH (2)
+#define FOF_LINK_UPDATE_TAG (1001)
 
 /* Are we timing calculating group properties in the FOF? */
 //#define WITHOUT_GROUP_PROPS
@@ -71,6 +73,7 @@ MPI_Datatype fof_mpi_type;
 MPI_Datatype group_length_mpi_type;
 MPI_Datatype fof_final_index_type;
 MPI_Datatype fof_final_mass_type;
+MPI_Datatype fof_fragment_root_type;
 
 /*! Offset between the first particle on this MPI rank and the first particle in
  * the global order */
@@ -126,6 +129,10 @@ void fof_init(struct fof_props *props, struct swift_params *params,
   props->l_x_absolute =
       parser_get_opt_param_double(params, "FOF:absolute_linking_length", -1.);
 
+  /* Link the groups across MPI domains using the global list of links? */
+  props->gather_group_links =
+      parser_get_opt_param_int(params, "FOF:gather_group_links", 0);
+
   if (props->l_x_ratio == -1. && props->l_x_absolute <= 0.)
     error("The FOF linking length can't be negative!");
 
@@ -180,6 +187,12 @@ void fof_create_mpi_types() {
       MPI_Type_commit(&fof_final_mass_type) != MPI_SUCCESS) {
     error("Failed to create MPI type for fof_final_mass.");
   }
+  /* Define type for sending fof_fragment_root struct */
+  if (MPI_Type_contiguous(sizeof(struct fof_fragment_root), MPI_BYTE,
+                          &fof_fragment_root_type) != MPI_SUCCESS ||
+      MPI_Type_commit(&fof_fragment_root_type) != MPI_SUCCESS) {
+    error("Failed to create MPI type for fof_fragment_root.");
+  }
 #else
   error("Calling an MPI function in non-MPI code.");
 #endif
@@ -770,6 +783,34 @@ __attribute__((always_inline)) INLINE static void fof_compute_send_recv_offsets(
   for (int i = 0; i < nr_nodes; i++) (*nrecv) += (*recvcount)[i];
 }
 
+/**
+ * @brief Decides which of two sets of fragments of a group spanning several
+ * MPI domains keeps its root when a link joins them.
+ *
+ * Using union by size, the largest set wins and ties go to the first set.
+ * Otherwise, the set whose root has the lowest ID wins. With union by size,
+ * the roots depend on the order in which the links are processed, which is
+ * always the order of the gathered links: by rank, then in the order in
+ * which each rank found them.
+ *
+ * @param size_a The size of the first set.
+ * @param id_a The global root index of the first set.
+ * @param size_b The size of the second set.
+ * @param id_b The global root index of the second set.
+ *
+ * @return 1 if the first set should keep its root, 0 otherwise.
+ */
+__attribute__((always_inline)) INLINE static int fof_set_keeps_root(
+    const size_t size_a, const size_t id_a, const size_t size_b,
+    const size_t id_b) {
+
+#ifdef UNION_BY_SIZE_OVER_MPI
+  return size_a >= size_b;
+#else
+  return id_a < id_b;
+#endif
+}
+
 #endif /* WITH_MPI */
 
 /**
@@ -1287,13 +1328,13 @@ void rec_fof_search_self(const struct fof_props *props, const double dim[3],
 }
 
 /* Mapper function to atomically update the group size array. */
-void fof_update_group_size_mapper(hashmap_key_t key, hashmap_value_t *value,
+void fof_update_group_size_mapper(chashmap_key_t key, void *value,
                                   void *data) {
 
   size_t *group_size = (size_t *)data;
 
   /* Use key to index into group size array. */
-  atomic_add(&group_size[key], value->value_st);
+  atomic_add(&group_size[key], *(size_t *)value);
 }
 
 /**
@@ -1317,45 +1358,40 @@ void fof_calc_group_size_mapper(void *map_data, int num_elements,
   size_t *const group_index_offset = group_index + gparts_offset;
 
   /* Create hash table. */
-  hashmap_t map;
-  hashmap_init(&map);
+  struct chashmap map;
+  chashmap_init(&map, num_elements, sizeof(size_t));
 
   /* Loop over particles and find which cells are in range of each other to
    * perform the FOF search. */
   for (int ind = 0; ind < num_elements; ind++) {
 
-    hashmap_key_t root =
-        (hashmap_key_t)fof_find(group_index_offset[ind], group_index);
+    chashmap_key_t root =
+        (chashmap_key_t)fof_find(group_index_offset[ind], group_index);
     const size_t gpart_index = gparts_offset + ind;
 
     /* Only add particles which aren't the root of a group. Stops groups of size
      * 1 being added to the hash table. */
     if (root != gpart_index) {
-      hashmap_value_t *size = hashmap_get(&map, root);
-
-      if (size != NULL)
-        (*size).value_st++;
-      else
-        error("Couldn't find key (%zu) or create new one.", root);
+      size_t *size = (size_t *)chashmap_get(&map, root);
+      (*size)++;
     }
   }
 
   /* Update the group size array. */
-  if (map.size > 0)
-    hashmap_iterate(&map, fof_update_group_size_mapper, group_size);
+  if (chashmap_size(&map) > 0)
+    chashmap_iterate(&map, fof_update_group_size_mapper, group_size);
 
-  hashmap_free(&map);
+  chashmap_free(&map);
 }
 
 /* Mapper function to atomically update the group mass array. */
-static INLINE void fof_update_group_mass_mapper(hashmap_key_t key,
-                                                hashmap_value_t *value,
-                                                void *data) {
+static INLINE void fof_update_group_mass_mapper(chashmap_key_t key,
+                                                void *value, void *data) {
 
   double *group_mass = (double *)data;
 
   /* Use key to index into group mass array. */
-  atomic_add_d(&group_mass[key], value->value_dbl);
+  atomic_add_d(&group_mass[key], *(double *)value);
 }
 
 /**
@@ -1376,8 +1412,8 @@ void fof_calc_group_mass_mapper(void *map_data, int num_elements,
   const size_t group_id_offset = s->e->fof_properties->group_id_offset;
 
   /* Create hash table. */
-  hashmap_t map;
-  hashmap_init(&map);
+  struct chashmap map;
+  chashmap_init(&map, num_elements, sizeof(double));
 
   /* Loop over particles and increment the group mass for groups above
    * min_group_size. */
@@ -1386,39 +1422,185 @@ void fof_calc_group_mass_mapper(void *map_data, int num_elements,
     /* Only check groups above the minimum size. */
     if (gparts[ind].fof_data.group_id != group_id_default) {
 
-      hashmap_key_t index = gparts[ind].fof_data.group_id - group_id_offset;
-      hashmap_value_t *data = hashmap_get(&map, index);
+      chashmap_key_t index = gparts[ind].fof_data.group_id - group_id_offset;
+      double *mass = (double *)chashmap_get(&map, index);
 
       /* Update group mass */
-      if (data != NULL)
-        (*data).value_dbl += gparts[ind].mass;
-      else
-        error("Couldn't find key (%zu) or create new one.", index);
+      *mass += gparts[ind].mass;
     }
   }
 
   /* Update the group mass array. */
-  if (map.size > 0)
-    hashmap_iterate(&map, fof_update_group_mass_mapper, group_mass);
+  if (chashmap_size(&map) > 0)
+    chashmap_iterate(&map, fof_update_group_mass_mapper, group_mass);
 
-  hashmap_free(&map);
+  chashmap_free(&map);
 }
 
 #ifdef WITH_MPI
 /* Mapper function to unpack hash table into array. */
-void fof_unpack_group_mass_mapper(hashmap_key_t key, hashmap_value_t *value,
+void fof_unpack_group_mass_mapper(chashmap_key_t key, void *value,
                                   void *data) {
 
   struct fof_mass_send_hashmap *fof_mass_send =
       (struct fof_mass_send_hashmap *)data;
   struct fof_final_mass *mass_send = fof_mass_send->mass_send;
-  size_t *nsend = &fof_mass_send->nsend;
+  const struct fof_mass_fragment *fragment =
+      (const struct fof_mass_fragment *)value;
+
+  /* Reserve a slot in the array */
+  const size_t ind = atomic_inc(&fof_mass_send->nsend);
 
   /* Store elements from hash table in array. */
-  mass_send[*nsend].global_root = key;
-  mass_send[(*nsend)].group_mass = value->value_dbl;
-  mass_send[(*nsend)].max_part_density_index = value->value_st;
-  mass_send[(*nsend)++].max_part_density = value->value_flt;
+  mass_send[ind].global_root = key;
+  mass_send[ind].group_mass = fragment->group_mass;
+  mass_send[ind].max_part_density_index = fragment->max_part_density_index;
+  mass_send[ind].max_part_density = fragment->max_part_density;
+}
+
+/* Data shared by the mappers of fof_calc_group_mass() */
+struct fof_calc_group_mass_data {
+
+  /*! The #space we work on */
+  const struct space *s;
+
+  /*! The group index of each #gpart */
+  size_t *group_index;
+
+  /*! The mass of the local groups */
+  double *group_mass;
+
+  /*! The group ID offsets */
+  size_t group_id_offset, group_id_default, num_groups_prev;
+
+  /*! Hash table of the fragments of the foreign groups */
+  struct chashmap *fragments;
+
+  /*! Number of #gpart in a foreign group */
+  size_t nr_foreign;
+};
+
+/**
+ * @brief Mapper function adding the mass of the #gpart%s to their group when
+ * its root is local and counting the ones whose root is foreign.
+ *
+ * @param map_data An array of #gpart%s.
+ * @param num_elements Chunk size.
+ * @param extra_data Pointer to a #fof_calc_group_mass_data.
+ */
+static void fof_calc_group_mass_local_mapper(void *map_data, int num_elements,
+                                             void *extra_data) {
+
+  struct fof_calc_group_mass_data *data =
+      (struct fof_calc_group_mass_data *)extra_data;
+  const struct gpart *gparts = (const struct gpart *)map_data;
+  const size_t nr_gparts = data->s->nr_gparts;
+  const size_t gparts_offset = (size_t)(gparts - data->s->gparts);
+  const size_t group_id_default = data->group_id_default;
+
+  /* Accumulate the masses locally before updating the global array */
+  struct chashmap map;
+  chashmap_init(&map, num_elements, sizeof(double));
+
+  size_t nr_foreign = 0;
+  for (int ind = 0; ind < num_elements; ind++) {
+
+    /* Check if the particle is in a group above the threshold. */
+    if (gparts[ind].fof_data.group_id == group_id_default) continue;
+
+    const size_t root =
+        fof_find_global(gparts_offset + ind, data->group_index, nr_gparts);
+
+    /* Increment the mass of groups that are local */
+    if (is_local(root, nr_gparts)) {
+
+      const chashmap_key_t index = gparts[ind].fof_data.group_id -
+                                   data->group_id_offset -
+                                   data->num_groups_prev;
+      double *mass = (double *)chashmap_get(&map, index);
+      *mass += gparts[ind].mass;
+
+    } else {
+      nr_foreign++;
+    }
+  }
+
+  /* Update the group mass array. */
+  if (chashmap_size(&map) > 0)
+    chashmap_iterate(&map, fof_update_group_mass_mapper, data->group_mass);
+  chashmap_free(&map);
+
+  atomic_add(&data->nr_foreign, nr_foreign);
+}
+
+/**
+ * @brief Mapper function adding the mass of the #gpart%s whose group root is
+ * foreign to the fragment of their group and finding the densest gas
+ * particle of each fragment.
+ *
+ * @param map_data An array of #gpart%s.
+ * @param num_elements Chunk size.
+ * @param extra_data Pointer to a #fof_calc_group_mass_data.
+ */
+static void fof_calc_group_mass_foreign_mapper(void *map_data,
+                                               int num_elements,
+                                               void *extra_data) {
+
+  struct fof_calc_group_mass_data *data =
+      (struct fof_calc_group_mass_data *)extra_data;
+  const struct gpart *gparts = (const struct gpart *)map_data;
+  const struct part *parts = data->s->parts;
+  const size_t nr_gparts = data->s->nr_gparts;
+  const size_t gparts_offset = (size_t)(gparts - data->s->gparts);
+  const size_t group_id_default = data->group_id_default;
+
+  for (int ind = 0; ind < num_elements; ind++) {
+
+    /* Check if the particle is in a group above the threshold. */
+    if (gparts[ind].fof_data.group_id == group_id_default) continue;
+
+    const size_t root =
+        fof_find_global(gparts_offset + ind, data->group_index, nr_gparts);
+    if (is_local(root, nr_gparts)) continue;
+
+    /* Add mass fragments of groups that have a foreign root to the shared
+     * hash table. */
+    struct fof_mass_fragment *fragment = (struct fof_mass_fragment *)
+        chashmap_get(data->fragments, (chashmap_key_t)root);
+    atomic_add_d(&fragment->group_mass, gparts[ind].mass);
+
+    if (gparts[ind].type != swift_type_gas &&
+        gparts[ind].type != swift_type_black_hole)
+      continue;
+
+    /* Lock the fragment (a zeroed int such that new entries are unlocked) */
+    while (atomic_cas(&fragment->lock, 0, 1) != 0)
+      ;
+
+    /* Find the densest gas particle.
+     * Account for groups that already have a black hole and groups that
+     * contain no gas. */
+    if (gparts[ind].type == swift_type_gas &&
+        fragment->max_part_density_index != fof_halo_has_black_hole) {
+
+      const size_t gas_index = -gparts[ind].id_or_neg_offset;
+      const float rho_com = hydro_get_comoving_density(&parts[gas_index]);
+
+      /* Update index if a denser gas particle is found. */
+      if (rho_com > fragment->max_part_density) {
+        fragment->max_part_density = rho_com;
+        fragment->max_part_density_index = gas_index;
+      }
+    }
+    /* If there is already a black hole in the group we don't need to
+       create a new one. */
+    else if (gparts[ind].type == swift_type_black_hole) {
+      fragment->max_part_density_index = fof_halo_has_black_hole;
+      fragment->max_part_density = 0.f;
+    }
+
+    atomic_cas(&fragment->lock, 1, 0);
+  }
 }
 
 #endif /* WITH_MPI */
@@ -1467,63 +1649,26 @@ void fof_calc_group_mass(struct fof_props *props, const struct space *s,
     max_part_density_index[i] = fof_halo_has_no_gas;
   }
 
-  /* Start the hash map */
-  hashmap_t map;
-  hashmap_init(&map);
-
-  /* JSW TODO: Parallelise with threadpool*/
-  for (size_t i = 0; i < nr_gparts; i++) {
-
-    /* Check if the particle is in a group above the threshold. */
-    if (gparts[i].fof_data.group_id != group_id_default) {
-
-      const size_t root = fof_find_global(i, group_index, nr_gparts);
+  struct fof_calc_group_mass_data mass_data = {
+      s, group_index, group_mass, group_id_offset, group_id_default,
+      num_groups_prev, /*fragments=*/NULL, /*nr_foreign=*/0};
 
-      /* Increment the mass of groups that are local */
-      if (is_local(root, nr_gparts)) {
-
-        const size_t index =
-            gparts[i].fof_data.group_id - group_id_offset - num_groups_prev;
-
-        /* Update group mass */
-        group_mass[index] += gparts[i].mass;
-
-      }
-      /* Add mass fragments of groups that have a foreign root to a hash table.
-       */
-      else {
-
-        hashmap_value_t *data = hashmap_get(&map, (hashmap_key_t)root);
-
-        if (data != NULL) {
-          data->value_dbl += gparts[i].mass;
-
-          /* Find the densest gas particle.
-           * Account for groups that already have a black hole and groups that
-           * contain no gas. */
-          if (gparts[i].type == swift_type_gas &&
-              data->value_st != fof_halo_has_black_hole) {
+  /* Increment the mass of the groups with a local root and count the
+   * particles of the foreign ones */
+  threadpool_map(&s->e->threadpool, fof_calc_group_mass_local_mapper, gparts,
+                 nr_gparts, sizeof(struct gpart), threadpool_auto_chunk_size,
+                 &mass_data);
 
-            const size_t gas_index = -gparts[i].id_or_neg_offset;
-            const float rho_com = hydro_get_comoving_density(&parts[gas_index]);
+  /* Start the hash map, large enough for all the foreign fragments */
+  struct chashmap map;
+  chashmap_init(&map, mass_data.nr_foreign, sizeof(struct fof_mass_fragment));
+  mass_data.fragments = &map;
 
-            /* Update index if a denser gas particle is found. */
-            if (rho_com > data->value_flt) {
-              data->value_flt = rho_com;
-              data->value_st = gas_index;
-            }
-          }
-          /* If there is already a black hole in the group we don't need to
-             create a new one. */
-          else if (gparts[i].type == swift_type_black_hole) {
-            data->value_st = fof_halo_has_black_hole;
-            data->value_flt = 0.f;
-          }
-        } else
-          error("Couldn't find key (%zu) or create new one.", root);
-      }
-    }
-  }
+  /* Collect the fragments of the groups with a foreign root */
+  if (mass_data.nr_foreign > 0)
+    threadpool_map(&s->e->threadpool, fof_calc_group_mass_foreign_mapper,
+                   gparts, nr_gparts, sizeof(struct gpart),
+                   threadpool_auto_chunk_size, &mass_data);
 
   /* Loop over particles and find the densest particle in each group. */
   /* JSW TODO: Parallelise with threadpool*/
@@ -1568,12 +1713,12 @@ void fof_calc_group_mass(struct fof_props *props, const struct space *s,
     }
   }
 
-  size_t nsend = map.size;
+  size_t nsend = chashmap_size(&map);
   struct fof_mass_send_hashmap hashmap_mass_send = {NULL, 0};
 
   /* Allocate and initialise a mass array. */
   if (posix_memalign((void **)&hashmap_mass_send.mass_send, 32,
-                     nsend * sizeof(struct fof_mass_send_hashmap)) != 0)
+                     nsend * sizeof(struct fof_final_mass)) != 0)
     error("Failed to allocate list of group masses for FOF search.");
 
   hashmap_mass_send.nsend = 0;
@@ -1581,15 +1726,15 @@ void fof_calc_group_mass(struct fof_props *props, const struct space *s,
   struct fof_final_mass *fof_mass_send = hashmap_mass_send.mass_send;
 
   /* Unpack mass fragments and roots from hash table. */
-  if (map.size > 0)
-    hashmap_iterate(&map, fof_unpack_group_mass_mapper, &hashmap_mass_send);
+  if (nsend > 0)
+    chashmap_iterate_parallel(&map, &s->e->threadpool,
+                              fof_unpack_group_mass_mapper,
+                              &hashmap_mass_send);
 
-  nsend = hashmap_mass_send.nsend;
-
-  if (nsend != map.size)
+  if (hashmap_mass_send.nsend != nsend)
     error("No. of mass fragments to send != elements in hash table.");
 
-  hashmap_free(&map);
+  chashmap_free(&map);
 
   /* Sort by global root - this puts the groups in order of which node they're
    * stored on */
@@ -2146,308 +2291,131 @@ void fof_set_outgoing_root_mapper(void *map_data, int num_elements,
 #endif
 }
 
+#ifdef WITH_MPI
+
 /**
- * @brief Search foreign cells for links and communicate any found to the
- * appropriate node.
+ * @brief Link the groups spanning several MPI domains by gathering the group
+ * links of all the ranks on every rank and performing a union-find over them.
+ *
+ * The cost of this grows with the total number of links, it is only kept to
+ * check fof_link_groups_distributed().
  *
  * @param props the properties of the FOF scheme.
  * @param s Pointer to a #space.
+ * @param group_link_count The number of links found on this rank.
  */
-void fof_search_foreign_cells(struct fof_props *props, const struct space *s) {
+static void fof_link_groups_gathered(struct fof_props *props,
+                                     const struct space *s,
+                                     const int group_link_count) {
 
-#ifdef WITH_MPI
-
-  struct engine *e = s->e;
-  int verbose = e->verbose;
+  const struct engine *e = s->e;
+  const int verbose = e->verbose;
   size_t *group_index = props->group_index;
   size_t *group_size = props->group_size;
   const size_t nr_gparts = s->nr_gparts;
-  const double dim[3] = {s->dim[0], s->dim[1], s->dim[2]};
-  const double search_r2 = props->l_x2;
 
   ticks tic = getticks();
 
-  /* Make group IDs globally unique. */
-  for (size_t i = 0; i < nr_gparts; i++) group_index[i] += node_offset;
+  struct fof_mpi *global_group_links = NULL;
+  int *displ = NULL, *group_link_counts = NULL;
+  int global_group_link_count = 0;
 
-  struct cell_pair_indices *cell_pairs = NULL;
-  int group_link_count = 0;
-  int cell_pair_count = 0;
+  ticks comms_tic = getticks();
 
-  props->group_links_size = fof_props_default_group_link_size;
-  props->group_link_count = 0;
+  MPI_Barrier(MPI_COMM_WORLD);
 
-  int num_cells_out = 0;
-  int num_cells_in = 0;
+  if (verbose)
+    message("Imbalance took: %.3f %s.",
+            clocks_from_ticks(getticks() - comms_tic), clocks_getunit());
 
-  /* Find the maximum no. of cell pairs. */
-  for (int i = 0; i < e->nr_proxies; i++) {
+  comms_tic = getticks();
 
-    for (int j = 0; j < e->proxies[i].nr_cells_out; j++) {
+  /* Sum the total number of links across MPI domains over each MPI rank. */
+  MPI_Allreduce(&group_link_count, &global_group_link_count, 1, MPI_INT,
+                MPI_SUM, MPI_COMM_WORLD);
 
-      /* Only include gravity cells. */
-      if (e->proxies[i].cells_out_type[j] & proxy_cell_type_gravity)
-        num_cells_out++;
-    }
+  /* Unique set of links is half of all group links as each link is found twice
+   * by opposing MPI ranks. */
+  if (swift_memalign("fof_global_group_links", (void **)&global_group_links,
+                     SWIFT_STRUCT_ALIGNMENT,
+                     global_group_link_count * sizeof(struct fof_mpi)) != 0)
+    error("Error while allocating memory for the global list of group links");
 
-    for (int j = 0; j < e->proxies[i].nr_cells_in; j++) {
+  if (posix_memalign((void **)&group_link_counts, SWIFT_STRUCT_ALIGNMENT,
+                     e->nr_nodes * sizeof(int)) != 0)
+    error(
+        "Error while allocating memory for the number of group links on each "
+        "MPI rank");
 
-      /* Only include gravity cells. */
-      if (e->proxies[i].cells_in_type[j] & proxy_cell_type_gravity)
-        num_cells_in++;
-    }
-  }
+  if (posix_memalign((void **)&displ, SWIFT_STRUCT_ALIGNMENT,
+                     e->nr_nodes * sizeof(int)) != 0)
+    error(
+        "Error while allocating memory for the displacement in memory for the "
+        "global group link list");
 
-  if (verbose)
-    message(
-        "Finding max no. of cells + offset IDs"
-        "took: %.3f %s.",
-        clocks_from_ticks(getticks() - tic), clocks_getunit());
+  /* Gather the total number of links on each rank. */
+  MPI_Allgather(&group_link_count, 1, MPI_INT, group_link_counts, 1, MPI_INT,
+                MPI_COMM_WORLD);
 
-  const int cell_pair_size = num_cells_in * num_cells_out;
+  /* Set the displacements into the global link list using the link counts from
+   * each rank */
+  displ[0] = 0;
+  for (int i = 1; i < e->nr_nodes; i++)
+    displ[i] = displ[i - 1] + group_link_counts[i - 1];
 
-  if (swift_memalign("fof_group_links", (void **)&props->group_links,
-                     SWIFT_STRUCT_ALIGNMENT,
-                     props->group_links_size * sizeof(struct fof_mpi)) != 0)
-    error("Error while allocating memory for FOF links over an MPI domain");
+  /* Gather the global link list on all ranks. */
+  MPI_Allgatherv(props->group_links, group_link_count, fof_mpi_type,
+                 global_group_links, group_link_counts, displ, fof_mpi_type,
+                 MPI_COMM_WORLD);
 
-  if (swift_memalign("fof_cell_pairs", (void **)&cell_pairs,
-                     SWIFT_STRUCT_ALIGNMENT,
-                     cell_pair_size * sizeof(struct cell_pair_indices)) != 0)
-    error("Error while allocating memory for FOF cell pair indices");
+  /* Clean up memory. */
+  free(displ);
+  swift_free("fof_group_links", props->group_links);
+  props->group_links = NULL;
 
-  ticks tic_pairs = getticks();
+  if (verbose) {
+    message("Communication took: %.3f %s.",
+            clocks_from_ticks(getticks() - comms_tic), clocks_getunit());
 
-  /* Loop over cells_in and cells_out for each proxy and find which cells are in
-   * range of each other to perform the FOF search. Store local cells that are
-   * touching foreign cells in a list. */
-  for (int i = 0; i < e->nr_proxies; i++) {
+    message("Global comms took: %.3f %s.", clocks_from_ticks(getticks() - tic),
+            clocks_getunit());
+  }
 
-    /* Only find links across an MPI domain on one rank. */
-    if (engine_rank == min(engine_rank, e->proxies[i].nodeID)) {
+  tic = getticks();
 
-      for (int j = 0; j < e->proxies[i].nr_cells_out; j++) {
+  /* Transform the group IDs to a local list going from 0-group_count so a
+   * union-find can be performed. */
+  size_t *global_group_index = NULL, *global_group_id = NULL,
+         *global_group_size = NULL;
+  const int global_group_list_size = 2 * global_group_link_count;
+  int group_count = 0;
 
-        /* Skip non-gravity cells. */
-        if (!(e->proxies[i].cells_out_type[j] & proxy_cell_type_gravity))
-          continue;
+  if (swift_memalign("fof_global_group_index", (void **)&global_group_index,
+                     SWIFT_STRUCT_ALIGNMENT,
+                     global_group_list_size * sizeof(size_t)) != 0)
+    error(
+        "Error while allocating memory for the displacement in memory for the "
+        "global group link list");
 
-        struct cell *restrict local_cell = e->proxies[i].cells_out[j];
+  if (swift_memalign("fof_global_group_id", (void **)&global_group_id,
+                     SWIFT_STRUCT_ALIGNMENT,
+                     global_group_list_size * sizeof(size_t)) != 0)
+    error(
+        "Error while allocating memory for the displacement in memory for the "
+        "global group link list");
 
-        /* Skip empty cells. */
-        if (local_cell->grav.count == 0) continue;
+  if (swift_memalign("fof_global_group_size", (void **)&global_group_size,
+                     SWIFT_STRUCT_ALIGNMENT,
+                     global_group_list_size * sizeof(size_t)) != 0)
+    error(
+        "Error while allocating memory for the displacement in memory for the "
+        "global group link list");
 
-        for (int k = 0; k < e->proxies[i].nr_cells_in; k++) {
+  bzero(global_group_size, global_group_list_size * sizeof(size_t));
 
-          /* Skip non-gravity cells. */
-          if (!(e->proxies[i].cells_in_type[k] & proxy_cell_type_gravity))
-            continue;
-
-          struct cell *restrict foreign_cell = e->proxies[i].cells_in[k];
-
-          /* Skip empty cells. */
-          if (foreign_cell->grav.count == 0) continue;
-
-          /* Check if local cell has already been added to the local list of
-           * cells. */
-          const double r2 = cell_min_dist(local_cell, foreign_cell, dim);
-          if (r2 < search_r2) {
-            cell_pairs[cell_pair_count].local = local_cell;
-            cell_pairs[cell_pair_count++].foreign = foreign_cell;
-          }
-        }
-      }
-    }
-  }
-
-  if (verbose)
-    message(
-        "Finding local/foreign cell pairs"
-        "took: %.3f %s.",
-        clocks_from_ticks(getticks() - tic_pairs), clocks_getunit());
-
-  ticks tic_set_roots = getticks();
-
-  /* Set the root of outgoing particles. */
-
-  /* Allocate array of outgoing cells and populate it */
-  struct cell **local_cells = malloc(num_cells_out * sizeof(struct cell *));
-  int count = 0;
-  for (int i = 0; i < e->nr_proxies; i++) {
-    for (int j = 0; j < e->proxies[i].nr_cells_out; j++) {
-
-      /* Only include gravity cells. */
-      if (e->proxies[i].cells_out_type[j] & proxy_cell_type_gravity) {
-
-        local_cells[count] = e->proxies[i].cells_out[j];
-        ++count;
-      }
-    }
-  }
-
-  /* Now set the roots */
-  struct mapper_data data;
-  data.group_index = group_index;
-  data.group_size = group_size;
-  data.nr_gparts = nr_gparts;
-  data.space_gparts = s->gparts;
-  threadpool_map(&e->threadpool, fof_set_outgoing_root_mapper, local_cells,
-                 num_cells_out, sizeof(struct cell **),
-                 threadpool_auto_chunk_size, &data);
-
-  if (verbose)
-    message(
-        "Initialising particle roots "
-        "took: %.3f %s.",
-        clocks_from_ticks(getticks() - tic_set_roots), clocks_getunit());
-
-  free(local_cells);
-
-  if (verbose)
-    message(
-        "Finding local/foreign cell pairs and initialising particle roots "
-        "took: %.3f %s.",
-        clocks_from_ticks(getticks() - tic), clocks_getunit());
-
-  /* Activate the tasks exchanging all the required gparts */
-  engine_activate_gpart_comms(e);
-
-  ticks local_fof_tic = getticks();
-
-  MPI_Barrier(MPI_COMM_WORLD);
-
-  if (verbose)
-    message("Local FOF imbalance: %.3f %s.",
-            clocks_from_ticks(getticks() - local_fof_tic), clocks_getunit());
-
-  tic = getticks();
-
-  /* Perform send and receive tasks. */
-  engine_launch(e, "fof comms");
-
-  if (verbose)
-    message("MPI send/recv comms took: %.3f %s.",
-            clocks_from_ticks(getticks() - tic), clocks_getunit());
-
-  tic = getticks();
-
-  /* Perform search of group links between local and foreign cells with the
-   * threadpool. */
-  threadpool_map(&s->e->threadpool, fof_find_foreign_links_mapper, cell_pairs,
-                 cell_pair_count, sizeof(struct cell_pair_indices), 1,
-                 (struct space *)s);
-
-  group_link_count = props->group_link_count;
-
-  /* Clean up memory. */
-  swift_free("fof_cell_pairs", cell_pairs);
-
-  if (verbose)
-    message("Searching for foreign links took: %.3f %s.",
-            clocks_from_ticks(getticks() - tic), clocks_getunit());
-
-  tic = getticks();
-
-  struct fof_mpi *global_group_links = NULL;
-  int *displ = NULL, *group_link_counts = NULL;
-  int global_group_link_count = 0;
-
-  ticks comms_tic = getticks();
-
-  MPI_Barrier(MPI_COMM_WORLD);
-
-  if (verbose)
-    message("Imbalance took: %.3f %s.",
-            clocks_from_ticks(getticks() - comms_tic), clocks_getunit());
-
-  comms_tic = getticks();
-
-  /* Sum the total number of links across MPI domains over each MPI rank. */
-  MPI_Allreduce(&group_link_count, &global_group_link_count, 1, MPI_INT,
-                MPI_SUM, MPI_COMM_WORLD);
-
-  /* Unique set of links is half of all group links as each link is found twice
-   * by opposing MPI ranks. */
-  if (swift_memalign("fof_global_group_links", (void **)&global_group_links,
-                     SWIFT_STRUCT_ALIGNMENT,
-                     global_group_link_count * sizeof(struct fof_mpi)) != 0)
-    error("Error while allocating memory for the global list of group links");
-
-  if (posix_memalign((void **)&group_link_counts, SWIFT_STRUCT_ALIGNMENT,
-                     e->nr_nodes * sizeof(int)) != 0)
-    error(
-        "Error while allocating memory for the number of group links on each "
-        "MPI rank");
-
-  if (posix_memalign((void **)&displ, SWIFT_STRUCT_ALIGNMENT,
-                     e->nr_nodes * sizeof(int)) != 0)
-    error(
-        "Error while allocating memory for the displacement in memory for the "
-        "global group link list");
-
-  /* Gather the total number of links on each rank. */
-  MPI_Allgather(&group_link_count, 1, MPI_INT, group_link_counts, 1, MPI_INT,
-                MPI_COMM_WORLD);
-
-  /* Set the displacements into the global link list using the link counts from
-   * each rank */
-  displ[0] = 0;
-  for (int i = 1; i < e->nr_nodes; i++)
-    displ[i] = displ[i - 1] + group_link_counts[i - 1];
-
-  /* Gather the global link list on all ranks. */
-  MPI_Allgatherv(props->group_links, group_link_count, fof_mpi_type,
-                 global_group_links, group_link_counts, displ, fof_mpi_type,
-                 MPI_COMM_WORLD);
-
-  /* Clean up memory. */
-  free(displ);
-  swift_free("fof_group_links", props->group_links);
-  props->group_links = NULL;
-
-  if (verbose) {
-    message("Communication took: %.3f %s.",
-            clocks_from_ticks(getticks() - comms_tic), clocks_getunit());
-
-    message("Global comms took: %.3f %s.", clocks_from_ticks(getticks() - tic),
-            clocks_getunit());
-  }
-
-  tic = getticks();
-
-  /* Transform the group IDs to a local list going from 0-group_count so a
-   * union-find can be performed. */
-  size_t *global_group_index = NULL, *global_group_id = NULL,
-         *global_group_size = NULL;
-  const int global_group_list_size = 2 * global_group_link_count;
-  int group_count = 0;
-
-  if (swift_memalign("fof_global_group_index", (void **)&global_group_index,
-                     SWIFT_STRUCT_ALIGNMENT,
-                     global_group_list_size * sizeof(size_t)) != 0)
-    error(
-        "Error while allocating memory for the displacement in memory for the "
-        "global group link list");
-
-  if (swift_memalign("fof_global_group_id", (void **)&global_group_id,
-                     SWIFT_STRUCT_ALIGNMENT,
-                     global_group_list_size * sizeof(size_t)) != 0)
-    error(
-        "Error while allocating memory for the displacement in memory for the "
-        "global group link list");
-
-  if (swift_memalign("fof_global_group_size", (void **)&global_group_size,
-                     SWIFT_STRUCT_ALIGNMENT,
-                     global_group_list_size * sizeof(size_t)) != 0)
-    error(
-        "Error while allocating memory for the displacement in memory for the "
-        "global group link list");
-
-  bzero(global_group_size, global_group_list_size * sizeof(size_t));
-
-  /* Create hash table. */
-  hashmap_t map;
-  hashmap_init(&map);
+  /* Create hash table. */
+  hashmap_t map;
+  hashmap_init(&map);
 
   /* Store each group ID and its properties. */
   for (int i = 0; i < global_group_link_count; i++) {
@@ -2510,23 +2478,13 @@ void fof_search_foreign_cells(struct fof_props *props, const struct space *s) {
     /* Update roots accordingly. */
     size_t size_i = global_group_size[root_i];
     size_t size_j = global_group_size[root_j];
-#ifdef UNION_BY_SIZE_OVER_MPI
-    if (size_i < size_j) {
-      global_group_index[root_i] = root_j;
-      global_group_size[root_j] += size_i;
-    } else {
+    if (fof_set_keeps_root(size_i, group_i, size_j, group_j)) {
       global_group_index[root_j] = root_i;
       global_group_size[root_i] += size_j;
-    }
-#else
-    if (group_j < group_i) {
+    } else {
       global_group_index[root_i] = root_j;
       global_group_size[root_j] += size_i;
-    } else {
-      global_group_index[root_j] = root_i;
-      global_group_size[root_i] += size_j;
     }
-#endif
   }
 
   hashmap_free(&map);
@@ -2569,6 +2527,765 @@ void fof_search_foreign_cells(struct fof_props *props, const struct space *s) {
   swift_free("fof_global_group_size", global_group_size);
   swift_free("fof_global_group_id", global_group_id);
   swift_free("fof_orig_global_group_size", orig_global_group_size);
+}
+
+/**
+ * @brief Exchange some data with all the neighbouring ranks.
+ *
+ * Every rank sends one (possibly empty) message to each of its proxies and
+ * receives one from each of them.
+ *
+ * @param e The #engine.
+ * @param send The data to send to each proxy.
+ * @param send_count The number of elements to send to each proxy.
+ * @param elem_size The size in bytes of an element.
+ * @param recv_count (return) The total number of elements received.
+ *
+ * @return The elements received from all the proxies, to be freed by the
+ * caller.
+ */
+static void *fof_exchange_with_proxies(const struct engine *e, void **send,
+                                       const size_t *send_count,
+                                       const size_t elem_size,
+                                       size_t *recv_count) {
+
+  const int nr_proxies = e->nr_proxies;
+  MPI_Request *reqs = (MPI_Request *)malloc(nr_proxies * sizeof(MPI_Request));
+  if (nr_proxies > 0 && reqs == NULL)
+    error("Failed to allocate FOF link requests.");
+
+  for (int k = 0; k < nr_proxies; k++) {
+    const size_t bytes = send_count[k] * elem_size;
+    if (bytes > INT_MAX)
+      error("Too many FOF links to send to node %d.", e->proxies[k].nodeID);
+    if (MPI_Isend(send[k], (int)bytes, MPI_BYTE, e->proxies[k].nodeID,
+                  FOF_LINK_UPDATE_TAG, MPI_COMM_WORLD,
+                  &reqs[k]) != MPI_SUCCESS)
+      error("Failed to send FOF links to node %d.", e->proxies[k].nodeID);
+  }
+
+  char *recv = NULL;
+  size_t recv_bytes = 0;
+  for (int k = 0; k < nr_proxies; k++) {
+
+    /* How much is coming from that node? */
+    MPI_Status status;
+    int bytes = 0;
+    if (MPI_Probe(e->proxies[k].nodeID, FOF_LINK_UPDATE_TAG, MPI_COMM_WORLD,
+                  &status) != MPI_SUCCESS ||
+        MPI_Get_count(&status, MPI_BYTE, &bytes) != MPI_SUCCESS)
+      error("Failed to probe FOF links from node %d.", e->proxies[k].nodeID);
+
+    if (bytes > 0) {
+      recv = (char *)realloc(recv, recv_bytes + bytes);
+      if (recv == NULL) error("Failed to allocate FOF links buffer.");
+    }
+
+    if (MPI_Recv(recv + recv_bytes, bytes, MPI_BYTE, e->proxies[k].nodeID,
+                 FOF_LINK_UPDATE_TAG, MPI_COMM_WORLD,
+                 MPI_STATUS_IGNORE) != MPI_SUCCESS)
+      error("Failed to receive FOF links from node %d.", e->proxies[k].nodeID);
+    recv_bytes += bytes;
+  }
+
+  if (MPI_Waitall(nr_proxies, reqs, MPI_STATUSES_IGNORE) != MPI_SUCCESS)
+    error("Failed to wait for the FOF links to be sent.");
+  free(reqs);
+
+  *recv_count = recv_bytes / elem_size;
+  return recv;
+}
+
+/**
+ * @brief Find the node owning a given global #gpart index.
+ *
+ * @param index The global index.
+ * @param first_on_node The first global index of each node.
+ * @param nr_nodes The number of nodes.
+ */
+__attribute__((always_inline)) INLINE static int fof_node_of_index(
+    const size_t index, const size_t *first_on_node, const int nr_nodes) {
+
+  /* Last node starting at or before the index (skips the empty ones) */
+  int lo = 0, hi = nr_nodes - 1;
+  while (lo < hi) {
+    const int mid = (lo + hi + 1) / 2;
+    if (first_on_node[mid] <= index)
+      lo = mid;
+    else
+      hi = mid - 1;
+  }
+  return lo;
+}
+
+/**
+ * @brief Find the root of a fragment in the union-find of
+ * fof_link_groups_distributed().
+ *
+ * @param i The index of the fragment.
+ * @param parent The parent of each fragment.
+ */
+__attribute__((always_inline)) INLINE static int fof_find_fragment(
+    int i, int *parent) {
+
+  while (parent[i] != i) {
+    parent[i] = parent[parent[i]];
+    i = parent[i];
+  }
+  return i;
+}
+
+/**
+ * @brief Link the groups spanning several MPI domains without gathering all
+ * the links on every rank.
+ *
+ * Each link is first sent to the rank owning its foreign group, such that
+ * every rank knows all the links touching its own groups. Each rank then
+ * merges the fragments connected by the links it knows, including copies of
+ * the foreign ones, and label propagation finds the lowest fragment of each
+ * group, its leader: the ranks repeatedly send the lowest fragment index
+ * found in each of their merged sets to the neighbours owning the other
+ * fragments of the set until nothing changes anymore. Every round moves the
+ * leader at least one rank further, so the number of rounds cannot exceed
+ * the total number of fragments.
+ *
+ * Every rank then sends the links it found to the owner of the leader of
+ * their group, which merges the fragments in the order of the gathered
+ * links using union by size, and sends the root of each fragment to the
+ * owners of the fragment and of the root. Each link is hence communicated
+ * at most twice in total, instead of to every rank.
+ *
+ * This gives the same roots as fof_link_groups_gathered().
+ *
+ * @param props the properties of the FOF scheme.
+ * @param s Pointer to a #space.
+ * @param group_link_count The number of links found on this rank.
+ */
+static void fof_link_groups_distributed(struct fof_props *props,
+                                        const struct space *s,
+                                        const int group_link_count) {
+
+  const struct engine *e = s->e;
+  const int verbose = e->verbose;
+  const int nr_nodes = e->nr_nodes;
+  const int nr_proxies = e->nr_proxies;
+  size_t *group_index = props->group_index;
+  size_t *group_size = props->group_size;
+  const size_t nr_gparts = s->nr_gparts;
+
+  ticks tic = getticks();
+
+  /* Range of global indices on each node */
+  size_t *num_on_node = (size_t *)malloc(nr_nodes * sizeof(size_t));
+  size_t *first_on_node = (size_t *)malloc(nr_nodes * sizeof(size_t));
+  MPI_Allgather(&nr_gparts, sizeof(size_t), MPI_BYTE, num_on_node,
+                sizeof(size_t), MPI_BYTE, MPI_COMM_WORLD);
+  first_on_node[0] = 0;
+  for (int i = 1; i < nr_nodes; i++)
+    first_on_node[i] = first_on_node[i - 1] + num_on_node[i - 1];
+
+  /* Proxy index of each node */
+  int *proxy_of_node = (int *)malloc(nr_nodes * sizeof(int));
+  for (int i = 0; i < nr_nodes; i++) proxy_of_node[i] = -1;
+  for (int k = 0; k < nr_proxies; k++)
+    proxy_of_node[e->proxies[k].nodeID] = k;
+
+  /* Sort the links found here by the proxy owning their foreign group */
+  size_t *send_count = (size_t *)malloc(nr_proxies * sizeof(size_t));
+  bzero(send_count, nr_proxies * sizeof(size_t));
+  int *link_proxy = (int *)malloc(group_link_count * sizeof(int));
+  for (int i = 0; i < group_link_count; i++) {
+
+    /* Find the node owning the foreign group */
+    const size_t group_j = props->group_links[i].group_j;
+    const int node = fof_node_of_index(group_j, first_on_node, nr_nodes);
+    if (proxy_of_node[node] < 0)
+      error("Group %zu linked to node %d which is not a proxy.", group_j,
+            node);
+
+    link_proxy[i] = proxy_of_node[node];
+    send_count[link_proxy[i]]++;
+  }
+
+  /* Send each link, as seen from the other side, to the owner of the foreign
+   * group */
+  struct fof_mpi **link_send =
+      (struct fof_mpi **)malloc(nr_proxies * sizeof(struct fof_mpi *));
+  for (int k = 0; k < nr_proxies; k++) {
+    if (swift_memalign("fof_link_send", (void **)&link_send[k],
+                       SWIFT_STRUCT_ALIGNMENT,
+                       send_count[k] * sizeof(struct fof_mpi)) != 0)
+      error("Failed to allocate FOF links to send.");
+    send_count[k] = 0;
+  }
+  for (int i = 0; i < group_link_count; i++) {
+    const int k = link_proxy[i];
+    struct fof_mpi *link = &link_send[k][send_count[k]++];
+    link->group_i = props->group_links[i].group_j;
+    link->group_i_size = props->group_links[i].group_j_size;
+    link->group_j = props->group_links[i].group_i;
+    link->group_j_size = props->group_links[i].group_i_size;
+  }
+
+  size_t nr_links_recv = 0;
+  struct fof_mpi *links_recv = (struct fof_mpi *)fof_exchange_with_proxies(
+      e, (void **)link_send, send_count, sizeof(struct fof_mpi),
+      &nr_links_recv);
+
+  for (int k = 0; k < nr_proxies; k++)
+    swift_free("fof_link_send", link_send[k]);
+  free(link_send);
+
+  /* All the links touching the groups of this rank, with the local group
+   * first */
+  const size_t nr_links = group_link_count + nr_links_recv;
+  struct fof_mpi *links = NULL;
+  if (swift_memalign("fof_links", (void **)&links, SWIFT_STRUCT_ALIGNMENT,
+                     nr_links * sizeof(struct fof_mpi)) != 0)
+    error("Failed to allocate FOF links.");
+  memcpy(links, props->group_links, group_link_count * sizeof(struct fof_mpi));
+  if (nr_links_recv > 0)
+    memcpy(links + group_link_count, links_recv,
+           nr_links_recv * sizeof(struct fof_mpi));
+  free(links_recv);
+  swift_free("fof_group_links", props->group_links);
+  props->group_links = NULL;
+
+  if (verbose)
+    message("Exchanging the links with the neighbours took: %.3f %s.",
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  tic = getticks();
+
+  /* Index the fragments appearing in the links, local and foreign ones */
+  struct chashmap map;
+  chashmap_init(&map, 2 * nr_links, sizeof(int));
+  size_t *fragment_id = (size_t *)malloc(2 * nr_links * sizeof(size_t));
+  int *fragment_proxy = (int *)malloc(2 * nr_links * sizeof(int));
+  int *link_i = (int *)malloc(nr_links * sizeof(int));
+  int *link_j = (int *)malloc(nr_links * sizeof(int));
+  int nr_fragments = 0;
+
+  for (size_t l = 0; l < nr_links; l++) {
+    for (int side = 0; side < 2; side++) {
+
+      const size_t id = side ? links[l].group_j : links[l].group_i;
+      int created = 0;
+      int *fragment = (int *)chashmap_get_new(&map, id, &created);
+      if (created) {
+        *fragment = nr_fragments;
+        fragment_id[nr_fragments] = id;
+        fragment_proxy[nr_fragments] = -1;
+        nr_fragments++;
+      }
+      if (side)
+        link_j[l] = *fragment;
+      else
+        link_i[l] = *fragment;
+    }
+  }
+
+  /* Merge the fragments connected by the links known here */
+  int *parent = (int *)malloc(nr_fragments * sizeof(int));
+  for (int i = 0; i < nr_fragments; i++) parent[i] = i;
+  for (size_t l = 0; l < nr_links; l++) {
+    const int root_i = fof_find_fragment(link_i[l], parent);
+    const int root_j = fof_find_fragment(link_j[l], parent);
+    if (root_i < root_j)
+      parent[root_j] = root_i;
+    else if (root_j < root_i)
+      parent[root_i] = root_j;
+  }
+
+  /* Lowest fragment of each set */
+  size_t *leader_id = (size_t *)malloc(nr_fragments * sizeof(size_t));
+  char *changed = (char *)malloc(nr_fragments * sizeof(char));
+  for (int i = 0; i < nr_fragments; i++) {
+    leader_id[i] = fragment_id[i];
+    changed[i] = 1;
+  }
+  for (int i = 0; i < nr_fragments; i++) {
+    const int r = fof_find_fragment(i, parent);
+    if (fragment_id[i] < leader_id[r]) leader_id[r] = fragment_id[i];
+  }
+
+  /* The proxy owning each foreign fragment */
+  for (size_t l = 0; l < nr_links; l++) {
+    const int node =
+        fof_node_of_index(links[l].group_j, first_on_node, nr_nodes);
+    fragment_proxy[link_j[l]] = proxy_of_node[node];
+  }
+
+  free(link_proxy);
+
+  if (verbose)
+    message("Merging %d fragments locally took: %.3f %s.", nr_fragments,
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  tic = getticks();
+
+  /* Propagate the lowest fragments until no set changes anymore */
+  struct fof_link_update **update_send = (struct fof_link_update **)malloc(
+      nr_proxies * sizeof(struct fof_link_update *));
+
+  /* A leader travels at least one fragment further every round */
+  long long max_rounds = nr_fragments;
+  MPI_Allreduce(MPI_IN_PLACE, &max_rounds, 1, MPI_LONG_LONG_INT, MPI_SUM,
+                MPI_COMM_WORLD);
+  max_rounds += 1;
+
+  int nr_rounds = 0;
+  while (1) {
+
+    if (nr_rounds > max_rounds)
+      error("Propagating the leaders did not converge after %d rounds.",
+            nr_rounds);
+
+    /* Send the leader of every set that changed to the owners of its foreign
+     * fragments */
+    for (int k = 0; k < nr_proxies; k++) send_count[k] = 0;
+    for (int i = 0; i < nr_fragments; i++)
+      if (fragment_proxy[i] >= 0 && changed[fof_find_fragment(i, parent)])
+        send_count[fragment_proxy[i]]++;
+
+    for (int k = 0; k < nr_proxies; k++) {
+      update_send[k] = (struct fof_link_update *)malloc(
+          send_count[k] * sizeof(struct fof_link_update));
+      send_count[k] = 0;
+    }
+
+    for (int i = 0; i < nr_fragments; i++) {
+      const int r = fof_find_fragment(i, parent);
+      if (fragment_proxy[i] >= 0 && changed[r]) {
+        const int k = fragment_proxy[i];
+        struct fof_link_update *update = &update_send[k][send_count[k]++];
+        update->group = fragment_id[i];
+        update->leader = leader_id[r];
+      }
+    }
+    for (int i = 0; i < nr_fragments; i++) changed[i] = 0;
+
+    size_t nr_updates = 0;
+    struct fof_link_update *updates =
+        (struct fof_link_update *)fof_exchange_with_proxies(
+            e, (void **)update_send, send_count,
+            sizeof(struct fof_link_update), &nr_updates);
+
+    for (int k = 0; k < nr_proxies; k++) free(update_send[k]);
+
+    /* Update the sets with what the neighbours found */
+    int local_changed = 0;
+    for (size_t u = 0; u < nr_updates; u++) {
+      const int *fragment =
+          (const int *)chashmap_lookup(&map, updates[u].group);
+      if (fragment == NULL)
+        error("Received an update for unknown group %zu.", updates[u].group);
+
+      const int r = fof_find_fragment(*fragment, parent);
+      if (updates[u].leader < leader_id[r]) {
+        leader_id[r] = updates[u].leader;
+        changed[r] = 1;
+        local_changed = 1;
+      }
+    }
+    free(updates);
+    nr_rounds++;
+
+    int global_changed = 0;
+    MPI_Allreduce(&local_changed, &global_changed, 1, MPI_INT, MPI_LOR,
+                  MPI_COMM_WORLD);
+    if (!global_changed) break;
+  }
+  free(update_send);
+  chashmap_free(&map);
+
+  if (verbose)
+    message("Propagating the leaders took %d rounds and %.3f %s.", nr_rounds,
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  tic = getticks();
+
+  /* Send the links found here to the owner of the leader of their group. As
+   * MPI_Alltoallv() orders the data by rank, every group then has all its
+   * links in the same order as in fof_link_groups_gathered(). */
+  int *sendcount = (int *)malloc(nr_nodes * sizeof(int));
+  for (int i = 0; i < nr_nodes; i++) sendcount[i] = 0;
+  int *link_node = (int *)malloc(group_link_count * sizeof(int));
+  for (int l = 0; l < group_link_count; l++) {
+    const size_t leader = leader_id[fof_find_fragment(link_i[l], parent)];
+    link_node[l] = fof_node_of_index(leader, first_on_node, nr_nodes);
+    sendcount[link_node[l]]++;
+  }
+
+  int *recvcount = NULL, *sendoffset = NULL, *recvoffset = NULL;
+  size_t nr_group_links = 0;
+  fof_compute_send_recv_offsets(nr_nodes, sendcount, &recvcount, &sendoffset,
+                                &recvoffset, &nr_group_links);
+
+  struct fof_mpi *leader_link_send = NULL, *group_links = NULL;
+  if (swift_memalign("fof_link_send", (void **)&leader_link_send,
+                     SWIFT_STRUCT_ALIGNMENT,
+                     group_link_count * sizeof(struct fof_mpi)) != 0 ||
+      swift_memalign("fof_group_links", (void **)&group_links,
+                     SWIFT_STRUCT_ALIGNMENT,
+                     nr_group_links * sizeof(struct fof_mpi)) != 0)
+    error("Failed to allocate FOF links to gather.");
+  for (int i = 0; i < nr_nodes; i++) sendcount[i] = 0;
+  for (int l = 0; l < group_link_count; l++) {
+    const int node = link_node[l];
+    leader_link_send[sendoffset[node] + sendcount[node]++] = links[l];
+  }
+
+  MPI_Alltoallv(leader_link_send, sendcount, sendoffset, fof_mpi_type,
+                group_links, recvcount, recvoffset, fof_mpi_type,
+                MPI_COMM_WORLD);
+
+  swift_free("fof_link_send", leader_link_send);
+  free(link_node);
+  free(recvcount);
+  free(sendoffset);
+  free(recvoffset);
+
+  /* Merge the fragments of the groups led here as fof_link_groups_gathered()
+   * does, in the same order and with the same sizes */
+  chashmap_init(&map, 2 * nr_group_links, sizeof(int));
+  size_t *set_id = (size_t *)malloc(2 * nr_group_links * sizeof(size_t));
+  size_t *set_size = (size_t *)malloc(2 * nr_group_links * sizeof(size_t));
+  size_t *set_orig_size =
+      (size_t *)malloc(2 * nr_group_links * sizeof(size_t));
+  int *set_parent = (int *)malloc(2 * nr_group_links * sizeof(int));
+  int nr_sets = 0;
+
+  for (size_t l = 0; l < nr_group_links; l++) {
+
+    int set[2];
+    for (int side = 0; side < 2; side++) {
+
+      const size_t id = side ? group_links[l].group_j : group_links[l].group_i;
+      int created = 0;
+      int *index = (int *)chashmap_get_new(&map, id, &created);
+      if (created) {
+        *index = nr_sets;
+        set_id[nr_sets] = id;
+        set_orig_size[nr_sets] =
+            side ? group_links[l].group_j_size : group_links[l].group_i_size;
+        set_size[nr_sets] = set_orig_size[nr_sets];
+        set_parent[nr_sets] = nr_sets;
+        nr_sets++;
+      }
+      set[side] = fof_find_fragment(*index, set_parent);
+    }
+
+    if (set[0] == set[1]) continue;
+
+    if (fof_set_keeps_root(set_size[set[0]], set_id[set[0]], set_size[set[1]],
+                           set_id[set[1]])) {
+      set_parent[set[1]] = set[0];
+      set_size[set[0]] += set_size[set[1]];
+    } else {
+      set_parent[set[0]] = set[1];
+      set_size[set[1]] += set_size[set[0]];
+    }
+  }
+  chashmap_free(&map);
+
+  /* Send the root of each fragment to the owner of the fragment and the size
+   * of the fragment to the owner of the root */
+  int *set_node = (int *)malloc(2 * nr_sets * sizeof(int));
+  for (int i = 0; i < nr_nodes; i++) sendcount[i] = 0;
+  for (int i = 0; i < nr_sets; i++) {
+
+    const int r = fof_find_fragment(i, set_parent);
+    set_node[2 * i] = set_node[2 * i + 1] = -1;
+    if (r == i) continue;
+
+    set_node[2 * i] = fof_node_of_index(set_id[i], first_on_node, nr_nodes);
+    sendcount[set_node[2 * i]]++;
+
+    const int root_node =
+        fof_node_of_index(set_id[r], first_on_node, nr_nodes);
+    if (root_node != set_node[2 * i]) {
+      set_node[2 * i + 1] = root_node;
+      sendcount[root_node]++;
+    }
+  }
+
+  size_t nrecv = 0;
+  fof_compute_send_recv_offsets(nr_nodes, sendcount, &recvcount, &sendoffset,
+                                &recvoffset, &nrecv);
+
+  struct fof_fragment_root *root_send = (struct fof_fragment_root *)malloc(
+      (sendoffset[nr_nodes - 1] + sendcount[nr_nodes - 1]) *
+      sizeof(struct fof_fragment_root));
+  struct fof_fragment_root *root_recv = (struct fof_fragment_root *)malloc(
+      nrecv * sizeof(struct fof_fragment_root));
+  for (int i = 0; i < nr_nodes; i++) sendcount[i] = 0;
+  for (int i = 0; i < nr_sets; i++) {
+    for (int k = 0; k < 2; k++) {
+      const int node = set_node[2 * i + k];
+      if (node < 0) continue;
+      struct fof_fragment_root *f =
+          &root_send[sendoffset[node] + sendcount[node]++];
+      f->group = set_id[i];
+      f->root = set_id[fof_find_fragment(i, set_parent)];
+      f->size = set_orig_size[i];
+    }
+  }
+
+  MPI_Alltoallv(root_send, sendcount, sendoffset, fof_fragment_root_type,
+                root_recv, recvcount, recvoffset, fof_fragment_root_type,
+                MPI_COMM_WORLD);
+
+  /* Point the local fragments to their root and move their size to it */
+  for (size_t i = 0; i < nrecv; i++) {
+    const size_t group = root_recv[i].group;
+    const size_t root = root_recv[i].root;
+    if (is_local(group, nr_gparts)) {
+      group_index[group - node_offset] = root;
+      group_size[group - node_offset] -= root_recv[i].size;
+    }
+    if (is_local(root, nr_gparts))
+      group_size[root - node_offset] += root_recv[i].size;
+  }
+
+  if (verbose)
+    message("Linking %d fragments took: %.3f %s.", nr_sets,
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  /* Clean up memory. */
+  free(root_send);
+  free(root_recv);
+  free(set_node);
+  free(set_id);
+  free(set_size);
+  free(set_orig_size);
+  free(set_parent);
+  swift_free("fof_group_links", group_links);
+  swift_free("fof_links", links);
+  free(sendcount);
+  free(recvcount);
+  free(sendoffset);
+  free(recvoffset);
+  free(fragment_id);
+  free(fragment_proxy);
+  free(link_i);
+  free(link_j);
+  free(parent);
+  free(leader_id);
+  free(changed);
+  free(send_count);
+  free(proxy_of_node);
+  free(num_on_node);
+  free(first_on_node);
+}
+
+#endif /* WITH_MPI */
+
+/**
+ * @brief Search foreign cells for links and communicate any found to the
+ * appropriate node.
+ *
+ * @param props the properties of the FOF scheme.
+ * @param s Pointer to a #space.
+ */
+void fof_search_foreign_cells(struct fof_props *props, const struct space *s) {
+
+#ifdef WITH_MPI
+
+  struct engine *e = s->e;
+  int verbose = e->verbose;
+  size_t *group_index = props->group_index;
+  size_t *group_size = props->group_size;
+  const size_t nr_gparts = s->nr_gparts;
+  const double dim[3] = {s->dim[0], s->dim[1], s->dim[2]};
+  const double search_r2 = props->l_x2;
+
+  ticks tic = getticks();
+
+  /* Make group IDs globally unique. */
+  for (size_t i = 0; i < nr_gparts; i++) group_index[i] += node_offset;
+
+  struct cell_pair_indices *cell_pairs = NULL;
+  int group_link_count = 0;
+  int cell_pair_count = 0;
+
+  props->group_links_size = fof_props_default_group_link_size;
+  props->group_link_count = 0;
+
+  int num_cells_out = 0;
+  int num_cells_in = 0;
+
+  /* Find the maximum no. of cell pairs. */
+  for (int i = 0; i < e->nr_proxies; i++) {
+
+    for (int j = 0; j < e->proxies[i].nr_cells_out; j++) {
+
+      /* Only include gravity cells. */
+      if (e->proxies[i].cells_out_type[j] & proxy_cell_type_gravity)
+        num_cells_out++;
+    }
+
+    for (int j = 0; j < e->proxies[i].nr_cells_in; j++) {
+
+      /* Only include gravity cells. */
+      if (e->proxies[i].cells_in_type[j] & proxy_cell_type_gravity)
+        num_cells_in++;
+    }
+  }
+
+  if (verbose)
+    message(
+        "Finding max no. of cells + offset IDs"
+        "took: %.3f %s.",
+        clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  const int cell_pair_size = num_cells_in * num_cells_out;
+
+  if (swift_memalign("fof_group_links", (void **)&props->group_links,
+                     SWIFT_STRUCT_ALIGNMENT,
+                     props->group_links_size * sizeof(struct fof_mpi)) != 0)
+    error("Error while allocating memory for FOF links over an MPI domain");
+
+  if (swift_memalign("fof_cell_pairs", (void **)&cell_pairs,
+                     SWIFT_STRUCT_ALIGNMENT,
+                     cell_pair_size * sizeof(struct cell_pair_indices)) != 0)
+    error("Error while allocating memory for FOF cell pair indices");
+
+  ticks tic_pairs = getticks();
+
+  /* Loop over cells_in and cells_out for each proxy and find which cells are in
+   * range of each other to perform the FOF search. Store local cells that are
+   * touching foreign cells in a list. */
+  for (int i = 0; i < e->nr_proxies; i++) {
+
+    /* Only find links across an MPI domain on one rank. */
+    if (engine_rank == min(engine_rank, e->proxies[i].nodeID)) {
+
+      for (int j = 0; j < e->proxies[i].nr_cells_out; j++) {
+
+        /* Skip non-gravity cells. */
+        if (!(e->proxies[i].cells_out_type[j] & proxy_cell_type_gravity))
+          continue;
+
+        struct cell *restrict local_cell = e->proxies[i].cells_out[j];
+
+        /* Skip empty cells. */
+        if (local_cell->grav.count == 0) continue;
+
+        for (int k = 0; k < e->proxies[i].nr_cells_in; k++) {
+
+          /* Skip non-gravity cells. */
+          if (!(e->proxies[i].cells_in_type[k] & proxy_cell_type_gravity))
+            continue;
+
+          struct cell *restrict foreign_cell = e->proxies[i].cells_in[k];
+
+          /* Skip empty cells. */
+          if (foreign_cell->grav.count == 0) continue;
+
+          /* Check if local cell has already been added to the local list of
+           * cells. */
+          const double r2 = cell_min_dist(local_cell, foreign_cell, dim);
+          if (r2 < search_r2) {
+            cell_pairs[cell_pair_count].local = local_cell;
+            cell_pairs[cell_pair_count++].foreign = foreign_cell;
+          }
+        }
+      }
+    }
+  }
+
+  if (verbose)
+    message(
+        "Finding local/foreign cell pairs"
+        "took: %.3f %s.",
+        clocks_from_ticks(getticks() - tic_pairs), clocks_getunit());
+
+  ticks tic_set_roots = getticks();
+
+  /* Set the root of outgoing particles. */
+
+  /* Allocate array of outgoing cells and populate it */
+  struct cell **local_cells = malloc(num_cells_out * sizeof(struct cell *));
+  int count = 0;
+  for (int i = 0; i < e->nr_proxies; i++) {
+    for (int j = 0; j < e->proxies[i].nr_cells_out; j++) {
+
+      /* Only include gravity cells. */
+      if (e->proxies[i].cells_out_type[j] & proxy_cell_type_gravity) {
+
+        local_cells[count] = e->proxies[i].cells_out[j];
+        ++count;
+      }
+    }
+  }
+
+  /* Now set the roots */
+  struct mapper_data data;
+  data.group_index = group_index;
+  data.group_size = group_size;
+  data.nr_gparts = nr_gparts;
+  data.space_gparts = s->gparts;
+  threadpool_map(&e->threadpool, fof_set_outgoing_root_mapper, local_cells,
+                 num_cells_out, sizeof(struct cell **),
+                 threadpool_auto_chunk_size, &data);
+
+  if (verbose)
+    message(
+        "Initialising particle roots "
+        "took: %.3f %s.",
+        clocks_from_ticks(getticks() - tic_set_roots), clocks_getunit());
+
+  free(local_cells);
+
+  if (verbose)
+    message(
+        "Finding local/foreign cell pairs and initialising particle roots "
+        "took: %.3f %s.",
+        clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  /* Activate the tasks exchanging all the required gparts */
+  engine_activate_gpart_comms(e);
+
+  ticks local_fof_tic = getticks();
+
+  MPI_Barrier(MPI_COMM_WORLD);
+
+  if (verbose)
+    message("Local FOF imbalance: %.3f %s.",
+            clocks_from_ticks(getticks() - local_fof_tic), clocks_getunit());
+
+  tic = getticks();
+
+  /* Perform send and receive tasks. */
+  engine_launch(e, "fof comms");
+
+  if (verbose)
+    message("MPI send/recv comms took: %.3f %s.",
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  tic = getticks();
+
+  /* Perform search of group links between local and foreign cells with the
+   * threadpool. */
+  threadpool_map(&s->e->threadpool, fof_find_foreign_links_mapper, cell_pairs,
+                 cell_pair_count, sizeof(struct cell_pair_indices), 1,
+                 (struct space *)s);
+
+  group_link_count = props->group_link_count;
+
+  /* Clean up memory. */
+  swift_free("fof_cell_pairs", cell_pairs);
+
+  if (verbose)
+    message("Searching for foreign links took: %.3f %s.",
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  /* Link the groups across MPI domains */
+  if (props->gather_group_links)
+    fof_link_groups_gathered(props, s, group_link_count);
+  else
+    fof_link_groups_distributed(props, s, group_link_count);
 
 #endif /* WITH_MPI */
 }
@@ -81,6 +81,10 @@ struct fof_props {
   /*! The base name of the output file */
   char base_name[PARSER_MAX_LINE_SIZE];
 
+  /*! Gather all the links between groups on every rank instead of only
+   * exchanging them with the neighbouring ranks? */
+  int gather_group_links;
+
   /* ------------  Group properties ----------------- */
 
   /*! Number of groups */
@@ -128,6 +132,30 @@ struct group_length {
 } SWIFT_STRUCT_ALIGN;
 
 #ifdef WITH_MPI
+/* Lowest fragment of a group spanning several MPI domains sent to a
+ * neighbouring rank while linking the groups */
+struct fof_link_update {
+
+  /* The global root index of the fragment on the receiving rank */
+  size_t group;
+
+  /* The lowest global root index of the group found so far */
+  size_t leader;
+};
+
+/* Final root of a fragment of a group spanning several MPI domains */
+struct fof_fragment_root {
+
+  /* The global root index of the fragment */
+  size_t group;
+
+  /* The global root index of the group */
+  size_t root;
+
+  /* The number of particles in the fragment */
+  size_t size;
+};
+
 /* Struct used to find final group ID when using MPI */
 struct fof_final_index {
   size_t local_root;
@@ -142,6 +170,15 @@ struct fof_final_mass {
   float max_part_density;
 } SWIFT_STRUCT_ALIGN;
 
+/* Fragment of a group whose root is on another node, accumulated in a hash
+ * table by all the threads when using MPI */
+struct fof_mass_fragment {
+  double group_mass;
+  long long max_part_density_index;
+  float max_part_density;
+  volatile int lock;
+};
+
 /* Struct used to iterate over the hash table and unpack the mass fragments of a
  * group when using MPI */
 struct fof_mass_send_hashmap {
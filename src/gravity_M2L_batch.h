@@ -0,0 +1,465 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#ifndef SWIFT_GRAVITY_M2L_BATCH_H
+#define SWIFT_GRAVITY_M2L_BATCH_H
+
+/* Config parameters. */
+#include "../config.h"
+
+/* Some standard headers. */
+#include <string.h>
+
+/* Local headers */
+#include "align.h"
+#include "error.h"
+#include "memuse.h"
+#include "multipole.h"
+#include "periodic.h"
+
+/*! Number of M2L interactions held by a #gravity_M2L_batch, a multiple of the
+ * vector length */
+#define gravity_M2L_batch_size 256
+
+/**
+ * @brief Index of the moments of the multipoles in a #gravity_M2L_batch.
+ *
+ * The dipole is zero as we expand around the CoM and is not stored.
+ */
+enum gravity_M2L_batch_moments {
+  gravity_M2L_batch_M_000,
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 1
+  gravity_M2L_batch_M_200,
+  gravity_M2L_batch_M_020,
+  gravity_M2L_batch_M_002,
+  gravity_M2L_batch_M_110,
+  gravity_M2L_batch_M_101,
+  gravity_M2L_batch_M_011,
+#endif
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 2
+  gravity_M2L_batch_M_300,
+  gravity_M2L_batch_M_030,
+  gravity_M2L_batch_M_003,
+  gravity_M2L_batch_M_210,
+  gravity_M2L_batch_M_201,
+  gravity_M2L_batch_M_120,
+  gravity_M2L_batch_M_021,
+  gravity_M2L_batch_M_102,
+  gravity_M2L_batch_M_012,
+  gravity_M2L_batch_M_111,
+#endif
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 3
+  gravity_M2L_batch_M_400,
+  gravity_M2L_batch_M_040,
+  gravity_M2L_batch_M_004,
+  gravity_M2L_batch_M_310,
+  gravity_M2L_batch_M_301,
+  gravity_M2L_batch_M_130,
+  gravity_M2L_batch_M_031,
+  gravity_M2L_batch_M_103,
+  gravity_M2L_batch_M_013,
+  gravity_M2L_batch_M_220,
+  gravity_M2L_batch_M_202,
+  gravity_M2L_batch_M_022,
+  gravity_M2L_batch_M_211,
+  gravity_M2L_batch_M_121,
+  gravity_M2L_batch_M_112,
+#endif
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 4
+  gravity_M2L_batch_M_005,
+  gravity_M2L_batch_M_014,
+  gravity_M2L_batch_M_023,
+  gravity_M2L_batch_M_032,
+  gravity_M2L_batch_M_041,
+  gravity_M2L_batch_M_050,
+  gravity_M2L_batch_M_104,
+  gravity_M2L_batch_M_113,
+  gravity_M2L_batch_M_122,
+  gravity_M2L_batch_M_131,
+  gravity_M2L_batch_M_140,
+  gravity_M2L_batch_M_203,
+  gravity_M2L_batch_M_212,
+  gravity_M2L_batch_M_221,
+  gravity_M2L_batch_M_230,
+  gravity_M2L_batch_M_302,
+  gravity_M2L_batch_M_311,
+  gravity_M2L_batch_M_320,
+  gravity_M2L_batch_M_401,
+  gravity_M2L_batch_M_410,
+  gravity_M2L_batch_M_500,
+#endif
+  gravity_M2L_batch_nr_moments
+};
+
+/**
+ * @brief A SoA object for the M2L interactions of many multipoles with the
+ * same field tensor.
+ *
+ * The derivatives of the potential and the contractions with the moments are
+ * then evaluated with the interactions spread over the vector lanes.
+ */
+struct gravity_M2L_batch {
+
+  /*! Distance vector between the field tensor and each multipole. */
+  float *restrict dx SWIFT_CACHE_ALIGN;
+  float *restrict dy SWIFT_CACHE_ALIGN;
+  float *restrict dz SWIFT_CACHE_ALIGN;
+
+  /*! Moments of each multipole, one row of gravity_M2L_batch_size per
+   * moment. */
+  float *restrict M SWIFT_CACHE_ALIGN;
+
+  /*! The field tensor accumulated from the interactions computed so far. */
+  struct grav_tensor l;
+
+  /*! Position of the field tensor. */
+  double pos[3];
+
+  /*! Size of the simulation box. */
+  double dim[3];
+
+  /*! Inverse of the gravity mesh-smoothing scale. */
+  float r_s_inv;
+
+  /*! Are we using periodic BCs ? */
+  int periodic;
+
+  /*! Number of interactions waiting to be computed. */
+  int count;
+};
+
+/**
+ * @brief Frees the memory allocated in a #gravity_M2L_batch.
+ *
+ * @param b The #gravity_M2L_batch to free.
+ */
+static INLINE void gravity_M2L_batch_clean(struct gravity_M2L_batch *b) {
+
+  swift_free("gravity_M2L_batch", b->dx);
+  swift_free("gravity_M2L_batch", b->dy);
+  swift_free("gravity_M2L_batch", b->dz);
+  swift_free("gravity_M2L_batch", b->M);
+  b->dx = NULL;
+  b->dy = NULL;
+  b->dz = NULL;
+  b->M = NULL;
+}
+
+/**
+ * @brief Allocates the memory of a #gravity_M2L_batch.
+ *
+ * @param b The #gravity_M2L_batch to allocate.
+ */
+static INLINE void gravity_M2L_batch_init(struct gravity_M2L_batch *b) {
+
+  const size_t sizeBytes = gravity_M2L_batch_size * sizeof(float);
+
+  int e = 0;
+  e += swift_memalign("gravity_M2L_batch", (void **)&b->dx,
+                      SWIFT_CACHE_ALIGNMENT, sizeBytes);
+  e += swift_memalign("gravity_M2L_batch", (void **)&b->dy,
+                      SWIFT_CACHE_ALIGNMENT, sizeBytes);
+  e += swift_memalign("gravity_M2L_batch", (void **)&b->dz,
+                      SWIFT_CACHE_ALIGNMENT, sizeBytes);
+  e += swift_memalign("gravity_M2L_batch", (void **)&b->M,
+                      SWIFT_CACHE_ALIGNMENT,
+                      gravity_M2L_batch_nr_moments * sizeBytes);
+
+  if (e != 0) error("Couldn't allocate M2L batch.");
+
+  b->count = 0;
+}
+
+/**
+ * @brief Starts collecting the M2L interactions of a field tensor.
+ *
+ * @param b The #gravity_M2L_batch.
+ * @param pos The position of the field tensor.
+ * @param periodic Are we using periodic BCs ?
+ * @param dim The size of the simulation box.
+ * @param r_s_inv The inverse of the gravity mesh-smoothing scale.
+ */
+INLINE static void gravity_M2L_batch_begin(struct gravity_M2L_batch *b,
+                                           const double pos[3],
+                                           const int periodic,
+                                           const double dim[3],
+                                           const float r_s_inv) {
+
+  bzero(&b->l, sizeof(struct grav_tensor));
+  for (int k = 0; k < 3; k++) {
+    b->pos[k] = pos[k];
+    b->dim[k] = dim[k];
+  }
+  b->periodic = periodic;
+  b->r_s_inv = r_s_inv;
+  b->count = 0;
+}
+
+/**
+ * @brief Computes all the M2L interactions waiting in a #gravity_M2L_batch
+ * and adds them to its field tensor.
+ *
+ * @param b The #gravity_M2L_batch.
+ */
+INLINE static void gravity_M2L_batch_compute(struct gravity_M2L_batch *b) {
+
+  const int count = b->count;
+  const int periodic = b->periodic;
+  const float r_s_inv = b->r_s_inv;
+
+  /* Make the compiler understand we are in happy vectorization land */
+  swift_declare_aligned_ptr(const float, dx, b->dx, SWIFT_CACHE_ALIGNMENT);
+  swift_declare_aligned_ptr(const float, dy, b->dy, SWIFT_CACHE_ALIGNMENT);
+  swift_declare_aligned_ptr(const float, dz, b->dz, SWIFT_CACHE_ALIGNMENT);
+  swift_declare_aligned_ptr(const float, M, b->M, SWIFT_CACHE_ALIGNMENT);
+
+  /* Local copy of the field tensor, such that its components become the
+   * reduction variables of the loop */
+  struct grav_tensor l = b->l;
+
+  for (int i = 0; i < count; i++) {
+
+    /* Compute distance */
+    const float r2 = dx[i] * dx[i] + dy[i] * dy[i] + dz[i] * dz[i];
+    const float r_inv = 1.f / sqrtf(r2);
+
+    /* The softened interactions were done when they were added. The
+     * softened branch of the derivatives is nevertheless evaluated in the
+     * vector lanes, so give it a softening below r with finite values. */
+    const float eps = 0.5f * r2 * r_inv;
+
+    /* Compute all derivatives */
+    struct potential_derivatives_M2L pot;
+    potential_derivatives_compute_M2L(dx[i], dy[i], dz[i], r2, r_inv, eps,
+                                      periodic, r_s_inv, &pot);
+
+    /* Gather the moments of this multipole */
+    struct multipole m;
+    m.M_000 = M[gravity_M2L_batch_M_000 * gravity_M2L_batch_size + i];
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 1
+    m.M_200 = M[gravity_M2L_batch_M_200 * gravity_M2L_batch_size + i];
+    m.M_020 = M[gravity_M2L_batch_M_020 * gravity_M2L_batch_size + i];
+    m.M_002 = M[gravity_M2L_batch_M_002 * gravity_M2L_batch_size + i];
+    m.M_110 = M[gravity_M2L_batch_M_110 * gravity_M2L_batch_size + i];
+    m.M_101 = M[gravity_M2L_batch_M_101 * gravity_M2L_batch_size + i];
+    m.M_011 = M[gravity_M2L_batch_M_011 * gravity_M2L_batch_size + i];
+#endif
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 2
+    m.M_300 = M[gravity_M2L_batch_M_300 * gravity_M2L_batch_size + i];
+    m.M_030 = M[gravity_M2L_batch_M_030 * gravity_M2L_batch_size + i];
+    m.M_003 = M[gravity_M2L_batch_M_003 * gravity_M2L_batch_size + i];
+    m.M_210 = M[gravity_M2L_batch_M_210 * gravity_M2L_batch_size + i];
+    m.M_201 = M[gravity_M2L_batch_M_201 * gravity_M2L_batch_size + i];
+    m.M_120 = M[gravity_M2L_batch_M_120 * gravity_M2L_batch_size + i];
+    m.M_021 = M[gravity_M2L_batch_M_021 * gravity_M2L_batch_size + i];
+    m.M_102 = M[gravity_M2L_batch_M_102 * gravity_M2L_batch_size + i];
+    m.M_012 = M[gravity_M2L_batch_M_012 * gravity_M2L_batch_size + i];
+    m.M_111 = M[gravity_M2L_batch_M_111 * gravity_M2L_batch_size + i];
+#endif
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 3
+    m.M_400 = M[gravity_M2L_batch_M_400 * gravity_M2L_batch_size + i];
+    m.M_040 = M[gravity_M2L_batch_M_040 * gravity_M2L_batch_size + i];
+    m.M_004 = M[gravity_M2L_batch_M_004 * gravity_M2L_batch_size + i];
+    m.M_310 = M[gravity_M2L_batch_M_310 * gravity_M2L_batch_size + i];
+    m.M_301 = M[gravity_M2L_batch_M_301 * gravity_M2L_batch_size + i];
+    m.M_130 = M[gravity_M2L_batch_M_130 * gravity_M2L_batch_size + i];
+    m.M_031 = M[gravity_M2L_batch_M_031 * gravity_M2L_batch_size + i];
+    m.M_103 = M[gravity_M2L_batch_M_103 * gravity_M2L_batch_size + i];
+    m.M_013 = M[gravity_M2L_batch_M_013 * gravity_M2L_batch_size + i];
+    m.M_220 = M[gravity_M2L_batch_M_220 * gravity_M2L_batch_size + i];
+    m.M_202 = M[gravity_M2L_batch_M_202 * gravity_M2L_batch_size + i];
+    m.M_022 = M[gravity_M2L_batch_M_022 * gravity_M2L_batch_size + i];
+    m.M_211 = M[gravity_M2L_batch_M_211 * gravity_M2L_batch_size + i];
+    m.M_121 = M[gravity_M2L_batch_M_121 * gravity_M2L_batch_size + i];
+    m.M_112 = M[gravity_M2L_batch_M_112 * gravity_M2L_batch_size + i];
+#endif
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 4
+    m.M_005 = M[gravity_M2L_batch_M_005 * gravity_M2L_batch_size + i];
+    m.M_014 = M[gravity_M2L_batch_M_014 * gravity_M2L_batch_size + i];
+    m.M_023 = M[gravity_M2L_batch_M_023 * gravity_M2L_batch_size + i];
+    m.M_032 = M[gravity_M2L_batch_M_032 * gravity_M2L_batch_size + i];
+    m.M_041 = M[gravity_M2L_batch_M_041 * gravity_M2L_batch_size + i];
+    m.M_050 = M[gravity_M2L_batch_M_050 * gravity_M2L_batch_size + i];
+    m.M_104 = M[gravity_M2L_batch_M_104 * gravity_M2L_batch_size + i];
+    m.M_113 = M[gravity_M2L_batch_M_113 * gravity_M2L_batch_size + i];
+    m.M_122 = M[gravity_M2L_batch_M_122 * gravity_M2L_batch_size + i];
+    m.M_131 = M[gravity_M2L_batch_M_131 * gravity_M2L_batch_size + i];
+    m.M_140 = M[gravity_M2L_batch_M_140 * gravity_M2L_batch_size + i];
+    m.M_203 = M[gravity_M2L_batch_M_203 * gravity_M2L_batch_size + i];
+    m.M_212 = M[gravity_M2L_batch_M_212 * gravity_M2L_batch_size + i];
+    m.M_221 = M[gravity_M2L_batch_M_221 * gravity_M2L_batch_size + i];
+    m.M_230 = M[gravity_M2L_batch_M_230 * gravity_M2L_batch_size + i];
+    m.M_302 = M[gravity_M2L_batch_M_302 * gravity_M2L_batch_size + i];
+    m.M_311 = M[gravity_M2L_batch_M_311 * gravity_M2L_batch_size + i];
+    m.M_320 = M[gravity_M2L_batch_M_320 * gravity_M2L_batch_size + i];
+    m.M_401 = M[gravity_M2L_batch_M_401 * gravity_M2L_batch_size + i];
+    m.M_410 = M[gravity_M2L_batch_M_410 * gravity_M2L_batch_size + i];
+    m.M_500 = M[gravity_M2L_batch_M_500 * gravity_M2L_batch_size + i];
+#endif
+
+    /* Do the M2L tensor multiplication */
+    gravity_M2L_add(&l, &m, &pot);
+  }
+
+  b->l = l;
+  b->count = 0;
+}
+
+/**
+ * @brief Adds the M2L interaction of a multipole to a #gravity_M2L_batch.
+ *
+ * Computes the interactions collected so far when the batch is full.
+ *
+ * @param b The #gravity_M2L_batch.
+ * @param m_a The multipole creating the field.
+ * @param pos_a The position of the multipole.
+ */
+INLINE static void gravity_M2L_batch_add(struct gravity_M2L_batch *b,
+                                         const struct multipole *m_a,
+                                         const double pos_a[3]) {
+
+  /* Compute distance vector */
+  float dx = (float)(b->pos[0] - pos_a[0]);
+  float dy = (float)(b->pos[1] - pos_a[1]);
+  float dz = (float)(b->pos[2] - pos_a[2]);
+
+  /* Apply BC */
+  if (b->periodic) {
+    dx = nearest(dx, b->dim[0]);
+    dy = nearest(dy, b->dim[1]);
+    dz = nearest(dz, b->dim[2]);
+  }
+
+#ifdef SWIFT_DEBUG_CHECKS
+  /* Count all interactions */
+  b->l.num_interacted += m_a->num_gpart;
+#endif
+
+#ifdef SWIFT_GRAVITY_FORCE_CHECKS
+  /* Count tree interactions */
+  b->l.num_interacted_tree += m_a->num_gpart;
+#endif
+
+  /* Record that the tensor has received contributions */
+  b->l.interacted = 1;
+
+  /* Softened interactions are rare, do them straight away */
+  const float eps = m_a->max_softening;
+  const float r2 = dx * dx + dy * dy + dz * dz;
+  if (r2 < eps * eps) {
+
+    const float r_inv = 1.f / sqrtf(r2);
+    struct potential_derivatives_M2L pot;
+    potential_derivatives_compute_M2L(dx, dy, dz, r2, r_inv, eps, b->periodic,
+                                      b->r_s_inv, &pot);
+    gravity_M2L_add(&b->l, m_a, &pot);
+    return;
+  }
+
+  if (b->count == gravity_M2L_batch_size) gravity_M2L_batch_compute(b);
+
+  const int i = b->count;
+  b->dx[i] = dx;
+  b->dy[i] = dy;
+  b->dz[i] = dz;
+
+  /* Scatter the moments to their rows */
+  float *M = b->M + i;
+  M[gravity_M2L_batch_M_000 * gravity_M2L_batch_size] = m_a->M_000;
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 1
+  M[gravity_M2L_batch_M_200 * gravity_M2L_batch_size] = m_a->M_200;
+  M[gravity_M2L_batch_M_020 * gravity_M2L_batch_size] = m_a->M_020;
+  M[gravity_M2L_batch_M_002 * gravity_M2L_batch_size] = m_a->M_002;
+  M[gravity_M2L_batch_M_110 * gravity_M2L_batch_size] = m_a->M_110;
+  M[gravity_M2L_batch_M_101 * gravity_M2L_batch_size] = m_a->M_101;
+  M[gravity_M2L_batch_M_011 * gravity_M2L_batch_size] = m_a->M_011;
+#endif
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 2
+  M[gravity_M2L_batch_M_300 * gravity_M2L_batch_size] = m_a->M_300;
+  M[gravity_M2L_batch_M_030 * gravity_M2L_batch_size] = m_a->M_030;
+  M[gravity_M2L_batch_M_003 * gravity_M2L_batch_size] = m_a->M_003;
+  M[gravity_M2L_batch_M_210 * gravity_M2L_batch_size] = m_a->M_210;
+  M[gravity_M2L_batch_M_201 * gravity_M2L_batch_size] = m_a->M_201;
+  M[gravity_M2L_batch_M_120 * gravity_M2L_batch_size] = m_a->M_120;
+  M[gravity_M2L_batch_M_021 * gravity_M2L_batch_size] = m_a->M_021;
+  M[gravity_M2L_batch_M_102 * gravity_M2L_batch_size] = m_a->M_102;
+  M[gravity_M2L_batch_M_012 * gravity_M2L_batch_size] = m_a->M_012;
+  M[gravity_M2L_batch_M_111 * gravity_M2L_batch_size] = m_a->M_111;
+#endif
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 3
+  M[gravity_M2L_batch_M_400 * gravity_M2L_batch_size] = m_a->M_400;
+  M[gravity_M2L_batch_M_040 * gravity_M2L_batch_size] = m_a->M_040;
+  M[gravity_M2L_batch_M_004 * gravity_M2L_batch_size] = m_a->M_004;
+  M[gravity_M2L_batch_M_310 * gravity_M2L_batch_size] = m_a->M_310;
+  M[gravity_M2L_batch_M_301 * gravity_M2L_batch_size] = m_a->M_301;
+  M[gravity_M2L_batch_M_130 * gravity_M2L_batch_size] = m_a->M_130;
+  M[gravity_M2L_batch_M_031 * gravity_M2L_batch_size] = m_a->M_031;
+  M[gravity_M2L_batch_M_103 * gravity_M2L_batch_size] = m_a->M_103;
+  M[gravity_M2L_batch_M_013 * gravity_M2L_batch_size] = m_a->M_013;
+  M[gravity_M2L_batch_M_220 * gravity_M2L_batch_size] = m_a->M_220;
+  M[gravity_M2L_batch_M_202 * gravity_M2L_batch_size] = m_a->M_202;
+  M[gravity_M2L_batch_M_022 * gravity_M2L_batch_size] = m_a->M_022;
+  M[gravity_M2L_batch_M_211 * gravity_M2L_batch_size] = m_a->M_211;
+  M[gravity_M2L_batch_M_121 * gravity_M2L_batch_size] = m_a->M_121;
+  M[gravity_M2L_batch_M_112 * gravity_M2L_batch_size] = m_a->M_112;
+#endif
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 4
+  M[gravity_M2L_batch_M_005 * gravity_M2L_batch_size] = m_a->M_005;
+  M[gravity_M2L_batch_M_014 * gravity_M2L_batch_size] = m_a->M_014;
+  M[gravity_M2L_batch_M_023 * gravity_M2L_batch_size] = m_a->M_023;
+  M[gravity_M2L_batch_M_032 * gravity_M2L_batch_size] = m_a->M_032;
+  M[gravity_M2L_batch_M_041 * gravity_M2L_batch_size] = m_a->M_041;
+  M[gravity_M2L_batch_M_050 * gravity_M2L_batch_size] = m_a->M_050;
+  M[gravity_M2L_batch_M_104 * gravity_M2L_batch_size] = m_a->M_104;
+  M[gravity_M2L_batch_M_113 * gravity_M2L_batch_size] = m_a->M_113;
+  M[gravity_M2L_batch_M_122 * gravity_M2L_batch_size] = m_a->M_122;
+  M[gravity_M2L_batch_M_131 * gravity_M2L_batch_size] = m_a->M_131;
+  M[gravity_M2L_batch_M_140 * gravity_M2L_batch_size] = m_a->M_140;
+  M[gravity_M2L_batch_M_203 * gravity_M2L_batch_size] = m_a->M_203;
+  M[gravity_M2L_batch_M_212 * gravity_M2L_batch_size] = m_a->M_212;
+  M[gravity_M2L_batch_M_221 * gravity_M2L_batch_size] = m_a->M_221;
+  M[gravity_M2L_batch_M_230 * gravity_M2L_batch_size] = m_a->M_230;
+  M[gravity_M2L_batch_M_302 * gravity_M2L_batch_size] = m_a->M_302;
+  M[gravity_M2L_batch_M_311 * gravity_M2L_batch_size] = m_a->M_311;
+  M[gravity_M2L_batch_M_320 * gravity_M2L_batch_size] = m_a->M_320;
+  M[gravity_M2L_batch_M_401 * gravity_M2L_batch_size] = m_a->M_401;
+  M[gravity_M2L_batch_M_410 * gravity_M2L_batch_size] = m_a->M_410;
+  M[gravity_M2L_batch_M_500 * gravity_M2L_batch_size] = m_a->M_500;
+#endif
+
+  b->count++;
+}
+
+/**
+ * @brief Computes the interactions left in a #gravity_M2L_batch and adds the
+ * accumulated field tensor to a cell's.
+ *
+ * The caller must hold the lock on the field tensor.
+ *
+ * @param b The #gravity_M2L_batch.
+ * @param l_b The field tensor to add to.
+ */
+INLINE static void gravity_M2L_batch_end(struct gravity_M2L_batch *b,
+                                         struct grav_tensor *l_b) {
+
+  if (b->count > 0) gravity_M2L_batch_compute(b);
+
+  if (b->l.interacted) gravity_field_tensors_add(l_b, &b->l);
+}
+
+#endif /* SWIFT_GRAVITY_M2L_BATCH_H */
@@ -498,4 +498,245 @@ INLINE static void gravity_cache_write_back(const struct gravity_cache *c,
   }
 }
 
+#ifdef SWIFT_GRAVITY_CELL_CACHE
+
+/**
+ * @brief Fill the #gravity_cell_cache of a leaf cell from its #gpart.
+ *
+ * The particles must have been drifted to the current time. The cache holds
+ * the same values (and padding) as gravity_cache_populate() would write in
+ * the input arrays of a #gravity_cache with no shift.
+ *
+ * @param c The leaf #cell.
+ * @param ti_current The current (integer) time.
+ * @param grav_props The global gravity properties.
+ */
+INLINE static void gravity_cell_cache_fill(
+    struct cell *c, const integertime_t ti_current,
+    const struct gravity_props *grav_props) {
+
+  struct gravity_cell_cache *cell_cache = &c->grav.cache;
+  const struct gpart *restrict gparts = c->grav.parts;
+  const int gcount = c->grav.count;
+  const int gcount_padded = gcount - (gcount % VEC_SIZE) + VEC_SIZE;
+
+  gravity_cell_cache_reserve(cell_cache, gcount_padded);
+
+  /* Make the compiler understand we are in happy vectorization land */
+  swift_declare_aligned_ptr(float, x, cell_cache->x, SWIFT_CACHE_ALIGNMENT);
+  swift_declare_aligned_ptr(float, y, cell_cache->y, SWIFT_CACHE_ALIGNMENT);
+  swift_declare_aligned_ptr(float, z, cell_cache->z, SWIFT_CACHE_ALIGNMENT);
+  swift_declare_aligned_ptr(float, epsilon, cell_cache->epsilon,
+                            SWIFT_CACHE_ALIGNMENT);
+  swift_declare_aligned_ptr(float, m, cell_cache->m, SWIFT_CACHE_ALIGNMENT);
+  swift_declare_aligned_ptr(float, old_a, cell_cache->old_a_grav_norm,
+                            SWIFT_CACHE_ALIGNMENT);
+  swift_declare_aligned_ptr(int, time_bin, cell_cache->time_bin,
+                            SWIFT_CACHE_ALIGNMENT);
+  swift_assume_size(gcount_padded, VEC_SIZE);
+
+  for (int i = 0; i < gcount; ++i) {
+    x[i] = (float)gparts[i].x[0];
+    y[i] = (float)gparts[i].x[1];
+    z[i] = (float)gparts[i].x[2];
+    epsilon[i] = gravity_get_softening(&gparts[i], grav_props);
+    old_a[i] = gparts[i].old_a_grav_norm;
+    time_bin[i] = gparts[i].time_bin;
+
+    /* Make a dummy particle out of the inhibted ones */
+    if (gparts[i].time_bin == time_bin_inhibited)
+      m[i] = 0.f;
+    else
+      m[i] = gparts[i].mass;
+  }
+
+  /* Pad the arrays the same way as the caches */
+  const float pos_padded[3] = {-2.f * (float)c->width[0],
+                               -2.f * (float)c->width[1],
+                               -2.f * (float)c->width[2]};
+  const float eps_padded = epsilon[0];
+
+  for (int i = gcount; i < gcount_padded; ++i) {
+    x[i] = pos_padded[0];
+    y[i] = pos_padded[1];
+    z[i] = pos_padded[2];
+    epsilon[i] = eps_padded;
+    old_a[i] = 0.f;
+    m[i] = 0.f;
+    time_bin[i] = time_bin_inhibited;
+  }
+
+  cell_cache->parts = gparts;
+  cell_cache->count = gcount;
+  cell_cache->ti_fill = ti_current;
+}
+
+/**
+ * @brief Is the #gravity_cell_cache of a cell up to date?
+ *
+ * @param c The #cell.
+ * @param ti_current The current (integer) time.
+ */
+INLINE static int gravity_cell_cache_is_valid(const struct cell *c,
+                                              const integertime_t ti_current) {
+
+  const struct gravity_cell_cache *cell_cache = &c->grav.cache;
+  return cell_cache->x != NULL && cell_cache->ti_fill == ti_current &&
+         cell_cache->parts == c->grav.parts &&
+         cell_cache->count == c->grav.count;
+}
+
+/**
+ * @brief Makes sure the #gravity_cell_cache of a leaf cell is up to date.
+ *
+ * The cache is only filled by the first P-P or M-P interaction of a step
+ * involving the cell, and read as is by the following ones. The caller must
+ * hold the lock on the #gpart of the cell.
+ *
+ * @param c The leaf #cell.
+ * @param ti_current The current (integer) time.
+ * @param grav_props The global gravity properties.
+ */
+INLINE static void gravity_cell_cache_prepare(
+    struct cell *c, const integertime_t ti_current,
+    const struct gravity_props *grav_props) {
+
+  if (!gravity_cell_cache_is_valid(c, ti_current))
+    gravity_cell_cache_fill(c, ti_current, grav_props);
+}
+
+/**
+ * @brief Sets up a #gravity_cache reading its inputs straight from the
+ * #gravity_cell_cache of a cell.
+ *
+ * The output arrays, the activity and the M2P flags are the ones of the
+ * runner's cache, which are prepared as gravity_cache_populate() would do.
+ *
+ * @param max_active_bin The largest active bin in the current time-step.
+ * @param view The #gravity_cache to set up.
+ * @param c The runner's #gravity_cache.
+ * @param allow_mpole Are we allowing the use of multipoles?
+ * @param periodic Are we using periodic BCs ?
+ * @param dim The size of the simulation volume along each dimension.
+ * @param cell_cache The #gravity_cell_cache to read from.
+ * @param gcount_padded The number of particle to read padded to the next
+ * multiple of the vector length.
+ * @param CoM The position of the multipole.
+ * @param multipole The mulipole to check for.
+ * @param grav_props The global gravity properties.
+ */
+INLINE static void gravity_cache_populate_from_cell_cache(
+    const timebin_t max_active_bin, struct gravity_cache *view,
+    const struct gravity_cache *c, const int allow_mpole, const int periodic,
+    const float dim[3], const struct gravity_cell_cache *cell_cache,
+    const int gcount_padded, const float CoM[3],
+    const struct gravity_tensors *multipole,
+    const struct gravity_props *grav_props) {
+
+#ifdef SWIFT_DEBUG_CHECKS
+  if (gcount_padded > cell_cache->size)
+    error("Invalid padded cell cache size.");
+  if (c->count < gcount_padded)
+    error("Size of the gravity cache is not large enough.");
+#endif
+
+  *view = *c;
+  view->x = cell_cache->x;
+  view->y = cell_cache->y;
+  view->z = cell_cache->z;
+  view->epsilon = cell_cache->epsilon;
+  view->m = cell_cache->m;
+
+  /* Make the compiler understand we are in happy vectorization land */
+  swift_declare_aligned_ptr(const float, x, cell_cache->x,
+                            SWIFT_CACHE_ALIGNMENT);
+  swift_declare_aligned_ptr(const float, y, cell_cache->y,
+                            SWIFT_CACHE_ALIGNMENT);
+  swift_declare_aligned_ptr(const float, z, cell_cache->z,
+                            SWIFT_CACHE_ALIGNMENT);
+  swift_declare_aligned_ptr(const float, epsilon, cell_cache->epsilon,
+                            SWIFT_CACHE_ALIGNMENT);
+  swift_declare_aligned_ptr(const float, old_a, cell_cache->old_a_grav_norm,
+                            SWIFT_CACHE_ALIGNMENT);
+  swift_declare_aligned_ptr(const int, time_bin, cell_cache->time_bin,
+                            SWIFT_CACHE_ALIGNMENT);
+  swift_declare_aligned_ptr(int, active, view->active, SWIFT_CACHE_ALIGNMENT);
+  swift_declare_aligned_ptr(int, use_mpole, view->use_mpole,
+                            SWIFT_CACHE_ALIGNMENT);
+  swift_assume_size(gcount_padded, VEC_SIZE);
+
+  /* The padded entries are never active */
+  for (int i = 0; i < gcount_padded; ++i)
+    active[i] = (int)(time_bin[i] <= max_active_bin);
+
+  /* Check whether we can use the multipole instead of P-P. The padded
+   * entries can never use it. */
+  for (int i = 0; i < cell_cache->count; ++i) {
+
+    /* Distance to the CoM of the other cell. */
+    float dx = x[i] - CoM[0];
+    float dy = y[i] - CoM[1];
+    float dz = z[i] - CoM[2];
+
+    /* Apply periodic BC */
+    if (periodic) {
+      dx = nearestf(dx, dim[0]);
+      dy = nearestf(dy, dim[1]);
+      dz = nearestf(dz, dim[2]);
+    }
+    const float r2 = dx * dx + dy * dy + dz * dz;
+
+    use_mpole[i] =
+        allow_mpole && gravity_M2P_accept_values(grav_props, epsilon[i],
+                                                 old_a[i], multipole, r2,
+                                                 periodic);
+  }
+  for (int i = cell_cache->count; i < gcount_padded; ++i) use_mpole[i] = 0;
+
+  /* Zero the output as well */
+  gravity_cache_zero_output(view, gcount_padded);
+}
+
+/**
+ * @brief Sets up a #gravity_cache reading its inputs straight from the
+ * #gravity_cell_cache of a cell and make them all use the multi-pole.
+ *
+ * @param max_active_bin The largest active bin in the current time-step.
+ * @param view The #gravity_cache to set up.
+ * @param c The runner's #gravity_cache.
+ * @param cell_cache The #gravity_cell_cache to read from.
+ * @param gcount_padded The number of particle to read padded to the next
+ * multiple of the vector length.
+ */
+INLINE static void gravity_cache_populate_all_mpole_from_cell_cache(
+    const timebin_t max_active_bin, struct gravity_cache *view,
+    const struct gravity_cache *c, const struct gravity_cell_cache *cell_cache,
+    const int gcount_padded) {
+
+#ifdef SWIFT_DEBUG_CHECKS
+  if (gcount_padded > cell_cache->size)
+    error("Invalid padded cell cache size.");
+  if (c->count < gcount_padded)
+    error("Size of the gravity cache is not large enough.");
+#endif
+
+  *view = *c;
+  view->x = cell_cache->x;
+  view->y = cell_cache->y;
+  view->z = cell_cache->z;
+  view->epsilon = cell_cache->epsilon;
+  view->m = cell_cache->m;
+
+  for (int i = 0; i < gcount_padded; ++i)
+    view->active[i] = (int)(cell_cache->time_bin[i] <= max_active_bin);
+  for (int i = 0; i < cell_cache->count; ++i) view->use_mpole[i] = 1;
+  for (int i = cell_cache->count; i < gcount_padded; ++i)
+    view->use_mpole[i] = 0;
+
+  /* Zero the output as well */
+  gravity_cache_zero_output(view, gcount_padded);
+}
+
+#endif /* SWIFT_GRAVITY_CELL_CACHE */
+
 #endif /* SWIFT_GRAVITY_CACHE_H */
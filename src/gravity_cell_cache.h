@@ -0,0 +1,152 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#ifndef SWIFT_GRAVITY_CELL_CACHE_H
+#define SWIFT_GRAVITY_CELL_CACHE_H
+
+/* Config parameters. */
+#include "../config.h"
+
+/* Some standard headers. */
+#include <stddef.h>
+
+/* Local headers */
+#include "align.h"
+#include "error.h"
+#include "inline.h"
+#include "memuse.h"
+#include "timeline.h"
+
+/* Pre-declarations */
+struct gpart;
+
+/**
+ * @brief The inputs of a #gravity_cache kept by a leaf cell for the whole
+ * step.
+ *
+ * The #gpart themselves are not re-organised: this is a lazily filled copy of
+ * what gravity_cache_populate() reads from them (including the padding to the
+ * vector length). It is filled by the first P-P or M-P interaction of a step
+ * involving the cell and re-used as is by the following ones, instead of
+ * re-populating a runner's cache from the #gpart for every interaction.
+ */
+struct gravity_cell_cache {
+
+  /*! #gpart x position. */
+  float *restrict x;
+
+  /*! #gpart y position. */
+  float *restrict y;
+
+  /*! #gpart z position. */
+  float *restrict z;
+
+  /*! #gpart softening length. */
+  float *restrict epsilon;
+
+  /*! #gpart mass (0 for the inhibited ones). */
+  float *restrict m;
+
+  /*! Norm of the #gpart acceleration at the previous step. */
+  float *restrict old_a_grav_norm;
+
+  /*! #gpart time-bin. */
+  int *restrict time_bin;
+
+  /*! The #gpart array the copy was made from. */
+  const struct gpart *parts;
+
+  /*! Number of #gpart in the copy. */
+  int count;
+
+  /*! Allocated length of each array. */
+  int size;
+
+  /*! Time at which the copy was made. */
+  integertime_t ti_fill;
+};
+
+/**
+ * @brief Frees the memory of a #gravity_cell_cache and marks it as out of
+ * date.
+ *
+ * @param cache The #gravity_cell_cache.
+ */
+static INLINE void gravity_cell_cache_free(struct gravity_cell_cache *cache) {
+
+  if (cache->x != NULL) swift_free("gravity_cell_cache", cache->x);
+  cache->x = NULL;
+  cache->y = NULL;
+  cache->z = NULL;
+  cache->epsilon = NULL;
+  cache->m = NULL;
+  cache->old_a_grav_norm = NULL;
+  cache->time_bin = NULL;
+  cache->parts = NULL;
+  cache->count = 0;
+  cache->size = 0;
+  cache->ti_fill = -1;
+}
+
+/**
+ * @brief Makes sure a #gravity_cell_cache can hold a given number of entries.
+ *
+ * All the arrays live in a single block and are aligned on the cache lines.
+ *
+ * @param cache The #gravity_cell_cache.
+ * @param size The number of entries, including the padding.
+ */
+static INLINE void gravity_cell_cache_reserve(struct gravity_cell_cache *cache,
+                                              const int size) {
+
+  if (cache->x != NULL && cache->size >= size) return;
+
+  /* Length of each array, rounded up to a whole number of cache lines */
+  const int per_line = SWIFT_CACHE_ALIGNMENT / sizeof(float);
+  const int stride = ((size + per_line - 1) / per_line) * per_line;
+
+  gravity_cell_cache_free(cache);
+
+  char *block = NULL;
+  if (swift_memalign("gravity_cell_cache", (void **)&block,
+                     SWIFT_CACHE_ALIGNMENT, 7 * stride * sizeof(float)) != 0)
+    error("Couldn't allocate gravity cell cache, size: %d", size);
+
+  const size_t bytes = stride * sizeof(float);
+  cache->x = (float *)(block + 0 * bytes);
+  cache->y = (float *)(block + 1 * bytes);
+  cache->z = (float *)(block + 2 * bytes);
+  cache->epsilon = (float *)(block + 3 * bytes);
+  cache->m = (float *)(block + 4 * bytes);
+  cache->old_a_grav_norm = (float *)(block + 5 * bytes);
+  cache->time_bin = (int *)(block + 6 * bytes);
+  cache->size = stride;
+}
+
+/**
+ * @brief Returns the memory used by a #gravity_cell_cache in bytes.
+ *
+ * @param cache The #gravity_cell_cache.
+ */
+static INLINE size_t
+gravity_cell_cache_memory(const struct gravity_cell_cache *cache) {
+
+  return cache->x == NULL ? 0 : 7 * (size_t)cache->size * sizeof(float);
+}
+
+#endif /* SWIFT_GRAVITY_CELL_CACHE_H */
@@ -40,6 +40,25 @@
 #define gravity_props_default_r_cut_min 0.1f
 #define gravity_props_default_rebuild_frequency 0.01f
 
+/**
+ * @brief Name of the mesh assignment scheme of a given order.
+ *
+ * @param order The order of the scheme (0 if there is no mesh).
+ */
+static const char *gravity_props_mesh_assignment_name(const int order) {
+
+  switch (order) {
+    case 2:
+      return "CIC";
+    case 3:
+      return "TSC";
+    case 4:
+      return "PCS";
+    default:
+      return "None";
+  }
+}
+
 void gravity_props_init(struct gravity_props *p, struct swift_params *params,
                         const struct phys_const *phys_const,
                         const struct cosmology *cosmo, const int with_cosmology,
@@ -59,6 +78,25 @@ void gravity_props_init(struct gravity_props *p, struct swift_params *params,
   /* Tree-PM parameters */
   if (periodic) {
     p->mesh_size = parser_get_param_int(params, "Gravity:mesh_side_length");
+    p->distributed_mesh =
+        parser_get_opt_param_int(params, "Gravity:distributed_mesh", 0);
+
+    char assignment[32] = {0};
+    parser_get_opt_param_string(params, "Gravity:mesh_assignment", assignment,
+                                "CIC");
+    if (strcmp(assignment, "CIC") == 0) {
+      p->mesh_assignment_order = 2;
+    } else if (strcmp(assignment, "TSC") == 0) {
+      p->mesh_assignment_order = 3;
+    } else if (strcmp(assignment, "PCS") == 0) {
+      p->mesh_assignment_order = 4;
+    } else {
+      error(
+          "Invalid choice of mesh assignment scheme: '%s'. Should be 'CIC', "
+          "'TSC' or 'PCS'",
+          assignment);
+    }
+
     p->a_smooth = parser_get_opt_param_float(params, "Gravity:a_smooth",
                                              gravity_props_default_a_smooth);
     p->r_cut_max_ratio = parser_get_opt_param_float(
@@ -79,8 +117,17 @@ void gravity_props_init(struct gravity_props *p, struct swift_params *params,
     if (2. * p->a_smooth * p->r_cut_max_ratio > p->mesh_size)
       error("Mesh too small given r_cut_max. Should be at least %d cells wide.",
             (int)(2. * p->a_smooth * p->r_cut_max_ratio) + 1);
+
+#if defined(WITH_MPI) && !defined(HAVE_MPI_FFTW)
+    if (p->distributed_mesh)
+      error(
+          "Cannot use the distributed mesh without the MPI version of FFTW. "
+          "Re-configure SWIFT with a fftw3_mpi library.");
+#endif
   } else {
     p->mesh_size = 0;
+    p->distributed_mesh = 0;
+    p->mesh_assignment_order = 0;
     p->a_smooth = 0.f;
     p->r_s = FLT_MAX;
     p->r_s_inv = 0.f;
@@ -277,6 +324,12 @@ void gravity_props_print(const struct gravity_props *p) {
       p->epsilon_baryon_max_physical);
 
   message("Self-gravity mesh side-length: N=%d", p->mesh_size);
+#ifdef WITH_MPI
+  message("Self-gravity mesh distributed over the ranks: %s",
+          p->distributed_mesh ? "yes" : "no");
+#endif
+  message("Self-gravity mesh assignment: %s",
+          gravity_props_mesh_assignment_name(p->mesh_assignment_order));
   message("Self-gravity mesh smoothing-scale: a_smooth=%f", p->a_smooth);
 
   message("Self-gravity tree cut-off ratio: r_cut_max=%f", p->r_cut_max_ratio);
@@ -333,6 +386,9 @@ void gravity_props_print_snapshot(hid_t h_grpgrav,
   io_write_attribute_f(h_grpgrav, "Opening angle", p->theta_crit);
   io_write_attribute_s(h_grpgrav, "Scheme", GRAVITY_IMPLEMENTATION);
   io_write_attribute_i(h_grpgrav, "MM order", SELF_GRAVITY_MULTIPOLE_ORDER);
+  io_write_attribute_s(
+      h_grpgrav, "Mesh assignment",
+      gravity_props_mesh_assignment_name(p->mesh_assignment_order));
   io_write_attribute_f(h_grpgrav, "Mesh a_smooth", p->a_smooth);
   io_write_attribute_f(h_grpgrav, "Mesh r_cut_max ratio", p->r_cut_max_ratio);
   io_write_attribute_f(h_grpgrav, "Mesh r_cut_min ratio", p->r_cut_min_ratio);
@@ -105,6 +105,12 @@ struct gravity_props {
   /*! Periodic long-range mesh side-length */
   int mesh_size;
 
+  /*! Are we distributing the mesh over the MPI ranks? */
+  int distributed_mesh;
+
+  /*! Order of the mass assignment to the mesh (2: CIC, 3: TSC, 4: PCS) */
+  int mesh_assignment_order;
+
   /*! Mesh smoothing scale in units of top-level cell size */
   float a_smooth;
 
@@ -33,6 +33,7 @@
  */
 
 #include "adiabatic_index.h"
+#include "cache.h"
 #include "hydro_parameters.h"
 #include "minmax.h"
 
@@ -437,4 +438,350 @@ __attribute__((always_inline)) INLINE static void runner_iact_nonsym_force(
   pi->force.v_sig = max(pi->force.v_sig, v_sig);
 }
 
+#ifdef WITH_MASKED_HYDRO_VECTORIZATION
+
+/**
+ * @brief Vectorised state of particle i in the density loop.
+ */
+struct hydro_vec_pi_density {
+
+  /*! Velocity of particle i */
+  vector vx, vy, vz;
+
+  /*! Inverse smoothing length of particle i */
+  vector h_inv;
+
+  /*! Partial sums of the density loop quantities */
+  vector rho, rho_dh, pressure_bar, pressure_bar_dh, wcount, wcount_dh;
+  vector div_v, rot_vx, rot_vy, rot_vz;
+};
+
+/**
+ * @brief Prepare the vectorised density loop for particle i.
+ *
+ * @param vi The #hydro_vec_pi_density to initialise.
+ * @param pi The #part.
+ * @param a Current scale factor.
+ * @param H Current Hubble parameter.
+ */
+__attribute__((always_inline)) INLINE static void hydro_vec_pi_init_density(
+    struct hydro_vec_pi_density *restrict vi, const struct part *restrict pi,
+    const float a, const float H) {
+
+  vi->vx = vector_set1(pi->v[0]);
+  vi->vy = vector_set1(pi->v[1]);
+  vi->vz = vector_set1(pi->v[2]);
+  vi->h_inv = vector_set1(1.f / pi->h);
+
+  vi->rho = vector_setzero();
+  vi->rho_dh = vector_setzero();
+  vi->pressure_bar = vector_setzero();
+  vi->pressure_bar_dh = vector_setzero();
+  vi->wcount = vector_setzero();
+  vi->wcount_dh = vector_setzero();
+  vi->div_v = vector_setzero();
+  vi->rot_vx = vector_setzero();
+  vi->rot_vy = vector_setzero();
+  vi->rot_vz = vector_setzero();
+}
+
+/**
+ * @brief Density interaction between particle i and one vector of cached
+ * particles (non-symmetric masked vectorized version).
+ *
+ * @param vi The #hydro_vec_pi_density of particle i.
+ * @param r2 Comoving square distances between the particles.
+ * @param dx Comoving separations along x (pi - pj).
+ * @param dy Comoving separations along y (pi - pj).
+ * @param dz Comoving separations along z (pi - pj).
+ * @param cj_cache The #cache containing the particles j.
+ * @param pjd Index of the first particle j in the cache.
+ * @param mask The mask of the particles j to interact with.
+ */
+__attribute__((always_inline)) INLINE static void
+runner_iact_nonsym_vec_density(struct hydro_vec_pi_density *restrict vi,
+                               const vector *r2, const vector *dx,
+                               const vector *dy, const vector *dz,
+                               const struct cache *restrict cj_cache,
+                               const int pjd, const mask_t mask) {
+
+  vector r, r_inv, ui, wi, wi_dx;
+  vector dvx, dvy, dvz, dvdr, faci;
+  vector curlvrx, curlvry, curlvrz, dw, mjuj;
+
+  /* Fill the vectors. */
+  const vector mj = vector_load(&cj_cache->m[pjd]);
+  const vector uj = vector_load(&cj_cache->u[pjd]);
+  const vector vjx = vector_load(&cj_cache->vx[pjd]);
+  const vector vjy = vector_load(&cj_cache->vy[pjd]);
+  const vector vjz = vector_load(&cj_cache->vz[pjd]);
+
+  /* Get the radius and inverse radius. */
+  r.v = vec_sqrt(r2->v);
+  r_inv.v = vec_div(vec_set1(1.f), r.v);
+  ui.v = vec_mul(r.v, vi->h_inv.v);
+
+  /* Calculate the kernel. */
+  kernel_deval_1_vec(&ui, &wi, &wi_dx);
+  dw.v = vec_fma(vec_set1(hydro_dimension), wi.v, vec_mul(ui.v, wi_dx.v));
+  faci.v = vec_mul(mj.v, vec_mul(wi_dx.v, r_inv.v));
+
+  /* Compute dv dot r */
+  dvx.v = vec_sub(vi->vx.v, vjx.v);
+  dvy.v = vec_sub(vi->vy.v, vjy.v);
+  dvz.v = vec_sub(vi->vz.v, vjz.v);
+  dvdr.v = vec_fma(dvx.v, dx->v, vec_fma(dvy.v, dy->v, vec_mul(dvz.v, dz->v)));
+
+  /* Compute dv cross r */
+  curlvrx.v = vec_fnma(dvz.v, dy->v, vec_mul(dvy.v, dz->v));
+  curlvry.v = vec_fnma(dvx.v, dz->v, vec_mul(dvz.v, dx->v));
+  curlvrz.v = vec_fnma(dvy.v, dx->v, vec_mul(dvx.v, dy->v));
+
+  /* Mask updates to the partial sums of particle i. */
+  vi->rho.v = vec_mask_add(vi->rho.v, vec_mul(mj.v, wi.v), mask);
+  vi->rho_dh.v = vec_mask_sub(vi->rho_dh.v, vec_mul(mj.v, dw.v), mask);
+  mjuj.v = vec_mul(mj.v, uj.v);
+  vi->pressure_bar.v =
+      vec_mask_add(vi->pressure_bar.v, vec_mul(mjuj.v, wi.v), mask);
+  vi->pressure_bar_dh.v =
+      vec_mask_sub(vi->pressure_bar_dh.v, vec_mul(mjuj.v, dw.v), mask);
+  vi->wcount.v = vec_mask_add(vi->wcount.v, wi.v, mask);
+  vi->wcount_dh.v = vec_mask_sub(vi->wcount_dh.v, dw.v, mask);
+  vi->div_v.v = vec_mask_sub(vi->div_v.v, vec_mul(faci.v, dvdr.v), mask);
+  vi->rot_vx.v = vec_mask_add(vi->rot_vx.v, vec_mul(faci.v, curlvrx.v), mask);
+  vi->rot_vy.v = vec_mask_add(vi->rot_vy.v, vec_mul(faci.v, curlvry.v), mask);
+  vi->rot_vz.v = vec_mask_add(vi->rot_vz.v, vec_mul(faci.v, curlvrz.v), mask);
+}
+
+/**
+ * @brief Add the partial sums of the vectorised density loop to particle i.
+ *
+ * @param vi The #hydro_vec_pi_density of particle i.
+ * @param pi The #part.
+ */
+__attribute__((always_inline)) INLINE static void hydro_vec_pi_store_density(
+    struct hydro_vec_pi_density *restrict vi, struct part *restrict pi) {
+
+  VEC_HADD(vi->rho, pi->rho);
+  VEC_HADD(vi->rho_dh, pi->density.rho_dh);
+  VEC_HADD(vi->pressure_bar, pi->pressure_bar);
+  VEC_HADD(vi->pressure_bar_dh, pi->density.pressure_bar_dh);
+  VEC_HADD(vi->wcount, pi->density.wcount);
+  VEC_HADD(vi->wcount_dh, pi->density.wcount_dh);
+  VEC_HADD(vi->div_v, pi->density.div_v);
+  VEC_HADD(vi->rot_vx, pi->density.rot_v[0]);
+  VEC_HADD(vi->rot_vy, pi->density.rot_v[1]);
+  VEC_HADD(vi->rot_vz, pi->density.rot_v[2]);
+}
+
+/**
+ * @brief Vectorised state of particle i in the force loop.
+ */
+struct hydro_vec_pi_force {
+
+  /*! Velocity of particle i */
+  vector vx, vy, vz;
+
+  /*! Inverse smoothing length of particle i and its power d+1 */
+  vector h_inv, hid_inv;
+
+  /*! Hydrodynamical properties of particle i */
+  vector miui, rhoi, pressure_inverse_i, ci, fi, balsara_i, ui;
+
+  /*! Cosmological factors entering the equations of motion */
+  vector fac_mu, a2_Hubble;
+
+  /*! Partial sums and maxima of the force loop quantities */
+  vector a_hydro_x, a_hydro_y, a_hydro_z, u_dt, h_dt, v_sig;
+};
+
+/**
+ * @brief Prepare the vectorised force loop for particle i.
+ *
+ * @param vi The #hydro_vec_pi_force to initialise.
+ * @param pi The #part.
+ * @param a Current scale factor.
+ * @param H Current Hubble parameter.
+ */
+__attribute__((always_inline)) INLINE static void hydro_vec_pi_init_force(
+    struct hydro_vec_pi_force *restrict vi, const struct part *restrict pi,
+    const float a, const float H) {
+
+  const float hi_inv = 1.f / pi->h;
+
+  vi->vx = vector_set1(pi->v[0]);
+  vi->vy = vector_set1(pi->v[1]);
+  vi->vz = vector_set1(pi->v[2]);
+  vi->h_inv = vector_set1(hi_inv);
+  vi->hid_inv = vector_set1(pow_dimension_plus_one(hi_inv));
+  vi->miui = vector_set1(pi->mass * pi->u);
+  vi->rhoi = vector_set1(pi->rho);
+  vi->pressure_inverse_i = vector_set1(pi->force.pressure_bar_with_floor /
+                                       (pi->pressure_bar * pi->pressure_bar));
+  vi->ci = vector_set1(pi->force.soundspeed);
+  vi->fi = vector_set1(pi->force.f);
+  vi->balsara_i = vector_set1(pi->force.balsara);
+  vi->ui = vector_set1(pi->u);
+  vi->fac_mu = vector_set1(pow_three_gamma_minus_five_over_two(a));
+  vi->a2_Hubble = vector_set1(a * a * H);
+
+  vi->a_hydro_x = vector_setzero();
+  vi->a_hydro_y = vector_setzero();
+  vi->a_hydro_z = vector_setzero();
+  vi->u_dt = vector_setzero();
+  vi->h_dt = vector_setzero();
+  vi->v_sig = vector_set1(pi->force.v_sig);
+}
+
+/**
+ * @brief Force interaction between particle i and one vector of cached
+ * particles (non-symmetric masked vectorized version).
+ *
+ * @param vi The #hydro_vec_pi_force of particle i.
+ * @param r2 Comoving square distances between the particles.
+ * @param dx Comoving separations along x (pi - pj).
+ * @param dy Comoving separations along y (pi - pj).
+ * @param dz Comoving separations along z (pi - pj).
+ * @param cj_cache The #cache containing the particles j.
+ * @param pjd Index of the first particle j in the cache.
+ * @param mask The mask of the particles j to interact with.
+ */
+__attribute__((always_inline)) INLINE static void runner_iact_nonsym_vec_force(
+    struct hydro_vec_pi_force *restrict vi, const vector *r2, const vector *dx,
+    const vector *dy, const vector *dz, const struct cache *restrict cj_cache,
+    const int pjd, const mask_t mask) {
+
+  vector r, r_inv, xi, xj, wi_dx, wj_dx, wi_dr, wj_dr, hj_inv;
+  vector dvdr, dvdr_Hubble, mu_ij, v_sig, f_ij, f_ji, rho_ij, visc;
+  vector visc_acc_term, uiuj, pressure_inverse_j, f_ij_P_i, f_ji_P_j;
+  vector acc, mj_acc, sph_du_term_i, visc_du_term, du_dt_i;
+
+  /* Fill the vectors, the values used as divisors are set to 1 in the
+   * masked-out lanes to keep them finite. */
+  const vector mj = vector_load_masked(&cj_cache->m[pjd], mask, 1.f);
+  const vector hj = vector_load_masked(&cj_cache->h[pjd], mask, 1.f);
+  const vector rhoj = vector_load_masked(&cj_cache->rho[pjd], mask, 1.f);
+  const vector pressure_bar_j =
+      vector_load_masked(&cj_cache->pressure[pjd], mask, 1.f);
+  const vector pressure_floor_j = vector_load(&cj_cache->pressure_floor[pjd]);
+  const vector cj = vector_load(&cj_cache->soundspeed[pjd]);
+  const vector fj = vector_load(&cj_cache->grad_h[pjd]);
+  const vector balsara_j = vector_load(&cj_cache->balsara[pjd]);
+  const vector uj = vector_load_masked(&cj_cache->u[pjd], mask, 1.f);
+  const vector vjx = vector_load(&cj_cache->vx[pjd]);
+  const vector vjy = vector_load(&cj_cache->vy[pjd]);
+  const vector vjz = vector_load(&cj_cache->vz[pjd]);
+
+  /* Get the radius and inverse radius. */
+  r.v = vec_sqrt(r2->v);
+  r_inv.v = vec_div(vec_set1(1.f), r.v);
+
+  /* Compute gradient terms */
+  f_ij.v = vec_sub(vec_set1(1.f), vec_div(vi->fi.v, vec_mul(mj.v, uj.v)));
+  f_ji.v = vec_sub(vec_set1(1.f), vec_div(fj.v, vi->miui.v));
+
+  /* Get the kernel for hi. */
+  xi.v = vec_mul(r.v, vi->h_inv.v);
+  kernel_eval_dWdx_force_vec(&xi, &wi_dx);
+  wi_dr.v = vec_mul(vi->hid_inv.v, wi_dx.v);
+
+  /* Get the kernel for hj. */
+  hj_inv.v = vec_div(vec_set1(1.f), hj.v);
+  xj.v = vec_mul(r.v, hj_inv.v);
+  kernel_eval_dWdx_force_vec(&xj, &wj_dx);
+  wj_dr.v = vec_mul(pow_dimension_plus_one_vec(hj_inv).v, wj_dx.v);
+
+  /* Compute dv dot r, including the Hubble flow. */
+  dvdr.v = vec_fma(
+      vec_sub(vi->vx.v, vjx.v), dx->v,
+      vec_fma(vec_sub(vi->vy.v, vjy.v), dy->v,
+              vec_mul(vec_sub(vi->vz.v, vjz.v), dz->v)));
+  dvdr_Hubble.v = vec_fma(vi->a2_Hubble.v, r2->v, dvdr.v);
+
+  /* Are the particles moving towards each others ? */
+  mu_ij.v = vec_mul(vi->fac_mu.v,
+                    vec_mul(r_inv.v, vec_fmin(dvdr_Hubble.v, vec_setzero())));
+
+  /* Compute sound speeds and signal velocity */
+  v_sig.v = vec_fnma(vec_set1(const_viscosity_beta), mu_ij.v,
+                     vec_add(vi->ci.v, cj.v));
+
+  /* Construct the full viscosity term */
+  rho_ij.v = vec_mul(vec_set1(0.5f), vec_add(vi->rhoi.v, rhoj.v));
+  visc.v = vec_div(vec_mul(vec_mul(vec_set1(-0.25f), vec_mul(v_sig.v, mu_ij.v)),
+                           vec_add(vi->balsara_i.v, balsara_j.v)),
+                   rho_ij.v);
+
+  /* Convolve with the kernel */
+  visc_acc_term.v = vec_mul(vec_mul(vec_set1(0.5f), visc.v),
+                            vec_mul(vec_add(wi_dr.v, wj_dr.v), r_inv.v));
+
+  /* Compute the ratio of pressures */
+  pressure_inverse_j.v = vec_div(pressure_floor_j.v,
+                                 vec_mul(pressure_bar_j.v, pressure_bar_j.v));
+
+  /* SPH acceleration term */
+  uiuj.v = vec_mul(vec_set1(hydro_gamma_minus_one * hydro_gamma_minus_one),
+                   vec_mul(uj.v, vi->ui.v));
+  f_ij_P_i.v = vec_mul(f_ij.v, vi->pressure_inverse_i.v);
+  f_ji_P_j.v = vec_mul(f_ji.v, pressure_inverse_j.v);
+
+  /* Assemble the acceleration */
+  acc.v = vec_fma(vec_mul(uiuj.v, vec_fma(f_ij_P_i.v, wi_dr.v,
+                                           vec_mul(f_ji_P_j.v, wj_dr.v))),
+                  r_inv.v, visc_acc_term.v);
+  mj_acc.v = vec_mul(mj.v, acc.v);
+
+  /* Use the force Luke ! */
+  vi->a_hydro_x.v =
+      vec_mask_sub(vi->a_hydro_x.v, vec_mul(mj_acc.v, dx->v), mask);
+  vi->a_hydro_y.v =
+      vec_mask_sub(vi->a_hydro_y.v, vec_mul(mj_acc.v, dy->v), mask);
+  vi->a_hydro_z.v =
+      vec_mask_sub(vi->a_hydro_z.v, vec_mul(mj_acc.v, dz->v), mask);
+
+  /* Get the time derivative for u. */
+  sph_du_term_i.v = vec_mul(vec_mul(vec_mul(uiuj.v, f_ij_P_i.v), wi_dr.v),
+                            vec_mul(dvdr.v, r_inv.v));
+
+  /* Viscosity term */
+  visc_du_term.v =
+      vec_mul(vec_mul(vec_set1(0.5f), visc_acc_term.v), dvdr_Hubble.v);
+
+  /* Assemble the energy equation term */
+  du_dt_i.v = vec_add(sph_du_term_i.v, visc_du_term.v);
+
+  /* Internal energy time derivative */
+  vi->u_dt.v = vec_mask_add(vi->u_dt.v, vec_mul(du_dt_i.v, mj.v), mask);
+
+  /* Get the time derivative for h. */
+  vi->h_dt.v = vec_mask_sub(
+      vi->h_dt.v,
+      vec_div(vec_mul(vec_mul(mj.v, dvdr.v), vec_mul(r_inv.v, wi_dr.v)),
+              rhoj.v),
+      mask);
+
+  /* Update the signal velocity. */
+  vi->v_sig.v = vec_blend(mask, vi->v_sig.v, vec_fmax(vi->v_sig.v, v_sig.v));
+}
+
+/**
+ * @brief Add the partial results of the vectorised force loop to particle i.
+ *
+ * @param vi The #hydro_vec_pi_force of particle i.
+ * @param pi The #part.
+ */
+__attribute__((always_inline)) INLINE static void hydro_vec_pi_store_force(
+    struct hydro_vec_pi_force *restrict vi, struct part *restrict pi) {
+
+  VEC_HADD(vi->a_hydro_x, pi->a_hydro[0]);
+  VEC_HADD(vi->a_hydro_y, pi->a_hydro[1]);
+  VEC_HADD(vi->a_hydro_z, pi->a_hydro[2]);
+  VEC_HADD(vi->u_dt, pi->u_dt);
+  VEC_HADD(vi->h_dt, pi->force.h_dt);
+  VEC_HMAX(vi->v_sig, pi->force.v_sig);
+}
+
+#endif /* WITH_MASKED_HYDRO_VECTORIZATION */
+
 #endif /* SWIFT_PRESSURE_ENERGY_HYDRO_IACT_H */
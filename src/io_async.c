@@ -0,0 +1,441 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+/* Config parameters. */
+#include "../config.h"
+
+#if defined(HAVE_HDF5)
+
+/* Some standard headers. */
+#include <hdf5.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* This object's header. */
+#include "io_async.h"
+
+/* Local includes. */
+#include "cosmology.h"
+#include "engine.h"
+#include "error.h"
+#include "memuse.h"
+#include "xmf.h"
+
+/*! State of the asynchronous snapshot writer */
+static struct {
+
+  /*! The thread writing the current snapshot */
+  pthread_t thread;
+
+  /*! Is the thread running? */
+  int running;
+
+  /*! Lock protecting the lists of jobs and the memory counter */
+  pthread_mutex_t lock;
+
+  /*! Signalled when a job is added or completed */
+  pthread_cond_t cond;
+
+  /*! Jobs still to be done, in order */
+  struct io_async_job *first, *last;
+
+  /*! Jobs already done, kept for the XMF description */
+  struct io_async_job *done_first, *done_last;
+
+  /*! Memory (in bytes) reserved for converted data not yet written */
+  size_t bytes_pending;
+
+  /*! Maximal amount of converted data (in bytes) to hold at any time */
+  size_t bytes_max;
+
+  /*! The snapshot being written */
+  struct io_async_snapshot snap;
+
+} io_async = {.lock = PTHREAD_MUTEX_INITIALIZER,
+              .cond = PTHREAD_COND_INITIALIZER};
+
+/**
+ * @brief Writes the XMF description of the snapshot written by the
+ * asynchronous writer, if required, and frees its list of completed jobs.
+ */
+static void io_async_write_xmf(void) {
+
+  const struct io_async_snapshot* snap = &io_async.snap;
+  FILE* xmfFile = NULL;
+
+  if (snap->write_xmf) {
+
+    /* First time, we need to create the XMF file */
+    if (snap->output_count == 0) xmf_create_file(snap->xmfFileName);
+
+    /* Prepare the XMF file for the new entry */
+    xmfFile = xmf_prepare_file(snap->xmfFileName);
+    xmf_write_outputheader(xmfFile, snap->fileName, snap->time);
+  }
+
+  struct io_async_job* job = io_async.done_first;
+  while (job != NULL) {
+    if (xmfFile != NULL) {
+      switch (job->type) {
+        case io_async_file_begin:
+          break;
+        case io_async_group_begin:
+          xmf_write_groupheader(xmfFile, snap->fileName, job->N_total,
+                                job->ptype);
+          break;
+        case io_async_dataset:
+          xmf_write_line(xmfFile, snap->fileName, job->partTypeGroupName,
+                         job->props.name, job->N_total, job->props.dimension,
+                         job->props.type);
+          break;
+        case io_async_group_end:
+          xmf_write_groupfooter(xmfFile, job->ptype);
+          break;
+        case io_async_file_end:
+          /* Also closes the file */
+          xmf_write_outputfooter(xmfFile, snap->output_count, snap->time);
+          break;
+      }
+    }
+
+    struct io_async_job* next = job->next;
+    free(job);
+    job = next;
+  }
+  io_async.done_first = NULL;
+  io_async.done_last = NULL;
+}
+
+/**
+ * @brief Main function of the asynchronous snapshot writer thread.
+ *
+ * Executes the jobs handed over by the snapshot writing functions in order
+ * until the end of the file is reached. The XMF description is only written
+ * once the snapshot file is complete and closed.
+ *
+ * @param arg Unused.
+ */
+static void* io_async_writer(void* arg) {
+
+  while (1) {
+
+    /* Get the next job */
+    pthread_mutex_lock(&io_async.lock);
+    while (io_async.first == NULL)
+      pthread_cond_wait(&io_async.cond, &io_async.lock);
+    struct io_async_job* job = io_async.first;
+    io_async.first = job->next;
+    if (io_async.first == NULL) io_async.last = NULL;
+    pthread_mutex_unlock(&io_async.lock);
+
+    /* Let the snapshot format do its thing */
+    io_async.snap.write_job(job, &io_async.snap);
+
+    if (job->buffer != NULL) {
+      swift_free("writebuff", job->buffer);
+      job->buffer = NULL;
+    }
+
+    /* Release the memory and record the job for the XMF file */
+    pthread_mutex_lock(&io_async.lock);
+    io_async.bytes_pending -= job->size;
+    job->next = NULL;
+    if (io_async.done_last != NULL)
+      io_async.done_last->next = job;
+    else
+      io_async.done_first = job;
+    io_async.done_last = job;
+    pthread_cond_broadcast(&io_async.cond);
+    pthread_mutex_unlock(&io_async.lock);
+
+    if (job->type == io_async_file_end) break;
+  }
+
+  /* Everything is on disk, we can now describe it */
+  io_async_write_xmf();
+
+  return NULL;
+}
+
+/**
+ * @brief Records the description of a new snapshot for the asynchronous
+ * writer.
+ *
+ * @param e The #engine.
+ * @param h_file The snapshot file.
+ * @param fileName The name of the snapshot file.
+ * @param xmfFileName The name of the XMF file, NULL if this rank does not
+ * write it.
+ * @param snapshot_units The #unit_system used in the snapshots.
+ * @param write_job The function executing the jobs in the writer thread.
+ */
+static void io_async_init_snapshot(const struct engine* e, hid_t h_file,
+                                   const char* fileName,
+                                   const char* xmfFileName,
+                                   const struct unit_system* snapshot_units,
+                                   io_async_write_function write_job) {
+
+#ifndef H5_HAVE_THREADSAFE
+  error("Asynchronous snapshots require a thread-safe HDF5 library.");
+#endif
+
+  if (io_async.running)
+    error("The previous snapshot has not been completed!");
+
+  struct io_async_snapshot* snap = &io_async.snap;
+  snap->h_file = h_file;
+  snap->h_grp = 0;
+  strcpy(snap->fileName, fileName);
+  snap->write_xmf = (xmfFileName != NULL);
+  if (xmfFileName != NULL) strcpy(snap->xmfFileName, xmfFileName);
+  snap->output_count = e->snapshot_output_count;
+  snap->time = e->time;
+  snap->a = e->cosmology->a;
+  snap->compression = e->snapshot_compression;
+  snap->snapshot_units = *snapshot_units;
+  snap->write_job = write_job;
+#ifdef WITH_MPI
+  snap->mpi_rank = e->nodeID;
+  snap->mpi_size = e->nr_nodes;
+  snap->comm = MPI_COMM_NULL;
+#endif
+
+  io_async.bytes_pending = 0;
+  io_async.bytes_max = e->snapshot_async_buffer_size;
+}
+
+/**
+ * @brief Starts the writer thread on the snapshot recorded by
+ * io_async_init_snapshot().
+ */
+static void io_async_start(void) {
+
+  if (pthread_create(&io_async.thread, /*attr=*/NULL, io_async_writer,
+                     /*arg=*/NULL) != 0)
+    error("Failed to create the snapshot writer thread.");
+  io_async.running = 1;
+}
+
+/**
+ * @brief Starts the asynchronous writer on a newly created snapshot file.
+ *
+ * The jobs of this snapshot must not communicate with the other ranks.
+ *
+ * @param e The #engine.
+ * @param h_file The snapshot file, with its header and meta-data written.
+ * @param fileName The name of the snapshot file.
+ * @param xmfFileName The name of the XMF file, NULL if this rank does not
+ * write it.
+ * @param snapshot_units The #unit_system used in the snapshots.
+ * @param write_job The function executing the jobs in the writer thread.
+ */
+void io_async_begin(const struct engine* e, hid_t h_file, const char* fileName,
+                    const char* xmfFileName,
+                    const struct unit_system* snapshot_units,
+                    io_async_write_function write_job) {
+
+  io_async_init_snapshot(e, h_file, fileName, xmfFileName, snapshot_units,
+                         write_job);
+  io_async_start();
+}
+
+#ifdef WITH_MPI
+/**
+ * @brief Starts the asynchronous writer on a snapshot written collectively
+ * by all the ranks.
+ *
+ * The writer threads of the different ranks communicate over a duplicate of
+ * the communicator such that they do not interfere with the engine. This
+ * must be called by all the ranks.
+ *
+ * @param e The #engine.
+ * @param h_file The snapshot file, if opened by this rank.
+ * @param fileName The name of the snapshot file.
+ * @param xmfFileName The name of the XMF file, NULL if this rank does not
+ * write it.
+ * @param snapshot_units The #unit_system used in the snapshots.
+ * @param write_job The function executing the jobs in the writer thread.
+ * @param mpi_rank The rank of this node.
+ * @param mpi_size The number of ranks.
+ * @param comm The communicator of the ranks writing the snapshot.
+ */
+void io_async_begin_collective(const struct engine* e, hid_t h_file,
+                               const char* fileName, const char* xmfFileName,
+                               const struct unit_system* snapshot_units,
+                               io_async_write_function write_job, int mpi_rank,
+                               int mpi_size, MPI_Comm comm) {
+
+  io_async_init_snapshot(e, h_file, fileName, xmfFileName, snapshot_units,
+                         write_job);
+
+  struct io_async_snapshot* snap = &io_async.snap;
+  snap->mpi_rank = mpi_rank;
+  snap->mpi_size = mpi_size;
+  if (MPI_Comm_dup(comm, &snap->comm) != MPI_SUCCESS)
+    error("Failed to duplicate the communicator of the snapshot writer.");
+
+  io_async_start();
+}
+#endif
+
+/**
+ * @brief Reserves memory for converted data, waiting for the asynchronous
+ * writer to release enough of it if needed.
+ *
+ * A single request larger than the whole budget is granted once the writer
+ * is idle.
+ *
+ * @param size The number of bytes to reserve.
+ */
+static void io_async_reserve(const size_t size) {
+
+  pthread_mutex_lock(&io_async.lock);
+  while (io_async.bytes_pending > 0 &&
+         io_async.bytes_pending + size > io_async.bytes_max)
+    pthread_cond_wait(&io_async.cond, &io_async.lock);
+  io_async.bytes_pending += size;
+  pthread_mutex_unlock(&io_async.lock);
+}
+
+/**
+ * @brief Creates a new job for the asynchronous writer.
+ *
+ * @param type The type of job.
+ * @param h_grp The particle group the job refers to, if opened by the engine.
+ * @param ptype The particle type of the group.
+ * @param partTypeGroupName The name of the particle group.
+ * @param N The number of particles of the group written by this rank.
+ * @param N_total The number of particles of the group written by all the
+ * ranks.
+ */
+struct io_async_job* io_async_new_job(const enum io_async_job_type type,
+                                      hid_t h_grp, const enum part_type ptype,
+                                      const char* partTypeGroupName,
+                                      const size_t N, const long long N_total) {
+
+  struct io_async_job* job =
+      (struct io_async_job*)calloc(1, sizeof(struct io_async_job));
+  if (job == NULL) error("Unable to allocate snapshot writer job.");
+  job->type = type;
+  job->h_grp = h_grp;
+  job->ptype = ptype;
+  if (partTypeGroupName != NULL)
+    strcpy(job->partTypeGroupName, partTypeGroupName);
+  job->N = N;
+  job->N_total = N_total;
+  return job;
+}
+
+/**
+ * @brief Hands over a job to the asynchronous writer.
+ *
+ * @param job The #io_async_job. Freed by the writer.
+ */
+void io_async_push(struct io_async_job* job) {
+
+  pthread_mutex_lock(&io_async.lock);
+  if (io_async.last != NULL)
+    io_async.last->next = job;
+  else
+    io_async.first = job;
+  io_async.last = job;
+  pthread_cond_broadcast(&io_async.cond);
+  pthread_mutex_unlock(&io_async.lock);
+}
+
+/**
+ * @brief Converts a data array and hands it over to the asynchronous writer.
+ *
+ * The conversion happens immediately, using the engine's threadpool, such
+ * that the particles can be modified as soon as this function returns.
+ *
+ * @todo Move the conversion to the writer as well, from a copy of the
+ * particles staged within the same memory budget. This first requires the
+ * conversion functions to neither follow the links to the other particle
+ * arrays (e.g. p->gpart) nor read the state of the #engine, both of which
+ * change once the simulation carries on.
+ *
+ * @param e The #engine we are writing from.
+ * @param h_grp The group in which to write, if opened by the engine.
+ * @param ptype The type of the particles.
+ * @param partTypeGroupName The name of the group containing the particles in
+ * the HDF5 file.
+ * @param props The #io_props of the field to write.
+ * @param N The number of particles to write from this rank.
+ * @param N_total The number of particles written by all the ranks.
+ * @param offset The offset of this rank's particles in the dataset.
+ * @param lossy_compression The lossy compression scheme to apply.
+ * @param internal_units The #unit_system used internally
+ * @param snapshot_units The #unit_system used in the snapshots
+ */
+void io_async_push_dataset(
+    const struct engine* e, hid_t h_grp, const enum part_type ptype,
+    const char* partTypeGroupName, const struct io_props props, const size_t N,
+    const long long N_total, const long long offset,
+    const enum lossy_compression_schemes lossy_compression,
+    const struct unit_system* internal_units,
+    const struct unit_system* snapshot_units) {
+
+  const size_t size = N * props.dimension * io_sizeof_type(props.type);
+
+  /* Wait until the buffer fits in the memory budget */
+  io_async_reserve(size);
+
+  /* Allocate temporary buffer */
+  void* temp = NULL;
+  if (swift_memalign("writebuff", (void**)&temp, IO_BUFFER_ALIGNMENT, size) !=
+      0)
+    error("Unable to allocate temporary i/o buffer");
+
+  /* Copy the particle data to the temporary buffer */
+  io_copy_temp_buffer(temp, e, props, N, internal_units, snapshot_units);
+
+  /* Hand it over to the writer */
+  struct io_async_job* job = io_async_new_job(io_async_dataset, h_grp, ptype,
+                                              partTypeGroupName, N, N_total);
+  job->offset = offset;
+  job->props = props;
+  job->lossy_compression = lossy_compression;
+  job->buffer = temp;
+  job->size = size;
+  io_async_push(job);
+}
+
+/**
+ * @brief Waits for the asynchronous writer to complete the current snapshot,
+ * if any.
+ *
+ * Over MPI, this must be called by all the ranks.
+ */
+void io_async_wait(void) {
+
+  if (!io_async.running) return;
+
+  if (pthread_join(io_async.thread, /*retval=*/NULL) != 0)
+    error("Failed to join the snapshot writer thread.");
+  io_async.running = 0;
+
+#ifdef WITH_MPI
+  if (io_async.snap.comm != MPI_COMM_NULL) MPI_Comm_free(&io_async.snap.comm);
+#endif
+}
+
+#endif /* HAVE_HDF5 */
@@ -0,0 +1,177 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#ifndef SWIFT_IO_ASYNC_H
+#define SWIFT_IO_ASYNC_H
+
+/* Config parameters. */
+#include "../config.h"
+
+#if defined(HAVE_HDF5)
+
+/* Library header */
+#include <hdf5.h>
+
+#ifdef WITH_MPI
+#include <mpi.h>
+#endif
+
+/* Local includes. */
+#include "common_io.h"
+#include "io_compression.h"
+#include "io_properties.h"
+#include "part_type.h"
+#include "units.h"
+
+struct engine;
+
+/*! Types of work handed over to the asynchronous snapshot writer */
+enum io_async_job_type {
+  io_async_file_begin,
+  io_async_group_begin,
+  io_async_dataset,
+  io_async_group_end,
+  io_async_file_end
+};
+
+/*! A piece of work for the asynchronous snapshot writer */
+struct io_async_job {
+
+  /*! What to do */
+  enum io_async_job_type type;
+
+  /*! The particle group in the file, if opened by the engine */
+  hid_t h_grp;
+
+  /*! The particle type of the group */
+  enum part_type ptype;
+
+  /*! Name of the particle group in the file */
+  char partTypeGroupName[PARTICLE_GROUP_BUFFER_SIZE];
+
+  /*! Number of particles of the group written by this rank */
+  size_t N;
+
+  /*! Number of particles of the group written by all the ranks */
+  long long N_total;
+
+  /*! Offset of this rank's particles in the datasets of the group */
+  long long offset;
+
+  /*! The field to write (datasets only) */
+  struct io_props props;
+
+  /*! The lossy compression scheme to apply (datasets only) */
+  enum lossy_compression_schemes lossy_compression;
+
+  /*! Number of fields written in the group (group ends only) */
+  int num_fields;
+
+  /*! The converted data (datasets only) */
+  void* buffer;
+
+  /*! Size of the converted data in bytes */
+  size_t size;
+
+  /*! Next job in the list */
+  struct io_async_job* next;
+};
+
+struct io_async_snapshot;
+
+/*! Function executing the jobs of a given snapshot format in the writer */
+typedef void (*io_async_write_function)(struct io_async_job* job,
+                                        struct io_async_snapshot* snap);
+
+/*! The snapshot being written by the asynchronous writer */
+struct io_async_snapshot {
+
+  /*! The snapshot file */
+  hid_t h_file;
+
+  /*! The particle group currently opened by the writer, if any */
+  hid_t h_grp;
+
+  /*! Name of the snapshot file */
+  char fileName[FILENAME_BUFFER_SIZE];
+
+  /*! Name of the XMF file */
+  char xmfFileName[FILENAME_BUFFER_SIZE];
+
+  /*! Does the writer update the XMF file once the snapshot is complete? */
+  int write_xmf;
+
+  /*! Number of this snapshot */
+  int output_count;
+
+  /*! Time of this snapshot */
+  double time;
+
+  /*! The scale-factor at the time of this snapshot */
+  double a;
+
+  /*! Level of GZIP compression */
+  int compression;
+
+  /*! The #unit_system used in the snapshots */
+  struct unit_system snapshot_units;
+
+#ifdef WITH_MPI
+  /*! The rank of this node */
+  int mpi_rank;
+
+  /*! The number of ranks */
+  int mpi_size;
+
+  /*! Communicator reserved to the writer, MPI_COMM_NULL if none */
+  MPI_Comm comm;
+#endif
+
+  /*! The function executing the jobs in the writer thread */
+  io_async_write_function write_job;
+};
+
+void io_async_begin(const struct engine* e, hid_t h_file, const char* fileName,
+                    const char* xmfFileName,
+                    const struct unit_system* snapshot_units,
+                    io_async_write_function write_job);
+#ifdef WITH_MPI
+void io_async_begin_collective(const struct engine* e, hid_t h_file,
+                               const char* fileName, const char* xmfFileName,
+                               const struct unit_system* snapshot_units,
+                               io_async_write_function write_job, int mpi_rank,
+                               int mpi_size, MPI_Comm comm);
+#endif
+
+struct io_async_job* io_async_new_job(const enum io_async_job_type type,
+                                      hid_t h_grp, const enum part_type ptype,
+                                      const char* partTypeGroupName,
+                                      const size_t N, const long long N_total);
+void io_async_push(struct io_async_job* job);
+void io_async_push_dataset(
+    const struct engine* e, hid_t h_grp, const enum part_type ptype,
+    const char* partTypeGroupName, const struct io_props props, const size_t N,
+    const long long N_total, const long long offset,
+    const enum lossy_compression_schemes lossy_compression,
+    const struct unit_system* internal_units,
+    const struct unit_system* snapshot_units);
+void io_async_wait(void);
+
+#endif /* HAVE_HDF5 */
+
+#endif /* SWIFT_IO_ASYNC_H */
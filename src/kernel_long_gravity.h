@@ -26,6 +26,7 @@
 #include "const.h"
 #include "exp.h"
 #include "inline.h"
+#include "minmax.h"
 
 /* Standard headers */
 #include <float.h>
@@ -33,7 +34,11 @@
 
 #define GADGET2_LONG_RANGE_CORRECTION
 
-#ifdef GADGET2_LONG_RANGE_CORRECTION
+#if defined(GADGET2_LONG_RANGE_CORRECTION) && \
+    defined(GRAVITY_USE_TABULATED_LONG_RANGE_MATH)
+#define kernel_long_gravity_truncation_name \
+  "Gadget-like (using erfc(), tabulated)"
+#elif defined(GADGET2_LONG_RANGE_CORRECTION)
 #define kernel_long_gravity_truncation_name "Gadget-like (using erfc())"
 #else
 #define kernel_long_gravity_truncation_name "Exp-based Sigmoid"
@@ -186,6 +191,104 @@ kernel_long_grav_derivatives(const float r, const float r_s_inv,
 #endif
 }
 
+#ifdef GADGET2_LONG_RANGE_CORRECTION
+
+/* Tabulated truncation of the P2P interactions */
+
+/*! Degree of the polynomials of the tabulated truncation */
+#define kernel_long_grav_degree 10
+
+/*! Range of r/r_s covered by the polynomials. The truncation is set to 0
+ * beyond, where it is below 6e-7 */
+#define kernel_long_grav_u_max 8.f
+
+/*! Width in r/r_s of each of the two polynomials */
+#define kernel_long_grav_width (0.5f * kernel_long_grav_u_max)
+
+/**
+ * @brief Coefficients of the polynomials approximating the force truncation
+ * over [0, u_max / 2[ and [u_max / 2, u_max[, highest degree first.
+ *
+ * Least-squares fits at Chebyshev nodes of
+ * \f$\mathrm{erfc}(u/2) + \frac{u}{\sqrt{\pi}}\exp(-u^2/4)\f$ as a function of
+ * the position \f$s \in [-1, 1[\f$ within each interval. The absolute error
+ * is below 1e-6 and the relative error below 2e-5 over [0, 5].
+ */
+static const float kernel_long_grav_coeffs_f[2 * (kernel_long_grav_degree + 1)]
+    __attribute__((aligned(16))) = {
+        7.248888258e-03f,  -5.008985288e-03f, -4.548917711e-02f,
+        5.431306735e-02f,  1.266956031e-01f,  -2.496478111e-01f,
+        -1.378089488e-01f, 5.535690784e-01f,  -4.724680912e-05f,
+        -8.302192688e-01f, 5.724073648e-01f, /* 0 < u < 4 */
+        -9.919123841e-05f, 5.112452200e-04f,  -6.985160871e-04f,
+        -8.011265891e-04f, 4.579207394e-03f,  -9.262388572e-03f,
+        1.209927350e-02f,  -1.094629336e-02f, 6.685492117e-03f,
+        -2.506983466e-03f, 4.398309975e-04f}; /* 4 < u < 8 */
+
+/**
+ * @brief Coefficients of the polynomials approximating the potential
+ * truncation \f$\mathrm{erfc}(u/2)\f$ over the same intervals.
+ *
+ * The absolute error is below 3e-7 and the relative error below 3e-5 over
+ * [0, 5].
+ */
+static const float
+    kernel_long_grav_coeffs_pot[2 * (kernel_long_grav_degree + 1)]
+    __attribute__((aligned(16))) = {
+        -7.441815687e-04f, 1.590803498e-03f,  4.275946412e-03f,
+        -1.484531537e-02f, -4.362739157e-03f, 6.904650480e-02f,
+        -6.924167275e-02f, -1.383442581e-01f, 4.151123166e-01f,
+        -4.151087403e-01f, 1.572991461e-01f, /* 0 < u < 4 */
+        -2.211729043e-05f, 1.413752943e-05f,  1.411225967e-04f,
+        -4.179115640e-04f, 7.350007072e-04f,  -1.004759688e-03f,
+        1.045075478e-03f,  -7.911855937e-04f, 4.177030642e-04f,
+        -1.391495025e-04f, 2.209125705e-05f}; /* 4 < u < 8 */
+
+/**
+ * @brief Computes the long-range correction terms for the potential and
+ * force calculations due to the mesh truncation using the tabulated
+ * polynomials.
+ *
+ * The polynomial is picked with a select rather than a table look-up such
+ * that vectorised loops over the particles do not need gathers. The relative
+ * accuracy is 2e-5 for both terms over the range [0, 5] of r_over_r_s.
+ *
+ * @param r_over_r_s The ratio of the distance to the FFT cell scale \f$u =
+ * r/r_s\f$.
+ * @param corr_f (return) The correction for the force term.
+ * @param corr_pot (return) The correction for the potential term.
+ */
+__attribute__((always_inline, nonnull)) INLINE static void
+kernel_long_grav_eval_table(const float r_over_r_s, float *restrict corr_f,
+                            float *restrict corr_pot) {
+
+  /* Pick the interval and go to [-1, 1[ within it */
+  const int second = r_over_r_s >= kernel_long_grav_width;
+  const float u = min(r_over_r_s, kernel_long_grav_u_max);
+  const float s = u * (2.f / kernel_long_grav_width) - (second ? 3.f : 1.f);
+
+  /* First term of the polynomials ... */
+  const int offset = kernel_long_grav_degree + 1;
+  float w_f = second ? kernel_long_grav_coeffs_f[offset]
+                     : kernel_long_grav_coeffs_f[0];
+  float w_pot = second ? kernel_long_grav_coeffs_pot[offset]
+                       : kernel_long_grav_coeffs_pot[0];
+
+  /* ... and the rest of them */
+  for (int k = 1; k <= kernel_long_grav_degree; k++) {
+    w_f = w_f * s + (second ? kernel_long_grav_coeffs_f[offset + k]
+                            : kernel_long_grav_coeffs_f[k]);
+    w_pot = w_pot * s + (second ? kernel_long_grav_coeffs_pot[offset + k]
+                                : kernel_long_grav_coeffs_pot[k]);
+  }
+
+  /* Nothing left beyond the range of the polynomials */
+  const int inside = r_over_r_s < kernel_long_grav_u_max;
+  *corr_f = inside ? w_f : 0.f;
+  *corr_pot = inside ? w_pot : 0.f;
+}
+#endif /* GADGET2_LONG_RANGE_CORRECTION */
+
 /**
  * @brief Computes the long-range correction terms for the potential and
  * force calculations due to the mesh truncation.
@@ -204,7 +307,12 @@ __attribute__((always_inline, nonnull)) INLINE static void
 kernel_long_grav_eval(const float r_over_r_s, float *restrict corr_f,
                       float *restrict corr_pot) {
 
-#ifdef GADGET2_LONG_RANGE_CORRECTION
+#if defined(GADGET2_LONG_RANGE_CORRECTION) && \
+    defined(GRAVITY_USE_TABULATED_LONG_RANGE_MATH)
+
+  kernel_long_grav_eval_table(r_over_r_s, corr_f, corr_pot);
+
+#elif defined(GADGET2_LONG_RANGE_CORRECTION)
 
   const float two_over_sqrt_pi = ((float)M_2_SQRTPI);
 
@@ -24,6 +24,10 @@
 #include <fftw3.h>
 #endif
 
+#if defined(WITH_MPI) && defined(HAVE_MPI_FFTW)
+#include <fftw3-mpi.h>
+#endif
+
 /* This object's header. */
 #include "mesh_gravity.h"
 
@@ -34,6 +38,8 @@
 #include "error.h"
 #include "gravity_properties.h"
 #include "kernel_long_gravity.h"
+#include "mesh_gravity_mpi.h"
+#include "mesh_gravity_patch.h"
 #include "part.h"
 #include "restart.h"
 #include "runner.h"
@@ -60,143 +66,82 @@ __attribute__((always_inline, const)) INLINE static int row_major_id_periodic(
 }
 
 /**
- * @brief Interpolate values from a the mesh using CIC.
- *
- * @param mesh The mesh to read from.
- * @param i The index of the cell along x
- * @param j The index of the cell along y
- * @param k The index of the cell along z
- * @param tx First CIC coefficient along x
- * @param ty First CIC coefficient along y
- * @param tz First CIC coefficient along z
- * @param dx Second CIC coefficient along x
- * @param dy Second CIC coefficient along y
- * @param dz Second CIC coefficient along z
+ * @brief Interpolate values from the local copy of the mesh around a particle
+ * using the weights of the assignment scheme.
+ *
+ * @param phi The local copy of the mesh.
+ * @param i The index in phi of the first cell of the stencil along x.
+ * @param j The index in phi of the first cell of the stencil along y.
+ * @param k The index in phi of the first cell of the stencil along z.
+ * @param wx The weights of the scheme along x.
+ * @param wy The weights of the scheme along y.
+ * @param wz The weights of the scheme along z.
+ * @param order The order of the scheme (2: CIC, 3: TSC, 4: PCS).
  */
-__attribute__((always_inline, const)) INLINE static double CIC_get(
-    double mesh[6][6][6], const int i, const int j, const int k,
-    const double tx, const double ty, const double tz, const double dx,
-    const double dy, const double dz) {
-
-  double temp;
-  temp = mesh[i + 0][j + 0][k + 0] * tx * ty * tz;
-  temp += mesh[i + 0][j + 0][k + 1] * tx * ty * dz;
-  temp += mesh[i + 0][j + 1][k + 0] * tx * dy * tz;
-  temp += mesh[i + 0][j + 1][k + 1] * tx * dy * dz;
-  temp += mesh[i + 1][j + 0][k + 0] * dx * ty * tz;
-  temp += mesh[i + 1][j + 0][k + 1] * dx * ty * dz;
-  temp += mesh[i + 1][j + 1][k + 0] * dx * dy * tz;
-  temp += mesh[i + 1][j + 1][k + 1] * dx * dy * dz;
+__attribute__((always_inline)) INLINE static double mesh_stencil_get(
+    double phi[pm_mesh_interpolation_max_size][pm_mesh_interpolation_max_size]
+              [pm_mesh_interpolation_max_size],
+    const int i, const int j, const int k, const double* wx, const double* wy,
+    const double* wz, const int order) {
+
+  double temp = 0.;
+  for (int ii = 0; ii < order; ++ii) {
+    for (int jj = 0; jj < order; ++jj) {
+      double temp_z = 0.;
+      for (int kk = 0; kk < order; ++kk)
+        temp_z += phi[i + ii][j + jj][k + kk] * wz[kk];
+      temp += temp_z * wx[ii] * wy[jj];
+    }
+  }
 
   return temp;
 }
 
 /**
- * @brief Interpolate a value to a mesh using CIC.
- *
- * @param mesh The mesh to write to
- * @param N The side-length of the mesh
- * @param i The index of the cell along x
- * @param j The index of the cell along y
- * @param k The index of the cell along z
- * @param tx First CIC coefficient along x
- * @param ty First CIC coefficient along y
- * @param tz First CIC coefficient along z
- * @param dx Second CIC coefficient along x
- * @param dy Second CIC coefficient along y
- * @param dz Second CIC coefficient along z
- * @param value The value to interpolate.
- */
-__attribute__((always_inline)) INLINE static void CIC_set(
-    double* mesh, const int N, const int i, const int j, const int k,
-    const double tx, const double ty, const double tz, const double dx,
-    const double dy, const double dz, const double value) {
-
-  /* Classic CIC interpolation */
-  atomic_add_d(&mesh[row_major_id_periodic(i + 0, j + 0, k + 0, N)],
-               value * tx * ty * tz);
-  atomic_add_d(&mesh[row_major_id_periodic(i + 0, j + 0, k + 1, N)],
-               value * tx * ty * dz);
-  atomic_add_d(&mesh[row_major_id_periodic(i + 0, j + 1, k + 0, N)],
-               value * tx * dy * tz);
-  atomic_add_d(&mesh[row_major_id_periodic(i + 0, j + 1, k + 1, N)],
-               value * tx * dy * dz);
-  atomic_add_d(&mesh[row_major_id_periodic(i + 1, j + 0, k + 0, N)],
-               value * dx * ty * tz);
-  atomic_add_d(&mesh[row_major_id_periodic(i + 1, j + 0, k + 1, N)],
-               value * dx * ty * dz);
-  atomic_add_d(&mesh[row_major_id_periodic(i + 1, j + 1, k + 0, N)],
-               value * dx * dy * tz);
-  atomic_add_d(&mesh[row_major_id_periodic(i + 1, j + 1, k + 1, N)],
-               value * dx * dy * dz);
-}
-
-/**
- * @brief Assigns a given #gpart to a density mesh using the CIC method.
+ * @brief Assigns a given #gpart to a density mesh shared by all the threads.
+ *
+ * Only used when there is no cell structure. Otherwise, the #gpart of each
+ * top-level cell are assigned to a private #pm_mesh_patch.
  *
  * @param gp The #gpart.
  * @param rho The density mesh.
  * @param N the size of the mesh along one axis.
  * @param fac The width of a mesh cell.
  * @param dim The dimensions of the simulation box.
+ * @param order The order of the assignment scheme.
  */
-INLINE static void gpart_to_mesh_CIC(const struct gpart* gp, double* rho,
-                                     const int N, const double fac,
-                                     const double dim[3]) {
+INLINE static void gpart_to_mesh(const struct gpart* gp, double* rho,
+                                 const int N, const double fac,
+                                 const double dim[3], const int order) {
 
   /* Box wrap the multipole's position */
   const double pos_x = box_wrap(gp->x[0], 0., dim[0]);
   const double pos_y = box_wrap(gp->x[1], 0., dim[1]);
   const double pos_z = box_wrap(gp->x[2], 0., dim[2]);
 
-  /* Workout the CIC coefficients */
-  int i = (int)(fac * pos_x);
-  if (i >= N) i = N - 1;
-  const double dx = fac * pos_x - i;
-  const double tx = 1. - dx;
-
-  int j = (int)(fac * pos_y);
-  if (j >= N) j = N - 1;
-  const double dy = fac * pos_y - j;
-  const double ty = 1. - dy;
-
-  int k = (int)(fac * pos_z);
-  if (k >= N) k = N - 1;
-  const double dz = fac * pos_z - k;
-  const double tz = 1. - dz;
+  /* Workout the assignment weights */
+  double wx[pm_mesh_assignment_max_order];
+  double wy[pm_mesh_assignment_max_order];
+  double wz[pm_mesh_assignment_max_order];
+  const int i = pm_mesh_assignment_weights(order, fac * pos_x, wx);
+  const int j = pm_mesh_assignment_weights(order, fac * pos_y, wy);
+  const int k = pm_mesh_assignment_weights(order, fac * pos_z, wz);
 
 #ifdef SWIFT_DEBUG_CHECKS
-  if (i < 0 || i >= N) error("Invalid gpart position in x");
-  if (j < 0 || j >= N) error("Invalid gpart position in y");
-  if (k < 0 || k >= N) error("Invalid gpart position in z");
+  if (i < -1 || i > N) error("Invalid gpart position in x");
+  if (j < -1 || j > N) error("Invalid gpart position in y");
+  if (k < -1 || k > N) error("Invalid gpart position in z");
 #endif
 
   const double mass = gp->mass;
 
-  /* CIC ! */
-  CIC_set(rho, N, i, j, k, tx, ty, tz, dx, dy, dz, mass);
-}
-
-/**
- * @brief Assigns all the #gpart of a #cell to a density mesh using the CIC
- * method.
- *
- * @param c The #cell.
- * @param rho The density mesh.
- * @param N the size of the mesh along one axis.
- * @param fac The width of a mesh cell.
- * @param dim The dimensions of the simulation box.
- */
-void cell_gpart_to_mesh_CIC(const struct cell* c, double* rho, const int N,
-                            const double fac, const double dim[3]) {
-
-  const int gcount = c->grav.count;
-  const struct gpart* gparts = c->grav.parts;
-
-  /* Assign all the gpart of that cell to the mesh */
-  for (int i = 0; i < gcount; ++i) {
-    if (gparts[i].time_bin == time_bin_inhibited) continue;
-    gpart_to_mesh_CIC(&gparts[i], rho, N, fac, dim);
+  for (int ii = 0; ii < order; ++ii) {
+    for (int jj = 0; jj < order; ++jj) {
+      const double mxy = mass * wx[ii] * wy[jj];
+      for (int kk = 0; kk < order; ++kk)
+        atomic_add_d(&rho[row_major_id_periodic(i + ii, j + jj, k + kk, N)],
+                     mxy * wz[kk]);
+    }
   }
 }
 
@@ -206,19 +151,32 @@ void cell_gpart_to_mesh_CIC(const struct cell* c, double* rho, const int N,
  */
 struct cic_mapper_data {
   const struct cell* cells;
+  const int* local_cells;
+  struct pm_mesh_patch* patches;
+  int nr_patches;
   double* rho;
   double* potential;
   int N;
+  int order;
   double fac;
   double dim[3];
   float const_G;
 };
 
-void gpart_to_mesh_CIC_mapper(void* map_data, int num, void* extra) {
+/**
+ * @brief Threadpool mapper function for the mesh assignment of a chunk of
+ * #gpart.
+ *
+ * @param map_data A chunk of the #gpart array.
+ * @param num The number of #gpart in the chunk.
+ * @param extra The information about the mesh.
+ */
+void gpart_to_mesh_mapper(void* map_data, int num, void* extra) {
 
   const struct cic_mapper_data* data = (struct cic_mapper_data*)extra;
   double* rho = data->rho;
   const int N = data->N;
+  const int order = data->order;
   const double fac = data->fac;
   const double dim[3] = {data->dim[0], data->dim[1], data->dim[2]};
 
@@ -227,49 +185,172 @@ void gpart_to_mesh_CIC_mapper(void* map_data, int num, void* extra) {
 
   for (int i = 0; i < num; ++i) {
     if (gparts[i].time_bin == time_bin_inhibited) continue;
-    gpart_to_mesh_CIC(&gparts[i], rho, N, fac, dim);
+    gpart_to_mesh(&gparts[i], rho, N, fac, dim, order);
   }
 }
 
 /**
- * @brief Threadpool mapper function for the mesh CIC assignment of a cell.
+ * @brief Threadpool mapper function assigning the #gpart of each local
+ * top-level cell to its own private #pm_mesh_patch.
  *
  * @param map_data A chunk of the list of local cells.
  * @param num The number of cells in the chunk.
  * @param extra The information about the mesh and cells.
  */
-void cell_gpart_to_mesh_CIC_mapper(void* map_data, int num, void* extra) {
+void cell_gpart_to_mesh_patch_mapper(void* map_data, int num, void* extra) {
 
   /* Unpack the shared information */
   const struct cic_mapper_data* data = (struct cic_mapper_data*)extra;
   const struct cell* cells = data->cells;
+
+  /* Pointer to the chunk to be processed */
+  const int* local_cells = (const int*)map_data;
+  const size_t offset = local_cells - data->local_cells;
+
+  /* Loop over the elements assigned to this thread */
+  for (int n = 0; n < num; ++n) {
+    const struct cell* c = &cells[local_cells[n]];
+    pm_mesh_patch_assign_cell(&data->patches[offset + n], c, data->N,
+                              data->fac, data->order);
+  }
+}
+
+/**
+ * @brief Threadpool mapper function adding the #pm_mesh_patch to the density
+ * mesh.
+ *
+ * Each call owns a range of slices of the mesh along x and adds the parts of
+ * all the patches falling in it, so no atomics are needed.
+ *
+ * @param map_data The first slice of the range.
+ * @param num The number of slices in the range.
+ * @param extra The information about the mesh and patches.
+ */
+void mesh_patches_to_mesh_mapper(void* map_data, int num, void* extra) {
+
+  /* Unpack the shared information */
+  const struct cic_mapper_data* data = (struct cic_mapper_data*)extra;
   double* rho = data->rho;
   const int N = data->N;
-  const double fac = data->fac;
-  const double dim[3] = {data->dim[0], data->dim[1], data->dim[2]};
 
-  /* Pointer to the chunk to be processed */
-  int* local_cells = (int*)map_data;
+  /* Range of slices handled by this call */
+  const int i_start = ((double*)map_data - rho) / ((size_t)N * N);
+  const int i_end = i_start + num;
 
-  // MATTHIEU: This could in principle be improved by creating a local mesh
-  //           with just the extent required for the cell. Assignment can
-  //           then be done without atomics. That local mesh is then added
-  //           atomically to the global one.
+  for (int n = 0; n < data->nr_patches; ++n) {
 
-  /* Loop over the elements assigned to this thread */
-  for (int i = 0; i < num; ++i) {
+    const struct pm_mesh_patch* patch = &data->patches[n];
+    if (patch->volume == 0) continue;
 
-    /* Pointer to local cell */
-    const struct cell* c = &cells[local_cells[i]];
+    const int* size = patch->mesh_size;
+    const int k_first = ((patch->mesh_min[2] % N) + N) % N;
 
-    /* Assign this cell's content to the mesh */
-    cell_gpart_to_mesh_CIC(c, rho, N, fac, dim);
+    for (int ii = 0; ii < size[0]; ++ii) {
+
+      /* Is that slice of the patch in our range? */
+      const int i = ((patch->mesh_min[0] + ii) % N + N) % N;
+      if (i < i_start || i >= i_end) continue;
+
+      for (int jj = 0; jj < size[1]; ++jj) {
+
+        const int j = ((patch->mesh_min[1] + jj) % N + N) % N;
+        const double* patch_row =
+            &patch->mesh[((size_t)ii * size[1] + jj) * size[2]];
+        double* row = &rho[((size_t)i * N + j) * N];
+
+        /* Add the row along z, wrapping it */
+        int k = k_first;
+        for (int kk = 0; kk < size[2]; ++kk) {
+          row[k] += patch_row[kk];
+          if (++k == N) k = 0;
+        }
+      }
+    }
   }
 }
 
 /**
- * @brief Computes the potential on a gpart from a given mesh using the CIC
- * method.
+ * @brief Computes the potential and accelerations on a gpart from the local
+ * copy of the mesh surrounding it.
+ *
+ * The interpolation uses the same scheme as the mass assignment. The local
+ * copy starts 2 cells below the first cell of the stencil along each axis to
+ * accommodate the 5-point gradient.
+ *
+ * @param gp The #gpart.
+ * @param phi The local copy of the potential mesh around the particle.
+ * @param wx The weights of the scheme along x.
+ * @param wy The weights of the scheme along y.
+ * @param wz The weights of the scheme along z.
+ * @param order The order of the scheme (2: CIC, 3: TSC, 4: PCS).
+ * @param fac width of a mesh cell.
+ */
+INLINE static void mesh_stencil_to_gpart(
+    struct gpart* gp,
+    double phi[pm_mesh_interpolation_max_size][pm_mesh_interpolation_max_size]
+              [pm_mesh_interpolation_max_size],
+    const double* wx, const double* wy, const double* wz, const int order,
+    const double fac) {
+
+#ifdef SWIFT_GRAVITY_FORCE_CHECKS
+  if (gp->a_grav_mesh[0] != 0.) error("Particle with non-initalised stuff");
+#ifndef SWIFT_GRAVITY_NO_POTENTIAL
+  if (gp->potential_mesh != 0.) error("Particle with non-initalised stuff");
+#endif
+#endif
+
+  /* Some local accumulators */
+  double p = 0.;
+  double a[3] = {0.};
+
+  /* Indices of the first cell of the stencil in the local copy of the mesh */
+  const int ii = 2, jj = 2, kk = 2;
+
+  /* Interpolation of the potential itself */
+  p += mesh_stencil_get(phi, ii, jj, kk, wx, wy, wz, order);
+
+  /* ---- */
+
+  /* 5-point stencil along each axis for the accelerations */
+  a[0] += (1. / 12.) *
+          mesh_stencil_get(phi, ii + 2, jj, kk, wx, wy, wz, order);
+  a[0] -= (2. / 3.) *
+          mesh_stencil_get(phi, ii + 1, jj, kk, wx, wy, wz, order);
+  a[0] += (2. / 3.) *
+          mesh_stencil_get(phi, ii - 1, jj, kk, wx, wy, wz, order);
+  a[0] -= (1. / 12.) *
+          mesh_stencil_get(phi, ii - 2, jj, kk, wx, wy, wz, order);
+
+  a[1] += (1. / 12.) *
+          mesh_stencil_get(phi, ii, jj + 2, kk, wx, wy, wz, order);
+  a[1] -= (2. / 3.) *
+          mesh_stencil_get(phi, ii, jj + 1, kk, wx, wy, wz, order);
+  a[1] += (2. / 3.) *
+          mesh_stencil_get(phi, ii, jj - 1, kk, wx, wy, wz, order);
+  a[1] -= (1. / 12.) *
+          mesh_stencil_get(phi, ii, jj - 2, kk, wx, wy, wz, order);
+
+  a[2] += (1. / 12.) *
+          mesh_stencil_get(phi, ii, jj, kk + 2, wx, wy, wz, order);
+  a[2] -= (2. / 3.) *
+          mesh_stencil_get(phi, ii, jj, kk + 1, wx, wy, wz, order);
+  a[2] += (2. / 3.) *
+          mesh_stencil_get(phi, ii, jj, kk - 1, wx, wy, wz, order);
+  a[2] -= (1. / 12.) *
+          mesh_stencil_get(phi, ii, jj, kk - 2, wx, wy, wz, order);
+
+  /* ---- */
+
+  /* Store things back */
+  gp->a_grav_mesh[0] = fac * a[0];
+  gp->a_grav_mesh[1] = fac * a[1];
+  gp->a_grav_mesh[2] = fac * a[2];
+  gravity_add_comoving_mesh_potential(gp, p);
+}
+
+/**
+ * @brief Computes the potential on a gpart from a given mesh using the
+ * assignment scheme.
  *
  * Debugging routine.
  *
@@ -278,100 +359,134 @@ void cell_gpart_to_mesh_CIC_mapper(void* map_data, int num, void* extra) {
  * @param N the size of the mesh along one axis.
  * @param fac width of a mesh cell.
  * @param dim The dimensions of the simulation box.
+ * @param order The order of the scheme (2: CIC, 3: TSC, 4: PCS).
  */
-void mesh_to_gpart_CIC(struct gpart* gp, const double* pot, const int N,
-                       const double fac, const double dim[3]) {
+void mesh_to_gpart(struct gpart* gp, const double* pot, const int N,
+                   const double fac, const double dim[3], const int order) {
 
   /* Box wrap the gpart's position */
   const double pos_x = box_wrap(gp->x[0], 0., dim[0]);
   const double pos_y = box_wrap(gp->x[1], 0., dim[1]);
   const double pos_z = box_wrap(gp->x[2], 0., dim[2]);
 
-  int i = (int)(fac * pos_x);
-  if (i >= N) i = N - 1;
-  const double dx = fac * pos_x - i;
-  const double tx = 1. - dx;
-
-  int j = (int)(fac * pos_y);
-  if (j >= N) j = N - 1;
-  const double dy = fac * pos_y - j;
-  const double ty = 1. - dy;
-
-  int k = (int)(fac * pos_z);
-  if (k >= N) k = N - 1;
-  const double dz = fac * pos_z - k;
-  const double tz = 1. - dz;
+  /* Workout the interpolation weights */
+  double wx[pm_mesh_assignment_max_order];
+  double wy[pm_mesh_assignment_max_order];
+  double wz[pm_mesh_assignment_max_order];
+  const int i = pm_mesh_assignment_weights(order, fac * pos_x, wx);
+  const int j = pm_mesh_assignment_weights(order, fac * pos_y, wy);
+  const int k = pm_mesh_assignment_weights(order, fac * pos_z, wz);
 
 #ifdef SWIFT_DEBUG_CHECKS
-  if (i < 0 || i >= N) error("Invalid gpart position in x");
-  if (j < 0 || j >= N) error("Invalid gpart position in y");
-  if (k < 0 || k >= N) error("Invalid gpart position in z");
-#endif
-
-#ifdef SWIFT_GRAVITY_FORCE_CHECKS
-  if (gp->a_grav_mesh[0] != 0.) error("Particle with non-initalised stuff");
-#ifndef SWIFT_GRAVITY_NO_POTENTIAL
-  if (gp->potential_mesh != 0.) error("Particle with non-initalised stuff");
-#endif
+  if (i < -1 || i > N) error("Invalid gpart position in x");
+  if (j < -1 || j > N) error("Invalid gpart position in y");
+  if (k < -1 || k > N) error("Invalid gpart position in z");
 #endif
 
   /* First, copy the necessary part of the mesh for stencil operations */
   /* This includes box-wrapping in all 3 dimensions. */
-  double phi[6][6][6];
-  for (int iii = -2; iii <= 3; ++iii) {
-    for (int jjj = -2; jjj <= 3; ++jjj) {
-      for (int kkk = -2; kkk <= 3; ++kkk) {
+  double phi[pm_mesh_interpolation_max_size][pm_mesh_interpolation_max_size]
+            [pm_mesh_interpolation_max_size];
+  for (int iii = -2; iii < order + 2; ++iii) {
+    for (int jjj = -2; jjj < order + 2; ++jjj) {
+      for (int kkk = -2; kkk < order + 2; ++kkk) {
         phi[iii + 2][jjj + 2][kkk + 2] =
             pot[row_major_id_periodic(i + iii, j + jjj, k + kkk, N)];
       }
     }
   }
 
-  /* Some local accumulators */
-  double p = 0.;
-  double a[3] = {0.};
+  /* Interpolate the potential and accelerations */
+  mesh_stencil_to_gpart(gp, phi, wx, wy, wz, order, fac);
+}
 
-  /* Indices of (i,j,k) in the local copy of the mesh */
-  const int ii = 2, jj = 2, kk = 2;
+/**
+ * @brief Computes the potential on a gpart from a #pm_mesh_patch using the
+ * assignment scheme.
+ *
+ * The patch uses unwrapped coordinates, so no box-wrapping is needed here.
+ *
+ * @param gp The #gpart.
+ * @param patch The #pm_mesh_patch covering the particle's stencil.
+ * @param order The order of the scheme (2: CIC, 3: TSC, 4: PCS).
+ */
+void mesh_patch_to_gpart(struct gpart* gp, const struct pm_mesh_patch* patch,
+                         const int order) {
+
+  const double fac = patch->fac;
+
+  /* Workout the interpolation weights */
+  double wx[pm_mesh_assignment_max_order];
+  double wy[pm_mesh_assignment_max_order];
+  double wz[pm_mesh_assignment_max_order];
+  const int i = pm_mesh_assignment_weights(order, fac * gp->x[0], wx);
+  const int j = pm_mesh_assignment_weights(order, fac * gp->x[1], wy);
+  const int k = pm_mesh_assignment_weights(order, fac * gp->x[2], wz);
+
+  /* First, copy the necessary part of the patch for stencil operations */
+  double phi[pm_mesh_interpolation_max_size][pm_mesh_interpolation_max_size]
+            [pm_mesh_interpolation_max_size];
+  for (int iii = -2; iii < order + 2; ++iii) {
+    for (int jjj = -2; jjj < order + 2; ++jjj) {
+      for (int kkk = -2; kkk < order + 2; ++kkk) {
+        phi[iii + 2][jjj + 2][kkk + 2] = patch->mesh[pm_mesh_patch_index(
+            patch, i + iii, j + jjj, k + kkk)];
+      }
+    }
+  }
 
-  /* Simple CIC for the potential itself */
-  p += CIC_get(phi, ii, jj, kk, tx, ty, tz, dx, dy, dz);
+  /* Interpolate the potential and accelerations */
+  mesh_stencil_to_gpart(gp, phi, wx, wy, wz, order, fac);
+}
 
-  /* ---- */
+void cell_mesh_to_gpart(const struct cell* c, const double* potential,
+                        const int N, const double fac, const float const_G,
+                        const double dim[3], const int order) {
 
-  /* 5-point stencil along each axis for the accelerations */
-  a[0] += (1. / 12.) * CIC_get(phi, ii + 2, jj, kk, tx, ty, tz, dx, dy, dz);
-  a[0] -= (2. / 3.) * CIC_get(phi, ii + 1, jj, kk, tx, ty, tz, dx, dy, dz);
-  a[0] += (2. / 3.) * CIC_get(phi, ii - 1, jj, kk, tx, ty, tz, dx, dy, dz);
-  a[0] -= (1. / 12.) * CIC_get(phi, ii - 2, jj, kk, tx, ty, tz, dx, dy, dz);
+  const int gcount = c->grav.count;
+  struct gpart* gparts = c->grav.parts;
 
-  a[1] += (1. / 12.) * CIC_get(phi, ii, jj + 2, kk, tx, ty, tz, dx, dy, dz);
-  a[1] -= (2. / 3.) * CIC_get(phi, ii, jj + 1, kk, tx, ty, tz, dx, dy, dz);
-  a[1] += (2. / 3.) * CIC_get(phi, ii, jj - 1, kk, tx, ty, tz, dx, dy, dz);
-  a[1] -= (1. / 12.) * CIC_get(phi, ii, jj - 2, kk, tx, ty, tz, dx, dy, dz);
+  /* Assign all the gpart of that cell to the mesh */
+  for (int i = 0; i < gcount; ++i) {
 
-  a[2] += (1. / 12.) * CIC_get(phi, ii, jj, kk + 2, tx, ty, tz, dx, dy, dz);
-  a[2] -= (2. / 3.) * CIC_get(phi, ii, jj, kk + 1, tx, ty, tz, dx, dy, dz);
-  a[2] += (2. / 3.) * CIC_get(phi, ii, jj, kk - 1, tx, ty, tz, dx, dy, dz);
-  a[2] -= (1. / 12.) * CIC_get(phi, ii, jj, kk - 2, tx, ty, tz, dx, dy, dz);
+    struct gpart* gp = &gparts[i];
 
-  /* ---- */
+    if (gp->time_bin == time_bin_inhibited) continue;
 
-  /* Store things back */
-  gp->a_grav_mesh[0] = fac * a[0];
-  gp->a_grav_mesh[1] = fac * a[1];
-  gp->a_grav_mesh[2] = fac * a[2];
-  gravity_add_comoving_mesh_potential(gp, p);
+    gp->a_grav_mesh[0] = 0.f;
+    gp->a_grav_mesh[1] = 0.f;
+    gp->a_grav_mesh[2] = 0.f;
+#ifndef SWIFT_GRAVITY_NO_POTENTIAL
+    gp->potential_mesh = 0.f;
+#endif
+
+    mesh_to_gpart(gp, potential, N, fac, dim, order);
+
+    gp->a_grav_mesh[0] *= const_G;
+    gp->a_grav_mesh[1] *= const_G;
+    gp->a_grav_mesh[2] *= const_G;
+#ifndef SWIFT_GRAVITY_NO_POTENTIAL
+    gp->potential_mesh *= const_G;
+#endif
+  }
 }
 
-void cell_mesh_to_gpart_CIC(const struct cell* c, const double* potential,
-                            const int N, const double fac, const float const_G,
-                            const double dim[3]) {
+/**
+ * @brief Interpolate the forces onto all the #gpart of a #cell from the
+ * #pm_mesh_patch covering it.
+ *
+ * @param c The #cell.
+ * @param patch The #pm_mesh_patch covering the cell's particles.
+ * @param const_G The gravitational constant.
+ * @param order The order of the interpolation scheme.
+ */
+void cell_mesh_patch_to_gpart(const struct cell* c,
+                              const struct pm_mesh_patch* patch,
+                              const float const_G, const int order) {
 
   const int gcount = c->grav.count;
   struct gpart* gparts = c->grav.parts;
 
-  /* Assign all the gpart of that cell to the mesh */
   for (int i = 0; i < gcount; ++i) {
 
     struct gpart* gp = &gparts[i];
@@ -385,7 +500,7 @@ void cell_mesh_to_gpart_CIC(const struct cell* c, const double* potential,
     gp->potential_mesh = 0.f;
 #endif
 
-    mesh_to_gpart_CIC(gp, potential, N, fac, dim);
+    mesh_patch_to_gpart(gp, patch, order);
 
     gp->a_grav_mesh[0] *= const_G;
     gp->a_grav_mesh[1] *= const_G;
@@ -396,7 +511,7 @@ void cell_mesh_to_gpart_CIC(const struct cell* c, const double* potential,
   }
 }
 
-void mesh_to_gpart_CIC_mapper(void* map_data, int num, void* extra) {
+void mesh_to_gpart_mapper(void* map_data, int num, void* extra) {
 
   /* Unpack the shared information */
   const struct cic_mapper_data* data = (struct cic_mapper_data*)extra;
@@ -405,6 +520,7 @@ void mesh_to_gpart_CIC_mapper(void* map_data, int num, void* extra) {
   const double fac = data->fac;
   const double dim[3] = {data->dim[0], data->dim[1], data->dim[2]};
   const float const_G = data->const_G;
+  const int order = data->order;
 
   /* Pointer to the chunk to be processed */
   struct gpart* gparts = (struct gpart*)map_data;
@@ -422,7 +538,7 @@ void mesh_to_gpart_CIC_mapper(void* map_data, int num, void* extra) {
     gp->potential_mesh = 0.f;
 #endif
 
-    mesh_to_gpart_CIC(gp, potential, N, fac, dim);
+    mesh_to_gpart(gp, potential, N, fac, dim, order);
 
     gp->a_grav_mesh[0] *= const_G;
     gp->a_grav_mesh[1] *= const_G;
@@ -434,13 +550,13 @@ void mesh_to_gpart_CIC_mapper(void* map_data, int num, void* extra) {
 }
 
 /**
- * @brief Threadpool mapper function for the mesh CIC assignment of a cell.
+ * @brief Threadpool mapper function for the mesh interpolation of a cell.
  *
  * @param map_data A chunk of the list of local cells.
  * @param num The number of cells in the chunk.
  * @param extra The information about the mesh and cells.
  */
-void cell_mesh_to_gpart_CIC_mapper(void* map_data, int num, void* extra) {
+void cell_mesh_to_gpart_mapper(void* map_data, int num, void* extra) {
 
   /* Unpack the shared information */
   const struct cic_mapper_data* data = (struct cic_mapper_data*)extra;
@@ -450,6 +566,7 @@ void cell_mesh_to_gpart_CIC_mapper(void* map_data, int num, void* extra) {
   const double fac = data->fac;
   const double dim[3] = {data->dim[0], data->dim[1], data->dim[2]};
   const float const_G = data->const_G;
+  const int order = data->order;
 
   /* Pointer to the chunk to be processed */
   int* local_cells = (int*)map_data;
@@ -461,7 +578,39 @@ void cell_mesh_to_gpart_CIC_mapper(void* map_data, int num, void* extra) {
     const struct cell* c = &cells[local_cells[i]];
 
     /* Assign this cell's content to the mesh */
-    cell_mesh_to_gpart_CIC(c, potential, N, fac, const_G, dim);
+    cell_mesh_to_gpart(c, potential, N, fac, const_G, dim, order);
+  }
+}
+
+/**
+ * @brief Threadpool mapper function for the mesh interpolation of a cell
+ * from its #pm_mesh_patch.
+ *
+ * @param map_data A chunk of the list of local cells.
+ * @param num The number of cells in the chunk.
+ * @param extra The information about the patches and cells.
+ */
+void cell_mesh_patch_to_gpart_mapper(void* map_data, int num, void* extra) {
+
+  /* Unpack the shared information */
+  const struct cic_mapper_data* data = (struct cic_mapper_data*)extra;
+  const struct cell* cells = data->cells;
+  const float const_G = data->const_G;
+  const int order = data->order;
+
+  /* Pointer to the chunk to be processed */
+  int* local_cells = (int*)map_data;
+  const size_t offset = local_cells - data->local_cells;
+
+  /* Loop over the elements assigned to this thread */
+  for (int i = 0; i < num; ++i) {
+
+    /* Pointer to local cell and its patch */
+    const struct cell* c = &cells[local_cells[i]];
+    const struct pm_mesh_patch* patch = &data->patches[offset + i];
+
+    /* Interpolate the forces onto this cell's content */
+    cell_mesh_patch_to_gpart(c, patch, const_G, order);
   }
 }
 
@@ -472,10 +621,12 @@ void cell_mesh_to_gpart_CIC_mapper(void* map_data, int num, void* extra) {
 struct Green_function_data {
 
   int N;
+  int slice_offset;
   fftw_complex* frho;
   double green_fac;
   double a_smooth2;
   double k_fac;
+  int order;
 };
 
 /**
@@ -499,16 +650,21 @@ void mesh_apply_Green_function_mapper(void* map_data, const int num,
   const double green_fac = data->green_fac;
   const double a_smooth2 = data->a_smooth2;
   const double k_fac = data->k_fac;
+  const int order = data->order;
 
-  /* Range handled by this call */
+  /* Range handled by this call (in the local slice) */
   const int i_start = (fftw_complex*)map_data - frho;
   const int i_end = i_start + num;
 
+  /* Offset of the local slice in the full mesh */
+  const int slice_offset = data->slice_offset;
+
   /* Loop over the x range corresponding to this thread */
   for (int i = i_start; i < i_end; ++i) {
 
     /* kx component of vector in Fourier space and 1/sinc(kx) */
-    const int kx = (i > N_half ? i - N : i);
+    const int i_global = i + slice_offset;
+    const int kx = (i_global > N_half ? i_global - N : i_global);
     const double kx_d = (double)kx;
     const double fx = k_fac * kx_d;
     const double sinc_kx_inv = (kx != 0) ? fx / sin(fx) : 1.;
@@ -540,13 +696,17 @@ void mesh_apply_Green_function_mapper(void* map_data, const int num,
         fourier_kernel_long_grav_eval(k2 * a_smooth2, &W);
         const double green_cor = green_fac * W / (k2 + FLT_MIN);
 
-        /* Deconvolution of CIC */
-        const double CIC_cor = sinc_kx_inv * sinc_ky_inv * sinc_kz_inv;
-        const double CIC_cor2 = CIC_cor * CIC_cor;
-        const double CIC_cor4 = CIC_cor2 * CIC_cor2;
+        /* Deconvolution of the mass assignment and of the interpolation
+         * (sinc^order each) */
+        const double W_cor = sinc_kx_inv * sinc_ky_inv * sinc_kz_inv;
+        const double W_cor2 = W_cor * W_cor;
+        const double W_cor4 = W_cor2 * W_cor2;
+        const double W_cor_total =
+            (order == 2) ? W_cor4
+                         : ((order == 3) ? W_cor4 * W_cor2 : W_cor4 * W_cor4);
 
         /* Combined correction */
-        const double total_cor = green_cor * CIC_cor4;
+        const double total_cor = green_cor * W_cor_total;
 
         /* Apply to the mesh */
         const int index = N * (N_half + 1) * i + (N_half + 1) * j + k;
@@ -561,43 +721,205 @@ void mesh_apply_Green_function_mapper(void* map_data, const int num,
  * @brief Apply the Green function in Fourier space to the density
  * array to get the potential.
  *
- * Also deconvolves the CIC kernel.
+ * Also deconvolves the mass assignment and interpolation kernels.
+ *
+ * The array can be a slice [slice_offset, slice_offset + slice_width[ along
+ * x of the full mesh, as is the case when the mesh is distributed.
  *
  * @param tp The threadpool.
- * @param frho The NxNx(N/2) complex array of the Fourier transform of the
- * density field.
+ * @param frho The slice_width x N x (N/2+1) complex array of the Fourier
+ * transform of the density field.
+ * @param slice_offset The index along x of the first element of the slice.
+ * @param slice_width The number of elements of the slice along x.
  * @param N The dimension of the array.
  * @param r_s The Green function smoothing scale.
  * @param box_size The physical size of the simulation box.
+ * @param order The order of the assignment and interpolation scheme.
  */
 void mesh_apply_Green_function(struct threadpool* tp, fftw_complex* frho,
+                               const int slice_offset, const int slice_width,
                                const int N, const double r_s,
-                               const double box_size) {
+                               const double box_size, const int order) {
 
   /* Some common factors */
   struct Green_function_data data;
   data.frho = frho;
+  data.slice_offset = slice_offset;
   data.N = N;
   data.green_fac = -1. / (M_PI * box_size);
   data.a_smooth2 = 4. * M_PI * M_PI * r_s * r_s / (box_size * box_size);
   data.k_fac = M_PI / (double)N;
+  data.order = order;
 
   /* Parallelize the Green function application using the threadpool
      to split the x-axis loop over the threads.
      The array is N x N x (N/2). We use the thread to each deal with
      a range [i_min, i_max[ x N x (N/2) */
   if (N < 32) {
-    mesh_apply_Green_function_mapper(frho, N, &data);
+    mesh_apply_Green_function_mapper(frho, slice_width, &data);
   } else {
-    threadpool_map(tp, mesh_apply_Green_function_mapper, frho, N,
+    threadpool_map(tp, mesh_apply_Green_function_mapper, frho, slice_width,
                    sizeof(fftw_complex), threadpool_auto_chunk_size, &data);
   }
 
   /* Correct singularity at (0,0,0) */
-  frho[0][0] = 0.;
-  frho[0][1] = 0.;
+  if (slice_offset == 0 && slice_width > 0) {
+    frho[0][0] = 0.;
+    frho[0][1] = 0.;
+  }
+}
+
+#if defined(WITH_MPI) && defined(HAVE_MPI_FFTW)
+
+/**
+ * @brief Compute the potential on a mesh distributed in slabs over the MPI
+ * ranks and interpolate the forces back onto the local #gpart.
+ *
+ * Each rank only holds local_n0 slices of N x N cells along x. The density
+ * contributions of the local particles are sent sparsely to the owners of
+ * the relevant slabs, the Fourier transforms are done using the MPI version
+ * of FFTW and only the potential values needed by the local particles are
+ * fetched back from the other ranks.
+ *
+ * Note that there is no multiplication by G_newton at this stage.
+ *
+ * @param mesh The #pm_mesh used to store the potential.
+ * @param s The #space containing the particles.
+ * @param tp The #threadpool object used for parallelisation.
+ * @param verbose Are we talkative?
+ */
+static void pm_mesh_compute_potential_distributed(struct pm_mesh* mesh,
+                                                  const struct space* s,
+                                                  struct threadpool* tp,
+                                                  const int verbose) {
+
+  const double r_s = mesh->r_s;
+  const double box_size = s->dim[0];
+  const int* local_cells = s->local_cells_top;
+  const int nr_local_cells = s->nr_local_cells;
+
+  /* Some useful constants */
+  const int N = mesh->N;
+  const int N_half = N / 2;
+  const double cell_fac = N / box_size;
+
+  /* Get the slab decomposition chosen by FFTW */
+  ptrdiff_t local_n0, local_0_start;
+  const ptrdiff_t nalloc = fftw_mpi_local_size_3d(
+      N, N, N_half + 1, MPI_COMM_WORLD, &local_n0, &local_0_start);
+
+  /* Allocate the local slab. The transforms are done in-place so the real
+   * array is padded to 2 x (N/2+1) elements along z. */
+  double* restrict rho_slab = fftw_alloc_real(2 * nalloc);
+  if (rho_slab == NULL) error("Error allocating memory for density slab");
+  memuse_log_allocation("fftw_rho_slab", rho_slab, 1,
+                        sizeof(double) * 2 * nalloc);
+  fftw_complex* restrict frho_slab = (fftw_complex*)rho_slab;
+
+  /* Prepare the FFT library */
+  fftw_plan forward_plan = fftw_mpi_plan_dft_r2c_3d(
+      N, N, N, rho_slab, frho_slab, MPI_COMM_WORLD,
+      FFTW_ESTIMATE | FFTW_DESTROY_INPUT);
+  fftw_plan inverse_plan = fftw_mpi_plan_dft_c2r_3d(
+      N, N, N, frho_slab, rho_slab, MPI_COMM_WORLD,
+      FFTW_ESTIMATE | FFTW_DESTROY_INPUT);
+
+  ticks tic = getticks();
+
+  /* Zero everything */
+  bzero(rho_slab, 2 * nalloc * sizeof(double));
+
+  /* Do a parallel mesh assignment of the local gparts and send the
+   * contributions to the ranks owning the slabs */
+  mpi_mesh_accumulate_gparts_to_local_slab(
+      tp, s, N, cell_fac, mesh->assignment_order, rho_slab, (int)local_n0,
+      (int)local_0_start, verbose);
+
+  if (verbose)
+    message("Gpart assignment to the distributed mesh took %.3f %s.",
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  tic = getticks();
+
+  /* Fourier transform to go to magic-land */
+  fftw_execute(forward_plan);
+
+  if (verbose)
+    message("Forward Fourier transform took %.3f %s.",
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  tic = getticks();
+
+  /* Now de-convolve the assignment kernel and apply the Green function on
+   * our slab */
+  mesh_apply_Green_function(tp, frho_slab, (int)local_0_start, (int)local_n0,
+                            N, r_s, box_size, mesh->assignment_order);
+
+  if (verbose)
+    message("Applying Green function took %.3f %s.",
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  tic = getticks();
+
+  /* Fourier transform to come back from magic-land */
+  fftw_execute(inverse_plan);
+
+  if (verbose)
+    message("Backwards Fourier transform took %.3f %s.",
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  /* rho_slab now contains the potential */
+
+  tic = getticks();
+
+  /* Fetch the parts of the potential we need for the local particles */
+  struct pm_mesh_patch* patches = (struct pm_mesh_patch*)calloc(
+      nr_local_cells, sizeof(struct pm_mesh_patch));
+  if (patches == NULL && nr_local_cells > 0)
+    error("Error allocating memory for the potential patches");
+
+  mpi_mesh_fetch_potential(tp, s, N, cell_fac, mesh->assignment_order,
+                           rho_slab, (int)local_n0, (int)local_0_start,
+                           patches, verbose);
+
+  /* We can now release the slab */
+  fftw_destroy_plan(forward_plan);
+  fftw_destroy_plan(inverse_plan);
+  memuse_log_allocation("fftw_rho_slab", rho_slab, 0, 0);
+  fftw_free(rho_slab);
+
+  /* Gather the mesh shared information to be used by the threads */
+  struct cic_mapper_data data;
+  data.cells = s->cells_top;
+  data.local_cells = local_cells;
+  data.patches = patches;
+  data.nr_patches = nr_local_cells;
+  data.rho = NULL;
+  data.potential = NULL;
+  data.N = N;
+  data.order = mesh->assignment_order;
+  data.fac = cell_fac;
+  data.dim[0] = s->dim[0];
+  data.dim[1] = s->dim[1];
+  data.dim[2] = s->dim[2];
+  data.const_G = s->e->physical_constants->const_newton_G;
+
+  /* Do a parallel mesh interpolation onto the gparts */
+  threadpool_map(tp, cell_mesh_patch_to_gpart_mapper, (void*)local_cells,
+                 nr_local_cells, sizeof(int), threadpool_auto_chunk_size,
+                 (void*)&data);
+
+  if (verbose)
+    message("Gpart mesh forces took %.3f %s.",
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  /* Clean-up the mess */
+  for (int i = 0; i < nr_local_cells; ++i) pm_mesh_patch_clean(&patches[i]);
+  free(patches);
 }
 
+#endif /* WITH_MPI && HAVE_MPI_FFTW */
+
 #endif
 
 /**
@@ -605,7 +927,8 @@ void mesh_apply_Green_function(struct threadpool* tp, fftw_complex* frho,
  *
  * Interpolates the top-level multipoles on-to a mesh, move to Fourier space,
  * compute the potential including short-range correction and move back
- * to real space. We use CIC for the interpolation.
+ * to real space. The mass is assigned and the forces are interpolated back
+ * using the same CIC, TSC or PCS scheme.
  *
  * Note that there is no multiplication by G_newton at this stage.
  *
@@ -630,6 +953,16 @@ void pm_mesh_compute_potential(struct pm_mesh* mesh, const struct space* s,
       mesh->dim[2] != dim[2])
     error("Domain size does not match the value stored in the space.");
 
+  /* Are we using the slab-decomposed version? */
+  if (mesh->distributed_mesh) {
+#if defined(WITH_MPI) && defined(HAVE_MPI_FFTW)
+    pm_mesh_compute_potential_distributed(mesh, s, tp, verbose);
+    return;
+#else
+    error("Distributed mesh requested but FFTW MPI library not found.");
+#endif
+  }
+
   /* Some useful constants */
   const int N = mesh->N;
   const int N_half = N / 2;
@@ -661,9 +994,13 @@ void pm_mesh_compute_potential(struct pm_mesh* mesh, const struct space* s,
   /* Gather the mesh shared information to be used by the threads */
   struct cic_mapper_data data;
   data.cells = s->cells_top;
+  data.local_cells = local_cells;
+  data.patches = NULL;
+  data.nr_patches = 0;
   data.rho = rho;
   data.potential = NULL;
   data.N = N;
+  data.order = mesh->assignment_order;
   data.fac = cell_fac;
   data.dim[0] = dim[0];
   data.dim[1] = dim[1];
@@ -674,17 +1011,33 @@ void pm_mesh_compute_potential(struct pm_mesh* mesh, const struct space* s,
 
     /* We don't have a cell infrastructure in place so we need to
      * directly loop over the particles */
-    threadpool_map(tp, gpart_to_mesh_CIC_mapper, s->gparts, s->nr_gparts,
+    threadpool_map(tp, gpart_to_mesh_mapper, s->gparts, s->nr_gparts,
                    sizeof(struct gpart), threadpool_auto_chunk_size,
                    (void*)&data);
 
   } else { /* Normal case */
 
-    /* Do a parallel CIC mesh assignment of the gparts but only using
-     * the local top-level cells */
-    threadpool_map(tp, cell_gpart_to_mesh_CIC_mapper, (void*)local_cells,
+    /* Do a parallel mesh assignment of the gparts of each local top-level
+     * cell to its own private patch */
+    struct pm_mesh_patch* patches = (struct pm_mesh_patch*)calloc(
+        nr_local_cells, sizeof(struct pm_mesh_patch));
+    if (patches == NULL) error("Error allocating memory for the mesh patches");
+    data.patches = patches;
+    data.nr_patches = nr_local_cells;
+
+    threadpool_map(tp, cell_gpart_to_mesh_patch_mapper, (void*)local_cells,
                    nr_local_cells, sizeof(int), threadpool_auto_chunk_size,
                    (void*)&data);
+
+    /* Add the patches to the mesh, each thread taking a range of slices */
+    threadpool_map(tp, mesh_patches_to_mesh_mapper, rho, N,
+                   sizeof(double) * N * N, threadpool_auto_chunk_size,
+                   (void*)&data);
+
+    for (int i = 0; i < nr_local_cells; ++i) pm_mesh_patch_clean(&patches[i]);
+    free(patches);
+    data.patches = NULL;
+    data.nr_patches = 0;
   }
 
   if (verbose)
@@ -722,8 +1075,10 @@ void pm_mesh_compute_potential(struct pm_mesh* mesh, const struct space* s,
 
   tic = getticks();
 
-  /* Now de-convolve the CIC kernel and apply the Green function */
-  mesh_apply_Green_function(tp, frho, N, r_s, box_size);
+  /* Now de-convolve the assignment kernel and apply the Green function */
+  mesh_apply_Green_function(tp, frho, /*slice_offset=*/0,
+                            /*slice_width=*/N, N, r_s, box_size,
+                            mesh->assignment_order);
 
   if (verbose)
     message("Applying Green function took %.3f %s.",
@@ -751,9 +1106,13 @@ void pm_mesh_compute_potential(struct pm_mesh* mesh, const struct space* s,
 
   /* Gather the mesh shared information to be used by the threads */
   data.cells = s->cells_top;
+  data.local_cells = local_cells;
+  data.patches = NULL;
+  data.nr_patches = 0;
   data.rho = NULL;
   data.potential = mesh->potential;
   data.N = N;
+  data.order = mesh->assignment_order;
   data.fac = cell_fac;
   data.dim[0] = dim[0];
   data.dim[1] = dim[1];
@@ -764,15 +1123,15 @@ void pm_mesh_compute_potential(struct pm_mesh* mesh, const struct space* s,
 
     /* We don't have a cell infrastructure in place so we need to
      * directly loop over the particles */
-    threadpool_map(tp, mesh_to_gpart_CIC_mapper, s->gparts, s->nr_gparts,
+    threadpool_map(tp, mesh_to_gpart_mapper, s->gparts, s->nr_gparts,
                    sizeof(struct gpart), threadpool_auto_chunk_size,
                    (void*)&data);
 
   } else { /* Normal case */
 
-    /* Do a parallel CIC mesh interpolation onto the gparts but only using
+    /* Do a parallel mesh interpolation onto the gparts but only using
        the local top-level cells */
-    threadpool_map(tp, cell_mesh_to_gpart_CIC_mapper, (void*)local_cells,
+    threadpool_map(tp, cell_mesh_to_gpart_mapper, (void*)local_cells,
                    nr_local_cells, sizeof(int), threadpool_auto_chunk_size,
                    (void*)&data);
   }
@@ -802,6 +1161,9 @@ void pm_mesh_allocate(struct pm_mesh* mesh) {
 #ifdef HAVE_FFTW
   if (mesh->potential != NULL) error("Mesh already allocated!");
 
+  /* The distributed mesh only allocates its slab when needed */
+  if (mesh->distributed_mesh) return;
+
   const int N = mesh->N;
 
   /* Allocate the memory for the combined density and potential array */
@@ -855,6 +1217,8 @@ void pm_mesh_init(struct pm_mesh* mesh, const struct gravity_props* props,
 
   mesh->nr_threads = nr_threads;
   mesh->periodic = 1;
+  mesh->distributed_mesh = props->distributed_mesh;
+  mesh->assignment_order = props->mesh_assignment_order;
   mesh->N = N;
   mesh->dim[0] = dim[0];
   mesh->dim[1] = dim[1];
@@ -870,10 +1234,10 @@ void pm_mesh_init(struct pm_mesh* mesh, const struct gravity_props* props,
   mesh->ti_beg_mesh_next = -1;
   mesh->ti_end_mesh_next = -1;
 
-  if (mesh->N > 1290)
+  if (mesh->N > 1290 && !mesh->distributed_mesh)
     error(
         "Mesh too big. The number of cells is larger than 2^31. "
-        "Use a mesh side-length <= 1290.");
+        "Use a mesh side-length <= 1290 or a distributed mesh.");
 
   if (2. * mesh->r_cut_max > box_size)
     error("Mesh too small or r_cut_max too big for this box size");
@@ -886,6 +1250,11 @@ void pm_mesh_init(struct pm_mesh* mesh, const struct gravity_props* props,
   }
 #endif
 
+#if defined(WITH_MPI) && defined(HAVE_MPI_FFTW)
+  /* Initialise the MPI-parallel FFTW version (after the threads) */
+  if (mesh->distributed_mesh) fftw_mpi_init();
+#endif
+
   pm_mesh_allocate(mesh);
 
 #else
@@ -926,6 +1295,10 @@ void pm_mesh_init_no_mesh(struct pm_mesh* mesh, double dim[3]) {
  */
 void pm_mesh_clean(struct pm_mesh* mesh) {
 
+#if defined(WITH_MPI) && defined(HAVE_MPI_FFTW)
+  if (mesh->distributed_mesh) fftw_mpi_cleanup();
+#endif
+
 #ifdef HAVE_THREADED_FFTW
   fftw_cleanup_threads();
 #endif
@@ -969,12 +1342,23 @@ void pm_mesh_struct_restore(struct pm_mesh* mesh, FILE* stream) {
     }
 #endif
 
+#if defined(WITH_MPI) && defined(HAVE_MPI_FFTW)
+    /* Initialise the MPI-parallel FFTW version (after the threads) */
+    if (mesh->distributed_mesh) fftw_mpi_init();
+#else
+    if (mesh->distributed_mesh)
+      error("Restarting with a distributed mesh without FFTW MPI library.");
+#endif
+
     /* Allocate the memory for the combined density and potential array */
-    mesh->potential = (double*)fftw_malloc(sizeof(double) * N * N * N);
-    if (mesh->potential == NULL)
-      error("Error allocating memory for the long-range gravity mesh.");
-    memuse_log_allocation("fftw_mesh.potential", mesh->potential, 1,
-                          sizeof(double) * N * N * N);
+    mesh->potential = NULL;
+    if (!mesh->distributed_mesh) {
+      mesh->potential = (double*)fftw_malloc(sizeof(double) * N * N * N);
+      if (mesh->potential == NULL)
+        error("Error allocating memory for the long-range gravity mesh.");
+      memuse_log_allocation("fftw_mesh.potential", mesh->potential, 1,
+                            sizeof(double) * N * N * N);
+    }
 #else
     error("No FFTW library found. Cannot compute periodic long-range forces.");
 #endif
@@ -40,6 +40,13 @@ struct pm_mesh {
   /*! Is the calculation using periodic BCs? */
   int periodic;
 
+  /*! Is the mesh distributed in slabs over the MPI ranks? */
+  int distributed_mesh;
+
+  /*! Order of the mass assignment and force interpolation (2: CIC, 3: TSC,
+   * 4: PCS) */
+  int assignment_order;
+
   /*! The number of threads used by the FFTW library */
   int nr_threads;
 
@@ -76,7 +83,7 @@ struct pm_mesh {
   /*! Distance below which tree forces are Newtonian */
   double r_cut_min;
 
-  /*! Potential field */
+  /*! Potential field (NULL if the mesh is distributed) */
   double *potential;
 };
 
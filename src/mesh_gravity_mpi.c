@@ -0,0 +1,651 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+/* Config parameters. */
+#include "../config.h"
+
+/* Some standard headers. */
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef WITH_MPI
+#include <mpi.h>
+#endif
+
+/* This object's header. */
+#include "mesh_gravity_mpi.h"
+
+/* Local includes. */
+#include "active.h"
+#include "atomic.h"
+#include "cell.h"
+#include "clocks.h"
+#include "error.h"
+#include "mesh_gravity_patch.h"
+#include "part.h"
+#include "space.h"
+#include "threadpool.h"
+
+#if defined(WITH_MPI) && defined(HAVE_MPI_FFTW)
+
+/**
+ * @brief A contribution of the local particles to one cell of the global
+ * density mesh.
+ */
+struct mesh_key_value {
+
+  /*! Index of the cell in the global NxNxN row-major mesh */
+  size_t key;
+
+  /*! Value to add to that cell */
+  double value;
+};
+
+/**
+ * @brief Shared information used by the patch mappers.
+ */
+struct mesh_patch_mapper_data {
+
+  /*! The top-level cells */
+  const struct cell* cells;
+
+  /*! The list of local top-level cells */
+  const int* local_cells;
+
+  /*! One patch per local top-level cell */
+  struct pm_mesh_patch* patches;
+
+  /*! Side-length of the mesh */
+  int N;
+
+  /*! Conversion factor between box and mesh size */
+  double fac;
+
+  /*! Order of the assignment and interpolation scheme */
+  int order;
+
+  /*! Sorted list of the mesh keys fetched from the other ranks */
+  const size_t* keys;
+
+  /*! The values corresponding to the keys */
+  const double* values;
+
+  /*! Number of keys */
+  size_t nr_keys;
+};
+
+/**
+ * @brief Returns the index of the MPI rank owning a given slab of the mesh.
+ *
+ * @param key The index of the cell in the global mesh.
+ * @param N The side-length of the mesh.
+ * @param slab_owner For each index along x, the rank holding that slice.
+ */
+__attribute__((always_inline)) INLINE static int mesh_key_owner(
+    const size_t key, const int N, const int* slab_owner) {
+
+  return slab_owner[key / ((size_t)N * (size_t)N)];
+}
+
+/**
+ * @brief Returns the index in the local (padded) real slab of a cell of the
+ * global mesh.
+ *
+ * @param key The index of the cell in the global mesh.
+ * @param N The side-length of the mesh.
+ * @param local_0_start The first slice along x held by this rank.
+ */
+__attribute__((always_inline)) INLINE static size_t mesh_key_to_slab_index(
+    const size_t key, const int N, const int local_0_start) {
+
+  const size_t N_pad = 2 * (N / 2 + 1);
+  const size_t i = key / ((size_t)N * (size_t)N) - local_0_start;
+  const size_t j = (key / N) % N;
+  const size_t k = key % N;
+
+  return (i * N + j) * N_pad + k;
+}
+
+/**
+ * @brief Gather the slab decomposition of all the ranks and build a
+ * look-up table mapping each slice along x to its owner.
+ *
+ * @param N The side-length of the mesh.
+ * @param local_n0 The number of slices held by this rank.
+ * @param local_0_start The first slice held by this rank.
+ */
+static int* mesh_build_slab_owner(const int N, const int local_n0,
+                                  const int local_0_start) {
+
+  int nr_nodes;
+  MPI_Comm_size(MPI_COMM_WORLD, &nr_nodes);
+
+  int* all_n0 = (int*)malloc(nr_nodes * sizeof(int));
+  int* all_0_start = (int*)malloc(nr_nodes * sizeof(int));
+  if (all_n0 == NULL || all_0_start == NULL)
+    error("Failed to allocate slab decomposition arrays.");
+
+  MPI_Allgather(&local_n0, 1, MPI_INT, all_n0, 1, MPI_INT, MPI_COMM_WORLD);
+  MPI_Allgather(&local_0_start, 1, MPI_INT, all_0_start, 1, MPI_INT,
+                MPI_COMM_WORLD);
+
+  int* slab_owner = (int*)malloc(N * sizeof(int));
+  if (slab_owner == NULL) error("Failed to allocate slab owner array.");
+  for (int i = 0; i < N; ++i) slab_owner[i] = -1;
+
+  for (int rank = 0; rank < nr_nodes; ++rank)
+    for (int i = all_0_start[rank]; i < all_0_start[rank] + all_n0[rank]; ++i)
+      slab_owner[i] = rank;
+
+  for (int i = 0; i < N; ++i)
+    if (slab_owner[i] < 0) error("Slice %d of the mesh has no owner!", i);
+
+  free(all_n0);
+  free(all_0_start);
+  return slab_owner;
+}
+
+/**
+ * @brief Compute the send and receive offsets from the counts and exchange
+ * the counts with all the other ranks.
+ *
+ * @param nr_nodes The number of MPI ranks.
+ * @param sendcount The number of elements to send to each rank.
+ * @param recvcount (return) The number of elements to receive from each rank.
+ * @param sendoffset (return) The offsets in the send buffer.
+ * @param recvoffset (return) The offsets in the receive buffer.
+ * @return The total number of elements to receive.
+ */
+static size_t mesh_exchange_counts(const int nr_nodes, const int* sendcount,
+                                   int* recvcount, int* sendoffset,
+                                   int* recvoffset) {
+
+  MPI_Alltoall(sendcount, 1, MPI_INT, recvcount, 1, MPI_INT, MPI_COMM_WORLD);
+
+  sendoffset[0] = 0;
+  recvoffset[0] = 0;
+  for (int i = 1; i < nr_nodes; ++i) {
+    sendoffset[i] = sendoffset[i - 1] + sendcount[i - 1];
+    recvoffset[i] = recvoffset[i - 1] + recvcount[i - 1];
+  }
+
+  size_t nrecv = 0;
+  for (int i = 0; i < nr_nodes; ++i) nrecv += recvcount[i];
+  return nrecv;
+}
+
+/**
+ * @brief Threadpool mapper assigning the #gpart of each local top-level cell
+ * to its own private #pm_mesh_patch.
+ *
+ * No atomics are needed since each patch is only touched by one thread.
+ *
+ * @param map_data A chunk of the list of local cells.
+ * @param num The number of cells in the chunk.
+ * @param extra The #mesh_patch_mapper_data.
+ */
+static void mesh_gparts_to_patch_mapper(void* map_data, int num,
+                                        void* extra) {
+
+  const struct mesh_patch_mapper_data* data =
+      (struct mesh_patch_mapper_data*)extra;
+  const int* local_cells = (const int*)map_data;
+  const size_t offset = local_cells - data->local_cells;
+
+  for (int n = 0; n < num; ++n) {
+    const struct cell* c = &data->cells[local_cells[n]];
+    pm_mesh_patch_assign_cell(&data->patches[offset + n], c, data->N,
+                              data->fac, data->order);
+  }
+}
+
+/**
+ * @brief Shared information used by the slab accumulation mapper.
+ */
+struct mesh_slab_accumulate_data {
+  double* rho_slab;
+  int N;
+  int local_0_start;
+};
+
+/**
+ * @brief Threadpool mapper adding received mesh contributions to the local
+ * slab.
+ *
+ * @param map_data A chunk of the received #mesh_key_value.
+ * @param num The number of elements in the chunk.
+ * @param extra The #mesh_slab_accumulate_data.
+ */
+static void mesh_slab_accumulate_mapper(void* map_data, int num,
+                                        void* extra) {
+
+  const struct mesh_slab_accumulate_data* data =
+      (struct mesh_slab_accumulate_data*)extra;
+  const struct mesh_key_value* recv = (const struct mesh_key_value*)map_data;
+
+  for (int n = 0; n < num; ++n) {
+    const size_t index =
+        mesh_key_to_slab_index(recv[n].key, data->N, data->local_0_start);
+    atomic_add_d(&data->rho_slab[index], recv[n].value);
+  }
+}
+
+/**
+ * @brief Assign the local #gpart to the distributed density mesh.
+ *
+ * Each local top-level cell is first assigned to a private dense patch. The
+ * non-zero elements of the patches are then sent to the rank owning the
+ * corresponding slab of the mesh and added to the local slab there.
+ *
+ * @param tp The #threadpool object used for parallelisation.
+ * @param s The #space containing the particles.
+ * @param N The side-length of the mesh.
+ * @param fac The conversion factor between box and mesh size.
+ * @param order The order of the mass assignment scheme.
+ * @param rho_slab The (padded) local slab of the density mesh.
+ * @param local_n0 The number of slices held by this rank.
+ * @param local_0_start The first slice held by this rank.
+ * @param verbose Are we talkative?
+ */
+void mpi_mesh_accumulate_gparts_to_local_slab(
+    struct threadpool* tp, const struct space* s, const int N,
+    const double fac, const int order, double* rho_slab, const int local_n0,
+    const int local_0_start, const int verbose) {
+
+  const int* local_cells = s->local_cells_top;
+  const int nr_local_cells = s->nr_local_cells;
+
+  if (nr_local_cells == 0 && s->nr_gparts > 0)
+    error("The distributed mesh requires a top-level cell structure.");
+
+  int nr_nodes;
+  MPI_Comm_size(MPI_COMM_WORLD, &nr_nodes);
+
+  ticks tic = getticks();
+
+  /* Assign each local cell to its own patch */
+  struct pm_mesh_patch* patches = (struct pm_mesh_patch*)calloc(
+      nr_local_cells, sizeof(struct pm_mesh_patch));
+  if (patches == NULL && nr_local_cells > 0)
+    error("Failed to allocate the mesh patches.");
+
+  struct mesh_patch_mapper_data data;
+  data.cells = s->cells_top;
+  data.local_cells = local_cells;
+  data.patches = patches;
+  data.N = N;
+  data.fac = fac;
+  data.order = order;
+  data.keys = NULL;
+  data.values = NULL;
+  data.nr_keys = 0;
+
+  threadpool_map(tp, mesh_gparts_to_patch_mapper, (void*)local_cells,
+                 nr_local_cells, sizeof(int), threadpool_auto_chunk_size,
+                 &data);
+
+  if (verbose)
+    message("Gpart assignment to patches took %.3f %s.",
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  tic = getticks();
+
+  /* Build the slab decomposition look-up table */
+  int* slab_owner = mesh_build_slab_owner(N, local_n0, local_0_start);
+
+  /* Count the non-zero contributions going to each rank */
+  int* sendcount = (int*)calloc(nr_nodes, sizeof(int));
+  int* recvcount = (int*)malloc(nr_nodes * sizeof(int));
+  int* sendoffset = (int*)malloc(nr_nodes * sizeof(int));
+  int* recvoffset = (int*)malloc(nr_nodes * sizeof(int));
+  if (sendcount == NULL || recvcount == NULL || sendoffset == NULL ||
+      recvoffset == NULL)
+    error("Failed to allocate count arrays.");
+
+  size_t nsend = 0;
+  for (int n = 0; n < nr_local_cells; ++n) {
+    const struct pm_mesh_patch* patch = &patches[n];
+    for (size_t ind = 0; ind < patch->volume; ++ind) {
+      if (patch->mesh[ind] == 0.) continue;
+      const size_t key = pm_mesh_patch_global_index(patch, ind);
+      sendcount[mesh_key_owner(key, N, slab_owner)]++;
+      nsend++;
+    }
+  }
+
+  /* Prepare the send buffer, sorted by destination */
+  struct mesh_key_value* sendbuf = (struct mesh_key_value*)malloc(
+      nsend * sizeof(struct mesh_key_value));
+  if (sendbuf == NULL && nsend > 0)
+    error("Failed to allocate the mesh send buffer.");
+
+  size_t nrecv = mesh_exchange_counts(nr_nodes, sendcount, recvcount,
+                                      sendoffset, recvoffset);
+
+  int* fill = (int*)malloc(nr_nodes * sizeof(int));
+  if (fill == NULL) error("Failed to allocate count arrays.");
+  memcpy(fill, sendoffset, nr_nodes * sizeof(int));
+
+  for (int n = 0; n < nr_local_cells; ++n) {
+    struct pm_mesh_patch* patch = &patches[n];
+    for (size_t ind = 0; ind < patch->volume; ++ind) {
+      if (patch->mesh[ind] == 0.) continue;
+      const size_t key = pm_mesh_patch_global_index(patch, ind);
+      const int dest = mesh_key_owner(key, N, slab_owner);
+      sendbuf[fill[dest]].key = key;
+      sendbuf[fill[dest]].value = patch->mesh[ind];
+      fill[dest]++;
+    }
+
+    /* We are done with this patch */
+    pm_mesh_patch_clean(patch);
+  }
+  free(patches);
+  free(fill);
+
+  struct mesh_key_value* recvbuf = (struct mesh_key_value*)malloc(
+      nrecv * sizeof(struct mesh_key_value));
+  if (recvbuf == NULL && nrecv > 0)
+    error("Failed to allocate the mesh receive buffer.");
+
+  /* Exchange the contributions */
+  MPI_Datatype mesh_key_value_type;
+  if (MPI_Type_contiguous(sizeof(struct mesh_key_value), MPI_BYTE,
+                          &mesh_key_value_type) != MPI_SUCCESS ||
+      MPI_Type_commit(&mesh_key_value_type) != MPI_SUCCESS)
+    error("Failed to create MPI type for mesh contributions.");
+
+  MPI_Alltoallv(sendbuf, sendcount, sendoffset, mesh_key_value_type, recvbuf,
+                recvcount, recvoffset, mesh_key_value_type, MPI_COMM_WORLD);
+
+  MPI_Type_free(&mesh_key_value_type);
+  free(sendbuf);
+
+  if (verbose)
+    message("Sparse exchange of %zu mesh contributions took %.3f %s.", nsend,
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  tic = getticks();
+
+  /* Add everything we received to the local slab */
+  struct mesh_slab_accumulate_data acc_data;
+  acc_data.rho_slab = rho_slab;
+  acc_data.N = N;
+  acc_data.local_0_start = local_0_start;
+  threadpool_map(tp, mesh_slab_accumulate_mapper, recvbuf, nrecv,
+                 sizeof(struct mesh_key_value), threadpool_auto_chunk_size,
+                 &acc_data);
+
+  if (verbose)
+    message("Accumulating %zu contributions in the local slab took %.3f %s.",
+            nrecv, clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  free(recvbuf);
+  free(slab_owner);
+  free(sendcount);
+  free(recvcount);
+  free(sendoffset);
+  free(recvoffset);
+}
+
+/**
+ * @brief Sort function for mesh keys.
+ */
+static int mesh_cmp_keys(const void* a, const void* b) {
+  const size_t key_a = *(const size_t*)a;
+  const size_t key_b = *(const size_t*)b;
+  return (key_a > key_b) - (key_a < key_b);
+}
+
+/**
+ * @brief Threadpool mapper initialising and allocating the interpolation
+ * patch of each local top-level cell.
+ *
+ * @param map_data A chunk of the list of local cells.
+ * @param num The number of cells in the chunk.
+ * @param extra The #mesh_patch_mapper_data.
+ */
+static void mesh_init_potential_patch_mapper(void* map_data, int num,
+                                             void* extra) {
+
+  const struct mesh_patch_mapper_data* data =
+      (struct mesh_patch_mapper_data*)extra;
+  const int* local_cells = (const int*)map_data;
+  const size_t offset = local_cells - data->local_cells;
+
+  for (int n = 0; n < num; ++n) {
+
+    const struct cell* c = &data->cells[local_cells[n]];
+    struct pm_mesh_patch* patch = &data->patches[offset + n];
+
+    /* Cover the assignment stencil extended by the 5-point gradient */
+    pm_mesh_patch_init(patch, c, data->N, data->fac,
+                       pm_mesh_interpolation_pad_lo(data->order),
+                       pm_mesh_interpolation_pad_hi(data->order));
+    pm_mesh_patch_allocate(patch);
+  }
+}
+
+/**
+ * @brief Threadpool mapper filling the interpolation patches from the
+ * potential values received from the other ranks.
+ *
+ * @param map_data A chunk of the list of local cells.
+ * @param num The number of cells in the chunk.
+ * @param extra The #mesh_patch_mapper_data.
+ */
+static void mesh_fill_potential_patch_mapper(void* map_data, int num,
+                                             void* extra) {
+
+  const struct mesh_patch_mapper_data* data =
+      (struct mesh_patch_mapper_data*)extra;
+  const int* local_cells = (const int*)map_data;
+  const size_t offset = local_cells - data->local_cells;
+
+  for (int n = 0; n < num; ++n) {
+
+    struct pm_mesh_patch* patch = &data->patches[offset + n];
+
+    for (size_t ind = 0; ind < patch->volume; ++ind) {
+
+      const size_t key = pm_mesh_patch_global_index(patch, ind);
+      const size_t* found = (const size_t*)bsearch(
+          &key, data->keys, data->nr_keys, sizeof(size_t), mesh_cmp_keys);
+
+      if (found == NULL) error("Mesh key %zu was not fetched!", key);
+
+      patch->mesh[ind] = data->values[found - data->keys];
+    }
+  }
+}
+
+/**
+ * @brief Retrieve the values of the distributed potential mesh needed to
+ * interpolate the forces onto the local #gpart.
+ *
+ * One #pm_mesh_patch covering the interpolation stencil of all its particles
+ * is built for each local top-level cell. The list of (unique) mesh cells
+ * required is then requested from the ranks owning the relevant slabs.
+ *
+ * @param tp The #threadpool object used for parallelisation.
+ * @param s The #space containing the particles.
+ * @param N The side-length of the mesh.
+ * @param fac The conversion factor between box and mesh size.
+ * @param order The order of the interpolation scheme.
+ * @param pot_slab The (padded) local slab of the potential mesh.
+ * @param local_n0 The number of slices held by this rank.
+ * @param local_0_start The first slice held by this rank.
+ * @param patches (return) One patch per local top-level cell.
+ * @param verbose Are we talkative?
+ */
+void mpi_mesh_fetch_potential(struct threadpool* tp, const struct space* s,
+                              const int N, const double fac, const int order,
+                              const double* pot_slab, const int local_n0,
+                              const int local_0_start,
+                              struct pm_mesh_patch* patches,
+                              const int verbose) {
+
+  const int* local_cells = s->local_cells_top;
+  const int nr_local_cells = s->nr_local_cells;
+
+  int nr_nodes;
+  MPI_Comm_size(MPI_COMM_WORLD, &nr_nodes);
+
+  ticks tic = getticks();
+
+  /* Create the (empty) patches */
+  struct mesh_patch_mapper_data data;
+  data.cells = s->cells_top;
+  data.local_cells = local_cells;
+  data.patches = patches;
+  data.N = N;
+  data.fac = fac;
+  data.order = order;
+  data.keys = NULL;
+  data.values = NULL;
+  data.nr_keys = 0;
+
+  threadpool_map(tp, mesh_init_potential_patch_mapper, (void*)local_cells,
+                 nr_local_cells, sizeof(int), threadpool_auto_chunk_size,
+                 &data);
+
+  /* Collect the list of mesh cells we need */
+  size_t nr_keys = 0;
+  for (int n = 0; n < nr_local_cells; ++n) nr_keys += patches[n].volume;
+
+  size_t* keys = (size_t*)malloc(nr_keys * sizeof(size_t));
+  if (keys == NULL && nr_keys > 0) error("Failed to allocate mesh keys.");
+
+  size_t count = 0;
+  for (int n = 0; n < nr_local_cells; ++n)
+    for (size_t ind = 0; ind < patches[n].volume; ++ind)
+      keys[count++] = pm_mesh_patch_global_index(&patches[n], ind);
+
+  /* Sort them and remove the duplicates. Since the slabs are distributed in
+   * increasing order along x, this also groups the keys by owner. */
+  qsort(keys, nr_keys, sizeof(size_t), mesh_cmp_keys);
+  size_t nr_unique = 0;
+  for (size_t n = 0; n < nr_keys; ++n)
+    if (nr_unique == 0 || keys[n] != keys[nr_unique - 1])
+      keys[nr_unique++] = keys[n];
+  nr_keys = nr_unique;
+
+  if (verbose)
+    message("Building the list of %zu needed mesh cells took %.3f %s.",
+            nr_keys, clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  tic = getticks();
+
+  /* Count the requests going to each rank */
+  int* slab_owner = mesh_build_slab_owner(N, local_n0, local_0_start);
+  int* sendcount = (int*)calloc(nr_nodes, sizeof(int));
+  int* recvcount = (int*)malloc(nr_nodes * sizeof(int));
+  int* sendoffset = (int*)malloc(nr_nodes * sizeof(int));
+  int* recvoffset = (int*)malloc(nr_nodes * sizeof(int));
+  if (sendcount == NULL || recvcount == NULL || sendoffset == NULL ||
+      recvoffset == NULL)
+    error("Failed to allocate count arrays.");
+
+  for (size_t n = 0; n < nr_keys; ++n)
+    sendcount[mesh_key_owner(keys[n], N, slab_owner)]++;
+
+  const size_t nrecv = mesh_exchange_counts(nr_nodes, sendcount, recvcount,
+                                            sendoffset, recvoffset);
+
+  /* Send the requests */
+  size_t* requests = (size_t*)malloc(nrecv * sizeof(size_t));
+  if (requests == NULL && nrecv > 0)
+    error("Failed to allocate the mesh requests buffer.");
+
+  MPI_Datatype mesh_key_type;
+  if (MPI_Type_contiguous(sizeof(size_t), MPI_BYTE, &mesh_key_type) !=
+          MPI_SUCCESS ||
+      MPI_Type_commit(&mesh_key_type) != MPI_SUCCESS)
+    error("Failed to create MPI type for mesh keys.");
+
+  MPI_Alltoallv(keys, sendcount, sendoffset, mesh_key_type, requests,
+                recvcount, recvoffset, mesh_key_type, MPI_COMM_WORLD);
+
+  MPI_Type_free(&mesh_key_type);
+
+  /* Read the requested values from our slab */
+  double* replies = (double*)malloc(nrecv * sizeof(double));
+  double* values = (double*)malloc(nr_keys * sizeof(double));
+  if ((replies == NULL && nrecv > 0) || (values == NULL && nr_keys > 0))
+    error("Failed to allocate the mesh values buffers.");
+
+  for (size_t n = 0; n < nrecv; ++n)
+    replies[n] =
+        pot_slab[mesh_key_to_slab_index(requests[n], N, local_0_start)];
+
+  free(requests);
+
+  /* Send the values back (in the same order as they were requested) */
+  MPI_Alltoallv(replies, recvcount, recvoffset, MPI_DOUBLE, values, sendcount,
+                sendoffset, MPI_DOUBLE, MPI_COMM_WORLD);
+
+  free(replies);
+
+  if (verbose)
+    message("Fetching %zu potential values took %.3f %s.", nr_keys,
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  tic = getticks();
+
+  /* Finally, fill the patches */
+  data.keys = keys;
+  data.values = values;
+  data.nr_keys = nr_keys;
+  threadpool_map(tp, mesh_fill_potential_patch_mapper, (void*)local_cells,
+                 nr_local_cells, sizeof(int), threadpool_auto_chunk_size,
+                 &data);
+
+  if (verbose)
+    message("Filling the potential patches took %.3f %s.",
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  free(keys);
+  free(values);
+  free(slab_owner);
+  free(sendcount);
+  free(recvcount);
+  free(sendoffset);
+  free(recvoffset);
+}
+
+#else
+
+void mpi_mesh_accumulate_gparts_to_local_slab(
+    struct threadpool* tp, const struct space* s, const int N,
+    const double fac, const int order, double* rho_slab, const int local_n0,
+    const int local_0_start, const int verbose) {
+  error("FFTW MPI not found - unable to use distributed mesh");
+}
+
+void mpi_mesh_fetch_potential(struct threadpool* tp, const struct space* s,
+                              const int N, const double fac, const int order,
+                              const double* pot_slab, const int local_n0,
+                              const int local_0_start,
+                              struct pm_mesh_patch* patches,
+                              const int verbose) {
+  error("FFTW MPI not found - unable to use distributed mesh");
+}
+
+#endif
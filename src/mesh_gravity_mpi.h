@@ -0,0 +1,42 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#ifndef SWIFT_MESH_GRAVITY_MPI_H
+#define SWIFT_MESH_GRAVITY_MPI_H
+
+/* Config parameters. */
+#include "../config.h"
+
+/* Forward declarations */
+struct space;
+struct threadpool;
+struct pm_mesh_patch;
+
+void mpi_mesh_accumulate_gparts_to_local_slab(
+    struct threadpool* tp, const struct space* s, const int N,
+    const double fac, const int order, double* rho_slab, const int local_n0,
+    const int local_0_start, const int verbose);
+
+void mpi_mesh_fetch_potential(struct threadpool* tp, const struct space* s,
+                              const int N, const double fac, const int order,
+                              const double* pot_slab, const int local_n0,
+                              const int local_0_start,
+                              struct pm_mesh_patch* patches,
+                              const int verbose);
+
+#endif /* SWIFT_MESH_GRAVITY_MPI_H */
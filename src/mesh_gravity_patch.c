@@ -0,0 +1,186 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+/* Config parameters. */
+#include "../config.h"
+
+/* Some standard headers. */
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+#include <strings.h>
+
+/* This object's header. */
+#include "mesh_gravity_patch.h"
+
+/* Local includes. */
+#include "cell.h"
+#include "part.h"
+
+/**
+ * @brief Initialise the extent of a #pm_mesh_patch covering the #gpart of a
+ * #cell.
+ *
+ * The extent is computed from the (unwrapped) positions of the particles
+ * such that particles that have drifted out of their cell are still covered.
+ * The patch is then padded by pad_lo cells below and pad_hi cells above to
+ * accommodate the stencil of the assignment or interpolation scheme.
+ *
+ * No memory is allocated here, see pm_mesh_patch_allocate().
+ *
+ * @param patch The #pm_mesh_patch to initialise.
+ * @param c The #cell whose #gpart the patch must cover.
+ * @param N The side-length of the global mesh.
+ * @param fac The conversion factor between box and mesh size.
+ * @param pad_lo The number of padding cells below the particles' extent.
+ * @param pad_hi The number of padding cells above the particles' extent.
+ */
+void pm_mesh_patch_init(struct pm_mesh_patch *patch, const struct cell *c,
+                        const int N, const double fac, const int pad_lo,
+                        const int pad_hi) {
+
+  const int gcount = c->grav.count;
+  const struct gpart *gparts = c->grav.parts;
+
+  patch->N = N;
+  patch->fac = fac;
+  patch->mesh = NULL;
+
+  /* Extent of the particles in the cell */
+  int min_i[3] = {INT_MAX, INT_MAX, INT_MAX};
+  int max_i[3] = {INT_MIN, INT_MIN, INT_MIN};
+  for (int i = 0; i < gcount; ++i) {
+
+    const struct gpart *gp = &gparts[i];
+    if (gp->time_bin == time_bin_inhibited) continue;
+
+    for (int k = 0; k < 3; ++k) {
+      const int ind = (int)floor(fac * gp->x[k]);
+      if (ind < min_i[k]) min_i[k] = ind;
+      if (ind > max_i[k]) max_i[k] = ind;
+    }
+  }
+
+  /* Empty cell? */
+  if (min_i[0] > max_i[0]) {
+    for (int k = 0; k < 3; ++k) {
+      patch->mesh_min[k] = 0;
+      patch->mesh_max[k] = 0;
+      patch->mesh_size[k] = 0;
+    }
+    patch->volume = 0;
+    return;
+  }
+
+  for (int k = 0; k < 3; ++k) {
+    patch->mesh_min[k] = min_i[k] - pad_lo;
+    patch->mesh_max[k] = max_i[k] + pad_hi + 1;
+    patch->mesh_size[k] = patch->mesh_max[k] - patch->mesh_min[k];
+  }
+
+  patch->volume = (size_t)patch->mesh_size[0] * (size_t)patch->mesh_size[1] *
+                  (size_t)patch->mesh_size[2];
+}
+
+/**
+ * @brief Allocate the memory for the values of a #pm_mesh_patch.
+ *
+ * @param patch The #pm_mesh_patch (already initialised).
+ */
+void pm_mesh_patch_allocate(struct pm_mesh_patch *patch) {
+
+  if (patch->mesh != NULL) error("Patch already allocated!");
+  if (patch->volume == 0) return;
+
+  patch->mesh = (double *)malloc(patch->volume * sizeof(double));
+  if (patch->mesh == NULL) error("Failed to allocate mesh patch!");
+}
+
+/**
+ * @brief Set all the values of a #pm_mesh_patch to 0.
+ *
+ * @param patch The #pm_mesh_patch.
+ */
+void pm_mesh_patch_zero(struct pm_mesh_patch *patch) {
+
+  if (patch->volume == 0) return;
+  bzero(patch->mesh, patch->volume * sizeof(double));
+}
+
+/**
+ * @brief Free the memory associated with a #pm_mesh_patch.
+ *
+ * @param patch The #pm_mesh_patch.
+ */
+void pm_mesh_patch_clean(struct pm_mesh_patch *patch) {
+
+  free(patch->mesh);
+  bzero(patch, sizeof(struct pm_mesh_patch));
+}
+
+/**
+ * @brief Assign the #gpart of a #cell to a new #pm_mesh_patch covering them.
+ *
+ * The patch is private to the caller, so no atomics are needed.
+ *
+ * @param patch The #pm_mesh_patch to initialise, allocate and fill.
+ * @param c The #cell whose #gpart are assigned.
+ * @param N The side-length of the global mesh.
+ * @param fac The conversion factor between box and mesh size.
+ * @param order The order of the assignment scheme (2: CIC, 3: TSC, 4: PCS).
+ */
+void pm_mesh_patch_assign_cell(struct pm_mesh_patch *patch,
+                               const struct cell *c, const int N,
+                               const double fac, const int order) {
+
+  pm_mesh_patch_init(patch, c, N, fac, pm_mesh_assignment_pad_lo(order),
+                     pm_mesh_assignment_pad_hi(order));
+  pm_mesh_patch_allocate(patch);
+  pm_mesh_patch_zero(patch);
+
+  const int gcount = c->grav.count;
+  const struct gpart *gparts = c->grav.parts;
+  double *mesh = patch->mesh;
+
+  for (int p = 0; p < gcount; ++p) {
+
+    const struct gpart *gp = &gparts[p];
+    if (gp->time_bin == time_bin_inhibited) continue;
+
+    /* Weights along each axis (unwrapped coordinates) */
+    double wx[pm_mesh_assignment_max_order];
+    double wy[pm_mesh_assignment_max_order];
+    double wz[pm_mesh_assignment_max_order];
+    const int i = pm_mesh_assignment_weights(order, fac * gp->x[0], wx);
+    const int j = pm_mesh_assignment_weights(order, fac * gp->x[1], wy);
+    const int k = pm_mesh_assignment_weights(order, fac * gp->x[2], wz);
+
+    const double m = gp->mass;
+
+    for (int ii = 0; ii < order; ++ii) {
+      for (int jj = 0; jj < order; ++jj) {
+
+        /* The row along z is contiguous in the patch */
+        const size_t index = pm_mesh_patch_index(patch, i + ii, j + jj, k);
+        const double mxy = m * wx[ii] * wy[jj];
+        for (int kk = 0; kk < order; ++kk) mesh[index + kk] += mxy * wz[kk];
+      }
+    }
+  }
+}
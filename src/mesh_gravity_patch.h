@@ -0,0 +1,213 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#ifndef SWIFT_MESH_GRAVITY_PATCH_H
+#define SWIFT_MESH_GRAVITY_PATCH_H
+
+/* Config parameters. */
+#include "../config.h"
+
+/* Some standard headers. */
+#include <math.h>
+
+/* Local includes */
+#include "error.h"
+#include "inline.h"
+
+/* Forward declarations */
+struct cell;
+
+/*! Largest number of mesh cells along each axis touched by the assignment
+ * of a particle (PCS) */
+#define pm_mesh_assignment_max_order 4
+
+/*! Number of mesh cells below the one containing a particle touched by the
+ * assignment of a given order */
+#define pm_mesh_assignment_pad_lo(order) ((order) > 2 ? 1 : 0)
+
+/*! Number of mesh cells above the one containing a particle touched by the
+ * assignment of a given order */
+#define pm_mesh_assignment_pad_hi(order) ((order) > 2 ? 2 : 1)
+
+/*! Number of mesh cells below the one containing a particle needed to
+ * interpolate its force (assignment stencil + 5-point gradient) */
+#define pm_mesh_interpolation_pad_lo(order) \
+  (pm_mesh_assignment_pad_lo(order) + 2)
+
+/*! Number of mesh cells above the one containing a particle needed to
+ * interpolate its force (assignment stencil + 5-point gradient) */
+#define pm_mesh_interpolation_pad_hi(order) \
+  (pm_mesh_assignment_pad_hi(order) + 2)
+
+/*! Largest number of mesh cells along each axis needed to interpolate the
+ * force of a particle */
+#define pm_mesh_interpolation_max_size (pm_mesh_assignment_max_order + 4)
+
+/**
+ * @brief Dense local copy of the region of the global mesh overlapping with
+ * a #cell.
+ *
+ * The patch covers the mesh cells touched by the #gpart of the cell, padded
+ * by the extent of the assignment/interpolation stencil. Indices are stored
+ * unwrapped; periodic wrapping only happens when converting to the index in
+ * the global mesh.
+ */
+struct pm_mesh_patch {
+
+  /*! Side-length of the full mesh */
+  int N;
+
+  /*! Conversion factor between box and mesh size */
+  double fac;
+
+  /*! Index of the first mesh cell of the patch along each axis (unwrapped) */
+  int mesh_min[3];
+
+  /*! Index one past the last mesh cell of the patch along each axis */
+  int mesh_max[3];
+
+  /*! Number of mesh cells of the patch along each axis */
+  int mesh_size[3];
+
+  /*! Total number of mesh cells in the patch */
+  size_t volume;
+
+  /*! The values stored on the patch */
+  double *mesh;
+};
+
+void pm_mesh_patch_init(struct pm_mesh_patch *patch, const struct cell *c,
+                        const int N, const double fac, const int pad_lo,
+                        const int pad_hi);
+void pm_mesh_patch_allocate(struct pm_mesh_patch *patch);
+void pm_mesh_patch_zero(struct pm_mesh_patch *patch);
+void pm_mesh_patch_clean(struct pm_mesh_patch *patch);
+void pm_mesh_patch_assign_cell(struct pm_mesh_patch *patch,
+                               const struct cell *c, const int N,
+                               const double fac, const int order);
+
+/**
+ * @brief Compute the weights of the mesh cells touched by the assignment
+ * of a particle along one axis.
+ *
+ * The mesh points sit at integer positions. Order 2 is the cloud-in-cell
+ * (CIC), order 3 the triangular-shaped cloud (TSC) and order 4 the
+ * piecewise cubic spline (PCS) scheme. The weights sum to 1.
+ *
+ * @param order The order of the scheme (2, 3 or 4).
+ * @param u The position of the particle in units of mesh cells.
+ * @param w (return) The order weights of the consecutive mesh cells.
+ * @return The (unwrapped) index of the first mesh cell touched.
+ */
+__attribute__((always_inline)) INLINE static int pm_mesh_assignment_weights(
+    const int order, const double u, double w[pm_mesh_assignment_max_order]) {
+
+  switch (order) {
+
+    case 2: {
+      const int i = (int)floor(u);
+      const double d = u - i;
+      w[0] = 1. - d;
+      w[1] = d;
+      return i;
+    }
+
+    case 3: {
+      const int i = (int)floor(u + 0.5);
+      const double d = u - i;
+      w[0] = 0.5 * (0.5 - d) * (0.5 - d);
+      w[1] = 0.75 - d * d;
+      w[2] = 0.5 * (0.5 + d) * (0.5 + d);
+      return i - 1;
+    }
+
+    case 4: {
+      const int i = (int)floor(u);
+      const double d = u - i;
+      const double d2 = d * d;
+      const double d3 = d2 * d;
+      const double t = 1. - d;
+      w[0] = (1. / 6.) * t * t * t;
+      w[1] = (1. / 6.) * (4. - 6. * d2 + 3. * d3);
+      w[2] = (1. / 6.) * (1. + 3. * d + 3. * d2 - 3. * d3);
+      w[3] = (1. / 6.) * d3;
+      return i - 1;
+    }
+
+    default:
+      error("Invalid mesh assignment order %d", order);
+      return 0;
+  }
+}
+
+/**
+ * @brief Return the local index in a #pm_mesh_patch of a given (unwrapped)
+ * mesh cell.
+ *
+ * @param patch The #pm_mesh_patch.
+ * @param i The (unwrapped) index of the mesh cell along x.
+ * @param j The (unwrapped) index of the mesh cell along y.
+ * @param k The (unwrapped) index of the mesh cell along z.
+ */
+__attribute__((always_inline)) INLINE static size_t
+pm_mesh_patch_index(const struct pm_mesh_patch *patch, const int i,
+                    const int j, const int k) {
+
+#ifdef SWIFT_DEBUG_CHECKS
+  if (i < patch->mesh_min[0] || i >= patch->mesh_max[0] ||
+      j < patch->mesh_min[1] || j >= patch->mesh_max[1] ||
+      k < patch->mesh_min[2] || k >= patch->mesh_max[2])
+    error("Accessing mesh cell (%d, %d, %d) outside of the patch!", i, j, k);
+#endif
+
+  const size_t ii = i - patch->mesh_min[0];
+  const size_t jj = j - patch->mesh_min[1];
+  const size_t kk = k - patch->mesh_min[2];
+
+  return (ii * patch->mesh_size[1] + jj) * patch->mesh_size[2] + kk;
+}
+
+/**
+ * @brief Return the index in the global NxNxN row-major mesh of a given
+ * local patch index.
+ *
+ * @param patch The #pm_mesh_patch.
+ * @param index The index of the element in the patch.
+ */
+__attribute__((always_inline)) INLINE static size_t
+pm_mesh_patch_global_index(const struct pm_mesh_patch *patch,
+                           const size_t index) {
+
+  const int N = patch->N;
+  const size_t slice = (size_t)patch->mesh_size[1] * patch->mesh_size[2];
+
+  /* Unwrapped coordinates of this patch element */
+  const int i = patch->mesh_min[0] + (int)(index / slice);
+  const int j =
+      patch->mesh_min[1] + (int)((index % slice) / patch->mesh_size[2]);
+  const int k = patch->mesh_min[2] + (int)(index % patch->mesh_size[2]);
+
+  /* Wrap them */
+  const size_t iw = (size_t)(((i % N) + N) % N);
+  const size_t jw = (size_t)(((j % N) + N) % N);
+  const size_t kw = (size_t)(((k % N) + N) % N);
+
+  return (iw * N + jw) * N + kw;
+}
+
+#endif /* SWIFT_MESH_GRAVITY_PATCH_H */
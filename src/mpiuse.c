@@ -195,6 +195,7 @@ void mpiuse_log_dump(const char *filename, ticks stepticks) {
   /* Create the radix tree root node. */
   struct memuse_rnode *memuse_rnode_root =
       (struct memuse_rnode *)calloc(1, sizeof(struct memuse_rnode));
+  memuse_rnode_root->value = -1;
 
   /* Stop any new logs from being processed while we are dumping. */
   size_t log_count = mpiuse_log_count;
@@ -222,7 +223,7 @@ void mpiuse_log_dump(const char *filename, ticks stepticks) {
     struct memuse_rnode *child = memuse_rnode_find_child(
         memuse_rnode_root, 0, mpiuse_log[k].vptr, sizeof(uintptr_t));
 
-    if (child != NULL && child->ptr != NULL) {
+    if (child != NULL && child->value != -1) {
 
       /* Should be the handoff. Check that. */
       if (mpiuse_log[k].activation) {
@@ -240,7 +241,7 @@ void mpiuse_log_dump(const char *filename, ticks stepticks) {
       }
 
       /* Free, update the missing fields, size of request is removed. */
-      struct mpiuse_log_entry *oldlog = (struct mpiuse_log_entry *)child->ptr;
+      struct mpiuse_log_entry *oldlog = &mpiuse_log[child->value];
       mpiuse_log[k].size = -oldlog->size;
       mpiuse_log[k].otherrank = oldlog->otherrank;
       mpiuse_log[k].tag = oldlog->tag;
@@ -249,7 +250,7 @@ void mpiuse_log_dump(const char *filename, ticks stepticks) {
       mpiuse_log[k].acttic = mpiuse_log[k].tic - oldlog->tic;
 
       /* And deactivate this key. */
-      child->ptr = NULL;
+      child->value = -1;
 
       /* And mark this as handed off. */
       mpiuse_log[k].active = 0;
@@ -257,10 +258,10 @@ void mpiuse_log_dump(const char *filename, ticks stepticks) {
 
     } else if (child == NULL && mpiuse_log[k].activation) {
 
-      /* Not found, so new send/recv which we store the log against the
-       * address. */
+      /* Not found, so new send/recv which we store the log index against
+       * the address. */
       memuse_rnode_insert_child(memuse_rnode_root, 0, mpiuse_log[k].vptr,
-                                sizeof(uintptr_t), &mpiuse_log[k]);
+                                sizeof(uintptr_t), k);
 
     } else if (child == NULL && !mpiuse_log[k].activation) {
 
@@ -277,9 +278,9 @@ void mpiuse_log_dump(const char *filename, ticks stepticks) {
     } else if (mpiuse_log[k].activation) {
 
       /* Must be previously released request with the same address, so we
-       * store. */
+       * store the index. */
       memuse_rnode_insert_child(memuse_rnode_root, 0, mpiuse_log[k].vptr,
-                                sizeof(uintptr_t), &mpiuse_log[k]);
+                                sizeof(uintptr_t), k);
 
     } else {
       message("Weird MPI log record found: (%s/%s: %d->%d: %zd/%d/%d/%p)",
@@ -338,6 +339,7 @@ void mpiuse_log_dump(const char *filename, ticks stepticks) {
 
   /* Finished with the rnodes. */
   memuse_rnode_cleanup(memuse_rnode_root);
+  free(memuse_rnode_root);
 
   /* Clear the log. We expect this to clear step to step, unlike memory. */
   mpiuse_log_count = 0;
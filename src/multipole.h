@@ -517,11 +517,11 @@ __attribute__((nonnull)) INLINE static int gravity_multipole_equal(
   }
 
   /* Manhattan Norm of 0th order terms */
-  const float order0_norm = fabsf(ma->M_000) + fabsf(mb->M_000);
+  const float order0_norm = fabs(ma->M_000) + fabs(mb->M_000);
 
   /* Compare 0th order terms above 1% of norm */
-  if (fabsf(ma->M_000 + mb->M_000) > 0.01f * order0_norm &&
-      fabsf(ma->M_000 - mb->M_000) / fabsf(ma->M_000 + mb->M_000) > tolerance) {
+  if (fabs(ma->M_000 + mb->M_000) > 0.01f * order0_norm &&
+      fabs(ma->M_000 - mb->M_000) / fabs(ma->M_000 + mb->M_000) > tolerance) {
     message("M_000 term different");
     return 0;
   }
@@ -533,39 +533,39 @@ __attribute__((nonnull)) INLINE static int gravity_multipole_equal(
 #if SELF_GRAVITY_MULTIPOLE_ORDER > 1
   /* Manhattan Norm of 2nd order terms */
   const float order2_norm =
-      fabsf(ma->M_002) + fabsf(mb->M_002) + fabsf(ma->M_011) +
-      fabsf(mb->M_011) + fabsf(ma->M_020) + fabsf(mb->M_020) +
-      fabsf(ma->M_101) + fabsf(mb->M_101) + fabsf(ma->M_110) +
-      fabsf(mb->M_110) + fabsf(ma->M_200) + fabsf(mb->M_200);
+      fabs(ma->M_002) + fabs(mb->M_002) + fabs(ma->M_011) +
+      fabs(mb->M_011) + fabs(ma->M_020) + fabs(mb->M_020) +
+      fabs(ma->M_101) + fabs(mb->M_101) + fabs(ma->M_110) +
+      fabs(mb->M_110) + fabs(ma->M_200) + fabs(mb->M_200);
 
   /* Compare 2nd order terms above 1% of norm */
-  if (fabsf(ma->M_002 + mb->M_002) > 0.01f * order2_norm &&
-      fabsf(ma->M_002 - mb->M_002) / fabsf(ma->M_002 + mb->M_002) > tolerance) {
+  if (fabs(ma->M_002 + mb->M_002) > 0.01f * order2_norm &&
+      fabs(ma->M_002 - mb->M_002) / fabs(ma->M_002 + mb->M_002) > tolerance) {
     message("M_002 term different");
     return 0;
   }
-  if (fabsf(ma->M_011 + mb->M_011) > 0.01f * order2_norm &&
-      fabsf(ma->M_011 - mb->M_011) / fabsf(ma->M_011 + mb->M_011) > tolerance) {
+  if (fabs(ma->M_011 + mb->M_011) > 0.01f * order2_norm &&
+      fabs(ma->M_011 - mb->M_011) / fabs(ma->M_011 + mb->M_011) > tolerance) {
     message("M_011 term different");
     return 0;
   }
-  if (fabsf(ma->M_020 + mb->M_020) > 0.01f * order2_norm &&
-      fabsf(ma->M_020 - mb->M_020) / fabsf(ma->M_020 + mb->M_020) > tolerance) {
+  if (fabs(ma->M_020 + mb->M_020) > 0.01f * order2_norm &&
+      fabs(ma->M_020 - mb->M_020) / fabs(ma->M_020 + mb->M_020) > tolerance) {
     message("M_020 term different");
     return 0;
   }
-  if (fabsf(ma->M_101 + mb->M_101) > 0.01f * order2_norm &&
-      fabsf(ma->M_101 - mb->M_101) / fabsf(ma->M_101 + mb->M_101) > tolerance) {
+  if (fabs(ma->M_101 + mb->M_101) > 0.01f * order2_norm &&
+      fabs(ma->M_101 - mb->M_101) / fabs(ma->M_101 + mb->M_101) > tolerance) {
     message("M_101 term different");
     return 0;
   }
-  if (fabsf(ma->M_110 + mb->M_110) > 0.01f * order2_norm &&
-      fabsf(ma->M_110 - mb->M_110) / fabsf(ma->M_110 + mb->M_110) > tolerance) {
+  if (fabs(ma->M_110 + mb->M_110) > 0.01f * order2_norm &&
+      fabs(ma->M_110 - mb->M_110) / fabs(ma->M_110 + mb->M_110) > tolerance) {
     message("M_110 term different");
     return 0;
   }
-  if (fabsf(ma->M_200 + mb->M_200) > 0.01f * order2_norm &&
-      fabsf(ma->M_200 - mb->M_200) / fabsf(ma->M_200 + mb->M_200) > tolerance) {
+  if (fabs(ma->M_200 + mb->M_200) > 0.01f * order2_norm &&
+      fabs(ma->M_200 - mb->M_200) / fabs(ma->M_200 + mb->M_200) > tolerance) {
     message("M_200 term different");
     return 0;
   }
@@ -574,62 +574,62 @@ __attribute__((nonnull)) INLINE static int gravity_multipole_equal(
 #if SELF_GRAVITY_MULTIPOLE_ORDER > 2
   /* Manhattan Norm of 3rd order terms */
   const float order3_norm =
-      fabsf(ma->M_003) + fabsf(mb->M_003) + fabsf(ma->M_012) +
-      fabsf(mb->M_012) + fabsf(ma->M_021) + fabsf(mb->M_021) +
-      fabsf(ma->M_030) + fabsf(mb->M_030) + fabsf(ma->M_102) +
-      fabsf(mb->M_102) + fabsf(ma->M_111) + fabsf(mb->M_111) +
-      fabsf(ma->M_120) + fabsf(mb->M_120) + fabsf(ma->M_201) +
-      fabsf(mb->M_201) + fabsf(ma->M_210) + fabsf(mb->M_210) +
-      fabsf(ma->M_300) + fabsf(mb->M_300);
+      fabs(ma->M_003) + fabs(mb->M_003) + fabs(ma->M_012) +
+      fabs(mb->M_012) + fabs(ma->M_021) + fabs(mb->M_021) +
+      fabs(ma->M_030) + fabs(mb->M_030) + fabs(ma->M_102) +
+      fabs(mb->M_102) + fabs(ma->M_111) + fabs(mb->M_111) +
+      fabs(ma->M_120) + fabs(mb->M_120) + fabs(ma->M_201) +
+      fabs(mb->M_201) + fabs(ma->M_210) + fabs(mb->M_210) +
+      fabs(ma->M_300) + fabs(mb->M_300);
 
   /* Compare 3rd order terms above 1% of norm */
-  if (fabsf(ma->M_003 + mb->M_003) > 0.01f * order3_norm &&
-      fabsf(ma->M_003 - mb->M_003) / fabsf(ma->M_003 + mb->M_003) > tolerance) {
+  if (fabs(ma->M_003 + mb->M_003) > 0.01f * order3_norm &&
+      fabs(ma->M_003 - mb->M_003) / fabs(ma->M_003 + mb->M_003) > tolerance) {
     message("M_003 term different");
     return 0;
   }
-  if (fabsf(ma->M_012 + mb->M_012) > 0.01f * order3_norm &&
-      fabsf(ma->M_012 - mb->M_012) / fabsf(ma->M_012 + mb->M_012) > tolerance) {
+  if (fabs(ma->M_012 + mb->M_012) > 0.01f * order3_norm &&
+      fabs(ma->M_012 - mb->M_012) / fabs(ma->M_012 + mb->M_012) > tolerance) {
     message("M_012 term different");
     return 0;
   }
-  if (fabsf(ma->M_021 + mb->M_021) > 0.01f * order3_norm &&
-      fabsf(ma->M_021 - mb->M_021) / fabsf(ma->M_021 + mb->M_021) > tolerance) {
+  if (fabs(ma->M_021 + mb->M_021) > 0.01f * order3_norm &&
+      fabs(ma->M_021 - mb->M_021) / fabs(ma->M_021 + mb->M_021) > tolerance) {
     message("M_021 term different");
     return 0;
   }
-  if (fabsf(ma->M_030 + mb->M_030) > 0.01f * order3_norm &&
-      fabsf(ma->M_030 - mb->M_030) / fabsf(ma->M_030 + mb->M_030) > tolerance) {
+  if (fabs(ma->M_030 + mb->M_030) > 0.01f * order3_norm &&
+      fabs(ma->M_030 - mb->M_030) / fabs(ma->M_030 + mb->M_030) > tolerance) {
     message("M_030 term different");
     return 0;
   }
-  if (fabsf(ma->M_102 + mb->M_102) > 0.01f * order3_norm &&
-      fabsf(ma->M_102 - mb->M_102) / fabsf(ma->M_102 + mb->M_102) > tolerance) {
+  if (fabs(ma->M_102 + mb->M_102) > 0.01f * order3_norm &&
+      fabs(ma->M_102 - mb->M_102) / fabs(ma->M_102 + mb->M_102) > tolerance) {
     message("M_102 term different");
     return 0;
   }
-  if (fabsf(ma->M_111 + mb->M_111) > 0.01f * order3_norm &&
-      fabsf(ma->M_111 - mb->M_111) / fabsf(ma->M_111 + mb->M_111) > tolerance) {
+  if (fabs(ma->M_111 + mb->M_111) > 0.01f * order3_norm &&
+      fabs(ma->M_111 - mb->M_111) / fabs(ma->M_111 + mb->M_111) > tolerance) {
     message("M_111 term different");
     return 0;
   }
-  if (fabsf(ma->M_120 + mb->M_120) > 0.01f * order3_norm &&
-      fabsf(ma->M_120 - mb->M_120) / fabsf(ma->M_120 + mb->M_120) > tolerance) {
+  if (fabs(ma->M_120 + mb->M_120) > 0.01f * order3_norm &&
+      fabs(ma->M_120 - mb->M_120) / fabs(ma->M_120 + mb->M_120) > tolerance) {
     message("M_120 term different");
     return 0;
   }
-  if (fabsf(ma->M_201 + mb->M_201) > 0.01f * order3_norm &&
-      fabsf(ma->M_201 - mb->M_201) / fabsf(ma->M_201 + mb->M_201) > tolerance) {
+  if (fabs(ma->M_201 + mb->M_201) > 0.01f * order3_norm &&
+      fabs(ma->M_201 - mb->M_201) / fabs(ma->M_201 + mb->M_201) > tolerance) {
     message("M_201 term different");
     return 0;
   }
-  if (fabsf(ma->M_210 + mb->M_210) > 0.01f * order3_norm &&
-      fabsf(ma->M_210 - mb->M_210) / fabsf(ma->M_210 + mb->M_210) > tolerance) {
+  if (fabs(ma->M_210 + mb->M_210) > 0.01f * order3_norm &&
+      fabs(ma->M_210 - mb->M_210) / fabs(ma->M_210 + mb->M_210) > tolerance) {
     message("M_210 term different");
     return 0;
   }
-  if (fabsf(ma->M_300 + mb->M_300) > 0.01f * order3_norm &&
-      fabsf(ma->M_300 - mb->M_300) / fabsf(ma->M_300 + mb->M_300) > tolerance) {
+  if (fabs(ma->M_300 + mb->M_300) > 0.01f * order3_norm &&
+      fabs(ma->M_300 - mb->M_300) / fabs(ma->M_300 + mb->M_300) > tolerance) {
     message("M_300 term different");
     return 0;
   }
@@ -637,90 +637,90 @@ __attribute__((nonnull)) INLINE static int gravity_multipole_equal(
 #if SELF_GRAVITY_MULTIPOLE_ORDER > 3
   /* Manhattan Norm of 4th order terms */
   const float order4_norm =
-      fabsf(ma->M_004) + fabsf(mb->M_004) + fabsf(ma->M_013) +
-      fabsf(mb->M_013) + fabsf(ma->M_022) + fabsf(mb->M_022) +
-      fabsf(ma->M_031) + fabsf(mb->M_031) + fabsf(ma->M_040) +
-      fabsf(mb->M_040) + fabsf(ma->M_103) + fabsf(mb->M_103) +
-      fabsf(ma->M_112) + fabsf(mb->M_112) + fabsf(ma->M_121) +
-      fabsf(mb->M_121) + fabsf(ma->M_130) + fabsf(mb->M_130) +
-      fabsf(ma->M_202) + fabsf(mb->M_202) + fabsf(ma->M_211) +
-      fabsf(mb->M_211) + fabsf(ma->M_220) + fabsf(mb->M_220) +
-      fabsf(ma->M_301) + fabsf(mb->M_301) + fabsf(ma->M_310) +
-      fabsf(mb->M_310) + fabsf(ma->M_400) + fabsf(mb->M_400);
+      fabs(ma->M_004) + fabs(mb->M_004) + fabs(ma->M_013) +
+      fabs(mb->M_013) + fabs(ma->M_022) + fabs(mb->M_022) +
+      fabs(ma->M_031) + fabs(mb->M_031) + fabs(ma->M_040) +
+      fabs(mb->M_040) + fabs(ma->M_103) + fabs(mb->M_103) +
+      fabs(ma->M_112) + fabs(mb->M_112) + fabs(ma->M_121) +
+      fabs(mb->M_121) + fabs(ma->M_130) + fabs(mb->M_130) +
+      fabs(ma->M_202) + fabs(mb->M_202) + fabs(ma->M_211) +
+      fabs(mb->M_211) + fabs(ma->M_220) + fabs(mb->M_220) +
+      fabs(ma->M_301) + fabs(mb->M_301) + fabs(ma->M_310) +
+      fabs(mb->M_310) + fabs(ma->M_400) + fabs(mb->M_400);
 
   /* Compare 4th order terms above 1% of norm */
-  if (fabsf(ma->M_004 + mb->M_004) > 0.01f * order4_norm &&
-      fabsf(ma->M_004 - mb->M_004) / fabsf(ma->M_004 + mb->M_004) > tolerance) {
+  if (fabs(ma->M_004 + mb->M_004) > 0.01f * order4_norm &&
+      fabs(ma->M_004 - mb->M_004) / fabs(ma->M_004 + mb->M_004) > tolerance) {
     message("M_004 term different");
     return 0;
   }
-  if (fabsf(ma->M_013 + mb->M_013) > 0.01f * order4_norm &&
-      fabsf(ma->M_013 - mb->M_013) / fabsf(ma->M_013 + mb->M_013) > tolerance) {
+  if (fabs(ma->M_013 + mb->M_013) > 0.01f * order4_norm &&
+      fabs(ma->M_013 - mb->M_013) / fabs(ma->M_013 + mb->M_013) > tolerance) {
     message("M_013 term different");
     return 0;
   }
-  if (fabsf(ma->M_022 + mb->M_022) > 0.01f * order4_norm &&
-      fabsf(ma->M_022 - mb->M_022) / fabsf(ma->M_022 + mb->M_022) > tolerance) {
+  if (fabs(ma->M_022 + mb->M_022) > 0.01f * order4_norm &&
+      fabs(ma->M_022 - mb->M_022) / fabs(ma->M_022 + mb->M_022) > tolerance) {
     message("M_022 term different");
     return 0;
   }
-  if (fabsf(ma->M_031 + mb->M_031) > 0.01f * order4_norm &&
-      fabsf(ma->M_031 - mb->M_031) / fabsf(ma->M_031 + mb->M_031) > tolerance) {
+  if (fabs(ma->M_031 + mb->M_031) > 0.01f * order4_norm &&
+      fabs(ma->M_031 - mb->M_031) / fabs(ma->M_031 + mb->M_031) > tolerance) {
     message("M_031 term different");
     return 0;
   }
-  if (fabsf(ma->M_040 + mb->M_040) > 0.01f * order4_norm &&
-      fabsf(ma->M_040 - mb->M_040) / fabsf(ma->M_040 + mb->M_040) > tolerance) {
+  if (fabs(ma->M_040 + mb->M_040) > 0.01f * order4_norm &&
+      fabs(ma->M_040 - mb->M_040) / fabs(ma->M_040 + mb->M_040) > tolerance) {
     message("M_040 term different");
     return 0;
   }
-  if (fabsf(ma->M_103 + mb->M_103) > 0.01f * order4_norm &&
-      fabsf(ma->M_103 - mb->M_103) / fabsf(ma->M_103 + mb->M_103) > tolerance) {
+  if (fabs(ma->M_103 + mb->M_103) > 0.01f * order4_norm &&
+      fabs(ma->M_103 - mb->M_103) / fabs(ma->M_103 + mb->M_103) > tolerance) {
     message("M_103 term different");
     return 0;
   }
-  if (fabsf(ma->M_112 + mb->M_112) > 0.01f * order4_norm &&
-      fabsf(ma->M_112 - mb->M_112) / fabsf(ma->M_112 + mb->M_112) > tolerance) {
+  if (fabs(ma->M_112 + mb->M_112) > 0.01f * order4_norm &&
+      fabs(ma->M_112 - mb->M_112) / fabs(ma->M_112 + mb->M_112) > tolerance) {
     message("M_112 term different");
     return 0;
   }
-  if (fabsf(ma->M_121 + mb->M_121) > 0.01f * order4_norm &&
-      fabsf(ma->M_121 - mb->M_121) / fabsf(ma->M_121 + mb->M_121) > tolerance) {
+  if (fabs(ma->M_121 + mb->M_121) > 0.01f * order4_norm &&
+      fabs(ma->M_121 - mb->M_121) / fabs(ma->M_121 + mb->M_121) > tolerance) {
     message("M_121 term different");
     return 0;
   }
-  if (fabsf(ma->M_130 + mb->M_130) > 0.01f * order4_norm &&
-      fabsf(ma->M_130 - mb->M_130) / fabsf(ma->M_130 + mb->M_130) > tolerance) {
+  if (fabs(ma->M_130 + mb->M_130) > 0.01f * order4_norm &&
+      fabs(ma->M_130 - mb->M_130) / fabs(ma->M_130 + mb->M_130) > tolerance) {
     message("M_130 term different");
     return 0;
   }
-  if (fabsf(ma->M_202 + mb->M_202) > 0.01f * order4_norm &&
-      fabsf(ma->M_202 - mb->M_202) / fabsf(ma->M_202 + mb->M_202) > tolerance) {
+  if (fabs(ma->M_202 + mb->M_202) > 0.01f * order4_norm &&
+      fabs(ma->M_202 - mb->M_202) / fabs(ma->M_202 + mb->M_202) > tolerance) {
     message("M_202 term different");
     return 0;
   }
-  if (fabsf(ma->M_211 + mb->M_211) > 0.01f * order4_norm &&
-      fabsf(ma->M_211 - mb->M_211) / fabsf(ma->M_211 + mb->M_211) > tolerance) {
+  if (fabs(ma->M_211 + mb->M_211) > 0.01f * order4_norm &&
+      fabs(ma->M_211 - mb->M_211) / fabs(ma->M_211 + mb->M_211) > tolerance) {
     message("M_211 term different");
     return 0;
   }
-  if (fabsf(ma->M_220 + mb->M_220) > 0.01f * order4_norm &&
-      fabsf(ma->M_220 - mb->M_220) / fabsf(ma->M_220 + mb->M_220) > tolerance) {
+  if (fabs(ma->M_220 + mb->M_220) > 0.01f * order4_norm &&
+      fabs(ma->M_220 - mb->M_220) / fabs(ma->M_220 + mb->M_220) > tolerance) {
     message("M_220 term different");
     return 0;
   }
-  if (fabsf(ma->M_301 + mb->M_301) > 0.01f * order4_norm &&
-      fabsf(ma->M_301 - mb->M_301) / fabsf(ma->M_301 + mb->M_301) > tolerance) {
+  if (fabs(ma->M_301 + mb->M_301) > 0.01f * order4_norm &&
+      fabs(ma->M_301 - mb->M_301) / fabs(ma->M_301 + mb->M_301) > tolerance) {
     message("M_301 term different");
     return 0;
   }
-  if (fabsf(ma->M_310 + mb->M_310) > 0.01f * order4_norm &&
-      fabsf(ma->M_310 - mb->M_310) / fabsf(ma->M_310 + mb->M_310) > tolerance) {
+  if (fabs(ma->M_310 + mb->M_310) > 0.01f * order4_norm &&
+      fabs(ma->M_310 - mb->M_310) / fabs(ma->M_310 + mb->M_310) > tolerance) {
     message("M_310 term different");
     return 0;
   }
-  if (fabsf(ma->M_400 + mb->M_400) > 0.01f * order4_norm &&
-      fabsf(ma->M_400 - mb->M_400) / fabsf(ma->M_400 + mb->M_400) > tolerance) {
+  if (fabs(ma->M_400 + mb->M_400) > 0.01f * order4_norm &&
+      fabs(ma->M_400 - mb->M_400) / fabs(ma->M_400 + mb->M_400) > tolerance) {
     message("M_400 term different");
     return 0;
   }
@@ -728,124 +728,124 @@ __attribute__((nonnull)) INLINE static int gravity_multipole_equal(
 #if SELF_GRAVITY_MULTIPOLE_ORDER > 4
   /* Manhattan Norm of 5th order terms */
   const float order5_norm =
-      fabsf(ma->M_005) + fabsf(mb->M_005) + fabsf(ma->M_014) +
-      fabsf(mb->M_014) + fabsf(ma->M_023) + fabsf(mb->M_023) +
-      fabsf(ma->M_032) + fabsf(mb->M_032) + fabsf(ma->M_041) +
-      fabsf(mb->M_041) + fabsf(ma->M_050) + fabsf(mb->M_050) +
-      fabsf(ma->M_104) + fabsf(mb->M_104) + fabsf(ma->M_113) +
-      fabsf(mb->M_113) + fabsf(ma->M_122) + fabsf(mb->M_122) +
-      fabsf(ma->M_131) + fabsf(mb->M_131) + fabsf(ma->M_140) +
-      fabsf(mb->M_140) + fabsf(ma->M_203) + fabsf(mb->M_203) +
-      fabsf(ma->M_212) + fabsf(mb->M_212) + fabsf(ma->M_221) +
-      fabsf(mb->M_221) + fabsf(ma->M_230) + fabsf(mb->M_230) +
-      fabsf(ma->M_302) + fabsf(mb->M_302) + fabsf(ma->M_311) +
-      fabsf(mb->M_311) + fabsf(ma->M_320) + fabsf(mb->M_320) +
-      fabsf(ma->M_401) + fabsf(mb->M_401) + fabsf(ma->M_410) +
-      fabsf(mb->M_410) + fabsf(ma->M_500) + fabsf(mb->M_500);
+      fabs(ma->M_005) + fabs(mb->M_005) + fabs(ma->M_014) +
+      fabs(mb->M_014) + fabs(ma->M_023) + fabs(mb->M_023) +
+      fabs(ma->M_032) + fabs(mb->M_032) + fabs(ma->M_041) +
+      fabs(mb->M_041) + fabs(ma->M_050) + fabs(mb->M_050) +
+      fabs(ma->M_104) + fabs(mb->M_104) + fabs(ma->M_113) +
+      fabs(mb->M_113) + fabs(ma->M_122) + fabs(mb->M_122) +
+      fabs(ma->M_131) + fabs(mb->M_131) + fabs(ma->M_140) +
+      fabs(mb->M_140) + fabs(ma->M_203) + fabs(mb->M_203) +
+      fabs(ma->M_212) + fabs(mb->M_212) + fabs(ma->M_221) +
+      fabs(mb->M_221) + fabs(ma->M_230) + fabs(mb->M_230) +
+      fabs(ma->M_302) + fabs(mb->M_302) + fabs(ma->M_311) +
+      fabs(mb->M_311) + fabs(ma->M_320) + fabs(mb->M_320) +
+      fabs(ma->M_401) + fabs(mb->M_401) + fabs(ma->M_410) +
+      fabs(mb->M_410) + fabs(ma->M_500) + fabs(mb->M_500);
 
   /* Compare 5th order terms above 1% of norm */
-  if (fabsf(ma->M_005 + mb->M_005) > 0.01f * order5_norm &&
-      fabsf(ma->M_005 - mb->M_005) / fabsf(ma->M_005 + mb->M_005) > tolerance) {
+  if (fabs(ma->M_005 + mb->M_005) > 0.01f * order5_norm &&
+      fabs(ma->M_005 - mb->M_005) / fabs(ma->M_005 + mb->M_005) > tolerance) {
     message("M_005 term different");
     return 0;
   }
-  if (fabsf(ma->M_014 + mb->M_014) > 0.01f * order5_norm &&
-      fabsf(ma->M_014 - mb->M_014) / fabsf(ma->M_014 + mb->M_014) > tolerance) {
+  if (fabs(ma->M_014 + mb->M_014) > 0.01f * order5_norm &&
+      fabs(ma->M_014 - mb->M_014) / fabs(ma->M_014 + mb->M_014) > tolerance) {
     message("M_014 term different");
     return 0;
   }
-  if (fabsf(ma->M_023 + mb->M_023) > 0.01f * order5_norm &&
-      fabsf(ma->M_023 - mb->M_023) / fabsf(ma->M_023 + mb->M_023) > tolerance) {
+  if (fabs(ma->M_023 + mb->M_023) > 0.01f * order5_norm &&
+      fabs(ma->M_023 - mb->M_023) / fabs(ma->M_023 + mb->M_023) > tolerance) {
     message("M_023 term different");
     return 0;
   }
-  if (fabsf(ma->M_032 + mb->M_032) > 0.01f * order5_norm &&
-      fabsf(ma->M_032 - mb->M_032) / fabsf(ma->M_032 + mb->M_032) > tolerance) {
+  if (fabs(ma->M_032 + mb->M_032) > 0.01f * order5_norm &&
+      fabs(ma->M_032 - mb->M_032) / fabs(ma->M_032 + mb->M_032) > tolerance) {
     message("M_032 term different");
     return 0;
   }
-  if (fabsf(ma->M_041 + mb->M_041) > 0.01f * order5_norm &&
-      fabsf(ma->M_041 - mb->M_041) / fabsf(ma->M_041 + mb->M_041) > tolerance) {
+  if (fabs(ma->M_041 + mb->M_041) > 0.01f * order5_norm &&
+      fabs(ma->M_041 - mb->M_041) / fabs(ma->M_041 + mb->M_041) > tolerance) {
     message("M_041 term different");
     return 0;
   }
-  if (fabsf(ma->M_050 + mb->M_050) > 0.01f * order5_norm &&
-      fabsf(ma->M_050 - mb->M_050) / fabsf(ma->M_050 + mb->M_050) > tolerance) {
+  if (fabs(ma->M_050 + mb->M_050) > 0.01f * order5_norm &&
+      fabs(ma->M_050 - mb->M_050) / fabs(ma->M_050 + mb->M_050) > tolerance) {
     message("M_050 term different");
     return 0;
   }
-  if (fabsf(ma->M_104 + mb->M_104) > 0.01f * order5_norm &&
-      fabsf(ma->M_104 - mb->M_104) / fabsf(ma->M_104 + mb->M_104) > tolerance) {
+  if (fabs(ma->M_104 + mb->M_104) > 0.01f * order5_norm &&
+      fabs(ma->M_104 - mb->M_104) / fabs(ma->M_104 + mb->M_104) > tolerance) {
     message("M_104 term different");
     return 0;
   }
-  if (fabsf(ma->M_113 + mb->M_113) > 0.01f * order5_norm &&
-      fabsf(ma->M_113 - mb->M_113) / fabsf(ma->M_113 + mb->M_113) > tolerance) {
+  if (fabs(ma->M_113 + mb->M_113) > 0.01f * order5_norm &&
+      fabs(ma->M_113 - mb->M_113) / fabs(ma->M_113 + mb->M_113) > tolerance) {
     message("M_113 term different");
     return 0;
   }
-  if (fabsf(ma->M_122 + mb->M_122) > 0.01f * order5_norm &&
-      fabsf(ma->M_122 - mb->M_122) / fabsf(ma->M_122 + mb->M_122) > tolerance) {
+  if (fabs(ma->M_122 + mb->M_122) > 0.01f * order5_norm &&
+      fabs(ma->M_122 - mb->M_122) / fabs(ma->M_122 + mb->M_122) > tolerance) {
     message("M_122 term different");
     return 0;
   }
-  if (fabsf(ma->M_131 + mb->M_131) > 0.01f * order5_norm &&
-      fabsf(ma->M_131 - mb->M_131) / fabsf(ma->M_131 + mb->M_131) > tolerance) {
+  if (fabs(ma->M_131 + mb->M_131) > 0.01f * order5_norm &&
+      fabs(ma->M_131 - mb->M_131) / fabs(ma->M_131 + mb->M_131) > tolerance) {
     message("M_131 term different");
     return 0;
   }
-  if (fabsf(ma->M_140 + mb->M_140) > 0.01f * order5_norm &&
-      fabsf(ma->M_140 - mb->M_140) / fabsf(ma->M_140 + mb->M_140) > tolerance) {
+  if (fabs(ma->M_140 + mb->M_140) > 0.01f * order5_norm &&
+      fabs(ma->M_140 - mb->M_140) / fabs(ma->M_140 + mb->M_140) > tolerance) {
     message("M_140 term different");
     return 0;
   }
-  if (fabsf(ma->M_203 + mb->M_203) > 0.01f * order5_norm &&
-      fabsf(ma->M_203 - mb->M_203) / fabsf(ma->M_203 + mb->M_203) > tolerance) {
+  if (fabs(ma->M_203 + mb->M_203) > 0.01f * order5_norm &&
+      fabs(ma->M_203 - mb->M_203) / fabs(ma->M_203 + mb->M_203) > tolerance) {
     message("M_203 term different");
     return 0;
   }
-  if (fabsf(ma->M_212 + mb->M_212) > 0.01f * order5_norm &&
-      fabsf(ma->M_212 - mb->M_212) / fabsf(ma->M_212 + mb->M_212) > tolerance) {
+  if (fabs(ma->M_212 + mb->M_212) > 0.01f * order5_norm &&
+      fabs(ma->M_212 - mb->M_212) / fabs(ma->M_212 + mb->M_212) > tolerance) {
     message("M_212 term different");
     return 0;
   }
-  if (fabsf(ma->M_221 + mb->M_221) > 0.01f * order5_norm &&
-      fabsf(ma->M_221 - mb->M_221) / fabsf(ma->M_221 + mb->M_221) > tolerance) {
+  if (fabs(ma->M_221 + mb->M_221) > 0.01f * order5_norm &&
+      fabs(ma->M_221 - mb->M_221) / fabs(ma->M_221 + mb->M_221) > tolerance) {
     message("M_221 term different");
     return 0;
   }
-  if (fabsf(ma->M_230 + mb->M_230) > 0.01f * order5_norm &&
-      fabsf(ma->M_230 - mb->M_230) / fabsf(ma->M_230 + mb->M_230) > tolerance) {
+  if (fabs(ma->M_230 + mb->M_230) > 0.01f * order5_norm &&
+      fabs(ma->M_230 - mb->M_230) / fabs(ma->M_230 + mb->M_230) > tolerance) {
     message("M_230 term different");
     return 0;
   }
-  if (fabsf(ma->M_302 + mb->M_302) > 0.01f * order5_norm &&
-      fabsf(ma->M_302 - mb->M_302) / fabsf(ma->M_302 + mb->M_302) > tolerance) {
+  if (fabs(ma->M_302 + mb->M_302) > 0.01f * order5_norm &&
+      fabs(ma->M_302 - mb->M_302) / fabs(ma->M_302 + mb->M_302) > tolerance) {
     message("M_302 term different");
     return 0;
   }
-  if (fabsf(ma->M_311 + mb->M_311) > 0.01f * order5_norm &&
-      fabsf(ma->M_311 - mb->M_311) / fabsf(ma->M_311 + mb->M_311) > tolerance) {
+  if (fabs(ma->M_311 + mb->M_311) > 0.01f * order5_norm &&
+      fabs(ma->M_311 - mb->M_311) / fabs(ma->M_311 + mb->M_311) > tolerance) {
     message("M_311 term different");
     return 0;
   }
-  if (fabsf(ma->M_320 + mb->M_320) > 0.01f * order5_norm &&
-      fabsf(ma->M_320 - mb->M_320) / fabsf(ma->M_320 + mb->M_320) > tolerance) {
+  if (fabs(ma->M_320 + mb->M_320) > 0.01f * order5_norm &&
+      fabs(ma->M_320 - mb->M_320) / fabs(ma->M_320 + mb->M_320) > tolerance) {
     message("M_320 term different");
     return 0;
   }
-  if (fabsf(ma->M_401 + mb->M_401) > 0.01f * order5_norm &&
-      fabsf(ma->M_401 - mb->M_401) / fabsf(ma->M_401 + mb->M_401) > tolerance) {
+  if (fabs(ma->M_401 + mb->M_401) > 0.01f * order5_norm &&
+      fabs(ma->M_401 - mb->M_401) / fabs(ma->M_401 + mb->M_401) > tolerance) {
     message("M_401 term different");
     return 0;
   }
-  if (fabsf(ma->M_410 + mb->M_410) > 0.01f * order5_norm &&
-      fabsf(ma->M_410 - mb->M_410) / fabsf(ma->M_410 + mb->M_410) > tolerance) {
+  if (fabs(ma->M_410 + mb->M_410) > 0.01f * order5_norm &&
+      fabs(ma->M_410 - mb->M_410) / fabs(ma->M_410 + mb->M_410) > tolerance) {
     message("M_410 term different");
     return 0;
   }
-  if (fabsf(ma->M_500 + mb->M_500) > 0.01f * order5_norm &&
-      fabsf(ma->M_500 - mb->M_500) / fabsf(ma->M_500 + mb->M_500) > tolerance) {
+  if (fabs(ma->M_500 + mb->M_500) > 0.01f * order5_norm &&
+      fabs(ma->M_500 - mb->M_500) / fabs(ma->M_500 + mb->M_500) > tolerance) {
     message("M_500 term different");
     return 0;
   }
@@ -1585,37 +1585,20 @@ __attribute__((nonnull)) INLINE static void gravity_M2M(
 }
 
 /**
- * @brief Compute the field tensors due to a multipole.
+ * @brief Add the field tensors due to a multipole, without any of the
+ * book-keeping of gravity_M2L_apply().
  *
- * Corresponds to equation (28b).
+ * Corresponds to equation (28b). Only does arithmetic such that it can be
+ * inlined in loops vectorized over many multipoles.
  *
- * @param l_b The field tensor to compute.
+ * @param l_b The field tensor to add to.
  * @param m_a The multipole creating the field.
  * @param pot The derivatives of the potential.
  */
-__attribute__((nonnull)) INLINE static void gravity_M2L_apply(
+__attribute__((always_inline, nonnull)) INLINE static void gravity_M2L_add(
     struct grav_tensor *restrict l_b, const struct multipole *restrict m_a,
     const struct potential_derivatives_M2L *pot) {
 
-#ifdef SWIFT_DEBUG_CHECKS
-  /* Count all interactions
-   * Note that despite being in a section of the code protected by locks,
-   * we must use atomics here as the long-range task may update this
-   * counter in a lock-free section of code. */
-  accumulate_add_ll(&l_b->num_interacted, m_a->num_gpart);
-#endif
-
-#ifdef SWIFT_GRAVITY_FORCE_CHECKS
-  /* Count tree interactions
-   * Note that despite being in a section of the code protected by locks,
-   * we must use atomics here as the long-range task may update this
-   * counter in a lock-free section of code. */
-  accumulate_add_ll(&l_b->num_interacted_tree, m_a->num_gpart);
-#endif
-
-  /* Record that this tensor has received contributions */
-  l_b->interacted = 1;
-
   const float M_000 = m_a->M_000;
   const float D_000 = pot->D_000;
 
@@ -1985,6 +1968,41 @@ __attribute__((nonnull)) INLINE static void gravity_M2L_apply(
 #endif
 }
 
+/**
+ * @brief Compute the field tensors due to a multipole.
+ *
+ * Corresponds to equation (28b).
+ *
+ * @param l_b The field tensor to compute.
+ * @param m_a The multipole creating the field.
+ * @param pot The derivatives of the potential.
+ */
+__attribute__((nonnull)) INLINE static void gravity_M2L_apply(
+    struct grav_tensor *restrict l_b, const struct multipole *restrict m_a,
+    const struct potential_derivatives_M2L *pot) {
+
+#ifdef SWIFT_DEBUG_CHECKS
+  /* Count all interactions
+   * Note that despite being in a section of the code protected by locks,
+   * we must use atomics here as the long-range task may update this
+   * counter in a lock-free section of code. */
+  accumulate_add_ll(&l_b->num_interacted, m_a->num_gpart);
+#endif
+
+#ifdef SWIFT_GRAVITY_FORCE_CHECKS
+  /* Count tree interactions
+   * Note that despite being in a section of the code protected by locks,
+   * we must use atomics here as the long-range task may update this
+   * counter in a lock-free section of code. */
+  accumulate_add_ll(&l_b->num_interacted_tree, m_a->num_gpart);
+#endif
+
+  /* Record that this tensor has received contributions */
+  l_b->interacted = 1;
+
+  gravity_M2L_add(l_b, m_a, pot);
+}
+
 /**
  * @brief Compute the field tensor due to a multipole.
  *
@@ -197,15 +197,20 @@ __attribute__((nonnull, pure)) INLINE static int gravity_M2L_accept_symmetric(
  *
  * We use the MAC of Dehnen 2014 eq. 16.
  *
+ * This version takes the properties of the particle as arguments.
+ *
  * @param props The properties of the gravity scheme.
- * @param pa The particle we want to compute forces for (sink)
+ * @param softening The softening length of the particle (sink).
+ * @param old_a_grav The norm of the acceleration of the particle at the
+ * previous step.
  * @param B The gravity tensors that act as a source.
  * @param r2 The square of the distance between pa and the centres of mass of B.
  * @param periodic Are we using periodic BCs?
  */
-__attribute__((nonnull, pure)) INLINE static int gravity_M2P_accept(
-    const struct gravity_props *props, const struct gpart *pa,
-    const struct gravity_tensors *B, const float r2, const int periodic) {
+__attribute__((nonnull, pure)) INLINE static int gravity_M2P_accept_values(
+    const struct gravity_props *props, const float softening,
+    const float old_a_grav, const struct gravity_tensors *B, const float r2,
+    const int periodic) {
 
   /* Order of the expansion */
   const int p = SELF_GRAVITY_MULTIPOLE_ORDER;
@@ -214,8 +219,7 @@ __attribute__((nonnull, pure)) INLINE static int gravity_M2P_accept(
   const float rho_B = B->r_max;
 
   /* Get the maximal softening */
-  const float max_softening =
-      max(B->m_pole.max_softening, gravity_get_softening(pa, props));
+  const float max_softening = max(B->m_pole.max_softening, softening);
 
 #ifdef SWIFT_DEBUG_CHECKS
   if (rho_B == 0.) error("Size of multipole B is 0!");
@@ -238,9 +242,6 @@ __attribute__((nonnull, pure)) INLINE static int gravity_M2P_accept(
     f_MAC_inv = r2;
   }
 
-  /* Get the estimate of the acceleration */
-  const float old_a_grav = pa->old_a_grav_norm;
-
   /* Get the relative tolerance */
   const float eps = props->adaptive_tolerance;
 
@@ -282,4 +283,24 @@ __attribute__((nonnull, pure)) INLINE static int gravity_M2P_accept(
   }
 }
 
+/**
+ * @brief Checks whether The multipole in B can be used to update the particle
+ * pa
+ *
+ * We use the MAC of Dehnen 2014 eq. 16.
+ *
+ * @param props The properties of the gravity scheme.
+ * @param pa The particle we want to compute forces for (sink)
+ * @param B The gravity tensors that act as a source.
+ * @param r2 The square of the distance between pa and the centres of mass of B.
+ * @param periodic Are we using periodic BCs?
+ */
+__attribute__((nonnull, pure)) INLINE static int gravity_M2P_accept(
+    const struct gravity_props *props, const struct gpart *pa,
+    const struct gravity_tensors *B, const float r2, const int periodic) {
+
+  return gravity_M2P_accept_values(props, gravity_get_softening(pa, props),
+                                   pa->old_a_grav_norm, B, r2, periodic);
+}
+
 #endif /* SWIFT_MULTIPOLE_ACCEPT_H */
@@ -30,54 +30,66 @@
  */
 #define multipole_align 128
 
+/**
+ * @brief Type of the components of the multipoles and field tensors.
+ *
+ * In double precision, the M2M, M2L, L2L and L2P operations accumulate their
+ * contributions in double as well.
+ */
+#ifdef SWIFT_GRAVITY_DOUBLE_TENSORS
+typedef double grav_float_t;
+#else
+typedef float grav_float_t;
+#endif
+
 /**
  * @brief Field tensor components at the location of the multipole.
  */
 struct grav_tensor {
 
   /* 0th order terms */
-  float F_000;
+  grav_float_t F_000;
 
 #if SELF_GRAVITY_MULTIPOLE_ORDER > 0
 
   /* 1st order terms */
-  float F_100, F_010, F_001;
+  grav_float_t F_100, F_010, F_001;
 #endif
 #if SELF_GRAVITY_MULTIPOLE_ORDER > 1
 
   /* 2nd order terms */
-  float F_200, F_020, F_002;
-  float F_110, F_101, F_011;
+  grav_float_t F_200, F_020, F_002;
+  grav_float_t F_110, F_101, F_011;
 #endif
 #if SELF_GRAVITY_MULTIPOLE_ORDER > 2
 
   /* 3rd order terms */
-  float F_300, F_030, F_003;
-  float F_210, F_201;
-  float F_120, F_021;
-  float F_102, F_012;
-  float F_111;
+  grav_float_t F_300, F_030, F_003;
+  grav_float_t F_210, F_201;
+  grav_float_t F_120, F_021;
+  grav_float_t F_102, F_012;
+  grav_float_t F_111;
 #endif
 #if SELF_GRAVITY_MULTIPOLE_ORDER > 3
 
   /* 4th order terms */
-  float F_400, F_040, F_004;
-  float F_310, F_301;
-  float F_130, F_031;
-  float F_103, F_013;
-  float F_220, F_202, F_022;
-  float F_211, F_121, F_112;
+  grav_float_t F_400, F_040, F_004;
+  grav_float_t F_310, F_301;
+  grav_float_t F_130, F_031;
+  grav_float_t F_103, F_013;
+  grav_float_t F_220, F_202, F_022;
+  grav_float_t F_211, F_121, F_112;
 #endif
 #if SELF_GRAVITY_MULTIPOLE_ORDER > 4
 
   /* 5th order terms */
-  float F_005, F_014, F_023;
-  float F_032, F_041, F_050;
-  float F_104, F_113, F_122;
-  float F_131, F_140, F_203;
-  float F_212, F_221, F_230;
-  float F_302, F_311, F_320;
-  float F_401, F_410, F_500;
+  grav_float_t F_005, F_014, F_023;
+  grav_float_t F_032, F_041, F_050;
+  grav_float_t F_104, F_113, F_122;
+  grav_float_t F_131, F_140, F_203;
+  grav_float_t F_212, F_221, F_230;
+  grav_float_t F_302, F_311, F_320;
+  grav_float_t F_401, F_410, F_500;
 #endif
 #if SELF_GRAVITY_MULTIPOLE_ORDER > 5
 #error "Missing implementation for order >5"
@@ -128,50 +140,50 @@ struct multipole {
   float power[SELF_GRAVITY_MULTIPOLE_ORDER + 1];
 
   /* 0th order term */
-  float M_000;
+  grav_float_t M_000;
 
 #if SELF_GRAVITY_MULTIPOLE_ORDER > 0
 
   /* 1st order terms (all 0 since we expand around CoM) */
-  // float M_100, M_010, M_001;
+  // grav_float_t M_100, M_010, M_001;
 
 #endif
 #if SELF_GRAVITY_MULTIPOLE_ORDER > 1
 
   /* 2nd order terms */
-  float M_200, M_020, M_002;
-  float M_110, M_101, M_011;
+  grav_float_t M_200, M_020, M_002;
+  grav_float_t M_110, M_101, M_011;
 
 #endif
 #if SELF_GRAVITY_MULTIPOLE_ORDER > 2
 
   /* 3rd order terms */
-  float M_300, M_030, M_003;
-  float M_210, M_201;
-  float M_120, M_021;
-  float M_102, M_012;
-  float M_111;
+  grav_float_t M_300, M_030, M_003;
+  grav_float_t M_210, M_201;
+  grav_float_t M_120, M_021;
+  grav_float_t M_102, M_012;
+  grav_float_t M_111;
 #endif
 #if SELF_GRAVITY_MULTIPOLE_ORDER > 3
 
   /* 4th order terms */
-  float M_400, M_040, M_004;
-  float M_310, M_301;
-  float M_130, M_031;
-  float M_103, M_013;
-  float M_220, M_202, M_022;
-  float M_211, M_121, M_112;
+  grav_float_t M_400, M_040, M_004;
+  grav_float_t M_310, M_301;
+  grav_float_t M_130, M_031;
+  grav_float_t M_103, M_013;
+  grav_float_t M_220, M_202, M_022;
+  grav_float_t M_211, M_121, M_112;
 #endif
 #if SELF_GRAVITY_MULTIPOLE_ORDER > 4
 
   /* 5th order terms */
-  float M_005, M_014, M_023;
-  float M_032, M_041, M_050;
-  float M_104, M_113, M_122;
-  float M_131, M_140, M_203;
-  float M_212, M_221, M_230;
-  float M_302, M_311, M_320;
-  float M_401, M_410, M_500;
+  grav_float_t M_005, M_014, M_023;
+  grav_float_t M_032, M_041, M_050;
+  grav_float_t M_104, M_113, M_122;
+  grav_float_t M_131, M_140, M_203;
+  grav_float_t M_212, M_221, M_230;
+  grav_float_t M_302, M_311, M_320;
+  grav_float_t M_401, M_410, M_500;
 #endif
 #if SELF_GRAVITY_MULTIPOLE_ORDER > 5
 #error "Missing implementation for order >5"
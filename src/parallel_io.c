@@ -49,6 +49,7 @@
 #include "gravity_properties.h"
 #include "hydro_io.h"
 #include "hydro_properties.h"
+#include "io_async.h"
 #include "io_properties.h"
 #include "memuse.h"
 #include "output_list.h"
@@ -499,51 +500,19 @@ void prepare_array_parallel(
 }
 
 /**
- * @brief Writes a chunk of data in an open HDF5 dataset
+ * @brief Writes a chunk of data already converted to the snapshot units in an
+ * open HDF5 dataset
  *
- * @param e The #engine we are writing from.
  * @param h_data The HDF5 dataset to write to.
  * @param props The #io_props of the field to write.
  * @param N The number of particles to write.
  * @param offset Offset in the array where this mpi task starts writing.
- * @param internal_units The #unit_system used internally.
- * @param snapshot_units The #unit_system used in the snapshots.
+ * @param temp The buffer containing the converted data.
  */
-void write_array_parallel_chunk(struct engine* e, hid_t h_data,
-                                const struct io_props props, size_t N,
-                                long long offset,
-                                const struct unit_system* internal_units,
-                                const struct unit_system* snapshot_units) {
-
-  const size_t typeSize = io_sizeof_type(props.type);
-  const size_t num_elements = N * props.dimension;
-
-  /* Can't handle writes of more than 2GB */
-  if (N * props.dimension * typeSize > HDF5_PARALLEL_IO_MAX_BYTES)
-    error("Dataset too large to be written in one pass!");
-
-  /* message("Writing '%s' array...", props.name); */
-
-  /* Allocate temporary buffer */
-  void* temp = NULL;
-  if (swift_memalign("writebuff", (void**)&temp, IO_BUFFER_ALIGNMENT,
-                     num_elements * typeSize) != 0)
-    error("Unable to allocate temporary i/o buffer");
-
-#ifdef IO_SPEED_MEASUREMENT
-  MPI_Barrier(MPI_COMM_WORLD);
-  ticks tic = getticks();
-#endif
-
-  /* Copy the particle data to the temporary buffer */
-  io_copy_temp_buffer(temp, e, props, N, internal_units, snapshot_units);
-
-#ifdef IO_SPEED_MEASUREMENT
-  MPI_Barrier(MPI_COMM_WORLD);
-  if (engine_rank == 0)
-    message("Copying for '%s' took %.3f %s.", props.name,
-            clocks_from_ticks(getticks() - tic), clocks_getunit());
-#endif
+static void write_array_parallel_chunk_buffer(hid_t h_data,
+                                              const struct io_props props,
+                                              size_t N, long long offset,
+                                              const void* temp) {
 
   /* Create data space */
   const hid_t h_memspace = H5Screate(H5S_SIMPLE);
@@ -582,24 +551,75 @@ void write_array_parallel_chunk(struct engine* e, hid_t h_data,
   else
     H5Sselect_none(h_filespace);
 
-  /* message("Writing %lld '%s', %zd elements = %zd bytes (int=%d) at offset
-   * %zd", N, props.name, N * props.dimension, N * props.dimension * typeSize,
-   */
-  /* 	  (int)(N * props.dimension * typeSize), offset); */
-
   /* Make a dataset creation property list and set MPI-I/O mode */
   hid_t h_plist_id = H5Pcreate(H5P_DATASET_XFER);
   H5Pset_dxpl_mpio(h_plist_id, H5FD_MPIO_COLLECTIVE);
 
+  /* Write temporary buffer to HDF5 dataspace */
+  h_err = H5Dwrite(h_data, io_hdf5_type(props.type), h_memspace, h_filespace,
+                   h_plist_id, temp);
+  if (h_err < 0) error("Error while writing data array '%s'.", props.name);
+
+  /* Close everything */
+  H5Pclose(h_plist_id);
+  H5Sclose(h_memspace);
+  H5Sclose(h_filespace);
+}
+
+/**
+ * @brief Writes a chunk of data in an open HDF5 dataset
+ *
+ * @param e The #engine we are writing from.
+ * @param h_data The HDF5 dataset to write to.
+ * @param props The #io_props of the field to write.
+ * @param N The number of particles to write.
+ * @param offset Offset in the array where this mpi task starts writing.
+ * @param internal_units The #unit_system used internally.
+ * @param snapshot_units The #unit_system used in the snapshots.
+ */
+void write_array_parallel_chunk(struct engine* e, hid_t h_data,
+                                const struct io_props props, size_t N,
+                                long long offset,
+                                const struct unit_system* internal_units,
+                                const struct unit_system* snapshot_units) {
+
+  const size_t typeSize = io_sizeof_type(props.type);
+  const size_t num_elements = N * props.dimension;
+
+  /* Can't handle writes of more than 2GB */
+  if (N * props.dimension * typeSize > HDF5_PARALLEL_IO_MAX_BYTES)
+    error("Dataset too large to be written in one pass!");
+
+  /* message("Writing '%s' array...", props.name); */
+
+  /* Allocate temporary buffer */
+  void* temp = NULL;
+  if (swift_memalign("writebuff", (void**)&temp, IO_BUFFER_ALIGNMENT,
+                     num_elements * typeSize) != 0)
+    error("Unable to allocate temporary i/o buffer");
+
+#ifdef IO_SPEED_MEASUREMENT
+  MPI_Barrier(MPI_COMM_WORLD);
+  ticks tic = getticks();
+#endif
+
+  /* Copy the particle data to the temporary buffer */
+  io_copy_temp_buffer(temp, e, props, N, internal_units, snapshot_units);
+
+#ifdef IO_SPEED_MEASUREMENT
+  MPI_Barrier(MPI_COMM_WORLD);
+  if (engine_rank == 0)
+    message("Copying for '%s' took %.3f %s.", props.name,
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+#endif
+
 #ifdef IO_SPEED_MEASUREMENT
   MPI_Barrier(MPI_COMM_WORLD);
   tic = getticks();
 #endif
 
   /* Write temporary buffer to HDF5 dataspace */
-  h_err = H5Dwrite(h_data, io_hdf5_type(props.type), h_memspace, h_filespace,
-                   h_plist_id, temp);
-  if (h_err < 0) error("Error while writing data array '%s'.", props.name);
+  write_array_parallel_chunk_buffer(h_data, props, N, offset, temp);
 
 #ifdef IO_SPEED_MEASUREMENT
   MPI_Barrier(MPI_COMM_WORLD);
@@ -613,11 +633,8 @@ void write_array_parallel_chunk(struct engine* e, hid_t h_data,
             props.name, total, ms, clocks_getunit(), total / (ms / 1000.));
 #endif
 
-  /* Free and close everything */
+  /* Free everything */
   swift_free("writebuff", temp);
-  H5Pclose(h_plist_id);
-  H5Sclose(h_memspace);
-  H5Sclose(h_filespace);
 }
 
 /**
@@ -703,6 +720,58 @@ void write_array_parallel(struct engine* e, hid_t grp, char* fileName,
 #endif
 }
 
+/**
+ * @brief Writes a data array already converted to the snapshot units in given
+ * HDF5 group.
+ *
+ * @param grp The group in which to write.
+ * @param props The #io_props of the field to write.
+ * @param N The number of particles to write.
+ * @param offset Offset in the array where this mpi task starts writing.
+ * @param temp The buffer containing the converted data.
+ * @param comm The communicator of the ranks writing the file.
+ */
+static void write_array_parallel_buffer(hid_t grp, const struct io_props props,
+                                        size_t N, long long offset,
+                                        const char* temp, MPI_Comm comm) {
+
+  const size_t typeSize = io_sizeof_type(props.type);
+
+  /* Open dataset */
+  const hid_t h_data = H5Dopen(grp, props.name, H5P_DEFAULT);
+  if (h_data < 0) error("Error while opening dataset '%s'.", props.name);
+
+  /* Same chunking as write_array_parallel() */
+  char redo = 1;
+  while (redo) {
+
+    /* Maximal number of elements */
+    const size_t max_chunk_size =
+        HDF5_PARALLEL_IO_MAX_BYTES / (props.dimension * typeSize);
+
+    /* Write the first chunk */
+    const size_t this_chunk = (N > max_chunk_size) ? max_chunk_size : N;
+    write_array_parallel_chunk_buffer(h_data, props, this_chunk, offset, temp);
+
+    /* Compute how many items are left */
+    if (N > max_chunk_size) {
+      N -= max_chunk_size;
+      temp += max_chunk_size * props.dimension * typeSize;
+      offset += max_chunk_size;
+      redo = 1;
+    } else {
+      N = 0;
+      redo = 0;
+    }
+
+    /* Do we need to run again ? */
+    MPI_Allreduce(MPI_IN_PLACE, &redo, 1, MPI_SIGNED_CHAR, MPI_MAX, comm);
+  }
+
+  /* Close everything */
+  H5Dclose(h_data);
+}
+
 /**
  * @brief Reads an HDF5 initial condition file (GADGET-3 type) in parallel
  *
@@ -1100,6 +1169,8 @@ void read_ic_parallel(char* fileName, const struct unit_system* internal_units,
  * @brief Prepares a file for a parallel write.
  *
  * @param e The #engine.
+ * @param fileName The name of the snapshot file.
+ * @param xmfFileName The name of the XMF file, NULL to leave it untouched.
  * @param N_total The total number of particles of each type to write.
  * @param numFields The number of fields to write for each particle type.
  * @param internal_units The #unit_system used internally.
@@ -1135,11 +1206,14 @@ void prepare_file(struct engine* e, const char* fileName,
   FILE* xmfFile = 0;
   int numFiles = 1;
 
-  /* First time, we need to create the XMF file */
-  if (e->snapshot_output_count == 0) xmf_create_file(xmfFileName);
+  if (xmfFileName != NULL) {
 
-  /* Prepare the XMF file for the new entry */
-  xmfFile = xmf_prepare_file(xmfFileName);
+    /* First time, we need to create the XMF file */
+    if (e->snapshot_output_count == 0) xmf_create_file(xmfFileName);
+
+    /* Prepare the XMF file for the new entry */
+    xmfFile = xmf_prepare_file(xmfFileName);
+  }
 
   /* Open HDF5 file with the chosen parameters */
   hid_t h_file = H5Fcreate(fileName, H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
@@ -1147,7 +1221,7 @@ void prepare_file(struct engine* e, const char* fileName,
 
   /* Write the part of the XMF file corresponding to this
    * specific output */
-  xmf_write_outputheader(xmfFile, fileName, e->time);
+  if (xmfFile != NULL) xmf_write_outputheader(xmfFile, fileName, e->time);
 
   /* Open header to write simulation properties */
   /* message("Writing file header..."); */
@@ -1232,8 +1306,9 @@ void prepare_file(struct engine* e, const char* fileName,
 
     /* Add the global information for that particle type to
      * the XMF meta-file */
-    xmf_write_groupheader(xmfFile, fileName, N_total[ptype],
-                          (enum part_type)ptype);
+    if (xmfFile != NULL)
+      xmf_write_groupheader(xmfFile, fileName, N_total[ptype],
+                            (enum part_type)ptype);
 
     /* Create the particle group in the file */
     char partTypeGroupName[PARTICLE_GROUP_BUFFER_SIZE];
@@ -1376,16 +1451,51 @@ void prepare_file(struct engine* e, const char* fileName,
     H5Gclose(h_grp);
 
     /* Close this particle group in the XMF file as well */
-    xmf_write_groupfooter(xmfFile, (enum part_type)ptype);
+    if (xmfFile != NULL) xmf_write_groupfooter(xmfFile, (enum part_type)ptype);
   }
 
   /* Write LXMF file descriptor */
-  xmf_write_outputfooter(xmfFile, e->snapshot_output_count, e->time);
+  if (xmfFile != NULL)
+    xmf_write_outputfooter(xmfFile, e->snapshot_output_count, e->time);
 
   /* Close the file for now */
   H5Fclose(h_file);
 }
 
+/**
+ * @brief Executes a job of the asynchronous snapshot writer.
+ *
+ * All the ranks execute the same sequence of collective operations on the
+ * file.
+ *
+ * @param job The #io_async_job to execute.
+ * @param snap The #io_async_snapshot being written.
+ */
+static void parallel_io_async_write_job(struct io_async_job* job,
+                                        struct io_async_snapshot* snap) {
+
+  switch (job->type) {
+    case io_async_file_begin:
+      break;
+    case io_async_group_begin:
+      snap->h_grp = H5Gopen(snap->h_file, job->partTypeGroupName, H5P_DEFAULT);
+      if (snap->h_grp < 0)
+        error("Error while opening particle group %s.",
+              job->partTypeGroupName);
+      break;
+    case io_async_dataset:
+      write_array_parallel_buffer(snap->h_grp, job->props, job->N, job->offset,
+                                  (const char*)job->buffer, snap->comm);
+      break;
+    case io_async_group_end:
+      H5Gclose(snap->h_grp);
+      break;
+    case io_async_file_end:
+      H5Fclose(snap->h_file);
+      break;
+  }
+}
+
 /**
  * @brief Writes an HDF5 output file (GADGET-3 type) with
  * its XMF descriptor
@@ -1403,6 +1513,12 @@ void prepare_file(struct engine* e, const char* fileName,
  * erased and replaced by the new one.
  * The companion XMF file is also updated accordingly.
  *
+ * In asynchronous mode, the particle fields are converted here but written
+ * collectively by a separate thread on each rank such that this function can
+ * return before the file is complete. The XMF file is then only updated once
+ * the snapshot is fully written. io_async_wait() must be called by all the
+ * ranks before any use of the file.
+ *
  * Calls #error() if an error occurs.
  *
  */
@@ -1432,6 +1548,10 @@ void write_output_parallel(struct engine* e,
   const int with_stf = 0;
 #endif
   const int with_rt = e->policy & engine_policy_rt;
+  const int async = e->snapshot_async;
+
+  /* Wait for the previous snapshot to be fully written */
+  io_async_wait();
 
   /* Number of particles currently in the arrays */
   const size_t Ntot = e->s->nr_gparts;
@@ -1507,9 +1627,10 @@ void write_output_parallel(struct engine* e,
         output_options, current_selection_name, ptype);
   }
 
-  /* Rank 0 prepares the file */
+  /* Rank 0 prepares the file. The asynchronous writer only updates the XMF
+   * file once the snapshot is complete. */
   if (mpi_rank == 0)
-    prepare_file(e, fileName, xmfFileName, N_total, numFields,
+    prepare_file(e, fileName, async ? NULL : xmfFileName, N_total, numFields,
                  current_selection_name, internal_units, snapshot_units);
 
   MPI_Barrier(MPI_COMM_WORLD);
@@ -1599,6 +1720,13 @@ void write_output_parallel(struct engine* e,
   hid_t h_file = H5Fopen(fileName, H5F_ACC_RDWR, plist_id);
   if (h_file < 0) error("Error while opening file '%s'.", fileName);
 
+  /* From now on, the file is only accessed by the writer threads */
+  if (async)
+    io_async_begin_collective(e, h_file, fileName,
+                              mpi_rank == 0 ? xmfFileName : NULL,
+                              snapshot_units, parallel_io_async_write_job,
+                              mpi_rank, mpi_size, comm);
+
 #ifdef IO_SPEED_MEASUREMENT
   MPI_Barrier(MPI_COMM_WORLD);
   if (engine_rank == 0)
@@ -1618,9 +1746,16 @@ void write_output_parallel(struct engine* e,
     char partTypeGroupName[PARTICLE_GROUP_BUFFER_SIZE];
     snprintf(partTypeGroupName, PARTICLE_GROUP_BUFFER_SIZE, "/PartType%d",
              ptype);
-    hid_t h_grp = H5Gopen(h_file, partTypeGroupName, H5P_DEFAULT);
-    if (h_grp < 0)
-      error("Error while opening particle group %s.", partTypeGroupName);
+    hid_t h_grp = 0;
+    if (async) {
+      io_async_push(io_async_new_job(io_async_group_begin, /*h_grp=*/0,
+                                     (enum part_type)ptype, partTypeGroupName,
+                                     N[ptype], N_total[ptype]));
+    } else {
+      h_grp = H5Gopen(h_file, partTypeGroupName, H5P_DEFAULT);
+      if (h_grp < 0)
+        error("Error while opening particle group %s.", partTypeGroupName);
+    }
 
     int num_fields = 0;
     struct io_props list[100];
@@ -1948,9 +2083,16 @@ void write_output_parallel(struct engine* e,
               (enum part_type)ptype, compression_level_current_default);
 
       if (compression_level != compression_do_not_write) {
-        write_array_parallel(e, h_grp, fileName, partTypeGroupName, list[i],
-                             Nparticles, N_total[ptype], mpi_rank,
-                             offset[ptype], internal_units, snapshot_units);
+        if (async)
+          io_async_push_dataset(e, /*h_grp=*/0, (enum part_type)ptype,
+                                partTypeGroupName, list[i], Nparticles,
+                                N_total[ptype], offset[ptype],
+                                compression_level, internal_units,
+                                snapshot_units);
+        else
+          write_array_parallel(e, h_grp, fileName, partTypeGroupName, list[i],
+                               Nparticles, N_total[ptype], mpi_rank,
+                               offset[ptype], internal_units, snapshot_units);
       }
     }
 
@@ -1970,7 +2112,12 @@ void write_output_parallel(struct engine* e,
 #endif
 
     /* Close particle group */
-    H5Gclose(h_grp);
+    if (async)
+      io_async_push(io_async_new_job(io_async_group_end, /*h_grp=*/0,
+                                     (enum part_type)ptype, partTypeGroupName,
+                                     N[ptype], N_total[ptype]));
+    else
+      H5Gclose(h_grp);
 
 #ifdef IO_SPEED_MEASUREMENT
     MPI_Barrier(MPI_COMM_WORLD);
@@ -2002,7 +2149,12 @@ void write_output_parallel(struct engine* e,
 #endif
 
   /* Close file */
-  H5Fclose(h_file);
+  if (async)
+    io_async_push(io_async_new_job(io_async_file_end, /*h_grp=*/0,
+                                   swift_type_gas, /*partTypeGroupName=*/NULL,
+                                   0, 0));
+  else
+    H5Fclose(h_file);
 
 #ifdef IO_SPEED_MEASUREMENT
   MPI_Barrier(MPI_COMM_WORLD);
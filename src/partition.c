@@ -24,7 +24,8 @@
  *  a grid of cells into geometrically connected regions and distributing
  *  these around a number of MPI nodes.
  *
- *  Currently supported partitioning types: grid, vectorise and METIS/ParMETIS.
+ *  Currently supported partitioning types: grid, vectorise, space-filling
+ *  curve and METIS/ParMETIS.
  */
 
 /* Config parameters. */
@@ -51,6 +52,12 @@
 #ifdef HAVE_METIS
 #include <metis.h>
 #endif
+#if !defined(HAVE_METIS) && !defined(HAVE_PARMETIS)
+/* Without METIS the graph indices and weight limits of the cost gathering
+ * are plain integers. */
+typedef int32_t idx_t;
+#define IDX_MAX INT32_MAX
+#endif
 #endif
 
 /* Local headers. */
@@ -68,13 +75,15 @@ const char *initial_partition_name[] = {
     "axis aligned grids of cells", "vectorized point associated cells",
     "memory balanced, using particle weighted cells",
     "similar sized regions, using unweighted cells",
-    "memory and edge balanced cells using particle weights"};
+    "memory and edge balanced cells using particle weights",
+    "memory balanced cuts of a space-filling curve through the cells"};
 
 /* Simple descriptions of repartition types for reports. */
 const char *repartition_name[] = {
     "none", "edge and vertex task cost weights", "task cost edge weights",
     "memory balanced, using particle vertex weights",
-    "vertex task costs and edge delta timebin weights"};
+    "vertex task costs and edge delta timebin weights",
+    "vertex task cost cuts of a space-filling curve through the cells"};
 
 /* Local functions, if needed. */
 static int check_complete(struct space *s, int verbose, int nregions);
@@ -83,7 +92,7 @@ static int check_complete(struct space *s, int verbose, int nregions);
  * Repartition fixed costs per type/subtype. These are determined from the
  * statistics output produced when running with task debugging enabled.
  */
-#if defined(WITH_MPI) && (defined(HAVE_METIS) || defined(HAVE_PARMETIS))
+#if defined(WITH_MPI)
 static double repartition_costs[task_type_count][task_subtype_count];
 #endif
 #if defined(WITH_MPI)
@@ -168,6 +177,209 @@ static void split_vector(struct space *s, int nregions, int *samplecells) {
 }
 #endif
 
+/*  Space-filling curve support */
+/*  =========================== */
+
+#if defined(WITH_MPI)
+/**
+ * @brief Position of a cell along a Hilbert curve.
+ *
+ * Uses Skilling's transposition of the axes (AIP Conf. Proc. 707, 381,
+ * 2004) on the smallest power-of-two grid enclosing the cells. Consecutive
+ * keys are neighbouring cells on that grid.
+ *
+ * @param nbits the number of bits per dimension of the grid.
+ * @param ind the integer coordinates of the cell.
+ */
+static uint64_t sfc_hilbert_key(const int nbits, const int ind[3]) {
+
+  unsigned int x[3] = {(unsigned int)ind[0], (unsigned int)ind[1],
+                       (unsigned int)ind[2]};
+  const unsigned int m = 1u << (nbits - 1);
+
+  /* Inverse undo excess work. */
+  for (unsigned int q = m; q > 1; q >>= 1) {
+    const unsigned int p = q - 1;
+    for (int i = 0; i < 3; i++) {
+      if (x[i] & q) {
+        x[0] ^= p;
+      } else {
+        const unsigned int t = (x[0] ^ x[i]) & p;
+        x[0] ^= t;
+        x[i] ^= t;
+      }
+    }
+  }
+
+  /* Gray encode. */
+  for (int i = 1; i < 3; i++) x[i] ^= x[i - 1];
+  unsigned int t = 0;
+  for (unsigned int q = m; q > 1; q >>= 1)
+    if (x[2] & q) t ^= q - 1;
+  for (int i = 0; i < 3; i++) x[i] ^= t;
+
+  /* Interleave the transposed bits, most significant first. */
+  uint64_t key = 0;
+  for (int b = nbits - 1; b >= 0; b--)
+    for (int i = 0; i < 3; i++) key = (key << 1) | ((x[i] >> b) & 1u);
+  return key;
+}
+
+/**
+ * @brief Position of a cell along a Morton (Z-order) curve.
+ *
+ * @param nbits the number of bits per dimension of the grid.
+ * @param ind the integer coordinates of the cell.
+ */
+static uint64_t sfc_morton_key(const int nbits, const int ind[3]) {
+
+  uint64_t key = 0;
+  for (int b = nbits - 1; b >= 0; b--)
+    for (int i = 0; i < 3; i++) key = (key << 1) | ((ind[i] >> b) & 1);
+  return key;
+}
+
+/* qsort support. */
+struct sfc_keyval {
+  uint64_t key;
+  int cid;
+};
+static int sfc_keyvalcmp(const void *p1, const void *p2) {
+  const struct sfc_keyval *kv1 = (const struct sfc_keyval *)p1;
+  const struct sfc_keyval *kv2 = (const struct sfc_keyval *)p2;
+  return (kv1->key > kv2->key) - (kv1->key < kv2->key);
+}
+
+/**
+ * @brief Partition the cells by cutting a space-filling curve through them
+ *        into segments of equal weight.
+ *
+ * The regions are the consecutive segments of the curve, in order, so a
+ * change of the weights only moves the boundaries between the regions
+ * along the curve. All the nodes get the same answer from the same
+ * weights, so no communication is needed. Every region gets at least one
+ * cell, provided there are more cells than regions.
+ *
+ * With a second set of weights each cut is placed where the worse of the
+ * two cumulative fractions of the weights is the closest to its target,
+ * balancing both as well as a single curve allows.
+ *
+ * @param s the space of cells.
+ * @param nregions the number of regions.
+ * @param curve the curve to use, a #partition_sfc_type.
+ * @param weights the weight of each cell, NULL or all zero for equal weights.
+ * @param weights2 a second weight of each cell to balance, NULL or all zero
+ *                 to only balance the first.
+ * @param celllist (return) the region of each cell.
+ */
+static void pick_sfc(struct space *s, int nregions, int curve,
+                     const double *weights, const double *weights2,
+                     int *celllist) {
+
+  const int nr_cells = s->nr_cells;
+  if (nregions > nr_cells)
+    error("Too few cells (%d) for this number of regions (%d)", nr_cells,
+          nregions);
+
+  /* Bits needed per dimension to index all the cells. */
+  const int cdim_max = max3(s->cdim[0], s->cdim[1], s->cdim[2]);
+  int nbits = 1;
+  while ((1 << nbits) < cdim_max) nbits++;
+
+  /* Order the cells along the curve. */
+  struct sfc_keyval *order = NULL;
+  if ((order = (struct sfc_keyval *)malloc(sizeof(struct sfc_keyval) *
+                                           nr_cells)) == NULL)
+    error("Failed to allocate space-filling curve keys");
+  for (int i = 0; i < s->cdim[0]; i++) {
+    for (int j = 0; j < s->cdim[1]; j++) {
+      for (int k = 0; k < s->cdim[2]; k++) {
+        const int cid = cell_getid(s->cdim, i, j, k);
+        const int ind[3] = {i, j, k};
+        order[cid].cid = cid;
+        order[cid].key = (curve == SFC_MORTON) ? sfc_morton_key(nbits, ind)
+                                               : sfc_hilbert_key(nbits, ind);
+      }
+    }
+  }
+  qsort(order, nr_cells, sizeof(struct sfc_keyval), sfc_keyvalcmp);
+
+  /* Total weight, falling back to equal weights if there is none. */
+  double sum = 0.0;
+  if (weights != NULL)
+    for (int k = 0; k < nr_cells; k++) sum += weights[k];
+  const int uniform = (sum <= 0.0);
+  if (uniform) sum = nr_cells;
+
+  double sum2 = 0.0;
+  if (weights2 != NULL)
+    for (int k = 0; k < nr_cells; k++) sum2 += weights2[k];
+
+  /* First position along the curve of each region. */
+  int *first = NULL;
+  if ((first = (int *)malloc(sizeof(int) * (nregions + 1))) == NULL)
+    error("Failed to allocate space-filling curve cuts");
+  first[0] = 0;
+  int r = 1;
+  if (sum2 <= 0.0) {
+
+    /* A cell goes to the region holding the middle of its weight. */
+    double cumul = 0.0;
+    for (int k = 0; k < nr_cells; k++) {
+      const double w = uniform ? 1.0 : weights[order[k].cid];
+      const double mid = (cumul + 0.5 * w) * nregions / sum;
+      while (r < nregions && mid >= r) first[r++] = k;
+      cumul += w;
+    }
+
+  } else {
+
+    /* Cumulative fractions of both weights before each position. */
+    double *frac = NULL;
+    if ((frac = (double *)malloc(sizeof(double) * 2 * (nr_cells + 1))) ==
+        NULL)
+      error("Failed to allocate space-filling curve fractions");
+    frac[0] = 0.0;
+    frac[1] = 0.0;
+    for (int k = 0; k < nr_cells; k++) {
+      const int cid = order[k].cid;
+      frac[2 * (k + 1)] = frac[2 * k] + (uniform ? 1.0 : weights[cid]) / sum;
+      frac[2 * (k + 1) + 1] = frac[2 * k + 1] + weights2[cid] / sum2;
+    }
+
+    /* The distance to the target is the largest of two functions that
+     * decrease then increase along the curve, so is also one, and we stop
+     * at its first minimum. */
+    int k = 0;
+    for (; r < nregions; r++) {
+      const double target = (double)r / nregions;
+      double dist =
+          max(fabs(frac[2 * k] - target), fabs(frac[2 * k + 1] - target));
+      while (k < nr_cells) {
+        const double next = max(fabs(frac[2 * (k + 1)] - target),
+                                fabs(frac[2 * (k + 1) + 1] - target));
+        if (next > dist) break;
+        dist = next;
+        k++;
+      }
+      first[r] = k;
+    }
+    free(frac);
+  }
+  while (r <= nregions) first[r++] = nr_cells;
+
+  /* Make sure no region is empty. */
+  for (r = 1; r < nregions; r++) first[r] = max(first[r], first[r - 1] + 1);
+  for (r = nregions - 1; r > 0; r--) first[r] = min(first[r], first[r + 1] - 1);
+
+  for (r = 0; r < nregions; r++)
+    for (int k = first[r]; k < first[r + 1]; k++) celllist[order[k].cid] = r;
+
+  free(first);
+  free(order);
+}
+#endif
+
 /* METIS/ParMETIS support (optional)
  * =================================
  *
@@ -326,7 +538,7 @@ static void graph_init(struct space *s, int periodic, idx_t *weights_e,
 }
 #endif
 
-#if defined(WITH_MPI) && (defined(HAVE_METIS) || defined(HAVE_PARMETIS))
+#if defined(WITH_MPI)
 struct counts_mapper_data {
   double *counts;
   size_t size;
@@ -520,7 +732,9 @@ static void accumulate_sizes(struct space *s, int verbose, double *counts) {
     for (int k = 0; k < s->nr_cells; k++) counts[k] *= vscale;
   }
 }
+#endif
 
+#if defined(WITH_MPI) && (defined(HAVE_METIS) || defined(HAVE_PARMETIS))
 /**
  * @brief Make edge weights from the accumulated particle sizes per cell.
  *
@@ -692,8 +906,10 @@ void permute_regions(int *newlist, int *oldlist, int nregions, int ncells,
  * @param nodeID our nodeID.
  * @param s the space of cells to partition.
  * @param nregions the number of regions required in the partition.
- * @param vertexw weights for the cells, sizeof number of cells if used,
- *        NULL for unit weights. Need to be in the range of idx_t.
+ * @param vertexw weights for the cells, sizeof number of cells * ncon if
+ *        used, NULL for unit weights. Need to be in the range of idx_t.
+ * @param ncon the number of weights per cell, the constraints of the
+ *        partition, interleaved in vertexw.
  * @param edgew weights for the graph edges between all cells, sizeof number
  *        of cells * 26 if used, NULL for unit weights. Need to be packed
  *        in CSR format, so same as adjncy array. Need to be in the range of
@@ -710,7 +926,7 @@ void permute_regions(int *newlist, int *oldlist, int nregions, int ncells,
  *        the old partition on entry.
  */
 static void pick_parmetis(int nodeID, struct space *s, int nregions,
-                          double *vertexw, double *edgew, int refine,
+                          double *vertexw, int ncon, double *edgew, int refine,
                           int adaptive, float itr, int *celllist) {
 
   int res;
@@ -768,7 +984,7 @@ static void pick_parmetis(int nodeID, struct space *s, int nregions,
 
   idx_t *weights_v = NULL;
   if (vertexw != NULL)
-    if ((weights_v = (idx_t *)malloc(sizeof(idx_t) * nverts)) == NULL)
+    if ((weights_v = (idx_t *)malloc(sizeof(idx_t) * nverts * ncon)) == NULL)
       error("Failed to allocate vertex weights array");
 
   idx_t *weights_e = NULL;
@@ -807,7 +1023,8 @@ static void pick_parmetis(int nodeID, struct space *s, int nregions,
       error("Failed to allocate full adjncy array.");
     idx_t *full_weights_v = NULL;
     if (weights_v != NULL)
-      if ((full_weights_v = (idx_t *)malloc(sizeof(idx_t) * ncells)) == NULL)
+      if ((full_weights_v = (idx_t *)malloc(sizeof(idx_t) * ncells * ncon)) ==
+          NULL)
         error("Failed to allocate full vertex weights array");
     idx_t *full_weights_e = NULL;
     if (weights_e != NULL)
@@ -823,7 +1040,7 @@ static void pick_parmetis(int nodeID, struct space *s, int nregions,
 
     /* Init the vertex weights array. */
     if (vertexw != NULL) {
-      for (int k = 0; k < ncells; k++) {
+      for (int k = 0; k < ncells * ncon; k++) {
         if (vertexw[k] > 1) {
           full_weights_v[k] = vertexw[k];
         } else {
@@ -834,7 +1051,7 @@ static void pick_parmetis(int nodeID, struct space *s, int nregions,
 #ifdef SWIFT_DEBUG_CHECKS
       /* Check weights are all in range. */
       int failed = 0;
-      for (int k = 0; k < ncells; k++) {
+      for (int k = 0; k < ncells * ncon; k++) {
         if ((idx_t)vertexw[k] < 0) {
           message("Input vertex weight out of range: %ld", (long)vertexw[k]);
           failed++;
@@ -919,7 +1136,8 @@ static void pick_parmetis(int nodeID, struct space *s, int nregions,
         if (weights_e != NULL)
           memcpy(weights_e, &full_weights_e[j2], sizeof(idx_t) * nedge);
         if (weights_v != NULL)
-          memcpy(weights_v, &full_weights_v[j3], sizeof(idx_t) * nvt);
+          memcpy(weights_v, &full_weights_v[j3 * ncon],
+                 sizeof(idx_t) * nvt * ncon);
         if (refine) memcpy(regionid, full_regionid, sizeof(idx_t) * nvt);
 
       } else {
@@ -932,8 +1150,8 @@ static void pick_parmetis(int nodeID, struct space *s, int nregions,
           res = MPI_Isend(&full_weights_e[j2], nvt * 26, IDX_T, rank, 2, comm,
                           &reqs[5 * rank + 2]);
         if (res == MPI_SUCCESS && weights_v != NULL)
-          res = MPI_Isend(&full_weights_v[j3], nvt, IDX_T, rank, 3, comm,
-                          &reqs[5 * rank + 3]);
+          res = MPI_Isend(&full_weights_v[j3 * ncon], nvt * ncon, IDX_T, rank,
+                          3, comm, &reqs[5 * rank + 3]);
         if (refine && res == MPI_SUCCESS)
           res = MPI_Isend(&full_regionid[j3], nvt, IDX_T, rank, 4, comm,
                           &reqs[5 * rank + 4]);
@@ -975,7 +1193,7 @@ static void pick_parmetis(int nodeID, struct space *s, int nregions,
     if (res == MPI_SUCCESS && weights_e != NULL)
       res = MPI_Irecv(weights_e, nverts * 26, IDX_T, 0, 2, comm, &reqs[2]);
     if (res == MPI_SUCCESS && weights_v != NULL)
-      res = MPI_Irecv(weights_v, nverts, IDX_T, 0, 3, comm, &reqs[3]);
+      res = MPI_Irecv(weights_v, nverts * ncon, IDX_T, 0, 3, comm, &reqs[3]);
     if (refine && res == MPI_SUCCESS)
       res += MPI_Irecv((void *)regionid, nverts, IDX_T, 0, 4, comm, &reqs[4]);
     if (res != MPI_SUCCESS) mpi_error(res, "Failed to receive graph data");
@@ -993,11 +1211,12 @@ static void pick_parmetis(int nodeID, struct space *s, int nregions,
     }
   }
 
-  /* Set up the tpwgts array. This is just 1/nregions. */
+  /* Set up the tpwgts array. This is just 1/nregions for all constraints. */
   real_t *tpwgts;
-  if ((tpwgts = (real_t *)malloc(sizeof(real_t) * nregions)) == NULL)
+  if ((tpwgts = (real_t *)malloc(sizeof(real_t) * nregions * ncon)) == NULL)
     error("Failed to allocate tpwgts array");
-  for (int i = 0; i < nregions; i++) tpwgts[i] = 1.0 / (real_t)nregions;
+  for (int i = 0; i < nregions * ncon; i++)
+    tpwgts[i] = 1.0 / (real_t)nregions;
 
   /* Common parameters. */
   idx_t options[4];
@@ -1005,15 +1224,17 @@ static void pick_parmetis(int nodeID, struct space *s, int nregions,
   options[1] = 0;
 
   idx_t edgecut;
-  idx_t ncon = 1;
+  idx_t idx_ncon = ncon;
   idx_t nparts = nregions;
   idx_t numflag = 0;
   idx_t wgtflag = 0;
   if (edgew != NULL) wgtflag += 1;
   if (vertexw != NULL) wgtflag += 2;
 
-  real_t ubvec[1];
-  ubvec[0] = 1.001;
+  /* Allowed imbalance of each constraint, looser when the fast time-bins
+   * need balancing as well. */
+  real_t ubvec[ncon];
+  for (int i = 0; i < ncon; i++) ubvec[i] = (ncon > 1) ? 1.05 : 1.001;
 
   if (refine) {
     /* Refine an existing partition, uncouple as we do not have the cells
@@ -1031,12 +1252,12 @@ static void pick_parmetis(int nodeID, struct space *s, int nregions,
       real_t itr_real_t = itr;
       if (ParMETIS_V3_AdaptiveRepart(
               vtxdist, xadj, adjncy, weights_v, NULL, weights_e, &wgtflag,
-              &numflag, &ncon, &nparts, tpwgts, ubvec, &itr_real_t, options,
+              &numflag, &idx_ncon, &nparts, tpwgts, ubvec, &itr_real_t, options,
               &edgecut, regionid, &comm) != METIS_OK)
         error("Call to ParMETIS_V3_AdaptiveRepart failed.");
     } else {
       if (ParMETIS_V3_RefineKway(vtxdist, xadj, adjncy, weights_v, weights_e,
-                                 &wgtflag, &numflag, &ncon, &nparts, tpwgts,
+                                 &wgtflag, &numflag, &idx_ncon, &nparts, tpwgts,
                                  ubvec, options, &edgecut, regionid,
                                  &comm) != METIS_OK)
         error("Call to ParMETIS_V3_RefineKway failed.");
@@ -1055,7 +1276,7 @@ static void pick_parmetis(int nodeID, struct space *s, int nregions,
       options[2] = clocks_random_seed();
 
       if (ParMETIS_V3_PartKway(vtxdist, xadj, adjncy, weights_v, weights_e,
-                               &wgtflag, &numflag, &ncon, &nparts, tpwgts,
+                               &wgtflag, &numflag, &idx_ncon, &nparts, tpwgts,
                                ubvec, options, &edgecut, regionid,
                                &comm) != METIS_OK)
         error("Call to ParMETIS_V3_PartKway failed.");
@@ -1196,8 +1417,10 @@ static void pick_parmetis(int nodeID, struct space *s, int nregions,
  * @param nodeID the rank of our node.
  * @param s the space of cells to partition.
  * @param nregions the number of regions required in the partition.
- * @param vertexw weights for the cells, sizeof number of cells if used,
- *        NULL for unit weights. Need to be in the range of idx_t.
+ * @param vertexw weights for the cells, sizeof number of cells * ncon if
+ *        used, NULL for unit weights. Need to be in the range of idx_t.
+ * @param ncon the number of weights per cell, the constraints of the
+ *        partition, interleaved in vertexw.
  * @param edgew weights for the graph edges between all cells, sizeof number
  *        of cells * 26 if used, NULL for unit weights. Need to be packed
  *        in CSR format, so same as adjncy array. Need to be in the range of
@@ -1206,7 +1429,8 @@ static void pick_parmetis(int nodeID, struct space *s, int nregions,
  *        sizeof number of cells.
  */
 static void pick_metis(int nodeID, struct space *s, int nregions,
-                       double *vertexw, double *edgew, int *celllist) {
+                       double *vertexw, int ncon, double *edgew,
+                       int *celllist) {
 
   /* Total number of cells. */
   int ncells = s->cdim[0] * s->cdim[1] * s->cdim[2];
@@ -1230,7 +1454,8 @@ static void pick_metis(int nodeID, struct space *s, int nregions,
       error("Failed to allocate adjncy array.");
     idx_t *weights_v = NULL;
     if (vertexw != NULL)
-      if ((weights_v = (idx_t *)malloc(sizeof(idx_t) * ncells)) == NULL)
+      if ((weights_v = (idx_t *)malloc(sizeof(idx_t) * ncells * ncon)) ==
+          NULL)
         error("Failed to allocate vertex weights array");
     idx_t *weights_e = NULL;
     if (edgew != NULL)
@@ -1242,7 +1467,7 @@ static void pick_metis(int nodeID, struct space *s, int nregions,
 
     /* Init the vertex weights array. */
     if (vertexw != NULL) {
-      for (int k = 0; k < ncells; k++) {
+      for (int k = 0; k < ncells * ncon; k++) {
         if (vertexw[k] > 1) {
           weights_v[k] = vertexw[k];
         } else {
@@ -1253,7 +1478,7 @@ static void pick_metis(int nodeID, struct space *s, int nregions,
 #ifdef SWIFT_DEBUG_CHECKS
       /* Check weights are all in range. */
       int failed = 0;
-      for (int k = 0; k < ncells; k++) {
+      for (int k = 0; k < ncells * ncon; k++) {
         if ((idx_t)vertexw[k] < 0) {
           message("Input vertex weight out of range: %ld", (long)vertexw[k]);
           failed++;
@@ -1311,16 +1536,16 @@ static void pick_metis(int nodeID, struct space *s, int nregions,
     options[METIS_OPTION_NITER] = 20;
 
     /* Call METIS. */
-    idx_t one = 1;
+    idx_t idx_ncon = ncon;
     idx_t idx_ncells = ncells;
     idx_t idx_nregions = nregions;
     idx_t objval;
 
     /* Dump graph in METIS format */
-    /*dumpMETISGraph("metis_graph", idx_ncells, one, xadj, adjncy, weights_v,
-                   NULL, weights_e);*/
+    /*dumpMETISGraph("metis_graph", idx_ncells, idx_ncon, xadj, adjncy,
+                   weights_v, NULL, weights_e);*/
 
-    if (METIS_PartGraphKway(&idx_ncells, &one, xadj, adjncy, weights_v, NULL,
+    if (METIS_PartGraphKway(&idx_ncells, &idx_ncon, xadj, adjncy, weights_v, NULL,
                             weights_e, &idx_nregions, NULL, NULL, options,
                             &objval, regionid) != METIS_OK)
       error("Call to METIS_PartGraphKway failed.");
@@ -1348,7 +1573,7 @@ static void pick_metis(int nodeID, struct space *s, int nregions,
 }
 #endif
 
-#if defined(WITH_MPI) && (defined(HAVE_METIS) || defined(HAVE_PARMETIS))
+#if defined(WITH_MPI)
 
 /* Helper struct for partition_gather weights. */
 struct weights_mapper_data {
@@ -1361,15 +1586,177 @@ struct weights_mapper_data {
   int vweights;
   int nr_cells;
   int use_ticks;
+  int comms_costs;
+  double comms_bytes;
+  double comms_ticks;
+  double *weights_f;
+  const int *cell_bins;
+  int fast_bin;
   struct cell *cells;
 };
 
+/**
+ * @brief Add the cost of a task to the vertex weight of a cell and, if the
+ *        cell has particles on the fast time-bins, to its fast weight.
+ *
+ * @param mydata the weights being gathered.
+ * @param cid the index of the top-level cell.
+ * @param w the cost.
+ */
+__attribute__((always_inline)) INLINE static void partition_add_vertex_cost(
+    struct weights_mapper_data *mydata, int cid, double w) {
+
+  atomic_add_d(&mydata->weights_v[cid], w);
+  if (mydata->weights_f != NULL && mydata->cell_bins[cid] <= mydata->fast_bin)
+    atomic_add_d(&mydata->weights_f[cid], w);
+}
+
+/**
+ * @brief Threadpool mapper function to find the shortest time-bin of the
+ *        particles of each of our top-level cells.
+ *
+ * @param map_data part of the local cells indices.
+ * @param num_elements the number of cells to process.
+ * @param extra_data the space and the array of time-bins.
+ */
+static void partition_cell_bins_mapper(void *map_data, int num_elements,
+                                       void *extra_data) {
+
+  const int *local_cells = (const int *)map_data;
+  struct space *s = *(struct space **)extra_data;
+  int *cell_bins = *((int **)extra_data + 1);
+
+  for (int k = 0; k < num_elements; k++) {
+    const struct cell *c = &s->cells_top[local_cells[k]];
+
+    /* Inhibited and not yet created particles have bins past the last one. */
+    int bin = num_time_bins;
+    for (int i = 0; i < c->hydro.count; i++)
+      bin = min(bin, c->hydro.parts[i].time_bin);
+    for (int i = 0; i < c->grav.count; i++)
+      bin = min(bin, c->grav.parts[i].time_bin);
+    for (int i = 0; i < c->stars.count; i++)
+      bin = min(bin, c->stars.parts[i].time_bin);
+    for (int i = 0; i < c->black_holes.count; i++)
+      bin = min(bin, c->black_holes.parts[i].time_bin);
+    cell_bins[local_cells[k]] = bin;
+  }
+}
+
+/**
+ * @brief Find the shortest time-bin of the particles of all the top-level
+ *        cells and the largest of the fast time-bins.
+ *
+ * The fast time-bins are the nr_bins shortest ones from the shortest
+ * time-bin in use, so the ones active in most steps.
+ *
+ * @param s the space of cells holding our local particles.
+ * @param nr_bins the number of fast time-bins.
+ * @param cell_bins (return) the shortest time-bin of each cell, the same on
+ *                  all nodes.
+ *
+ * @return the largest fast time-bin.
+ */
+static int partition_cell_bins(struct space *s, int nr_bins, int *cell_bins) {
+
+  for (int k = 0; k < s->nr_cells; k++) cell_bins[k] = num_time_bins;
+
+  void *extra_data[2] = {s, cell_bins};
+  threadpool_map(&s->e->threadpool, partition_cell_bins_mapper,
+                 s->local_cells_top, s->nr_local_cells, sizeof(int),
+                 threadpool_auto_chunk_size, extra_data);
+
+  int res = MPI_Allreduce(MPI_IN_PLACE, cell_bins, s->nr_cells, MPI_INT,
+                          MPI_MIN, MPI_COMM_WORLD);
+  if (res != MPI_SUCCESS) mpi_error(res, "Failed to allreduce cell bins.");
+
+  int min_bin = num_time_bins;
+  for (int k = 0; k < s->nr_cells; k++) min_bin = min(min_bin, cell_bins[k]);
+  return min_bin + nr_bins - 1;
+}
+
+/**
+ * @brief The ratio of the largest sum of the weights of the cells of a node
+ *        to the mean, for reports.
+ *
+ * @param nr_nodes the number of nodes.
+ * @param s the space of cells.
+ * @param weights the weights of the cells.
+ * @param celllist the node of each cell, NULL for the current ones.
+ */
+static double partition_imbalance(int nr_nodes, const struct space *s,
+                                  const double *weights, const int *celllist) {
+
+  double loads[nr_nodes];
+  for (int k = 0; k < nr_nodes; k++) loads[k] = 0.0;
+  double sum = 0.0;
+  for (int k = 0; k < s->nr_cells; k++) {
+    const int node = (celllist != NULL) ? celllist[k] : s->cells_top[k].nodeID;
+    loads[node] += weights[k];
+    sum += weights[k];
+  }
+  double max_load = 0.0;
+  for (int k = 0; k < nr_nodes; k++) max_load = max(max_load, loads[k]);
+  return (sum > 0.0) ? max_load * nr_nodes / sum : 1.0;
+}
+
 #ifdef SWIFT_DEBUG_CHECKS
 static void check_weights(struct task *tasks, int nr_tasks,
                           struct weights_mapper_data *weights_data,
                           double *weights_v, double *weights_e);
 #endif
 
+#ifdef SWIFT_MPIUSE_REPORTS
+/**
+ * @brief Add the measured time of a send task to the edge weights of the
+ *        top-level cells it connects.
+ *
+ * The time is from posting the send to its completion, so includes the
+ * latency and the transfer of the data. Cells that are not neighbours
+ * (gravity) get no edge weight, as with the pair tasks.
+ *
+ * @param t the send task.
+ * @param cells the top-level cells.
+ * @param nr_cells the number of top-level cells.
+ * @param inds the indices of the neighbours of the cells.
+ * @param weights_e the edge weights.
+ */
+static void partition_add_send_cost(const struct task *t, struct cell *cells,
+                                    int nr_cells, const idx_t *inds,
+                                    double *weights_e) {
+
+  /* Get the top-level cells involved. */
+  const struct cell *ci, *cj;
+  for (ci = t->ci; ci->parent != NULL; ci = ci->parent)
+    ;
+  for (cj = t->cj; cj->parent != NULL; cj = cj->parent)
+    ;
+  const int cid = ci - cells;
+  const int cjd = cj - cells;
+
+  int ik = -1;
+  for (int k = 26 * cid; k < 26 * nr_cells; k++) {
+    if (inds[k] == cjd) {
+      ik = k;
+      break;
+    }
+  }
+  int jk = -1;
+  for (int k = 26 * cjd; k < 26 * nr_cells; k++) {
+    if (inds[k] == cid) {
+      jk = k;
+      break;
+    }
+  }
+
+  if (ik != -1 && jk != -1) {
+    const double w = (double)t->mpi_ticks;
+    atomic_add_d(&weights_e[ik], w);
+    atomic_add_d(&weights_e[jk], w);
+  }
+}
+#endif
+
 /**
  * @brief Threadpool mapper function to gather cell edge and vertex weights
  *        from the associated tasks.
@@ -1385,7 +1772,6 @@ static void partition_gather_weights(void *map_data, int num_elements,
   struct weights_mapper_data *mydata = (struct weights_mapper_data *)extra_data;
 
   double *weights_e = mydata->weights_e;
-  double *weights_v = mydata->weights_v;
   idx_t *inds = mydata->inds;
   int eweights = mydata->eweights;
   int nodeID = mydata->nodeID;
@@ -1396,10 +1782,27 @@ static void partition_gather_weights(void *map_data, int num_elements,
 
   struct cell *cells = mydata->cells;
 
+#ifdef SWIFT_MPIUSE_REPORTS
+  int comms_costs = mydata->comms_costs;
+  double comms_bytes = 0.0;
+  double comms_ticks = 0.0;
+#endif
+
   /* Loop over the tasks... */
   for (int i = 0; i < num_elements; i++) {
     struct task *t = &tasks[i];
 
+#ifdef SWIFT_MPIUSE_REPORTS
+    /* Measured volume and time of the sends to the other nodes. */
+    if (t->type == task_type_send && t->cj != NULL && t->mpi_ticks > 0) {
+      comms_bytes += (double)t->mpi_size;
+      comms_ticks += (double)t->mpi_ticks;
+      if (comms_costs)
+        partition_add_send_cost(t, cells, nr_cells, inds, weights_e);
+      continue;
+    }
+#endif
+
     /* Skip un-interesting tasks. */
     if (t->type == task_type_send || t->type == task_type_recv ||
         t->type == task_type_logger || t->implicit || t->ci == NULL)
@@ -1438,7 +1841,7 @@ static void partition_gather_weights(void *map_data, int num_elements,
         t->type == task_type_grav_long_range) {
 
       /* Particle updates add only to vertex weight. */
-      if (vweights) atomic_add_d(&weights_v[cid], w);
+      if (vweights) partition_add_vertex_cost(mydata, cid, w);
     }
 
     /* Self interaction? */
@@ -1446,7 +1849,7 @@ static void partition_gather_weights(void *map_data, int num_elements,
              (t->type == task_type_sub_self && cj == NULL &&
               ci->nodeID == nodeID)) {
       /* Self interactions add only to vertex weight. */
-      if (vweights) atomic_add_d(&weights_v[cid], w);
+      if (vweights) partition_add_vertex_cost(mydata, cid, w);
 
     }
 
@@ -1456,7 +1859,7 @@ static void partition_gather_weights(void *map_data, int num_elements,
       /* In-cell pair? */
       if (ci == cj) {
         /* Add weight to vertex for ci. */
-        if (vweights) atomic_add_d(&weights_v[cid], w);
+        if (vweights) partition_add_vertex_cost(mydata, cid, w);
 
       }
 
@@ -1468,8 +1871,9 @@ static void partition_gather_weights(void *map_data, int num_elements,
 
         /* Local cells add weight to vertices. */
         if (vweights && ci->nodeID == nodeID) {
-          atomic_add_d(&weights_v[cid], 0.5 * w);
-          if (cj->nodeID == nodeID) atomic_add_d(&weights_v[cjd], 0.5 * w);
+          partition_add_vertex_cost(mydata, cid, 0.5 * w);
+          if (cj->nodeID == nodeID)
+            partition_add_vertex_cost(mydata, cjd, 0.5 * w);
         }
 
         if (eweights) {
@@ -1520,7 +1924,251 @@ static void partition_gather_weights(void *map_data, int num_elements,
       }
     }
   }
+
+#ifdef SWIFT_MPIUSE_REPORTS
+  atomic_add_d(&mydata->comms_bytes, comms_bytes);
+  atomic_add_d(&mydata->comms_ticks, comms_ticks);
+#endif
+}
+
+/**
+ * @brief Decide if a new partition is expected to recover the cost of
+ *        redistributing the particles within the number of steps given by
+ *        the payback_steps parameter.
+ *
+ * The gain of a step is the reduction of the task time of the slowest node,
+ * shared between its threads, according to the vertex weights. The cost of
+ * the redistribution is the largest amount of particle data a node has to
+ * send, at the bandwidth measured for the sends of the last step. Needs
+ * vertex weights that are task ticks and the MPI use reports for the
+ * bandwidth, otherwise all partitions are accepted.
+ *
+ * All the nodes need to call this function, they all get the same answer.
+ *
+ * @param repartition the partition struct of the local engine.
+ * @param nodeID our nodeID.
+ * @param nr_nodes the number of nodes.
+ * @param s the space of cells holding our local particles.
+ * @param weights_v the vertex weights of the cells, may be NULL.
+ * @param vsum_ticks the sum of the vertex weights in ticks, before any
+ *                   rescaling.
+ * @param celllist the new node of each cell.
+ * @param comms_bytes our bytes sent in the last step.
+ * @param comms_ticks our ticks taken by these sends.
+ *
+ * @return 1 if the new partition should be used, 0 otherwise.
+ */
+static int repart_pays_back(struct repartition *repartition, int nodeID,
+                            int nr_nodes, struct space *s,
+                            const double *weights_v, double vsum_ticks,
+                            const int *celllist, double comms_bytes,
+                            double comms_ticks) {
+
+  if (repartition->payback_steps <= 0.f || !repartition->use_ticks ||
+      weights_v == NULL)
+    return 1;
+
+  const int nr_cells = s->nr_cells;
+  const struct cell *cells = s->cells_top;
+
+  /* Bandwidth of all the sends of the last step. */
+  double comms[2] = {comms_bytes, comms_ticks};
+  int res = MPI_Allreduce(MPI_IN_PLACE, comms, 2, MPI_DOUBLE, MPI_SUM,
+                          MPI_COMM_WORLD);
+  if (res != MPI_SUCCESS) mpi_error(res, "Failed to allreduce comms costs.");
+
+  /* Size of the particles we would have to send. */
+  double moved = 0.0;
+  for (int k = 0; k < nr_cells; k++) {
+    if (cells[k].nodeID == nodeID && celllist[k] != nodeID) {
+      moved += cells[k].hydro.count *
+                   (double)(sizeof(struct part) + sizeof(struct xpart)) +
+               cells[k].grav.count * (double)sizeof(struct gpart) +
+               cells[k].stars.count * (double)sizeof(struct spart) +
+               cells[k].black_holes.count * (double)sizeof(struct bpart);
+    }
+  }
+  res = MPI_Allreduce(MPI_IN_PLACE, &moved, 1, MPI_DOUBLE, MPI_MAX,
+                      MPI_COMM_WORLD);
+  if (res != MPI_SUCCESS) mpi_error(res, "Failed to allreduce moved sizes.");
+
+  /* No measurements, nothing to decide with. */
+  if (comms[0] <= 0.0 || comms[1] <= 0.0) return 1;
+
+  /* Task time of the slowest node, before and after. */
+  double loads[2 * nr_nodes];
+  for (int k = 0; k < 2 * nr_nodes; k++) loads[k] = 0.0;
+  double wsum = 0.0;
+  for (int k = 0; k < nr_cells; k++) {
+    loads[cells[k].nodeID] += weights_v[k];
+    loads[nr_nodes + celllist[k]] += weights_v[k];
+    wsum += weights_v[k];
+  }
+  double max_old = 0.0;
+  double max_new = 0.0;
+  for (int k = 0; k < nr_nodes; k++) {
+    max_old = max(max_old, loads[k]);
+    max_new = max(max_new, loads[nr_nodes + k]);
+  }
+  if (wsum <= 0.0) return 1;
+
+  /* Convert to wall-clock ticks of a step. */
+  const double gain =
+      (max_old - max_new) * (vsum_ticks / wsum) / s->e->nr_threads;
+  const double cost = moved * comms[1] / comms[0];
+  const double payback = (gain > 0.0) ? cost / gain : FLT_MAX;
+
+  if (s->e->verbose)
+    message(
+        "predicted imbalance %.3f -> %.3f, redistribution %.3f %s, gain "
+        "%.3f %s per step, pays back in %.1f steps (limit %.1f).",
+        max_old * nr_nodes / wsum, max_new * nr_nodes / wsum,
+        clocks_from_ticks(cost), clocks_getunit(),
+        clocks_from_ticks(max(gain, 0.0)), clocks_getunit(), payback,
+        repartition->payback_steps);
+
+  return payback <= repartition->payback_steps;
+}
+
+/**
+ * @brief Repartition the cells amongst the nodes by cutting a space-filling
+ *        curve through them using the vertex weights of the tasks.
+ *
+ * Only needs the weights of the cells, not the graph, so it works without
+ * METIS and is cheap enough to be used often. As the regions are always
+ * the segments of the same curve, repartitioning moves their boundaries
+ * and only the cells around them change node.
+ *
+ * @param repartition the partition struct of the local engine.
+ * @param nodeID our nodeID.
+ * @param nr_nodes the number of nodes.
+ * @param s the space of cells holding our local particles.
+ * @param tasks the completed tasks from the last engine step for our node.
+ * @param nr_tasks the number of tasks.
+ *
+ * @return 1 if the cells have been repartitioned, 0 if the new partition
+ *         was not expected to pay back its cost.
+ */
+static int repart_sfc_costs(struct repartition *repartition, int nodeID,
+                            int nr_nodes, struct space *s, struct task *tasks,
+                            int nr_tasks) {
+
+  const int nr_cells = s->nr_cells;
+
+  /* Allocate and init the weights. */
+  double *weights_v = NULL;
+  if ((weights_v = (double *)calloc(nr_cells, sizeof(double))) == NULL)
+    error("Failed to allocate vertex weights arrays.");
+
+  /* Gather the vertex weights only. */
+  struct weights_mapper_data weights_data;
+  weights_data.cells = s->cells_top;
+  weights_data.eweights = 0;
+  weights_data.inds = NULL;
+  weights_data.nodeID = nodeID;
+  weights_data.nr_cells = nr_cells;
+  weights_data.timebins = 0;
+  weights_data.vweights = 1;
+  weights_data.weights_e = NULL;
+  weights_data.weights_v = weights_v;
+  weights_data.use_ticks = repartition->use_ticks;
+  weights_data.comms_costs = 0;
+  weights_data.comms_bytes = 0.0;
+  weights_data.comms_ticks = 0.0;
+
+  /* And the costs of the cells on the fast time-bins, if wanted. */
+  double *weights_f = NULL;
+  int *cell_bins = NULL;
+  weights_data.fast_bin = 0;
+  if (repartition->fast_bins > 0) {
+    if ((weights_f = (double *)calloc(nr_cells, sizeof(double))) == NULL ||
+        (cell_bins = (int *)malloc(sizeof(int) * nr_cells)) == NULL)
+      error("Failed to allocate fast time-bins weights arrays.");
+    weights_data.fast_bin =
+        partition_cell_bins(s, repartition->fast_bins, cell_bins);
+  }
+  weights_data.weights_f = weights_f;
+  weights_data.cell_bins = cell_bins;
+
+  ticks tic = getticks();
+
+  threadpool_map(&s->e->threadpool, partition_gather_weights, tasks, nr_tasks,
+                 sizeof(struct task), threadpool_auto_chunk_size,
+                 &weights_data);
+  if (s->e->verbose)
+    message("weight mapper took %.3f %s.", clocks_from_ticks(getticks() - tic),
+            clocks_getunit());
+
+#ifdef SWIFT_DEBUG_CHECKS
+  check_weights(tasks, nr_tasks, &weights_data, weights_v, NULL);
+#endif
+
+  /* Merge the weights across all nodes. */
+  int res = MPI_Allreduce(MPI_IN_PLACE, weights_v, nr_cells, MPI_DOUBLE,
+                          MPI_SUM, MPI_COMM_WORLD);
+  if (res != MPI_SUCCESS) mpi_error(res, "Failed to allreduce vertex weights.");
+  if (weights_f != NULL) {
+    res = MPI_Allreduce(MPI_IN_PLACE, weights_f, nr_cells, MPI_DOUBLE, MPI_SUM,
+                        MPI_COMM_WORLD);
+    if (res != MPI_SUCCESS)
+      mpi_error(res, "Failed to allreduce fast time-bins weights.");
+  }
+
+  /* Allocate cell list for the partition. If not already done. */
+  if (repartition->ncelllist != nr_cells) {
+    free(repartition->celllist);
+    repartition->ncelllist = 0;
+    if ((repartition->celllist = (int *)malloc(sizeof(int) * nr_cells)) == NULL)
+      error("Failed to allocate celllist");
+    repartition->ncelllist = nr_cells;
+  }
+
+  /* Cut the curve, all nodes get the same answer. */
+  pick_sfc(s, nr_nodes, repartition->sfc_curve, weights_v, weights_f,
+           repartition->celllist);
+  if (s->e->verbose && weights_f != NULL)
+    message("imbalance of all bins %.3f -> %.3f, of bins <= %d %.3f -> %.3f.",
+            partition_imbalance(nr_nodes, s, weights_v, NULL),
+            partition_imbalance(nr_nodes, s, weights_v, repartition->celllist),
+            weights_data.fast_bin,
+            partition_imbalance(nr_nodes, s, weights_f, NULL),
+            partition_imbalance(nr_nodes, s, weights_f, repartition->celllist));
+
+  /* Is it worth moving the particles? */
+  double vsum = 0.0;
+  for (int k = 0; k < nr_cells; k++) vsum += weights_v[k];
+  if (!repart_pays_back(repartition, nodeID, nr_nodes, s, weights_v, vsum,
+                        repartition->celllist, weights_data.comms_bytes,
+                        weights_data.comms_ticks)) {
+    if (s->e->verbose) message("keeping the current partition.");
+    for (int k = 0; k < nr_cells; k++)
+      repartition->celllist[k] = s->cells_top[k].nodeID;
+    free(weights_v);
+    free(weights_f);
+    free(cell_bins);
+    return 0;
+  }
+
+  /* Report how many cells moved. */
+  if (s->e->verbose) {
+    int moved = 0;
+    for (int k = 0; k < nr_cells; k++)
+      if (repartition->celllist[k] != s->cells_top[k].nodeID) moved++;
+    message("%d of %d cells changed node.", moved, nr_cells);
+  }
+
+  /* And apply to our cells */
+  for (int k = 0; k < nr_cells; k++)
+    s->cells_top[k].nodeID = repartition->celllist[k];
+
+  free(weights_v);
+  free(weights_f);
+  free(cell_bins);
+  return 1;
 }
+#endif
+
+#if defined(WITH_MPI) && (defined(HAVE_METIS) || defined(HAVE_PARMETIS))
 
 /**
  * @brief Repartition the cells amongst the nodes using weights of
@@ -1535,11 +2183,14 @@ static void partition_gather_weights(void *map_data, int num_elements,
  * @param s the space of cells holding our local particles.
  * @param tasks the completed tasks from the last engine step for our node.
  * @param nr_tasks the number of tasks.
+ *
+ * @return 1 if the cells have been repartitioned, 0 if the new partition
+ *         was not expected to pay back its cost.
  */
-static void repart_edge_metis(int vweights, int eweights, int timebins,
-                              struct repartition *repartition, int nodeID,
-                              int nr_nodes, struct space *s, struct task *tasks,
-                              int nr_tasks) {
+static int repart_edge_metis(int vweights, int eweights, int timebins,
+                             struct repartition *repartition, int nodeID,
+                             int nr_nodes, struct space *s, struct task *tasks,
+                             int nr_tasks) {
 
   /* Create weight arrays using task ticks for vertices and edges (edges
    * assume the same graph structure as used in the part_ calls). */
@@ -1583,6 +2234,25 @@ static void repart_edge_metis(int vweights, int eweights, int timebins,
   weights_data.weights_e = weights_e;
   weights_data.weights_v = weights_v;
   weights_data.use_ticks = repartition->use_ticks;
+  weights_data.comms_costs =
+      repartition->comms_costs && eweights && !timebins;
+  weights_data.comms_bytes = 0.0;
+  weights_data.comms_ticks = 0.0;
+
+  /* And the costs of the cells on the fast time-bins, if wanted. These
+   * become a second constraint of the partition. */
+  double *weights_f = NULL;
+  int *cell_bins = NULL;
+  weights_data.fast_bin = 0;
+  if (vweights && repartition->fast_bins > 0) {
+    if ((weights_f = (double *)calloc(nr_cells, sizeof(double))) == NULL ||
+        (cell_bins = (int *)malloc(sizeof(int) * nr_cells)) == NULL)
+      error("Failed to allocate fast time-bins weights arrays.");
+    weights_data.fast_bin =
+        partition_cell_bins(s, repartition->fast_bins, cell_bins);
+  }
+  weights_data.weights_f = weights_f;
+  weights_data.cell_bins = cell_bins;
 
   ticks tic = getticks();
 
@@ -1605,6 +2275,12 @@ static void repart_edge_metis(int vweights, int eweights, int timebins,
     if (res != MPI_SUCCESS)
       mpi_error(res, "Failed to allreduce vertex weights.");
   }
+  if (weights_f != NULL) {
+    res = MPI_Allreduce(MPI_IN_PLACE, weights_f, nr_cells, MPI_DOUBLE, MPI_SUM,
+                        MPI_COMM_WORLD);
+    if (res != MPI_SUCCESS)
+      mpi_error(res, "Failed to allreduce fast time-bins weights.");
+  }
 
   if (eweights) {
     res = MPI_Allreduce(MPI_IN_PLACE, weights_e, 26 * nr_cells, MPI_DOUBLE,
@@ -1635,6 +2311,7 @@ static void repart_edge_metis(int vweights, int eweights, int timebins,
   double esum = 0.0;
   if (eweights)
     for (int k = 0; k < 26 * nr_cells; k++) esum += weights_e[k];
+  const double vsum_ticks = vsum;
 
   /* Do the scaling, if needed, keeping both weights in proportion. */
   double vscale = 1.0;
@@ -1692,19 +2369,42 @@ static void repart_edge_metis(int vweights, int eweights, int timebins,
     }
   }
 
+  /* With the fast time-bins, the vertex weights become pairs of the total
+   * and fast costs, the latter scaled like the former. */
+  double *vertexw = weights_v;
+  int ncon = 1;
+  double fsum = 0.0;
+  if (weights_f != NULL)
+    for (int k = 0; k < nr_cells; k++) fsum += weights_f[k];
+  if (fsum > 0.0 && vsum_ticks > 0.0) {
+    double wsum = 0.0;
+    for (int k = 0; k < nr_cells; k++) wsum += weights_v[k];
+    const double fscale = wsum / vsum_ticks;
+
+    if ((vertexw = (double *)malloc(sizeof(double) * 2 * nr_cells)) == NULL)
+      error("Failed to allocate constraints weights array.");
+    for (int k = 0; k < nr_cells; k++) {
+      vertexw[2 * k + 0] = weights_v[k];
+      vertexw[2 * k + 1] = weights_f[k] * fscale;
+    }
+    ncon = 2;
+  }
+
   /* And repartition/ partition, using both weights or not as requested. */
 #ifdef HAVE_PARMETIS
   if (repartition->usemetis) {
-    pick_metis(nodeID, s, nr_nodes, weights_v, weights_e,
+    pick_metis(nodeID, s, nr_nodes, vertexw, ncon, weights_e,
                repartition->celllist);
   } else {
-    pick_parmetis(nodeID, s, nr_nodes, weights_v, weights_e, refine,
+    pick_parmetis(nodeID, s, nr_nodes, vertexw, ncon, weights_e, refine,
                   repartition->adaptive, repartition->itr,
                   repartition->celllist);
   }
 #else
-  pick_metis(nodeID, s, nr_nodes, weights_v, weights_e, repartition->celllist);
+  pick_metis(nodeID, s, nr_nodes, vertexw, ncon, weights_e,
+             repartition->celllist);
 #endif
+  if (vertexw != weights_v) free(vertexw);
 
   /* Check that all cells have good values. All nodes have same copy, so just
    * check on one. */
@@ -1736,6 +2436,26 @@ static void repart_edge_metis(int vweights, int eweights, int timebins,
       repartition->celllist[k] = cells[k].nodeID;
   }
 
+  /* Is it worth moving the particles? */
+  int repartitioned = 1;
+  if (!failed && !repart_pays_back(repartition, nodeID, nr_nodes, s,
+                                   weights_v, vsum_ticks,
+                                   repartition->celllist,
+                                   weights_data.comms_bytes,
+                                   weights_data.comms_ticks)) {
+    if (s->e->verbose) message("keeping the current partition.");
+    for (int k = 0; k < nr_cells; k++)
+      repartition->celllist[k] = cells[k].nodeID;
+    repartitioned = 0;
+  }
+  if (s->e->verbose && repartitioned && weights_f != NULL)
+    message("imbalance of all bins %.3f -> %.3f, of bins <= %d %.3f -> %.3f.",
+            partition_imbalance(nr_nodes, s, weights_v, NULL),
+            partition_imbalance(nr_nodes, s, weights_v, repartition->celllist),
+            weights_data.fast_bin,
+            partition_imbalance(nr_nodes, s, weights_f, NULL),
+            partition_imbalance(nr_nodes, s, weights_f, repartition->celllist));
+
   /* And apply to our cells */
   split_metis(s, nr_nodes, repartition->celllist);
 
@@ -1743,6 +2463,10 @@ static void repart_edge_metis(int vweights, int eweights, int timebins,
   free(inds);
   if (vweights) free(weights_v);
   if (eweights) free(weights_e);
+  free(weights_f);
+  free(cell_bins);
+
+  return repartitioned;
 }
 
 /**
@@ -1793,14 +2517,14 @@ static void repart_memory_metis(struct repartition *repartition, int nodeID,
   /* And repartition. */
 #ifdef HAVE_PARMETIS
   if (repartition->usemetis) {
-    pick_metis(nodeID, s, nr_nodes, weights, NULL, repartition->celllist);
+    pick_metis(nodeID, s, nr_nodes, weights, 1, NULL, repartition->celllist);
   } else {
-    pick_parmetis(nodeID, s, nr_nodes, weights, NULL, refine,
+    pick_parmetis(nodeID, s, nr_nodes, weights, 1, NULL, refine,
                   repartition->adaptive, repartition->itr,
                   repartition->celllist);
   }
 #else
-  pick_metis(nodeID, s, nr_nodes, weights, NULL, repartition->celllist);
+  pick_metis(nodeID, s, nr_nodes, weights, 1, NULL, repartition->celllist);
 #endif
 
   /* Check that all cells have good values. All nodes have same copy, so just
@@ -1850,29 +2574,39 @@ static void repart_memory_metis(struct repartition *repartition, int nodeID,
  * @param s the space of cells holding our local particles.
  * @param tasks the completed tasks from the last engine step for our node.
  * @param nr_tasks the number of tasks.
+ *
+ * @return 1 if the cells have been repartitioned, 0 if the current partition
+ *         has been kept as the new one was not worth the redistribution.
  */
-void partition_repartition(struct repartition *reparttype, int nodeID,
-                           int nr_nodes, struct space *s, struct task *tasks,
-                           int nr_tasks) {
+int partition_repartition(struct repartition *reparttype, int nodeID,
+                          int nr_nodes, struct space *s, struct task *tasks,
+                          int nr_tasks) {
 
-#if defined(WITH_MPI) && (defined(HAVE_METIS) || defined(HAVE_PARMETIS))
+#if defined(WITH_MPI)
 
   ticks tic = getticks();
+  int repartitioned = 1;
+
+  if (reparttype->type == REPART_SFC_COSTS) {
+    repartitioned =
+        repart_sfc_costs(reparttype, nodeID, nr_nodes, s, tasks, nr_tasks);
 
-  if (reparttype->type == REPART_METIS_VERTEX_EDGE_COSTS) {
-    repart_edge_metis(1, 1, 0, reparttype, nodeID, nr_nodes, s, tasks,
-                      nr_tasks);
+#if defined(HAVE_METIS) || defined(HAVE_PARMETIS)
+  } else if (reparttype->type == REPART_METIS_VERTEX_EDGE_COSTS) {
+    repartitioned = repart_edge_metis(1, 1, 0, reparttype, nodeID, nr_nodes,
+                                      s, tasks, nr_tasks);
 
   } else if (reparttype->type == REPART_METIS_EDGE_COSTS) {
-    repart_edge_metis(0, 1, 0, reparttype, nodeID, nr_nodes, s, tasks,
-                      nr_tasks);
+    repartitioned = repart_edge_metis(0, 1, 0, reparttype, nodeID, nr_nodes,
+                                      s, tasks, nr_tasks);
 
   } else if (reparttype->type == REPART_METIS_VERTEX_COSTS_TIMEBINS) {
-    repart_edge_metis(1, 1, 1, reparttype, nodeID, nr_nodes, s, tasks,
-                      nr_tasks);
+    repartitioned = repart_edge_metis(1, 1, 1, reparttype, nodeID, nr_nodes,
+                                      s, tasks, nr_tasks);
 
   } else if (reparttype->type == REPART_METIS_VERTEX_COUNTS) {
     repart_memory_metis(reparttype, nodeID, nr_nodes, s);
+#endif
 
   } else if (reparttype->type == REPART_NONE) {
     /* Doing nothing. */
@@ -1884,8 +2618,11 @@ void partition_repartition(struct repartition *reparttype, int nodeID,
   if (s->e->verbose)
     message("took %.3f %s.", clocks_from_ticks(getticks() - tic),
             clocks_getunit());
+
+  return repartitioned;
 #else
-  error("SWIFT was not compiled with METIS or ParMETIS support.");
+  error("SWIFT was not compiled with MPI support.");
+  return 0;
 #endif
 }
 
@@ -1979,13 +2716,13 @@ void partition_initial_partition(struct partition *initial_partition,
       error("Failed to allocate celllist");
 #ifdef HAVE_PARMETIS
     if (initial_partition->usemetis) {
-      pick_metis(nodeID, s, nr_nodes, weights_v, weights_e, celllist);
+      pick_metis(nodeID, s, nr_nodes, weights_v, 1, weights_e, celllist);
     } else {
-      pick_parmetis(nodeID, s, nr_nodes, weights_v, weights_e, 0, 0, 0.0f,
+      pick_parmetis(nodeID, s, nr_nodes, weights_v, 1, weights_e, 0, 0, 0.0f,
                     celllist);
     }
 #else
-    pick_metis(nodeID, s, nr_nodes, weights_v, weights_e, celllist);
+    pick_metis(nodeID, s, nr_nodes, weights_v, 1, weights_e, celllist);
 #endif
 
     /* And apply to our cells */
@@ -2007,6 +2744,40 @@ void partition_initial_partition(struct partition *initial_partition,
     error("SWIFT was not compiled with METIS or ParMETIS support");
 #endif
 
+  } else if (initial_partition->type == INITPART_SFC) {
+#if defined(WITH_MPI)
+    /* Segments of a space-filling curve through the cells holding equal
+     * amounts of particle memory. Cheap and does not need METIS. */
+    double *weights_v = NULL;
+    if ((weights_v = (double *)malloc(sizeof(double) * s->nr_cells)) == NULL)
+      error("Failed to allocate weights_v buffer.");
+
+    /* Check each particle and accumulate the sizes per cell. */
+    accumulate_sizes(s, s->e->verbose, weights_v);
+
+    int *celllist = NULL;
+    if ((celllist = (int *)malloc(sizeof(int) * s->nr_cells)) == NULL)
+      error("Failed to allocate celllist");
+    pick_sfc(s, nr_nodes, initial_partition->sfc_curve, weights_v, NULL,
+             celllist);
+
+    /* And apply to our cells */
+    for (int k = 0; k < s->nr_cells; k++) s->cells_top[k].nodeID = celllist[k];
+
+    /* Should not fail, but check for this before proceeding. */
+    if (!check_complete(s, (nodeID == 0), nr_nodes)) {
+      if (nodeID == 0)
+        message("SFC initial partition failed, using a vectorised partition");
+      initial_partition->type = INITPART_VECTORIZE;
+      partition_initial_partition(initial_partition, nodeID, nr_nodes, s);
+    }
+
+    free(weights_v);
+    free(celllist);
+#else
+    error("SWIFT was not compiled with MPI support");
+#endif
+
   } else if (initial_partition->type == INITPART_VECTORIZE) {
 
 #if defined(WITH_MPI)
@@ -2080,6 +2851,9 @@ void partition_init(struct partition *partition,
     case 'v':
       partition->type = INITPART_VECTORIZE;
       break;
+    case 's':
+      partition->type = INITPART_SFC;
+      break;
 #if defined(HAVE_METIS) || defined(HAVE_PARMETIS)
     case 'r':
       partition->type = INITPART_METIS_NOWEIGHT;
@@ -2093,13 +2867,13 @@ void partition_init(struct partition *partition,
     default:
       message("Invalid choice of initial partition type '%s'.", part_type);
       error(
-          "Permitted values are: 'grid', 'region', 'memory', 'edgememory' or "
-          "'vectorized'");
+          "Permitted values are: 'grid', 'region', 'memory', 'edgememory', "
+          "'sfc' or 'vectorized'");
 #else
     default:
       message("Invalid choice of initial partition type '%s'.", part_type);
       error(
-          "Permitted values are: 'grid' or 'vectorized' when compiled "
+          "Permitted values are: 'grid', 'sfc' or 'vectorized' when compiled "
           "without METIS or ParMETIS.");
 #endif
   }
@@ -2117,6 +2891,9 @@ void partition_init(struct partition *partition,
   if (strcmp("none", part_type) == 0) {
     repartition->type = REPART_NONE;
 
+  } else if (strcmp("sfccosts", part_type) == 0) {
+    repartition->type = REPART_SFC_COSTS;
+
 #if defined(HAVE_METIS) || defined(HAVE_PARMETIS)
   } else if (strcmp("fullcosts", part_type) == 0) {
     repartition->type = REPART_METIS_VERTEX_EDGE_COSTS;
@@ -2134,16 +2911,29 @@ void partition_init(struct partition *partition,
     message("Invalid choice of re-partition type '%s'.", part_type);
     error(
         "Permitted values are: 'none', 'fullcosts', 'edgecosts' "
-        "'memory' or 'timecosts'");
+        "'memory', 'timecosts' or 'sfccosts'");
 #else
   } else {
     message("Invalid choice of re-partition type '%s'.", part_type);
     error(
-        "Permitted values are: 'none' when compiled without "
+        "Permitted values are: 'none' or 'sfccosts' when compiled without "
         "METIS or ParMETIS.");
 #endif
   }
 
+  /* The space-filling curve to use with the 'sfc' and 'sfccosts' types. */
+  parser_get_opt_param_string(params, "DomainDecomposition:sfc_curve",
+                              part_type, "hilbert");
+  if (strcmp("hilbert", part_type) == 0) {
+    partition->sfc_curve = SFC_HILBERT;
+  } else if (strcmp("morton", part_type) == 0) {
+    partition->sfc_curve = SFC_MORTON;
+  } else {
+    message("Invalid choice of space-filling curve '%s'.", part_type);
+    error("Permitted values are: 'hilbert' or 'morton'");
+  }
+  repartition->sfc_curve = partition->sfc_curve;
+
   /* Get the fraction CPU time difference between nodes (<1) or the number
    * of steps between repartitions (>1). */
   repartition->trigger =
@@ -2177,6 +2967,36 @@ void partition_init(struct partition *partition,
   repartition->itr =
       parser_get_opt_param_float(params, "DomainDecomposition:itr", 100.0f);
 
+  /* Add the measured times of the MPI sends to the edge weights. */
+  repartition->comms_costs =
+      parser_get_opt_param_int(params, "DomainDecomposition:comms_costs", 0);
+
+  /* Only accept new partitions that recover the cost of the redistribution
+   * within this number of steps, 0 to accept all. */
+  repartition->payback_steps = parser_get_opt_param_float(
+      params, "DomainDecomposition:payback_steps", 0.f);
+  if (repartition->payback_steps < 0.f)
+    error("Invalid DomainDecomposition:payback_steps, must not be negative");
+
+  /* Also balance the costs of the cells on this number of the shortest
+   * time-bins, 0 to only balance the total costs. */
+  repartition->fast_bins =
+      parser_get_opt_param_int(params, "DomainDecomposition:fast_bins", 0);
+  if (repartition->fast_bins < 0)
+    error("Invalid DomainDecomposition:fast_bins, must not be negative");
+
+#ifndef SWIFT_MPIUSE_REPORTS
+  /* Both need the measurements of the MPI use reports. */
+  if (repartition->comms_costs || repartition->payback_steps > 0.f) {
+    if (engine_rank == 0)
+      message(
+          "WARNING: communication costs for repartitioning need "
+          "--enable-mpiuse-reports, not using them.");
+    repartition->comms_costs = 0;
+    repartition->payback_steps = 0.f;
+  }
+#endif
+
   /* Clear the celllist for use. */
   repartition->ncelllist = 0;
   repartition->celllist = NULL;
@@ -2221,7 +3041,7 @@ void partition_init(struct partition *partition,
  */
 static int repart_init_fixed_costs(void) {
 
-#if defined(WITH_MPI) && (defined(HAVE_METIS) || defined(HAVE_PARMETIS))
+#if defined(WITH_MPI)
   /* Set the default fixed cost. */
   for (int j = 0; j < task_type_count; j++) {
     for (int k = 0; k < task_subtype_count; k++) {
@@ -2274,7 +3094,7 @@ static int check_complete(struct space *s, int verbose, int nregions) {
   return (!failed);
 }
 
-#if defined(WITH_MPI) && (defined(HAVE_METIS) || defined(HAVE_PARMETIS))
+#if defined(WITH_MPI)
 #ifdef SWIFT_DEBUG_CHECKS
 /**
  * @brief Check that the threadpool version of the weights construction is
@@ -2320,6 +3140,15 @@ static void check_weights(struct task *tasks, int nr_tasks,
     /* Get a pointer to the kth task. */
     struct task *t = &tasks[j];
 
+#ifdef SWIFT_MPIUSE_REPORTS
+    /* Measured times of the sends. */
+    if (t->type == task_type_send && t->cj != NULL && t->mpi_ticks > 0) {
+      if (mydata->comms_costs)
+        partition_add_send_cost(t, cells, nr_cells, inds, weights_e);
+      continue;
+    }
+#endif
+
     /* Skip un-interesting tasks. */
     if (t->type == task_type_send || t->type == task_type_recv ||
         t->type == task_type_logger || t->implicit || t->ci == NULL)
@@ -2447,7 +3276,7 @@ static void check_weights(struct task *tasks, int nr_tasks,
   }
   if (fabs(sum - refsum) > 1.0) {
     error("vertex partition weights are not consistent (%f!=%f)", sum, refsum);
-  } else {
+  } else if (eweights) {
     refsum = 0.0;
     sum = 0.0;
     for (int k = 0; k < 26 * nr_cells; k++) {
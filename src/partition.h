@@ -29,9 +29,13 @@ enum partition_type {
   INITPART_VECTORIZE,
   INITPART_METIS_WEIGHT,
   INITPART_METIS_NOWEIGHT,
-  INITPART_METIS_WEIGHT_EDGE
+  INITPART_METIS_WEIGHT_EDGE,
+  INITPART_SFC
 };
 
+/* Space-filling curves for the SFC partitions. */
+enum partition_sfc_type { SFC_HILBERT = 0, SFC_MORTON };
+
 /* Simple descriptions of types for reports. */
 extern const char *initial_partition_name[];
 
@@ -40,6 +44,7 @@ struct partition {
   enum partition_type type;
   int grid[3];
   int usemetis;
+  int sfc_curve;
 };
 
 /* Repartition type to use. */
@@ -48,7 +53,8 @@ enum repartition_type {
   REPART_METIS_VERTEX_EDGE_COSTS,
   REPART_METIS_EDGE_COSTS,
   REPART_METIS_VERTEX_COUNTS,
-  REPART_METIS_VERTEX_COSTS_TIMEBINS
+  REPART_METIS_VERTEX_COSTS_TIMEBINS,
+  REPART_SFC_COSTS
 };
 
 /* Repartition preferences. */
@@ -59,6 +65,10 @@ struct repartition {
   float itr;
   int usemetis;
   int adaptive;
+  int sfc_curve;
+  int comms_costs;
+  float payback_steps;
+  int fast_bins;
 
   int use_fixed_costs;
   int use_ticks;
@@ -71,9 +81,9 @@ struct repartition {
 /* Simple descriptions of types for reports. */
 extern const char *repartition_name[];
 
-void partition_repartition(struct repartition *reparttype, int nodeID,
-                           int nr_nodes, struct space *s, struct task *tasks,
-                           int nr_tasks);
+int partition_repartition(struct repartition *reparttype, int nodeID,
+                          int nr_nodes, struct space *s, struct task *tasks,
+                          int nr_tasks);
 void partition_initial_partition(struct partition *initial_partition,
                                  int nodeID, int nr_nodes, struct space *s);
 
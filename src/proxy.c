@@ -39,6 +39,7 @@
 
 /* Local headers. */
 #include "cell.h"
+#include "chashmap.h"
 #include "engine.h"
 #include "error.h"
 #include "memuse.h"
@@ -187,6 +188,158 @@ void proxy_tags_exchange(struct proxy *proxies, int num_proxies,
 #endif
 }
 
+#ifdef DEBUG_INTERACTIONS_STARS
+/**
+ * @brief The feedback neighbour counter of a foreign #spart, sent back to
+ * the node owning the star.
+ */
+struct proxy_stars_counter {
+
+  /*! ID of the #spart */
+  long long id;
+
+  /*! Number of neighbours found in the feedback loop */
+  int num_ngb_feedback;
+};
+
+/**
+ * @brief Send the feedback neighbour counters of the foreign stars back to
+ * their home node and add them to the counters of the local stars.
+ *
+ * Each node only exchanges data with its proxies, i.e. it only receives the
+ * counters of the copies of its own stars. The counters of the foreign stars
+ * are reset once they have been sent.
+ *
+ * @param proxies The list of #proxy that will send/recv the counters.
+ * @param num_proxies The number of proxies.
+ * @param s The #space.
+ */
+void proxy_stars_counters_exchange(struct proxy *proxies, int num_proxies,
+                                   struct space *s) {
+
+#ifdef WITH_MPI
+
+  const ticks tic = getticks();
+
+  /* Count the foreign stars going back to each proxy */
+  int *counts = (int *)malloc(2 * num_proxies * sizeof(int) + 1);
+  MPI_Request *reqs =
+      (MPI_Request *)malloc(2 * num_proxies * sizeof(MPI_Request) + 1);
+  if (counts == NULL || reqs == NULL)
+    error("Failed to allocate the star counter exchange buffers.");
+  int *counts_out = counts;
+  int *counts_in = &counts[num_proxies];
+
+  int count_out = 0;
+  for (int k = 0; k < num_proxies; k++) {
+    counts_out[k] = 0;
+    for (int j = 0; j < proxies[k].nr_cells_in; j++)
+      counts_out[k] += proxies[k].cells_in[j]->stars.count;
+    count_out += counts_out[k];
+  }
+
+  /* Tell everyone how much they will receive */
+  for (int k = 0; k < num_proxies; k++) {
+    int err = MPI_Irecv(&counts_in[k], 1, MPI_INT, proxies[k].nodeID,
+                        proxies[k].nodeID * proxy_tag_shift + proxy_tag_count,
+                        MPI_COMM_WORLD, &reqs[k]);
+    if (err != MPI_SUCCESS) mpi_error(err, "Failed to irecv star counts.");
+    err = MPI_Isend(&counts_out[k], 1, MPI_INT, proxies[k].nodeID,
+                    proxies[k].mynodeID * proxy_tag_shift + proxy_tag_count,
+                    MPI_COMM_WORLD, &reqs[num_proxies + k]);
+    if (err != MPI_SUCCESS) mpi_error(err, "Failed to isend star counts.");
+  }
+  if (MPI_Waitall(2 * num_proxies, reqs, MPI_STATUSES_IGNORE) != MPI_SUCCESS)
+    error("MPI_Waitall on star counts failed.");
+
+  int count_in = 0;
+  for (int k = 0; k < num_proxies; k++) count_in += counts_in[k];
+
+  struct proxy_stars_counter *buff_in = NULL;
+  struct proxy_stars_counter *buff_out = NULL;
+  if (swift_memalign("stars_counters_in", (void **)&buff_in,
+                     SWIFT_CACHE_ALIGNMENT,
+                     sizeof(struct proxy_stars_counter) * (count_in + 1)) !=
+          0 ||
+      swift_memalign("stars_counters_out", (void **)&buff_out,
+                     SWIFT_CACHE_ALIGNMENT,
+                     sizeof(struct proxy_stars_counter) * (count_out + 1)) != 0)
+    error("Failed to allocate star counter buffers.");
+
+  /* Pack the counters of the foreign stars and reset them */
+  int offset = 0;
+  for (int k = 0; k < num_proxies; k++) {
+    for (int j = 0; j < proxies[k].nr_cells_in; j++) {
+      struct spart *sparts = proxies[k].cells_in[j]->stars.parts;
+      for (int i = 0; i < proxies[k].cells_in[j]->stars.count; i++) {
+        buff_out[offset].id = sparts[i].id;
+        buff_out[offset].num_ngb_feedback = sparts[i].num_ngb_feedback;
+        sparts[i].num_ngb_feedback = 0;
+        offset++;
+      }
+    }
+  }
+
+  /* Ship them */
+  for (int offset_in = 0, offset_out = 0, k = 0; k < num_proxies; k++) {
+    int err = MPI_Irecv(&buff_in[offset_in],
+                        counts_in[k] * sizeof(struct proxy_stars_counter),
+                        MPI_BYTE, proxies[k].nodeID,
+                        proxies[k].nodeID * proxy_tag_shift + proxy_tag_sparts,
+                        MPI_COMM_WORLD, &reqs[k]);
+    if (err != MPI_SUCCESS) mpi_error(err, "Failed to irecv star counters.");
+    err = MPI_Isend(&buff_out[offset_out],
+                    counts_out[k] * sizeof(struct proxy_stars_counter),
+                    MPI_BYTE, proxies[k].nodeID,
+                    proxies[k].mynodeID * proxy_tag_shift + proxy_tag_sparts,
+                    MPI_COMM_WORLD, &reqs[num_proxies + k]);
+    if (err != MPI_SUCCESS) mpi_error(err, "Failed to isend star counters.");
+    offset_in += counts_in[k];
+    offset_out += counts_out[k];
+  }
+
+  /* Index the local stars by ID while the data is in flight */
+  struct chashmap map;
+  chashmap_init(&map, s->nr_sparts, sizeof(size_t));
+  for (size_t i = 0; i < s->nr_sparts; i++) {
+    if (s->sparts[i].time_bin == time_bin_inhibited ||
+        s->sparts[i].time_bin == time_bin_not_created)
+      continue;
+    *(size_t *)chashmap_get(&map, (chashmap_key_t)s->sparts[i].id) = i;
+  }
+
+  /* None of the foreign stars should be one of ours */
+  for (int i = 0; i < count_out; i++)
+    if (chashmap_lookup(&map, (chashmap_key_t)buff_out[i].id) != NULL)
+      error("Found a local spart in foreign cell ID=%lld", buff_out[i].id);
+
+  if (MPI_Waitall(2 * num_proxies, reqs, MPI_STATUSES_IGNORE) != MPI_SUCCESS)
+    error("MPI_Waitall on star counters failed.");
+
+  /* Add the counters to the local stars */
+  for (int i = 0; i < count_in; i++) {
+    const size_t *index =
+        (const size_t *)chashmap_lookup(&map, (chashmap_key_t)buff_in[i].id);
+    if (index != NULL)
+      s->sparts[*index].num_ngb_feedback += buff_in[i].num_ngb_feedback;
+  }
+
+  chashmap_free(&map);
+  swift_free("stars_counters_in", buff_in);
+  swift_free("stars_counters_out", buff_out);
+  free(counts);
+  free(reqs);
+
+  if (s->e->verbose)
+    message("took %.3f %s.", clocks_from_ticks(getticks() - tic),
+            clocks_getunit());
+
+#else
+  error("SWIFT was not compiled with MPI support.");
+#endif
+}
+#endif /* DEBUG_INTERACTIONS_STARS */
+
 /**
  * @brief Exchange cells with a remote node, first part.
  *
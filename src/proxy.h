@@ -113,6 +113,10 @@ void proxy_cells_exchange(struct proxy *proxies, int num_proxies,
                           struct space *s, int with_gravity);
 void proxy_tags_exchange(struct proxy *proxies, int num_proxies,
                          struct space *s);
+#ifdef DEBUG_INTERACTIONS_STARS
+void proxy_stars_counters_exchange(struct proxy *proxies, int num_proxies,
+                                   struct space *s);
+#endif
 void proxy_create_mpi_type(void);
 void proxy_free_mpi_type(void);
 
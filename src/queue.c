@@ -21,6 +21,7 @@
 #include "../config.h"
 
 /* Some standard headers. */
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -102,6 +103,144 @@ int queue_sift_down(struct queue *q, int ind) {
   return ind;
 }
 
+/**
+ * @brief Allocate a new #queue_deque_array.
+ *
+ * @param size The number of elements, must be a power of two.
+ * @param retired The array this one replaces, if any.
+ */
+static struct queue_deque_array *queue_deque_array_new(
+    const long long size, struct queue_deque_array *retired) {
+
+  struct queue_deque_array *a = (struct queue_deque_array *)malloc(
+      sizeof(struct queue_deque_array) + sizeof(int) * size);
+  if (a == NULL) error("Failed to allocate deque array.");
+  a->size = size;
+  a->retired = retired;
+  return a;
+}
+
+/**
+ * @brief Push a task offset at the bottom of a #queue_deque.
+ *
+ * Must only be called by the owner of the deque, i.e. with the #queue lock
+ * held.
+ *
+ * @param d The #queue_deque.
+ * @param tid The offset of the task.
+ */
+static void queue_deque_push(struct queue_deque *d, const int tid) {
+
+  const long long b = d->bottom;
+  const long long t = d->top;
+  struct queue_deque_array *a = d->array;
+
+  /* Does the array need to be grown? The old one is only retired as
+   * thieves may still be reading from it. */
+  if (b - t >= a->size) {
+    struct queue_deque_array *temp = queue_deque_array_new(2 * a->size, a);
+    for (long long k = t; k < b; k++)
+      temp->tids[k & (temp->size - 1)] = a->tids[k & (a->size - 1)];
+    __sync_synchronize();
+    d->array = a = temp;
+  }
+
+  a->tids[b & (a->size - 1)] = tid;
+
+  /* Make the element visible before publishing the new bottom. */
+  __sync_synchronize();
+  d->bottom = b + 1;
+}
+
+/**
+ * @brief Pop the task offset at the bottom of a #queue_deque.
+ *
+ * Must only be called by the owner of the deque, i.e. with the #queue lock
+ * held.
+ *
+ * @param d The #queue_deque.
+ *
+ * @return The task offset or -1 if the deque is empty.
+ */
+static int queue_deque_pop(struct queue_deque *d) {
+
+  const long long b = d->bottom - 1;
+  struct queue_deque_array *a = d->array;
+  d->bottom = b;
+  __sync_synchronize();
+  const long long t = d->top;
+
+  /* Empty deque? */
+  if (t > b) {
+    d->bottom = b + 1;
+    return -1;
+  }
+
+  int tid = a->tids[b & (a->size - 1)];
+
+  /* Last element, race against the thieves for it. */
+  if (t == b) {
+    if (atomic_cas(&d->top, t, t + 1) != t) tid = -1;
+    d->bottom = b + 1;
+  }
+
+  return tid;
+}
+
+/**
+ * @brief Steal the task offset at the top of a #queue_deque.
+ *
+ * Can be called by any thread without holding any lock.
+ *
+ * @param d The #queue_deque.
+ *
+ * @return The task offset, -1 if the deque is empty or -2 if we lost a race
+ * against another thread.
+ */
+static int queue_deque_steal(struct queue_deque *d) {
+
+  const long long t = d->top;
+  __sync_synchronize();
+  const long long b = d->bottom;
+
+  if (t >= b) return -1;
+
+  const struct queue_deque_array *a = d->array;
+  const int tid = a->tids[t & (a->size - 1)];
+
+  if (atomic_cas(&d->top, t, t + 1) != t) return -2;
+
+  return tid;
+}
+
+/**
+ * @brief Return the #queue_deque bucket in which a task of a given weight
+ * goes.
+ *
+ * The weights are in ticks, so they are normalised by the largest weight of
+ * the step: the last bucket holds the weights within a factor 2 of it, the
+ * previous one those within a factor 4, etc., and the first one everything
+ * lighter.
+ *
+ * @param weight The weight of the task.
+ * @param weight_max The largest weight of the tasks of the step (0 if
+ * unknown).
+ */
+static int queue_lockfree_bucket(const float weight, const float weight_max) {
+
+  /* No normalisation known, use the absolute log2 of the weight. */
+  if (!(weight_max > 0.f)) {
+    if (!(weight >= 1.f)) return 0;
+    const int b = ilogbf(weight) + 1;
+    return b < queue_lockfree_nr_buckets ? b : queue_lockfree_nr_buckets - 1;
+  }
+
+  if (!(weight > 0.f)) return 0;
+  if (weight >= weight_max) return queue_lockfree_nr_buckets - 1;
+  const int b = queue_lockfree_nr_buckets - 1 + ilogbf(weight / weight_max);
+  return b > 0 ? b : 0;
+}
+
 /**
  * @brief Enqueue all tasks in the incoming DEQ.
  *
@@ -122,6 +261,16 @@ void queue_get_incoming(struct queue *q) {
     const int offset = atomic_swap(&q->tid_incoming[ind], -1);
     atomic_inc(&q->first_incoming);
 
+    /* In lock-free mode, push the task to the deque matching its weight. */
+    if (q->lockfree) {
+      const int bucket =
+          queue_lockfree_bucket(q->tasks[offset].weight, q->weight_max);
+      queue_deque_push(&q->deques[bucket], offset);
+      atomic_inc(&q->count);
+      atomic_dec(&q->count_incoming);
+      continue;
+    }
+
     /* Does the queue need to be grown? */
     if (q->count == q->size) {
       struct queue_entry *temp;
@@ -188,8 +337,9 @@ void queue_insert(struct queue *q, struct task *t) {
  *
  * @param q The #queue.
  * @param tasks List of tasks to which the queue indices refer to.
+ * @param lockfree Use the lock-free deques rather than the binary heap?
  */
-void queue_init(struct queue *q, struct task *tasks) {
+void queue_init(struct queue *q, struct task *tasks, int lockfree) {
 
   /* Allocate the task list if needed. */
   q->size = queue_sizeinit;
@@ -216,6 +366,137 @@ void queue_init(struct queue *q, struct task *tasks) {
   q->first_incoming = 0;
   q->last_incoming = 0;
   q->count_incoming = 0;
+
+  /* Init the lock-free deques. */
+  q->lockfree = lockfree;
+  q->weight_max = 0.f;
+  q->deques = NULL;
+  if (lockfree) {
+    if ((q->deques = (struct queue_deque *)malloc(
+             sizeof(struct queue_deque) * queue_lockfree_nr_buckets)) == NULL)
+      error("Failed to allocate queue deques.");
+    for (int k = 0; k < queue_lockfree_nr_buckets; k++) {
+      q->deques[k].top = 0;
+      q->deques[k].bottom = 0;
+      q->deques[k].array = queue_deque_array_new(queue_lockfree_sizeinit, NULL);
+    }
+  }
+
+  /* Init the sleeping runners. */
+  q->numa_node = -1;
+  q->nr_sleeping = 0;
+  if (pthread_cond_init(&q->sleep_cond, NULL) != 0 ||
+      pthread_mutex_init(&q->sleep_mutex, NULL) != 0)
+    error("Failed to initialize queue sleep barrier.");
+}
+
+/**
+ * @brief Get a task free of dependencies and conflicts from the lock-free
+ * deques of a queue, as its owner.
+ *
+ * Tasks are taken from the bottom of the highest-weight non-empty deque.
+ * Tasks that cannot be locked are moved one bucket down, which mirrors the
+ * re-weighting done in the binary heap.
+ *
+ * @param q The task #queue.
+ * @param prev The previous #task extracted from this #queue.
+ * @param blocking Block until access to the queue is granted.
+ */
+static struct task *queue_lockfree_gettask(struct queue *q,
+                                           const struct task *prev,
+                                           int blocking) {
+
+  swift_lock_type *qlock = &q->lock;
+  struct task *res = NULL;
+
+  /* Grab the queue lock, or act as a thief if someone else owns it. */
+  if (blocking) {
+    if (lock_lock(qlock) != 0) error("Locking the qlock failed.\n");
+  } else {
+    if (lock_trylock(qlock) != 0) return queue_steal(q, prev);
+  }
+
+  /* Fill any tasks from the incoming DEQ. */
+  queue_get_incoming(q);
+
+  /* Do not look at more tasks than there are in the queue, since tasks that
+   * fail to lock are pushed back. */
+  int attempts = q->count;
+
+  for (int b = queue_lockfree_nr_buckets - 1;
+       b >= 0 && res == NULL && attempts > 0; b--) {
+    while (attempts > 0) {
+
+      const int tid = queue_deque_pop(&q->deques[b]);
+      if (tid < 0) break;
+      attempts--;
+
+      /* Try to lock the task. */
+      struct task *t = &q->tasks[tid];
+      if (task_lock(t)) {
+        atomic_dec(&q->count);
+        res = t;
+        break;
+      }
+
+      /* De-prioritize this task by moving it down a bucket. */
+      const int new_b = ((1ULL << t->type) & queue_lock_fail_reweight_mask) &&
+                                b > 0
+                            ? b - 1
+                            : b;
+      queue_deque_push(&q->deques[new_b], tid);
+
+      /* Don't pop the same task again straight away. */
+      if (new_b == b) break;
+    }
+  }
+
+  /* Release the queue lock. */
+  if (lock_unlock(qlock) != 0) error("Unlocking the qlock failed.\n");
+
+  return res;
+}
+
+/**
+ * @brief Steal a task free of dependencies and conflicts from a queue.
+ *
+ * In lock-free mode this does not take the queue lock, unless the deques
+ * are empty and the incoming DEQ needs to be emptied. Tasks are taken from
+ * the top (oldest end) of the highest-weight non-empty deque. In heap mode
+ * this is just a non-blocking queue_gettask().
+ *
+ * @param q The task #queue.
+ * @param prev The previous #task extracted by the thief.
+ */
+struct task *queue_steal(struct queue *q, const struct task *prev) {
+
+  if (!q->lockfree) return queue_gettask(q, prev, 0);
+
+  /* Nothing in the deques? Try to move the incoming tasks over. */
+  if (q->count == 0 && q->count_incoming > 0 && lock_trylock(&q->lock) == 0) {
+    queue_get_incoming(q);
+    lock_unlock_blind(&q->lock);
+  }
+
+  for (int b = queue_lockfree_nr_buckets - 1; b >= 0 && q->count > 0; b--) {
+    for (int k = 0; k < queue_lockfree_steal_retries; k++) {
+
+      const int tid = queue_deque_steal(&q->deques[b]);
+      if (tid == -1) break;
+      if (tid == -2) continue;
+
+      /* Got one, but can we lock it? */
+      struct task *t = &q->tasks[tid];
+      atomic_dec(&q->count);
+      if (task_lock(t)) return t;
+
+      /* No, give it back to the owner and try the next bucket. */
+      queue_insert(q, t);
+      break;
+    }
+  }
+
+  return NULL;
 }
 
 /**
@@ -228,6 +509,9 @@ void queue_init(struct queue *q, struct task *tasks) {
 struct task *queue_gettask(struct queue *q, const struct task *prev,
                            int blocking) {
 
+  /* Are we using the lock-free deques? */
+  if (q->lockfree) return queue_lockfree_gettask(q, prev, blocking);
+
   swift_lock_type *qlock = &q->lock;
   struct task *res = NULL;
 
@@ -307,6 +591,21 @@ void queue_clean(struct queue *q) {
 
   free(q->entries);
   free(q->tid_incoming);
+
+  /* Free the deques and all their retired arrays. */
+  if (q->deques != NULL) {
+    for (int k = 0; k < queue_lockfree_nr_buckets; k++) {
+      struct queue_deque_array *a = q->deques[k].array;
+      while (a != NULL) {
+        struct queue_deque_array *retired = a->retired;
+        free(a);
+        a = retired;
+      }
+    }
+    free(q->deques);
+  }
+  pthread_cond_destroy(&q->sleep_cond);
+  pthread_mutex_destroy(&q->sleep_mutex);
 }
 
 /**
@@ -328,11 +627,25 @@ void queue_dump(int nodeID, int index, FILE *file, struct queue *q) {
   queue_get_incoming(q);
 
   /* Loop over the queue entries. */
-  for (int k = 0; k < q->count; k++) {
-    struct task *t = &q->tasks[q->entries[k].tid];
+  if (q->lockfree) {
+    int k = 0;
+    for (int b = queue_lockfree_nr_buckets - 1; b >= 0; b--) {
+      const struct queue_deque *d = &q->deques[b];
+      const struct queue_deque_array *a = d->array;
+      for (long long i = d->top; i < d->bottom; i++, k++) {
+        struct task *t = &q->tasks[a->tids[i & (a->size - 1)]];
+
+        fprintf(file, "%d %d %d %s %s %.2f\n", nodeID, index, k,
+                taskID_names[t->type], subtaskID_names[t->subtype], t->weight);
+      }
+    }
+  } else {
+    for (int k = 0; k < q->count; k++) {
+      struct task *t = &q->tasks[q->entries[k].tid];
 
-    fprintf(file, "%d %d %d %s %s %.2f\n", nodeID, index, k,
-            taskID_names[t->type], subtaskID_names[t->subtype], t->weight);
+      fprintf(file, "%d %d %d %s %s %.2f\n", nodeID, index, k,
+              taskID_names[t->type], subtaskID_names[t->subtype], t->weight);
+    }
   }
 
   /* Release the task lock. */
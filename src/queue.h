@@ -19,6 +19,9 @@
 #ifndef SWIFT_QUEUE_H
 #define SWIFT_QUEUE_H
 
+/* Some standard headers. */
+#include <pthread.h>
+
 /* Includes. */
 #include "cell.h"
 #include "lock.h"
@@ -32,6 +35,11 @@
 #define queue_incoming_size 10240
 #define queue_struct_align 64
 
+/* Constants dealing with the lock-free deques. */
+#define queue_lockfree_nr_buckets 32
+#define queue_lockfree_sizeinit 64
+#define queue_lockfree_steal_retries 4
+
 /* Constants dealing with task de-priorization. */
 #define queue_lock_fail_reweight_factor 0.5
 /* #define queue_lock_fail_reweight_mask \
@@ -56,6 +64,34 @@ struct queue_entry {
   float weight;
 };
 
+/** Growable circular array of task offsets used by a #queue_deque. */
+struct queue_deque_array {
+
+  /* Number of elements (always a power of two). */
+  long long size;
+
+  /* Previously used (smaller) array, kept until the queue is cleaned since
+   * thieves may still be reading from it. */
+  struct queue_deque_array *retired;
+
+  /* The task offsets. */
+  int tids[];
+};
+
+/** Chase-Lev work-stealing deque. The owner pushes and pops at the bottom,
+ * thieves steal from the top without taking any lock. */
+struct queue_deque {
+
+  /* Index of the oldest element, only ever incremented with a CAS. */
+  volatile long long top;
+
+  /* Index one past the newest element, only written by the owner. */
+  volatile long long bottom;
+
+  /* The current array of elements. */
+  struct queue_deque_array *volatile array;
+};
+
 /** The queue struct. */
 struct queue {
 
@@ -75,12 +111,33 @@ struct queue {
   int *tid_incoming;
   volatile unsigned int first_incoming, last_incoming, count_incoming;
 
+  /* Are we using the lock-free deques instead of the binary heap? */
+  int lockfree;
+
+  /* Deques of tasks, bucketed by log2 of their weight relative to the
+   * largest one. Only used in the lock-free mode, in which case the lock
+   * above guards the owner side. */
+  struct queue_deque *deques;
+
+  /* Largest task weight of the step, set by scheduler_reweight(). */
+  float weight_max;
+
+  /* NUMA node of the runners using this queue (-1 if unknown). */
+  int numa_node;
+
+  /* Number of runners sleeping on this queue and the associated mutex and
+   * condition (lock-free mode only). */
+  volatile int nr_sleeping;
+  pthread_mutex_t sleep_mutex;
+  pthread_cond_t sleep_cond;
+
 } __attribute__((aligned(queue_struct_align)));
 
 /* Function prototypes. */
 struct task *queue_gettask(struct queue *q, const struct task *prev,
                            int blocking);
-void queue_init(struct queue *q, struct task *tasks);
+struct task *queue_steal(struct queue *q, const struct task *prev);
+void queue_init(struct queue *q, struct task *tasks, int lockfree);
 void queue_insert(struct queue *q, struct task *t);
 void queue_clean(struct queue *q);
 
@@ -28,17 +28,24 @@
 /* Standard headers. */
 #include "engine.h"
 #include "error.h"
+#include "minmax.h"
 #include "restart.h"
+#include "threadpool.h"
 #include "version.h"
 
 #include <errno.h>
 #include <glob.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
 /* The signature for restart files. */
 #define SWIFT_RESTART_SIGNATURE "SWIFT-restart-file"
 #define SWIFT_RESTART_END_SIGNATURE "SWIFT-restart-file:end"
@@ -46,12 +53,123 @@
 #define FNAMELEN 200
 #define LABLEN 20
 
+/* Default length of the chunks of the large blocks (16 MB). */
+#define CHUNKLEN (16 * 1024 * 1024)
+
 /* Structure for a dumped header. */
 struct header {
   size_t len;             /* Total length of data in bytes. */
   char label[LABLEN + 1]; /* A label for data */
 };
 
+/* The ways a chunk can be stored. */
+enum restart_codec {
+  restart_codec_none = 0,
+  restart_codec_zlib = 1,
+};
+
+/* Structure describing the chunks of a block of data. */
+struct chunks_header {
+  size_t chunk_size; /* Length in bytes of the uncompressed chunks. */
+  size_t nr_chunks;  /* Number of chunks. */
+  size_t stored;     /* Total length of the chunks stored in this file. */
+};
+
+/* Structure describing one chunk of a block of data. */
+struct chunk {
+  uint64_t hash; /* Hash of the uncompressed content. */
+  size_t offset; /* Position of the stored data in its file. */
+  size_t length; /* Length of the stored data. */
+  int codec;     /* How the data is stored, a #restart_codec. */
+  int in_base;   /* Whether the data lives in the base file. */
+};
+
+/* Maximal number of blocks we keep the chunks of for incremental dumps. */
+#define HISTORY_MAX 16
+
+/* The chunks of a block of the last full dump. */
+struct chunk_history {
+  char label[LABLEN + 1];
+  size_t chunk_size;
+  size_t nr_chunks;
+  struct chunk *chunks;
+};
+
+/* The state of the current dump or restore, set by restart_write() and
+ * restart_read() and used by the chunked reads and writes. */
+static struct {
+
+  /* Threads to use for the writes, NULL to work serially. */
+  struct threadpool *tp;
+
+  /* Length of the chunks and compression level for the writes. */
+  size_t chunk_size;
+  int compression;
+
+  /* Are we writing an incremental dump? */
+  int incremental;
+
+  /* Are we writing a full dump to be used as the base of the next ones? */
+  int record;
+
+  /* Name and stream of the base file for the reads. */
+  char base_name[FNAMELEN];
+  FILE *base;
+
+} restart_chunking;
+
+/* The chunks of the last full dump and whether they can be referred to. */
+static struct chunk_history restart_history[HISTORY_MAX];
+static int restart_history_count = 0;
+static int restart_history_valid = 0;
+
+/**
+ * @brief Hash a chunk of memory.
+ *
+ * @param data the memory.
+ * @param len its length in bytes.
+ */
+static uint64_t restart_hash(const void *data, size_t len) {
+
+  const unsigned char *bytes = (const unsigned char *)data;
+  uint64_t h = 0x9e3779b97f4a7c15ULL ^ len;
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t)) {
+    uint64_t w;
+    memcpy(&w, &bytes[i], sizeof(uint64_t));
+    w *= 0xbf58476d1ce4e5b9ULL;
+    w ^= w >> 31;
+    h = (h ^ w) * 0x94d049bb133111ebULL;
+    h ^= h >> 29;
+  }
+  for (; i < len; i++) h = (h ^ bytes[i]) * 0x100000001b3ULL;
+  return h ^ (h >> 32);
+}
+
+/**
+ * @brief Forget the chunks of the last full dump.
+ */
+static void restart_history_clear(void) {
+  for (int k = 0; k < restart_history_count; k++)
+    free(restart_history[k].chunks);
+  restart_history_count = 0;
+  restart_history_valid = 0;
+}
+
+/**
+ * @brief Find the chunks of a block of the last full dump.
+ *
+ * @param label the label of the block.
+ *
+ * @result the chunks or NULL if there is no such block.
+ */
+static struct chunk_history *restart_history_find(const char *label) {
+  for (int k = 0; k < restart_history_count; k++)
+    if (strncmp(restart_history[k].label, label, LABLEN) == 0)
+      return &restart_history[k];
+  return NULL;
+}
+
 /**
  * @brief generate a name for a restart file.
  *
@@ -133,6 +251,17 @@ void restart_write(struct engine *e, const char *filename) {
   /* Save a backup the existing restart file, if requested. */
   if (e->restart_save) restart_save_previous(filename);
 
+  /* Only write the chunks that changed since the last full dump? */
+  const int incremental = e->restart_incremental && restart_history_valid &&
+                          e->restart_nr_incremental < e->restart_full_every;
+  if (!incremental) restart_history_clear();
+
+  restart_chunking.tp = &e->threadpool;
+  restart_chunking.chunk_size = e->restart_chunk_size;
+  restart_chunking.compression = e->restart_compression;
+  restart_chunking.incremental = incremental;
+  restart_chunking.record = e->restart_incremental && !incremental;
+
   FILE *stream = fopen(filename, "w");
   if (stream == NULL)
     error("Failed to open restart file: %s (%s)", filename, strerror(errno));
@@ -152,10 +281,37 @@ void restart_write(struct engine *e, const char *filename) {
                        "endsignature", "SWIFT end signature");
 
   fclose(stream);
+  restart_chunking.tp = NULL;
+
+  /* Keep a link to a full dump for the next incremental ones to refer to. */
+  if (e->restart_incremental) {
+    if (incremental) {
+      e->restart_nr_incremental++;
+    } else {
+      char basename[FNAMELEN];
+      if (snprintf(basename, FNAMELEN, "%s.base", filename) >= FNAMELEN)
+        error("Restart base file name too long");
+
+      if (e->restart_save)
+        restart_save_previous(basename);
+      else
+        unlink(basename);
+
+      if (link(filename, basename) == 0) {
+        restart_history_valid = 1;
+      } else {
+        message("WARNING: failed to link '%s' to '%s' (%s), next dump will "
+                "not be incremental",
+                filename, basename, strerror(errno));
+        restart_history_clear();
+      }
+      e->restart_nr_incremental = 0;
+    }
+  }
 
   if (e->verbose)
-    message("took %.3f %s.", clocks_from_ticks(getticks() - tic),
-            clocks_getunit());
+    message("took %.3f %s (%s dump).", clocks_from_ticks(getticks() - tic),
+            clocks_getunit(), incremental ? "incremental" : "full");
 }
 
 /**
@@ -172,6 +328,12 @@ void restart_read(struct engine *e, const char *filename) {
   if (stream == NULL)
     error("Failed to open restart file: %s (%s)", filename, strerror(errno));
 
+  /* The chunks of incremental dumps are found in the base file. */
+  if (snprintf(restart_chunking.base_name, FNAMELEN, "%s.base", filename) >=
+      FNAMELEN)
+    error("Restart base file name too long");
+  restart_chunking.base = NULL;
+
   /* Get our version and signature back. These should match. */
   char signature[strlen(SWIFT_RESTART_SIGNATURE) + 1];
   int len = strlen(SWIFT_RESTART_SIGNATURE);
@@ -198,6 +360,8 @@ void restart_read(struct engine *e, const char *filename) {
 
   engine_struct_restore(e, stream);
   fclose(stream);
+  if (restart_chunking.base != NULL) fclose(restart_chunking.base);
+  restart_chunking.base = NULL;
 
   if (e->verbose)
     message("took %.3f %s.", clocks_from_ticks(getticks() - tic),
@@ -278,6 +442,329 @@ void restart_write_blocks(void *ptr, size_t size, size_t nblocks, FILE *stream,
   }
 }
 
+/* Data needed to prepare or write the chunks of a block. */
+struct chunk_data {
+  const char *ptr;
+  size_t len;
+  size_t chunk_size;
+  struct chunk *chunks;
+  char **buffers;
+  const struct chunk_history *history;
+  int compression;
+  int fd;
+};
+
+/**
+ * @brief #threadpool mapper hashing and compressing chunks.
+ *
+ * Chunks identical to the ones of the last full dump are not compressed
+ * but refer to their copy in the base file.
+ */
+static void restart_chunks_prepare_mapper(void *map_data, int num_elements,
+                                          void *extra_data) {
+
+  const struct chunk_data *data = (const struct chunk_data *)extra_data;
+  struct chunk *chunks = (struct chunk *)map_data;
+
+  for (int k = 0; k < num_elements; k++) {
+    const size_t i = &chunks[k] - data->chunks;
+    const char *src = data->ptr + i * data->chunk_size;
+    const size_t n = min(data->chunk_size, data->len - i * data->chunk_size);
+
+    const uint64_t hash = restart_hash(src, n);
+
+    /* Unchanged since the last full dump? */
+    const struct chunk_history *h = data->history;
+    if (h != NULL && i < h->nr_chunks && h->chunks[i].hash == hash) {
+      chunks[k] = h->chunks[i];
+      chunks[k].in_base = 1;
+      continue;
+    }
+
+    chunks[k].hash = hash;
+    chunks[k].in_base = 0;
+    chunks[k].codec = restart_codec_none;
+    chunks[k].length = n;
+    data->buffers[i] = NULL;
+
+#ifdef HAVE_ZLIB
+    if (data->compression > 0) {
+      uLongf length = compressBound(n);
+      char *buffer = (char *)malloc(length);
+      if (buffer == NULL) error("Failed to allocate compression buffer");
+      if (compress2((Bytef *)buffer, &length, (const Bytef *)src, n,
+                    data->compression) != Z_OK)
+        error("Failed to compress restart data");
+
+      /* Only keep it if it helps */
+      if (length < n) {
+        chunks[k].codec = restart_codec_zlib;
+        chunks[k].length = length;
+        data->buffers[i] = buffer;
+      } else {
+        free(buffer);
+      }
+    }
+#endif
+  }
+}
+
+/**
+ * @brief #threadpool mapper writing chunks at their position in the file.
+ */
+static void restart_chunks_write_mapper(void *map_data, int num_elements,
+                                        void *extra_data) {
+
+  const struct chunk_data *data = (const struct chunk_data *)extra_data;
+  struct chunk *chunks = (struct chunk *)map_data;
+
+  for (int k = 0; k < num_elements; k++) {
+    if (chunks[k].in_base) continue;
+
+    const size_t i = &chunks[k] - data->chunks;
+    const char *src = data->buffers[i] != NULL
+                          ? data->buffers[i]
+                          : data->ptr + i * data->chunk_size;
+
+    size_t done = 0;
+    while (done < chunks[k].length) {
+      const ssize_t n = pwrite(data->fd, src + done, chunks[k].length - done,
+                               chunks[k].offset + done);
+      if (n < 0) error("Failed to write restart chunk (%s)", strerror(errno));
+      done += n;
+    }
+  }
+}
+
+/**
+ * @brief Write blocks of memory to a file stream as a series of chunks.
+ *        Exits the application if the write fails and does nothing
+ *        if the size is zero.
+ *
+ * The chunks are hashed and, if requested, compressed using the threads of
+ * the engine. When writing an incremental dump, the chunks identical to the
+ * ones of the last full dump are not written but refer to the base file.
+ * Use restart_read_chunked_blocks() to read them back.
+ *
+ * @param ptr pointer to the memory
+ * @param size the blocks
+ * @param nblocks number of blocks to write
+ * @param stream the file stream
+ * @param label a label for the content, can only be 20 characters.
+ * @param errstr a context string to qualify any errors.
+ */
+void restart_write_chunked_blocks(void *ptr, size_t size, size_t nblocks,
+                                  FILE *stream, const char *label,
+                                  const char *errstr) {
+
+  const size_t len = size * nblocks;
+  if (len == 0) return;
+
+  struct chunks_header chead;
+  chead.chunk_size = restart_chunking.chunk_size > 0
+                         ? restart_chunking.chunk_size
+                         : CHUNKLEN;
+  chead.nr_chunks = (len + chead.chunk_size - 1) / chead.chunk_size;
+
+  struct chunk *chunks =
+      (struct chunk *)calloc(chead.nr_chunks, sizeof(struct chunk));
+  char **buffers = (char **)calloc(chead.nr_chunks, sizeof(char *));
+  if (chunks == NULL || buffers == NULL)
+    error("Failed to allocate chunks for %s", errstr);
+
+  /* What did this block look like at the last full dump? */
+  const struct chunk_history *history = NULL;
+  if (restart_chunking.incremental) {
+    history = restart_history_find(label);
+    if (history != NULL && history->chunk_size != chead.chunk_size)
+      history = NULL;
+  }
+
+  struct chunk_data data = {(const char *)ptr, len,      chead.chunk_size,
+                            chunks,            buffers,  history,
+                            restart_chunking.compression, -1};
+
+  /* Hash and compress everything */
+  if (restart_chunking.tp != NULL)
+    threadpool_map(restart_chunking.tp, restart_chunks_prepare_mapper, chunks,
+                   chead.nr_chunks, sizeof(struct chunk), 1, &data);
+  else
+    restart_chunks_prepare_mapper(chunks, chead.nr_chunks, &data);
+
+  /* Work out where everything goes, the stored chunks follow the table. */
+  if (fflush(stream) != 0)
+    error("Failed to flush restart file (%s)", strerror(errno));
+  const long start = ftell(stream);
+  if (start < 0) error("Failed to locate position in restart file");
+  size_t offset = start + sizeof(struct header) + sizeof(struct chunks_header) +
+                  chead.nr_chunks * sizeof(struct chunk);
+  chead.stored = 0;
+  for (size_t i = 0; i < chead.nr_chunks; i++) {
+    if (chunks[i].in_base) continue;
+    chunks[i].offset = offset;
+    offset += chunks[i].length;
+    chead.stored += chunks[i].length;
+  }
+
+  /* Dump the headers and table. */
+  struct header head;
+  head.len = len;
+  strncpy(head.label, label, LABLEN);
+  head.label[LABLEN] = '\0';
+  if (fwrite(&head, sizeof(struct header), 1, stream) != 1 ||
+      fwrite(&chead, sizeof(struct chunks_header), 1, stream) != 1 ||
+      fwrite(chunks, sizeof(struct chunk), chead.nr_chunks, stream) !=
+          chead.nr_chunks)
+    error("Failed to save %s header to restart file (%s)", errstr,
+          strerror(errno));
+  if (fflush(stream) != 0)
+    error("Failed to flush restart file (%s)", strerror(errno));
+
+  /* And the chunks, in parallel. */
+  data.fd = fileno(stream);
+  if (restart_chunking.tp != NULL)
+    threadpool_map(restart_chunking.tp, restart_chunks_write_mapper, chunks,
+                   chead.nr_chunks, sizeof(struct chunk), 1, &data);
+  else
+    restart_chunks_write_mapper(chunks, chead.nr_chunks, &data);
+
+  if (fseek(stream, offset, SEEK_SET) != 0)
+    error("Failed to seek in restart file (%s)", strerror(errno));
+
+  /* Keep the table if this dump will be the base of the next ones. */
+  if (restart_chunking.record) {
+    if (restart_history_count == HISTORY_MAX)
+      error("Too many chunked blocks in restart file");
+    struct chunk_history *h = &restart_history[restart_history_count++];
+    strncpy(h->label, label, LABLEN);
+    h->label[LABLEN] = '\0';
+    h->chunk_size = chead.chunk_size;
+    h->nr_chunks = chead.nr_chunks;
+    h->chunks = chunks;
+  } else {
+    free(chunks);
+  }
+
+  for (size_t i = 0; i < chead.nr_chunks; i++) free(buffers[i]);
+  free(buffers);
+}
+
+/**
+ * @brief Read blocks of memory written by restart_write_chunked_blocks()
+ *        from a file stream into a memory location. Exits the application if
+ *        the read fails or if the content of a chunk does not match its hash
+ *        and does nothing if the size is zero.
+ *
+ * @param ptr pointer to the memory
+ * @param size size of a block
+ * @param nblocks number of blocks to read
+ * @param stream the file stream
+ * @param label the label recovered for the block, needs to be at least 20
+ *              characters, set to NULL if not required
+ * @param errstr a context string to qualify any errors.
+ */
+void restart_read_chunked_blocks(void *ptr, size_t size, size_t nblocks,
+                                 FILE *stream, char *label,
+                                 const char *errstr) {
+
+  const size_t len = size * nblocks;
+  if (len == 0) return;
+
+  struct header head;
+  if (fread(&head, sizeof(struct header), 1, stream) != 1)
+    error("Failed to read the %s header from restart file (%s)", errstr,
+          strerror(errno));
+  if (head.len != len)
+    error("Mismatched data length in restart file for %s (%zu != %zu)",
+          errstr, head.len, len);
+  if (label != NULL) {
+    head.label[LABLEN] = '\0';
+    strncpy(label, head.label, LABLEN + 1);
+  }
+
+  struct chunks_header chead;
+  if (fread(&chead, sizeof(struct chunks_header), 1, stream) != 1)
+    error("Failed to read the %s chunks from restart file (%s)", errstr,
+          strerror(errno));
+  if (chead.chunk_size == 0 ||
+      chead.nr_chunks != (len + chead.chunk_size - 1) / chead.chunk_size)
+    error("Invalid chunks in restart file for %s", errstr);
+
+  struct chunk *chunks =
+      (struct chunk *)malloc(chead.nr_chunks * sizeof(struct chunk));
+  if (chunks == NULL) error("Failed to allocate chunks for %s", errstr);
+  if (fread(chunks, sizeof(struct chunk), chead.nr_chunks, stream) !=
+      chead.nr_chunks)
+    error("Failed to read the %s chunks from restart file (%s)", errstr,
+          strerror(errno));
+  const long end = ftell(stream) + chead.stored;
+
+  char *buffer = NULL;
+  size_t buffer_size = 0;
+
+  for (size_t i = 0; i < chead.nr_chunks; i++) {
+    char *dest = (char *)ptr + i * chead.chunk_size;
+    const size_t n = min(chead.chunk_size, len - i * chead.chunk_size);
+
+    /* Where is this chunk? */
+    FILE *file = stream;
+    if (chunks[i].in_base) {
+      if (restart_chunking.base == NULL) {
+        restart_chunking.base = fopen(restart_chunking.base_name, "r");
+        if (restart_chunking.base == NULL)
+          error("Failed to open restart base file: %s (%s)",
+                restart_chunking.base_name, strerror(errno));
+      }
+      file = restart_chunking.base;
+    }
+    if (fseek(file, chunks[i].offset, SEEK_SET) != 0)
+      error("Failed to seek in restart file (%s)", strerror(errno));
+
+    if (chunks[i].codec == restart_codec_none) {
+      if (chunks[i].length != n)
+        error("Invalid chunk %zu in restart file for %s", i, errstr);
+      if (fread(dest, 1, n, file) != n)
+        error("Failed to restore %s from restart file (%s)", errstr,
+              ferror(file) ? strerror(errno) : "unexpected end of file");
+
+    } else if (chunks[i].codec == restart_codec_zlib) {
+#ifdef HAVE_ZLIB
+      if (chunks[i].length > buffer_size) {
+        free(buffer);
+        buffer_size = chunks[i].length;
+        buffer = (char *)malloc(buffer_size);
+        if (buffer == NULL) error("Failed to allocate decompression buffer");
+      }
+      if (fread(buffer, 1, chunks[i].length, file) != chunks[i].length)
+        error("Failed to restore %s from restart file (%s)", errstr,
+              ferror(file) ? strerror(errno) : "unexpected end of file");
+      uLongf length = n;
+      if (uncompress((Bytef *)dest, &length, (const Bytef *)buffer,
+                     chunks[i].length) != Z_OK ||
+          length != n)
+        error("Failed to decompress %s from restart file", errstr);
+#else
+      error("Restart file for %s is compressed but SWIFT was not compiled "
+            "with zlib",
+            errstr);
+#endif
+    } else {
+      error("Unknown storage of chunk %zu in restart file for %s", i, errstr);
+    }
+
+    /* Make sure we got back what was written */
+    if (restart_hash(dest, n) != chunks[i].hash)
+      error("Chunk %zu of %s in restart file does not match its hash%s", i,
+            errstr, chunks[i].in_base ? " (stale base file?)" : "");
+  }
+
+  if (fseek(stream, end, SEEK_SET) != 0)
+    error("Failed to seek in restart file (%s)", strerror(errno));
+
+  free(buffer);
+  free(chunks);
+}
+
 /**
  * @brief check if the stop file exists in the given directory and optionally
  *        remove it if found.
@@ -35,6 +35,11 @@ void restart_read_blocks(void *ptr, size_t size, size_t nblocks, FILE *stream,
                          char *label, const char *errstr);
 void restart_write_blocks(void *ptr, size_t size, size_t nblocks, FILE *stream,
                           const char *label, const char *errstr);
+void restart_read_chunked_blocks(void *ptr, size_t size, size_t nblocks,
+                                 FILE *stream, char *label, const char *errstr);
+void restart_write_chunked_blocks(void *ptr, size_t size, size_t nblocks,
+                                  FILE *stream, const char *label,
+                                  const char *errstr);
 
 int restart_stop_now(const char *dir, int cleanup);
 
@@ -28,7 +28,11 @@
 
 /* Local headers. */
 #include "cache.h"
+#include "cycle.h"
+#include "gravity_M2L_batch.h"
 #include "gravity_cache.h"
+#include "runner_arena.h"
+#include "task_profiler.h"
 
 struct cell;
 struct engine;
@@ -57,6 +61,13 @@ struct runner {
   /*! The queue to use to get tasks. */
   int cpuid, qid;
 
+  /*! Time spent running tasks and end of the last task, for the analysis
+   * of the steps. */
+  ticks busy_ticks, last_toc;
+
+  /*! The samples of the task costs taken by this runner. */
+  struct task_profiler_ring profiler_ring;
+
   /*! The engine owing this runner. */
   struct engine *e;
 
@@ -66,6 +77,12 @@ struct runner {
   /*! The particle gravity_cache of cell cj. */
   struct gravity_cache cj_gravity_cache;
 
+  /*! The M2L interactions of the long-range gravity task. */
+  struct gravity_M2L_batch M2L_batch;
+
+  /*! Scratch memory of the tasks, released at the end of each task. */
+  struct runner_arena arena;
+
 #ifdef WITH_VECTORIZATION
 
   /*! The particle cache of cell ci. */
@@ -0,0 +1,238 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#ifndef SWIFT_RUNNER_ARENA_H
+#define SWIFT_RUNNER_ARENA_H
+
+/* Config parameters. */
+#include "../config.h"
+
+/* Some standard headers. */
+#include <stddef.h>
+
+/* Local headers */
+#include "align.h"
+#include "error.h"
+#include "inline.h"
+#include "memuse.h"
+
+/*! Initial size of the arena of each runner in bytes */
+#define runner_arena_initial_size (256 * 1024)
+
+/**
+ * @brief Header of a block allocated when the main block of a
+ * #runner_arena is full.
+ */
+struct runner_arena_overflow {
+
+  /*! The previous overflow block */
+  struct runner_arena_overflow *next;
+};
+
+/**
+ * @brief A bump allocator for the scratch memory of the tasks of a runner.
+ *
+ * Allocations are carved out of a single block and released all at once
+ * at the end of each task, or in LIFO order using runner_arena_mark() and
+ * runner_arena_release(). Requests that do not fit in the block are served
+ * from separate overflow blocks and the main block is grown to the
+ * high-water mark at the next reset such that this only happens while
+ * warming up.
+ *
+ * The main blocks are logged in the memuse reports as "runner_arena" and the
+ * overflow blocks as "runner_arena_overflow". As the main block is re-sized
+ * after each overflow, its logged size tracks the high-water mark. The
+ * high-water marks of each step are printed by the engine when running
+ * verbosely.
+ */
+struct runner_arena {
+
+  /*! The main block of memory */
+  char *block;
+
+  /*! Size of the main block in bytes */
+  size_t size;
+
+  /*! Number of bytes used in the main block */
+  size_t used;
+
+  /*! Number of bytes requested from overflow blocks since the last reset */
+  size_t overflow;
+
+  /*! Largest number of bytes used between two resets */
+  size_t high_water;
+
+  /*! Largest number of bytes used between two resets since the last call to
+   * runner_arena_step_high_water() */
+  size_t step_high_water;
+
+  /*! The overflow blocks allocated since the last reset */
+  struct runner_arena_overflow *overflow_blocks;
+};
+
+/**
+ * @brief Frees all the memory of a #runner_arena.
+ *
+ * @param a The #runner_arena.
+ */
+static INLINE void runner_arena_clean(struct runner_arena *a) {
+
+  while (a->overflow_blocks != NULL) {
+    struct runner_arena_overflow *next = a->overflow_blocks->next;
+    swift_free("runner_arena_overflow", a->overflow_blocks);
+    a->overflow_blocks = next;
+  }
+  if (a->block != NULL) swift_free("runner_arena", a->block);
+  a->block = NULL;
+  a->size = 0;
+  a->used = 0;
+  a->overflow = 0;
+}
+
+/**
+ * @brief Allocates the main block of a #runner_arena.
+ *
+ * @param a The #runner_arena.
+ * @param size The size of the block in bytes.
+ */
+static INLINE void runner_arena_init(struct runner_arena *a,
+                                     const size_t size) {
+
+  a->block = NULL;
+  a->size = 0;
+  a->used = 0;
+  a->overflow = 0;
+  a->high_water = 0;
+  a->step_high_water = 0;
+  a->overflow_blocks = NULL;
+
+  if (swift_memalign("runner_arena", (void **)&a->block, SWIFT_CACHE_ALIGNMENT,
+                     size) != 0)
+    error("Couldn't allocate runner arena, size: %zu", size);
+  a->size = size;
+}
+
+/**
+ * @brief Allocates some scratch memory from a #runner_arena.
+ *
+ * The memory is valid until the matching runner_arena_release() or the
+ * next runner_arena_reset(). There is no need to free it.
+ *
+ * @param a The #runner_arena.
+ * @param size The number of bytes to allocate.
+ * @param alignment The alignment of the memory, must be a power of 2 no
+ * larger than SWIFT_CACHE_ALIGNMENT.
+ */
+static INLINE void *runner_arena_alloc(struct runner_arena *a,
+                                       const size_t size,
+                                       const size_t alignment) {
+
+#ifdef SWIFT_DEBUG_CHECKS
+  if (alignment == 0 || (alignment & (alignment - 1)) != 0 ||
+      alignment > SWIFT_CACHE_ALIGNMENT)
+    error("Invalid arena alignment (%zu).", alignment);
+#endif
+
+  /* Fits in the main block? */
+  const size_t offset = (a->used + alignment - 1) & ~(alignment - 1);
+  if (offset + size <= a->size) {
+    a->used = offset + size;
+    return a->block + offset;
+  }
+
+  /* Otherwise use a new overflow block */
+  const size_t header_size = (sizeof(struct runner_arena_overflow) +
+                              SWIFT_CACHE_ALIGNMENT - 1) &
+                             ~(size_t)(SWIFT_CACHE_ALIGNMENT - 1);
+  struct runner_arena_overflow *block = NULL;
+  if (swift_memalign("runner_arena_overflow", (void **)&block,
+                     SWIFT_CACHE_ALIGNMENT, header_size + size) != 0)
+    error("Couldn't allocate runner arena overflow, size: %zu", size);
+  block->next = a->overflow_blocks;
+  a->overflow_blocks = block;
+  a->overflow += size + alignment;
+  return (char *)block + header_size;
+}
+
+/**
+ * @brief Returns the current position in the main block of a #runner_arena.
+ *
+ * @param a The #runner_arena.
+ */
+static INLINE size_t runner_arena_mark(const struct runner_arena *a) {
+  return a->used;
+}
+
+/**
+ * @brief Releases all the memory allocated in the main block of a
+ * #runner_arena since a given mark.
+ *
+ * Overflow blocks are only released by runner_arena_reset().
+ *
+ * @param a The #runner_arena.
+ * @param mark The position returned by runner_arena_mark().
+ */
+static INLINE void runner_arena_release(struct runner_arena *a,
+                                        const size_t mark) {
+
+  /* Keep track of the largest use made of the arena */
+  const size_t total = a->used + a->overflow;
+  if (total > a->high_water) a->high_water = total;
+  if (total > a->step_high_water) a->step_high_water = total;
+
+  a->used = mark;
+}
+
+/**
+ * @brief Releases all the memory of a #runner_arena. Called at the end of
+ * every task.
+ *
+ * If overflow blocks had to be used, the main block is re-allocated to fit
+ * the high-water mark.
+ *
+ * @param a The #runner_arena.
+ */
+static INLINE void runner_arena_reset(struct runner_arena *a) {
+
+  runner_arena_release(a, /*mark=*/0);
+
+  if (a->overflow_blocks == NULL) return;
+
+  /* Grow the main block, with some margin */
+  const size_t high_water = a->high_water;
+  const size_t step_high_water = a->step_high_water;
+  runner_arena_clean(a);
+  runner_arena_init(a, high_water + high_water / 4);
+  a->high_water = high_water;
+  a->step_high_water = step_high_water;
+}
+
+/**
+ * @brief Returns the largest use made of a #runner_arena since the last call
+ * to this function and starts counting again.
+ *
+ * @param a The #runner_arena.
+ */
+static INLINE size_t runner_arena_step_high_water(struct runner_arena *a) {
+
+  const size_t high_water = a->step_high_water;
+  a->step_high_water = 0;
+  return high_water;
+}
+
+#endif /* SWIFT_RUNNER_ARENA_H */
@@ -25,6 +25,7 @@
    runner_iact_FUNCTION. */
 
 #include "runner_doiact_hydro.h"
+#include "runner_doiact_functions_hydro_vec.h"
 
 /**
  * @brief Compute the interactions between a cell pair (non-symmetric case).
@@ -811,6 +812,9 @@ void DOPAIR_SUBSET_BRANCH(struct runner *r, struct cell *restrict ci,
                                      flipped, shift);
   else
     DOPAIR_SUBSET(r, ci, parts_i, ind, count, cj, sid, flipped, shift);
+#elif defined(WITH_MASKED_HYDRO_VECTORIZATION) && \
+    (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
+  DOPAIR_SUBSET_VEC(r, ci, parts_i, ind, count, cj, sid, flipped, shift);
 #else
   DOPAIR_SUBSET(r, ci, parts_i, ind, count, cj, sid, flipped, shift);
 #endif
@@ -916,6 +920,9 @@ void DOSELF_SUBSET_BRANCH(struct runner *r, struct cell *restrict ci,
 
 #if defined(WITH_VECTORIZATION) && defined(GADGET2_SPH)
   runner_doself_subset_density_vec(r, ci, parts, ind, count);
+#elif defined(WITH_MASKED_HYDRO_VECTORIZATION) && \
+    (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
+  DOSELF_SUBSET_VEC(r, ci, parts, ind, count);
 #else
   DOSELF_SUBSET(r, ci, parts, ind, count);
 #endif
@@ -1249,6 +1256,9 @@ void DOPAIR1_BRANCH(struct runner *r, struct cell *ci, struct cell *cj) {
     runner_dopair1_density_vec(r, ci, cj, sid, shift);
   else
     DOPAIR1(r, ci, cj, sid, shift);
+#elif defined(WITH_MASKED_HYDRO_VECTORIZATION) && \
+    (FUNCTION_TASK_LOOP != TASK_LOOP_FORCE)
+  DOPAIR_VEC(r, ci, cj, sid, shift);
 #else
   DOPAIR1(r, ci, cj, sid, shift);
 #endif
@@ -1316,6 +1326,9 @@ void DOPAIR2(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
                              cj->loc[2] + shift[2]};
   const double shift_j[3] = {cj->loc[0], cj->loc[1], cj->loc[2]};
 
+  /* The active sortlists are only needed during this function */
+  const size_t arena_mark = runner_arena_mark(&r->arena);
+
   int count_active_i = 0, count_active_j = 0;
   struct sort_entry *restrict sort_active_i = NULL,
                               *restrict sort_active_j = NULL;
@@ -1326,9 +1339,8 @@ void DOPAIR2(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
     sort_active_i = sort_i;
     count_active_i = count_i;
   } else if (cell_is_active_hydro(ci, e)) {
-    if (posix_memalign((void **)&sort_active_i, SWIFT_CACHE_ALIGNMENT,
-                       sizeof(struct sort_entry) * count_i) != 0)
-      error("Failed to allocate active sortlists.");
+    sort_active_i = (struct sort_entry *)runner_arena_alloc(
+        &r->arena, sizeof(struct sort_entry) * count_i, SWIFT_CACHE_ALIGNMENT);
 
     /* Collect the active particles in ci */
     for (int k = 0; k < count_i; k++) {
@@ -1345,9 +1357,8 @@ void DOPAIR2(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
     sort_active_j = sort_j;
     count_active_j = count_j;
   } else if (cell_is_active_hydro(cj, e)) {
-    if (posix_memalign((void **)&sort_active_j, SWIFT_CACHE_ALIGNMENT,
-                       sizeof(struct sort_entry) * count_j) != 0)
-      error("Failed to allocate active sortlists.");
+    sort_active_j = (struct sort_entry *)runner_arena_alloc(
+        &r->arena, sizeof(struct sort_entry) * count_j, SWIFT_CACHE_ALIGNMENT);
 
     /* Collect the active particles in cj */
     for (int k = 0; k < count_j; k++) {
@@ -1744,11 +1755,8 @@ void DOPAIR2(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
     }   /* Is pj active? */
   }     /* Loop over all cj */
 
-  /* Clean-up if necessary */  // MATTHIEU: temporary disable this optimization
-  if (cell_is_active_hydro(ci, e))  // && !cell_is_all_active_hydro(ci, e))
-    free(sort_active_i);
-  if (cell_is_active_hydro(cj, e))  // && !cell_is_all_active_hydro(cj, e))
-    free(sort_active_j);
+  /* Clean-up */
+  runner_arena_release(&r->arena, arena_mark);
 
   TIMER_TOC(TIMER_DOPAIR);
 }
@@ -1841,6 +1849,9 @@ void DOPAIR2_BRANCH(struct runner *r, struct cell *ci, struct cell *cj) {
     runner_dopair2_force_vec(r, ci, cj, sid, shift);
   else
     DOPAIR2(r, ci, cj, sid, shift);
+#elif defined(WITH_MASKED_HYDRO_VECTORIZATION) && \
+    (FUNCTION_TASK_LOOP == TASK_LOOP_FORCE)
+  DOPAIR_VEC(r, ci, cj, sid, shift);
 #else
   DOPAIR2(r, ci, cj, sid, shift);
 #endif
@@ -1863,11 +1874,10 @@ void DOSELF1(struct runner *r, struct cell *restrict c) {
   const int count = c->hydro.count;
 
   /* Set up indt. */
-  int *indt = NULL;
+  const size_t arena_mark = runner_arena_mark(&r->arena);
+  int *indt = (int *)runner_arena_alloc(&r->arena, count * sizeof(int),
+                                        VEC_SIZE * sizeof(int));
   int countdt = 0, firstdt = 0;
-  if (posix_memalign((void **)&indt, VEC_SIZE * sizeof(int),
-                     count * sizeof(int)) != 0)
-    error("Failed to allocate indt.");
   for (int k = 0; k < count; k++)
     if (part_is_active(&parts[k], e)) {
       indt[countdt] = k;
@@ -2018,7 +2028,7 @@ void DOSELF1(struct runner *r, struct cell *restrict c) {
     }
   } /* loop over all particles. */
 
-  free(indt);
+  runner_arena_release(&r->arena, arena_mark);
 
   TIMER_TOC(TIMER_DOSELF);
 }
@@ -2053,6 +2063,9 @@ void DOSELF1_BRANCH(struct runner *r, struct cell *c) {
 #elif defined(WITH_VECTORIZATION) && defined(GADGET2_SPH) && \
     (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
   runner_doself1_density_vec(r, c);
+#elif defined(WITH_MASKED_HYDRO_VECTORIZATION) && \
+    (FUNCTION_TASK_LOOP != TASK_LOOP_FORCE)
+  DOSELF_VEC(r, c);
 #else
   DOSELF1(r, c);
 #endif
@@ -2075,11 +2088,10 @@ void DOSELF2(struct runner *r, struct cell *restrict c) {
   const int count = c->hydro.count;
 
   /* Set up indt. */
-  int *indt = NULL;
+  const size_t arena_mark = runner_arena_mark(&r->arena);
+  int *indt = (int *)runner_arena_alloc(&r->arena, count * sizeof(int),
+                                        VEC_SIZE * sizeof(int));
   int countdt = 0, firstdt = 0;
-  if (posix_memalign((void **)&indt, VEC_SIZE * sizeof(int),
-                     count * sizeof(int)) != 0)
-    error("Failed to allocate indt.");
   for (int k = 0; k < count; k++)
     if (part_is_active(&parts[k], e)) {
       indt[countdt] = k;
@@ -2210,7 +2222,7 @@ void DOSELF2(struct runner *r, struct cell *restrict c) {
     }
   } /* loop over all particles. */
 
-  free(indt);
+  runner_arena_release(&r->arena, arena_mark);
 
   TIMER_TOC(TIMER_DOSELF);
 }
@@ -2245,6 +2257,9 @@ void DOSELF2_BRANCH(struct runner *r, struct cell *c) {
 #elif defined(WITH_VECTORIZATION) && defined(GADGET2_SPH) && \
     (FUNCTION_TASK_LOOP == TASK_LOOP_FORCE)
   runner_doself2_force_vec(r, c);
+#elif defined(WITH_MASKED_HYDRO_VECTORIZATION) && \
+    (FUNCTION_TASK_LOOP == TASK_LOOP_FORCE)
+  DOSELF_VEC(r, c);
 #else
   DOSELF2(r, c);
 #endif
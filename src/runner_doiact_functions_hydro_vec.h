@@ -0,0 +1,459 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+/* Before including this file, define FUNCTION, which is the
+   name of the interaction function, and FUNCTION_TASK_LOOP. This creates the
+   masked vector versions of the self, pair and subset interaction loops for
+   the hydro schemes providing runner_iact_nonsym_vec_FUNCTION(). */
+
+#ifdef WITH_MASKED_HYDRO_VECTORIZATION
+
+/**
+ * @brief Interact one particle with a range of the particles stored in a
+ * #cache using masked vector operations (non-symmetric).
+ *
+ * The cached particles are processed one vector at a time. The lanes that are
+ * out of range (including the particle itself) are masked out of the
+ * interaction. The other physics modules interacting alongside the hydro are
+ * called for each of the particles in range.
+ *
+ * @param pi The #part to update.
+ * @param pix The x coordinate of pi in the frame of the cache.
+ * @param piy The y coordinate of pi in the frame of the cache.
+ * @param piz The z coordinate of pi in the frame of the cache.
+ * @param cj_cache The #cache of the particles to interact with.
+ * @param parts_j The #part array the cache was read from.
+ * @param sort_j The sort list the cache was read with (NULL if unsorted).
+ * @param pjd_start First index in the cache (must be a multiple of VEC_SIZE).
+ * @param pjd_end Index one past the last particle to consider in the cache.
+ * @param a Current scale factor.
+ * @param H Current Hubble parameter.
+ */
+__attribute__((always_inline)) INLINE static void DOPART_VEC(
+    struct part *restrict pi, const float pix, const float piy,
+    const float piz, const struct cache *restrict cj_cache,
+    struct part *restrict parts_j, const struct sort_entry *restrict sort_j,
+    const int pjd_start, const int pjd_end, const float a, const float H) {
+
+#ifdef SWIFT_DEBUG_CHECKS
+  if (pjd_start % VEC_SIZE != 0) error("Unaligned read! pjd=%d", pjd_start);
+#endif
+
+  const float hi = pi->h;
+  const vector v_pix = vector_set1(pix);
+  const vector v_piy = vector_set1(piy);
+  const vector v_piz = vector_set1(piz);
+  const vector v_hig2 = vector_set1(hi * hi * kernel_gamma2);
+
+  /* Broadcast the properties of pi and reset its partial sums. */
+  struct HYDRO_VEC_PI vi;
+  HYDRO_VEC_PI_INIT(&vi, pi, a, H);
+
+  for (int pjd = pjd_start; pjd < pjd_end; pjd += VEC_SIZE) {
+
+    vector v_dx, v_dy, v_dz, v_r2;
+
+    /* Load 1 set of vectors from the particle cache. */
+    const vector v_pjx = vector_load(&cj_cache->x[pjd]);
+    const vector v_pjy = vector_load(&cj_cache->y[pjd]);
+    const vector v_pjz = vector_load(&cj_cache->z[pjd]);
+
+    /* Compute the pairwise distance. */
+    v_dx.v = vec_sub(v_pix.v, v_pjx.v);
+    v_dy.v = vec_sub(v_piy.v, v_pjy.v);
+    v_dz.v = vec_sub(v_piz.v, v_pjz.v);
+
+    v_r2.v = vec_mul(v_dx.v, v_dx.v);
+    v_r2.v = vec_fma(v_dy.v, v_dy.v, v_r2.v);
+    v_r2.v = vec_fma(v_dz.v, v_dz.v, v_r2.v);
+
+    mask_t v_mask, v_self_mask;
+
+#if (FUNCTION_TASK_LOOP == TASK_LOOP_FORCE)
+    /* Form r2 < max(hig2, hjg2) mask. */
+    const vector v_hj = vector_load(&cj_cache->h[pjd]);
+    vector v_hjg2;
+    v_hjg2.v = vec_mul(vec_mul(v_hj.v, v_hj.v), vec_set1(kernel_gamma2));
+    vec_create_mask(v_mask, vec_cmp_lt(v_r2.v, vec_fmax(v_hig2.v, v_hjg2.v)));
+#else
+    /* Form r2 < hig2 mask. */
+    vec_create_mask(v_mask, vec_cmp_lt(v_r2.v, v_hig2.v));
+#endif
+
+    /* Do not interact the particle with itself. */
+    vec_create_mask(v_self_mask, vec_cmp_gt(v_r2.v, vec_setzero()));
+    vec_combine_masks(v_mask, v_self_mask);
+
+    if (!vec_is_mask_true(v_mask)) continue;
+
+    /* Keep the masked-out lanes well-behaved. */
+    v_r2.v = vec_blend(v_mask, vec_set1(1.f), v_r2.v);
+
+    IACT_NONSYM_VEC(&vi, &v_r2, &v_dx, &v_dy, &v_dz, cj_cache, pjd, v_mask);
+
+#if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY) || \
+    (FUNCTION_TASK_LOOP == TASK_LOOP_FORCE)
+
+    /* Interactions of the other physics modules. */
+    const int mask_bits = vec_is_mask_true(v_mask);
+    for (int k = 0; k < VEC_SIZE; k++) {
+
+      if (!(mask_bits & (1 << k))) continue;
+
+      struct part *restrict pj =
+          &parts_j[sort_j == NULL ? pjd + k : sort_j[pjd + k].i];
+      const float r2 = v_r2.f[k];
+      const float dx[3] = {v_dx.f[k], v_dy.f[k], v_dz.f[k]};
+      const float hj = cj_cache->h[pjd + k];
+
+#if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
+      runner_iact_nonsym_chemistry(r2, dx, hi, hj, pi, pj, a, H);
+      runner_iact_nonsym_pressure_floor(r2, dx, hi, hj, pi, pj, a, H);
+      runner_iact_nonsym_star_formation(r2, dx, hi, hj, pi, pj, a, H);
+#endif
+#if (FUNCTION_TASK_LOOP == TASK_LOOP_FORCE)
+      runner_iact_nonsym_timebin(r2, dx, hi, hj, pi, pj, a, H);
+#endif
+    }
+#endif
+  }
+
+  /* Add the partial sums to pi. */
+  HYDRO_VEC_PI_STORE(&vi, pi);
+}
+
+/**
+ * @brief Compute the interactions within a cell (non-symmetric, vectorised).
+ *
+ * @param r The #runner.
+ * @param c The #cell.
+ */
+void DOSELF_VEC(struct runner *r, struct cell *restrict c) {
+
+  const struct engine *e = r->e;
+  const struct cosmology *cosmo = e->cosmology;
+
+  TIMER_TIC;
+
+  /* Anything to do here? */
+  if (!cell_is_active_hydro(c, e)) return;
+
+  /* Cosmological terms */
+  const float a = cosmo->a;
+  const float H = cosmo->H;
+
+  const int count = c->hydro.count;
+  struct part *restrict parts = c->hydro.parts;
+
+  /* Read the particles into the cache, in the frame of the cell. */
+  struct cache *restrict cell_cache = &r->ci_cache;
+  const double width = max3(c->width[0], c->width[1], c->width[2]);
+  const int count_align =
+      cache_read_hydro_cell(c, cell_cache, NULL, c->loc, width);
+
+  /* Loop over the parts in c. */
+  for (int pid = 0; pid < count; pid++) {
+
+    /* Get a hold of the ith part in c. */
+    struct part *restrict pi = &parts[pid];
+
+    /* Skip inactive particles */
+    if (!part_is_active(pi, e)) continue;
+
+#ifdef SWIFT_DEBUG_CHECKS
+    /* Check that particles have been drifted to the current time */
+    if (pi->ti_drift != e->ti_current)
+      error("Particle pi not drifted to current time");
+#endif
+
+    DOPART_VEC(pi, cell_cache->x[pid], cell_cache->y[pid], cell_cache->z[pid],
+               cell_cache, parts, NULL, 0, count_align, a, H);
+  }
+
+  TIMER_TOC(TIMER_DOSELF);
+}
+
+/**
+ * @brief Compute the interactions between a cell pair (non-symmetric,
+ * vectorised).
+ *
+ * In the force loop, particles interact if they are within the kernel of
+ * either of the two particles.
+ *
+ * @param r The #runner.
+ * @param ci The first #cell.
+ * @param cj The second #cell.
+ * @param sid The direction of the pair.
+ * @param shift The shift vector to apply to the particles in ci.
+ */
+void DOPAIR_VEC(struct runner *r, struct cell *ci, struct cell *cj,
+                const int sid, const double *shift) {
+
+  const struct engine *restrict e = r->e;
+  const struct cosmology *restrict cosmo = e->cosmology;
+
+  TIMER_TIC;
+
+  /* Get the cutoff shift. */
+  double rshift = 0.0;
+  for (int k = 0; k < 3; k++) rshift += shift[k] * runner_shift[sid][k];
+
+  /* Pick-out the sorted lists. */
+  const struct sort_entry *restrict sort_i = cell_get_hydro_sorts(ci, sid);
+  const struct sort_entry *restrict sort_j = cell_get_hydro_sorts(cj, sid);
+
+  /* Get some other useful values. */
+  const int count_i = ci->hydro.count;
+  const int count_j = cj->hydro.count;
+  struct part *restrict parts_i = ci->hydro.parts;
+  struct part *restrict parts_j = cj->hydro.parts;
+  const double di_max = sort_i[count_i - 1].d - rshift;
+  const double dj_min = sort_j[0].d;
+  const float dx_max = (ci->hydro.dx_max_sort + cj->hydro.dx_max_sort);
+
+#if (FUNCTION_TASK_LOOP == TASK_LOOP_FORCE)
+  /* The neighbours' smoothing lengths also set the range of the search. */
+  const float hi_min = cj->hydro.h_max;
+  const float hj_min = ci->hydro.h_max;
+#else
+  const float hi_min = 0.f;
+  const float hj_min = 0.f;
+#endif
+  const double hi_max = max(ci->hydro.h_max, hi_min) * kernel_gamma - rshift;
+  const double hj_max = max(cj->hydro.h_max, hj_min) * kernel_gamma;
+
+  /* Cosmological terms */
+  const float a = cosmo->a;
+  const float H = cosmo->H;
+
+  /* Read the particles into the caches, in the frame of cj. */
+  const double loc_i[3] = {cj->loc[0] + shift[0], cj->loc[1] + shift[1],
+                           cj->loc[2] + shift[2]};
+  const double width_i = max3(ci->width[0], ci->width[1], ci->width[2]);
+  const double width_j = max3(cj->width[0], cj->width[1], cj->width[2]);
+  const double width = max(width_i, width_j);
+  struct cache *restrict ci_cache = &r->ci_cache;
+  struct cache *restrict cj_cache = &r->cj_cache;
+  cache_read_hydro_cell(ci, ci_cache, sort_i, loc_i, width);
+  cache_read_hydro_cell(cj, cj_cache, sort_j, cj->loc, width);
+
+  if (cell_is_active_hydro(ci, e)) {
+
+    /* Loop over the parts in ci. */
+    for (int pid = count_i - 1;
+         pid >= 0 && sort_i[pid].d + hi_max + dx_max > dj_min; pid--) {
+
+      /* Get a hold of the ith part in ci. */
+      struct part *restrict pi = &parts_i[sort_i[pid].i];
+
+      /* Skip inactive particles */
+      if (!part_is_active(pi, e)) continue;
+
+      /* Is there anything we need to interact with ? */
+      const double di =
+          sort_i[pid].d + max(pi->h, hi_min) * kernel_gamma + dx_max - rshift;
+      if (di < dj_min) continue;
+
+      /* Find the last particle of cj in range. */
+      int last_pj = 0;
+      while (last_pj < count_j && sort_j[last_pj].d < di) last_pj++;
+
+#ifdef SWIFT_DEBUG_CHECKS
+      /* Check that particles have been drifted to the current time */
+      if (pi->ti_drift != e->ti_current)
+        error("Particle pi not drifted to current time");
+#endif
+
+      DOPART_VEC(pi, ci_cache->x[pid], ci_cache->y[pid], ci_cache->z[pid],
+                 cj_cache, parts_j, sort_j, 0, last_pj, a, H);
+    }
+  }
+
+  if (cell_is_active_hydro(cj, e)) {
+
+    /* Loop over the parts in cj. */
+    for (int pjd = 0; pjd < count_j && sort_j[pjd].d - hj_max - dx_max < di_max;
+         pjd++) {
+
+      /* Get a hold of the jth part in cj. */
+      struct part *restrict pj = &parts_j[sort_j[pjd].i];
+
+      /* Skip inactive particles */
+      if (!part_is_active(pj, e)) continue;
+
+      /* Is there anything we need to interact with ? */
+      const double dj =
+          sort_j[pjd].d - max(pj->h, hj_min) * kernel_gamma - dx_max + rshift;
+      if (dj - rshift > di_max) continue;
+
+      /* Find the first particle of ci in range and align the index. */
+      int first_pi = count_i;
+      while (first_pi > 0 && sort_i[first_pi - 1].d > dj) first_pi--;
+      first_pi -= first_pi % VEC_SIZE;
+
+#ifdef SWIFT_DEBUG_CHECKS
+      /* Check that particles have been drifted to the current time */
+      if (pj->ti_drift != e->ti_current)
+        error("Particle pj not drifted to current time");
+#endif
+
+      DOPART_VEC(pj, cj_cache->x[pjd], cj_cache->y[pjd], cj_cache->z[pjd],
+                 ci_cache, parts_i, sort_i, first_pi, count_i, a, H);
+    }
+  }
+
+  TIMER_TOC(TIMER_DOPAIR);
+}
+
+#if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
+
+/**
+ * @brief Compute the interactions between a cell and a subset of its own
+ * particles (non-symmetric, vectorised).
+ *
+ * @param r The #runner.
+ * @param ci The #cell.
+ * @param parts The #part to interact.
+ * @param ind The list of indices of particles in @c ci to interact with.
+ * @param count The number of particles in @c ind.
+ */
+void DOSELF_SUBSET_VEC(struct runner *r, struct cell *restrict ci,
+                       struct part *restrict parts, int *restrict ind,
+                       int count) {
+
+  const struct engine *e = r->e;
+  const struct cosmology *cosmo = e->cosmology;
+
+  TIMER_TIC;
+
+  /* Cosmological terms */
+  const float a = cosmo->a;
+  const float H = cosmo->H;
+
+  /* Read the particles into the cache, in the frame of the cell. */
+  struct cache *restrict cell_cache = &r->ci_cache;
+  const double width = max3(ci->width[0], ci->width[1], ci->width[2]);
+  const int count_align =
+      cache_read_hydro_cell(ci, cell_cache, NULL, ci->loc, width);
+
+  /* Loop over the parts in the subset. */
+  for (int pid = 0; pid < count; pid++) {
+
+    /* Get a hold of the ith part in ci. */
+    struct part *restrict pi = &parts[ind[pid]];
+
+#ifdef SWIFT_DEBUG_CHECKS
+    if (!part_is_active(pi, e)) error("Inactive particle in subset function!");
+#endif
+
+    DOPART_VEC(pi, (float)(pi->x[0] - ci->loc[0]),
+               (float)(pi->x[1] - ci->loc[1]), (float)(pi->x[2] - ci->loc[2]),
+               cell_cache, ci->hydro.parts, NULL, 0, count_align, a, H);
+  }
+
+  TIMER_TOC(timer_doself_subset);
+}
+
+/**
+ * @brief Compute the interactions between a cell pair, but only for the
+ * given indices in ci (non-symmetric, vectorised).
+ *
+ * @param r The #runner.
+ * @param ci The first #cell.
+ * @param parts_i The #part to interact with @c cj.
+ * @param ind The list of indices of particles in @c ci to interact with.
+ * @param count The number of particles in @c ind.
+ * @param cj The second #cell.
+ * @param sid The direction of the pair.
+ * @param flipped Flag to check whether the cells have been flipped or not.
+ * @param shift The shift vector to apply to the particles in ci.
+ */
+void DOPAIR_SUBSET_VEC(struct runner *r, struct cell *restrict ci,
+                       struct part *restrict parts_i, int *restrict ind,
+                       int count, struct cell *restrict cj, const int sid,
+                       const int flipped, const double *shift) {
+
+  const struct engine *e = r->e;
+  const struct cosmology *cosmo = e->cosmology;
+
+  TIMER_TIC;
+
+  const int count_j = cj->hydro.count;
+  struct part *restrict parts_j = cj->hydro.parts;
+
+  /* Cosmological terms */
+  const float a = cosmo->a;
+  const float H = cosmo->H;
+
+  /* Pick-out the sorted lists. */
+  const struct sort_entry *sort_j = cell_get_hydro_sorts(cj, sid);
+  const float dxj = cj->hydro.dx_max_sort;
+
+  /* Read the particles of cj into the cache, in their own frame. */
+  struct cache *restrict cj_cache = &r->cj_cache;
+  const double width_i = max3(ci->width[0], ci->width[1], ci->width[2]);
+  const double width_j = max3(cj->width[0], cj->width[1], cj->width[2]);
+  const double width = max(width_i, width_j);
+  cache_read_hydro_cell(cj, cj_cache, sort_j, cj->loc, width);
+
+  /* Loop over the parts_i. */
+  for (int pid = 0; pid < count; pid++) {
+
+    /* Get a hold of the ith part in ci. */
+    struct part *restrict pi = &parts_i[ind[pid]];
+    const double pix = pi->x[0] - (shift[0]);
+    const double piy = pi->x[1] - (shift[1]);
+    const double piz = pi->x[2] - (shift[2]);
+    const float hi = pi->h;
+    const double dproj = pix * runner_shift[sid][0] +
+                         piy * runner_shift[sid][1] +
+                         piz * runner_shift[sid][2];
+
+    int first_pj, last_pj;
+
+    /* Parts are on the left? */
+    if (!flipped) {
+
+      const double di = hi * kernel_gamma + dxj + dproj;
+
+      first_pj = 0;
+      last_pj = 0;
+      while (last_pj < count_j && sort_j[last_pj].d < di) last_pj++;
+
+    } else {
+
+      const double di = -hi * kernel_gamma - dxj + dproj;
+
+      first_pj = count_j;
+      last_pj = count_j;
+      while (first_pj > 0 && sort_j[first_pj - 1].d > di) first_pj--;
+      first_pj -= first_pj % VEC_SIZE;
+    }
+
+    DOPART_VEC(pi, (float)(pix - cj->loc[0]), (float)(piy - cj->loc[1]),
+               (float)(piz - cj->loc[2]), cj_cache, parts_j, sort_j, first_pj,
+               last_pj, a, H);
+  }
+
+  TIMER_TOC(timer_dopair_subset);
+}
+
+#endif /* FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY */
+
+#endif /* WITH_MASKED_HYDRO_VECTORIZATION */
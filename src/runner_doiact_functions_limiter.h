@@ -549,11 +549,10 @@ void DOSELF1(struct runner *r, struct cell *restrict c) {
   const int count = c->hydro.count;
 
   /* Set up indt. */
-  int *indt = NULL;
+  const size_t arena_mark = runner_arena_mark(&r->arena);
+  int *indt = (int *)runner_arena_alloc(&r->arena, count * sizeof(int),
+                                        VEC_SIZE * sizeof(int));
   int countdt = 0, firstdt = 0;
-  if (posix_memalign((void **)&indt, VEC_SIZE * sizeof(int),
-                     count * sizeof(int)) != 0)
-    error("Failed to allocate indt.");
   for (int k = 0; k < count; k++)
     if (part_is_starting(&parts[k], e)) {
       indt[countdt] = k;
@@ -672,7 +671,7 @@ void DOSELF1(struct runner *r, struct cell *restrict c) {
     }
   } /* loop over all particles. */
 
-  free(indt);
+  runner_arena_release(&r->arena, arena_mark);
 
   TIMER_TOC(TIMER_DOSELF);
 }
@@ -1168,8 +1168,8 @@ void runner_dopair_grav_pp(struct runner *r, struct cell *ci, struct cell *cj,
 #endif
 
   /* Caches to play with */
-  struct gravity_cache *const ci_cache = &r->ci_gravity_cache;
-  struct gravity_cache *const cj_cache = &r->cj_gravity_cache;
+  struct gravity_cache *ci_cache = &r->ci_gravity_cache;
+  struct gravity_cache *cj_cache = &r->cj_gravity_cache;
 
   /* Shift to apply to the particles in each cell */
   const double shift_i[3] = {0., 0., 0.};
@@ -1205,6 +1205,24 @@ void runner_dopair_grav_pp(struct runner *r, struct cell *ci, struct cell *cj,
   const int allow_multipole_i = allow_mpole && ci->grav.count > 1;
   const int allow_multipole_j = allow_mpole && cj->grav.count > 1;
 
+#ifdef SWIFT_GRAVITY_CELL_CACHE
+  /* Read the particles straight from the cells' gravity caches. We hold the
+   * lock on both cells, so the first interaction of the step can fill them */
+  struct gravity_cache ci_view, cj_view;
+  gravity_cell_cache_prepare(ci, e->ti_current, e->gravity_properties);
+  gravity_cell_cache_prepare(cj, e->ti_current, e->gravity_properties);
+
+  gravity_cache_populate_from_cell_cache(
+      e->max_active_bin, &ci_view, ci_cache, allow_multipole_j, periodic, dim,
+      &ci->grav.cache, gcount_padded_i, CoM_j, cj->grav.multipole,
+      e->gravity_properties);
+  gravity_cache_populate_from_cell_cache(
+      e->max_active_bin, &cj_view, cj_cache, allow_multipole_i, periodic, dim,
+      &cj->grav.cache, gcount_padded_j, CoM_i, ci->grav.multipole,
+      e->gravity_properties);
+  ci_cache = &ci_view;
+  cj_cache = &cj_view;
+#else
   /* Fill the caches */
   gravity_cache_populate(e->max_active_bin, allow_multipole_j, periodic, dim,
                          ci_cache, ci->grav.parts, gcount_i, gcount_padded_i,
@@ -1214,6 +1232,7 @@ void runner_dopair_grav_pp(struct runner *r, struct cell *ci, struct cell *cj,
                          cj_cache, cj->grav.parts, gcount_j, gcount_padded_j,
                          shift_j, CoM_i, ci->grav.multipole, cj,
                          e->gravity_properties);
+#endif
 
   /* Can we use the Newtonian version or do we need the truncated one ? */
   if (!periodic) {
@@ -2036,7 +2055,7 @@ void runner_dopair_recursive_grav_pm(struct runner *r, struct cell *ci,
     /* Start by constructing particle caches */
 
     /* Cache to play with */
-    struct gravity_cache *const ci_cache = &r->ci_gravity_cache;
+    struct gravity_cache *ci_cache = &r->ci_gravity_cache;
 
     /* Computed the padded counts */
     const int gcount_i = ci->grav.count;
@@ -2059,10 +2078,21 @@ void runner_dopair_recursive_grav_pm(struct runner *r, struct cell *ci,
       error("Constructing cache for M2P interaction with multipole of size 0!");
 #endif
 
+#ifdef SWIFT_GRAVITY_CELL_CACHE
+    /* Read the particles straight from the cell's gravity cache. We hold the
+     * lock on the cell, so the first interaction of the step can fill it */
+    struct gravity_cache ci_view;
+    gravity_cell_cache_prepare(ci, e->ti_current, e->gravity_properties);
+    gravity_cache_populate_all_mpole_from_cell_cache(
+        e->max_active_bin, &ci_view, ci_cache, &ci->grav.cache,
+        gcount_padded_i);
+    ci_cache = &ci_view;
+#else
     /* Fill the cache */
     gravity_cache_populate_all_mpole(
         e->max_active_bin, periodic, dim, ci_cache, ci->grav.parts, gcount_i,
         gcount_padded_i, ci, CoM_j, cj->grav.multipole, e->gravity_properties);
+#endif
 
     /* Can we use the Newtonian version or do we need the truncated one ? */
     if (!periodic) {
@@ -2336,14 +2366,13 @@ void runner_do_grav_long_range(struct runner *r, struct cell *ci,
   const struct engine *e = r->e;
   const int periodic = e->mesh->periodic;
   const double dim[3] = {e->mesh->dim[0], e->mesh->dim[1], e->mesh->dim[2]};
-  const double max_distance2 = e->mesh->r_cut_max * e->mesh->r_cut_max;
+  const float r_s_inv = e->mesh->r_s_inv;
 
   TIMER_TIC;
 
   /* Recover the list of top-level cells */
-  struct cell *cells = e->s->cells_top;
-  int *cells_with_particles = e->s->cells_with_particles_top;
-  const int nr_cells_with_particles = e->s->nr_cells_with_particles;
+  const struct space *s = e->s;
+  struct cell *cells = s->cells_top;
 
   /* Anything to do here? */
   if (!cell_is_active_gravity(ci, e)) return;
@@ -2361,62 +2390,86 @@ void runner_do_grav_long_range(struct runner *r, struct cell *ci,
   struct cell *top = ci;
   while (top->parent != NULL) top = top->parent;
 
-  /* Loop over all the top-level cells and go for a M-M interaction if
-   * well-separated */
-  for (int n = 0; n < nr_cells_with_particles; ++n) {
+#ifdef SWIFT_DEBUG_CHECKS
+  if (multi_i->pot.ti_init != e->ti_current)
+    error("ci->grav tensor not initialised.");
+#endif
 
-    /* Handle on the top-level cell and it's gravity business*/
-    struct cell *cj = &cells[cells_with_particles[n]];
-    struct gravity_tensors *const multi_j = cj->grav.multipole;
+  /* Collect the M-M interactions in a batch to evaluate them with SIMD */
+  struct gravity_M2L_batch *const batch = &r->M2L_batch;
+  gravity_M2L_batch_begin(batch, multi_i->CoM, periodic, dim, r_s_inv);
+
+  /* Recover the list of well-separated top-level cells made at rebuild */
+  const int top_id = top - cells;
+  const int *list =
+      &s->grav_long_range_cells[s->grav_long_range_offsets[top_id]];
+  const int nr_mm = s->grav_long_range_offsets[top_id + 1] -
+                    s->grav_long_range_offsets[top_id];
 
-    /* Avoid self contributions */
-    if (top == cj) continue;
+  /* Loop over them and go for a M-M interaction */
+  for (int n = 0; n < nr_mm; ++n) {
+
+    /* Handle on the top-level cell and it's gravity business*/
+    const struct cell *cj = &cells[list[n]];
+    const struct gravity_tensors *const multi_j = cj->grav.multipole;
 
     /* Skip empty cells */
     if (multi_j->m_pole.M_000 == 0.f) continue;
 
-    /* Can we escape early in the periodic BC case? */
-    if (periodic) {
+#ifdef SWIFT_DEBUG_CHECKS
+    if (multi_j->m_pole.num_gpart == 0)
+      error("Multipole does not seem to have been set.");
 
-      /* Minimal distance between any pair of particles */
-      const double min_radius2 =
-          cell_min_dist2_same_size(top, cj, periodic, dim);
+    if (cj->grav.ti_old_multipole != e->ti_current)
+      error("Undrifted multipole cj->grav.ti_old_multipole=%lld",
+            cj->grav.ti_old_multipole);
+#endif
 
-      /* Are we beyond the distance where the truncated forces are 0 ?*/
-      if (min_radius2 > max_distance2) {
+    /* Queue the M2L interaction */
+    gravity_M2L_batch_add(batch, &multi_j->m_pole, multi_j->CoM);
+
+    /* Record that this multipole received a contribution */
+    multi_i->pot.interacted = 1;
+  }
 
+  /* The cells beyond the cut-off contribute through the mesh */
+  if (s->grav_long_range_nr_far[top_id] > 0) multi_i->pot.interacted = 1;
+
+#if defined(SWIFT_DEBUG_CHECKS) || defined(SWIFT_GRAVITY_FORCE_CHECKS)
+  /* Need to account for the interactions we missed */
+  if (periodic) {
+    const double max_distance2 = e->mesh->r_cut_max * e->mesh->r_cut_max;
+    for (int n = 0; n < s->nr_cells_with_particles; ++n) {
+      const struct cell *cj = &cells[s->cells_with_particles_top[n]];
+      const struct gravity_tensors *const multi_j = cj->grav.multipole;
+
+      if (top == cj || multi_j->m_pole.M_000 == 0.f) continue;
+
+      /* Are we beyond the distance where the truncated forces are 0 ?*/
+      if (cell_min_dist2_same_size(top, cj, periodic, dim) > max_distance2) {
 #ifdef SWIFT_DEBUG_CHECKS
-        /* Need to account for the interactions we missed */
         accumulate_add_ll(&multi_i->pot.num_interacted,
                           multi_j->m_pole.num_gpart);
 #endif
-
 #ifdef SWIFT_GRAVITY_FORCE_CHECKS
-        /* Need to account for the interactions we missed */
         accumulate_add_ll(&multi_i->pot.num_interacted_pm,
                           multi_j->m_pole.num_gpart);
 #endif
-
-        /* Record that this multipole received a contribution */
-        multi_i->pot.interacted = 1;
-
-        /* We are done here. */
-        continue;
       }
     }
+  }
+#endif
 
-    if (cell_can_use_pair_mm(top, cj, e, e->s, /*use_rebuild_data=*/1,
-                             /*is_tree_walk=*/0)) {
-
-      /* Call the PM interaction fucntion on the active sub-cells of ci */
-      runner_dopair_grav_mm_nonsym(r, ci, cj);
-      // runner_dopair_recursive_grav_pm(r, ci, cj);
+#ifndef SWIFT_TASKS_WITHOUT_ATOMICS
+  lock_lock(&ci->grav.mlock);
+#endif
 
-      /* Record that this multipole received a contribution */
-      multi_i->pot.interacted = 1;
+  /* Compute the remaining interactions and add them to ci */
+  gravity_M2L_batch_end(batch, &multi_i->pot);
 
-    } /* We are in charge of this pair */
-  }   /* Loop over top-level cells */
+#ifndef SWIFT_TASKS_WITHOUT_ATOMICS
+  if (lock_unlock(&ci->grav.mlock) != 0) error("Failed to unlock multipole");
+#endif
 
   if (timer) TIMER_TOC(timer_dograv_long_range);
 }
@@ -107,6 +107,30 @@
 #define _IACT_VEC(f) PASTE(runner_iact_vec, f)
 #define IACT_VEC _IACT_VEC(FUNCTION)
 
+#define _DOSELF_VEC(f) PASTE(runner_doself_vec, f)
+#define DOSELF_VEC _DOSELF_VEC(FUNCTION)
+
+#define _DOPAIR_VEC(f) PASTE(runner_dopair_vec, f)
+#define DOPAIR_VEC _DOPAIR_VEC(FUNCTION)
+
+#define _DOSELF_SUBSET_VEC(f) PASTE(runner_doself_subset_vec, f)
+#define DOSELF_SUBSET_VEC _DOSELF_SUBSET_VEC(FUNCTION)
+
+#define _DOPAIR_SUBSET_VEC(f) PASTE(runner_dopair_subset_vec, f)
+#define DOPAIR_SUBSET_VEC _DOPAIR_SUBSET_VEC(FUNCTION)
+
+#define _DOPART_VEC(f) PASTE(runner_dopart_vec, f)
+#define DOPART_VEC _DOPART_VEC(FUNCTION)
+
+#define _HYDRO_VEC_PI(f) PASTE(hydro_vec_pi, f)
+#define HYDRO_VEC_PI _HYDRO_VEC_PI(FUNCTION)
+
+#define _HYDRO_VEC_PI_INIT(f) PASTE(hydro_vec_pi_init, f)
+#define HYDRO_VEC_PI_INIT _HYDRO_VEC_PI_INIT(FUNCTION)
+
+#define _HYDRO_VEC_PI_STORE(f) PASTE(hydro_vec_pi_store, f)
+#define HYDRO_VEC_PI_STORE _HYDRO_VEC_PI_STORE(FUNCTION)
+
 #define _TIMER_DOSELF(f) PASTE(timer_doself, f)
 #define TIMER_DOSELF _TIMER_DOSELF(FUNCTION)
 
@@ -114,18 +114,15 @@ void runner_do_stars_ghost(struct runner *r, struct cell *c, int timer) {
   } else {
 
     /* Init the list of active particles that have to be updated. */
-    int *sid = NULL;
-    float *h_0 = NULL;
-    float *left = NULL;
-    float *right = NULL;
-    if ((sid = (int *)malloc(sizeof(int) * c->stars.count)) == NULL)
-      error("Can't allocate memory for sid.");
-    if ((h_0 = (float *)malloc(sizeof(float) * c->stars.count)) == NULL)
-      error("Can't allocate memory for h_0.");
-    if ((left = (float *)malloc(sizeof(float) * c->stars.count)) == NULL)
-      error("Can't allocate memory for left.");
-    if ((right = (float *)malloc(sizeof(float) * c->stars.count)) == NULL)
-      error("Can't allocate memory for right.");
+    const size_t arena_mark = runner_arena_mark(&r->arena);
+    int *sid = (int *)runner_arena_alloc(
+        &r->arena, sizeof(int) * c->stars.count, sizeof(int));
+    float *h_0 = (float *)runner_arena_alloc(
+        &r->arena, sizeof(float) * c->stars.count, sizeof(float));
+    float *left = (float *)runner_arena_alloc(
+        &r->arena, sizeof(float) * c->stars.count, sizeof(float));
+    float *right = (float *)runner_arena_alloc(
+        &r->arena, sizeof(float) * c->stars.count, sizeof(float));
     for (int k = 0; k < c->stars.count; k++)
       if (spart_is_active(&sparts[k], e) &&
           feedback_is_active(&sparts[k], e->time, cosmo, with_cosmology)) {
@@ -461,10 +458,7 @@ void runner_do_stars_ghost(struct runner *r, struct cell *c, int timer) {
     }
 
     /* Be clean */
-    free(left);
-    free(right);
-    free(sid);
-    free(h_0);
+    runner_arena_release(&r->arena, arena_mark);
   }
 
   /* Update h_max */
@@ -525,18 +519,15 @@ void runner_do_black_holes_density_ghost(struct runner *r, struct cell *c,
   } else {
 
     /* Init the list of active particles that have to be updated. */
-    int *sid = NULL;
-    float *h_0 = NULL;
-    float *left = NULL;
-    float *right = NULL;
-    if ((sid = (int *)malloc(sizeof(int) * c->black_holes.count)) == NULL)
-      error("Can't allocate memory for sid.");
-    if ((h_0 = (float *)malloc(sizeof(float) * c->black_holes.count)) == NULL)
-      error("Can't allocate memory for h_0.");
-    if ((left = (float *)malloc(sizeof(float) * c->black_holes.count)) == NULL)
-      error("Can't allocate memory for left.");
-    if ((right = (float *)malloc(sizeof(float) * c->black_holes.count)) == NULL)
-      error("Can't allocate memory for right.");
+    const size_t arena_mark = runner_arena_mark(&r->arena);
+    int *sid = (int *)runner_arena_alloc(
+        &r->arena, sizeof(int) * c->black_holes.count, sizeof(int));
+    float *h_0 = (float *)runner_arena_alloc(
+        &r->arena, sizeof(float) * c->black_holes.count, sizeof(float));
+    float *left = (float *)runner_arena_alloc(
+        &r->arena, sizeof(float) * c->black_holes.count, sizeof(float));
+    float *right = (float *)runner_arena_alloc(
+        &r->arena, sizeof(float) * c->black_holes.count, sizeof(float));
     for (int k = 0; k < c->black_holes.count; k++)
       if (bpart_is_active(&bparts[k], e)) {
         sid[bcount] = k;
@@ -772,10 +763,7 @@ void runner_do_black_holes_density_ghost(struct runner *r, struct cell *c,
     }
 
     /* Be clean */
-    free(left);
-    free(right);
-    free(sid);
-    free(h_0);
+    runner_arena_release(&r->arena, arena_mark);
   }
 
   /* Update h_max */
@@ -995,18 +983,15 @@ void runner_do_ghost(struct runner *r, struct cell *c, int timer) {
 
     /* Init the list of active particles that have to be updated and their
      * current smoothing lengths. */
-    int *pid = NULL;
-    float *h_0 = NULL;
-    float *left = NULL;
-    float *right = NULL;
-    if ((pid = (int *)malloc(sizeof(int) * c->hydro.count)) == NULL)
-      error("Can't allocate memory for pid.");
-    if ((h_0 = (float *)malloc(sizeof(float) * c->hydro.count)) == NULL)
-      error("Can't allocate memory for h_0.");
-    if ((left = (float *)malloc(sizeof(float) * c->hydro.count)) == NULL)
-      error("Can't allocate memory for left.");
-    if ((right = (float *)malloc(sizeof(float) * c->hydro.count)) == NULL)
-      error("Can't allocate memory for right.");
+    const size_t arena_mark = runner_arena_mark(&r->arena);
+    int *pid = (int *)runner_arena_alloc(
+        &r->arena, sizeof(int) * c->hydro.count, sizeof(int));
+    float *h_0 = (float *)runner_arena_alloc(
+        &r->arena, sizeof(float) * c->hydro.count, sizeof(float));
+    float *left = (float *)runner_arena_alloc(
+        &r->arena, sizeof(float) * c->hydro.count, sizeof(float));
+    float *right = (float *)runner_arena_alloc(
+        &r->arena, sizeof(float) * c->hydro.count, sizeof(float));
     for (int k = 0; k < c->hydro.count; k++)
       if (part_is_active(&parts[k], e)) {
         pid[count] = k;
@@ -1368,10 +1353,7 @@ void runner_do_ghost(struct runner *r, struct cell *c, int timer) {
     }
 
     /* Be clean */
-    free(left);
-    free(right);
-    free(pid);
-    free(h_0);
+    runner_arena_release(&r->arena, arena_mark);
   }
 
   /* Update h_max */
@@ -520,10 +520,18 @@ void *runner_main(void *data) {
       r->t = NULL;
 #endif
 
+      /* Release the scratch memory used by the task */
+      runner_arena_reset(&r->arena);
+
       /* We're done with this task, see if we get a next one. */
       prev = t;
       t = scheduler_done(sched, t);
 
+      /* Account for the time it took and maybe sample it. */
+      r->busy_ticks += prev->toc - prev->tic;
+      r->last_toc = prev->toc;
+      task_profiler_sample(&r->profiler_ring, e->profiler.every, prev);
+
     } /* main loop. */
   }
 
@@ -29,8 +29,13 @@
 #include "active.h"
 #include "cell.h"
 #include "engine.h"
+#include "sort_part.h"
 #include "timers.h"
 
+/*! Average number of moves per particle beyond which re-using the order of
+ * the previous sort is abandoned in favour of a full sort. */
+#define runner_sort_max_moves_per_entry 8
+
 /**
  * @brief Sorts again all the stars in a given cell hierarchy.
  *
@@ -58,108 +63,6 @@ void runner_do_stars_resort(struct runner *r, struct cell *c, const int timer) {
   if (timer) TIMER_TOC(timer_do_stars_resort);
 }
 
-/**
- * @brief Sort the entries in ascending order using QuickSort.
- *
- * @param sort The entries
- * @param N The number of entries.
- */
-void runner_do_sort_ascending(struct sort_entry *sort, int N) {
-  const int stack_size = 10;
-
-  struct {
-    short int lo, hi;
-  } qstack[stack_size];
-  int qpos, i, j, lo, hi, imin;
-  struct sort_entry temp;
-  float pivot;
-
-  if (N >= (1LL << stack_size)) {
-    error(
-        "The stack size for sorting is too small."
-        "Either increase it or reduce the number of parts per cell.");
-  }
-
-  /* Sort parts in cell_i in decreasing order with quicksort */
-  qstack[0].lo = 0;
-  qstack[0].hi = N - 1;
-  qpos = 0;
-  while (qpos >= 0) {
-    lo = qstack[qpos].lo;
-    hi = qstack[qpos].hi;
-    qpos -= 1;
-    /* Do we have a low number of element to sort? */
-    if (hi - lo < 15) {
-      /* Sort the last elements. */
-      for (i = lo; i < hi; i++) {
-        imin = i;
-        /* Find the minimal value. */
-        for (j = i + 1; j <= hi; j++) {
-          if (sort[j].d < sort[imin].d) {
-            imin = j;
-          }
-        }
-        /* Swap the elements if a smaller element exists. */
-        if (imin != i) {
-          temp = sort[imin];
-          sort[imin] = sort[i];
-          sort[i] = temp;
-        }
-      }
-    } else {
-      /* Select a pivot */
-      pivot = sort[(lo + hi) / 2].d;
-      i = lo;
-      j = hi;
-      /* Ensure that the elements before/after the pivot
-         are smaller/larger than the pivot. */
-      while (i <= j) {
-        /* Find the first elements that do not respect
-           the order. */
-        while (sort[i].d < pivot) i++;
-        while (sort[j].d > pivot) j--;
-        /* Did we get two different elements */
-        if (i <= j) {
-          if (i < j) {
-            /* Swap the elements */
-            temp = sort[i];
-            sort[i] = sort[j];
-            sort[j] = temp;
-          }
-          i += 1;
-          j -= 1;
-        }
-      }
-      /* Add the next operations to the stack.
-       * The order is important in order to decrease the stack size.
-       */
-      if (j > (lo + hi) / 2) {
-        if (lo < j) {
-          qpos += 1;
-          qstack[qpos].lo = lo;
-          qstack[qpos].hi = j;
-        }
-        if (i < hi) {
-          qpos += 1;
-          qstack[qpos].lo = i;
-          qstack[qpos].hi = hi;
-        }
-      } else {
-        if (i < hi) {
-          qpos += 1;
-          qstack[qpos].lo = i;
-          qstack[qpos].hi = hi;
-        }
-        if (lo < j) {
-          qpos += 1;
-          qstack[qpos].lo = lo;
-          qstack[qpos].hi = j;
-        }
-      }
-    }
-  }
-}
-
 #ifdef SWIFT_DEBUG_CHECKS
 /**
  * @brief Recursively checks that the flags are consistent in a cell hierarchy.
@@ -366,11 +269,17 @@ void runner_do_hydro_sort(struct runner *r, struct cell *c, int flags,
       c->hydro.dx_max_sort = 0.f;
     }
 
+    /* Directions for which we can start from the order of the last sort.
+       The particles have not been re-ordered in memory since then, so the
+       old list is still a valid permutation that is now almost sorted. */
+    const int flags_reuse = flags & c->hydro.sort_reusable;
+    const int flags_fresh = flags & ~flags_reuse;
+
     /* Fill the sort array. */
     for (int k = 0; k < count; k++) {
       const double px[3] = {parts[k].x[0], parts[k].x[1], parts[k].x[2]};
       for (int j = 0; j < 13; j++)
-        if (flags & (1 << j)) {
+        if (flags_fresh & (1 << j)) {
           struct sort_entry *entries = cell_get_hydro_sorts(c, j);
           entries[k].i = k;
           entries[k].d = px[0] * runner_shift[j][0] +
@@ -379,15 +288,34 @@ void runner_do_hydro_sort(struct runner *r, struct cell *c, int flags,
         }
     }
 
+    /* Update the distances of the re-used sort arrays. */
+    for (int j = 0; j < 13; j++)
+      if (flags_reuse & (1 << j)) {
+        struct sort_entry *entries = cell_get_hydro_sorts(c, j);
+        for (int k = 0; k < count; k++) {
+          const double *px = parts[entries[k].i].x;
+          entries[k].d = px[0] * runner_shift[j][0] +
+                         px[1] * runner_shift[j][1] +
+                         px[2] * runner_shift[j][2];
+        }
+      }
+
     /* Add the sentinel and sort. */
     for (int j = 0; j < 13; j++)
       if (flags & (1 << j)) {
         struct sort_entry *entries = cell_get_hydro_sorts(c, j);
         entries[count].d = FLT_MAX;
         entries[count].i = 0;
-        runner_do_sort_ascending(entries, count);
+        if (flags_reuse & (1 << j))
+          sort_part_ascending_adaptive(entries, count,
+                                       runner_sort_max_moves_per_entry);
+        else
+          sort_part_ascending(entries, count);
         atomic_or(&c->hydro.sorted, 1 << j);
       }
+
+    /* These can be used as a starting point next time. */
+    c->hydro.sort_reusable |= flags;
   }
 
 #ifdef SWIFT_DEBUG_CHECKS
@@ -614,7 +542,7 @@ void runner_do_stars_sort(struct runner *r, struct cell *c, int flags,
         struct sort_entry *entries = cell_get_stars_sorts(c, j);
         entries[count].d = FLT_MAX;
         entries[count].i = 0;
-        runner_do_sort_ascending(entries, count);
+        sort_part_ascending(entries, count);
         atomic_or(&c->stars.sorted, 1 << j);
       }
   }
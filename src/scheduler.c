@@ -30,6 +30,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
+#include <time.h>
 
 /* MPI headers. */
 #ifdef WITH_MPI
@@ -1121,6 +1122,11 @@ struct task *scheduler_addtask(struct scheduler *s, enum task_types type,
   t->tic = 0;
   t->toc = 0;
   t->total_ticks = 0;
+#if defined(WITH_MPI) && defined(SWIFT_MPIUSE_REPORTS)
+  t->mpi_size = 0;
+  t->mpi_tic = 0;
+  t->mpi_ticks = 0;
+#endif
 
   if (ci != NULL) cell_set_flag(ci, cell_flag_has_tasks);
   if (cj != NULL) cell_set_flag(cj, cell_flag_has_tasks);
@@ -1329,332 +1335,406 @@ void scheduler_reset(struct scheduler *s, int size) {
 }
 
 /**
- * @brief Compute the task weights
+ * @brief Model of the cost of a task based on the number of particles it
+ * acts on.
  *
- * @param s The #scheduler.
- * @param verbose Are we talkative?
+ * @param t The #task.
+ * @param nodeID The ID of the node we are on.
  */
-void scheduler_reweight(struct scheduler *s, int verbose) {
-  const int nr_tasks = s->nr_tasks;
-  int *tid = s->tasks_ind;
-  struct task *tasks = s->tasks;
-  const int nodeID = s->nodeID;
+static float scheduler_task_model_cost(const struct task *t,
+                                       const int nodeID) {
   const float wscale = 0.001f;
-  const ticks tic = getticks();
+  float cost = 0.f;
+
+  const float count_i = (t->ci != NULL) ? t->ci->hydro.count : 0.f;
+  const float count_j = (t->cj != NULL) ? t->cj->hydro.count : 0.f;
+  const float gcount_i = (t->ci != NULL) ? t->ci->grav.count : 0.f;
+  const float gcount_j = (t->cj != NULL) ? t->cj->grav.count : 0.f;
+  const float scount_i = (t->ci != NULL) ? t->ci->stars.count : 0.f;
+  const float scount_j = (t->cj != NULL) ? t->cj->stars.count : 0.f;
+  const float sink_count_i = (t->ci != NULL) ? t->ci->sinks.count : 0.f;
+  const float sink_count_j = (t->cj != NULL) ? t->cj->sinks.count : 0.f;
+  const float bcount_i = (t->ci != NULL) ? t->ci->black_holes.count : 0.f;
+  const float bcount_j = (t->cj != NULL) ? t->cj->black_holes.count : 0.f;
+
+  switch (t->type) {
+    case task_type_sort:
+      cost = wscale * intrinsics_popcount(t->flags) * count_i *
+             (sizeof(int) * 8 - intrinsics_clz(t->ci->hydro.count));
+      break;
 
-  /* Run through the tasks backwards and set their weights. */
-  for (int k = nr_tasks - 1; k >= 0; k--) {
-    struct task *t = &tasks[tid[k]];
-    float cost = 0.f;
-    t->weight = 0.f;
+    case task_type_stars_sort:
+      cost = wscale * intrinsics_popcount(t->flags) * scount_i *
+             (sizeof(int) * 8 - intrinsics_clz(t->ci->stars.count));
+      break;
 
-    for (int j = 0; j < t->nr_unlock_tasks; j++)
-      if (t->unlock_tasks[j]->weight > t->weight)
-        t->weight = t->unlock_tasks[j]->weight;
+    case task_type_stars_resort:
+      cost = wscale * intrinsics_popcount(t->flags) * scount_i *
+             (sizeof(int) * 8 - intrinsics_clz(t->ci->stars.count));
+      break;
 
-    const float count_i = (t->ci != NULL) ? t->ci->hydro.count : 0.f;
-    const float count_j = (t->cj != NULL) ? t->cj->hydro.count : 0.f;
-    const float gcount_i = (t->ci != NULL) ? t->ci->grav.count : 0.f;
-    const float gcount_j = (t->cj != NULL) ? t->cj->grav.count : 0.f;
-    const float scount_i = (t->ci != NULL) ? t->ci->stars.count : 0.f;
-    const float scount_j = (t->cj != NULL) ? t->cj->stars.count : 0.f;
-    const float sink_count_i = (t->ci != NULL) ? t->ci->sinks.count : 0.f;
-    const float sink_count_j = (t->cj != NULL) ? t->cj->sinks.count : 0.f;
-    const float bcount_i = (t->ci != NULL) ? t->ci->black_holes.count : 0.f;
-    const float bcount_j = (t->cj != NULL) ? t->cj->black_holes.count : 0.f;
+    case task_type_self:
+      if (t->subtype == task_subtype_grav) {
+        cost = 1.f * (wscale * gcount_i) * gcount_i;
+      } else if (t->subtype == task_subtype_external_grav)
+        cost = 1.f * wscale * gcount_i;
+      else if (t->subtype == task_subtype_stars_density ||
+               t->subtype == task_subtype_stars_feedback)
+        cost = 1.f * wscale * scount_i * count_i;
+      else if (t->subtype == task_subtype_sink_compute_formation)
+        cost = 1.f * wscale * count_i * sink_count_i;
+      else if (t->subtype == task_subtype_bh_density ||
+               t->subtype == task_subtype_bh_swallow ||
+               t->subtype == task_subtype_bh_feedback)
+        cost = 1.f * wscale * bcount_i * count_i;
+      else if (t->subtype == task_subtype_do_gas_swallow)
+        cost = 1.f * wscale * count_i;
+      else if (t->subtype == task_subtype_do_bh_swallow)
+        cost = 1.f * wscale * bcount_i;
+      else if (t->subtype == task_subtype_density ||
+               t->subtype == task_subtype_gradient ||
+               t->subtype == task_subtype_force ||
+               t->subtype == task_subtype_limiter)
+        cost = 1.f * (wscale * count_i) * count_i;
+      else if (t->subtype == task_subtype_rt_inject) {
+        cost = 1.f * wscale * scount_i * count_i;
+      } else
+        error("Untreated sub-type for selfs: %s",
+              subtaskID_names[t->subtype]);
+      break;
 
-    switch (t->type) {
-      case task_type_sort:
-        cost = wscale * intrinsics_popcount(t->flags) * count_i *
-               (sizeof(int) * 8 - intrinsics_clz(t->ci->hydro.count));
-        break;
+    case task_type_pair:
+      if (t->subtype == task_subtype_grav) {
+        if (t->ci->nodeID != nodeID || t->cj->nodeID != nodeID)
+          cost = 3.f * (wscale * gcount_i) * gcount_j;
+        else
+          cost = 2.f * (wscale * gcount_i) * gcount_j;
+
+      } else if (t->subtype == task_subtype_stars_density ||
+                 t->subtype == task_subtype_stars_feedback) {
+        if (t->ci->nodeID != nodeID)
+          cost = 3.f * wscale * count_i * scount_j * sid_scale[t->flags];
+        else if (t->cj->nodeID != nodeID)
+          cost = 3.f * wscale * scount_i * count_j * sid_scale[t->flags];
+        else
+          cost = 2.f * wscale * (scount_i * count_j + scount_j * count_i) *
+                 sid_scale[t->flags];
+
+      } else if (t->subtype == task_subtype_sink_compute_formation) {
+        if (t->ci->nodeID != nodeID)
+          cost = 3.f * wscale * count_i * sink_count_j * sid_scale[t->flags];
+        else if (t->cj->nodeID != nodeID)
+          cost = 3.f * wscale * sink_count_i * count_j * sid_scale[t->flags];
+        else
+          cost = 2.f * wscale *
+                 (sink_count_i * count_j + sink_count_j * count_i) *
+                 sid_scale[t->flags];
 
-      case task_type_stars_sort:
-        cost = wscale * intrinsics_popcount(t->flags) * scount_i *
-               (sizeof(int) * 8 - intrinsics_clz(t->ci->stars.count));
-        break;
+      } else if (t->subtype == task_subtype_bh_density ||
+                 t->subtype == task_subtype_bh_swallow ||
+                 t->subtype == task_subtype_bh_feedback) {
+        if (t->ci->nodeID != nodeID)
+          cost = 3.f * wscale * count_i * bcount_j * sid_scale[t->flags];
+        else if (t->cj->nodeID != nodeID)
+          cost = 3.f * wscale * bcount_i * count_j * sid_scale[t->flags];
+        else
+          cost = 2.f * wscale * (bcount_i * count_j + bcount_j * count_i) *
+                 sid_scale[t->flags];
 
-      case task_type_stars_resort:
-        cost = wscale * intrinsics_popcount(t->flags) * scount_i *
-               (sizeof(int) * 8 - intrinsics_clz(t->ci->stars.count));
-        break;
+      } else if (t->subtype == task_subtype_do_gas_swallow) {
+        cost = 1.f * wscale * (count_i + count_j);
 
-      case task_type_self:
-        if (t->subtype == task_subtype_grav) {
-          cost = 1.f * (wscale * gcount_i) * gcount_i;
-        } else if (t->subtype == task_subtype_external_grav)
-          cost = 1.f * wscale * gcount_i;
-        else if (t->subtype == task_subtype_stars_density ||
-                 t->subtype == task_subtype_stars_feedback)
-          cost = 1.f * wscale * scount_i * count_i;
-        else if (t->subtype == task_subtype_sink_compute_formation)
-          cost = 1.f * wscale * count_i * sink_count_i;
-        else if (t->subtype == task_subtype_bh_density ||
-                 t->subtype == task_subtype_bh_swallow ||
-                 t->subtype == task_subtype_bh_feedback)
-          cost = 1.f * wscale * bcount_i * count_i;
-        else if (t->subtype == task_subtype_do_gas_swallow)
-          cost = 1.f * wscale * count_i;
-        else if (t->subtype == task_subtype_do_bh_swallow)
-          cost = 1.f * wscale * bcount_i;
-        else if (t->subtype == task_subtype_density ||
+      } else if (t->subtype == task_subtype_do_bh_swallow) {
+        cost = 1.f * wscale * (bcount_i + bcount_j);
+
+      } else if (t->subtype == task_subtype_density ||
                  t->subtype == task_subtype_gradient ||
                  t->subtype == task_subtype_force ||
-                 t->subtype == task_subtype_limiter)
-          cost = 1.f * (wscale * count_i) * count_i;
-        else if (t->subtype == task_subtype_rt_inject) {
-          cost = 1.f * wscale * scount_i * count_i;
-        } else
-          error("Untreated sub-type for selfs: %s",
-                subtaskID_names[t->subtype]);
-        break;
+                 t->subtype == task_subtype_limiter) {
+        if (t->ci->nodeID != nodeID || t->cj->nodeID != nodeID)
+          cost = 3.f * (wscale * count_i) * count_j * sid_scale[t->flags];
+        else
+          cost = 2.f * (wscale * count_i) * count_j * sid_scale[t->flags];
 
-      case task_type_pair:
-        if (t->subtype == task_subtype_grav) {
-          if (t->ci->nodeID != nodeID || t->cj->nodeID != nodeID)
-            cost = 3.f * (wscale * gcount_i) * gcount_j;
-          else
-            cost = 2.f * (wscale * gcount_i) * gcount_j;
-
-        } else if (t->subtype == task_subtype_stars_density ||
-                   t->subtype == task_subtype_stars_feedback) {
-          if (t->ci->nodeID != nodeID)
-            cost = 3.f * wscale * count_i * scount_j * sid_scale[t->flags];
-          else if (t->cj->nodeID != nodeID)
-            cost = 3.f * wscale * scount_i * count_j * sid_scale[t->flags];
-          else
-            cost = 2.f * wscale * (scount_i * count_j + scount_j * count_i) *
-                   sid_scale[t->flags];
-
-        } else if (t->subtype == task_subtype_sink_compute_formation) {
-          if (t->ci->nodeID != nodeID)
-            cost = 3.f * wscale * count_i * sink_count_j * sid_scale[t->flags];
-          else if (t->cj->nodeID != nodeID)
-            cost = 3.f * wscale * sink_count_i * count_j * sid_scale[t->flags];
-          else
-            cost = 2.f * wscale *
-                   (sink_count_i * count_j + sink_count_j * count_i) *
-                   sid_scale[t->flags];
-
-        } else if (t->subtype == task_subtype_bh_density ||
-                   t->subtype == task_subtype_bh_swallow ||
-                   t->subtype == task_subtype_bh_feedback) {
-          if (t->ci->nodeID != nodeID)
-            cost = 3.f * wscale * count_i * bcount_j * sid_scale[t->flags];
-          else if (t->cj->nodeID != nodeID)
-            cost = 3.f * wscale * bcount_i * count_j * sid_scale[t->flags];
-          else
-            cost = 2.f * wscale * (bcount_i * count_j + bcount_j * count_i) *
-                   sid_scale[t->flags];
+      } else if (t->subtype == task_subtype_rt_inject) {
+        cost = 1.f * wscale * scount_i * count_j;
+      } else {
+        error("Untreated sub-type for pairs: %s",
+              subtaskID_names[t->subtype]);
+      }
+      break;
+
+    case task_type_sub_pair:
+#ifdef SWIFT_DEBUG_CHECKS
+      if (t->flags < 0) error("Negative flag value!");
+#endif
+      if (t->subtype == task_subtype_stars_density ||
+          t->subtype == task_subtype_stars_feedback) {
+        if (t->ci->nodeID != nodeID) {
+          cost = 3.f * (wscale * count_i) * scount_j * sid_scale[t->flags];
+        } else if (t->cj->nodeID != nodeID) {
+          cost = 3.f * (wscale * scount_i) * count_j * sid_scale[t->flags];
+        } else {
+          cost = 2.f * wscale * (scount_i * count_j + scount_j * count_i) *
+                 sid_scale[t->flags];
+        }
 
-        } else if (t->subtype == task_subtype_do_gas_swallow) {
-          cost = 1.f * wscale * (count_i + count_j);
+      } else if (t->subtype == task_subtype_sink_compute_formation) {
+        if (t->ci->nodeID != nodeID) {
+          cost =
+              3.f * (wscale * count_i) * sink_count_j * sid_scale[t->flags];
+        } else if (t->cj->nodeID != nodeID) {
+          cost =
+              3.f * (wscale * sink_count_i) * count_j * sid_scale[t->flags];
+        } else {
+          cost = 2.f * wscale *
+                 (sink_count_i * count_j + sink_count_j * count_i) *
+                 sid_scale[t->flags];
+        }
+      } else if (t->subtype == task_subtype_bh_density ||
+                 t->subtype == task_subtype_bh_swallow ||
+                 t->subtype == task_subtype_bh_feedback) {
+        if (t->ci->nodeID != nodeID) {
+          cost = 3.f * (wscale * count_i) * bcount_j * sid_scale[t->flags];
+        } else if (t->cj->nodeID != nodeID) {
+          cost = 3.f * (wscale * bcount_i) * count_j * sid_scale[t->flags];
+        } else {
+          cost = 2.f * wscale * (bcount_i * count_j + bcount_j * count_i) *
+                 sid_scale[t->flags];
+        }
 
-        } else if (t->subtype == task_subtype_do_bh_swallow) {
-          cost = 1.f * wscale * (bcount_i + bcount_j);
+      } else if (t->subtype == task_subtype_do_gas_swallow) {
+        cost = 1.f * wscale * (count_i + count_j);
 
-        } else if (t->subtype == task_subtype_density ||
-                   t->subtype == task_subtype_gradient ||
-                   t->subtype == task_subtype_force ||
-                   t->subtype == task_subtype_limiter) {
-          if (t->ci->nodeID != nodeID || t->cj->nodeID != nodeID)
-            cost = 3.f * (wscale * count_i) * count_j * sid_scale[t->flags];
-          else
-            cost = 2.f * (wscale * count_i) * count_j * sid_scale[t->flags];
+      } else if (t->subtype == task_subtype_do_bh_swallow) {
+        cost = 1.f * wscale * (bcount_i + bcount_j);
 
-        } else if (t->subtype == task_subtype_rt_inject) {
-          cost = 1.f * wscale * scount_i * count_j;
+      } else if (t->subtype == task_subtype_density ||
+                 t->subtype == task_subtype_gradient ||
+                 t->subtype == task_subtype_force ||
+                 t->subtype == task_subtype_limiter) {
+        if (t->ci->nodeID != nodeID || t->cj->nodeID != nodeID) {
+          cost = 3.f * (wscale * count_i) * count_j * sid_scale[t->flags];
         } else {
-          error("Untreated sub-type for pairs: %s",
-                subtaskID_names[t->subtype]);
+          cost = 2.f * (wscale * count_i) * count_j * sid_scale[t->flags];
         }
-        break;
+      } else if (t->subtype == task_subtype_rt_inject) {
+        cost = 1.f * wscale * scount_i * count_j;
+      } else {
+        error("Untreated sub-type for sub-pairs: %s",
+              subtaskID_names[t->subtype]);
+      }
+      break;
 
-      case task_type_sub_pair:
-#ifdef SWIFT_DEBUG_CHECKS
-        if (t->flags < 0) error("Negative flag value!");
-#endif
-        if (t->subtype == task_subtype_stars_density ||
-            t->subtype == task_subtype_stars_feedback) {
-          if (t->ci->nodeID != nodeID) {
-            cost = 3.f * (wscale * count_i) * scount_j * sid_scale[t->flags];
-          } else if (t->cj->nodeID != nodeID) {
-            cost = 3.f * (wscale * scount_i) * count_j * sid_scale[t->flags];
-          } else {
-            cost = 2.f * wscale * (scount_i * count_j + scount_j * count_i) *
-                   sid_scale[t->flags];
-          }
+    case task_type_sub_self:
+      if (t->subtype == task_subtype_stars_density ||
+          t->subtype == task_subtype_stars_feedback) {
+        cost = 1.f * (wscale * scount_i) * count_i;
+      } else if (t->subtype == task_subtype_sink_compute_formation) {
+        cost = 1.f * (wscale * sink_count_i) * count_i;
+      } else if (t->subtype == task_subtype_bh_density ||
+                 t->subtype == task_subtype_bh_swallow ||
+                 t->subtype == task_subtype_bh_feedback) {
+        cost = 1.f * (wscale * bcount_i) * count_i;
+      } else if (t->subtype == task_subtype_do_gas_swallow) {
+        cost = 1.f * wscale * count_i;
+      } else if (t->subtype == task_subtype_do_bh_swallow) {
+        cost = 1.f * wscale * bcount_i;
+      } else if (t->subtype == task_subtype_density ||
+                 t->subtype == task_subtype_gradient ||
+                 t->subtype == task_subtype_force ||
+                 t->subtype == task_subtype_limiter) {
+        cost = 1.f * (wscale * count_i) * count_i;
+      } else if (t->subtype == task_subtype_rt_inject) {
+        cost = 1.f * wscale * scount_i * count_i;
+      } else {
+        error("Untreated sub-type for sub-selfs: %s",
+              subtaskID_names[t->subtype]);
+      }
+      break;
+    case task_type_ghost:
+      if (t->ci == t->ci->hydro.super) cost = wscale * count_i;
+      break;
+    case task_type_extra_ghost:
+      if (t->ci == t->ci->hydro.super) cost = wscale * count_i;
+      break;
+    case task_type_stars_ghost:
+      if (t->ci == t->ci->hydro.super) cost = wscale * scount_i;
+      break;
+    case task_type_bh_density_ghost:
+      if (t->ci == t->ci->hydro.super) cost = wscale * bcount_i;
+      break;
+    case task_type_bh_swallow_ghost2:
+      if (t->ci == t->ci->hydro.super) cost = wscale * bcount_i;
+      break;
+    case task_type_drift_part:
+      cost = wscale * count_i;
+      break;
+    case task_type_drift_gpart:
+      cost = wscale * gcount_i;
+      break;
+    case task_type_drift_spart:
+      cost = wscale * scount_i;
+      break;
+    case task_type_drift_sink:
+      cost = wscale * sink_count_i;
+      break;
+    case task_type_drift_bpart:
+      cost = wscale * bcount_i;
+      break;
+    case task_type_init_grav:
+      cost = wscale * gcount_i;
+      break;
+    case task_type_grav_down:
+      cost = wscale * gcount_i;
+      break;
+    case task_type_grav_long_range:
+      cost = wscale * gcount_i;
+      break;
+    case task_type_grav_mm:
+      cost = wscale * (gcount_i + gcount_j);
+      break;
+    case task_type_end_hydro_force:
+      cost = wscale * count_i;
+      break;
+    case task_type_end_grav_force:
+      cost = wscale * gcount_i;
+      break;
+    case task_type_cooling:
+      cost = wscale * count_i;
+      break;
+    case task_type_star_formation:
+      cost = wscale * (count_i + scount_i);
+      break;
+    case task_type_sink_formation:
+      cost = wscale * (count_i + sink_count_i);
+      break;
+    case task_type_rt_ghost1:
+      cost = wscale * count_i;
+      break;
+    case task_type_kick1:
+      cost =
+          wscale * (count_i + gcount_i + scount_i + sink_count_i + bcount_i);
+      break;
+    case task_type_kick2:
+      cost =
+          wscale * (count_i + gcount_i + scount_i + sink_count_i + bcount_i);
+      break;
+    case task_type_timestep:
+      cost =
+          wscale * (count_i + gcount_i + scount_i + sink_count_i + bcount_i);
+      break;
+    case task_type_timestep_limiter:
+      cost = wscale * count_i;
+      break;
+    case task_type_timestep_sync:
+      cost = wscale * count_i;
+      break;
+    case task_type_send:
+      if (count_i < 1e5)
+        cost = 10.f * (wscale * count_i) * count_i;
+      else
+        cost = 2e9;
+      break;
+    case task_type_recv:
+      if (count_i < 1e5)
+        cost = 5.f * (wscale * count_i) * count_i;
+      else
+        cost = 1e9;
+      break;
+    default:
+      cost = 0;
+      break;
+  }
 
-        } else if (t->subtype == task_subtype_sink_compute_formation) {
-          if (t->ci->nodeID != nodeID) {
-            cost =
-                3.f * (wscale * count_i) * sink_count_j * sid_scale[t->flags];
-          } else if (t->cj->nodeID != nodeID) {
-            cost =
-                3.f * (wscale * sink_count_i) * count_j * sid_scale[t->flags];
-          } else {
-            cost = 2.f * wscale *
-                   (sink_count_i * count_j + sink_count_j * count_i) *
-                   sid_scale[t->flags];
-          }
-        } else if (t->subtype == task_subtype_bh_density ||
-                   t->subtype == task_subtype_bh_swallow ||
-                   t->subtype == task_subtype_bh_feedback) {
-          if (t->ci->nodeID != nodeID) {
-            cost = 3.f * (wscale * count_i) * bcount_j * sid_scale[t->flags];
-          } else if (t->cj->nodeID != nodeID) {
-            cost = 3.f * (wscale * bcount_i) * count_j * sid_scale[t->flags];
-          } else {
-            cost = 2.f * wscale * (bcount_i * count_j + bcount_j * count_i) *
-                   sid_scale[t->flags];
-          }
+  return cost;
+}
 
-        } else if (t->subtype == task_subtype_do_gas_swallow) {
-          cost = 1.f * wscale * (count_i + count_j);
+/**
+ * @brief Bin of particle count of a task used to store its measured cost.
+ *
+ * Each bin covers a factor of 4 in the total number of particles of all
+ * types in the cells of the task.
+ *
+ * @param t The #task.
+ */
+static int scheduler_cost_bin(const struct task *t) {
+
+  long long count = 0;
+  if (t->ci != NULL)
+    count += t->ci->hydro.count + t->ci->grav.count + t->ci->stars.count +
+             t->ci->sinks.count + t->ci->black_holes.count;
+  if (t->cj != NULL)
+    count += t->cj->hydro.count + t->cj->grav.count + t->cj->stars.count +
+             t->cj->sinks.count + t->cj->black_holes.count;
+
+  int bin = 0;
+  while (count > 1 && bin < scheduler_cost_nr_bins - 1) {
+    count >>= 2;
+    bin++;
+  }
+  return bin;
+}
 
-        } else if (t->subtype == task_subtype_do_bh_swallow) {
-          cost = 1.f * wscale * (bcount_i + bcount_j);
+/**
+ * @brief Cost of a task, in ticks if it has been measured in previous steps.
+ *
+ * The cost model is re-scaled by the moving average of the ticks per unit
+ * of modelled cost measured for the same type, sub-type and count bin. If
+ * nothing was measured for this kind of task, the average over all tasks is
+ * used instead such that all the costs remain in the same units.
+ *
+ * @param s The #scheduler.
+ * @param t The #task.
+ */
+static float scheduler_task_cost(const struct scheduler *s,
+                                 const struct task *t) {
 
-        } else if (t->subtype == task_subtype_density ||
-                   t->subtype == task_subtype_gradient ||
-                   t->subtype == task_subtype_force ||
-                   t->subtype == task_subtype_limiter) {
-          if (t->ci->nodeID != nodeID || t->cj->nodeID != nodeID) {
-            cost = 3.f * (wscale * count_i) * count_j * sid_scale[t->flags];
-          } else {
-            cost = 2.f * (wscale * count_i) * count_j * sid_scale[t->flags];
-          }
-        } else if (t->subtype == task_subtype_rt_inject) {
-          cost = 1.f * wscale * scount_i * count_j;
-        } else {
-          error("Untreated sub-type for sub-pairs: %s",
-                subtaskID_names[t->subtype]);
-        }
-        break;
+  const float cost = scheduler_task_model_cost(t, s->nodeID);
+  if (cost == 0.f || s->costs.ticks_per_cost_all == 0.f) return cost;
 
-      case task_type_sub_self:
-        if (t->subtype == task_subtype_stars_density ||
-            t->subtype == task_subtype_stars_feedback) {
-          cost = 1.f * (wscale * scount_i) * count_i;
-        } else if (t->subtype == task_subtype_sink_compute_formation) {
-          cost = 1.f * (wscale * sink_count_i) * count_i;
-        } else if (t->subtype == task_subtype_bh_density ||
-                   t->subtype == task_subtype_bh_swallow ||
-                   t->subtype == task_subtype_bh_feedback) {
-          cost = 1.f * (wscale * bcount_i) * count_i;
-        } else if (t->subtype == task_subtype_do_gas_swallow) {
-          cost = 1.f * wscale * count_i;
-        } else if (t->subtype == task_subtype_do_bh_swallow) {
-          cost = 1.f * wscale * bcount_i;
-        } else if (t->subtype == task_subtype_density ||
-                   t->subtype == task_subtype_gradient ||
-                   t->subtype == task_subtype_force ||
-                   t->subtype == task_subtype_limiter) {
-          cost = 1.f * (wscale * count_i) * count_i;
-        } else if (t->subtype == task_subtype_rt_inject) {
-          cost = 1.f * wscale * scount_i * count_i;
-        } else {
-          error("Untreated sub-type for sub-selfs: %s",
-                subtaskID_names[t->subtype]);
-        }
-        break;
-      case task_type_ghost:
-        if (t->ci == t->ci->hydro.super) cost = wscale * count_i;
-        break;
-      case task_type_extra_ghost:
-        if (t->ci == t->ci->hydro.super) cost = wscale * count_i;
-        break;
-      case task_type_stars_ghost:
-        if (t->ci == t->ci->hydro.super) cost = wscale * scount_i;
-        break;
-      case task_type_bh_density_ghost:
-        if (t->ci == t->ci->hydro.super) cost = wscale * bcount_i;
-        break;
-      case task_type_bh_swallow_ghost2:
-        if (t->ci == t->ci->hydro.super) cost = wscale * bcount_i;
-        break;
-      case task_type_drift_part:
-        cost = wscale * count_i;
-        break;
-      case task_type_drift_gpart:
-        cost = wscale * gcount_i;
-        break;
-      case task_type_drift_spart:
-        cost = wscale * scount_i;
-        break;
-      case task_type_drift_sink:
-        cost = wscale * sink_count_i;
-        break;
-      case task_type_drift_bpart:
-        cost = wscale * bcount_i;
-        break;
-      case task_type_init_grav:
-        cost = wscale * gcount_i;
-        break;
-      case task_type_grav_down:
-        cost = wscale * gcount_i;
-        break;
-      case task_type_grav_long_range:
-        cost = wscale * gcount_i;
-        break;
-      case task_type_grav_mm:
-        cost = wscale * (gcount_i + gcount_j);
-        break;
-      case task_type_end_hydro_force:
-        cost = wscale * count_i;
-        break;
-      case task_type_end_grav_force:
-        cost = wscale * gcount_i;
-        break;
-      case task_type_cooling:
-        cost = wscale * count_i;
-        break;
-      case task_type_star_formation:
-        cost = wscale * (count_i + scount_i);
-        break;
-      case task_type_sink_formation:
-        cost = wscale * (count_i + sink_count_i);
-        break;
-      case task_type_rt_ghost1:
-        cost = wscale * count_i;
-        break;
-      case task_type_kick1:
-        cost =
-            wscale * (count_i + gcount_i + scount_i + sink_count_i + bcount_i);
-        break;
-      case task_type_kick2:
-        cost =
-            wscale * (count_i + gcount_i + scount_i + sink_count_i + bcount_i);
-        break;
-      case task_type_timestep:
-        cost =
-            wscale * (count_i + gcount_i + scount_i + sink_count_i + bcount_i);
-        break;
-      case task_type_timestep_limiter:
-        cost = wscale * count_i;
-        break;
-      case task_type_timestep_sync:
-        cost = wscale * count_i;
-        break;
-      case task_type_send:
-        if (count_i < 1e5)
-          cost = 10.f * (wscale * count_i) * count_i;
-        else
-          cost = 2e9;
-        break;
-      case task_type_recv:
-        if (count_i < 1e5)
-          cost = 5.f * (wscale * count_i) * count_i;
-        else
-          cost = 1e9;
-        break;
-      default:
-        cost = 0;
-        break;
-    }
-    t->weight += cost;
+  const float ticks_per_cost =
+      s->costs.ticks_per_cost[t->type][t->subtype][scheduler_cost_bin(t)];
+
+  if (ticks_per_cost > 0.f)
+    return cost * ticks_per_cost;
+  else
+    return cost * s->costs.ticks_per_cost_all;
+}
+
+/**
+ * @brief Compute the task weights
+ *
+ * The weight of a task is the cost of the most expensive chain of tasks
+ * starting with it, i.e. its position on the critical path.
+ *
+ * @param s The #scheduler.
+ * @param verbose Are we talkative?
+ */
+void scheduler_reweight(struct scheduler *s, int verbose) {
+  const int nr_tasks = s->nr_tasks;
+  int *tid = s->tasks_ind;
+  struct task *tasks = s->tasks;
+  const ticks tic = getticks();
+
+  /* Run through the tasks backwards and set their weights. */
+  for (int k = nr_tasks - 1; k >= 0; k--) {
+    struct task *t = &tasks[tid[k]];
+    t->weight = 0.f;
+
+    for (int j = 0; j < t->nr_unlock_tasks; j++)
+      if (t->unlock_tasks[j]->weight > t->weight)
+        t->weight = t->unlock_tasks[j]->weight;
+
+    t->weight += scheduler_task_cost(s, t);
   }
 
+  /* The lock-free queues bucket the weights relative to the largest one. */
+  float weight_max = 0.f;
+  for (int k = 0; k < nr_tasks; k++)
+    if (tasks[k].weight > weight_max) weight_max = tasks[k].weight;
+  for (int k = 0; k < s->nr_queues; k++) s->queues[k].weight_max = weight_max;
+
   if (verbose)
     message("took %.3f %s.", clocks_from_ticks(getticks() - tic),
             clocks_getunit());
@@ -1668,6 +1748,102 @@ void scheduler_reweight(struct scheduler *s, int verbose) {
   message( "task weights are in [ %i , %i ]." , min , max ); */
 }
 
+/*! Data passed to scheduler_update_costs_mapper() */
+struct scheduler_update_costs_data {
+
+  /*! The #scheduler */
+  const struct scheduler *s;
+
+  /*! The time at which the step was launched */
+  ticks tic_start;
+};
+
+/**
+ * @brief Accumulate the measured and modelled costs of the tasks run in
+ * the last step.
+ *        Threadpool mapper function.
+ *
+ * @param map_data Pointer to the tasks.
+ * @param num_elements The number of tasks to treat.
+ * @param extra_data Pointer to a #scheduler_update_costs_data.
+ */
+static void scheduler_update_costs_mapper(void *map_data, int num_elements,
+                                          void *extra_data) {
+
+  struct task *tasks = (struct task *)map_data;
+  const struct scheduler_update_costs_data *data =
+      (const struct scheduler_update_costs_data *)extra_data;
+  const struct scheduler *s = data->s;
+  const ticks tic_start = data->tic_start;
+
+  for (int i = 0; i < num_elements; i++) {
+    const struct task *t = &tasks[i];
+
+    /* Only consider the tasks that actually ran in this step */
+    if (t->implicit || t->tic < tic_start || t->toc < t->tic) continue;
+
+    const float cost = scheduler_task_model_cost(t, s->nodeID);
+    if (cost <= 0.f) continue;
+
+    const size_t ind =
+        ((size_t)t->type * task_subtype_count + t->subtype) *
+            scheduler_cost_nr_bins +
+        scheduler_cost_bin(t);
+    atomic_add_f(&s->step_ticks[ind], (float)(t->toc - t->tic));
+    atomic_add_f(&s->step_costs[ind], cost);
+  }
+}
+
+/**
+ * @brief Update the moving averages of the measured cost of the tasks with
+ * the tasks that ran in the last step.
+ *
+ * The averages are used in scheduler_reweight() the next time the graph is
+ * weighted.
+ *
+ * @param s The #scheduler.
+ * @param tic_start The time at which the step was launched.
+ */
+void scheduler_update_costs(struct scheduler *s, const ticks tic_start) {
+
+  struct scheduler_costs *costs = &s->costs;
+  const float alpha = costs->alpha;
+  if (alpha <= 0.f || s->nr_tasks == 0) return;
+
+  struct scheduler_update_costs_data data = {s, tic_start};
+  threadpool_map(s->threadpool, scheduler_update_costs_mapper, s->tasks,
+                 s->nr_tasks, sizeof(struct task), threadpool_auto_chunk_size,
+                 &data);
+
+  float *ticks_per_cost = &costs->ticks_per_cost[0][0][0];
+  const size_t size =
+      (size_t)task_type_count * task_subtype_count * scheduler_cost_nr_bins;
+  double total_ticks = 0., total_cost = 0.;
+  for (size_t ind = 0; ind < size; ind++) {
+    if (s->step_costs[ind] > 0.f) {
+      const float measured = s->step_ticks[ind] / s->step_costs[ind];
+      if (ticks_per_cost[ind] > 0.f)
+        ticks_per_cost[ind] += alpha * (measured - ticks_per_cost[ind]);
+      else
+        ticks_per_cost[ind] = measured;
+
+      total_ticks += s->step_ticks[ind];
+      total_cost += s->step_costs[ind];
+      s->step_ticks[ind] = 0.f;
+      s->step_costs[ind] = 0.f;
+    }
+  }
+
+  if (total_cost > 0.) {
+    const float measured = total_ticks / total_cost;
+    if (costs->ticks_per_cost_all > 0.f)
+      costs->ticks_per_cost_all +=
+          alpha * (measured - costs->ticks_per_cost_all);
+    else
+      costs->ticks_per_cost_all = measured;
+  }
+}
+
 /**
  * @brief #threadpool_map function which runs through the task
  *        graph and re-computes the task wait counters.
@@ -1748,6 +1924,61 @@ void scheduler_start(struct scheduler *s) {
   pthread_mutex_unlock(&s->sleep_mutex);
 }
 
+/**
+ * @brief Wake up one runner to deal with a task just added to a queue
+ * (lock-free mode).
+ *
+ * Runners sleeping on the queue itself are preferred, then runners sleeping
+ * on a queue on the same NUMA node, then any sleeping runner.
+ *
+ * @param s The #scheduler.
+ * @param qid The ID of the #queue that received a task.
+ */
+static void scheduler_wakeup_queue(struct scheduler *s, const int qid) {
+
+  /* Nobody to wake up? */
+  if (s->nr_sleeping == 0) return;
+
+  const int nr_queues = s->nr_queues;
+  const int numa_node = s->queues[qid].numa_node;
+  struct queue *q = &s->queues[qid];
+
+  if (q->nr_sleeping == 0) {
+    q = NULL;
+    for (int pass = 0; pass < 2 && q == NULL; pass++) {
+      for (int k = 1; k < nr_queues; k++) {
+        struct queue *other = &s->queues[(qid + k) % nr_queues];
+        if (other->nr_sleeping > 0 &&
+            (pass == 1 || other->numa_node == numa_node)) {
+          q = other;
+          break;
+        }
+      }
+    }
+    if (q == NULL) return;
+  }
+
+  pthread_mutex_lock(&q->sleep_mutex);
+  pthread_cond_signal(&q->sleep_cond);
+  pthread_mutex_unlock(&q->sleep_mutex);
+}
+
+/**
+ * @brief Wake up all the runners sleeping on any queue (lock-free mode).
+ *
+ * @param s The #scheduler.
+ */
+static void scheduler_wakeup_all(struct scheduler *s) {
+
+  for (int k = 0; k < s->nr_queues; k++) {
+    struct queue *q = &s->queues[k];
+    if (q->nr_sleeping == 0) continue;
+    pthread_mutex_lock(&q->sleep_mutex);
+    pthread_cond_broadcast(&q->sleep_cond);
+    pthread_mutex_unlock(&q->sleep_mutex);
+  }
+}
+
 /**
  * @brief Put a task on one of the queues.
  *
@@ -1914,6 +2145,10 @@ void scheduler_enqueue(struct scheduler *s, struct task *t) {
         /* And log, if logging enabled. */
         mpiuse_log_allocation(t->type, t->subtype, &t->req, 1, size,
                               t->ci->nodeID, t->flags);
+#ifdef SWIFT_MPIUSE_REPORTS
+        t->mpi_size = size;
+        t->mpi_tic = getticks();
+#endif
 
         qid = 1 % s->nr_queues;
       }
@@ -2038,6 +2273,10 @@ void scheduler_enqueue(struct scheduler *s, struct task *t) {
         /* And log, if logging enabled. */
         mpiuse_log_allocation(t->type, t->subtype, &t->req, 1, size,
                               t->cj->nodeID, t->flags);
+#ifdef SWIFT_MPIUSE_REPORTS
+        t->mpi_size = size;
+        t->mpi_tic = getticks();
+#endif
 
         qid = 0;
       }
@@ -2060,6 +2299,9 @@ void scheduler_enqueue(struct scheduler *s, struct task *t) {
 
     /* Insert the task into that queue. */
     queue_insert(&s->queues[qid], t);
+
+    /* Make sure someone is awake to run it. */
+    if (s->flags & scheduler_flag_lockfree) scheduler_wakeup_queue(s, qid);
   }
 }
 
@@ -2094,10 +2336,14 @@ struct task *scheduler_done(struct scheduler *s, struct task *t) {
   if (!t->implicit) {
     t->toc = getticks();
     t->total_ticks += t->toc - t->tic;
-    pthread_mutex_lock(&s->sleep_mutex);
-    atomic_dec(&s->waiting);
-    pthread_cond_broadcast(&s->sleep_cond);
-    pthread_mutex_unlock(&s->sleep_mutex);
+    if (s->flags & scheduler_flag_lockfree) {
+      if (atomic_dec(&s->waiting) == 1) scheduler_wakeup_all(s);
+    } else {
+      pthread_mutex_lock(&s->sleep_mutex);
+      atomic_dec(&s->waiting);
+      pthread_cond_broadcast(&s->sleep_cond);
+      pthread_mutex_unlock(&s->sleep_mutex);
+    }
   }
 
   /* Mark the task as skip. */
@@ -2135,10 +2381,14 @@ struct task *scheduler_unlock(struct scheduler *s, struct task *t) {
   if (!t->implicit) {
     t->toc = getticks();
     t->total_ticks += t->toc - t->tic;
-    pthread_mutex_lock(&s->sleep_mutex);
-    atomic_dec(&s->waiting);
-    pthread_cond_broadcast(&s->sleep_cond);
-    pthread_mutex_unlock(&s->sleep_mutex);
+    if (s->flags & scheduler_flag_lockfree) {
+      if (atomic_dec(&s->waiting) == 1) scheduler_wakeup_all(s);
+    } else {
+      pthread_mutex_lock(&s->sleep_mutex);
+      atomic_dec(&s->waiting);
+      pthread_cond_broadcast(&s->sleep_cond);
+      pthread_mutex_unlock(&s->sleep_mutex);
+    }
   }
 
   /* Return the next best task. Note that we currently do not
@@ -2147,6 +2397,103 @@ struct task *scheduler_unlock(struct scheduler *s, struct task *t) {
   return NULL;
 }
 
+/**
+ * @brief Get a task, preferably from the given queue, using the lock-free
+ * deques.
+ *
+ * Stealing is lock-free and tries the queues on the same NUMA node as the
+ * given one first. Idle runners sleep on their own queue rather than on a
+ * global condition.
+ *
+ * @param s The #scheduler.
+ * @param qid The ID of the preferred #queue.
+ * @param prev the previous task that was run.
+ *
+ * @return A pointer to a #task or @c NULL if there are no available tasks.
+ */
+static struct task *scheduler_gettask_lockfree(struct scheduler *s, int qid,
+                                               const struct task *prev) {
+  struct task *res = NULL;
+  const int nr_queues = s->nr_queues;
+  struct queue *q = &s->queues[qid];
+  unsigned int seed = qid;
+
+  /* Loop as long as there are tasks... */
+  while (s->waiting > 0 && res == NULL) {
+    /* Try more than once before sleeping. */
+    for (int tries = 0; res == NULL && s->waiting && tries < scheduler_maxtries;
+         tries++) {
+      /* Try to get a task from the suggested queue. */
+      if (q->count > 0 || q->count_incoming > 0) {
+        TIMER_TIC
+        res = queue_gettask(q, prev, 0);
+        TIMER_TOC(timer_qget);
+        if (res != NULL) break;
+      }
+
+      /* If unsuccessful, try stealing from the other queues, NUMA-local
+       * ones first. */
+      if (s->flags & scheduler_flag_steal) {
+        int count_local = 0, count_remote = 0, qids[nr_queues];
+        for (int k = 0; k < nr_queues; k++) {
+          const struct queue *other = &s->queues[k];
+          if (k == qid || (other->count == 0 && other->count_incoming == 0))
+            continue;
+          if (other->numa_node == q->numa_node)
+            qids[count_local++] = k;
+          else
+            qids[nr_queues - 1 - count_remote++] = k;
+        }
+        for (int k = 0; k < scheduler_maxsteal; k++) {
+          int ind;
+          if (count_local > 0)
+            ind = rand_r(&seed) % count_local;
+          else if (count_remote > 0)
+            ind = nr_queues - 1 - rand_r(&seed) % count_remote;
+          else
+            break;
+          TIMER_TIC
+          res = queue_steal(&s->queues[qids[ind]], prev);
+          TIMER_TOC(timer_qsteal);
+          if (res != NULL) break;
+          if (count_local > 0)
+            qids[ind] = qids[--count_local];
+          else
+            qids[ind] = qids[nr_queues - count_remote--];
+        }
+        if (res != NULL) break;
+      }
+    }
+
+/* If we failed, take a short nap on our own queue. */
+#ifdef WITH_MPI
+    if (res == NULL && qid > 1)
+#else
+    if (res == NULL)
+#endif
+    {
+      pthread_mutex_lock(&q->sleep_mutex);
+      atomic_inc(&q->nr_sleeping);
+      atomic_inc(&s->nr_sleeping);
+      if (s->waiting > 0 && q->count == 0 && q->count_incoming == 0) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += scheduler_lockfree_nap_ns;
+        if (deadline.tv_nsec >= 1000000000) {
+          deadline.tv_sec += 1;
+          deadline.tv_nsec -= 1000000000;
+        }
+        pthread_cond_timedwait(&q->sleep_cond, &q->sleep_mutex, &deadline);
+      }
+      atomic_dec(&s->nr_sleeping);
+      atomic_dec(&q->nr_sleeping);
+      pthread_mutex_unlock(&q->sleep_mutex);
+    }
+  }
+
+  return res;
+}
+
 /**
  * @brief Get a task, preferably from the given queue.
  *
@@ -2165,6 +2512,10 @@ struct task *scheduler_gettask(struct scheduler *s, int qid,
   /* Check qid. */
   if (qid >= nr_queues || qid < 0) error("Bad queue ID.");
 
+  /* Use the lock-free deques? */
+  if (s->flags & scheduler_flag_lockfree)
+    res = scheduler_gettask_lockfree(s, qid, prev);
+
   /* Loop as long as there are tasks... */
   while (s->waiting > 0 && res == NULL) {
     /* Try more than once before sleeping. */
@@ -2250,12 +2601,14 @@ void scheduler_init(struct scheduler *s, struct space *space, int nr_tasks,
     error("Failed to allocate queues.");
 
   /* Initialize each queue. */
-  for (int k = 0; k < nr_queues; k++) queue_init(&s->queues[k], NULL);
+  for (int k = 0; k < nr_queues; k++)
+    queue_init(&s->queues[k], NULL, flags & scheduler_flag_lockfree);
 
   /* Init the sleep mutex and cond. */
   if (pthread_cond_init(&s->sleep_cond, NULL) != 0 ||
       pthread_mutex_init(&s->sleep_mutex, NULL) != 0)
     error("Failed to initialize sleep barrier.");
+  s->nr_sleeping = 0;
 
   /* Init the unlocks. */
   if ((s->unlocks = (struct task **)swift_malloc(
@@ -2267,6 +2620,13 @@ void scheduler_init(struct scheduler *s, struct space *space, int nr_tasks,
   s->nr_unlocks = 0;
   s->size_unlocks = scheduler_init_nr_unlocks;
 
+  /* Init the accumulators of measured costs. */
+  const size_t size_costs =
+      (size_t)task_type_count * task_subtype_count * scheduler_cost_nr_bins;
+  if ((s->step_ticks = (float *)calloc(size_costs, sizeof(float))) == NULL ||
+      (s->step_costs = (float *)calloc(size_costs, sizeof(float))) == NULL)
+    error("Failed to allocate task cost accumulators.");
+
   /* Set the scheduler variables. */
   s->nr_queues = nr_queues;
   s->flags = flags;
@@ -2315,6 +2675,8 @@ void scheduler_clean(struct scheduler *s) {
   swift_free("unlock_ind", s->unlock_ind);
   for (int i = 0; i < s->nr_queues; ++i) queue_clean(&s->queues[i]);
   swift_free("queues", s->queues);
+  free(s->step_ticks);
+  free(s->step_costs);
 }
 
 /**
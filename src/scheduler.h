@@ -45,6 +45,7 @@
 #define scheduler_dosub 1
 #define scheduler_maxsteal 10
 #define scheduler_maxtries 2
+#define scheduler_lockfree_nap_ns 1000000
 #define scheduler_doforcesplit            \
   0 /* Beware: switching this on can/will \
        break engine_addlink as it assumes \
@@ -53,6 +54,31 @@
 /* Flags . */
 #define scheduler_flag_none 0
 #define scheduler_flag_steal (1 << 1)
+#define scheduler_flag_lockfree (1 << 2)
+
+/* Number of particle-count bins of the measured task costs. */
+#define scheduler_cost_nr_bins 16
+
+/**
+ * @brief Measured cost of the tasks, relative to the cost model used in
+ * scheduler_reweight().
+ *
+ * This is kept across rebuilds and restarts.
+ */
+struct scheduler_costs {
+
+  /*! Moving average of the ticks per unit of modelled cost for each task
+   * type, sub-type and bin of particle count (0 if never measured) */
+  float ticks_per_cost[task_type_count][task_subtype_count]
+                      [scheduler_cost_nr_bins];
+
+  /*! Moving average of the ticks per unit of modelled cost over all tasks */
+  float ticks_per_cost_all;
+
+  /*! Weight of the latest step in the moving averages (0 to only use the
+   * cost model) */
+  float alpha;
+};
 
 /* Data of a scheduler. */
 struct scheduler {
@@ -93,6 +119,9 @@ struct scheduler {
   pthread_mutex_t sleep_mutex;
   pthread_cond_t sleep_cond;
 
+  /* Number of runners sleeping on any of the queues (lock-free mode). */
+  volatile int nr_sleeping;
+
   /* The space associated with this scheduler. */
   struct space *space;
 
@@ -111,6 +140,13 @@ struct scheduler {
 
   /* Total ticks spent running the tasks */
   ticks total_ticks;
+
+  /* Measured cost of the tasks. */
+  struct scheduler_costs costs;
+
+  /* Ticks and modelled cost of the tasks run in the current step, per type,
+   * sub-type and count bin (temporary storage, not kept over restarts). */
+  float *step_ticks, *step_costs;
 };
 
 /* Inlined functions (for speed). */
@@ -190,9 +226,12 @@ void scheduler_start(struct scheduler *s);
 void scheduler_reset(struct scheduler *s, int nr_tasks);
 void scheduler_ranktasks(struct scheduler *s);
 void scheduler_reweight(struct scheduler *s, int verbose);
+void scheduler_update_costs(struct scheduler *s, const ticks tic_start);
 struct task *scheduler_addtask(struct scheduler *s, enum task_types type,
                                enum task_subtypes subtype, int flags,
                                int implicit, struct cell *ci, struct cell *cj);
+void scheduler_splittasks_mapper(void *map_data, int num_elements,
+                                 void *extra_data);
 void scheduler_splittasks(struct scheduler *s, const int fof_tasks,
                           const int verbose);
 struct task *scheduler_done(struct scheduler *s, struct task *t);
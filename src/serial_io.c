@@ -49,6 +49,7 @@
 #include "gravity_properties.h"
 #include "hydro_io.h"
 #include "hydro_properties.h"
+#include "io_async.h"
 #include "io_properties.h"
 #include "memuse.h"
 #include "output_list.h"
@@ -240,12 +241,26 @@ void read_array_serial(hid_t grp, const struct io_props props, size_t N,
   H5Dclose(h_data);
 }
 
+/**
+ * @brief Creates an array in the snapshot.
+ *
+ * @param grp The group in which to create the array.
+ * @param fileName The name of the file in which the data is written
+ * @param xmfFile The FILE used to write the XMF description
+ * @param partTypeGroupName The name of the group containing the particles in
+ * the HDF5 file.
+ * @param props The #io_props of the field to write.
+ * @param N_total The total number of particles on all ranks.
+ * @param lossy_compression Lossy compression filter to apply.
+ * @param compression The level of GZIP compression to apply.
+ * @param a The current scale-factor.
+ * @param snapshot_units The #unit_system used in the snapshots
+ */
 void prepare_array_serial(
-    const struct engine* e, hid_t grp, char* fileName, FILE* xmfFile,
-    char* partTypeGroupName, const struct io_props props,
-    unsigned long long N_total,
+    hid_t grp, char* fileName, FILE* xmfFile, char* partTypeGroupName,
+    const struct io_props props, unsigned long long N_total,
     const enum lossy_compression_schemes lossy_compression,
-    const struct unit_system* internal_units,
+    const int compression, const double a,
     const struct unit_system* snapshot_units) {
 
   /* Create data space */
@@ -298,13 +313,13 @@ void prepare_array_serial(
     set_hdf5_lossy_compression(&h_prop, &h_type, lossy_compression, props.name);
 
   /* Impose data compression */
-  if (e->snapshot_compression > 0) {
+  if (compression > 0) {
     h_err = H5Pset_shuffle(h_prop);
     if (h_err < 0)
       error("Error while setting shuffling options for field '%s'.",
             props.name);
 
-    h_err = H5Pset_deflate(h_prop, e->snapshot_compression);
+    h_err = H5Pset_deflate(h_prop, compression);
     if (h_err < 0)
       error("Error while setting compression options for field '%s'.",
             props.name);
@@ -350,7 +365,7 @@ void prepare_array_serial(
   io_write_attribute_d(
       h_data,
       "Conversion factor to physical CGS (including cosmological corrections)",
-      factor * pow(e->cosmology->a, props.scale_factor_exponent));
+      factor * pow(a, props.scale_factor_exponent));
 
 #ifdef SWIFT_DEBUG_CHECKS
   if (strlen(props.description) == 0)
@@ -368,53 +383,18 @@ void prepare_array_serial(
 }
 
 /**
- * @brief Writes a data array in given HDF5 group.
+ * @brief Writes this rank's part of a data array already converted to the
+ * snapshot units.
  *
- * @param e The #engine we are writing from.
- * @param grp The group in which to write.
- * @param fileName The name of the file in which the data is written
- * @param xmfFile The FILE used to write the XMF description
- * @param partTypeGroupName The name of the group containing the particles in
- * the HDF5 file.
- * @param props The #io_props of the field to read
+ * @param grp The group containing the array.
+ * @param props The #io_props of the field to write.
  * @param N The number of particles to write.
- * @param N_total The total number of particles on all ranks.
  * @param offset The offset position where this rank starts writing.
- * @param lossy_compression Lossy compression filter to apply.
- * @param mpi_rank The MPI rank of this node
- * @param internal_units The #unit_system used internally
- * @param snapshot_units The #unit_system used in the snapshots
- *
- * @todo A better version using HDF5 hyper-slabs to write the file directly from
- * the part array will be written once the structures have been stabilized.
+ * @param temp The buffer containing the converted data.
  */
-void write_array_serial(const struct engine* e, hid_t grp, char* fileName,
-                        FILE* xmfFile, char* partTypeGroupName,
-                        const struct io_props props, size_t N,
-                        long long N_total, int mpi_rank, long long offset,
-                        const enum lossy_compression_schemes lossy_compression,
-                        const struct unit_system* internal_units,
-                        const struct unit_system* snapshot_units) {
-
-  const size_t typeSize = io_sizeof_type(props.type);
-  const size_t num_elements = N * props.dimension;
-
-  /* message("Writing '%s' array...", props.name); */
-
-  /* Prepare the arrays in the file */
-  if (mpi_rank == 0)
-    prepare_array_serial(e, grp, fileName, xmfFile, partTypeGroupName, props,
-                         N_total, lossy_compression, internal_units,
-                         snapshot_units);
-
-  /* Allocate temporary buffer */
-  void* temp = NULL;
-  if (swift_memalign("writebuff", (void**)&temp, IO_BUFFER_ALIGNMENT,
-                     num_elements * typeSize) != 0)
-    error("Unable to allocate temporary i/o buffer");
-
-  /* Copy the particle data to the temporary buffer */
-  io_copy_temp_buffer(temp, e, props, N, internal_units, snapshot_units);
+static void write_array_serial_buffer(hid_t grp, const struct io_props props,
+                                      size_t N, long long offset,
+                                      const void* temp) {
 
   /* Construct information for the hyper-slab */
   int rank;
@@ -459,13 +439,68 @@ void write_array_serial(const struct engine* e, hid_t grp, char* fileName,
                    H5P_DEFAULT, temp);
   if (h_err < 0) error("Error while writing data array '%s'.", props.name);
 
-  /* Free and close everything */
-  swift_free("writebuff", temp);
+  /* Close everything */
   H5Dclose(h_data);
   H5Sclose(h_memspace);
   H5Sclose(h_filespace);
 }
 
+/**
+ * @brief Writes a data array in given HDF5 group.
+ *
+ * @param e The #engine we are writing from.
+ * @param grp The group in which to write.
+ * @param fileName The name of the file in which the data is written
+ * @param xmfFile The FILE used to write the XMF description
+ * @param partTypeGroupName The name of the group containing the particles in
+ * the HDF5 file.
+ * @param props The #io_props of the field to read
+ * @param N The number of particles to write.
+ * @param N_total The total number of particles on all ranks.
+ * @param offset The offset position where this rank starts writing.
+ * @param lossy_compression Lossy compression filter to apply.
+ * @param mpi_rank The MPI rank of this node
+ * @param internal_units The #unit_system used internally
+ * @param snapshot_units The #unit_system used in the snapshots
+ *
+ * @todo A better version using HDF5 hyper-slabs to write the file directly from
+ * the part array will be written once the structures have been stabilized.
+ */
+void write_array_serial(const struct engine* e, hid_t grp, char* fileName,
+                        FILE* xmfFile, char* partTypeGroupName,
+                        const struct io_props props, size_t N,
+                        long long N_total, int mpi_rank, long long offset,
+                        const enum lossy_compression_schemes lossy_compression,
+                        const struct unit_system* internal_units,
+                        const struct unit_system* snapshot_units) {
+
+  const size_t typeSize = io_sizeof_type(props.type);
+  const size_t num_elements = N * props.dimension;
+
+  /* message("Writing '%s' array...", props.name); */
+
+  /* Prepare the arrays in the file */
+  if (mpi_rank == 0)
+    prepare_array_serial(grp, fileName, xmfFile, partTypeGroupName, props,
+                         N_total, lossy_compression, e->snapshot_compression,
+                         e->cosmology->a, snapshot_units);
+
+  /* Allocate temporary buffer */
+  void* temp = NULL;
+  if (swift_memalign("writebuff", (void**)&temp, IO_BUFFER_ALIGNMENT,
+                     num_elements * typeSize) != 0)
+    error("Unable to allocate temporary i/o buffer");
+
+  /* Copy the particle data to the temporary buffer */
+  io_copy_temp_buffer(temp, e, props, N, internal_units, snapshot_units);
+
+  /* Write it to the file */
+  write_array_serial_buffer(grp, props, N, offset, temp);
+
+  /* Free everything */
+  swift_free("writebuff", temp);
+}
+
 /**
  * @brief Reads an HDF5 initial condition file (GADGET-3 type)
  *
@@ -896,6 +931,62 @@ void read_ic_serial(char* fileName, const struct unit_system* internal_units,
   free(ic_units);
 }
 
+/**
+ * @brief Executes a job of the asynchronous snapshot writer.
+ *
+ * The ranks take turns to write their particles, passing a token over the
+ * writer's communicator once their file is closed.
+ *
+ * @param job The #io_async_job to execute.
+ * @param snap The #io_async_snapshot being written.
+ */
+static void serial_io_async_write_job(struct io_async_job* job,
+                                      struct io_async_snapshot* snap) {
+
+  switch (job->type) {
+    case io_async_file_begin:
+
+      /* Wait for the previous rank to be done */
+      if (snap->mpi_rank > 0)
+        MPI_Recv(NULL, 0, MPI_BYTE, snap->mpi_rank - 1, 0, snap->comm,
+                 MPI_STATUS_IGNORE);
+
+      snap->h_file = H5Fopen(snap->fileName, H5F_ACC_RDWR, H5P_DEFAULT);
+      if (snap->h_file < 0)
+        error("Error while opening file '%s' on rank %d.", snap->fileName,
+              snap->mpi_rank);
+      break;
+    case io_async_group_begin:
+      snap->h_grp = H5Gopen(snap->h_file, job->partTypeGroupName, H5P_DEFAULT);
+      if (snap->h_grp < 0)
+        error("Error while opening particle group %s.",
+              job->partTypeGroupName);
+      break;
+    case io_async_dataset:
+      if (snap->mpi_rank == 0)
+        prepare_array_serial(snap->h_grp, snap->fileName, /*xmfFile=*/NULL,
+                             job->partTypeGroupName, job->props, job->N_total,
+                             job->lossy_compression, snap->compression,
+                             snap->a, &snap->snapshot_units);
+      write_array_serial_buffer(snap->h_grp, job->props, job->N, job->offset,
+                                job->buffer);
+      break;
+    case io_async_group_end:
+      if (snap->mpi_rank == 0)
+        io_write_attribute_i(snap->h_grp, "NumberOfFields", job->num_fields);
+      H5Gclose(snap->h_grp);
+      break;
+    case io_async_file_end:
+      H5Fclose(snap->h_file);
+
+      /* Hand over to the next rank and wait for the file to be complete */
+      if (snap->mpi_rank < snap->mpi_size - 1)
+        MPI_Send(NULL, 0, MPI_BYTE, snap->mpi_rank + 1, 0, snap->comm);
+      MPI_Barrier(snap->comm);
+      break;
+  }
+}
+
 /**
  * @brief Writes an HDF5 output file (GADGET-3 type) with its XMF descriptor
  *
@@ -912,6 +1003,12 @@ void read_ic_serial(char* fileName, const struct unit_system* internal_units,
  * by the new one.
  * The companion XMF file is also updated accordingly.
  *
+ * In asynchronous mode, the particle fields are converted here but the ranks
+ * take turns to write them from a separate thread such that this function
+ * can return before the file is complete. The XMF file is then only updated
+ * once the snapshot is fully written. io_async_wait() must be called by all
+ * the ranks before any use of the file.
+ *
  * Calls #error() if an error occurs.
  *
  */
@@ -942,9 +1039,13 @@ void write_output_serial(struct engine* e,
   const int with_stf = 0;
 #endif
   const int with_rt = e->policy & engine_policy_rt;
+  const int async = e->snapshot_async;
 
   FILE* xmfFile = 0;
 
+  /* Wait for the previous snapshot to be fully written */
+  io_async_wait();
+
   /* Number of particles currently in the arrays */
   const size_t Ntot = e->s->nr_gparts;
   const size_t Ngas = e->s->nr_parts;
@@ -1021,14 +1122,19 @@ void write_output_serial(struct engine* e,
   /* Do common stuff first */
   if (mpi_rank == 0) {
 
-    /* First time, we need to create the XMF file */
-    if (e->snapshot_output_count == 0) xmf_create_file(xmfFileName);
+    /* The asynchronous writer only updates the XMF file once the snapshot is
+     * complete */
+    if (!async) {
 
-    /* Prepare the XMF file for the new entry */
-    xmfFile = xmf_prepare_file(xmfFileName);
+      /* First time, we need to create the XMF file */
+      if (e->snapshot_output_count == 0) xmf_create_file(xmfFileName);
 
-    /* Write the part corresponding to this specific output */
-    xmf_write_outputheader(xmfFile, fileName, e->time);
+      /* Prepare the XMF file for the new entry */
+      xmfFile = xmf_prepare_file(xmfFileName);
+
+      /* Write the part corresponding to this specific output */
+      xmf_write_outputheader(xmfFile, fileName, e->time);
+    }
 
     /* Open file */
     /* message("Opening file '%s'.", fileName); */
@@ -1170,15 +1276,30 @@ void write_output_serial(struct engine* e,
     H5Fclose(h_file_cells);
   }
 
-  /* Now loop over ranks and write the data */
+  /* From now on, the file is only accessed by the writer threads */
+  if (async)
+    io_async_begin_collective(e, /*h_file=*/0, fileName,
+                              mpi_rank == 0 ? xmfFileName : NULL,
+                              snapshot_units, serial_io_async_write_job,
+                              mpi_rank, mpi_size, comm);
+
+  /* Now loop over ranks and write the data. The asynchronous writers take
+   * turns by themselves so all the ranks hand over their data at once. */
   for (int rank = 0; rank < mpi_size; ++rank) {
 
     /* Is it this rank's turn to write ? */
-    if (rank == mpi_rank) {
-
-      h_file = H5Fopen(fileName, H5F_ACC_RDWR, H5P_DEFAULT);
-      if (h_file < 0)
-        error("Error while opening file '%s' on rank %d.", fileName, mpi_rank);
+    if (async ? rank == 0 : rank == mpi_rank) {
+
+      if (async) {
+        io_async_push(io_async_new_job(io_async_file_begin, /*h_grp=*/0,
+                                       swift_type_gas,
+                                       /*partTypeGroupName=*/NULL, 0, 0));
+      } else {
+        h_file = H5Fopen(fileName, H5F_ACC_RDWR, H5P_DEFAULT);
+        if (h_file < 0)
+          error("Error while opening file '%s' on rank %d.", fileName,
+                mpi_rank);
+      }
 
       /* Loop over all particle types */
       for (int ptype = 0; ptype < swift_type_count; ptype++) {
@@ -1189,7 +1310,7 @@ void write_output_serial(struct engine* e,
 
         /* Add the global information for that particle type to the XMF
          * meta-file */
-        if (mpi_rank == 0)
+        if (mpi_rank == 0 && !async)
           xmf_write_groupheader(xmfFile, fileName, N_total[ptype],
                                 (enum part_type)ptype);
 
@@ -1197,9 +1318,16 @@ void write_output_serial(struct engine* e,
         char partTypeGroupName[PARTICLE_GROUP_BUFFER_SIZE];
         snprintf(partTypeGroupName, PARTICLE_GROUP_BUFFER_SIZE, "/PartType%d",
                  ptype);
-        h_grp = H5Gopen(h_file, partTypeGroupName, H5P_DEFAULT);
-        if (h_grp < 0)
-          error("Error while opening particle group %s.", partTypeGroupName);
+        if (async) {
+          io_async_push(io_async_new_job(io_async_group_begin, /*h_grp=*/0,
+                                         (enum part_type)ptype,
+                                         partTypeGroupName, N[ptype],
+                                         N_total[ptype]));
+        } else {
+          h_grp = H5Gopen(h_file, partTypeGroupName, H5P_DEFAULT);
+          if (h_grp < 0)
+            error("Error while opening particle group %s.", partTypeGroupName);
+        }
 
         int num_fields = 0;
         struct io_props list[100];
@@ -1302,7 +1430,7 @@ void write_output_serial(struct engine* e,
               darkmatter_write_particles(gparts, list, &num_fields);
               if (with_fof) {
                 num_fields +=
-                    fof_write_gparts(gparts_written, list + num_fields);
+                    fof_write_gparts(gparts, list + num_fields);
               }
               if (with_stf) {
                 num_fields += velociraptor_write_gparts(e->s->gpart_group_data,
@@ -1543,15 +1671,29 @@ void write_output_serial(struct engine* e,
                   (enum part_type)ptype, compression_level_current_default);
 
           if (compression_level != compression_do_not_write) {
-            write_array_serial(e, h_grp, fileName, xmfFile, partTypeGroupName,
-                               list[i], Nparticles, N_total[ptype], mpi_rank,
-                               offset[ptype], compression_level, internal_units,
-                               snapshot_units);
+            if (async)
+              io_async_push_dataset(e, /*h_grp=*/0, (enum part_type)ptype,
+                                    partTypeGroupName, list[i], Nparticles,
+                                    N_total[ptype], offset[ptype],
+                                    compression_level, internal_units,
+                                    snapshot_units);
+            else
+              write_array_serial(e, h_grp, fileName, xmfFile,
+                                 partTypeGroupName, list[i], Nparticles,
+                                 N_total[ptype], mpi_rank, offset[ptype],
+                                 compression_level, internal_units,
+                                 snapshot_units);
             num_fields_written++;
           }
         }
 
-        if (mpi_rank == 0) {
+        if (async) {
+          struct io_async_job* job = io_async_new_job(
+              io_async_group_end, /*h_grp=*/0, (enum part_type)ptype,
+              partTypeGroupName, N[ptype], N_total[ptype]);
+          job->num_fields = num_fields_written;
+          io_async_push(job);
+        } else if (mpi_rank == 0) {
           /* Only write this now that we know exactly how many fields there are.
            */
           io_write_attribute_i(h_grp, "NumberOfFields", num_fields_written);
@@ -1567,24 +1709,32 @@ void write_output_serial(struct engine* e,
         if (bparts_written) swift_free("bparts_written", sparts_written);
         if (sinks_written) swift_free("sinks_written", sinks_written);
 
-        /* Close particle group */
-        H5Gclose(h_grp);
+        if (!async) {
+
+          /* Close particle group */
+          H5Gclose(h_grp);
 
-        /* Close this particle group in the XMF file as well */
-        if (mpi_rank == 0)
-          xmf_write_groupfooter(xmfFile, (enum part_type)ptype);
+          /* Close this particle group in the XMF file as well */
+          if (mpi_rank == 0)
+            xmf_write_groupfooter(xmfFile, (enum part_type)ptype);
+        }
       }
 
       /* Close file */
-      H5Fclose(h_file);
+      if (async)
+        io_async_push(io_async_new_job(io_async_file_end, /*h_grp=*/0,
+                                       swift_type_gas,
+                                       /*partTypeGroupName=*/NULL, 0, 0));
+      else
+        H5Fclose(h_file);
     }
 
     /* Wait for the read of the reading to complete */
-    MPI_Barrier(comm);
+    if (!async) MPI_Barrier(comm);
   }
 
   /* Write footer of LXMF file descriptor */
-  if (mpi_rank == 0)
+  if (mpi_rank == 0 && !async)
     xmf_write_outputfooter(xmfFile, e->snapshot_output_count, e->time);
 
   /* message("Done writing particles..."); */
@@ -48,6 +48,7 @@
 #include "gravity_properties.h"
 #include "hydro_io.h"
 #include "hydro_properties.h"
+#include "io_async.h"
 #include "io_compression.h"
 #include "io_properties.h"
 #include "memuse.h"
@@ -217,9 +218,9 @@ void read_array_single(hid_t h_grp, const struct io_props props, size_t N,
 }
 
 /**
- * @brief Writes a data array in given HDF5 group.
+ * @brief Writes a data array already converted to snapshot units in a given
+ * HDF5 group.
  *
- * @param e The #engine we are writing from.
  * @param grp The group in which to write.
  * @param fileName The name of the file in which the data is written
  * @param xmfFile The FILE used to write the XMF description
@@ -227,32 +228,18 @@ void read_array_single(hid_t h_grp, const struct io_props props, size_t N,
  * the HDF5 file.
  * @param props The #io_props of the field to read
  * @param N The number of particles to write.
- * @param internal_units The #unit_system used internally
+ * @param lossy_compression The lossy compression scheme to apply.
+ * @param compression The level of GZIP compression to apply.
+ * @param a The current scale-factor.
  * @param snapshot_units The #unit_system used in the snapshots
- *
- * @todo A better version using HDF5 hyper-slabs to write the file directly from
- * the part array will be written once the structures have been stabilized.
+ * @param temp The buffer containing the converted data.
  */
-void write_array_single(const struct engine* e, hid_t grp, char* fileName,
-                        FILE* xmfFile, char* partTypeGroupName,
-                        const struct io_props props, size_t N,
-                        const enum lossy_compression_schemes lossy_compression,
-                        const struct unit_system* internal_units,
-                        const struct unit_system* snapshot_units) {
-
-  const size_t typeSize = io_sizeof_type(props.type);
-  const size_t num_elements = N * props.dimension;
-
-  /* message("Writing '%s' array...", props.name); */
-
-  /* Allocate temporary buffer */
-  void* temp = NULL;
-  if (swift_memalign("writebuff", (void**)&temp, IO_BUFFER_ALIGNMENT,
-                     num_elements * typeSize) != 0)
-    error("Unable to allocate temporary i/o buffer");
-
-  /* Copy the particle data to the temporary buffer */
-  io_copy_temp_buffer(temp, e, props, N, internal_units, snapshot_units);
+static void write_array_single_buffer(
+    hid_t grp, const char* fileName, FILE* xmfFile,
+    const char* partTypeGroupName, const struct io_props props, size_t N,
+    const enum lossy_compression_schemes lossy_compression,
+    const int compression, const double a,
+    const struct unit_system* snapshot_units, const void* temp) {
 
   /* Create data space */
   const hid_t h_space = H5Screate(H5S_SIMPLE);
@@ -305,13 +292,13 @@ void write_array_single(const struct engine* e, hid_t grp, char* fileName,
     set_hdf5_lossy_compression(&h_prop, &h_type, lossy_compression, props.name);
 
   /* Impose GZIP data compression */
-  if (e->snapshot_compression > 0) {
+  if (compression > 0) {
     h_err = H5Pset_shuffle(h_prop);
     if (h_err < 0)
       error("Error while setting shuffling options for field '%s'.",
             props.name);
 
-    h_err = H5Pset_deflate(h_prop, e->snapshot_compression);
+    h_err = H5Pset_deflate(h_prop, compression);
     if (h_err < 0)
       error("Error while setting compression options for field '%s'.",
             props.name);
@@ -362,7 +349,7 @@ void write_array_single(const struct engine* e, hid_t grp, char* fileName,
   io_write_attribute_d(
       h_data,
       "Conversion factor to physical CGS (including cosmological corrections)",
-      factor * pow(e->cosmology->a, props.scale_factor_exponent));
+      factor * pow(a, props.scale_factor_exponent));
 
 #ifdef SWIFT_DEBUG_CHECKS
   if (strlen(props.description) == 0)
@@ -372,14 +359,61 @@ void write_array_single(const struct engine* e, hid_t grp, char* fileName,
   /* Write the full description */
   io_write_attribute_s(h_data, "Description", props.description);
 
-  /* Free and close everything */
-  swift_free("writebuff", temp);
+  /* Close everything */
   H5Tclose(h_type);
   H5Pclose(h_prop);
   H5Dclose(h_data);
   H5Sclose(h_space);
 }
 
+/**
+ * @brief Writes a data array in given HDF5 group.
+ *
+ * @param e The #engine we are writing from.
+ * @param grp The group in which to write.
+ * @param fileName The name of the file in which the data is written
+ * @param xmfFile The FILE used to write the XMF description
+ * @param partTypeGroupName The name of the group containing the particles in
+ * the HDF5 file.
+ * @param props The #io_props of the field to read
+ * @param N The number of particles to write.
+ * @param lossy_compression The lossy compression scheme to apply.
+ * @param internal_units The #unit_system used internally
+ * @param snapshot_units The #unit_system used in the snapshots
+ *
+ * @todo A better version using HDF5 hyper-slabs to write the file directly from
+ * the part array will be written once the structures have been stabilized.
+ */
+void write_array_single(const struct engine* e, hid_t grp, char* fileName,
+                        FILE* xmfFile, char* partTypeGroupName,
+                        const struct io_props props, size_t N,
+                        const enum lossy_compression_schemes lossy_compression,
+                        const struct unit_system* internal_units,
+                        const struct unit_system* snapshot_units) {
+
+  const size_t typeSize = io_sizeof_type(props.type);
+  const size_t num_elements = N * props.dimension;
+
+  /* message("Writing '%s' array...", props.name); */
+
+  /* Allocate temporary buffer */
+  void* temp = NULL;
+  if (swift_memalign("writebuff", (void**)&temp, IO_BUFFER_ALIGNMENT,
+                     num_elements * typeSize) != 0)
+    error("Unable to allocate temporary i/o buffer");
+
+  /* Copy the particle data to the temporary buffer */
+  io_copy_temp_buffer(temp, e, props, N, internal_units, snapshot_units);
+
+  /* Write it to the file */
+  write_array_single_buffer(grp, fileName, xmfFile, partTypeGroupName, props,
+                            N, lossy_compression, e->snapshot_compression,
+                            e->cosmology->a, snapshot_units, temp);
+
+  /* Free everything */
+  swift_free("writebuff", temp);
+}
+
 /**
  * @brief Reads an HDF5 initial condition file (GADGET-3 type)
  *
@@ -756,6 +790,38 @@ void read_ic_single(const char* fileName,
   H5Fclose(h_file);
 }
 
+/**
+ * @brief Executes a job of the asynchronous snapshot writer.
+ *
+ * The groups and the file are created by write_output_single() and closed
+ * here once all their datasets are written.
+ *
+ * @param job The #io_async_job to execute.
+ * @param snap The #io_async_snapshot being written.
+ */
+static void single_io_async_write_job(struct io_async_job* job,
+                                      struct io_async_snapshot* snap) {
+
+  switch (job->type) {
+    case io_async_file_begin:
+    case io_async_group_begin:
+      break;
+    case io_async_dataset:
+      write_array_single_buffer(
+          job->h_grp, snap->fileName, /*xmfFile=*/NULL, job->partTypeGroupName,
+          job->props, job->N, job->lossy_compression, snap->compression,
+          snap->a, &snap->snapshot_units, job->buffer);
+      break;
+    case io_async_group_end:
+      io_write_attribute_i(job->h_grp, "NumberOfFields", job->num_fields);
+      H5Gclose(job->h_grp);
+      break;
+    case io_async_file_end:
+      H5Fclose(snap->h_file);
+      break;
+  }
+}
+
 /**
  * @brief Writes an HDF5 output file (GADGET-3 type) with its XMF descriptor
  *
@@ -768,6 +834,11 @@ void read_ic_single(const char* fileName,
  * by the new one.
  * The companion XMF file is also updated accordingly.
  *
+ * In asynchronous mode, the particle fields are converted here but written
+ * by a separate thread such that this function can return before the file
+ * is complete. The XMF file is then only updated once the snapshot is fully
+ * written. io_async_wait() must be called before any use of the file.
+ *
  * Calls #error() if an error occurs.
  *
  */
@@ -797,6 +868,10 @@ void write_output_single(struct engine* e,
   const int with_stf = 0;
 #endif
   const int with_rt = e->policy & engine_policy_rt;
+  const int async = e->snapshot_async;
+
+  /* Make sure the previous snapshot is complete */
+  io_async_wait();
 
   /* Number of particles currently in the arrays */
   const size_t Ntot = e->s->nr_gparts;
@@ -843,15 +918,19 @@ void write_output_single(struct engine* e,
                            e->snapshot_output_count, e->snapshot_subdir,
                            e->snapshot_base_name);
 
-  /* First time, we need to create the XMF file */
-  if (e->snapshot_output_count == 0) xmf_create_file(xmfFileName);
-
-  /* Prepare the XMF file for the new entry */
+  /* In asynchronous mode, the XMF file is written by the writer thread */
   FILE* xmfFile = 0;
-  xmfFile = xmf_prepare_file(xmfFileName);
+  if (!async) {
+
+    /* First time, we need to create the XMF file */
+    if (e->snapshot_output_count == 0) xmf_create_file(xmfFileName);
 
-  /* Write the part corresponding to this specific output */
-  xmf_write_outputheader(xmfFile, fileName, e->time);
+    /* Prepare the XMF file for the new entry */
+    xmfFile = xmf_prepare_file(xmfFileName);
+
+    /* Write the part corresponding to this specific output */
+    xmf_write_outputheader(xmfFile, fileName, e->time);
+  }
 
   /* Open file */
   /* message("Opening file '%s'.", fileName); */
@@ -960,6 +1039,11 @@ void write_output_single(struct engine* e,
                         internal_units, snapshot_units);
   H5Gclose(h_grp);
 
+  /* The particle data will be written by the writer thread */
+  if (async)
+    io_async_begin(e, h_file, fileName, xmfFileName, snapshot_units,
+                   single_io_async_write_job);
+
   /* Loop over all particle types */
   for (int ptype = 0; ptype < swift_type_count; ptype++) {
 
@@ -968,8 +1052,14 @@ void write_output_single(struct engine* e,
     if (numParticles[ptype] == 0 || numFields[ptype] == 0) continue;
 
     /* Add the global information for that particle type to the XMF meta-file */
-    xmf_write_groupheader(xmfFile, fileName, numParticles[ptype],
-                          (enum part_type)ptype);
+    if (async)
+      io_async_push(io_async_new_job(io_async_group_begin, /*h_grp=*/0,
+                                     (enum part_type)ptype,
+                                     /*partTypeGroupName=*/NULL,
+                                     N_total[ptype], N_total[ptype]));
+    else
+      xmf_write_groupheader(xmfFile, fileName, numParticles[ptype],
+                            (enum part_type)ptype);
 
     /* Open the particle group in the file */
     char partTypeGroupName[PARTICLE_GROUP_BUFFER_SIZE];
@@ -1317,16 +1407,19 @@ void write_output_single(struct engine* e,
               (enum part_type)ptype, compression_level_current_default);
 
       if (compression_level != compression_do_not_write) {
-        write_array_single(e, h_grp, fileName, xmfFile, partTypeGroupName,
-                           list[i], N, compression_level, internal_units,
-                           snapshot_units);
+        if (async)
+          io_async_push_dataset(e, h_grp, (enum part_type)ptype,
+                                partTypeGroupName, list[i], N, N,
+                                /*offset=*/0, compression_level,
+                                internal_units, snapshot_units);
+        else
+          write_array_single(e, h_grp, fileName, xmfFile, partTypeGroupName,
+                             list[i], N, compression_level, internal_units,
+                             snapshot_units);
         num_fields_written++;
       }
     }
 
-    /* Only write this now that we know exactly how many fields there are. */
-    io_write_attribute_i(h_grp, "NumberOfFields", num_fields_written);
-
     /* Free temporary arrays */
     if (parts_written) swift_free("parts_written", parts_written);
     if (xparts_written) swift_free("xparts_written", xparts_written);
@@ -1337,20 +1430,44 @@ void write_output_single(struct engine* e,
     if (bparts_written) swift_free("bparts_written", bparts_written);
     if (sinks_written) swift_free("sinks_written", sinks_written);
 
-    /* Close particle group */
-    H5Gclose(h_grp);
+    if (async) {
+
+      /* Let the writer close the group once all its fields are written */
+      struct io_async_job* job =
+          io_async_new_job(io_async_group_end, h_grp, (enum part_type)ptype,
+                           partTypeGroupName, N, N);
+      job->num_fields = num_fields_written;
+      io_async_push(job);
 
-    /* Close this particle group in the XMF file as well */
-    xmf_write_groupfooter(xmfFile, (enum part_type)ptype);
+    } else {
+
+      /* Only write this now that we know exactly how many fields there are. */
+      io_write_attribute_i(h_grp, "NumberOfFields", num_fields_written);
+
+      /* Close particle group */
+      H5Gclose(h_grp);
+
+      /* Close this particle group in the XMF file as well */
+      xmf_write_groupfooter(xmfFile, (enum part_type)ptype);
+    }
   } /* ends loop over particle types */
 
-  /* Write LXMF file descriptor */
-  xmf_write_outputfooter(xmfFile, e->snapshot_output_count, e->time);
+  if (async) {
 
-  /* message("Done writing particles..."); */
+    /* Let the writer close the file and write the XMF description */
+    io_async_push(io_async_new_job(io_async_file_end, h_file, swift_type_gas,
+                                   /*partTypeGroupName=*/NULL, 0, 0));
 
-  /* Close file */
-  H5Fclose(h_file);
+  } else {
+
+    /* Write LXMF file descriptor */
+    xmf_write_outputfooter(xmfFile, e->snapshot_output_count, e->time);
+
+    /* message("Done writing particles..."); */
+
+    /* Close file */
+    H5Fclose(h_file);
+  }
 
   e->snapshot_output_count++;
   if (e->snapshot_invoke_stf) e->stf_output_count++;
@@ -0,0 +1,219 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+/* Config parameters. */
+#include "../config.h"
+
+/* Some standard headers. */
+#include <stdint.h>
+#include <string.h>
+
+/* This object's header. */
+#include "sort_part.h"
+
+/*! Number of bits sorted in each pass of the radix sort */
+#define sort_part_radix_bits 8
+
+/*! Number of buckets used in each pass of the radix sort */
+#define sort_part_radix_size (1 << sort_part_radix_bits)
+
+/*! Below this size, lists are sorted using insertion sort */
+#define sort_part_insertion_threshold 32
+
+/**
+ * @brief Convert a float into an unsigned integer with the same ordering.
+ *
+ * Positive numbers get their sign bit set and negative ones get all their
+ * bits flipped such that the integers compare in the same order as the
+ * floats.
+ *
+ * @param d The float to convert.
+ */
+__attribute__((always_inline)) INLINE static uint32_t sort_part_key(
+    const float d) {
+
+  uint32_t u;
+  memcpy(&u, &d, sizeof(uint32_t));
+  const uint32_t mask = (uint32_t)(-(int32_t)(u >> 31)) | 0x80000000u;
+  return u ^ mask;
+}
+
+/**
+ * @brief Sort a short list of entries in ascending order using insertion
+ * sort.
+ *
+ * Entries with equal distances are ordered by particle index such that the
+ * result does not depend on the order in which they were provided.
+ *
+ * @param sort The entries.
+ * @param N The number of entries.
+ */
+static void sort_part_insertion(struct sort_entry *restrict sort,
+                                const int N) {
+
+  for (int i = 1; i < N; i++) {
+    const struct sort_entry temp = sort[i];
+    int j = i - 1;
+    while (j >= 0 && (sort[j].d > temp.d ||
+                      (sort[j].d == temp.d && sort[j].i > temp.i))) {
+      sort[j + 1] = sort[j];
+      j--;
+    }
+    sort[j + 1] = temp;
+  }
+}
+
+/**
+ * @brief Recursive in-place MSD radix sort (American flag sort) of a list of
+ * entries.
+ *
+ * The digit used at each level is chosen from the range of keys present in
+ * the list such that the bits common to all the entries are skipped. Since
+ * the distances of particles in a cell only span a narrow range of values,
+ * this typically leaves very few levels to process.
+ *
+ * @param sort The entries.
+ * @param N The number of entries.
+ */
+static void sort_part_radix(struct sort_entry *restrict sort, const int N) {
+
+  if (N <= sort_part_insertion_threshold) {
+    sort_part_insertion(sort, N);
+    return;
+  }
+
+  /* Range of keys in this list */
+  uint32_t key_min = UINT32_MAX, key_max = 0;
+  for (int i = 0; i < N; i++) {
+    const uint32_t key = sort_part_key(sort[i].d);
+    key_min = key < key_min ? key : key_min;
+    key_max = key > key_max ? key : key_max;
+  }
+
+  /* All the same? Then only the indices are left to order. */
+  const uint32_t diff = key_min ^ key_max;
+  if (diff == 0) {
+    sort_part_insertion(sort, N);
+    return;
+  }
+
+  /* Digit starting at the highest bit differing between the keys */
+  const int top_bit = 31 - __builtin_clz(diff);
+  const int shift = top_bit >= sort_part_radix_bits - 1
+                        ? top_bit - (sort_part_radix_bits - 1)
+                        : 0;
+
+  /* Histogram of the digits */
+  int count[sort_part_radix_size] = {0};
+  for (int i = 0; i < N; i++) {
+    const uint32_t key = sort_part_key(sort[i].d);
+    count[(key >> shift) & (sort_part_radix_size - 1)]++;
+  }
+
+  /* Start and end of each bucket */
+  int next[sort_part_radix_size], end[sort_part_radix_size];
+  int offset = 0;
+  for (int b = 0; b < sort_part_radix_size; b++) {
+    next[b] = offset;
+    offset += count[b];
+    end[b] = offset;
+  }
+
+  /* Move the entries to their bucket by following the permutation cycles */
+  for (int b = 0; b < sort_part_radix_size; b++) {
+    while (next[b] < end[b]) {
+      struct sort_entry temp = sort[next[b]];
+      int dest =
+          (sort_part_key(temp.d) >> shift) & (sort_part_radix_size - 1);
+      while (dest != b) {
+        const struct sort_entry swap = sort[next[dest]];
+        sort[next[dest]++] = temp;
+        temp = swap;
+        dest = (sort_part_key(temp.d) >> shift) & (sort_part_radix_size - 1);
+      }
+      sort[next[b]++] = temp;
+    }
+  }
+
+  /* Last digit? */
+  if (shift == 0) return;
+
+  /* Recurse into the buckets */
+  offset = 0;
+  for (int b = 0; b < sort_part_radix_size; b++) {
+    if (count[b] > 1) sort_part_radix(&sort[offset], count[b]);
+    offset += count[b];
+  }
+}
+
+/**
+ * @brief Sort the entries in ascending order of distance.
+ *
+ * Uses an in-place radix sort on the bit representation of the distances,
+ * hence requires no additional memory and places no limit on the number of
+ * entries.
+ *
+ * @param sort The entries.
+ * @param N The number of entries.
+ */
+void sort_part_ascending(struct sort_entry *sort, const int N) {
+
+  sort_part_radix(sort, N);
+}
+
+/**
+ * @brief Sort entries that are expected to be almost in ascending order.
+ *
+ * This is meant for lists re-using the order of a previous sort after the
+ * particles have only drifted by a small amount. An insertion sort is used
+ * as long as the total number of moves it requires stays below
+ * max_moves_per_entry * N. Beyond that, the remainder of the work is
+ * handed over to sort_part_ascending().
+ *
+ * @param sort The entries.
+ * @param N The number of entries.
+ * @param max_moves_per_entry Average number of moves per entry above which
+ * we give up on the insertion sort.
+ */
+void sort_part_ascending_adaptive(struct sort_entry *sort, const int N,
+                                  const int max_moves_per_entry) {
+
+  long long moves_left = (long long)max_moves_per_entry * N;
+
+  for (int i = 1; i < N; i++) {
+
+    /* Common case: already in the right place */
+    if (sort[i].d >= sort[i - 1].d) continue;
+
+    const struct sort_entry temp = sort[i];
+    int j = i - 1;
+    while (j >= 0 && sort[j].d > temp.d) {
+      sort[j + 1] = sort[j];
+      j--;
+    }
+    sort[j + 1] = temp;
+
+    /* Too many inversions? */
+    moves_left -= i - 1 - j;
+    if (moves_left < 0) {
+      sort_part_ascending(sort, N);
+      return;
+    }
+  }
+}
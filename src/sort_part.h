@@ -20,6 +20,9 @@
 #ifndef SWIFT_SORT_PART_H
 #define SWIFT_SORT_PART_H
 
+/* Local headers. */
+#include "inline.h"
+
 /**
  * @brief Entry in a list of sorted indices.
  */
@@ -129,4 +132,8 @@ __attribute__((always_inline)) INLINE static int sort_is_face(int sid) {
   return (sid == 4 || sid == 10 || sid == 12);
 }
 
+void sort_part_ascending(struct sort_entry *sort, const int N);
+void sort_part_ascending_adaptive(struct sort_entry *sort, const int N,
+                                  const int max_moves_per_entry);
+
 #endif /* SWIFT_SORT_PART_H */
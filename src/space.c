@@ -277,6 +277,7 @@ void space_map_clearsort(struct cell *c, void *data) {
 
   cell_free_hydro_sorts(c);
   cell_free_stars_sorts(c);
+  cell_free_grav_cache(c);
 }
 
 /**
@@ -485,6 +486,7 @@ void space_getcells(struct space *s, int nr_cells, struct cell **cells) {
   for (int j = 0; j < nr_cells; j++) {
     cell_free_hydro_sorts(cells[j]);
     cell_free_stars_sorts(cells[j]);
+    cell_free_grav_cache(cells[j]);
 
     struct gravity_tensors *temp = cells[j]->grav.multipole;
     bzero(cells[j], sizeof(struct cell));
@@ -513,6 +515,7 @@ void space_free_buff_sort_indices(struct space *s) {
        finger = finger->next) {
     cell_free_hydro_sorts(finger);
     cell_free_stars_sorts(finger);
+    cell_free_grav_cache(finger);
   }
 }
 
@@ -1952,6 +1955,9 @@ void space_clean(struct space *s) {
   swift_free("cells_with_particles_top", s->cells_with_particles_top);
   swift_free("local_cells_with_particles_top",
              s->local_cells_with_particles_top);
+  swift_free("grav_long_range_offsets", s->grav_long_range_offsets);
+  swift_free("grav_long_range_cells", s->grav_long_range_cells);
+  swift_free("grav_long_range_nr_far", s->grav_long_range_nr_far);
   swift_free("parts", s->parts);
   swift_free("xparts", s->xparts);
   swift_free("gparts", s->gparts);
@@ -2028,25 +2034,25 @@ void space_struct_dump(struct space *s, FILE *stream) {
 
   /* More things to write. */
   if (s->nr_parts > 0) {
-    restart_write_blocks(s->parts, s->nr_parts, sizeof(struct part), stream,
-                         "parts", "parts");
-    restart_write_blocks(s->xparts, s->nr_parts, sizeof(struct xpart), stream,
-                         "xparts", "xparts");
+    restart_write_chunked_blocks(s->parts, s->nr_parts, sizeof(struct part),
+                                 stream, "parts", "parts");
+    restart_write_chunked_blocks(s->xparts, s->nr_parts, sizeof(struct xpart),
+                                 stream, "xparts", "xparts");
   }
   if (s->nr_gparts > 0)
-    restart_write_blocks(s->gparts, s->nr_gparts, sizeof(struct gpart), stream,
-                         "gparts", "gparts");
+    restart_write_chunked_blocks(s->gparts, s->nr_gparts, sizeof(struct gpart),
+                                 stream, "gparts", "gparts");
 
   if (s->nr_sinks > 0)
-    restart_write_blocks(s->sinks, s->nr_sinks, sizeof(struct sink), stream,
-                         "sinks", "sinks");
+    restart_write_chunked_blocks(s->sinks, s->nr_sinks, sizeof(struct sink),
+                                 stream, "sinks", "sinks");
 
   if (s->nr_sparts > 0)
-    restart_write_blocks(s->sparts, s->nr_sparts, sizeof(struct spart), stream,
-                         "sparts", "sparts");
+    restart_write_chunked_blocks(s->sparts, s->nr_sparts, sizeof(struct spart),
+                                 stream, "sparts", "sparts");
   if (s->nr_bparts > 0)
-    restart_write_blocks(s->bparts, s->nr_bparts, sizeof(struct bpart), stream,
-                         "bparts", "bparts");
+    restart_write_chunked_blocks(s->bparts, s->nr_bparts, sizeof(struct bpart),
+                                 stream, "bparts", "bparts");
 }
 
 /**
@@ -2109,6 +2115,9 @@ void space_struct_restore(struct space *s, FILE *stream) {
   s->local_cells_with_tasks_top = NULL;
   s->cells_with_particles_top = NULL;
   s->local_cells_with_particles_top = NULL;
+  s->grav_long_range_offsets = NULL;
+  s->grav_long_range_cells = NULL;
+  s->grav_long_range_nr_far = NULL;
   s->nr_local_cells_with_tasks = 0;
   s->nr_cells_with_particles = 0;
 #ifdef WITH_MPI
@@ -2136,10 +2145,10 @@ void space_struct_restore(struct space *s, FILE *stream) {
                        s->size_parts * sizeof(struct xpart)) != 0)
       error("Failed to allocate restore xpart array.");
 
-    restart_read_blocks(s->parts, s->nr_parts, sizeof(struct part), stream,
-                        NULL, "parts");
-    restart_read_blocks(s->xparts, s->nr_parts, sizeof(struct xpart), stream,
-                        NULL, "xparts");
+    restart_read_chunked_blocks(s->parts, s->nr_parts, sizeof(struct part),
+                                stream, NULL, "parts");
+    restart_read_chunked_blocks(s->xparts, s->nr_parts, sizeof(struct xpart),
+                                stream, NULL, "xparts");
   }
   s->gparts = NULL;
   if (s->nr_gparts > 0) {
@@ -2147,8 +2156,8 @@ void space_struct_restore(struct space *s, FILE *stream) {
                        s->size_gparts * sizeof(struct gpart)) != 0)
       error("Failed to allocate restore gpart array.");
 
-    restart_read_blocks(s->gparts, s->nr_gparts, sizeof(struct gpart), stream,
-                        NULL, "gparts");
+    restart_read_chunked_blocks(s->gparts, s->nr_gparts, sizeof(struct gpart),
+                                stream, NULL, "gparts");
   }
 
   s->sinks = NULL;
@@ -2157,8 +2166,8 @@ void space_struct_restore(struct space *s, FILE *stream) {
                        s->size_sinks * sizeof(struct sink)) != 0)
       error("Failed to allocate restore sink array.");
 
-    restart_read_blocks(s->sinks, s->nr_sinks, sizeof(struct sink), stream,
-                        NULL, "sinks");
+    restart_read_chunked_blocks(s->sinks, s->nr_sinks, sizeof(struct sink),
+                                stream, NULL, "sinks");
   }
 
   s->sparts = NULL;
@@ -2167,8 +2176,8 @@ void space_struct_restore(struct space *s, FILE *stream) {
                        s->size_sparts * sizeof(struct spart)) != 0)
       error("Failed to allocate restore spart array.");
 
-    restart_read_blocks(s->sparts, s->nr_sparts, sizeof(struct spart), stream,
-                        NULL, "sparts");
+    restart_read_chunked_blocks(s->sparts, s->nr_sparts, sizeof(struct spart),
+                                stream, NULL, "sparts");
   }
   s->bparts = NULL;
   if (s->nr_bparts > 0) {
@@ -2176,8 +2185,8 @@ void space_struct_restore(struct space *s, FILE *stream) {
                        s->size_bparts * sizeof(struct bpart)) != 0)
       error("Failed to allocate restore bpart array.");
 
-    restart_read_blocks(s->bparts, s->nr_bparts, sizeof(struct bpart), stream,
-                        NULL, "bparts");
+    restart_read_chunked_blocks(s->bparts, s->nr_bparts, sizeof(struct bpart),
+                                stream, NULL, "bparts");
   }
 
   /* Need to reconnect the gravity parts to their hydro, star and BH particles.
@@ -168,6 +168,17 @@ struct space {
   /*! The indices of the top-level cells that have >0 particles (of any kind) */
   int *local_cells_with_particles_top;
 
+  /*! For each top-level cell, the start of its list of top-level cells to
+   * interact with using M-M in the long-range gravity task */
+  int *grav_long_range_offsets;
+
+  /*! The lists of M-M interactions of the long-range gravity tasks */
+  int *grav_long_range_cells;
+
+  /*! For each top-level cell, the number of top-level cells beyond the
+   * cut-off of the mesh forces */
+  int *grav_long_range_nr_far;
+
   /*! The total number of #part in the space. */
   size_t nr_parts;
 
@@ -88,6 +88,7 @@ void space_rebuild_recycle_mapper(void *map_data, int num_elements,
     if (cell_rec_begin != NULL)
       space_recycle_list(s, cell_rec_begin, cell_rec_end, multipole_rec_begin,
                          multipole_rec_end);
+    cell_free_grav_cache(c);
     c->hydro.sorts = NULL;
     c->stars.sorts = NULL;
     c->nr_tasks = 0;
@@ -106,6 +107,7 @@ void space_rebuild_recycle_mapper(void *map_data, int num_elements,
     c->black_holes.dx_max_part = 0.f;
     c->hydro.sorted = 0;
     c->hydro.sort_allocated = 0;
+    c->hydro.sort_reusable = 0;
     c->stars.sorted = 0;
     c->hydro.count = 0;
     c->hydro.count_total = 0;
@@ -28,6 +28,7 @@
 #include "black_holes_properties.h"
 #include "cache.h"
 #include "cell.h"
+#include "chashmap.h"
 #include "chemistry.h"
 #include "clocks.h"
 #include "common_io.h"
@@ -46,6 +46,7 @@
 #include "error.h"
 #include "inline.h"
 #include "lock.h"
+#include "minmax.h"
 #include "mpiuse.h"
 
 /* Task type names. */
@@ -653,6 +654,9 @@ int task_lock(struct task *t) {
       /* And log deactivation, if logging enabled. */
       if (res) {
         mpiuse_log_allocation(t->type, t->subtype, &t->req, 0, 0, 0, 0);
+#ifdef SWIFT_MPIUSE_REPORTS
+        t->mpi_ticks = getticks() - t->mpi_tic;
+#endif
       }
 
       return res;
@@ -1412,6 +1416,179 @@ void task_dump_active(struct engine *e) {
             clocks_getunit());
 }
 
+/**
+ * @brief Analyse the execution of the tasks of the last step.
+ *
+ * Finds the length of the longest chain of dependent tasks, which bounds
+ * the time of the step whatever the number of threads, the fraction of the
+ * step the threads spent idle and the tasks that were running in the tail
+ * of the step, after the first thread ran out of work. The results of all
+ * the ranks are combined into e->step_summary on rank 0, keeping the
+ * largest values and the tail of the rank with the longest one.
+ *
+ * Needs the time spent by the runners on their tasks, which is reset
+ * before the tasks are launched.
+ *
+ * @param e the #engine
+ */
+void task_analyse_step(struct engine *e) {
+
+  const ticks function_tic = getticks();
+
+  struct task *tasks = e->sched.tasks;
+  const int nr_tasks = e->sched.nr_tasks;
+
+  /* Extent of the tasks that ran in this step. */
+  ticks first = 0, last = 0;
+  for (int k = 0; k < nr_tasks; k++) {
+    const struct task *t = &tasks[k];
+    if (t->implicit || t->tic <= e->tic_step) continue;
+    if (first == 0 || t->tic < first) first = t->tic;
+    if (t->toc > last) last = t->toc;
+  }
+  const double span = (last > first) ? (double)(last - first) : 0.;
+
+  /* Longest chain of dependent tasks, visiting the tasks once all their
+   * dependencies have been. The implicit tasks and the ones that did not
+   * run take no time. */
+  int *waits = NULL;
+  int *queue = NULL;
+  ticks *ends = NULL;
+  if ((waits = (int *)calloc(nr_tasks, sizeof(int))) == NULL ||
+      (queue = (int *)malloc(sizeof(int) * nr_tasks)) == NULL ||
+      (ends = (ticks *)calloc(nr_tasks, sizeof(ticks))) == NULL)
+    error("Failed to allocate the step analysis arrays.");
+
+  for (int k = 0; k < nr_tasks; k++)
+    for (int j = 0; j < tasks[k].nr_unlock_tasks; j++)
+      waits[tasks[k].unlock_tasks[j] - tasks]++;
+
+  int nr_queued = 0;
+  for (int k = 0; k < nr_tasks; k++)
+    if (waits[k] == 0) queue[nr_queued++] = k;
+
+  ticks critical = 0;
+  for (int q = 0; q < nr_queued; q++) {
+    const int k = queue[q];
+    const struct task *t = &tasks[k];
+    if (!t->implicit && t->tic > e->tic_step) ends[k] += t->toc - t->tic;
+    if (ends[k] > critical) critical = ends[k];
+
+    for (int j = 0; j < t->nr_unlock_tasks; j++) {
+      const int u = t->unlock_tasks[j] - tasks;
+      if (ends[k] > ends[u]) ends[u] = ends[k];
+      if (--waits[u] == 0) queue[nr_queued++] = u;
+    }
+  }
+  free(waits);
+  free(queue);
+  free(ends);
+
+  /* Idle fractions of the threads and start of the tail, when the first of
+   * them ran out of work. */
+  double idle_sum = 0., idle_max = 0.;
+  ticks tail_start = last;
+  for (int k = 0; k < e->nr_threads; k++) {
+    const struct runner *r = &e->runners[k];
+    double idle = 0.;
+    if (span > 0.) idle = max(0., 1. - (double)r->busy_ticks / span);
+    idle_sum += idle;
+    idle_max = max(idle_max, idle);
+    const ticks runner_end = max(r->last_toc, first);
+    tail_start = min(tail_start, runner_end);
+  }
+
+  /* Time each type of task spent running in the tail. */
+  double tail_time[task_type_count][task_subtype_count];
+  for (int j = 0; j < task_type_count; j++)
+    for (int k = 0; k < task_subtype_count; k++) tail_time[j][k] = 0.;
+
+  for (int k = 0; k < nr_tasks; k++) {
+    const struct task *t = &tasks[k];
+    if (t->implicit || t->tic <= e->tic_step) continue;
+    const ticks from = max(t->tic, tail_start);
+    if (t->toc > from) tail_time[t->type][t->subtype] += t->toc - from;
+  }
+
+  int tail_type = task_type_none;
+  int tail_subtype = task_subtype_none;
+  for (int j = 0; j < task_type_count; j++) {
+    for (int k = 0; k < task_subtype_count; k++) {
+      if (tail_time[j][k] > tail_time[tail_type][tail_subtype]) {
+        tail_type = j;
+        tail_subtype = k;
+      }
+    }
+  }
+
+  /* Our results, times still in ticks. */
+  double values[7] = {span,
+                      (double)critical,
+                      idle_sum / e->nr_threads,
+                      idle_max,
+                      (double)(last - tail_start),
+                      tail_type,
+                      tail_subtype};
+
+#ifdef WITH_MPI
+  /* Combine the results of all the ranks on rank 0. */
+  double all_values[7 * e->nr_nodes];
+  int res = MPI_Gather(values, 7, MPI_DOUBLE, all_values, 7, MPI_DOUBLE, 0,
+                       MPI_COMM_WORLD);
+  if (res != MPI_SUCCESS) mpi_error(res, "Failed to gather step analysis");
+
+  if (e->nodeID == 0) {
+    double idle_mean = 0., tail_max = -1.;
+    for (int i = 0; i < e->nr_nodes; i++) {
+      const double *v = &all_values[7 * i];
+      values[0] = max(values[0], v[0]);
+      values[1] = max(values[1], v[1]);
+      idle_mean += v[2] / e->nr_nodes;
+      values[3] = max(values[3], v[3]);
+
+      /* Keep the tail of the rank with the longest one. */
+      if (v[4] > tail_max) {
+        tail_max = v[4];
+        values[5] = v[5];
+        values[6] = v[6];
+      }
+    }
+    values[2] = idle_mean;
+    values[4] = tail_max;
+  }
+#endif
+
+  struct task_step_summary *summary = &e->step_summary;
+  summary->span = clocks_from_ticks((ticks)values[0]);
+  summary->critical_path = clocks_from_ticks((ticks)values[1]);
+  summary->idle_mean = values[2];
+  summary->idle_max = values[3];
+  summary->tail = clocks_from_ticks((ticks)values[4]);
+  summary->tail_type = (int)values[5];
+  summary->tail_subtype = (int)values[6];
+
+  if (e->verbose)
+    message("took %.3f %s.", clocks_from_ticks(getticks() - function_tic),
+            clocks_getunit());
+}
+
+/**
+ * @brief Write the columns of the analysis of the tasks of a step to the
+ *        timesteps file.
+ *
+ * @param file the file.
+ * @param summary the analysis of the step.
+ */
+void task_write_step_summary(FILE *file,
+                             const struct task_step_summary *summary) {
+
+  char tail_name[64];
+  task_get_full_name(summary->tail_type, summary->tail_subtype, tail_name);
+  fprintf(file, " %19.3f %19.3f %9.4f %9.4f %19.3f %24s", summary->span,
+          summary->critical_path, summary->idle_mean, summary->idle_max,
+          summary->tail, tail_name);
+}
+
 /**
  * @brief Return the #task_categories of a given #task.
  *
@@ -25,6 +25,9 @@
 
 #include "../config.h"
 
+/* Standard headers. */
+#include <stdio.h>
+
 /* Includes. */
 #include "align.h"
 #include "cycle.h"
@@ -225,6 +228,15 @@ struct task {
   /*! MPI request corresponding to this task */
   MPI_Request req;
 
+#ifdef SWIFT_MPIUSE_REPORTS
+  /*! Size in bytes of the last communication of this task */
+  size_t mpi_size;
+
+  /*! Time the last communication was posted and the time it took to
+   * complete */
+  ticks mpi_tic, mpi_ticks;
+#endif
+
 #endif
 
   /*! Rank of a task in the order */
@@ -272,6 +284,28 @@ struct task {
 
 } SWIFT_STRUCT_ALIGN;
 
+/**
+ * @brief Summary of the execution of the tasks of a step, over all ranks.
+ */
+struct task_step_summary {
+
+  /*! Time from the start of the first to the end of the last task (ms) */
+  float span;
+
+  /*! Length of the longest chain of dependent tasks (ms) */
+  float critical_path;
+
+  /*! Mean and largest fractions of the span the threads were idle */
+  float idle_mean, idle_max;
+
+  /*! Time from the end of the work of the first thread to run out of it
+   * to the end of the step (ms) */
+  float tail;
+
+  /*! Type and subtype of the tasks that ran the longest in the tail */
+  int tail_type, tail_subtype;
+};
+
 /* Function prototypes. */
 void task_unlock(struct task *t);
 float task_overlap(const struct task *ta, const struct task *tb);
@@ -282,6 +316,9 @@ void task_dump_all(struct engine *e, int step);
 void task_dump_stats(const char *dumpfile, struct engine *e,
                      float dump_tasks_threshold, int header, int allranks);
 void task_dump_active(struct engine *e);
+void task_analyse_step(struct engine *e);
+void task_write_step_summary(FILE *file,
+                             const struct task_step_summary *summary);
 void task_get_full_name(int type, int subtype, char *name);
 void task_get_group_name(int type, int subtype, char *cluster);
 enum task_categories task_get_category(const struct task *t);
@@ -0,0 +1,278 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+/* Config parameters. */
+#include "../config.h"
+
+/* Some standard headers. */
+#include <stdlib.h>
+#include <string.h>
+
+/* MPI headers. */
+#ifdef WITH_MPI
+#include <mpi.h>
+#endif
+
+/* This object's header. */
+#include "task_profiler.h"
+
+/* Local headers. */
+#include "cell.h"
+#include "clocks.h"
+#include "error.h"
+#include "parser.h"
+#include "runner.h"
+#include "task.h"
+
+/**
+ * @brief Initialises the #task_profiler from the parameters.
+ *
+ * @param p The #task_profiler.
+ * @param params The parsed parameters.
+ * @param nodeID The rank of this node.
+ * @param restart Are we restarting? Then the file is appended to.
+ */
+void task_profiler_init(struct task_profiler *p, struct swift_params *params,
+                        int nodeID, int restart) {
+
+  p->every = parser_get_opt_param_int(params, "Scheduler:profiler_every", 0);
+  if (p->every < 0)
+    error("Invalid Scheduler:profiler_every, must not be negative");
+  p->write_steps =
+      parser_get_opt_param_int(params, "Scheduler:profiler_write_steps", 100);
+  if (p->write_steps <= 0)
+    error("Invalid Scheduler:profiler_write_steps, must be positive");
+
+  p->nr_samples = NULL;
+  p->sum_ticks = NULL;
+  p->sum_counts = NULL;
+  p->histograms = NULL;
+  p->nr_lost = 0;
+  p->file = NULL;
+  if (p->every == 0) return;
+
+  const size_t size = task_type_count * task_subtype_count;
+  if ((p->nr_samples = (long long *)calloc(size, sizeof(long long))) ==
+          NULL ||
+      (p->sum_ticks = (double *)calloc(size, sizeof(double))) == NULL ||
+      (p->sum_counts = (double *)calloc(size, sizeof(double))) == NULL ||
+      (p->histograms = (long long *)calloc(size * task_profiler_nr_bins,
+                                           sizeof(long long))) == NULL)
+    error("Failed to allocate the task profiler histograms.");
+
+  if (nodeID == 0) {
+    p->file = fopen(task_profiler_file_name, restart ? "a" : "w");
+    if (p->file == NULL)
+      error("Failed to open the task profiler file '%s'.",
+            task_profiler_file_name);
+    if (!restart) {
+      fprintf(p->file, "# Sampling one task every %d\n", p->every);
+      fprintf(p->file,
+              "# Histograms bin i counts the tasks that took from 2^i to "
+              "2^(i+1) ticks, at %llu ticks per second\n",
+              clocks_get_cpufreq());
+      fprintf(p->file, "# %6s %32s %12s %14s %14s %s\n", "Step", "Task",
+              "Samples", "Mean [ms]", "Mean count", "Histogram");
+    }
+  }
+}
+
+/**
+ * @brief Initialises the ring buffer of a runner.
+ *
+ * @param ring The #task_profiler_ring.
+ * @param p The #task_profiler.
+ * @param id The id of the runner, to seed the sampling.
+ */
+void task_profiler_ring_init(struct task_profiler_ring *ring,
+                             const struct task_profiler *p, int id) {
+
+  ring->nr_taken = 0;
+  ring->nr_collected = 0;
+  ring->seed = id + 1;
+  ring->countdown = (p->every > 0) ? 1 + rand_r(&ring->seed) % p->every : 0;
+}
+
+/**
+ * @brief Takes a sample of a task that has just been run and draws the
+ * number of tasks until the next one.
+ *
+ * The intervals are uniform between 1 and 2 * every - 1 such that the
+ * samples do not follow any regular pattern in the order of the tasks.
+ *
+ * @param ring The #task_profiler_ring of the runner.
+ * @param every The mean number of tasks between two samples.
+ * @param t The #task.
+ */
+void task_profiler_take(struct task_profiler_ring *ring, int every,
+                        const struct task *t) {
+
+  struct task_profiler_sample *sample =
+      &ring->samples[ring->nr_taken % task_profiler_ring_size];
+  sample->dt = t->toc - t->tic;
+  sample->type = t->type;
+  sample->subtype = t->subtype;
+
+  /* Count the particles the task works on. */
+  int count = 0;
+  for (int k = 0; k < 2; k++) {
+    const struct cell *c = (k == 0) ? t->ci : t->cj;
+    if (c == NULL) continue;
+    switch (task_get_category(t)) {
+      case task_category_gravity:
+        count += c->grav.count;
+        break;
+      case task_category_feedback:
+        count += c->stars.count;
+        break;
+      case task_category_black_holes:
+        count += c->black_holes.count;
+        break;
+      default:
+        count += c->hydro.count;
+    }
+  }
+  sample->count = count;
+
+  ring->nr_taken++;
+  ring->countdown = 1 + rand_r(&ring->seed) % (2 * every - 1);
+}
+
+/**
+ * @brief Adds the samples of all the runners to the histograms.
+ *
+ * Must be called when the runners are not running tasks.
+ *
+ * @param p The #task_profiler.
+ * @param runners The runners.
+ * @param nr_runners The number of runners.
+ */
+void task_profiler_collect(struct task_profiler *p, struct runner *runners,
+                           int nr_runners) {
+
+  for (int k = 0; k < nr_runners; k++) {
+    struct task_profiler_ring *ring = &runners[k].profiler_ring;
+
+    /* Skip the samples that have been overwritten. */
+    size_t first = ring->nr_collected;
+    if (ring->nr_taken - first > task_profiler_ring_size) {
+      p->nr_lost += ring->nr_taken - first - task_profiler_ring_size;
+      first = ring->nr_taken - task_profiler_ring_size;
+    }
+
+    for (size_t i = first; i < ring->nr_taken; i++) {
+      const struct task_profiler_sample *sample =
+          &ring->samples[i % task_profiler_ring_size];
+      const int ind = sample->type * task_subtype_count + sample->subtype;
+
+      int bin = (sample->dt > 0) ? 63 - __builtin_clzll(sample->dt) : 0;
+      if (bin >= task_profiler_nr_bins) bin = task_profiler_nr_bins - 1;
+
+      p->nr_samples[ind]++;
+      p->sum_ticks[ind] += sample->dt;
+      p->sum_counts[ind] += sample->count;
+      p->histograms[ind * task_profiler_nr_bins + bin]++;
+    }
+    ring->nr_collected = ring->nr_taken;
+  }
+}
+
+/**
+ * @brief Writes the histograms of all the ranks to the file and resets them.
+ *
+ * Collective over all the ranks.
+ *
+ * @param p The #task_profiler.
+ * @param step The current step.
+ * @param nodeID The rank of this node.
+ */
+void task_profiler_write(struct task_profiler *p, int step, int nodeID) {
+
+  const size_t size = task_type_count * task_subtype_count;
+
+#ifdef WITH_MPI
+  /* Sum the histograms of all the ranks on rank 0. */
+  int res = MPI_Reduce(nodeID == 0 ? MPI_IN_PLACE : p->nr_samples,
+                       p->nr_samples, size, MPI_LONG_LONG, MPI_SUM, 0,
+                       MPI_COMM_WORLD);
+  if (res == MPI_SUCCESS)
+    res = MPI_Reduce(nodeID == 0 ? MPI_IN_PLACE : p->sum_ticks, p->sum_ticks,
+                     size, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+  if (res == MPI_SUCCESS)
+    res = MPI_Reduce(nodeID == 0 ? MPI_IN_PLACE : p->sum_counts,
+                     p->sum_counts, size, MPI_DOUBLE, MPI_SUM, 0,
+                     MPI_COMM_WORLD);
+  if (res == MPI_SUCCESS)
+    res = MPI_Reduce(nodeID == 0 ? MPI_IN_PLACE : p->histograms,
+                     p->histograms, size * task_profiler_nr_bins,
+                     MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+  if (res == MPI_SUCCESS)
+    res = MPI_Reduce(nodeID == 0 ? MPI_IN_PLACE : &p->nr_lost, &p->nr_lost, 1,
+                     MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+  if (res != MPI_SUCCESS) mpi_error(res, "Failed to reduce task profiles.");
+#endif
+
+  if (nodeID == 0) {
+    for (size_t ind = 0; ind < size; ind++) {
+      if (p->nr_samples[ind] == 0) continue;
+
+      char name[64];
+      task_get_full_name(ind / task_subtype_count, ind % task_subtype_count,
+                         name);
+      const double mean_ticks = p->sum_ticks[ind] / p->nr_samples[ind];
+      fprintf(p->file, "  %6d %32s %12lld %14.6f %14.1f", step, name,
+              p->nr_samples[ind], clocks_from_ticks((ticks)mean_ticks),
+              p->sum_counts[ind] / p->nr_samples[ind]);
+      for (int bin = 0; bin < task_profiler_nr_bins; bin++)
+        fprintf(p->file, " %lld",
+                p->histograms[ind * task_profiler_nr_bins + bin]);
+      fprintf(p->file, "\n");
+    }
+    if (p->nr_lost > 0)
+      fprintf(p->file, "# Step %d: %lld samples lost, full buffers\n", step,
+              p->nr_lost);
+    fflush(p->file);
+  }
+
+  /* And start again. */
+  memset(p->nr_samples, 0, size * sizeof(long long));
+  memset(p->sum_ticks, 0, size * sizeof(double));
+  memset(p->sum_counts, 0, size * sizeof(double));
+  memset(p->histograms, 0, size * task_profiler_nr_bins * sizeof(long long));
+  p->nr_lost = 0;
+}
+
+/**
+ * @brief Frees the memory of the #task_profiler and closes its file.
+ *
+ * @param p The #task_profiler.
+ */
+void task_profiler_clean(struct task_profiler *p) {
+
+  free(p->nr_samples);
+  free(p->sum_ticks);
+  free(p->sum_counts);
+  free(p->histograms);
+  if (p->file != NULL) fclose(p->file);
+  p->nr_samples = NULL;
+  p->sum_ticks = NULL;
+  p->sum_counts = NULL;
+  p->histograms = NULL;
+  p->file = NULL;
+}
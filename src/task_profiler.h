@@ -0,0 +1,136 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#ifndef SWIFT_TASK_PROFILER_H
+#define SWIFT_TASK_PROFILER_H
+
+/* Config parameters. */
+#include "../config.h"
+
+/* Some standard headers. */
+#include <stddef.h>
+#include <stdio.h>
+
+/* Local headers */
+#include "cycle.h"
+#include "inline.h"
+
+/* Pre-declarations */
+struct runner;
+struct swift_params;
+struct task;
+
+/*! Number of samples a runner can hold between two collections */
+#define task_profiler_ring_size 512
+
+/*! Number of bins of the histograms, the ith one holds the samples that
+ * took between 2^i and 2^(i+1) ticks */
+#define task_profiler_nr_bins 40
+
+/*! Name of the file the histograms are written to */
+#define task_profiler_file_name "task_profile.txt"
+
+/**
+ * @brief The cost of a sampled task.
+ */
+struct task_profiler_sample {
+
+  /*! Ticks the task took */
+  ticks dt;
+
+  /*! Number of particles in the cells of the task */
+  int count;
+
+  /*! Type and subtype of the task */
+  short int type, subtype;
+};
+
+/**
+ * @brief The samples taken by a runner, in a ring buffer.
+ *
+ * Only the runner writes to its ring while the tasks run, the samples are
+ * collected once the runners are done. When more samples are taken than the
+ * ring holds, the oldest ones are lost.
+ */
+struct task_profiler_ring {
+
+  /*! The samples */
+  struct task_profiler_sample samples[task_profiler_ring_size];
+
+  /*! Number of samples taken and collected so far */
+  size_t nr_taken, nr_collected;
+
+  /*! Number of tasks to run before the next sample */
+  int countdown;
+
+  /*! Seed of the random intervals between the samples */
+  unsigned int seed;
+};
+
+/**
+ * @brief The histograms of the sampled costs of each type of task.
+ */
+struct task_profiler {
+
+  /*! Sample one task every this many on average, 0 to not sample */
+  int every;
+
+  /*! Number of steps between two writes of the histograms */
+  int write_steps;
+
+  /*! Number of samples of each type and subtype */
+  long long *nr_samples;
+
+  /*! Sums of the ticks and the particle counts of the samples */
+  double *sum_ticks, *sum_counts;
+
+  /*! Histograms of the ticks of the samples of each type and subtype */
+  long long *histograms;
+
+  /*! Number of samples lost as the rings were full */
+  long long nr_lost;
+
+  /*! The output file, only on rank 0 */
+  FILE *file;
+};
+
+void task_profiler_init(struct task_profiler *p, struct swift_params *params,
+                        int nodeID, int restart);
+void task_profiler_ring_init(struct task_profiler_ring *ring,
+                             const struct task_profiler *p, int id);
+void task_profiler_take(struct task_profiler_ring *ring, int every,
+                        const struct task *t);
+void task_profiler_collect(struct task_profiler *p, struct runner *runners,
+                           int nr_runners);
+void task_profiler_write(struct task_profiler *p, int step, int nodeID);
+void task_profiler_clean(struct task_profiler *p);
+
+/**
+ * @brief Sample a task that has just been run, once every few.
+ *
+ * @param ring The #task_profiler_ring of the runner.
+ * @param every The mean number of tasks between two samples, 0 for none.
+ * @param t The #task.
+ */
+__attribute__((always_inline)) INLINE static void task_profiler_sample(
+    struct task_profiler_ring *ring, const int every, const struct task *t) {
+
+  if (every > 0 && --ring->countdown <= 0) task_profiler_take(ring, every, t);
+}
+
+#endif /* SWIFT_TASK_PROFILER_H */
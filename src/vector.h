@@ -474,6 +474,25 @@ __attribute__((always_inline)) INLINE vector vector_load(float *const x) {
   return temp;
 }
 
+/**
+ * @brief Returns a new vector with data loaded from a memory address in the
+ * lanes of a mask and a given value in the other lanes.
+ *
+ * Used to keep the masked-out lanes of an interaction finite.
+ *
+ * @param x memory address to load from.
+ * @param mask The lanes to load.
+ * @param fill The value to put in the other lanes.
+ * @return Loaded #vector.
+ */
+__attribute__((always_inline)) INLINE vector
+vector_load_masked(float *const x, const mask_t mask, const float fill) {
+
+  vector temp;
+  temp.v = vec_blend(mask, vec_set1(fill), vec_load(x));
+  return temp;
+}
+
 /**
  * @brief Returns a vector filled with one value.
  *
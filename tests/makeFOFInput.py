@@ -0,0 +1,84 @@
+###############################################################################
+ # This file is part of SWIFT.
+ # Copyright (c) 2026 agent (agent@local)
+ # 
+ # This program is free software: you can redistribute it and/or modify
+ # it under the terms of the GNU Lesser General Public License as published
+ # by the Free Software Foundation, either version 3 of the License, or
+ # (at your option) any later version.
+ # 
+ # This program is distributed in the hope that it will be useful,
+ # but WITHOUT ANY WARRANTY; without even the implied warranty of
+ # MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ # GNU General Public License for more details.
+ # 
+ # You should have received a copy of the GNU Lesser General Public License
+ # along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ # 
+ ##############################################################################
+
+import h5py
+from numpy import *
+
+# Generates a swift IC file containing clumps of dark matter particles of
+# various sizes and extents on top of a uniform background, such that many
+# FoF groups span several MPI domains
+
+# Parameters
+boxSize = 1.
+numBackground = 8000   # Number of particles in the background
+numClumps = 60         # Number of clumps
+fileName = "fof_input.hdf5"
+
+#---------------------------------------------------
+random.seed(1234)
+
+coords = [random.random((numBackground, 3)) * boxSize]
+for i in range(numClumps):
+    n = random.randint(10, 1000)
+    centre = random.random(3) * boxSize
+    sigma = 0.005 + 0.04 * random.random()
+    coords.append(centre + random.normal(0., sigma, (n, 3)))
+
+coords = concatenate(coords) % boxSize
+numPart = size(coords, 0)
+v = zeros((numPart, 3))
+m = ones((numPart, 1)) / numPart
+ids = linspace(1, numPart, numPart).reshape((numPart, 1))
+
+#--------------------------------------------------
+
+#File
+file = h5py.File(fileName, 'w')
+
+# Header
+grp = file.create_group("/Header")
+grp.attrs["BoxSize"] = boxSize
+grp.attrs["NumPart_Total"] =  [0, numPart, 0, 0, 0, 0]
+grp.attrs["NumPart_Total_HighWord"] = [0, 0, 0, 0, 0, 0]
+grp.attrs["NumPart_ThisFile"] = [0, numPart, 0, 0, 0, 0]
+grp.attrs["Time"] = 0.0
+grp.attrs["NumFilesPerSnapshot"] = 1
+grp.attrs["MassTable"] = [0.0, 0.0, 0.0, 0.0, 0.0, 0.0]
+grp.attrs["Flag_Entropy_ICs"] = [0, 0, 0, 0, 0, 0]
+
+#Units
+grp = file.create_group("/Units")
+grp.attrs["Unit length in cgs (U_L)"] = 1.
+grp.attrs["Unit mass in cgs (U_M)"] = 1.
+grp.attrs["Unit time in cgs (U_t)"] = 1.
+grp.attrs["Unit current in cgs (U_I)"] = 1.
+grp.attrs["Unit temperature in cgs (U_T)"] = 1.
+
+#Particle group
+grp = file.create_group("/PartType1")
+ds = grp.create_dataset('Coordinates', (numPart, 3), 'd')
+ds[()] = coords
+ds = grp.create_dataset('Velocities', (numPart, 3), 'f')
+ds[()] = v
+ds = grp.create_dataset('Masses', (numPart,1), 'f')
+ds[()] = m
+ds = grp.create_dataset('ParticleIDs', (numPart, 1), 'L')
+ds[()] = ids
+
+file.close()
@@ -264,7 +264,10 @@ struct cell *make_cell(size_t n, const double offset[3], double size, double h,
 
   const size_t count = n * n * n;
   const double volume = size * size * size;
-  struct cell *cell = (struct cell *)malloc(sizeof(struct cell));
+  struct cell *cell = NULL;
+  if (posix_memalign((void **)&cell, SWIFT_STRUCT_ALIGNMENT,
+                     sizeof(struct cell)) != 0)
+    error("couldn't allocate cell");
   bzero(cell, sizeof(struct cell));
 
   if (posix_memalign((void **)&cell->hydro.parts, part_align,
@@ -618,6 +621,7 @@ int main(int argc, char *argv[]) {
 
   struct runner runner;
   runner.e = &engine;
+  runner_arena_init(&runner.arena, runner_arena_initial_size);
 
   /* Construct some cells */
   struct cell *cells[125];
@@ -976,6 +980,7 @@ int main(int argc, char *argv[]) {
   cache_clean(&runner.ci_cache);
   cache_clean(&runner.cj_cache);
 #endif
+  runner_arena_clean(&runner.arena);
 
   return 0;
 }
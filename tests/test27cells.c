@@ -98,7 +98,10 @@ struct cell *make_cell(size_t n, double *offset, double size, double h,
   const size_t count = n * n * n;
   const double volume = size * size * size;
   float h_max = 0.f;
-  struct cell *cell = (struct cell *)malloc(sizeof(struct cell));
+  struct cell *cell = NULL;
+  if (posix_memalign((void **)&cell, SWIFT_STRUCT_ALIGNMENT,
+                     sizeof(struct cell)) != 0)
+    error("couldn't allocate cell");
   bzero(cell, sizeof(struct cell));
 
   if (posix_memalign((void **)&cell->hydro.parts, part_align,
@@ -489,6 +492,7 @@ int main(int argc, char *argv[]) {
 
   struct runner runner;
   runner.e = &engine;
+  runner_arena_init(&runner.arena, runner_arena_initial_size);
 
   /* Construct some cells */
   struct cell *cells[27];
@@ -632,6 +636,7 @@ int main(int argc, char *argv[]) {
   cache_clean(&runner.ci_cache);
   cache_clean(&runner.cj_cache);
 #endif
+  runner_arena_clean(&runner.arena);
 
   return 0;
 }
@@ -71,7 +71,10 @@ struct cell *make_cell(size_t n, size_t n_stars, double *offset, double size,
   const size_t scount = n_stars * n_stars * n_stars;
   float h_max = 0.f;
   float stars_h_max = 0.f;
-  struct cell *cell = (struct cell *)malloc(sizeof(struct cell));
+  struct cell *cell = NULL;
+  if (posix_memalign((void **)&cell, SWIFT_STRUCT_ALIGNMENT,
+                     sizeof(struct cell)) != 0)
+    error("couldn't allocate cell");
   bzero(cell, sizeof(struct cell));
 
   if (posix_memalign((void **)&cell->hydro.parts, part_align,
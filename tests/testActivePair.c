@@ -60,7 +60,10 @@ struct cell *make_cell(size_t n, double *offset, double size, double h,
   const size_t count = n * n * n;
   const double volume = size * size * size;
   float h_max = 0.f;
-  struct cell *cell = (struct cell *)malloc(sizeof(struct cell));
+  struct cell *cell = NULL;
+  if (posix_memalign((void **)&cell, SWIFT_STRUCT_ALIGNMENT,
+                     sizeof(struct cell)) != 0)
+    error("couldn't allocate cell");
   bzero(cell, sizeof(struct cell));
 
   if (posix_memalign((void **)&cell->hydro.parts, part_align,
@@ -594,6 +597,7 @@ int main(int argc, char *argv[]) {
   }
 
   runner->e = &engine;
+  runner_arena_init(&runner->arena, runner_arena_initial_size);
 
   /* Create output file names. */
   sprintf(swiftOutputFileName, "swift_dopair_%.150s.dat",
@@ -686,5 +690,8 @@ int main(int argc, char *argv[]) {
                              perturbation, h_pert, swiftOutputFileName,
                              bruteForceOutputFileName, serial_inter_func,
                              vec_inter_func, init, finalise);
+
+  runner_arena_clean(&runner->arena);
+  free(runner);
   return 0;
 }
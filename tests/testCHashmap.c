@@ -0,0 +1,109 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+/* Config parameters. */
+#include "../config.h"
+
+#include <fenv.h>
+
+/* Local headers. */
+#include "swift.h"
+
+#define NUM_KEYS (4 * 1000 * 1000)
+#define NUM_HITS 3
+
+/* Each key is inserted NUM_HITS times, from different chunks */
+void insert_mapper(void *map_data, int num_elements, void *extra_data) {
+
+  struct chashmap *m = (struct chashmap *)extra_data;
+  const size_t *first = (const size_t *)map_data;
+
+  for (int i = 0; i < num_elements; i++) {
+    const chashmap_key_t key = first[i] % NUM_KEYS;
+    size_t *value = (size_t *)chashmap_get(m, key * 7919);
+    atomic_inc(value);
+  }
+}
+
+void check_mapper(chashmap_key_t key, void *value, void *data) {
+
+  if (*(size_t *)value != NUM_HITS)
+    error("Incorrect value (%zu) found for key: %zu", *(size_t *)value, key);
+  atomic_inc((size_t *)data);
+}
+
+int main(int argc, char *argv[]) {
+
+  /* Initialize CPU frequency, this also starts time. */
+  unsigned long long cpufreq = 0;
+  clocks_set_cpufreq(cpufreq);
+
+/* Choke on FPEs */
+#ifdef HAVE_FE_ENABLE_EXCEPT
+  feenableexcept(FE_DIVBYZERO | FE_INVALID | FE_OVERFLOW);
+#endif
+
+  struct threadpool tp;
+  threadpool_init(&tp, 4);
+
+  size_t *indices = (size_t *)malloc(NUM_HITS * NUM_KEYS * sizeof(size_t));
+  for (size_t i = 0; i < NUM_HITS * NUM_KEYS; i++) indices[i] = i;
+
+  struct chashmap m;
+
+  message("Initialising hash table...");
+  chashmap_init(&m, NUM_KEYS, sizeof(size_t));
+
+  message("Populating hash table from 4 threads...");
+  threadpool_map(&tp, insert_mapper, indices, NUM_HITS * NUM_KEYS,
+                 sizeof(size_t), threadpool_auto_chunk_size, &m);
+
+  message("Checking hash table size...");
+  if (chashmap_size(&m) != NUM_KEYS)
+    error(
+        "The no. of elements stored in the hash table are not equal to the no. "
+        "of keys. No. of elements: %zu, no. of keys: %d",
+        chashmap_size(&m), NUM_KEYS);
+
+  message("Retrieving elements from the hash table...");
+  for (chashmap_key_t key = 0; key < NUM_KEYS; key++) {
+    const size_t *value = (const size_t *)chashmap_lookup(&m, key * 7919);
+    if (value == NULL) error("Key: %zu not found.", key * 7919);
+    if (*value != NUM_HITS)
+      error("Incorrect value (%zu) found for key: %zu", *value, key * 7919);
+  }
+
+  message("Checking for invalid key...");
+  const chashmap_key_t absent_key = (chashmap_key_t)7919 * NUM_KEYS + 1;
+  if (chashmap_lookup(&m, absent_key) != NULL)
+    error("Key: %zu shouldn't exist.", absent_key);
+
+  message("Iterating over the hash table...");
+  size_t count = 0;
+  chashmap_iterate_parallel(&m, &tp, check_mapper, &count);
+  if (count != NUM_KEYS)
+    error("Iterated over %zu elements instead of %d.", count, NUM_KEYS);
+
+  message("Freeing hash table...");
+  chashmap_free(&m);
+  free(indices);
+  threadpool_clean(&tp);
+
+  return 0;
+}
@@ -0,0 +1,72 @@
+###############################################################################
+ # This file is part of SWIFT.
+ # Copyright (c) 2026 agent (agent@local)
+ # 
+ # This program is free software: you can redistribute it and/or modify
+ # it under the terms of the GNU Lesser General Public License as published
+ # by the Free Software Foundation, either version 3 of the License, or
+ # (at your option) any later version.
+ # 
+ # This program is distributed in the hope that it will be useful,
+ # but WITHOUT ANY WARRANTY; without even the implied warranty of
+ # MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ # GNU General Public License for more details.
+ # 
+ # You should have received a copy of the GNU Lesser General Public License
+ # along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ # 
+ ##############################################################################
+
+# Checks that two runs of the stand-alone FoF found exactly the same groups.
+# Over MPI, the groups are labeled by decreasing size within each rank, so the
+# labels depend on the decomposition of the domain and on which rank holds the
+# root of each group; by default, only the partition of the particles into
+# groups has to be the same. With --same-ids, the group IDs must also be the
+# same, which is the case for runs on the same number of ranks.
+# Usage: python testFOF.py <reference snapshot> <snapshot to check> [--same-ids]
+
+import sys
+import h5py
+from numpy import *
+
+
+def read_groups(fileName):
+    f = h5py.File(fileName, "r")
+    ids = f["/PartType1/ParticleIDs"][:]
+    groups = f["/PartType1/FOFGroupIDs"][:]
+    f.close()
+    return groups[argsort(ids)]
+
+
+ref = read_groups(sys.argv[1])
+test = read_groups(sys.argv[2])
+same_ids = len(sys.argv) > 3 and sys.argv[3] == "--same-ids"
+
+if size(ref) != size(test):
+    print("Different number of particles: %d vs. %d" % (size(ref), size(test)))
+    exit(1)
+
+num_groups = size(unique(ref))
+print("Found %d groups (including the default ID)" % num_groups)
+
+# The particles must be grouped the same way: every group of one run must
+# correspond to exactly one group of the other
+pairs = unique(stack((ref, test)), axis=1)
+if size(unique(test)) != num_groups or size(pairs, 1) != num_groups:
+    print("The groups differ between the two runs!")
+    exit(1)
+
+# The particles in no group must be the same
+if any((ref == max(ref)) != (test == max(test))):
+    print("The particles in no group differ between the two runs!")
+    exit(1)
+
+# And the group IDs themselves if requested
+if same_ids and any(ref != test):
+    print(
+        "The group IDs of %d particles differ between the two runs!"
+        % count_nonzero(ref != test)
+    )
+    exit(1)
+
+print("Test passed")
@@ -247,6 +247,72 @@ int main(int argc, char *argv[]) {
           SELF_GRAVITY_MULTIPOLE_ORDER,
           (int)(1e6 * clocks_from_ticks(toc - tic) / num_M2L_runs), "ns");
 
+  /* Now run the same interactions through a batch, all of them into the same
+   * field tensor */
+  struct gravity_M2L_batch batch;
+  gravity_M2L_batch_init(&batch);
+
+  /********
+   * Batched non-periodic M2L
+   ********/
+  struct grav_tensor l_batch;
+  gravity_field_tensors_init(&l_batch, 0);
+  tic = getticks();
+  gravity_M2L_batch_begin(&batch, tensors_i[0].CoM, /* periodic=*/0, dim,
+                          r_s_inv);
+  for (int n = 0; n < num_M2L_runs; ++n) {
+
+    gravity_M2L_batch_add(&batch, &tensors_j[n].m_pole, tensors_j[n].CoM);
+  }
+  gravity_M2L_batch_end(&batch, &l_batch);
+  toc = getticks();
+  message("%30s at order %d took %4d %s.", "Batched non-periodic M2L",
+          SELF_GRAVITY_MULTIPOLE_ORDER,
+          (int)(1e6 * clocks_from_ticks(toc - tic) / num_M2L_runs), "ns");
+
+  /********
+   * Batched periodic M2L
+   ********/
+  tic = getticks();
+  gravity_M2L_batch_begin(&batch, tensors_i[0].CoM, /* periodic=*/1, dim,
+                          r_s_inv);
+  for (int n = 0; n < num_M2L_runs; ++n) {
+
+    gravity_M2L_batch_add(&batch, &tensors_j[n].m_pole, tensors_j[n].CoM);
+  }
+  gravity_M2L_batch_end(&batch, &l_batch);
+  toc = getticks();
+  message("%30s at order %d took %4d %s.", "Batched periodic M2L",
+          SELF_GRAVITY_MULTIPOLE_ORDER,
+          (int)(1e6 * clocks_from_ticks(toc - tic) / num_M2L_runs), "ns");
+
+  /* Check the batch against the pair-by-pair M2L on a few interactions */
+  for (int periodic = 0; periodic < 2; ++periodic) {
+
+    struct grav_tensor l_pair;
+    gravity_field_tensors_init(&l_pair, 0);
+    gravity_field_tensors_init(&l_batch, 0);
+    gravity_M2L_batch_begin(&batch, tensors_i[0].CoM, periodic, dim, r_s_inv);
+    for (int n = 0; n < 1000; ++n) {
+
+      gravity_M2L_nonsym(&l_pair, &tensors_j[n].m_pole, tensors_i[0].CoM,
+                         tensors_j[n].CoM, &grav_props, periodic, dim,
+                         r_s_inv);
+      gravity_M2L_batch_add(&batch, &tensors_j[n].m_pole, tensors_j[n].CoM);
+    }
+    gravity_M2L_batch_end(&batch, &l_batch);
+
+    if (fabsf(l_batch.F_000 - l_pair.F_000) > 1e-4f * fabsf(l_pair.F_000))
+      error("Batched M2L differs from the pair-by-pair M2L: %e != %e",
+            l_batch.F_000, l_pair.F_000);
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 0
+    if (fabsf(l_batch.F_100 - l_pair.F_100) > 1e-4f * fabsf(l_pair.F_100))
+      error("Batched M2L differs from the pair-by-pair M2L: %e != %e",
+            l_batch.F_100, l_pair.F_100);
+#endif
+  }
+  gravity_M2L_batch_clean(&batch);
+
   /* Now run a series of M2L kernels */
 
   /********
@@ -0,0 +1,249 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#include "../config.h"
+
+/* Test the double-precision multipoles and field tensors whatever the
+ * configuration. Only the inline functions of the headers are used, so the
+ * layout of the structures does not need to match the library's. */
+#ifndef SWIFT_GRAVITY_DOUBLE_TENSORS
+#define SWIFT_GRAVITY_DOUBLE_TENSORS 1
+#endif
+
+/* Some standard headers. */
+#include <fenv.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Local headers. */
+#include "swift.h"
+
+/* Number of contributions summed by each operation */
+#define NUM_INTERACTIONS 200000
+
+/**
+ * @brief Relative error of a sum with respect to a reference.
+ */
+static double rel_error(const double sum, const double ref) {
+  return fabs(sum - ref) / fabs(ref);
+}
+
+/**
+ * @brief Random number in [0, 1].
+ */
+static double rand_unit(void) { return rand() / ((double)RAND_MAX); }
+
+/**
+ * @brief Random position in a shell between 10 and 20 around the origin.
+ */
+static void rand_shell(double pos[3]) {
+  const double r = 10. + 10. * rand_unit();
+  const double cos_theta = 2. * rand_unit() - 1.;
+  const double sin_theta = sqrt(1. - cos_theta * cos_theta);
+  const double phi = 2. * M_PI * rand_unit();
+  pos[0] = r * sin_theta * cos(phi);
+  pos[1] = r * sin_theta * sin(phi);
+  pos[2] = r * cos_theta;
+}
+
+/**
+ * @brief Compares the sum of some contributions accumulated in double by the
+ * gravity functions and in float, as they would be without the
+ * double-precision tensors, to a reference.
+ *
+ * @param name The name of the component, for the messages.
+ * @param sum_double The sum accumulated by the gravity functions.
+ * @param sum_float The same contributions summed in float.
+ * @param ref The reference sum of the contributions.
+ * @param same_sign Do all the contributions have the same sign? The sum is
+ * then well conditioned and only limited by the precision of the sums, which
+ * we check. The other sums are only reported.
+ *
+ * The float sums are only reported as their error is a random walk that can
+ * end close to zero by chance. The double sums must be well below the
+ * typical float error of NUM_INTERACTIONS terms (~1e-5).
+ */
+static void check_sum(const char *name, const double sum_double,
+                      const float sum_float, const double ref,
+                      const int same_sign) {
+
+  const double err_double = rel_error(sum_double, ref);
+  const double err_float = rel_error(sum_float, ref);
+
+  message("%s: float sums rel. error = %e, double sums rel. error = %e", name,
+          err_float, err_double);
+
+  if (!same_sign) return;
+
+  if (err_double > 1e-6)
+    error("%s: double-precision sums not accurate enough: %e", name,
+          err_double);
+}
+
+int main(int argc, char *argv[]) {
+
+  /* Initialize CPU frequency, this also starts time. */
+  unsigned long long cpufreq = 0;
+  clocks_set_cpufreq(cpufreq);
+
+/* Choke on FPEs */
+#ifdef HAVE_FE_ENABLE_EXCEPT
+  feenableexcept(FE_DIVBYZERO | FE_INVALID | FE_OVERFLOW);
+#endif
+
+  /* Get some randomness going */
+  const int seed = time(NULL);
+  message("Seed = %d", seed);
+  srand(seed);
+
+  const double pos_b[3] = {0., 0., 0.};
+  const double dim[3] = {0., 0., 0.};
+  struct gravity_props props;
+  bzero(&props, sizeof(struct gravity_props));
+
+  /* Batched M2L, as done by the long-range tasks, and pair M2L, as done by
+   * the mm tasks */
+  struct gravity_M2L_batch batch;
+  gravity_M2L_batch_init(&batch);
+  gravity_M2L_batch_begin(&batch, pos_b, /*periodic=*/0, dim,
+                          /*r_s_inv=*/0.f);
+
+  struct grav_tensor l_pair;
+  bzero(&l_pair, sizeof(struct grav_tensor));
+
+  float float_000 = 0.f, float_100 = 0.f;
+  double ref_000 = 0., ref_100 = 0.;
+
+  for (int i = 0; i < NUM_INTERACTIONS; ++i) {
+
+    /* A point mass in a shell around the tensor */
+    double pos_a[3];
+    rand_shell(pos_a);
+
+    struct multipole m;
+    bzero(&m, sizeof(struct multipole));
+    m.M_000 = 0.5 + rand_unit();
+
+    gravity_M2L_batch_add(&batch, &m, pos_a);
+    gravity_M2L_nonsym(&l_pair, &m, pos_b, pos_a, &props, /*periodic=*/0, dim,
+                       /*rs_inv=*/0.f);
+
+    /* Contribution of this interaction alone */
+    struct grav_tensor l_i;
+    bzero(&l_i, sizeof(struct grav_tensor));
+    gravity_M2L_nonsym(&l_i, &m, pos_b, pos_a, &props, /*periodic=*/0, dim,
+                       /*rs_inv=*/0.f);
+
+    ref_000 += l_i.F_000;
+    ref_100 += l_i.F_100;
+    float_000 += (float)l_i.F_000;
+    float_100 += (float)l_i.F_100;
+  }
+
+  struct grav_tensor l_batch;
+  bzero(&l_batch, sizeof(struct grav_tensor));
+  gravity_M2L_batch_end(&batch, &l_batch);
+  gravity_M2L_batch_clean(&batch);
+
+  check_sum("Batched M2L F_000", l_batch.F_000, float_000, ref_000, 1);
+  check_sum("Batched M2L F_100", l_batch.F_100, float_100, ref_100, 0);
+  check_sum("Pair M2L F_000", l_pair.F_000, float_000, ref_000, 1);
+  check_sum("Pair M2L F_100", l_pair.F_100, float_100, ref_100, 0);
+
+  /* M2M of many progenies into the same multipole */
+  struct multipole m_sum;
+  bzero(&m_sum, sizeof(struct multipole));
+
+  float_000 = 0.f;
+  ref_000 = 0.;
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 1
+  float float_200 = 0.f;
+  double ref_200 = 0.;
+#endif
+
+  for (int i = 0; i < NUM_INTERACTIONS; ++i) {
+
+    double pos_a[3];
+    rand_shell(pos_a);
+
+    struct multipole m;
+    bzero(&m, sizeof(struct multipole));
+    m.M_000 = 0.5 + rand_unit();
+
+    struct multipole m_shifted;
+    gravity_M2M(&m_shifted, &m, pos_b, pos_a);
+    gravity_multipole_add(&m_sum, &m_shifted);
+
+    ref_000 += m_shifted.M_000;
+    float_000 += (float)m_shifted.M_000;
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 1
+    ref_200 += m_shifted.M_200;
+    float_200 += (float)m_shifted.M_200;
+#endif
+  }
+
+  check_sum("M2M M_000", m_sum.M_000, float_000, ref_000, 1);
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 1
+  check_sum("M2M M_200", m_sum.M_200, float_200, ref_200, 1);
+#endif
+
+  /* L2L of many field tensors added to the same one */
+  struct grav_tensor l_sum;
+  bzero(&l_sum, sizeof(struct grav_tensor));
+
+  float_000 = 0.f;
+  float_100 = 0.f;
+  ref_000 = 0.;
+  ref_100 = 0.;
+
+  for (int i = 0; i < NUM_INTERACTIONS; ++i) {
+
+    double pos_a[3];
+    rand_shell(pos_a);
+
+    /* The field tensor of a point mass at the origin */
+    struct multipole m;
+    bzero(&m, sizeof(struct multipole));
+    m.M_000 = 0.5 + rand_unit();
+
+    struct grav_tensor l_a;
+    bzero(&l_a, sizeof(struct grav_tensor));
+    gravity_M2L_nonsym(&l_a, &m, pos_a, pos_b, &props, /*periodic=*/0, dim,
+                       /*rs_inv=*/0.f);
+
+    /* Shifted by a small offset */
+    const double pos_c[3] = {pos_a[0] + 0.1 * rand_unit(),
+                             pos_a[1] + 0.1 * rand_unit(),
+                             pos_a[2] + 0.1 * rand_unit()};
+    struct grav_tensor l_c;
+    gravity_L2L(&l_c, &l_a, pos_c, pos_a);
+    gravity_field_tensors_add(&l_sum, &l_c);
+
+    ref_000 += l_c.F_000;
+    ref_100 += l_c.F_100;
+    float_000 += (float)l_c.F_000;
+    float_100 += (float)l_c.F_100;
+  }
+
+  check_sum("L2L F_000", l_sum.F_000, float_000, ref_000, 1);
+  check_sum("L2L F_100", l_sum.F_100, float_100, ref_100, 0);
+
+  return 0;
+}
@@ -113,8 +113,84 @@ int main(int argc, char* argv[]) {
 
       check_value(swift_corr_pot_lr, corr_pot, "corr_pot", 3.4e-3, r, r_s);
       check_value(swift_corr_f_lr, corr_f, "corr_f", 2.4e-4, r, r_s);
+
+      /* And the tabulated ones */
+      float table_corr_f_lr, table_corr_pot_lr;
+      kernel_long_grav_eval_table(r / r_s, &table_corr_f_lr,
+                                  &table_corr_pot_lr);
+
+      check_value(table_corr_pot_lr, corr_pot, "table corr_pot", 3e-5, r, r_s);
+      check_value(table_corr_f_lr, corr_f, "table corr_f", 3e-5, r, r_s);
     }
   }
 
+  /* Now time the different versions of the truncation, on arrays that fit
+   * in the cache */
+  const int num_evals = 1 << 12;
+  const int num_reps = 1 << 10;
+  float *u = (float *)malloc(num_evals * sizeof(float));
+  float *corr_f = (float *)malloc(num_evals * sizeof(float));
+  float *corr_pot = (float *)malloc(num_evals * sizeof(float));
+  if (u == NULL || corr_f == NULL || corr_pot == NULL)
+    error("Impossible to allocate memory for the benchmark.");
+
+  /* Over the range of the truncated P2P interactions */
+  for (int i = 0; i < num_evals; ++i) {
+    u[i] = 6. * rand() / ((double)RAND_MAX);
+    corr_f[i] = 0.f;
+    corr_pot[i] = 0.f;
+  }
+
+  /* Both terms, as in the P2P with the potential, then the force alone */
+  const int num_versions = 5;
+  const char *names[5] = {"kernel_long_grav_eval()",
+                          "kernel_long_grav_eval_table()", "erfcf()",
+                          "kernel_long_grav_eval() force",
+                          "kernel_long_grav_eval_table() force"};
+
+  for (int version = 0; version < num_versions; ++version) {
+
+    const ticks tic = getticks();
+
+    for (int rep = 0; rep < num_reps; ++rep) {
+      if (version == 0) {
+        for (int i = 0; i < num_evals; ++i)
+          kernel_long_grav_eval(u[i], &corr_f[i], &corr_pot[i]);
+      } else if (version == 1) {
+        for (int i = 0; i < num_evals; ++i)
+          kernel_long_grav_eval_table(u[i], &corr_f[i], &corr_pot[i]);
+      } else if (version == 2) {
+        for (int i = 0; i < num_evals; ++i) {
+          const float x = 0.5f * u[i];
+          corr_pot[i] = erfcf(x);
+          corr_f[i] = corr_pot[i] + ((float)M_2_SQRTPI) * x * expf(-x * x);
+        }
+      } else if (version == 3) {
+        for (int i = 0; i < num_evals; ++i) {
+          float dummy;
+          kernel_long_grav_eval(u[i], &corr_f[i], &dummy);
+        }
+      } else {
+        for (int i = 0; i < num_evals; ++i) {
+          float dummy;
+          kernel_long_grav_eval_table(u[i], &corr_f[i], &dummy);
+        }
+      }
+    }
+
+    const ticks toc = getticks();
+
+    /* Use the results such that the loops are not optimised out */
+    double sum = 0.;
+    for (int i = 0; i < num_evals; ++i) sum += corr_f[i] + corr_pot[i];
+
+    message("%36s took %6.3f ns per call (sum=%e).", names[version],
+            clocks_from_ticks(toc - tic) * 1e6 / num_evals / num_reps, sum);
+  }
+
+  free(u);
+  free(corr_f);
+  free(corr_pot);
+
   return 0;
 }
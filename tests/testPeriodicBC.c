@@ -496,6 +496,7 @@ int main(int argc, char *argv[]) {
   struct runner real_runner;
   struct runner *runner = &real_runner;
   runner->e = &engine;
+  runner_arena_init(&runner->arena, runner_arena_initial_size);
 
   struct cosmology cosmo;
   cosmology_init_no_cosmo(&cosmo);
@@ -596,6 +597,7 @@ int main(int argc, char *argv[]) {
 
   /* Clean things to make the sanitizer happy ... */
   for (int i = 0; i < dim * dim * dim; ++i) clean_up(cells[i]);
+  runner_arena_clean(&runner->arena);
 
   return 0;
 }
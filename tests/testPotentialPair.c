@@ -262,6 +262,10 @@ int main(int argc, char *argv[]) {
   /* Reset the accelerations */
   for (int n = 0; n < num_tests; ++n) gravity_init_gpart(&cj.grav.parts[n]);
 
+  /* The particles are changed below, drop the copies of the old ones */
+  cell_free_grav_cache(&ci);
+  cell_free_grav_cache(&cj);
+
   /**********************************/
   /* Test the basic PM interactions */
   /**********************************/
@@ -309,6 +313,10 @@ int main(int argc, char *argv[]) {
   /* Reset the accelerations */
   for (int n = 0; n < num_tests; ++n) gravity_init_gpart(&cj.grav.parts[n]);
 
+  /* The particles are changed below, drop the copies of the old ones */
+  cell_free_grav_cache(&ci);
+  cell_free_grav_cache(&cj);
+
   /***************************************/
   /* Test the truncated PM interactions  */
   /***************************************/
@@ -354,6 +362,10 @@ int main(int argc, char *argv[]) {
   /* Reset the accelerations */
   for (int n = 0; n < num_tests; ++n) gravity_init_gpart(&cj.grav.parts[n]);
 
+  /* The particles are changed below, drop the copies of the old ones */
+  cell_free_grav_cache(&ci);
+  cell_free_grav_cache(&cj);
+
 #if SELF_GRAVITY_MULTIPOLE_ORDER >= 3
 
   /* Let's make ci more interesting */
@@ -446,6 +458,8 @@ int main(int argc, char *argv[]) {
 
 #endif
 
+  cell_free_grav_cache(&ci);
+  cell_free_grav_cache(&cj);
   free(ci.grav.multipole);
   free(cj.grav.multipole);
   free(ci.grav.parts);
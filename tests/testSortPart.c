@@ -0,0 +1,212 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+/* Config parameters. */
+#include "../config.h"
+
+/* Standard includes. */
+#include <fenv.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Local includes */
+#include "sort_part.h"
+#include "swift.h"
+
+/* Largest list we sort */
+#define MAX_ENTRIES 20000
+
+/* Number of random lists of each kind */
+#define NUM_LISTS 50
+
+/**
+ * @brief Order entries by distance and then by index, as sort_part_ascending()
+ * does.
+ */
+static int compare_entries(const void *a, const void *b) {
+
+  const struct sort_entry *ea = (const struct sort_entry *)a;
+  const struct sort_entry *eb = (const struct sort_entry *)b;
+
+  if (ea->d < eb->d) return -1;
+  if (ea->d > eb->d) return 1;
+  return (ea->i > eb->i) - (ea->i < eb->i);
+}
+
+/**
+ * @brief Order integers, to compare the sets of indices.
+ */
+static int compare_int(const void *a, const void *b) {
+  const int ia = *(const int *)a, ib = *(const int *)b;
+  return (ia > ib) - (ia < ib);
+}
+
+/**
+ * @brief Fill a list with the requested kind of distances.
+ *
+ * Kinds: 0 random, 1 random with many duplicate distances, 2 sorted then
+ * slightly perturbed, 3 all equal, 4 sorted in reverse order.
+ */
+static void fill_list(struct sort_entry *sort, const int N, const int kind) {
+
+  for (int k = 0; k < N; k++) {
+    sort[k].i = k;
+    switch (kind) {
+      case 0:
+        sort[k].d = 2.f * rand() / ((float)RAND_MAX) - 1.f;
+        break;
+      case 1:
+        sort[k].d = (float)(rand() % 16) * 0.125f - 1.f;
+        break;
+      case 2:
+        sort[k].d = ((float)k + 4.f * (rand() / ((float)RAND_MAX) - 0.5f)) / N;
+        break;
+      case 3:
+        sort[k].d = 0.5f;
+        break;
+      case 4:
+        sort[k].d = (float)(N - k) / N - 0.5f;
+        break;
+      default:
+        error("Unknown list kind %d", kind);
+    }
+  }
+
+  /* Shuffle the indices so that the ties are not already in order */
+  for (int k = N - 1; k > 0; k--) {
+    const int l = rand() % (k + 1);
+    const int temp = sort[k].i;
+    sort[k].i = sort[l].i;
+    sort[l].i = temp;
+  }
+}
+
+/**
+ * @brief Check that a list is sorted and is a permutation of the reference.
+ *
+ * @param sort The list to check.
+ * @param ref The reference, sorted by (d, i).
+ * @param N The number of entries.
+ * @param ids Scratch space for N indices.
+ * @param name The name of the sort, for the error messages.
+ */
+static void check_sorted(const struct sort_entry *sort,
+                         const struct sort_entry *ref, const int N, int *ids,
+                         const char *name) {
+
+  /* The distances must match the reference one by one */
+  for (int k = 0; k < N; k++)
+    if (sort[k].d != ref[k].d)
+      error("%s: wrong distance at position %d/%d: %e instead of %e", name, k,
+            N, sort[k].d, ref[k].d);
+
+  /* And no index may be lost or duplicated */
+  for (int k = 0; k < N; k++) ids[k] = sort[k].i;
+  qsort(ids, N, sizeof(int), compare_int);
+  for (int k = 0; k < N; k++)
+    if (ids[k] != k) error("%s: index %d lost in a list of %d", name, k, N);
+}
+
+int main(int argc, char *argv[]) {
+
+  /* Initialize CPU frequency, this also starts time. */
+  unsigned long long cpufreq = 0;
+  clocks_set_cpufreq(cpufreq);
+
+/* Choke on FPEs */
+#ifdef HAVE_FE_ENABLE_EXCEPT
+  feenableexcept(FE_DIVBYZERO | FE_INVALID | FE_OVERFLOW);
+#endif
+
+  /* Get some randomness going */
+  const int seed = time(NULL);
+  message("Seed = %d", seed);
+  srand(seed);
+
+  struct sort_entry *list = (struct sort_entry *)malloc(
+      (MAX_ENTRIES + 1) * sizeof(struct sort_entry));
+  struct sort_entry *ref = (struct sort_entry *)malloc(
+      (MAX_ENTRIES + 1) * sizeof(struct sort_entry));
+  struct sort_entry *copy = (struct sort_entry *)malloc(
+      (MAX_ENTRIES + 1) * sizeof(struct sort_entry));
+  int *ids = (int *)malloc((MAX_ENTRIES + 1) * sizeof(int));
+  if (list == NULL || ref == NULL || copy == NULL || ids == NULL)
+    error("Impossible to allocate the lists");
+
+  /* Sizes spanning the insertion-sort threshold and the old 1024 limit */
+  const int sizes[] = {0, 1, 2, 31, 32, 33, 1023, 1024, 1025, MAX_ENTRIES};
+  const int num_sizes = sizeof(sizes) / sizeof(int);
+
+  for (int kind = 0; kind < 5; kind++) {
+    for (int s = 0; s < num_sizes; s++) {
+      for (int n = 0; n < NUM_LISTS; n++) {
+
+        /* Random length up to the current size for the random kinds */
+        const int N =
+            (n == 0 || kind > 1) ? sizes[s] : rand() % (sizes[s] + 1);
+
+        fill_list(list, N, kind);
+        memcpy(ref, list, N * sizeof(struct sort_entry));
+        memcpy(copy, list, N * sizeof(struct sort_entry));
+        qsort(ref, N, sizeof(struct sort_entry), compare_entries);
+
+        /* The full sort must reproduce qsort exactly, ties included */
+        sort_part_ascending(list, N);
+        for (int k = 0; k < N; k++)
+          if (list[k].d != ref[k].d || list[k].i != ref[k].i)
+            error(
+                "sort_part_ascending: kind=%d N=%d entry %d is (%e, %d) "
+                "instead of (%e, %d)",
+                kind, N, k, list[k].d, list[k].i, ref[k].d, ref[k].i);
+
+        /* The adaptive sort keeps the previous order of the ties, try it
+         * with no and with a generous budget of moves */
+        memcpy(list, copy, N * sizeof(struct sort_entry));
+        sort_part_ascending_adaptive(list, N, 0);
+        check_sorted(list, ref, N, ids, "sort_part_ascending_adaptive(0)");
+
+        memcpy(list, copy, N * sizeof(struct sort_entry));
+        sort_part_ascending_adaptive(list, N, 16);
+        check_sorted(list, ref, N, ids, "sort_part_ascending_adaptive(16)");
+      }
+    }
+  }
+
+  /* Lists terminated by a sentinel, as used in the runners */
+  for (int n = 0; n < NUM_LISTS; n++) {
+    const int N = 1 + rand() % MAX_ENTRIES;
+    fill_list(list, N, 2);
+    list[N].d = FLT_MAX;
+    list[N].i = N;
+    memcpy(ref, list, (N + 1) * sizeof(struct sort_entry));
+    qsort(ref, N + 1, sizeof(struct sort_entry), compare_entries);
+    sort_part_ascending_adaptive(list, N + 1, 4);
+    check_sorted(list, ref, N + 1, ids, "sentinel");
+    if (list[N].d != FLT_MAX) error("The sentinel moved!");
+  }
+
+  message("All good!");
+
+  /* Be clean */
+  free(list);
+  free(ref);
+  free(copy);
+  free(ids);
+  return 0;
+}